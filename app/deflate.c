@@ -1,7 +1,7 @@
 /**
  * @file deflate.c
  * @author hutusi (hutusi@outlook.com)
- * @brief Use Huffman Tree to deflate text file.
+ * @brief Use LZ77 and Huffman Tree to deflate text file.
  * @date 2019-08-30
  * 
  * @copyright Copyright (c) 2019, hutusi.com
@@ -20,10 +20,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+/** The bytes read from the file at a time. */
+#define READ_SIZE 65536
+
+/** the online CPUs, for the default number of threads. */
+static unsigned int default_threads()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) {
+        return 1;
+    }
+    return cpus > HUFFMAN_MAX_THREADS ? HUFFMAN_MAX_THREADS
+                                      : (unsigned int)cpus;
+}
+
+static int write_file(const void *data, size_t size, void *args)
+{
+    return fwrite(data, 1, size, (FILE *)args) == size ? 0 : -1;
+}
 
 int main(int argc, char *argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <text_filename> [<deflate_filename>]", argv[0]);
+        fprintf(stderr,
+                "Usage: %s <text_filename> [<deflate_filename>] [<block_size>] "
+                "[<num_threads>] [<level>]",
+                argv[0]);
         return -1;
     }
 
@@ -34,39 +57,56 @@ int main(int argc, char *argv[]) {
     } else {
         strcpy(outfile, "out.deflate");
     }
+    size_t block_size = argc > 3 ? strtoul(argv[3], NULL, 10) : 0;
+    unsigned int num_threads = argc > 4
+                                   ? (unsigned int)strtoul(argv[4], NULL, 10)
+                                   : default_threads();
+    /** level 0 for Huffman coding only. */
+    int level = argc > 5 ? atoi(argv[5]) : LZ77_DEFAULT_LEVEL;
     fprintf(stdout, "%s %s ==> %s \n", argv[0], argv[1], outfile);
 
-    FILE *fin = fopen(argv[1], "r");
+    FILE *fin = fopen(argv[1], "rb");
     if (fin == NULL) {
         fprintf(stderr, "Error: Cannot open file [%s]", argv[1]);
         return -1;
     }
+    FILE *fout = fopen(outfile, "wb");
+    if (fout == NULL) {
+        fprintf(stderr, "Error: Cannot open file [%s]", outfile);
+        fclose(fin);
+        return -1;
+    }
 
-    fseek(fin, 0, SEEK_END);
-    unsigned long size = ftell(fin);
-    fseek(fin, 0, SEEK_SET);
+    /** block by block, the file is never read whole. */
+    HuffmanEncoder *encoder = huffman_encoder_new_level(
+        block_size, level, num_threads, write_file, fout);
+    if (encoder == NULL) {
+        fprintf(stderr,
+                "Error: Bad block size [%lu] or threads [%u]",
+                (unsigned long)block_size,
+                num_threads);
+        fclose(fin);
+        fclose(fout);
+        return -1;
+    }
 
-    char *buffer = (char *)malloc(size);
-    fread(buffer, 1, size, fin);
+    char buffer[READ_SIZE];
+    size_t size;
+    int result = 0;
+    while (result == 0 && (size = fread(buffer, 1, READ_SIZE, fin)) > 0) {
+        result = huffman_encoder_write(encoder, buffer, size);
+    }
+    if (result == 0) {
+        result = huffman_encoder_finish(encoder);
+    }
+    huffman_encoder_free(encoder);
     fclose(fin);
-
-    Heap *heap = huffman_heap_from_string(buffer, size);
-    HuffmanTree *tree = huffman_tree_from(heap);
-    BitMap *textbits = huffman_encode_string(tree, buffer, size);
-    BitMap *treebits = huffman_tree_deflate(tree);
-    free(buffer);
-    huffman_tree_free(tree);
-
-    FILE *fout = fopen(outfile, "w");
-    fwrite(&(treebits->num_bits), sizeof(unsigned int), 1, fout);
-    fwrite(treebits->words, sizeof(word_t), treebits->num_words, fout);
-    fwrite(&(textbits->num_bits), sizeof(unsigned int), 1, fout);
-    fwrite(textbits->words, sizeof(word_t), textbits->num_words, fout);
     fclose(fout);
 
-    bitmap_free(treebits);
-    bitmap_free(textbits);
-
+    if (result != 0) {
+        fprintf(stderr, "Error: Cannot deflate to file [%s]", outfile);
+        return -1;
+    }
     fprintf(stdout, "done! deflate to file [%s]. \n", outfile);
 
     return 0;
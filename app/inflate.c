@@ -19,10 +19,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+/** The bytes read from the file at a time. */
+#define READ_SIZE 65536
+
+/** the online CPUs, for the default number of threads. */
+static unsigned int default_threads()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) {
+        return 1;
+    }
+    return cpus > HUFFMAN_MAX_THREADS ? HUFFMAN_MAX_THREADS
+                                      : (unsigned int)cpus;
+}
+
+static int write_file(const void *data, size_t size, void *args)
+{
+    return fwrite(data, 1, size, (FILE *)args) == size ? 0 : -1;
+}
 
 int main(int argc, char *argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <text_filename> [<inflate_filename>]", argv[0]);
+        fprintf(stderr,
+                "Usage: %s <text_filename> [<inflate_filename>] [<num_threads>]",
+                argv[0]);
         return -1;
     }
 
@@ -33,37 +55,49 @@ int main(int argc, char *argv[]) {
     } else {
         strcpy(outfile, "out.txt");
     }
+    unsigned int num_threads = argc > 3
+                                   ? (unsigned int)strtoul(argv[3], NULL, 10)
+                                   : default_threads();
     fprintf(stdout, "%s %s ==> %s \n", argv[0], argv[1], outfile);
 
-    FILE *fin = fopen(argv[1], "r");
+    FILE *fin = fopen(argv[1], "rb");
     if (fin == NULL) {
         fprintf(stderr, "Error: Cannot open file [%s]", argv[1]);
         return -1;
     }
+    FILE *fout = fopen(outfile, "wb");
+    if (fout == NULL) {
+        fprintf(stderr, "Error: Cannot open file [%s]", outfile);
+        fclose(fin);
+        return -1;
+    }
 
-    /** [tree_size][tree_bits][encode_size][encode_bits]*/
-    unsigned int num_bits;
-    fread(&num_bits, sizeof(unsigned int), 1, fin);
-    BitMap *treebits = bitmap_new(num_bits);
-    fread(treebits->words, sizeof(word_t), treebits->num_words, fin);
-
-    fread(&num_bits, sizeof(unsigned int), 1, fin);
-    BitMap *textbits = bitmap_new(num_bits);
-    fread(textbits->words, sizeof(word_t), textbits->num_words, fin);
-
+    /** blocks are decoded on threads and written out in order. */
+    HuffmanDecoder *decoder =
+        huffman_decoder_new_threads(num_threads, write_file, fout);
+    if (decoder == NULL) {
+        fprintf(stderr, "Error: Bad threads [%u]", num_threads);
+        fclose(fin);
+        fclose(fout);
+        return -1;
+    }
+    unsigned char buffer[READ_SIZE];
+    size_t size;
+    int result = 0;
+    while (result == 0 && (size = fread(buffer, 1, READ_SIZE, fin)) > 0) {
+        result = huffman_decoder_write(decoder, buffer, size);
+    }
+    if (result == 0) {
+        result = huffman_decoder_finish(decoder);
+    }
+    huffman_decoder_free(decoder);
     fclose(fin);
-
-    HuffmanTree *tree = huffman_tree_inflate(treebits);
-    Text *text = huffman_decode(tree, textbits);
-    bitmap_free(treebits);
-    bitmap_free(textbits);
-    huffman_tree_free(tree);
-
-    FILE *fout = fopen(outfile, "w");
-    fwrite(text_char_string(text), sizeof(char), text_length(text), fout);
     fclose(fout);
-    text_free(text);
 
+    if (result != 0) {
+        fprintf(stderr, "Error: Bad or truncated file [%s]", argv[1]);
+        return -1;
+    }
     fprintf(stdout, "done! inflate to file [%s]. \n", outfile);
 
     return 0;
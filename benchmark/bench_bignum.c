@@ -0,0 +1,358 @@
+/**
+ * @file bench_bignum.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark BigNum, of 64-bit limbs, against the former decimal string
+ * arithmetic (one char a digit), from 100 to 10^6 digits: decimal parse and
+ * print, add, sub, mul (n x n digits) and divmod (2n / n digits).
+ *
+ * Usage: bench_bignum [max_digits] [max_string_digits]
+ *        (default 1000000 digits, the string arithmetic of mul and divmod up
+ *        to 10000 digits, being quadratic with a large constant)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "bignum.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define char_to_int(ch) ((ch) - '0')
+#define int_to_char(ch) ((ch) + '0')
+
+/** Run an operation at least this long for its time. */
+#define BENCH_MIN_SECONDS 0.2
+
+/** The string arithmetic before BigNum, as it was. */
+
+static size_t string_trim_head_zero(char *num, size_t len)
+{
+    size_t zero = 0;
+    while (zero + 1 < len && num[zero] == '0') {
+        ++zero;
+    }
+    if (zero > 0) {
+        memmove(num, num + zero, len - zero + 1);
+    }
+    return len - zero;
+}
+
+static size_t string_addition_internal(const char *addend,
+                                       size_t addend_len,
+                                       const char *aug,
+                                       size_t aug_len,
+                                       char *sum)
+{
+    int carry = 0;
+    size_t sum_len = addend_len + 1;
+    size_t index = sum_len;
+    sum[0] = '0';
+    sum[index] = '\0';
+
+    for (size_t i = 1; i <= aug_len; ++i) {
+        int eval = char_to_int(addend[addend_len - i]) +
+                   char_to_int(aug[aug_len - i]) + carry;
+        carry = eval / 10;
+        sum[--index] = int_to_char(eval % 10);
+    }
+    for (size_t i = addend_len - aug_len; i-- > 0;) {
+        int eval = char_to_int(addend[i]) + carry;
+        carry = eval / 10;
+        sum[--index] = int_to_char(eval % 10);
+    }
+
+    if (carry > 0) {
+        sum[--index] = int_to_char(carry);
+    } else {
+        memmove(sum, &sum[1], sum_len);
+        --sum_len;
+    }
+    return sum_len;
+}
+
+static void string_addition(const char *addend, const char *aug, char *sum)
+{
+    size_t addend_len = strlen(addend);
+    size_t aug_len = strlen(aug);
+    if (addend_len < aug_len) {
+        string_addition_internal(aug, aug_len, addend, addend_len, sum);
+    } else {
+        string_addition_internal(addend, addend_len, aug, aug_len, sum);
+    }
+}
+
+static size_t string_subtraction_internal(const char *minuend,
+                                          const char *subtractor,
+                                          char *difference)
+{
+    size_t minuend_len = strlen(minuend);
+    size_t subtractor_len = strlen(subtractor);
+    size_t index = minuend_len;
+    difference[index] = '\0';
+
+    int borrow = 0;
+    for (size_t i = 1; i <= minuend_len; ++i) {
+        int m = char_to_int(minuend[minuend_len - i]) - borrow;
+        int s = i <= subtractor_len
+                    ? char_to_int(subtractor[subtractor_len - i])
+                    : 0;
+        borrow = m < s;
+        difference[--index] = int_to_char(borrow ? 10 + m - s : m - s);
+    }
+    return string_trim_head_zero(difference, minuend_len);
+}
+
+static void
+string_subtraction(const char *minuend, const char *subtractor, char *difference)
+{
+    int cmp = bignum_int_compare(minuend, subtractor);
+    if (cmp < 0) {
+        string_subtraction_internal(subtractor, minuend, difference);
+    } else if (cmp > 0) {
+        string_subtraction_internal(minuend, subtractor, difference);
+    } else {
+        strcpy(difference, "0");
+    }
+}
+
+/** the product by repeated addition of the shifted multiplicand. */
+static void string_multiplication(const char *multiplicand,
+                                  const char *multiplier,
+                                  char *product)
+{
+    size_t multiplicand_len = strlen(multiplicand);
+    size_t multiplier_len = strlen(multiplier);
+    size_t product_len = multiplicand_len + multiplier_len;
+    char *tmp_product = (char *)malloc(product_len + 2);
+    char *tmp_multip = (char *)malloc(product_len + 2);
+    size_t tmp_product_len = 1;
+    strcpy(product, "0");
+
+    size_t move = 0;
+    for (size_t i = multiplier_len; i-- > 0; ++move) {
+        memcpy(tmp_multip, multiplicand, multiplicand_len);
+        memset(tmp_multip + multiplicand_len, '0', move);
+        size_t tmp_multip_len = multiplicand_len + move;
+        tmp_multip[tmp_multip_len] = '\0';
+
+        int factor = char_to_int(multiplier[i]);
+        for (int j = 0; j < factor; ++j) {
+            strcpy(tmp_product, product);
+            if (tmp_product_len < tmp_multip_len) {
+                tmp_product_len = string_addition_internal(tmp_multip,
+                                                           tmp_multip_len,
+                                                           tmp_product,
+                                                           tmp_product_len,
+                                                           product);
+            } else {
+                tmp_product_len = string_addition_internal(tmp_product,
+                                                           tmp_product_len,
+                                                           tmp_multip,
+                                                           tmp_multip_len,
+                                                           product);
+            }
+        }
+    }
+    free(tmp_product);
+    free(tmp_multip);
+}
+
+/** long division, each digit by repeated subtraction. */
+static void string_division(const char *dividend,
+                            const char *divisor,
+                            char *quotient,
+                            char *remainder)
+{
+    size_t dividend_len = strlen(dividend);
+    size_t divisor_len = strlen(divisor);
+    char *tmp_dividend = (char *)malloc(dividend_len + 2);
+    char *tmp_diff = (char *)malloc(dividend_len + 2);
+    size_t quotient_len = 0;
+
+    size_t tmp_dividend_len = divisor_len - 1;
+    memcpy(tmp_dividend, dividend, tmp_dividend_len);
+    tmp_dividend[tmp_dividend_len] = '\0';
+    for (size_t cursor = tmp_dividend_len; cursor < dividend_len; ++cursor) {
+        tmp_dividend[tmp_dividend_len++] = dividend[cursor];
+        tmp_dividend[tmp_dividend_len] = '\0';
+        tmp_dividend_len = string_trim_head_zero(tmp_dividend, tmp_dividend_len);
+
+        int times = 0;
+        while (bignum_int_compare(tmp_dividend, divisor) >= 0) {
+            tmp_dividend_len =
+                string_subtraction_internal(tmp_dividend, divisor, tmp_diff);
+            strcpy(tmp_dividend, tmp_diff);
+            ++times;
+        }
+        if (quotient_len != 0 || times != 0) {
+            quotient[quotient_len++] = (char)int_to_char(times);
+        }
+    }
+    quotient[quotient_len] = '\0';
+    strcpy(remainder, tmp_dividend);
+    free(tmp_dividend);
+    free(tmp_diff);
+}
+
+/** random digits, the first not zero. */
+static char *random_digits(size_t length)
+{
+    char *digits = (char *)malloc(length + 1);
+    digits[0] = (char)('1' + rand() % 9);
+    for (size_t i = 1; i < length; ++i) {
+        digits[i] = (char)('0' + rand() % 10);
+    }
+    digits[length] = '\0';
+    return digits;
+}
+
+typedef struct _BenchOperands {
+    const char *a;
+    const char *b;
+    const char *wide;
+    BigNum *x;
+    BigNum *y;
+    BigNum *w;
+    BigNum *q;
+    BigNum *r;
+    char *output;
+    char *remainder;
+} BenchOperands;
+
+typedef void (*BenchOp)(BenchOperands *operands);
+
+static void op_parse(BenchOperands *o) { bignum_from_string(o->q, o->a); }
+
+static void op_print(BenchOperands *o) { free(bignum_to_string(o->x)); }
+
+static void op_add(BenchOperands *o) { bignum_add(o->q, o->x, o->y); }
+
+static void op_sub(BenchOperands *o) { bignum_sub(o->q, o->y, o->x); }
+
+static void op_mul(BenchOperands *o) { bignum_mul(o->q, o->x, o->y); }
+
+static void op_divmod(BenchOperands *o) { bignum_divmod(o->q, o->r, o->w, o->y); }
+
+static void op_string_add(BenchOperands *o)
+{
+    string_addition(o->a, o->b, o->output);
+}
+
+static void op_string_sub(BenchOperands *o)
+{
+    string_subtraction(o->b, o->a, o->output);
+}
+
+static void op_string_mul(BenchOperands *o)
+{
+    string_multiplication(o->a, o->b, o->output);
+}
+
+static void op_string_divmod(BenchOperands *o)
+{
+    string_division(o->wide, o->b, o->output, o->remainder);
+}
+
+/** seconds of an operation, repeated for BENCH_MIN_SECONDS. */
+static double bench_op(BenchOp op, BenchOperands *operands)
+{
+    size_t count = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        op(operands);
+        ++count;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return elapsed / count;
+}
+
+static void bench_print(const char *name, double seconds, double string_seconds)
+{
+    if (string_seconds > 0) {
+        printf("  %-7s %12.6f ms  string %12.6f ms  x%9.1f\n",
+               name,
+               seconds * 1e3,
+               string_seconds * 1e3,
+               string_seconds / seconds);
+    } else {
+        printf("  %-7s %12.6f ms\n", name, seconds * 1e3);
+    }
+}
+
+static void bench_digits(size_t digits, size_t max_string_digits)
+{
+    BenchOperands o;
+    char *a = random_digits(digits);
+    char *b = random_digits(digits);
+    char *wide = random_digits(digits * 2);
+    o.a = a;
+    o.b = b;
+    o.wide = wide;
+    o.x = bignum_new();
+    o.y = bignum_new();
+    o.w = bignum_new();
+    o.q = bignum_new();
+    o.r = bignum_new();
+    o.output = (char *)malloc(digits * 2 + 2);
+    o.remainder = (char *)malloc(digits * 2 + 2);
+    bignum_from_string(o.x, a);
+    bignum_from_string(o.y, b);
+    bignum_from_string(o.w, wide);
+
+    /** print back what was parsed. */
+    char *printed = bignum_to_string(o.x);
+    if (strcmp(printed, a) != 0) {
+        printf("  print not equal to parsed!\n");
+    }
+    free(printed);
+
+    printf("%lu digits\n", (unsigned long)digits);
+    bench_print("parse", bench_op(op_parse, &o), 0);
+    bench_print("print", bench_op(op_print, &o), 0);
+    bench_print("add", bench_op(op_add, &o), bench_op(op_string_add, &o));
+    bench_print("sub", bench_op(op_sub, &o), bench_op(op_string_sub, &o));
+    bool slow = digits <= max_string_digits;
+    bench_print("mul",
+                bench_op(op_mul, &o),
+                slow ? bench_op(op_string_mul, &o) : 0);
+    bench_print("divmod",
+                bench_op(op_divmod, &o),
+                slow ? bench_op(op_string_divmod, &o) : 0);
+    if (slow) {
+        printed = bignum_to_string(o.q);
+        if (strcmp(printed, o.output) != 0) {
+            printf("  divmod not equal to the string division!\n");
+        }
+        free(printed);
+    }
+
+    bignum_free(o.x);
+    bignum_free(o.y);
+    bignum_free(o.w);
+    bignum_free(o.q);
+    bignum_free(o.r);
+    free(o.output);
+    free(o.remainder);
+    free(a);
+    free(b);
+    free(wide);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_digits = bench_arg(argc, argv, 1, 1000000);
+    size_t max_string_digits = bench_arg(argc, argv, 2, 10000);
+
+    srand(2019);
+    for (size_t digits = 100; digits <= max_digits; digits *= 10) {
+        bench_digits(digits, max_string_digits);
+    }
+    return 0;
+}
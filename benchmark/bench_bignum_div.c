@@ -0,0 +1,194 @@
+/**
+ * @file bench_bignum_div.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Tune the Burnikel-Ziegler threshold of BigNum division, then
+ * benchmark division (2n by n digits), GCD and modular exponentiation from
+ * 10^3 to 10^6 digits.
+ *
+ * The threshold is the least divisor size at which Burnikel-Ziegler beats
+ * schoolbook (Knuth D) division of 2n by n limbs, at that size and the next
+ * two measured. Copy it to BIGNUM_BURNIKEL_ZIEGLER_THRESHOLD of bignum.c.
+ *
+ * Usage: bench_bignum_div [max_digits] [max_gcd_digits] [max_powmod_digits]
+ *        (default 1000000, 100000 and 3000 digits; schoolbook division up
+ *        to 100000 digits)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "bignum.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Run an operation at least this long for its time. */
+#define BENCH_MIN_SECONDS 0.05
+
+/** Schoolbook division takes seconds above this. */
+#define BENCH_KNUTH_MAX_DIGITS 100000
+
+/** About 19.3 digits a limb. */
+#define BENCH_DIGITS_TO_LIMBS(digits) ((digits) * 10 / 193 + 1)
+
+/** a random BigNum of size limbs. */
+static void random_bignum(BigNum *num, size_t size)
+{
+    BigNum *limb = bignum_new();
+    bignum_set_int(num, 0);
+    for (size_t i = 0; i < size; ++i) {
+        int64_t value = ((int64_t)rand() << 31) ^ rand();
+        bignum_shift_left(num, num, BIGNUM_LIMB_BITS);
+        bignum_set_int(limb, value | 1);
+        bignum_shift_left(limb, limb, 32);
+        bignum_add(num, num, limb);
+        bignum_set_int(limb, rand());
+        bignum_add(num, num, limb);
+    }
+    bignum_free(limb);
+}
+
+/** seconds of a / b by the thresholds. */
+static double bench_divmod(const BigNumThresholds *thresholds,
+                           const BigNum *a,
+                           const BigNum *b,
+                           BigNum *quotient,
+                           BigNum *remainder)
+{
+    bignum_set_thresholds(thresholds);
+    size_t count = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        bignum_divmod(quotient, remainder, a, b);
+        ++count;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return elapsed / count;
+}
+
+/**
+ * the least divisor size at which Burnikel-Ziegler from the size wins over
+ * schoolbook, 3 in a row.
+ */
+static size_t tune(BigNumThresholds *thresholds)
+{
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *quotient = bignum_new();
+    BigNum *remainder = bignum_new();
+    size_t found = SIZE_MAX;
+    int wins = 0;
+
+    printf("burnikel-ziegler: schoolbook, burnikel-ziegler (2n / n limbs)\n");
+    for (size_t size = 4; size <= 20000 && wins < 3; size += size / 7 + 1) {
+        random_bignum(a, 2 * size);
+        random_bignum(b, size);
+
+        thresholds->burnikel_ziegler = SIZE_MAX;
+        double slow = bench_divmod(thresholds, a, b, quotient, remainder);
+        thresholds->burnikel_ziegler = size;
+        double fast = bench_divmod(thresholds, a, b, quotient, remainder);
+        printf("  %6lu limbs  %10.3f us  %10.3f us  %s\n",
+               (unsigned long)size,
+               slow * 1e6,
+               fast * 1e6,
+               fast < slow ? "faster" : "");
+
+        if (fast < slow) {
+            if (wins++ == 0) {
+                found = size;
+            }
+        } else {
+            wins = 0;
+        }
+    }
+    thresholds->burnikel_ziegler = found;
+    printf("  threshold: %lu\n", (unsigned long)found);
+
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(quotient);
+    bignum_free(remainder);
+    return found;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_digits = bench_arg(argc, argv, 1, 1000000);
+    size_t max_gcd_digits = bench_arg(argc, argv, 2, 100000);
+    size_t max_powmod_digits = bench_arg(argc, argv, 3, 3000);
+    srand(2019);
+
+    BigNumThresholds tuned;
+    bignum_get_thresholds(&tuned);
+    tune(&tuned);
+    printf("\n#define BIGNUM_BURNIKEL_ZIEGLER_THRESHOLD %lu\n\n",
+           (unsigned long)tuned.burnikel_ziegler);
+
+    BigNumThresholds knuth = tuned;
+    knuth.burnikel_ziegler = SIZE_MAX;
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *m = bignum_new();
+    BigNum *quotient = bignum_new();
+    BigNum *remainder = bignum_new();
+
+    printf("%8s  %12s  %12s  %12s  %12s   (ms)\n",
+           "digits",
+           "knuth",
+           "bz",
+           "gcd",
+           "powmod");
+    for (size_t digits = 1000; digits <= max_digits; digits *= 10) {
+        for (size_t step = 1; step < 10 && digits * step <= max_digits;
+             step *= 3) {
+            size_t n = digits * step;
+            size_t limbs = BENCH_DIGITS_TO_LIMBS(n);
+            random_bignum(a, 2 * limbs);
+            random_bignum(b, limbs);
+            printf("%8lu", (unsigned long)n);
+
+            if (n <= BENCH_KNUTH_MAX_DIGITS) {
+                printf("  %12.4f",
+                       bench_divmod(&knuth, a, b, quotient, remainder) * 1e3);
+            } else {
+                printf("  %12s", "-");
+            }
+            printf("  %12.4f",
+                   bench_divmod(&tuned, a, b, quotient, remainder) * 1e3);
+
+            /** gcd of two n digits, once: Lehmer is quadratic. */
+            if (n <= max_gcd_digits) {
+                random_bignum(a, limbs);
+                double start = bench_now();
+                bignum_gcd(quotient, a, b);
+                printf("  %12.4f", (bench_now() - start) * 1e3);
+            } else {
+                printf("  %12s", "-");
+            }
+
+            /** a^b mod m, all n digits, once. */
+            if (n <= max_powmod_digits) {
+                random_bignum(m, limbs);
+                double start = bench_now();
+                bignum_powmod(quotient, a, b, m);
+                printf("  %12.4f", (bench_now() - start) * 1e3);
+            } else {
+                printf("  %12s", "-");
+            }
+            printf("\n");
+        }
+    }
+
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(m);
+    bignum_free(quotient);
+    bignum_free(remainder);
+    return 0;
+}
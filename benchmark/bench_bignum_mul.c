@@ -0,0 +1,209 @@
+/**
+ * @file bench_bignum_mul.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Tune the thresholds of BigNum multiplication, then benchmark each
+ * algorithm from 10 to 10^5 limbs (n x n limbs, about 19.3 digits a limb).
+ *
+ * A threshold is the least size at which one level of the faster algorithm,
+ * the slower below it, beats the slower alone, at that size and the next
+ * two measured: Karatsuba against schoolbook, then Toom-3 against
+ * Karatsuba from the Karatsuba threshold, then the transform against Toom-3
+ * from the Toom-3 threshold. Copy the thresholds found
+ * to BIGNUM_*_THRESHOLD of bignum.c.
+ *
+ * Usage: bench_bignum_mul [max_limbs]
+ *        (default 100000 limbs for the benchmark, schoolbook up to 10000)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "bignum.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Run a multiplication at least this long for its time. */
+#define BENCH_MIN_SECONDS 0.05
+
+/** Schoolbook takes seconds above this. */
+#define BENCH_BASECASE_MAX_LIMBS 10000
+
+/** a random BigNum of size limbs. */
+static void random_bignum(BigNum *num, size_t size)
+{
+    BigNum *limb = bignum_new();
+    bignum_set_int(num, 0);
+    for (size_t i = 0; i < size; ++i) {
+        int64_t value = ((int64_t)rand() << 31) ^ rand();
+        bignum_shift_left(num, num, BIGNUM_LIMB_BITS);
+        bignum_set_int(limb, value | 1);
+        bignum_shift_left(limb, limb, 32);
+        bignum_add(num, num, limb);
+        bignum_set_int(limb, rand());
+        bignum_add(num, num, limb);
+    }
+    bignum_free(limb);
+}
+
+/** seconds of a * b by the thresholds. */
+static double bench_mul(const BigNumThresholds *thresholds,
+                        const BigNum *a,
+                        const BigNum *b,
+                        BigNum *product)
+{
+    bignum_set_thresholds(thresholds);
+    size_t count = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        bignum_mul(product, a, b);
+        ++count;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return elapsed / count;
+}
+
+/**
+ * the least of the sizes from min_size at which the threshold set to the
+ * size (one level of the faster algorithm) wins over it set above, 3 in a
+ * row.
+ */
+static size_t tune(const char *name,
+                   BigNumThresholds *thresholds,
+                   size_t *threshold,
+                   size_t min_size,
+                   const size_t *sizes,
+                   size_t num_sizes)
+{
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *product = bignum_new();
+    size_t found = SIZE_MAX;
+    int wins = 0;
+
+    printf("%s\n", name);
+    for (size_t i = 0; i < num_sizes && wins < 3; ++i) {
+        size_t size = sizes[i];
+        if (size < min_size) {
+            continue;
+        }
+        random_bignum(a, size);
+        random_bignum(b, size);
+
+        *threshold = SIZE_MAX;
+        double slow = bench_mul(thresholds, a, b, product);
+        *threshold = size;
+        double fast = bench_mul(thresholds, a, b, product);
+        printf("  %6lu limbs  %10.3f us  %10.3f us  %s\n",
+               (unsigned long)size,
+               slow * 1e6,
+               fast * 1e6,
+               fast < slow ? "faster" : "");
+
+        if (fast < slow) {
+            if (wins++ == 0) {
+                found = size;
+            }
+        } else {
+            wins = 0;
+        }
+    }
+    *threshold = found;
+    printf("  threshold: %lu\n", (unsigned long)found);
+
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(product);
+    return found;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_limbs = bench_arg(argc, argv, 1, 100000);
+    srand(2019);
+
+    /** the sizes, about 1.15 apart. */
+    size_t sizes[128];
+    size_t num_sizes = 0;
+    for (size_t size = 4; size <= 20000; size += size / 7 + 1) {
+        sizes[num_sizes++] = size;
+    }
+
+    BigNumThresholds tuned;
+    bignum_get_thresholds(&tuned);
+    tuned.karatsuba = SIZE_MAX;
+    tuned.toom3 = SIZE_MAX;
+    tuned.ntt = SIZE_MAX;
+    tune("karatsuba: schoolbook, one level of karatsuba",
+         &tuned,
+         &(tuned.karatsuba),
+         0,
+         sizes,
+         num_sizes);
+    tune("toom3: karatsuba, one level of toom3",
+         &tuned,
+         &(tuned.toom3),
+         tuned.karatsuba,
+         sizes,
+         num_sizes);
+    tune("ntt: toom3, ntt",
+         &tuned,
+         &(tuned.ntt),
+         tuned.toom3,
+         sizes,
+         num_sizes);
+    printf("\n#define BIGNUM_KARATSUBA_THRESHOLD %lu\n"
+           "#define BIGNUM_TOOM3_THRESHOLD %lu\n"
+           "#define BIGNUM_NTT_THRESHOLD %lu\n\n",
+           (unsigned long)tuned.karatsuba,
+           (unsigned long)tuned.toom3,
+           (unsigned long)tuned.ntt);
+
+    /** each algorithm down to its own threshold, the tuned below. */
+    const char *names[] = {"schoolbook", "karatsuba", "toom3", "ntt", "tuned"};
+    size_t bz = tuned.burnikel_ziegler;
+    BigNumThresholds algorithms[5] = {
+        {SIZE_MAX, SIZE_MAX, SIZE_MAX, bz},
+        {tuned.karatsuba, SIZE_MAX, SIZE_MAX, bz},
+        {tuned.karatsuba, tuned.toom3, SIZE_MAX, bz},
+        {tuned.karatsuba, tuned.toom3, 1, bz},
+        tuned,
+    };
+    printf("%8s", "limbs");
+    for (int k = 0; k < 5; ++k) {
+        printf("  %12s", names[k]);
+    }
+    printf("   (ms)\n");
+
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *product = bignum_new();
+    for (size_t size = 10; size <= max_limbs; size *= 10) {
+        for (size_t step = 1; step < 10 && size * step <= max_limbs;
+             step *= 3) {
+            size_t n = size * step;
+            random_bignum(a, n);
+            random_bignum(b, n);
+            printf("%8lu", (unsigned long)n);
+            for (int k = 0; k < 5; ++k) {
+                if (k == 0 && n > BENCH_BASECASE_MAX_LIMBS) {
+                    printf("  %12s", "-");
+                    continue;
+                }
+                printf("  %12.4f",
+                       bench_mul(&(algorithms[k]), a, b, product) * 1e3);
+            }
+            printf("\n");
+        }
+    }
+
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(product);
+    return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file bench_bignum_scratch.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark BigNum loops allocating a call against a reused scratch:
+ * a dot product, acc += x[i] * y[i] by bignum_mul and bignum_add or by
+ * bignum_addmul, and a / b by bignum_divmod or bignum_divmod_scratch
+ * (2n by n limbs), from 1 to 4096 limbs.
+ *
+ * Usage: bench_bignum_scratch [max_limbs]
+ *        (default 4096 limbs)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "bignum.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Run a loop at least this long for its time. */
+#define BENCH_MIN_SECONDS 0.05
+
+/** The terms of the dot product. */
+#define BENCH_TERMS 16
+
+/** a random BigNum of size limbs. */
+static void random_bignum(BigNum *num, size_t size)
+{
+    BigNum *limb = bignum_new();
+    bignum_set_int(num, 0);
+    for (size_t i = 0; i < size; ++i) {
+        int64_t value = ((int64_t)rand() << 31) ^ rand();
+        bignum_shift_left(num, num, BIGNUM_LIMB_BITS);
+        bignum_set_int(limb, value | 1);
+        bignum_shift_left(limb, limb, 32);
+        bignum_add(num, num, limb);
+        bignum_set_int(limb, rand());
+        bignum_add(num, num, limb);
+    }
+    bignum_free(limb);
+}
+
+/** seconds of a dot product, by bignum_addmul if scratch. */
+static double bench_dot(BigNum **x,
+                        BigNum **y,
+                        BigNum *acc,
+                        BigNum *product,
+                        BigNumScratch *scratch)
+{
+    size_t count = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        bignum_set_int(acc, 0);
+        for (int i = 0; i < BENCH_TERMS; ++i) {
+            if (scratch != NULL) {
+                bignum_addmul(acc, x[i], y[i], scratch);
+            } else {
+                bignum_mul(product, x[i], y[i]);
+                bignum_add(acc, acc, product);
+            }
+        }
+        ++count;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return elapsed / count;
+}
+
+/** seconds of a / b, by bignum_divmod_scratch if scratch. */
+static double bench_divmod(const BigNum *a,
+                           const BigNum *b,
+                           BigNum *quotient,
+                           BigNum *remainder,
+                           BigNumScratch *scratch)
+{
+    size_t count = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        if (scratch != NULL) {
+            bignum_divmod_scratch(quotient, remainder, a, b, scratch);
+        } else {
+            bignum_divmod(quotient, remainder, a, b);
+        }
+        ++count;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return elapsed / count;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_limbs = bench_arg(argc, argv, 1, 4096);
+    srand(2019);
+
+    BigNum *x[BENCH_TERMS];
+    BigNum *y[BENCH_TERMS];
+    for (int i = 0; i < BENCH_TERMS; ++i) {
+        x[i] = bignum_new();
+        y[i] = bignum_new();
+    }
+    BigNum *acc = bignum_new();
+    BigNum *product = bignum_new();
+    BigNum *a = bignum_new();
+    BigNum *quotient = bignum_new();
+    BigNum *remainder = bignum_new();
+    BigNumScratch *scratch = bignum_scratch_new(0);
+
+    printf("%8s  %12s  %12s  %6s  %12s  %12s  %6s   (us)\n",
+           "limbs",
+           "mul+add",
+           "addmul",
+           "x",
+           "divmod",
+           "scratch",
+           "x");
+    for (size_t n = 1; n <= max_limbs; n *= 4) {
+        for (int i = 0; i < BENCH_TERMS; ++i) {
+            random_bignum(x[i], n);
+            random_bignum(y[i], n);
+        }
+        random_bignum(a, 2 * n);
+
+        /** the sizes up front: the scratch loops allocate nothing. */
+        size_t size = bignum_addmul_size(2 * n, n, n) + 1;
+        size_t scratch_size = bignum_addmul_scratch_size(n, n);
+        if (scratch_size < bignum_divmod_scratch_size(2 * n, n)) {
+            scratch_size = bignum_divmod_scratch_size(2 * n, n);
+        }
+        bignum_reserve(acc, size);
+        bignum_reserve(quotient, bignum_quotient_size(2 * n, n));
+        bignum_reserve(remainder, bignum_remainder_size(2 * n, n));
+        bignum_scratch_reserve(scratch, scratch_size);
+
+        double plain = bench_dot(x, y, acc, product, NULL);
+        double fused = bench_dot(x, y, acc, product, scratch);
+        double divmod = bench_divmod(a, x[0], quotient, remainder, NULL);
+        double reused = bench_divmod(a, x[0], quotient, remainder, scratch);
+        printf("%8lu  %12.3f  %12.3f  %6.2f  %12.3f  %12.3f  %6.2f\n",
+               (unsigned long)n,
+               plain * 1e6,
+               fused * 1e6,
+               plain / fused,
+               divmod * 1e6,
+               reused * 1e6,
+               divmod / reused);
+    }
+
+    for (int i = 0; i < BENCH_TERMS; ++i) {
+        bignum_free(x[i]);
+        bignum_free(y[i]);
+    }
+    bignum_free(acc);
+    bignum_free(product);
+    bignum_free(a);
+    bignum_free(quotient);
+    bignum_free(remainder);
+    bignum_scratch_free(scratch);
+    return 0;
+}
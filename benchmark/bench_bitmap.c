@@ -0,0 +1,294 @@
+/**
+ * @file bench_bitmap.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark BitMap kernels against the former 32-bit, bit at a time
+ * kernels, from 1K to 1G bits.
+ *
+ * Usage: bench_bitmap [max_bits]   (default 1073741824)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "bitmap.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** each measurement processes about this many bits, over repeats. */
+#define WORK_BITS (1UL << 28)
+
+/** the former BitMap: 32-bit words, one word more per realloc. */
+typedef struct {
+    uint32_t *words;
+    unsigned int num_bits;
+    unsigned int num_words;
+} LegacyBitMap;
+
+static LegacyBitMap *legacy_new(unsigned int num_bits)
+{
+    LegacyBitMap *bitmap = (LegacyBitMap *)malloc(sizeof(LegacyBitMap));
+    bitmap->num_bits = num_bits;
+    bitmap->num_words = num_bits / 32 + (num_bits % 32 != 0);
+    if (bitmap->num_words == 0) {
+        bitmap->num_words = 1;
+    }
+    bitmap->words = (uint32_t *)calloc(bitmap->num_words, sizeof(uint32_t));
+    return bitmap;
+}
+
+static void legacy_free(LegacyBitMap *bitmap)
+{
+    free(bitmap->words);
+    free(bitmap);
+}
+
+static int legacy_get(const LegacyBitMap *bitmap, unsigned int n)
+{
+    return (bitmap->words[n / 32] & ((uint32_t)1 << (n % 32))) != 0;
+}
+
+static unsigned int legacy_count(const LegacyBitMap *bitmap)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < bitmap->num_bits; ++i) {
+        if (legacy_get(bitmap, i))
+            ++count;
+    }
+    return count;
+}
+
+static void legacy_xor(LegacyBitMap *bitmap, const LegacyBitMap *other)
+{
+    for (int i = 0; i < bitmap->num_words; ++i) {
+        bitmap->words[i] ^= other->words[i];
+    }
+}
+
+static void legacy_append(LegacyBitMap *bitmap, int flag)
+{
+    if (bitmap->num_words * 32 <= bitmap->num_bits) {
+        ++(bitmap->num_words);
+        bitmap->words = (uint32_t *)realloc(
+            bitmap->words, sizeof(uint32_t) * bitmap->num_words);
+    }
+    if (flag) {
+        bitmap->words[bitmap->num_bits / 32] |= (uint32_t)1
+                                                << (bitmap->num_bits % 32);
+    } else {
+        bitmap->words[bitmap->num_bits / 32] &=
+            ~((uint32_t)1 << (bitmap->num_bits % 32));
+    }
+    ++(bitmap->num_bits);
+}
+
+/** the former concat shifted 32-bit words, or'ing into stale words. */
+static void legacy_concat(LegacyBitMap *bitmap, const LegacyBitMap *other)
+{
+    unsigned int total_bits = bitmap->num_bits + other->num_bits;
+    unsigned int num_words = total_bits / 32 + (total_bits % 32 != 0);
+    if (total_bits >= bitmap->num_words * 32) {
+        bitmap->words = (uint32_t *)realloc(bitmap->words,
+                                            sizeof(uint32_t) * num_words);
+        bitmap->num_words = num_words;
+    }
+    unsigned int remainder = bitmap->num_bits % 32;
+    unsigned int quotient = bitmap->num_bits / 32;
+    if (remainder == 0) {
+        memcpy(&(bitmap->words[quotient]),
+               other->words,
+               sizeof(uint32_t) * other->num_words);
+    } else {
+        bitmap->words[quotient] &= ~(((uint32_t)(-1)) << remainder);
+        memset(&(bitmap->words[quotient + 1]),
+               0,
+               sizeof(uint32_t) * (bitmap->num_words - quotient - 1));
+        for (int i = 0; i < other->num_words; ++i) {
+            bitmap->words[quotient + i] |= other->words[i] << remainder;
+            if (quotient + i + 1 < bitmap->num_words) {
+                bitmap->words[quotient + i + 1] |=
+                    other->words[i] >> (32 - remainder);
+            }
+        }
+    }
+    bitmap->num_bits = total_bits;
+}
+
+static void
+report(const char *name, unsigned long bits, double legacy, double now)
+{
+    printf("  %-10s legacy %10.1f  new %10.1f MB/s  x%.1f\n",
+           name,
+           bench_mbps(bits / 8.0, legacy),
+           bench_mbps(bits / 8.0, now),
+           now > 0 ? legacy / now : 0);
+}
+
+static void bench_size(unsigned int num_bits)
+{
+    unsigned long repeats = WORK_BITS / num_bits;
+    if (repeats == 0) {
+        repeats = 1;
+    }
+    unsigned long bits = (unsigned long)num_bits * repeats;
+    volatile unsigned long sink = 0;
+
+    /** same random bits in both layouts (little-endian words). */
+    BitMap *bitmap = bitmap_new(num_bits);
+    BitMap *other = bitmap_new(num_bits);
+    LegacyBitMap *legacy = legacy_new(num_bits);
+    LegacyBitMap *legacy_other = legacy_new(num_bits);
+    srand(2019);
+    for (unsigned int i = 0; i < bitmap->num_words; ++i) {
+        bitmap->words[i] = ((word_t)rand() << 42) ^ ((word_t)rand() << 21) ^
+                           (word_t)rand();
+        other->words[i] = ((word_t)rand() << 42) ^ ((word_t)rand() << 21) ^
+                          (word_t)rand();
+    }
+    if (num_bits % BITS_PER_WORD != 0) {
+        word_t mask = ((word_t)1 << (num_bits % BITS_PER_WORD)) - 1;
+        bitmap->words[bitmap->num_words - 1] &= mask;
+        other->words[other->num_words - 1] &= mask;
+    }
+    memcpy(legacy->words, bitmap->words, legacy->num_words * 4);
+    memcpy(legacy_other->words, other->words, legacy->num_words * 4);
+
+    printf("%u bits, %lu repeats\n", num_bits, repeats);
+
+    double start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        sink += legacy_count(legacy);
+    }
+    double legacy_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        sink += bitmap_count(bitmap);
+    }
+    report("count", bits, legacy_time, bench_now() - start);
+
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        legacy_xor(legacy, legacy_other);
+    }
+    legacy_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        bitmap_xor(bitmap, other);
+    }
+    report("xor", bits, legacy_time, bench_now() - start);
+
+    /** iterate 1 bits: a get on every bit vs find next set. */
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        for (unsigned int i = 0; i < num_bits; ++i) {
+            if (legacy_get(legacy, i)) {
+                sink += i;
+            }
+        }
+    }
+    legacy_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        for (unsigned int i = bitmap_first_set(bitmap); i != BITMAP_NOT_FOUND;
+             i = bitmap_next_set(bitmap, i + 1)) {
+            sink += i;
+        }
+    }
+    report("iterate", bits, legacy_time, bench_now() - start);
+
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        LegacyBitMap *appended = legacy_new(0);
+        for (unsigned int i = 0; i < num_bits; ++i) {
+            legacy_append(appended, i & 1);
+        }
+        legacy_free(appended);
+    }
+    legacy_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        BitMap *appended = bitmap_new(0);
+        for (unsigned int i = 0; i < num_bits; ++i) {
+            bitmap_append(appended, i & 1);
+        }
+        bitmap_free(appended);
+    }
+    report("append", bits, legacy_time, bench_now() - start);
+
+    /** a byte at a time, as the huffman codes are written. */
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        LegacyBitMap *appended = legacy_new(0);
+        for (unsigned int i = 0; i < num_bits; i += 8) {
+            for (unsigned int j = 0; j < 8; ++j) {
+                legacy_append(appended, (i >> j) & 1);
+            }
+        }
+        legacy_free(appended);
+    }
+    legacy_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        BitMap *appended = bitmap_new(0);
+        for (unsigned int i = 0; i < num_bits; i += 8) {
+            bitmap_append_char(appended, (unsigned char)i);
+        }
+        bitmap_free(appended);
+    }
+    report("append8", bits, legacy_time, bench_now() - start);
+
+    /** concat at an odd offset, so every word is shifted. */
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        LegacyBitMap *head = legacy_new(3);
+        legacy_concat(head, legacy);
+        legacy_free(head);
+    }
+    legacy_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        BitMap *head = bitmap_new(3);
+        bitmap_concat(head, bitmap);
+        bitmap_free(head);
+    }
+    report("concat", bits, legacy_time, bench_now() - start);
+
+    /** rank and select have no former kernel, report their own speed. */
+    unsigned int count = bitmap_count(bitmap);
+    unsigned long queries = repeats < 64 ? 64 : repeats;
+    start = bench_now();
+    for (unsigned long q = 0; q < queries; ++q) {
+        unsigned int n = (unsigned int)(q * 2654435761u) % num_bits;
+        sink += bitmap_rank(bitmap, n);
+    }
+    double rank_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long q = 0; q < queries && count > 0; ++q) {
+        unsigned int k = (unsigned int)(q * 2654435761u) % count;
+        sink += bitmap_select(bitmap, k);
+    }
+    printf("  %-10s rank %10.0f  select %10.0f ns/query\n",
+           "rank",
+           rank_time * 1e9 / queries,
+           (bench_now() - start) * 1e9 / queries);
+
+    legacy_free(legacy_other);
+    legacy_free(legacy);
+    bitmap_free(other);
+    bitmap_free(bitmap);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long max_bits = bench_arg(argc, argv, 1, 1UL << 30);
+    for (unsigned long num_bits = 1024; num_bits <= max_bits;
+         num_bits *= 32) {
+        bench_size((unsigned int)num_bits);
+    }
+    return 0;
+}
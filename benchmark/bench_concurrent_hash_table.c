@@ -0,0 +1,171 @@
+/**
+ * @file bench_concurrent_hash_table.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark ConcurrentHashTable scaling vs a HashTable behind a
+ * single global mutex, with read-mostly and write-heavy mixes.
+ *
+ * Usage: bench_concurrent_hash_table [max_threads] [ops_per_thread] [keys]
+ *        (default 64 threads, 200000 ops, 1048576 keys)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "compare.h"
+#include "concurrent_hash_table.h"
+#include "hash.h"
+#include "hash_table.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    const char *name;
+    /** percentage of get, set; the rest are deletes. */
+    int get_percent;
+    int set_percent;
+} Mix;
+
+typedef struct {
+    ConcurrentHashTable *concurrent;
+    HashTable *locked;
+    pthread_mutex_t *mutex;
+    int *keys;
+    unsigned int num_keys;
+    unsigned long ops;
+    const Mix *mix;
+    unsigned int seed;
+} Worker;
+
+static inline unsigned int xorshift(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void *run_worker(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    unsigned int state = worker->seed;
+    for (unsigned long i = 0; i < worker->ops; ++i) {
+        unsigned int r = xorshift(&state);
+        int *key = &worker->keys[r % worker->num_keys];
+        int op = (int)((r >> 24) % 100);
+
+        if (worker->concurrent != NULL) {
+            if (op < worker->mix->get_percent) {
+                concurrent_hash_table_get(worker->concurrent, key);
+            } else if (op < worker->mix->get_percent +
+                                 worker->mix->set_percent) {
+                concurrent_hash_table_set(worker->concurrent, key, key);
+            } else {
+                concurrent_hash_table_delete(worker->concurrent, key);
+            }
+        } else {
+            pthread_mutex_lock(worker->mutex);
+            if (op < worker->mix->get_percent) {
+                hash_table_get(worker->locked, key);
+            } else if (op < worker->mix->get_percent +
+                                 worker->mix->set_percent) {
+                hash_table_set(worker->locked, key, key);
+            } else {
+                hash_table_delete(worker->locked, key);
+            }
+            pthread_mutex_unlock(worker->mutex);
+        }
+    }
+    return NULL;
+}
+
+static double bench_run(int concurrent,
+                        const Mix *mix,
+                        int *keys,
+                        unsigned int num_keys,
+                        int num_threads,
+                        unsigned long ops)
+{
+    ConcurrentHashTable *table = NULL;
+    HashTable *hash_table = NULL;
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    if (concurrent) {
+        table = concurrent_hash_table_new(hash_int, int_equal, NULL, NULL, 0);
+    } else {
+        hash_table = hash_table_new(hash_int, int_equal, NULL, NULL);
+    }
+    /** half of the keys are present at start. */
+    for (unsigned int i = 0; i < num_keys; i += 2) {
+        if (concurrent) {
+            concurrent_hash_table_insert(table, &keys[i], &keys[i]);
+        } else {
+            hash_table_insert(hash_table, &keys[i], &keys[i]);
+        }
+    }
+
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * num_threads);
+    Worker *workers = (Worker *)malloc(sizeof(Worker) * num_threads);
+    double start = bench_now();
+    for (int t = 0; t < num_threads; ++t) {
+        workers[t].concurrent = table;
+        workers[t].locked = hash_table;
+        workers[t].mutex = &mutex;
+        workers[t].keys = keys;
+        workers[t].num_keys = num_keys;
+        workers[t].ops = ops;
+        workers[t].mix = mix;
+        workers[t].seed = 2463534242u + t * 7919u;
+        pthread_create(&threads[t], NULL, run_worker, &workers[t]);
+    }
+    for (int t = 0; t < num_threads; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = bench_now() - start;
+
+    free(threads);
+    free(workers);
+    if (concurrent) {
+        concurrent_hash_table_free(table);
+    } else {
+        hash_table_free(hash_table);
+    }
+    return bench_mops((double)ops * num_threads, elapsed);
+}
+
+int main(int argc, char *argv[])
+{
+    int max_threads = (int)bench_arg(argc, argv, 1, 64);
+    unsigned long ops = bench_arg(argc, argv, 2, 200000);
+    unsigned int num_keys = (unsigned int)bench_arg(argc, argv, 3, 1 << 20);
+    Mix mixes[] = {{"read-mostly (90/9/1)", 90, 9},
+                   {"write-heavy (50/25/25)", 50, 25}};
+
+    int *keys = (int *)malloc(sizeof(int) * num_keys);
+    for (unsigned int i = 0; i < num_keys; ++i) {
+        keys[i] = (int)(i * 2654435761u);
+    }
+
+    for (int m = 0; m < 2; ++m) {
+        printf("%s, %lu ops per thread, %u keys\n",
+               mixes[m].name,
+               ops,
+               num_keys);
+        printf("%8s %16s %16s\n", "threads", "global mutex", "striped");
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            double locked =
+                bench_run(0, &mixes[m], keys, num_keys, threads, ops);
+            double striped =
+                bench_run(1, &mixes[m], keys, num_keys, threads, ops);
+            printf("%8d %9.2f Mops/s %9.2f Mops/s\n", threads, locked, striped);
+        }
+    }
+
+    free(keys);
+    return 0;
+}
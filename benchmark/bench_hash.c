@@ -0,0 +1,193 @@
+/**
+ * @file bench_hash.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark hash functions: quality and throughput.
+ *
+ * Usage: bench_hash [num_keys]   (default 1000000)
+ *
+ * Quality: keys are put into 2^16 buckets by masking (as HashTable does),
+ * chi2 / buckets should be close to 1.0. Avalanche reports the worst bias of
+ * an output bit flipping when one input bit flips, ideal is 0.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "hash.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_BUCKETS (1 << 16)
+
+typedef unsigned int (*HashFunc)(void *key);
+
+static void report_distribution(const char *name,
+                                const unsigned int *hashes,
+                                unsigned int n)
+{
+    static unsigned int buckets[NUM_BUCKETS];
+    memset(buckets, 0, sizeof(buckets));
+    for (unsigned int i = 0; i < n; ++i) {
+        ++buckets[hashes[i] & (NUM_BUCKETS - 1)];
+    }
+
+    double expect = (double)n / NUM_BUCKETS;
+    double chi2 = 0;
+    unsigned int max = 0;
+    for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+        double diff = buckets[i] - expect;
+        chi2 += diff * diff / expect;
+        if (buckets[i] > max) {
+            max = buckets[i];
+        }
+    }
+    printf("  %-28s chi2/buckets %10.3f  max bucket %6u (expect %.1f)\n",
+           name,
+           chi2 / NUM_BUCKETS,
+           max,
+           expect);
+}
+
+static void bench_quality(unsigned int n)
+{
+    unsigned int *hashes = (unsigned int *)malloc(sizeof(unsigned int) * n);
+    char buf[32];
+
+    printf("distribution of %u keys:\n", n);
+
+    for (unsigned int i = 0; i < n; ++i) {
+        unsigned int key = i * 1024; /** strided integers */
+        hashes[i] = hash_int(&key);
+    }
+    report_distribution("hash_int (stride 1024)", hashes, n);
+    for (unsigned int i = 0; i < n; ++i) {
+        unsigned int key = i * 1024;
+        hashes[i] = hash_int_mix(&key);
+    }
+    report_distribution("hash_int_mix (stride 1024)", hashes, n);
+
+    for (unsigned int i = 0; i < n; ++i) {
+        sprintf(buf, "user:%u", i);
+        hashes[i] = hash_string(buf);
+    }
+    report_distribution("hash_string (user:N)", hashes, n);
+    for (unsigned int i = 0; i < n; ++i) {
+        sprintf(buf, "user:%u", i);
+        hashes[i] = hash_string_fast(buf);
+    }
+    report_distribution("hash_string_fast (user:N)", hashes, n);
+
+    /** 64 bytes aligned fake pointers. */
+    for (unsigned int i = 0; i < n; ++i) {
+        hashes[i] = hash_object((void *)(uintptr_t)(0x10000000u + i * 64));
+    }
+    report_distribution("hash_object (aligned)", hashes, n);
+    for (unsigned int i = 0; i < n; ++i) {
+        hashes[i] = hash_object_mix((void *)(uintptr_t)(0x10000000u + i * 64));
+    }
+    report_distribution("hash_object_mix (aligned)", hashes, n);
+
+    free(hashes);
+}
+
+static void report_avalanche(const char *name, HashFunc func, int len)
+{
+    char key[17];
+    unsigned int flips[16 * 8][32];
+    const int rounds = 2000;
+    memset(flips, 0, sizeof(flips));
+    srand(2019);
+
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < len; ++i) {
+            /** two bits set, flipping one bit never makes a NUL. */
+            key[i] = (char)((rand() & 0xFF) | 0x11);
+        }
+        key[len] = '\0';
+        unsigned int origin = func(key);
+
+        for (int bit = 0; bit < len * 8; ++bit) {
+            key[bit / 8] ^= (char)(1 << (bit % 8));
+            unsigned int diff = origin ^ func(key);
+            for (int out = 0; out < 32; ++out) {
+                flips[bit][out] += (diff >> out) & 1;
+            }
+            key[bit / 8] ^= (char)(1 << (bit % 8));
+        }
+    }
+
+    double worst = 0;
+    for (int bit = 0; bit < len * 8; ++bit) {
+        for (int out = 0; out < 32; ++out) {
+            double bias = fabs((double)flips[bit][out] / rounds - 0.5);
+            if (bias > worst) {
+                worst = bias;
+            }
+        }
+    }
+    printf("  %-28s %2d bytes key, worst bias %.3f\n", name, len, worst);
+}
+
+static void bench_throughput()
+{
+    const size_t lengths[] = {4, 8, 16, 32, 64, 256, 1024, 65536};
+    const size_t total = 64 * 1024 * 1024; /** bytes hashed per case */
+    char *buffer = (char *)malloc(65536 + 1);
+    for (int i = 0; i < 65536; ++i) {
+        buffer[i] = (char)('a' + i % 26);
+    }
+
+    printf("throughput:\n");
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+        size_t len = lengths[l];
+        size_t rounds = total / len;
+        volatile unsigned int sink = 0;
+        buffer[len] = '\0';
+
+        double start = bench_now();
+        for (size_t r = 0; r < rounds; ++r) {
+            buffer[0] = (char)('a' + r % 26);
+            sink += hash_string(buffer);
+        }
+        double bkdr = bench_now() - start;
+
+        start = bench_now();
+        for (size_t r = 0; r < rounds; ++r) {
+            buffer[0] = (char)('a' + r % 26);
+            sink += (unsigned int)hash_bytes64(buffer, len, 0);
+        }
+        double fast = bench_now() - start;
+
+        printf("  %6zu bytes  hash_string %9.1f MB/s  hash_bytes64 %9.1f "
+               "MB/s\n",
+               len,
+               bench_mbps(total, bkdr),
+               bench_mbps(total, fast));
+        buffer[len] = (char)('a' + len % 26);
+        (void)sink;
+    }
+    free(buffer);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int n = (unsigned int)bench_arg(argc, argv, 1, 1000000);
+
+    bench_quality(n);
+
+    printf("avalanche:\n");
+    report_avalanche("hash_string", hash_string, 8);
+    report_avalanche("hash_string_fast", hash_string_fast, 8);
+    report_avalanche("hash_string", hash_string, 16);
+    report_avalanche("hash_string_fast", hash_string_fast, 16);
+
+    bench_throughput();
+    return 0;
+}
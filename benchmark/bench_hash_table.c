@@ -0,0 +1,200 @@
+/**
+ * @file bench_hash_table.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark HashTable engines: chaining vs open addressing, single vs
+ * batched lookups.
+ *
+ * Usage: bench_hash_table [max_keys]   (default 1000000, try 10000000)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "compare.h"
+#include "hash.h"
+#include "hash_table.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *engine_name(HashTableType type)
+{
+    return type == HASH_TABLE_OPEN_ADDRESSING ? "open-addressing" : "chaining";
+}
+
+static void bench_engine(HashTableType type,
+                         int *keys,
+                         int *misses,
+                         int *order,
+                         int n)
+{
+    HashTable *hash_table =
+        hash_table_new_with_type(type, hash_int, int_equal, NULL, NULL);
+
+    double start = bench_now();
+    for (int i = 0; i < n; ++i) {
+        hash_table_insert(hash_table, &keys[i], &keys[i]);
+    }
+    double insert_time = bench_now() - start;
+
+    long found = 0;
+    start = bench_now();
+    for (int i = 0; i < n; ++i) {
+        found += hash_table_get(hash_table, &keys[order[i] % n]) != NULL;
+    }
+    double hit_time = bench_now() - start;
+
+    start = bench_now();
+    for (int i = 0; i < n; ++i) {
+        found += hash_table_get(hash_table, &misses[i]) != NULL;
+    }
+    double miss_time = bench_now() - start;
+
+    printf("%10d %-16s insert %8.2f  hit %8.2f  miss %8.2f Mops/s\n",
+           n,
+           engine_name(type),
+           bench_mops(n, insert_time),
+           bench_mops(n, hit_time),
+           bench_mops(n, miss_time));
+
+    if (found != n) {
+        fprintf(stderr, "Error: found %ld keys, expect %d\n", found, n);
+    }
+    hash_table_free(hash_table);
+}
+
+/** random lookups one at a time vs hash_table_get_many by batches. */
+static void bench_batch(HashTableType type, int *keys, int *order, int n)
+{
+    HashTable *hash_table =
+        hash_table_new_with_type(type, hash_int, int_equal, NULL, NULL);
+    HashTableKey *lookups = (HashTableKey *)malloc(sizeof(HashTableKey) * n);
+    HashTableValue *values =
+        (HashTableValue *)malloc(sizeof(HashTableValue) * n);
+    for (int i = 0; i < n; ++i) {
+        hash_table_insert(hash_table, &keys[i], &keys[i]);
+        lookups[i] = &keys[order[i] % n];
+    }
+
+    long found = 0;
+    double start = bench_now();
+    for (int i = 0; i < n; ++i) {
+        values[i] = hash_table_get(hash_table, lookups[i]);
+    }
+    double single_time = bench_now() - start;
+    for (int i = 0; i < n; ++i) {
+        found += values[i] != NULL;
+    }
+
+    unsigned int batches[] = {16, 256, (unsigned int)n};
+    double batch_mops[3];
+    for (int b = 0; b < 3; ++b) {
+        start = bench_now();
+        for (unsigned int from = 0; from < (unsigned int)n;
+             from += batches[b]) {
+            unsigned int count = (unsigned int)n - from < batches[b]
+                                     ? (unsigned int)n - from
+                                     : batches[b];
+            hash_table_get_many(
+                hash_table, &lookups[from], count, &values[from]);
+        }
+        batch_mops[b] = bench_mops(n, bench_now() - start);
+        for (int i = 0; i < n; ++i) {
+            found += values[i] != NULL;
+        }
+    }
+
+    printf("%10d %-16s get %8.2f  get_many(16) %8.2f  (256) %8.2f  (all) "
+           "%8.2f Mops/s\n",
+           n,
+           engine_name(type),
+           bench_mops(n, single_time),
+           batch_mops[0],
+           batch_mops[1],
+           batch_mops[2]);
+
+    if (found != (long)n * 4) {
+        fprintf(stderr, "Error: found %ld keys, expect %d\n", found, n * 4);
+    }
+    free(lookups);
+    free(values);
+    hash_table_free(hash_table);
+}
+
+/** worst single insert latency, stop-the-world vs incremental rehash. */
+static void bench_rehash_latency(int *keys, int n, unsigned int step)
+{
+    HashTable *hash_table = hash_table_new(hash_int, int_equal, NULL, NULL);
+    hash_table_set_rehash_step(hash_table, step);
+
+    double worst = 0;
+    double start = bench_now();
+    for (int i = 0; i < n; ++i) {
+        double op_start = bench_now();
+        hash_table_insert(hash_table, &keys[i], &keys[i]);
+        double latency = bench_now() - op_start;
+        if (latency > worst) {
+            worst = latency;
+        }
+    }
+    double total = bench_now() - start;
+
+    printf("%10d rehash step %-4u insert %8.2f Mops/s  worst %10.3f ms\n",
+           n,
+           step,
+           bench_mops(n, total),
+           worst * 1e3);
+    hash_table_free(hash_table);
+}
+
+int main(int argc, char *argv[])
+{
+    int max_keys = (int)bench_arg(argc, argv, 1, 1000000);
+    int *keys = (int *)malloc(sizeof(int) * max_keys);
+    int *misses = (int *)malloc(sizeof(int) * max_keys);
+    int *order = (int *)malloc(sizeof(int) * max_keys);
+
+    /**
+     * distinct pseudo random keys: an odd multiplier is a bijection on 32
+     * bits, even numbers hit and odd numbers miss.
+     */
+    for (int i = 0; i < max_keys; ++i) {
+        keys[i] = (int)((unsigned int)(i * 2) * 2654435761u);
+        misses[i] = (int)((unsigned int)(i * 2 + 1) * 2654435761u);
+        order[i] = i;
+    }
+
+    /**
+     * lookup in shuffled order, otherwise chained entities allocated in
+     * insertion order would be visited sequentially.
+     */
+    srand(2019);
+    for (int i = max_keys - 1; i > 0; --i) {
+        int j = rand() % (i + 1);
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    for (int n = 1000; n <= max_keys; n *= 10) {
+        bench_engine(HASH_TABLE_CHAINING, keys, misses, order, n);
+        bench_engine(HASH_TABLE_OPEN_ADDRESSING, keys, misses, order, n);
+    }
+
+    for (int n = 1000; n <= max_keys; n *= 10) {
+        bench_batch(HASH_TABLE_CHAINING, keys, order, n);
+        bench_batch(HASH_TABLE_OPEN_ADDRESSING, keys, order, n);
+    }
+
+    bench_rehash_latency(keys, max_keys, 0);
+    bench_rehash_latency(keys, max_keys, 1);
+    bench_rehash_latency(keys, max_keys, 64);
+
+    free(keys);
+    free(misses);
+    free(order);
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file bench_helper.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Timing helpers shared by benchmarks.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_BENCH_HELPER_H
+#define RETHINK_C_BENCH_HELPER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Wall clock time in seconds.
+ *
+ * @return double   The monotonic time.
+ */
+static inline double bench_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Million operations per second.
+ *
+ * @param ops       The number of operations.
+ * @param seconds   The elapsed seconds.
+ * @return double   Mops/s.
+ */
+static inline double bench_mops(double ops, double seconds)
+{
+    return seconds > 0 ? ops / seconds / 1e6 : 0;
+}
+
+/**
+ * @brief Megabytes per second.
+ *
+ * @param bytes     The number of bytes.
+ * @param seconds   The elapsed seconds.
+ * @return double   MB/s.
+ */
+static inline double bench_mbps(double bytes, double seconds)
+{
+    return seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0;
+}
+
+/**
+ * @brief Parse an unsigned long argument, or use default value.
+ *
+ * @param argc          The argc of main.
+ * @param argv          The argv of main.
+ * @param index         The argument index.
+ * @param default_value The default value.
+ * @return unsigned long    The value.
+ */
+static inline unsigned long
+bench_arg(int argc, char *argv[], int index, unsigned long default_value)
+{
+    if (argc > index) {
+        return strtoul(argv[index], NULL, 10);
+    }
+    return default_value;
+}
+
+#endif /* RETHINK_C_BENCH_HELPER_H */
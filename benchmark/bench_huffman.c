@@ -0,0 +1,388 @@
+/**
+ * @file bench_huffman.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark Huffman encoding by a HuffmanTable against the former
+ * path, a HashTable of per-char BitMaps concatenated byte by byte; and
+ * decoding by a HuffmanDecodeTable against the former walk of the tree bit
+ * by bit; the time to build the canonical code lengths and their tables;
+ * and the scaling of the block stream from 1 to all online CPUs.
+ *
+ * Usage: bench_huffman [size] [file]
+ *        (default 16777216 bytes of each generated corpus; a file is
+ *        benchmarked as a further corpus, up to size bytes. The stream is
+ *        benchmarked on the english corpus of size bytes, give a size of
+ *        some GB for the scaling of large inputs)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "compare.h"
+#include "hash.h"
+#include "hash_table.h"
+#include "huffman.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** each measurement encodes about this many bytes, over repeats. */
+#define WORK_BYTES (1UL << 26)
+
+static const char *english_words[] = {
+    "the",  "of",    "and",   "to",     "a",       "in",    "is",
+    "that", "for",   "it",    "as",     "was",     "with",  "be",
+    "by",   "on",    "not",   "he",     "this",    "are",   "or",
+    "his",  "from",  "at",    "which",  "but",     "have",  "an",
+    "had",  "they",  "you",   "were",   "their",   "one",   "all",
+    "we",   "can",   "her",   "has",    "there",   "been",  "if",
+    "more", "when",  "will",  "would",  "who",     "so",    "no",
+    "time", "people", "world", "number", "between", "water", "Huffman",
+};
+
+static const char *source_tokens[] = {
+    "    ",   "\n",     "{",       "}",       "(",      ")",     ";",
+    " = ",    "int ",   "return ", "if (",    "for (",  "++i",   "NULL",
+    "->",     "node",   "bitmap",  "size",    "char *", "const ", "unsigned ",
+    "void ",  "static ", "0",      "1",       " < ",    ", ",    "/** ",
+    " */",    "free(",  "malloc(", "sizeof(", "struct ", "table", "words",
+};
+
+/** words of a Zipf-like rank, joined by spaces and punctuation. */
+static void fill_english(char *buffer, size_t size)
+{
+    size_t num_words = sizeof(english_words) / sizeof(english_words[0]);
+    size_t n = 0;
+    while (n < size) {
+        size_t rank = (size_t)rand() % num_words;
+        rank = rank * ((size_t)rand() % num_words) / num_words;
+        const char *word = english_words[rank];
+        for (size_t i = 0; word[i] != '\0' && n < size; ++i) {
+            buffer[n++] = word[i];
+        }
+        if (n < size) {
+            int r = rand() % 16;
+            buffer[n++] = r == 0 ? ',' : (r == 1 ? '.' : ' ');
+        }
+    }
+}
+
+static void fill_source(char *buffer, size_t size)
+{
+    size_t num_tokens = sizeof(source_tokens) / sizeof(source_tokens[0]);
+    size_t n = 0;
+    while (n < size) {
+        const char *token = source_tokens[(size_t)rand() % num_tokens];
+        for (size_t i = 0; token[i] != '\0' && n < size; ++i) {
+            buffer[n++] = token[i];
+        }
+    }
+}
+
+/** all 256 bytes, geometric: long codes for the rare ones. */
+static void fill_binary(char *buffer, size_t size)
+{
+    for (size_t n = 0; n < size; ++n) {
+        unsigned int r = (unsigned int)rand();
+        unsigned int shift = r % 8;
+        buffer[n] = (char)((r >> 8) & (0xFFu >> shift));
+    }
+}
+
+static void legacy_to_hash_table(const HuffmanNode *node,
+                                 HashTable *hash_table,
+                                 BitMap *bitmap)
+{
+    if (node->left != NULL) {
+        BitMap *left_bitmap = bitmap_clone(bitmap);
+        bitmap_append(left_bitmap, 0);
+        legacy_to_hash_table(node->left, hash_table, left_bitmap);
+    }
+    if (node->right != NULL) {
+        BitMap *right_bitmap = bitmap_clone(bitmap);
+        bitmap_append(right_bitmap, 1);
+        legacy_to_hash_table(node->right, hash_table, right_bitmap);
+    }
+    if (node->left == NULL && node->right == NULL) {
+        char *ch = (char *)malloc(sizeof(char));
+        *ch = node->value;
+        hash_table_insert(hash_table, ch, bitmap);
+    } else {
+        bitmap_free(bitmap);
+    }
+}
+
+/** the former huffman_encode_string. */
+static BitMap *
+legacy_encode(const HuffmanTree *tree, const char *string, unsigned int size)
+{
+    HashTable *hash_table = hash_table_new(
+        hash_char, char_equal, free, (HashTableFreeValueFunc)bitmap_free);
+    legacy_to_hash_table(tree->root, hash_table, bitmap_new(0));
+
+    BitMap *bitmap = bitmap_new(0);
+    for (unsigned int i = 0; i < size; ++i) {
+        BitMap *bits = (BitMap *)hash_table_get(hash_table, (void *)&string[i]);
+        bitmap_concat(bitmap, bits);
+    }
+    hash_table_free(hash_table);
+    return bitmap;
+}
+
+/** the former huffman_decode. */
+static Text *legacy_decode(const HuffmanTree *tree, const BitMap *bitmap)
+{
+    Text *text = text_new();
+    HuffmanNode *node = tree->root;
+    for (unsigned int i = 0; i < bitmap->num_bits; ++i) {
+        if (bitmap_get(bitmap, i)) {
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+        if (node->left == NULL && node->right == NULL) {
+            text_append(text, node->value);
+            node = tree->root;
+        }
+    }
+    return text;
+}
+
+static void bench_corpus(const char *name, const char *buffer, size_t size)
+{
+    unsigned long repeats = WORK_BYTES / size;
+    if (repeats == 0) {
+        repeats = 1;
+    }
+    double bytes = (double)size * repeats;
+    volatile unsigned long sink = 0;
+
+    Heap *heap = huffman_heap_from_string(buffer, (unsigned int)size);
+    HuffmanTree *tree = huffman_tree_from(heap);
+
+    double start = bench_now();
+    BitMap *expected = legacy_encode(tree, buffer, (unsigned int)size);
+    for (unsigned long r = 1; r < repeats; ++r) {
+        BitMap *code = legacy_encode(tree, buffer, (unsigned int)size);
+        sink += code->num_bits;
+        bitmap_free(code);
+    }
+    double legacy_time = bench_now() - start;
+
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        BitMap *code = huffman_encode_string(tree, buffer, (unsigned int)size);
+        if (r == 0 && !bitmap_equal(code, expected)) {
+            printf("  %s: code not equal to the former code!\n", name);
+        }
+        sink += code->num_bits;
+        bitmap_free(code);
+    }
+    double encode_time = bench_now() - start;
+
+    /** the table reused, into a buffer of the caller. */
+    HuffmanTable *table = huffman_table_new(tree);
+    uint64_t num_bits = huffman_table_encoded_bits(table, buffer, size);
+    word_t *words = (word_t *)malloc(
+        sizeof(word_t) * (num_bits / BITS_PER_WORD + 1));
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        sink += huffman_table_encode_to(table, buffer, size, words);
+    }
+    double table_time = bench_now() - start;
+
+    printf("%-8s %9lu bytes, %.3f bits/byte\n",
+           name,
+           (unsigned long)size,
+           (double)num_bits / size);
+    printf("  encode  legacy %8.1f  encode %8.1f  encode_to %8.1f MB/s  x%.1f\n",
+           bench_mbps(bytes, legacy_time),
+           bench_mbps(bytes, encode_time),
+           bench_mbps(bytes, table_time),
+           encode_time > 0 ? legacy_time / encode_time : 0);
+
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        Text *text = legacy_decode(tree, expected);
+        sink += text_length(text);
+        text_free(text);
+    }
+    legacy_time = bench_now() - start;
+
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        Text *text = huffman_decode(tree, expected);
+        if (r == 0 && (text_length(text) != size ||
+                       memcmp(text_char_string(text), buffer, size) != 0)) {
+            printf("  %s: decoded text not equal to the corpus!\n", name);
+        }
+        sink += text_length(text);
+        text_free(text);
+    }
+    double decode_time = bench_now() - start;
+
+    /** the decode table reused, into a buffer of the caller. */
+    HuffmanDecodeTable *decode_table = huffman_decode_table_new(tree);
+    char *output = (char *)malloc(size);
+    start = bench_now();
+    for (unsigned long r = 0; r < repeats; ++r) {
+        uint64_t position = 0;
+        sink += huffman_decode_to(decode_table,
+                                  expected->words,
+                                  expected->num_bits,
+                                  &position,
+                                  output,
+                                  size);
+    }
+    table_time = bench_now() - start;
+
+    printf("  decode  legacy %8.1f  decode %8.1f  decode_to %8.1f MB/s  x%.1f\n",
+           bench_mbps(bytes, legacy_time),
+           bench_mbps(bytes, decode_time),
+           bench_mbps(bytes, table_time),
+           decode_time > 0 ? legacy_time / decode_time : 0);
+
+    /** canonical codes of at most 15 bits, from the weights. */
+    uint64_t weights[256];
+    unsigned char lengths[256];
+    unsigned long builds = 1000;
+    huffman_count_weights(buffer, size, weights);
+    start = bench_now();
+    for (unsigned long r = 0; r < builds; ++r) {
+        huffman_code_lengths(weights, 15, lengths);
+    }
+    double lengths_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < builds; ++r) {
+        huffman_table_free(huffman_table_from_lengths(lengths));
+    }
+    double table_build_time = bench_now() - start;
+    start = bench_now();
+    for (unsigned long r = 0; r < builds; ++r) {
+        huffman_decode_table_free(huffman_decode_table_from_lengths(lengths));
+    }
+    double decode_build_time = bench_now() - start;
+    printf("  build   lengths %6.1f  table %6.1f  decode_table %6.1f us\n",
+           lengths_time * 1e6 / builds,
+           table_build_time * 1e6 / builds,
+           decode_build_time * 1e6 / builds);
+
+    free(output);
+    huffman_decode_table_free(decode_table);
+    free(words);
+    huffman_table_free(table);
+    bitmap_free(expected);
+    huffman_tree_free(tree);
+}
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+} StreamSink;
+
+static int stream_write(const void *data, size_t size, void *args)
+{
+    StreamSink *sink = (StreamSink *)args;
+    memcpy(sink->data + sink->size, data, size);
+    sink->size += size;
+    return 0;
+}
+
+/** the block stream, encoded and decoded on 1, 2, 4 ... threads. */
+static void bench_stream(const char *buffer, size_t size)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int max_threads = cpus < 1 ? 1 : (unsigned int)cpus;
+    if (max_threads > HUFFMAN_MAX_THREADS) {
+        max_threads = HUFFMAN_MAX_THREADS;
+    }
+
+    /** each block at most its raw size, plus headers and the index. */
+    size_t num_blocks = size / HUFFMAN_BLOCK_SIZE + 1;
+    StreamSink sink;
+    sink.data = (unsigned char *)malloc(
+        size + HUFFMAN_STREAM_HEADER_SIZE +
+        (num_blocks + 1) * (HUFFMAN_BLOCK_HEADER_SIZE + 8) + 8);
+    char *output = (char *)malloc(size);
+
+    printf("stream   %9lu bytes, %u online CPUs\n",
+           (unsigned long)size,
+           (unsigned int)(cpus < 1 ? 1 : cpus));
+    double encode_base = 0;
+    double decode_base = 0;
+    unsigned int threads = 1;
+    while (1) {
+        sink.size = 0;
+        double start = bench_now();
+        HuffmanEncoder *encoder =
+            huffman_encoder_new_threads(0, threads, stream_write, &sink);
+        huffman_encoder_write(encoder, buffer, size);
+        huffman_encoder_finish(encoder);
+        huffman_encoder_free(encoder);
+        double encode_time = bench_now() - start;
+
+        start = bench_now();
+        int result =
+            huffman_stream_decode(sink.data, sink.size, output, size, threads);
+        double decode_time = bench_now() - start;
+        if (result != 0 || memcmp(output, buffer, size) != 0) {
+            printf("  stream decode not equal to the corpus!\n");
+        }
+
+        if (threads == 1) {
+            encode_base = encode_time;
+            decode_base = decode_time;
+        }
+        printf("  threads %2u  encode %8.1f MB/s x%.2f  decode %8.1f MB/s "
+               "x%.2f\n",
+               threads,
+               bench_mbps((double)size, encode_time),
+               encode_time > 0 ? encode_base / encode_time : 0,
+               bench_mbps((double)size, decode_time),
+               decode_time > 0 ? decode_base / decode_time : 0);
+
+        if (threads == max_threads) {
+            break;
+        }
+        threads = threads * 2 < max_threads ? threads * 2 : max_threads;
+    }
+
+    free(output);
+    free(sink.data);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t size = bench_arg(argc, argv, 1, 1UL << 24);
+    char *buffer = (char *)malloc(size);
+
+    srand(2019);
+    fill_english(buffer, size);
+    bench_corpus("english", buffer, size);
+    bench_stream(buffer, size);
+    fill_source(buffer, size);
+    bench_corpus("source", buffer, size);
+    fill_binary(buffer, size);
+    bench_corpus("binary", buffer, size);
+
+    if (argc > 2) {
+        FILE *fin = fopen(argv[2], "rb");
+        if (fin == NULL) {
+            fprintf(stderr, "Error: Cannot open file [%s]\n", argv[2]);
+        } else {
+            size_t n = fread(buffer, 1, size, fin);
+            fclose(fin);
+            if (n > 0) {
+                bench_corpus(argv[2], buffer, n);
+            }
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,370 @@
+/**
+ * @file bench_lockfree_queue.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark SpscQueue and MpmcQueue against a Queue guarded by a
+ * mutex and condition variables, as the hand-off between threads.
+ *
+ * Throughput is measured for producer/consumer pairs, single and batched,
+ * latency as the mean round trip of a ping-pong over two queues.
+ *
+ * Usage: bench_lockfree_queue [ops] [max_pairs] [producer_cpu] [consumer_cpu]
+ *        (default 1000000 ops per producer, 4 pairs, not pinned; pass the
+ *        same cpu twice to share a core, different cpus to cross cores)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "mpmc_queue.h"
+#include "queue.h"
+#include "spsc_queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CAPACITY 1024
+#define MAX_BATCH 32
+
+/** a bounded Queue guarded by a mutex, the way pipeline threads used it. */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    Queue *queue;
+    unsigned int length;
+} LockedQueue;
+
+static void *locked_new()
+{
+    LockedQueue *locked = (LockedQueue *)malloc(sizeof(LockedQueue));
+    pthread_mutex_init(&(locked->lock), NULL);
+    pthread_cond_init(&(locked->not_empty), NULL);
+    pthread_cond_init(&(locked->not_full), NULL);
+    locked->queue = queue_new();
+    locked->length = 0;
+    return locked;
+}
+
+static void locked_free(void *queue)
+{
+    LockedQueue *locked = (LockedQueue *)queue;
+    queue_free(locked->queue);
+    pthread_cond_destroy(&(locked->not_full));
+    pthread_cond_destroy(&(locked->not_empty));
+    pthread_mutex_destroy(&(locked->lock));
+    free(locked);
+}
+
+/** blocks while full, then pushes as many as fit. */
+static unsigned int
+locked_push_many(void *queue, QueueValue *data, unsigned int count)
+{
+    LockedQueue *locked = (LockedQueue *)queue;
+    unsigned int pushed = 0;
+    pthread_mutex_lock(&(locked->lock));
+    while (locked->length == CAPACITY) {
+        pthread_cond_wait(&(locked->not_full), &(locked->lock));
+    }
+    while (pushed < count && locked->length < CAPACITY) {
+        queue_push_tail(locked->queue, data[pushed++]);
+        ++(locked->length);
+    }
+    pthread_cond_broadcast(&(locked->not_empty));
+    pthread_mutex_unlock(&(locked->lock));
+    return pushed;
+}
+
+/** blocks while empty, then pops as many as available. */
+static unsigned int
+locked_pop_many(void *queue, QueueValue *data, unsigned int count)
+{
+    LockedQueue *locked = (LockedQueue *)queue;
+    unsigned int popped = 0;
+    pthread_mutex_lock(&(locked->lock));
+    while (locked->length == 0) {
+        pthread_cond_wait(&(locked->not_empty), &(locked->lock));
+    }
+    while (popped < count && locked->length > 0) {
+        data[popped++] = queue_pop_head(locked->queue);
+        --(locked->length);
+    }
+    pthread_cond_broadcast(&(locked->not_full));
+    pthread_mutex_unlock(&(locked->lock));
+    return popped;
+}
+
+static void *spsc_new()
+{
+    return spsc_queue_new(CAPACITY);
+}
+
+static void spsc_free(void *queue)
+{
+    spsc_queue_free((SpscQueue *)queue);
+}
+
+static unsigned int
+spsc_push_many(void *queue, QueueValue *data, unsigned int count)
+{
+    if (count == 1) {
+        return spsc_queue_push((SpscQueue *)queue, data[0]) == 0;
+    }
+    return spsc_queue_push_many((SpscQueue *)queue, data, count);
+}
+
+static unsigned int
+spsc_pop_many(void *queue, QueueValue *data, unsigned int count)
+{
+    if (count == 1) {
+        return spsc_queue_pop((SpscQueue *)queue, data) == 0;
+    }
+    return spsc_queue_pop_many((SpscQueue *)queue, data, count);
+}
+
+static void *mpmc_new()
+{
+    return mpmc_queue_new(CAPACITY);
+}
+
+static void mpmc_free(void *queue)
+{
+    mpmc_queue_free((MpmcQueue *)queue);
+}
+
+static unsigned int
+mpmc_push_many(void *queue, QueueValue *data, unsigned int count)
+{
+    if (count == 1) {
+        return mpmc_queue_push((MpmcQueue *)queue, data[0]) == 0;
+    }
+    return mpmc_queue_push_many((MpmcQueue *)queue, data, count);
+}
+
+static unsigned int
+mpmc_pop_many(void *queue, QueueValue *data, unsigned int count)
+{
+    if (count == 1) {
+        return mpmc_queue_pop((MpmcQueue *)queue, data) == 0;
+    }
+    return mpmc_queue_pop_many((MpmcQueue *)queue, data, count);
+}
+
+typedef struct {
+    const char *name;
+    void *(*new_queue)();
+    void (*free_queue)(void *queue);
+    unsigned int (*push_many)(void *queue,
+                              QueueValue *data,
+                              unsigned int count);
+    unsigned int (*pop_many)(void *queue, QueueValue *data, unsigned int count);
+    /** 1 if many producers and consumers may share the queue. */
+    int shared;
+} Channel;
+
+static const Channel channels[] = {
+    {"mutex Queue", locked_new, locked_free, locked_push_many,
+     locked_pop_many, 1},
+    {"SpscQueue", spsc_new, spsc_free, spsc_push_many, spsc_pop_many, 0},
+    {"MpmcQueue", mpmc_new, mpmc_free, mpmc_push_many, mpmc_pop_many, 1},
+};
+
+typedef struct {
+    const Channel *channel;
+    void *queue;
+    /** the second queue of ping-pong. */
+    void *reply;
+    unsigned long ops;
+    unsigned int batch;
+    int cpu;
+} Worker;
+
+static void pin(int cpu)
+{
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+}
+
+static void *produce(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    QueueValue data[MAX_BATCH];
+    pin(worker->cpu);
+    for (unsigned int i = 0; i < MAX_BATCH; ++i) {
+        data[i] = worker;
+    }
+
+    unsigned long pushed = 0;
+    while (pushed < worker->ops) {
+        unsigned long count = worker->ops - pushed;
+        if (count > worker->batch) {
+            count = worker->batch;
+        }
+        unsigned int done = worker->channel->push_many(
+            worker->queue, data, (unsigned int)count);
+        if (done == 0) {
+            sched_yield();
+        }
+        pushed += done;
+    }
+    return NULL;
+}
+
+static void *consume(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    QueueValue data[MAX_BATCH];
+    pin(worker->cpu);
+
+    unsigned long popped = 0;
+    while (popped < worker->ops) {
+        unsigned long count = worker->ops - popped;
+        if (count > worker->batch) {
+            count = worker->batch;
+        }
+        unsigned int done = worker->channel->pop_many(
+            worker->queue, data, (unsigned int)count);
+        if (done == 0) {
+            sched_yield();
+        }
+        popped += done;
+    }
+    return NULL;
+}
+
+/** every consumer pops as many as a producer pushes, so all of them end. */
+static void bench_throughput(const Channel *channel,
+                             int pairs,
+                             unsigned int batch,
+                             unsigned long ops,
+                             int producer_cpu,
+                             int consumer_cpu)
+{
+    void *queue = channel->new_queue();
+    pthread_t threads[2 * pairs];
+    Worker workers[2 * pairs];
+
+    double start = bench_now();
+    for (int t = 0; t < 2 * pairs; ++t) {
+        workers[t].channel = channel;
+        workers[t].queue = queue;
+        workers[t].ops = ops;
+        workers[t].batch = batch;
+        workers[t].cpu = t < pairs ? producer_cpu : consumer_cpu;
+        pthread_create(
+            &threads[t], NULL, t < pairs ? produce : consume, &workers[t]);
+    }
+    for (int t = 0; t < 2 * pairs; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    double seconds = bench_now() - start;
+
+    printf("%-12s %dP/%dC batch %-3u %10.2f Mops/s\n",
+           channel->name,
+           pairs,
+           pairs,
+           batch,
+           bench_mops((double)ops * pairs, seconds));
+    channel->free_queue(queue);
+}
+
+static void *pong(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    QueueValue data;
+    pin(worker->cpu);
+    for (unsigned long i = 0; i < worker->ops; ++i) {
+        while (worker->channel->pop_many(worker->queue, &data, 1) == 0) {
+            sched_yield();
+        }
+        while (worker->channel->push_many(worker->reply, &data, 1) == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void bench_latency(const Channel *channel,
+                          unsigned long round_trips,
+                          int producer_cpu,
+                          int consumer_cpu)
+{
+    Worker worker;
+    worker.channel = channel;
+    worker.queue = channel->new_queue();
+    worker.reply = channel->new_queue();
+    worker.ops = round_trips;
+    worker.batch = 1;
+    worker.cpu = consumer_cpu;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, pong, &worker);
+    pin(producer_cpu);
+
+    QueueValue data = &worker;
+    double start = bench_now();
+    for (unsigned long i = 0; i < round_trips; ++i) {
+        while (channel->push_many(worker.queue, &data, 1) == 0) {
+            sched_yield();
+        }
+        while (channel->pop_many(worker.reply, &data, 1) == 0) {
+            sched_yield();
+        }
+    }
+    double seconds = bench_now() - start;
+    pthread_join(thread, NULL);
+
+    printf("%-12s ping-pong    %10.0f ns per round trip\n",
+           channel->name,
+           seconds * 1e9 / round_trips);
+    channel->free_queue(worker.reply);
+    channel->free_queue(worker.queue);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long ops = bench_arg(argc, argv, 1, 1000000);
+    int max_pairs = (int)bench_arg(argc, argv, 2, 4);
+    int producer_cpu = argc > 3 ? atoi(argv[3]) : -1;
+    int consumer_cpu = argc > 4 ? atoi(argv[4]) : producer_cpu;
+    unsigned int num_channels = sizeof(channels) / sizeof(Channel);
+
+    printf("%lu ops per producer, producer cpu %d, consumer cpu %d\n",
+           ops,
+           producer_cpu,
+           consumer_cpu);
+    for (unsigned int c = 0; c < num_channels; ++c) {
+        for (unsigned int batch = 1; batch <= MAX_BATCH; batch *= MAX_BATCH) {
+            bench_throughput(
+                &channels[c], 1, batch, ops, producer_cpu, consumer_cpu);
+        }
+    }
+    for (int pairs = 2; pairs <= max_pairs; pairs *= 2) {
+        for (unsigned int c = 0; c < num_channels; ++c) {
+            if (!channels[c].shared) {
+                continue;
+            }
+            for (unsigned int batch = 1; batch <= MAX_BATCH;
+                 batch *= MAX_BATCH) {
+                bench_throughput(&channels[c],
+                                 pairs,
+                                 batch,
+                                 ops,
+                                 producer_cpu,
+                                 consumer_cpu);
+            }
+        }
+    }
+    for (unsigned int c = 0; c < num_channels; ++c) {
+        bench_latency(&channels[c], ops / 10, producer_cpu, consumer_cpu);
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file bench_lz77.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark the compression ratio and speed of LZ77 blocks by level,
+ * against Huffman coding alone (level 0), block by block in one thread.
+ *
+ * Usage: bench_lz77 [size] [file]
+ *        (default 16777216 bytes of each generated corpus; a file is
+ *        benchmarked as a further corpus, up to size bytes)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "huffman.h"
+#include "lz77.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *log_levels[] = {"INFO", "INFO", "INFO", "WARN", "DEBUG",
+                                   "ERROR"};
+
+static const char *log_messages[] = {
+    "GET /api/v1/users 200",
+    "GET /api/v1/orders 200",
+    "POST /api/v1/orders 201",
+    "GET /static/app.js 304",
+    "connection reset by peer",
+    "cache miss, loading from database",
+    "slow query took",
+};
+
+static const char *english_words[] = {
+    "the",  "of",    "and",   "to",     "a",       "in",    "is",
+    "that", "for",   "it",    "as",     "was",     "with",  "be",
+    "by",   "on",    "not",   "he",     "this",    "are",   "or",
+    "his",  "from",  "at",    "which",  "but",     "have",  "an",
+    "had",  "they",  "you",   "were",   "their",   "one",   "all",
+    "we",   "can",   "her",   "has",    "there",   "been",  "if",
+    "more", "when",  "will",  "would",  "who",     "so",    "no",
+    "time", "people", "world", "number", "between", "water", "Huffman",
+};
+
+/** lines of a server log: timestamps, levels, hosts and messages. */
+static void fill_log(char *buffer, size_t size)
+{
+    size_t num_levels = sizeof(log_levels) / sizeof(log_levels[0]);
+    size_t num_messages = sizeof(log_messages) / sizeof(log_messages[0]);
+    size_t n = 0;
+    unsigned long millis = 0;
+    while (n < size) {
+        char line[160];
+        millis += (unsigned long)rand() % 50;
+        int length =
+            snprintf(line,
+                     sizeof(line),
+                     "2019-08-30T%02lu:%02lu:%02lu.%03lu [%s] 10.0.%d.%d %s %d\n",
+                     millis / 3600000 % 24,
+                     millis / 60000 % 60,
+                     millis / 1000 % 60,
+                     millis % 1000,
+                     log_levels[(size_t)rand() % num_levels],
+                     rand() % 4,
+                     rand() % 256,
+                     log_messages[(size_t)rand() % num_messages],
+                     rand() % 1000);
+        for (int i = 0; i < length && n < size; ++i) {
+            buffer[n++] = line[i];
+        }
+    }
+}
+
+/** words of a Zipf-like rank, joined by spaces and punctuation. */
+static void fill_english(char *buffer, size_t size)
+{
+    size_t num_words = sizeof(english_words) / sizeof(english_words[0]);
+    size_t n = 0;
+    while (n < size) {
+        size_t rank = (size_t)rand() % num_words;
+        rank = rank * ((size_t)rand() % num_words) / num_words;
+        const char *word = english_words[rank];
+        for (size_t i = 0; word[i] != '\0' && n < size; ++i) {
+            buffer[n++] = word[i];
+        }
+        if (n < size) {
+            int r = rand() % 16;
+            buffer[n++] = r == 0 ? ',' : (r == 1 ? '.' : ' ');
+        }
+    }
+}
+
+/** all 256 bytes, geometric: nothing repeats but by chance. */
+static void fill_binary(char *buffer, size_t size)
+{
+    for (size_t n = 0; n < size; ++n) {
+        unsigned int r = (unsigned int)rand();
+        unsigned int shift = r % 8;
+        buffer[n] = (char)((r >> 8) & (0xFFu >> shift));
+    }
+}
+
+static void bench_corpus(const char *name, const char *buffer, size_t size)
+{
+    size_t num_blocks = (size + HUFFMAN_BLOCK_SIZE - 1) / HUFFMAN_BLOCK_SIZE;
+    unsigned char *blocks = (unsigned char *)malloc(
+        num_blocks * huffman_block_bound(HUFFMAN_BLOCK_SIZE));
+    size_t *block_sizes = (size_t *)malloc(sizeof(size_t) * num_blocks);
+    char *output = (char *)malloc(size);
+
+    printf("%-8s %9lu bytes\n", name, (unsigned long)size);
+    for (int level = 0; level <= LZ77_MAX_LEVEL; ++level) {
+        Lz77Params params;
+        lz77_params_from_level(level, &params);
+
+        double start = bench_now();
+        size_t compressed = 0;
+        for (size_t b = 0; b < num_blocks; ++b) {
+            size_t offset = b * HUFFMAN_BLOCK_SIZE;
+            size_t count = size - offset < HUFFMAN_BLOCK_SIZE
+                               ? size - offset
+                               : HUFFMAN_BLOCK_SIZE;
+            unsigned char *block =
+                blocks + b * huffman_block_bound(HUFFMAN_BLOCK_SIZE);
+            block_sizes[b] =
+                level == 0
+                    ? huffman_block_encode(buffer + offset, count, block)
+                    : lz77_block_encode(buffer + offset, count, &params, block);
+            compressed += block_sizes[b];
+        }
+        double encode_time = bench_now() - start;
+
+        start = bench_now();
+        int result = 0;
+        for (size_t b = 0; b < num_blocks; ++b) {
+            const unsigned char *block =
+                blocks + b * huffman_block_bound(HUFFMAN_BLOCK_SIZE);
+            char *raw = output + b * HUFFMAN_BLOCK_SIZE;
+            result |= level == 0
+                          ? huffman_block_decode(block, block_sizes[b], raw)
+                          : lz77_block_decode(block, block_sizes[b], raw);
+        }
+        double decode_time = bench_now() - start;
+        if (result != 0 || memcmp(output, buffer, size) != 0) {
+            printf("  level %d: decoded not equal to the corpus!\n", level);
+        }
+
+        printf("  level %d  %6.2f%%  x%5.2f  encode %8.1f MB/s  decode %8.1f "
+               "MB/s\n",
+               level,
+               100.0 * compressed / size,
+               (double)size / compressed,
+               bench_mbps((double)size, encode_time),
+               bench_mbps((double)size, decode_time));
+    }
+
+    free(output);
+    free(block_sizes);
+    free(blocks);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t size = bench_arg(argc, argv, 1, 1UL << 24);
+    char *buffer = (char *)malloc(size);
+
+    srand(2019);
+    fill_log(buffer, size);
+    bench_corpus("log", buffer, size);
+    fill_english(buffer, size);
+    bench_corpus("english", buffer, size);
+    fill_binary(buffer, size);
+    bench_corpus("binary", buffer, size);
+
+    if (argc > 2) {
+        FILE *fin = fopen(argv[2], "rb");
+        if (fin == NULL) {
+            fprintf(stderr, "Error: Cannot open file [%s]\n", argv[2]);
+        } else {
+            size_t n = fread(buffer, 1, size, fin);
+            fclose(fin);
+            if (n > 0) {
+                bench_corpus(argv[2], buffer, n);
+            }
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file bench_prime.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark the segmented prime sieve against prime_number_sieve, and
+ * the segmented sieve with one thread against several, up to 10^10; then
+ * PrimeWheel memory and queries (pi(n), nth prime, primality) to 10^9.
+ *
+ * Usage: bench_prime [max_number] [num_threads]
+ *        (default 10000000000 and the number of online CPUs, at least 2;
+ *        prime_number_sieve only runs up to 10^9, its BitMap is 60 MB there)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "prime.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/** the largest number prime_number_sieve is run up to. */
+#define MAX_WHOLE_SIEVE 1000000000UL
+
+static int sum_prime(uint64_t prime, void *args)
+{
+    *(uint64_t *)args += prime;
+    return 0;
+}
+
+static void bench_limit(uint64_t limit, unsigned int num_threads)
+{
+    printf("primes below %llu\n", (unsigned long long)limit);
+
+    double whole = 0;
+    if (limit <= MAX_WHOLE_SIEVE) {
+        double start = bench_now();
+        BitMap *sieve = prime_number_sieve((unsigned int)(limit - 1));
+        unsigned int count = prime_number_sieve_count(sieve);
+        whole = bench_now() - start;
+        prime_number_sieve_free(sieve);
+        printf("  %-22s %12u  %8.3f s\n", "whole sieve", count, whole);
+    }
+
+    double start = bench_now();
+    int64_t count = prime_segmented_count(0, limit, 1);
+    double single = bench_now() - start;
+    printf("  %-22s %12lld  %8.3f s",
+           "segmented, 1 thread",
+           (long long)count,
+           single);
+    if (whole > 0) {
+        printf("  x%.1f", whole / single);
+    }
+    printf("\n");
+
+    start = bench_now();
+    count = prime_segmented_count(0, limit, num_threads);
+    double multi = bench_now() - start;
+    printf("  segmented, %2u threads  %12lld  %8.3f s  x%.1f\n",
+           num_threads,
+           (long long)count,
+           multi,
+           single / multi);
+
+    /** streaming every prime to a callback, in order. */
+    uint64_t sum = 0;
+    start = bench_now();
+    count = prime_segmented_sieve(0, limit, num_threads, sum_prime, &sum);
+    double stream = bench_now() - start;
+    printf("  %-22s %12lld  %8.3f s  %.0f M primes/s\n",
+           "segmented, callback",
+           (long long)count,
+           stream,
+           bench_mops((double)count, stream));
+}
+
+/** the number of random queries of each kind. */
+#define NUM_QUERIES 1000000
+
+static uint64_t random_number(uint64_t *state, uint64_t limit)
+{
+    /** xorshift64 */
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state % limit;
+}
+
+static void bench_wheel(uint64_t limit)
+{
+    printf("primes up to %llu, %d random queries\n",
+           (unsigned long long)limit,
+           NUM_QUERIES);
+
+    double start = bench_now();
+    BitMap *sieve = prime_number_sieve((unsigned int)limit);
+    double sieve_time = bench_now() - start;
+    start = bench_now();
+    PrimeWheel *wheel = prime_wheel_new(limit);
+    double wheel_time = bench_now() - start;
+    printf("  %-12s sieve %8.3f s %8.1f MB  wheel %8.3f s %8.1f MB\n",
+           "build",
+           sieve_time,
+           sieve->capacity * sizeof(word_t) / 1e6,
+           wheel_time,
+           (wheel->num_words * sizeof(word_t) +
+            (wheel->num_words / 8 + 1) * sizeof(uint64_t)) /
+               1e6);
+
+    /** pi(n): a rank over the odd-only sieve vs the block counts. */
+    volatile uint64_t sink = 0;
+    uint64_t state = 2019;
+    unsigned int rank_queries = NUM_QUERIES / 1000;
+    start = bench_now();
+    for (unsigned int i = 0; i < rank_queries; ++i) {
+        uint64_t n = random_number(&state, limit - 3) + 3;
+        sink += bitmap_rank(sieve, (unsigned int)((n - 1) / 2));
+    }
+    double rank_time = (bench_now() - start) / rank_queries;
+    start = bench_now();
+    for (unsigned int i = 0; i < NUM_QUERIES; ++i) {
+        sink += prime_wheel_count(wheel, random_number(&state, limit));
+    }
+    double count_time = (bench_now() - start) / NUM_QUERIES;
+    printf("  %-12s sieve %10.0f ns     wheel %10.0f ns  x%.0f\n",
+           "pi(n)",
+           rank_time * 1e9,
+           count_time * 1e9,
+           rank_time / count_time);
+
+    start = bench_now();
+    for (unsigned int i = 0; i < NUM_QUERIES; ++i) {
+        sink += prime_wheel_nth(
+            wheel, random_number(&state, wheel->num_primes) + 1);
+    }
+    printf("  %-12s wheel %10.0f ns\n",
+           "nth prime",
+           (bench_now() - start) * 1e9 / NUM_QUERIES);
+
+    /** in range a lookup, past it Miller-Rabin on odd 64-bit numbers. */
+    start = bench_now();
+    for (unsigned int i = 0; i < NUM_QUERIES; ++i) {
+        uint64_t n = random_number(&state, limit);
+        sink += prime_number_sieve_check(sieve, (unsigned int)n);
+    }
+    double check_time = (bench_now() - start) / NUM_QUERIES;
+    start = bench_now();
+    for (unsigned int i = 0; i < NUM_QUERIES; ++i) {
+        sink += prime_wheel_is_prime(wheel, random_number(&state, limit));
+    }
+    double lookup_time = (bench_now() - start) / NUM_QUERIES;
+    start = bench_now();
+    for (unsigned int i = 0; i < NUM_QUERIES; ++i) {
+        uint64_t n = random_number(&state, UINT64_MAX) | 1;
+        sink += prime_wheel_is_prime(wheel, n);
+    }
+    printf("  %-12s sieve %10.0f ns     wheel %10.0f ns  "
+           "Miller-Rabin %.0f ns\n",
+           "is prime",
+           check_time * 1e9,
+           lookup_time * 1e9,
+           (bench_now() - start) * 1e9 / NUM_QUERIES);
+
+    prime_wheel_free(wheel);
+    prime_number_sieve_free(sieve);
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t max_number = bench_arg(argc, argv, 1, 10000000000UL);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int num_threads =
+        (unsigned int)bench_arg(argc, argv, 2, cpus > 2 ? cpus : 2);
+    for (uint64_t limit = 10000000; limit <= max_number; limit *= 10) {
+        bench_limit(limit, num_threads);
+    }
+    bench_wheel(max_number < MAX_WHOLE_SIEVE ? max_number : MAX_WHOLE_SIEVE);
+    return 0;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file bench_ring_queue.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark RingQueue vs the linked Queue, as the BFS frontier of a
+ * random sparse graph and as a plain FIFO.
+ *
+ * Usage: bench_ring_queue [vertexes] [degree]   (default 1000000, 8)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "dup.h"
+#include "queue.h"
+#include "ring_queue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BULK 256
+
+/** a random graph in compressed sparse rows: arcs of v are
+ * targets[offsets[v]] to targets[offsets[v + 1] - 1]. */
+typedef struct {
+    int num_vertexes;
+    int *offsets;
+    int *targets;
+} Graph;
+
+static Graph *graph_new(int num_vertexes, int degree)
+{
+    Graph *graph = (Graph *)malloc(sizeof(Graph));
+    graph->num_vertexes = num_vertexes;
+    graph->offsets = (int *)malloc(sizeof(int) * (num_vertexes + 1));
+    graph->targets = (int *)malloc(sizeof(int) * num_vertexes * degree);
+    srand(2019);
+    for (int v = 0; v <= num_vertexes; ++v) {
+        graph->offsets[v] = v * degree;
+    }
+    for (long i = 0; i < (long)num_vertexes * degree; ++i) {
+        graph->targets[i] =
+            (int)(((unsigned long)rand() * RAND_MAX + rand()) % num_vertexes);
+    }
+    return graph;
+}
+
+static void graph_free(Graph *graph)
+{
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph);
+}
+
+/** the boxed way: every queued vertex is an intdup'd int in a QueueNode. */
+static long bfs_queue_boxed(const Graph *graph, int *dist)
+{
+    long sum = 0;
+    Queue *queue = queue_new();
+    dist[0] = 0;
+    queue_push_tail(queue, intdup(0));
+    while (!queue_is_empty(queue)) {
+        int *boxed = (int *)queue_pop_head(queue);
+        int v = *boxed;
+        free(boxed);
+        sum += dist[v];
+        for (int i = graph->offsets[v]; i < graph->offsets[v + 1]; ++i) {
+            int w = graph->targets[i];
+            if (dist[w] < 0) {
+                dist[w] = dist[v] + 1;
+                queue_push_tail(queue, intdup(w));
+            }
+        }
+    }
+    queue_free(queue);
+    return sum;
+}
+
+/** the best case of a linked Queue: slab nodes, vertexes as pointers into
+ * an array, so nothing is boxed. */
+static long bfs_queue_slab(const Graph *graph, int *dist, int *ids)
+{
+    long sum = 0;
+    Queue *queue = queue_new_with_slab(0);
+    dist[0] = 0;
+    queue_push_tail(queue, &ids[0]);
+    while (!queue_is_empty(queue)) {
+        int v = *(int *)queue_pop_head(queue);
+        sum += dist[v];
+        for (int i = graph->offsets[v]; i < graph->offsets[v + 1]; ++i) {
+            int w = graph->targets[i];
+            if (dist[w] < 0) {
+                dist[w] = dist[v] + 1;
+                queue_push_tail(queue, &ids[w]);
+            }
+        }
+    }
+    queue_free(queue);
+    return sum;
+}
+
+static long bfs_ring_queue(const Graph *graph, int *dist)
+{
+    long sum = 0;
+    RingQueue *queue = ring_queue_new(sizeof(int), 0);
+    int v = 0;
+    dist[0] = 0;
+    ring_queue_push_tail(queue, &v);
+    while (ring_queue_pop_head(queue, &v) == 0) {
+        sum += dist[v];
+        for (int i = graph->offsets[v]; i < graph->offsets[v + 1]; ++i) {
+            int w = graph->targets[i];
+            if (dist[w] < 0) {
+                dist[w] = dist[v] + 1;
+                ring_queue_push_tail(queue, &w);
+            }
+        }
+    }
+    ring_queue_free(queue);
+    return sum;
+}
+
+/** pop BULK vertexes at a time, push each vertex's new neighbours at once. */
+static long bfs_ring_queue_bulk(const Graph *graph, int *dist)
+{
+    long sum = 0;
+    RingQueue *queue = ring_queue_new(sizeof(int), 0);
+    int frontier[BULK];
+    int *found = (int *)malloc(sizeof(int) * graph->num_vertexes);
+    unsigned int count;
+    frontier[0] = 0;
+    dist[0] = 0;
+    ring_queue_push_tail(queue, frontier);
+    while ((count = ring_queue_pop_head_many(queue, frontier, BULK)) > 0) {
+        int num_found = 0;
+        for (unsigned int k = 0; k < count; ++k) {
+            int v = frontier[k];
+            sum += dist[v];
+            for (int i = graph->offsets[v]; i < graph->offsets[v + 1]; ++i) {
+                int w = graph->targets[i];
+                if (dist[w] < 0) {
+                    dist[w] = dist[v] + 1;
+                    found[num_found++] = w;
+                }
+            }
+        }
+        ring_queue_push_tail_many(queue, found, num_found);
+    }
+    free(found);
+    ring_queue_free(queue);
+    return sum;
+}
+
+typedef enum { BOXED, SLAB, RING, RING_BULK } Variant;
+
+static const char *variant_names[] = {"Queue (intdup)",
+                                      "Queue (slab, unboxed)",
+                                      "RingQueue",
+                                      "RingQueue (bulk)"};
+
+static void bench_bfs(const Graph *graph, Variant variant, int *dist, int *ids)
+{
+    for (int i = 0; i < graph->num_vertexes; ++i) {
+        dist[i] = -1;
+    }
+
+    double start = bench_now();
+    long sum = 0;
+    switch (variant) {
+    case BOXED:
+        sum = bfs_queue_boxed(graph, dist);
+        break;
+    case SLAB:
+        sum = bfs_queue_slab(graph, dist, ids);
+        break;
+    case RING:
+        sum = bfs_ring_queue(graph, dist);
+        break;
+    case RING_BULK:
+        sum = bfs_ring_queue_bulk(graph, dist);
+        break;
+    }
+    double seconds = bench_now() - start;
+
+    int reached = 0;
+    for (int i = 0; i < graph->num_vertexes; ++i) {
+        reached += dist[i] >= 0;
+    }
+    printf("bfs  %-24s %8.3f s  %8.2f Mvertexes/s  (reached %d, sum %ld)\n",
+           variant_names[variant],
+           seconds,
+           bench_mops(reached, seconds),
+           reached,
+           sum);
+}
+
+static volatile long bench_sink;
+
+/** a steady FIFO of `window` ints, n pushes and n pops. */
+static void bench_fifo(int n, int window)
+{
+    static int ids[1];
+    double start = bench_now();
+    Queue *queue = queue_new_with_slab(0);
+    for (int i = 0; i < n; ++i) {
+        queue_push_tail(queue, &ids[0]);
+        if (i >= window) {
+            queue_pop_head(queue);
+        }
+    }
+    while (!queue_is_empty(queue)) {
+        queue_pop_head(queue);
+    }
+    queue_free(queue);
+    double queue_time = bench_now() - start;
+
+    long sum = 0;
+    start = bench_now();
+    RingQueue *ring = ring_queue_new(sizeof(int), 0);
+    for (int i = 0; i < n; ++i) {
+        int value;
+        ring_queue_push_tail(ring, &i);
+        if (i >= window) {
+            ring_queue_pop_head(ring, &value);
+            sum += value;
+        }
+    }
+    while (!ring_queue_is_empty(ring)) {
+        int value;
+        ring_queue_pop_head(ring, &value);
+        sum += value;
+    }
+    ring_queue_free(ring);
+    double ring_time = bench_now() - start;
+
+    /** keep the popped values alive. */
+    bench_sink = sum;
+    printf("fifo window %-8d Queue (slab) %8.2f  RingQueue %8.2f Mops/s\n",
+           window,
+           bench_mops(2.0 * n, queue_time),
+           bench_mops(2.0 * n, ring_time));
+}
+
+int main(int argc, char *argv[])
+{
+    int num_vertexes = (int)bench_arg(argc, argv, 1, 1000000);
+    int degree = (int)bench_arg(argc, argv, 2, 8);
+
+    Graph *graph = graph_new(num_vertexes, degree);
+    int *dist = (int *)malloc(sizeof(int) * num_vertexes);
+    int *ids = (int *)malloc(sizeof(int) * num_vertexes);
+    for (int i = 0; i < num_vertexes; ++i) {
+        ids[i] = i;
+    }
+
+    printf("random graph: %d vertexes, out degree %d\n", num_vertexes, degree);
+    for (int variant = BOXED; variant <= RING_BULK; ++variant) {
+        bench_bfs(graph, (Variant)variant, dist, ids);
+    }
+
+    for (int window = 16; window <= 1000000; window *= 250) {
+        bench_fifo(10000000, window);
+    }
+
+    free(ids);
+    free(dist);
+    graph_free(graph);
+    return 0;
+}
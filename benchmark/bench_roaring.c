@@ -0,0 +1,168 @@
+/**
+ * @file bench_roaring.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark Roaring against a dense BitMap: memory, and/or/andnot
+ * and iteration, for sparse, medium, dense and clustered sets.
+ *
+ * Usage: bench_roaring [universe_bits]   (default 268435456, 2^28; 2^32 - 1
+ *        for the full range costs 512 MB per BitMap)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "bitmap.h"
+#include "roaring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/** each timing repeats an operation for at least this many seconds. */
+#define MIN_SECONDS 0.2
+
+typedef enum { SPARSE, MEDIUM, DENSE, CLUSTERED } Density;
+
+static const char *density_names[] = {
+    "sparse (4096 ids)", "medium (1%)", "dense (50%)", "clustered runs"};
+
+static uint32_t random_value(uint32_t universe)
+{
+    uint32_t value = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    return value % universe;
+}
+
+static void
+fill(Roaring *roaring, BitMap *bitmap, uint32_t universe, Density density)
+{
+    uint64_t count = 0;
+    switch (density) {
+    case SPARSE:
+        count = 4096;
+        break;
+    case MEDIUM:
+        count = universe / 100;
+        break;
+    case DENSE:
+        count = universe / 2;
+        break;
+    case CLUSTERED:
+        /** ranges of about 1000 ids, 1% of the universe in all. */
+        for (uint64_t i = 0; i < universe / 100000; ++i) {
+            uint32_t start = random_value(universe - 2000);
+            uint32_t end = start + 500 + rand() % 1000;
+            roaring_add_range(roaring, start, end);
+            for (uint32_t value = start; value < end; ++value) {
+                bitmap_set(bitmap, value);
+            }
+        }
+        return;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        uint32_t value = random_value(universe);
+        roaring_add(roaring, value);
+        bitmap_set(bitmap, value);
+    }
+}
+
+typedef Roaring *(*RoaringOp)(const Roaring *, const Roaring *);
+typedef void (*BitMapOp)(BitMap *, const BitMap *);
+
+/** seconds per operation, the result is a new set for both. */
+static double time_bitmap_op(BitMapOp op, const BitMap *a, const BitMap *b)
+{
+    unsigned long repeats = 0;
+    double start = bench_now();
+    double seconds;
+    do {
+        BitMap *result = bitmap_clone(a);
+        op(result, b);
+        bitmap_free(result);
+        ++repeats;
+    } while ((seconds = bench_now() - start) < MIN_SECONDS);
+    return seconds / repeats;
+}
+
+static double time_roaring_op(RoaringOp op, const Roaring *a, const Roaring *b)
+{
+    unsigned long repeats = 0;
+    double start = bench_now();
+    double seconds;
+    do {
+        roaring_free(op(a, b));
+        ++repeats;
+    } while ((seconds = bench_now() - start) < MIN_SECONDS);
+    return seconds / repeats;
+}
+
+static void bench_density(uint32_t universe, Density density)
+{
+    srand(2019);
+    BitMap *bitmap1 = bitmap_new(universe);
+    BitMap *bitmap2 = bitmap_new(universe);
+    Roaring *roaring1 = roaring_new();
+    Roaring *roaring2 = roaring_new();
+    fill(roaring1, bitmap1, universe, density);
+    fill(roaring2, bitmap2, universe, density);
+    roaring_run_optimize(roaring1);
+    roaring_run_optimize(roaring2);
+
+    printf("%s, %llu values\n",
+           density_names[density],
+           (unsigned long long)roaring_cardinality(roaring1));
+    printf("  %-10s BitMap %12.1f KB  Roaring %12.1f KB\n",
+           "memory",
+           bitmap1->capacity * sizeof(word_t) / 1024.0,
+           roaring_size_in_bytes(roaring1) / 1024.0);
+
+    const char *names[] = {"and", "or", "andnot"};
+    BitMapOp bitmap_ops[] = {bitmap_and, bitmap_or, bitmap_andnot};
+    RoaringOp roaring_ops[] = {roaring_and, roaring_or, roaring_andnot};
+    for (int i = 0; i < 3; ++i) {
+        double dense = time_bitmap_op(bitmap_ops[i], bitmap1, bitmap2);
+        double roaring = time_roaring_op(roaring_ops[i], roaring1, roaring2);
+        printf("  %-10s BitMap %12.1f us  Roaring %12.1f us  x%.1f\n",
+               names[i],
+               dense * 1e6,
+               roaring * 1e6,
+               dense / roaring);
+    }
+
+    volatile uint64_t sink = 0;
+    double start = bench_now();
+    for (unsigned int i = bitmap_first_set(bitmap1); i != BITMAP_NOT_FOUND;
+         i = bitmap_next_set(bitmap1, i + 1)) {
+        sink += i;
+    }
+    double dense = bench_now() - start;
+    RoaringIterator iterator;
+    uint32_t value;
+    start = bench_now();
+    roaring_iterate(roaring1, &iterator);
+    while (roaring_iter_next(&iterator, &value)) {
+        sink += value;
+    }
+    double roaring = bench_now() - start;
+    double values = (double)roaring_cardinality(roaring1);
+    printf("  %-10s BitMap %12.1f M/s  Roaring %12.1f M/s\n",
+           "iterate",
+           bench_mops(values, dense),
+           bench_mops(values, roaring));
+
+    roaring_free(roaring2);
+    roaring_free(roaring1);
+    bitmap_free(bitmap2);
+    bitmap_free(bitmap1);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t universe = (uint32_t)bench_arg(argc, argv, 1, 1UL << 28);
+    printf("universe %u\n", universe);
+    for (Density density = SPARSE; density <= CLUSTERED; ++density) {
+        bench_density(universe, density);
+    }
+    return 0;
+}
@@ -0,0 +1,259 @@
+/**
+ * @file bench_search.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Benchmark substring search over a log and a DNA corpus: all matches
+ * of patterns of 1 to 256 bytes, by KMP, BM and Sunday called again after
+ * each match, against search.h by each algorithm and by its dispatcher.
+ *
+ * The corpora are generated: log lines of timestamps, levels, threads,
+ * requests, paths and addresses, and DNA of ACGT with mutated repeats.
+ * Files given are benchmarked as corpora too, e.g. a real log or FASTA.
+ * The patterns are taken from the corpus at random; "picked" is the choice
+ * of search_choose, "!" a count differing from it.
+ *
+ * Usage: bench_search [megabytes] [file...]
+ *        (default 16 MB corpora)
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "bench_helper.h"
+#include "bm.h"
+#include "kmp.h"
+#include "search.h"
+#include "sunday.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Run a search at least this long for its time. */
+#define BENCH_MIN_SECONDS 0.1
+
+typedef int (*MatchFunc)(const char *text,
+                         unsigned int text_len,
+                         const char *pattern,
+                         unsigned int pat_len);
+
+/** all matches by a first match function, called again after each. */
+static unsigned int match_all_by_first(MatchFunc match,
+                                       const char *text,
+                                       unsigned int text_len,
+                                       const char *pattern,
+                                       unsigned int pat_len)
+{
+    unsigned int count = 0;
+    unsigned int offset = 0;
+    while (text_len - offset >= pat_len) {
+        int index = match(text + offset, text_len - offset, pattern, pat_len);
+        if (index < 0) {
+            break;
+        }
+        ++count;
+        offset += (unsigned int)index + 1;
+    }
+    return count;
+}
+
+/** MB/s of all matches, by match or else by algorithm; count to *count. */
+static double bench_run(MatchFunc match,
+                        SearchAlgorithm algorithm,
+                        const char *text,
+                        unsigned int text_len,
+                        const char *pattern,
+                        unsigned int pat_len,
+                        unsigned int *count)
+{
+    size_t runs = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        if (match != NULL) {
+            *count = match_all_by_first(
+                match, text, text_len, pattern, pat_len);
+        } else {
+            *count = search_text_match_all_by(
+                algorithm, text, text_len, pattern, pat_len, NULL, 0);
+        }
+        ++runs;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return bench_mbps((double)text_len * runs, elapsed);
+}
+
+/** log lines to size bytes. */
+static char *generate_log(unsigned int size)
+{
+    static const char *levels[] = {"INFO ", "INFO ", "INFO ", "DEBUG",
+                                   "DEBUG", "WARN ", "ERROR"};
+    static const char *methods[] = {"GET", "GET", "POST", "PUT", "DELETE"};
+    static const char *paths[] = {"/api/v1/users/",
+                                  "/api/v1/orders/",
+                                  "/api/v2/search?q=",
+                                  "/static/js/app.",
+                                  "/healthz?probe=",
+                                  "/api/v1/sessions/"};
+    static const char *messages[] = {
+        "request completed",
+        "cache miss, fetching from upstream",
+        "connection reset by peer, retrying",
+        "slow query detected",
+        "token refreshed for session",
+        "upstream timed out after 3000ms"};
+    char *text = (char *)malloc(size + 256);
+    unsigned int length = 0;
+    while (length < size) {
+        int status = rand() % 20 == 0 ? 500 : rand() % 10 == 0 ? 404 : 200;
+        length += (unsigned int)sprintf(
+            text + length,
+            "2026-10-17T%02d:%02d:%02d.%03dZ %s [worker-%d] %s %s%d %d "
+            "%dms from 10.%d.%d.%d: %s\n",
+            rand() % 24,
+            rand() % 60,
+            rand() % 60,
+            rand() % 1000,
+            levels[rand() % 7],
+            rand() % 32,
+            methods[rand() % 5],
+            paths[rand() % 6],
+            rand() % 100000,
+            status,
+            rand() % 2000,
+            rand() % 4,
+            rand() % 256,
+            rand() % 256,
+            messages[rand() % 6]);
+    }
+    return text;
+}
+
+/** ACGT to size bytes, a tenth copied from before with mutations. */
+static char *generate_dna(unsigned int size)
+{
+    static const char bases[] = "ACGT";
+    char *text = (char *)malloc(size);
+    unsigned int length = 0;
+    while (length < size) {
+        unsigned int run = 1000 + rand() % 4000;
+        if (run > size - length) {
+            run = size - length;
+        }
+        if (length > 10000 && rand() % 10 == 0) {
+            unsigned int from = (unsigned int)rand() % (length - run / 2);
+            for (unsigned int i = 0; i < run; ++i) {
+                char base = text[from + i % (length - from)];
+                text[length + i] = rand() % 50 == 0 ? bases[rand() % 4] : base;
+            }
+        } else {
+            for (unsigned int i = 0; i < run; ++i) {
+                text[length + i] = bases[rand() % 4];
+            }
+        }
+        length += run;
+    }
+    return text;
+}
+
+static char *read_file(const char *path, unsigned int *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = (char *)malloc(length > 0 ? length : 1);
+    *size = (unsigned int)fread(text, 1, length > 0 ? length : 0, file);
+    fclose(file);
+    return text;
+}
+
+static const char *algorithm_name(SearchAlgorithm algorithm)
+{
+    static const char *names[] = {"auto", "scalar", "sse2", "avx2", "hashq"};
+    return names[algorithm];
+}
+
+static void bench_corpus(const char *name, const char *text, unsigned int size)
+{
+    static const unsigned int lengths[] = {
+        1, 2, 4, 8, 12, 16, 24, 32, 64, 96, 128, 256};
+    static const char *columns[] = {"kmp", "bm", "sunday", "scalar",
+                                    "sse2", "avx2", "hashq", "auto"};
+    MatchFunc firsts[] = {kmp_text_match, bm_text_match, sunday_text_match};
+    SearchAlgorithm algorithms[] = {
+        SEARCH_SCALAR, SEARCH_SSE2, SEARCH_AVX2, SEARCH_HASHQ, SEARCH_AUTO};
+
+    printf("\n%s, %u bytes (MB/s, all matches)\n", name, size);
+    printf("%4s %9s", "len", "matches");
+    for (int k = 0; k < 8; ++k) {
+        printf(" %8s", columns[k]);
+    }
+    printf("  picked\n");
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+        unsigned int pat_len = lengths[l];
+        if (pat_len > size) {
+            break;
+        }
+        char pattern[256];
+        unsigned int offset = (unsigned int)rand() % (size - pat_len + 1);
+        memcpy(pattern, text + offset, pat_len);
+
+        double mbps[8];
+        unsigned int counts[8];
+        for (int k = 0; k < 3; ++k) {
+            mbps[k] = bench_run(firsts[k],
+                                SEARCH_AUTO,
+                                text,
+                                size,
+                                pattern,
+                                pat_len,
+                                &(counts[k]));
+        }
+        for (int k = 0; k < 5; ++k) {
+            mbps[3 + k] = bench_run(NULL,
+                                    algorithms[k],
+                                    text,
+                                    size,
+                                    pattern,
+                                    pat_len,
+                                    &(counts[3 + k]));
+        }
+
+        printf("%4u %9u", pat_len, counts[7]);
+        for (int k = 0; k < 8; ++k) {
+            printf(" %8.0f%s", mbps[k], counts[k] == counts[7] ? "" : "!");
+        }
+        printf("  %s\n", algorithm_name(search_choose(pattern, pat_len)));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int size = (unsigned int)bench_arg(argc, argv, 1, 16) << 20;
+    srand(2019);
+
+    char *logs = generate_log(size);
+    bench_corpus("log", logs, size);
+    free(logs);
+    char *dna = generate_dna(size);
+    bench_corpus("dna", dna, size);
+    free(dna);
+
+    for (int i = 2; i < argc; ++i) {
+        unsigned int file_size;
+        char *text = read_file(argv[i], &file_size);
+        if (text == NULL) {
+            printf("\n%s: can not read\n", argv[i]);
+            continue;
+        }
+        bench_corpus(argv[i], text, file_size);
+        free(text);
+    }
+    return 0;
+}
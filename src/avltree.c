@@ -21,14 +21,53 @@ AVLTree *avl_tree_new(AVLTreeCompareFunc compare_func,
                       AVLTreeFreeValueFunc free_value_func)
 {
     AVLTree *tree = (AVLTree *)malloc(sizeof(AVLTree));
+    if (tree == NULL) {
+        return NULL;
+    }
     tree->compare_func = compare_func;
     tree->free_key_func = free_key_func;
     tree->free_value_func = free_value_func;
     tree->root = AVL_TREE_NIL;
     tree->num_nodes = 0;
+    tree->slab = NULL;
+    return tree;
+}
+
+AVLTree *avl_tree_new_with_slab(AVLTreeCompareFunc compare_func,
+                                AVLTreeFreeKeyFunc free_key_func,
+                                AVLTreeFreeValueFunc free_value_func,
+                                unsigned int nodes_per_page)
+{
+    AVLTree *tree = avl_tree_new(compare_func, free_key_func, free_value_func);
+    if (tree == NULL) {
+        return NULL;
+    }
+    /** nodes and entities share the Slab. */
+    unsigned int object_size = sizeof(AVLTreeNode) > sizeof(AVLTreeEntity)
+                                   ? sizeof(AVLTreeNode)
+                                   : sizeof(AVLTreeEntity);
+    tree->slab = slab_new(object_size, nodes_per_page);
+    if (tree->slab == NULL) {
+        free(tree);
+        return NULL;
+    }
     return tree;
 }
 
+static inline void *avl_tree_alloc(AVLTree *tree, size_t size)
+{
+    return tree->slab != NULL ? slab_alloc(tree->slab) : malloc(size);
+}
+
+static inline void avl_tree_dealloc(AVLTree *tree, void *object)
+{
+    if (tree->slab != NULL) {
+        slab_dealloc(tree->slab, object);
+    } else {
+        free(object);
+    }
+}
+
 void avl_tree_free_node(AVLTree *tree, AVLTreeNode *node)
 {
     AVLTreeEntity *data = node->data;
@@ -38,14 +77,14 @@ void avl_tree_free_node(AVLTree *tree, AVLTreeNode *node)
         if (tree->free_value_func && prev->value) {
             tree->free_value_func(prev->value);
         }
-        free(prev);
+        avl_tree_dealloc(tree, prev);
     }
 
     if (tree->free_key_func && node->key) {
         tree->free_key_func(node->key);
     }
 
-    free(node);
+    avl_tree_dealloc(tree, node);
 }
 
 static void avl_tree_free_node_callback(AVLTreeNode *node, void *args)
@@ -57,17 +96,30 @@ static void avl_tree_free_node_callback(AVLTreeNode *node, void *args)
 
 void avl_tree_free(AVLTree *tree)
 {
+    if (tree->slab != NULL && tree->free_key_func == NULL &&
+        tree->free_value_func == NULL) {
+        /** nothing to free per node, drop the pages at once. */
+        slab_free(tree->slab);
+        free(tree);
+        return;
+    }
+
     // free all nodes
     avl_tree_postorder_traverse(tree, avl_tree_free_node_callback, tree);
+    if (tree->slab != NULL) {
+        slab_free(tree->slab);
+    }
     free(tree);
 }
 
-static AVLTreeNode *avl_tree_node_new(AVLTreeKey key, AVLTreeValue value)
+static AVLTreeNode *
+avl_tree_node_new(AVLTree *tree, AVLTreeKey key, AVLTreeValue value)
 {
-    AVLTreeNode *node = (AVLTreeNode *)malloc(sizeof(AVLTreeNode));
+    AVLTreeNode *node =
+        (AVLTreeNode *)avl_tree_alloc(tree, sizeof(AVLTreeNode));
 
     node->key = key;
-    node->data = (AVLTreeEntity *)malloc(sizeof(AVLTreeEntity));
+    node->data = (AVLTreeEntity *)avl_tree_alloc(tree, sizeof(AVLTreeEntity));
     node->data->value = value;
     node->data->next = NULL;
 
@@ -77,10 +129,12 @@ static AVLTreeNode *avl_tree_node_new(AVLTreeKey key, AVLTreeValue value)
     return node;
 }
 
-static AVLTreeEntity *avl_tree_node_append_value(AVLTreeNode *node,
+static AVLTreeEntity *avl_tree_node_append_value(AVLTree *tree,
+                                                 AVLTreeNode *node,
                                                  AVLTreeValue value)
 {
-    AVLTreeEntity *entity = (AVLTreeEntity *)malloc(sizeof(AVLTreeEntity));
+    AVLTreeEntity *entity =
+        (AVLTreeEntity *)avl_tree_alloc(tree, sizeof(AVLTreeEntity));
     entity->value = value;
     entity->next = NULL;
 
@@ -298,12 +352,12 @@ AVLTreeNode *avl_tree_insert(AVLTree *tree, AVLTreeKey key, AVLTreeValue value)
             // free the key. shared key with prev node.
             if (tree->free_key_func)
                 tree->free_key_func(key);
-            avl_tree_node_append_value(rover, value);
+            avl_tree_node_append_value(tree, rover, value);
             return rover;
         }
     }
 
-    AVLTreeNode *new_node = avl_tree_node_new(key, value);
+    AVLTreeNode *new_node = avl_tree_node_new(tree, key, value);
     new_node->parent = insert;
     ++(tree->num_nodes);
 
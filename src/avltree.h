@@ -19,6 +19,8 @@
 #ifndef RETHINK_C_AVL_TREE_H
 #define RETHINK_C_AVL_TREE_H
 
+#include "slab.h"
+
 /**
  * @brief The type of a key to be stored in a @ref AVLTree.
  *        (void *) can be changed to int, char *, or other types if needed.
@@ -77,6 +79,8 @@ typedef struct _AVLTree {
     AVLTreeFreeValueFunc free_value_func;
     /** The number of nodes of the @ref AVLTree. */
     unsigned int num_nodes;
+    /** The Slab of nodes and entities, NULL if allocated by malloc. */
+    Slab *slab;
 } AVLTree;
 
 /**
@@ -91,6 +95,24 @@ AVLTree *avl_tree_new(AVLTreeCompareFunc compare_func,
                       AVLTreeFreeKeyFunc free_key_func,
                       AVLTreeFreeValueFunc free_value_func);
 
+/**
+ * @brief Allcate a new AVLTree whose nodes and entities are allocated from its
+ * own Slab.
+ *
+ * Nodes are packed in pages, and avl_tree_free releases them in O(pages) if
+ * there are no free key/value functions.
+ *
+ * @param compare_func      Compare two node value when do searching in AVLTree.
+ * @param free_key_func     Free key callback function.
+ * @param free_value_func   Free value callback function.
+ * @param nodes_per_page    The number of nodes per Slab page, 0 for default.
+ * @return AVLTree*          The new AVLTree if success, otherwise return NULL.
+ */
+AVLTree *avl_tree_new_with_slab(AVLTreeCompareFunc compare_func,
+                                AVLTreeFreeKeyFunc free_key_func,
+                                AVLTreeFreeValueFunc free_value_func,
+                                unsigned int nodes_per_page);
+
 /**
  * @brief Delete a AVLTree and free back memory.
  *
@@ -10,7 +10,6 @@
 
 #include "bignum.h"
 #include "def.h"
-#include <assert.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -166,298 +165,2481 @@ Sign bignum_int_sanitize(char *num)
     return sign;
 }
 
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 dlimb_t;
+#endif
+
+/** a * b, the high limb to *high, return the low limb. */
+static inline limb_t bignum_limb_mul(limb_t a, limb_t b, limb_t *high)
+{
+#ifdef __SIZEOF_INT128__
+    dlimb_t product = (dlimb_t)a * b;
+    *high = (limb_t)(product >> BIGNUM_LIMB_BITS);
+    return (limb_t)product;
+#else
+    limb_t a0 = (uint32_t)a, a1 = a >> 32;
+    limb_t b0 = (uint32_t)b, b1 = b >> 32;
+    limb_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    limb_t middle = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+    *high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+    return (middle << 32) | (uint32_t)p00;
+#endif
+}
+
+/** (high * B + low) / d, high < d, the remainder to *remainder. */
+static inline limb_t
+bignum_limb_div(limb_t high, limb_t low, limb_t d, limb_t *remainder)
+{
+#ifdef __SIZEOF_INT128__
+    dlimb_t n = ((dlimb_t)high << BIGNUM_LIMB_BITS) | low;
+    *remainder = (limb_t)(n % d);
+    return (limb_t)(n / d);
+#else
+    /** a bit at a time, the remainder with its bit out kept below d. */
+    limb_t quotient = 0;
+    for (int i = BIGNUM_LIMB_BITS - 1; i >= 0; --i) {
+        limb_t out = high >> (BIGNUM_LIMB_BITS - 1);
+        high = (high << 1) | ((low >> i) & 1);
+        quotient <<= 1;
+        if (out != 0 || high >= d) {
+            high -= d;
+            quotient |= 1;
+        }
+    }
+    *remainder = high;
+    return quotient;
+#endif
+}
+
+/** the number of leading zero bits, x not 0. */
+static inline unsigned int bignum_limb_clz(limb_t x)
+{
+#ifdef __GNUC__
+    return (unsigned int)__builtin_clzll(x);
+#else
+    unsigned int n = 0;
+    while ((x >> (BIGNUM_LIMB_BITS - 1)) == 0) {
+        x <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/** The decimal digits of a limb in conversions, 10^19 < 2^64. */
+#define BIGNUM_LIMB_DIGITS 19
+#define BIGNUM_LIMB_TEN_POWER 10000000000000000000ULL
+
+/**
+ * The sizes of the smaller operand from which Karatsuba, Toom-3 and the
+ * transform multiply, by benchmark/bench_bignum_mul (x86-64, -O2).
+ */
+#define BIGNUM_KARATSUBA_THRESHOLD 24
+#define BIGNUM_TOOM3_THRESHOLD 160
+#define BIGNUM_NTT_THRESHOLD 3072
+
+/**
+ * The size of the divisor and the quotient from which Burnikel-Ziegler
+ * divides, by benchmark/bench_bignum_div.
+ */
+#define BIGNUM_BURNIKEL_ZIEGLER_THRESHOLD 60
+
+/** Below these, decimal conversion is limb by limb, not split. */
+#define BIGNUM_PARSE_SPLIT_DIGITS 1200
+#define BIGNUM_PRINT_SPLIT_LIMBS 40
+
+static inline size_t bignum_normalized_size(const limb_t *limbs, size_t size)
+{
+    while (size > 0 && limbs[size - 1] == 0) {
+        --size;
+    }
+    return size;
+}
+
+static int bignum_limbs_compare(const limb_t *left,
+                                size_t left_size,
+                                const limb_t *right,
+                                size_t right_size)
+{
+    if (left_size != right_size) {
+        return left_size > right_size ? 1 : -1;
+    }
+    for (size_t i = left_size; i-- > 0;) {
+        if (left[i] != right[i]) {
+            return left[i] > right[i] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+/** result = a + b, a_size >= b_size, a_size limbs written, return carry. */
+static limb_t bignum_limbs_add(limb_t *result,
+                               const limb_t *a,
+                               size_t a_size,
+                               const limb_t *b,
+                               size_t b_size)
+{
+    limb_t carry = 0;
+    size_t i = 0;
+    for (; i < b_size; ++i) {
+        limb_t sum = a[i] + carry;
+        carry = sum < carry;
+        sum += b[i];
+        carry += sum < b[i];
+        result[i] = sum;
+    }
+    for (; i < a_size; ++i) {
+        limb_t sum = a[i] + carry;
+        carry = sum < carry;
+        result[i] = sum;
+    }
+    return carry;
+}
+
+/** result = a - b, a >= b, a_size limbs written, return borrow. */
+static limb_t bignum_limbs_sub(limb_t *result,
+                               const limb_t *a,
+                               size_t a_size,
+                               const limb_t *b,
+                               size_t b_size)
+{
+    limb_t borrow = 0;
+    size_t i = 0;
+    for (; i < b_size; ++i) {
+        limb_t x = a[i];
+        limb_t y = b[i] + borrow;
+        borrow = (y < borrow) | (x < y);
+        result[i] = x - y;
+    }
+    for (; i < a_size; ++i) {
+        limb_t x = a[i];
+        result[i] = x - borrow;
+        borrow = x < borrow;
+    }
+    return borrow;
+}
+
+/** result = a * m + carry, size limbs written, return the high limb. */
+static limb_t bignum_limbs_mul_1(limb_t *result,
+                                 const limb_t *a,
+                                 size_t size,
+                                 limb_t m,
+                                 limb_t carry)
+{
+    for (size_t i = 0; i < size; ++i) {
+        limb_t high;
+        limb_t low = bignum_limb_mul(a[i], m, &high);
+        low += carry;
+        result[i] = low;
+        carry = high + (low < carry);
+    }
+    return carry;
+}
+
+/** result += a * m, size limbs, return the carry out. */
+static limb_t bignum_limbs_addmul_1(limb_t *result,
+                                    const limb_t *a,
+                                    size_t size,
+                                    limb_t m)
+{
+    limb_t carry = 0;
+    for (size_t i = 0; i < size; ++i) {
+        limb_t high;
+        limb_t low = bignum_limb_mul(a[i], m, &high);
+        low += carry;
+        high += low < carry;
+        limb_t x = result[i];
+        low += x;
+        result[i] = low;
+        carry = high + (low < x);
+    }
+    return carry;
+}
+
+/** result -= a * m, size limbs, return the borrow out. */
+static limb_t bignum_limbs_submul_1(limb_t *result,
+                                    const limb_t *a,
+                                    size_t size,
+                                    limb_t m)
+{
+    limb_t borrow = 0;
+    for (size_t i = 0; i < size; ++i) {
+        limb_t high;
+        limb_t low = bignum_limb_mul(a[i], m, &high);
+        low += borrow;
+        borrow = high + (low < borrow);
+        limb_t x = result[i];
+        result[i] = x - low;
+        borrow += x < low;
+    }
+    return borrow;
+}
+
+/**
+ * result = a * b, a_size + b_size limbs, schoolbook; result is none of a
+ * and b.
+ */
+static void bignum_limbs_mul_basecase(limb_t *result,
+                                      const limb_t *a,
+                                      size_t a_size,
+                                      const limb_t *b,
+                                      size_t b_size)
+{
+    result[a_size] = bignum_limbs_mul_1(result, a, a_size, b[0], 0);
+    for (size_t j = 1; j < b_size; ++j) {
+        result[a_size + j] =
+            bignum_limbs_addmul_1(result + j, a, a_size, b[j]);
+    }
+}
+
+/** quotient = a / d, size limbs, return the remainder. */
+static limb_t bignum_limbs_divrem_1(limb_t *quotient,
+                                    const limb_t *a,
+                                    size_t size,
+                                    limb_t d)
+{
+    limb_t remainder = 0;
+    for (size_t i = size; i-- > 0;) {
+        quotient[i] = bignum_limb_div(remainder, a[i], d, &remainder);
+    }
+    return remainder;
+}
+
+/** result = a << bits, bits below 64, size limbs, return the bits out. */
+static limb_t bignum_limbs_lshift(limb_t *result,
+                                  const limb_t *a,
+                                  size_t size,
+                                  unsigned int bits)
+{
+    if (bits == 0) {
+        memmove(result, a, sizeof(limb_t) * size);
+        return 0;
+    }
+    limb_t out = 0;
+    for (size_t i = size; i-- > 0;) {
+        limb_t limb = a[i];
+        if (i == size - 1) {
+            out = limb >> (BIGNUM_LIMB_BITS - bits);
+        }
+        result[i] = (limb << bits) |
+                    (i > 0 ? a[i - 1] >> (BIGNUM_LIMB_BITS - bits) : 0);
+    }
+    return out;
+}
+
+/** result = a >> bits, bits below 64, size limbs. */
+static void bignum_limbs_rshift(limb_t *result,
+                                const limb_t *a,
+                                size_t size,
+                                unsigned int bits)
+{
+    if (bits == 0) {
+        memmove(result, a, sizeof(limb_t) * size);
+        return;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        result[i] = (a[i] >> bits) |
+                    (i + 1 < size ? a[i + 1] << (BIGNUM_LIMB_BITS - bits) : 0);
+    }
+}
+
+/** The thresholds of multiplication and division. */
+static BigNumThresholds bignum_thresholds = {
+    BIGNUM_KARATSUBA_THRESHOLD,
+    BIGNUM_TOOM3_THRESHOLD,
+    BIGNUM_NTT_THRESHOLD,
+    BIGNUM_BURNIKEL_ZIEGLER_THRESHOLD,
+};
+
+typedef enum _BignumMulAlgorithm {
+    BIGNUM_MUL_BASECASE,
+    BIGNUM_MUL_UNBALANCED,
+    BIGNUM_MUL_KARATSUBA,
+    BIGNUM_MUL_TOOM3,
+    BIGNUM_MUL_NTT,
+} BignumMulAlgorithm;
+
+/** the algorithm multiplying a_size by b_size limbs, a_size >= b_size. */
+static BignumMulAlgorithm bignum_mul_algorithm(size_t a_size, size_t b_size)
+{
+    if (b_size < bignum_thresholds.karatsuba) {
+        return BIGNUM_MUL_BASECASE;
+    }
+    if (b_size >= bignum_thresholds.ntt) {
+        return BIGNUM_MUL_NTT;
+    }
+    if (a_size >= 2 * b_size) {
+        return BIGNUM_MUL_UNBALANCED;
+    }
+    /** Toom-3 splits a in thirds, b must be longer than two of them. */
+    if (b_size >= bignum_thresholds.toom3 &&
+        b_size > 2 * ((a_size + 2) / 3)) {
+        return BIGNUM_MUL_TOOM3;
+    }
+    return BIGNUM_MUL_KARATSUBA;
+}
+
+void bignum_get_thresholds(BigNumThresholds *thresholds)
+{
+    *thresholds = bignum_thresholds;
+}
+
+void bignum_set_thresholds(const BigNumThresholds *thresholds)
+{
+    bignum_thresholds = *thresholds;
+    if (bignum_thresholds.karatsuba < 2) {
+        bignum_thresholds.karatsuba = 2;
+    }
+    if (bignum_thresholds.toom3 < 3) {
+        bignum_thresholds.toom3 = 3;
+    }
+    if (bignum_thresholds.ntt < 1) {
+        bignum_thresholds.ntt = 1;
+    }
+    if (bignum_thresholds.burnikel_ziegler < 2) {
+        bignum_thresholds.burnikel_ziegler = 2;
+    }
+}
+
+static inline size_t bignum_max_size(size_t a, size_t b)
+{
+    return a > b ? a : b;
+}
+
+/** the least power of 2 not below size. */
+static inline size_t bignum_ntt_length(size_t size)
+{
+    size_t length = 1;
+    while (length < size) {
+        length <<= 1;
+    }
+    return length;
+}
+
+/** the limbs of scratch multiplying a_size by b_size limbs, any order. */
+static size_t bignum_limbs_mul_scratch_size(size_t a_size, size_t b_size)
+{
+    if (a_size < b_size) {
+        size_t size = a_size;
+        a_size = b_size;
+        b_size = size;
+    }
+
+    switch (bignum_mul_algorithm(a_size, b_size)) {
+    case BIGNUM_MUL_BASECASE:
+        return 0;
+    case BIGNUM_MUL_NTT:
+        return 5 * bignum_ntt_length(a_size + b_size);
+    case BIGNUM_MUL_UNBALANCED: {
+        size_t size = bignum_limbs_mul_scratch_size(b_size, b_size);
+        if (a_size % b_size != 0) {
+            size = bignum_max_size(
+                size, bignum_limbs_mul_scratch_size(b_size, a_size % b_size));
+        }
+        return 2 * b_size + size;
+    }
+    case BIGNUM_MUL_TOOM3: {
+        size_t k = (a_size + 2) / 3;
+        size_t size = bignum_max_size(
+            bignum_limbs_mul_scratch_size(k + 1, k + 1),
+            bignum_limbs_mul_scratch_size(k, k));
+        size = bignum_max_size(
+            size,
+            bignum_limbs_mul_scratch_size(a_size - 2 * k, b_size - 2 * k));
+        return 10 * k + 10 + size;
+    }
+    case BIGNUM_MUL_KARATSUBA:
+    default: {
+        size_t h = (a_size + 1) / 2;
+        if (b_size <= h) {
+            size_t size = bignum_max_size(
+                bignum_limbs_mul_scratch_size(h, b_size),
+                bignum_limbs_mul_scratch_size(a_size - h, b_size));
+            return a_size - h + b_size + size;
+        }
+        size_t size = bignum_max_size(
+            bignum_limbs_mul_scratch_size(h, h),
+            bignum_limbs_mul_scratch_size(a_size - h, b_size - h));
+        return 6 * h + 1 + size;
+    }
+    }
+}
+
+static void bignum_limbs_mul_scratch(limb_t *result,
+                                     const limb_t *a,
+                                     size_t a_size,
+                                     const limb_t *b,
+                                     size_t b_size,
+                                     limb_t *scratch);
+
+/** the magnitude of a - b to result, size limbs, return 1 if negative. */
+static int bignum_limbs_abs_sub(limb_t *result,
+                                const limb_t *a,
+                                size_t a_size,
+                                const limb_t *b,
+                                size_t b_size,
+                                size_t size)
+{
+    a_size = bignum_normalized_size(a, a_size);
+    b_size = bignum_normalized_size(b, b_size);
+    int negative = bignum_limbs_compare(a, a_size, b, b_size) < 0;
+    if (negative) {
+        bignum_limbs_sub(result, b, b_size, a, a_size);
+        memset(result + b_size, 0, sizeof(limb_t) * (size - b_size));
+    } else {
+        bignum_limbs_sub(result, a, a_size, b, b_size);
+        memset(result + a_size, 0, sizeof(limb_t) * (size - a_size));
+    }
+    return negative;
+}
+
+/**
+ * Karatsuba, b_size <= a_size < 2 * b_size: split both at h limbs,
+ * a = a1 * B^h + a0, b = b1 * B^h + b0, then
+ * a * b = z2 * B^2h + (z0 + z2 - (a0 - a1) * (b0 - b1)) * B^h + z0,
+ * z0 = a0 * b0, z2 = a1 * b1.
+ */
+static void bignum_limbs_mul_karatsuba(limb_t *result,
+                                       const limb_t *a,
+                                       size_t a_size,
+                                       const limb_t *b,
+                                       size_t b_size,
+                                       limb_t *scratch)
+{
+    size_t size = a_size + b_size;
+    size_t h = (a_size + 1) / 2;
+    if (b_size <= h) {
+        /** b too short to split: a0 * b + a1 * b * B^h. */
+        limb_t *product = scratch;
+        size_t product_size = a_size - h + b_size;
+        bignum_limbs_mul_scratch(result, a, h, b, b_size, scratch);
+        bignum_limbs_mul_scratch(
+            product, a + h, a_size - h, b, b_size, scratch + product_size);
+        memset(result + h + b_size, 0, sizeof(limb_t) * (size - h - b_size));
+        bignum_limbs_add(
+            result + h, result + h, size - h, product, product_size);
+        return;
+    }
+
+    limb_t *da = scratch;
+    limb_t *db = da + h;
+    limb_t *m = db + h;
+    limb_t *w = m + 2 * h;
+    limb_t *next = w + 2 * h + 1;
+
+    bignum_limbs_mul_scratch(result, a, h, b, h, next);
+    bignum_limbs_mul_scratch(
+        result + 2 * h, a + h, a_size - h, b + h, b_size - h, next);
+
+    int negative = bignum_limbs_abs_sub(da, a, h, a + h, a_size - h, h) ^
+                   bignum_limbs_abs_sub(db, b, h, b + h, b_size - h, h);
+    bignum_limbs_mul_scratch(m, da, h, db, h, next);
+
+    /** w = z0 + z2 -+ m, the middle coefficient. */
+    w[2 * h] = bignum_limbs_add(
+        w, result, 2 * h, result + 2 * h, size - 2 * h);
+    if (negative) {
+        bignum_limbs_add(w, w, 2 * h + 1, m, 2 * h);
+    } else {
+        bignum_limbs_sub(w, w, 2 * h + 1, m, 2 * h);
+    }
+    size_t w_size = size - h < 2 * h + 1 ? size - h : 2 * h + 1;
+    bignum_limbs_add(result + h, result + h, size - h, w, w_size);
+}
+
+/** a = a / 3, exactly, modulo B^size. */
+static void bignum_limbs_divexact_3(limb_t *a, size_t size)
+{
+    /** 3 * inverse == 1 modulo 2^64. */
+    const limb_t inverse = 0xAAAAAAAAAAAAAAABULL;
+    limb_t borrow = 0;
+    for (size_t i = 0; i < size; ++i) {
+        limb_t x = a[i];
+        limb_t y = x - borrow;
+        borrow = x < borrow;
+        limb_t q = y * inverse;
+        a[i] = q;
+        limb_t high;
+        bignum_limb_mul(q, 3, &high);
+        borrow += high;
+    }
+}
+
+/** a = -a modulo B^size, two's complement. */
+static void bignum_limbs_negate(limb_t *a, size_t size)
+{
+    limb_t carry = 1;
+    for (size_t i = 0; i < size; ++i) {
+        limb_t x = ~a[i] + carry;
+        carry = x < carry;
+        a[i] = x;
+    }
+}
+
+/**
+ * Toom-3, b_size > 2k, k = ceil(a_size / 3): a and b split in three
+ * parts of k limbs, polynomials of B^k, are evaluated at 0, 1, -1, 2 and
+ * infinity, multiplied there, and the product interpolated. The values
+ * are 2k + 2 limbs, two's complement when negative.
+ */
+static void bignum_limbs_mul_toom3(limb_t *result,
+                                   const limb_t *a,
+                                   size_t a_size,
+                                   const limb_t *b,
+                                   size_t b_size,
+                                   limb_t *scratch)
+{
+    size_t size = a_size + b_size;
+    size_t k = (a_size + 2) / 3;
+    size_t a2_size = a_size - 2 * k;
+    size_t b2_size = b_size - 2 * k;
+    size_t width = 2 * k + 2;
+    const limb_t *a1 = a + k;
+    const limb_t *a2 = a + 2 * k;
+    const limb_t *b1 = b + k;
+    const limb_t *b2 = b + 2 * k;
+
+    limb_t *p = scratch;
+    limb_t *q = p + k + 1;
+    limb_t *s = q + k + 1;
+    limb_t *t = s + k + 1;
+    limb_t *v1 = t + k + 1;
+    limb_t *vm1 = v1 + width;
+    limb_t *v2 = vm1 + width;
+    limb_t *next = v2 + width;
+
+    /** v0 and vinf in place, the product coefficients 0 and 4. */
+    limb_t *vinf = result + 4 * k;
+    size_t vinf_size = size - 4 * k;
+    bignum_limbs_mul_scratch(result, a, k, b, k, next);
+    bignum_limbs_mul_scratch(vinf, a2, a2_size, b2, b2_size, next);
+    memset(result + 2 * k, 0, sizeof(limb_t) * 2 * k);
+
+    /** v1 = (a0 + a1 + a2) * (b0 + b1 + b2). */
+    p[k] = bignum_limbs_add(p, a, k, a2, a2_size);
+    q[k] = bignum_limbs_add(q, b, k, b2, b2_size);
+    bignum_limbs_add(s, p, k + 1, a1, k);
+    bignum_limbs_add(t, q, k + 1, b1, k);
+    bignum_limbs_mul_scratch(v1, s, k + 1, t, k + 1, next);
+
+    /** vm1 = (a0 - a1 + a2) * (b0 - b1 + b2). */
+    int negative = bignum_limbs_abs_sub(s, p, k + 1, a1, k, k + 1) ^
+                   bignum_limbs_abs_sub(t, q, k + 1, b1, k, k + 1);
+    bignum_limbs_mul_scratch(vm1, s, k + 1, t, k + 1, next);
+    if (negative) {
+        bignum_limbs_negate(vm1, width);
+    }
+
+    /** v2 = (a0 + 2 a1 + 4 a2) * (b0 + 2 b1 + 4 b2). */
+    memset(s, 0, sizeof(limb_t) * (k + 1));
+    memset(t, 0, sizeof(limb_t) * (k + 1));
+    s[a2_size] = bignum_limbs_lshift(s, a2, a2_size, 1);
+    t[b2_size] = bignum_limbs_lshift(t, b2, b2_size, 1);
+    bignum_limbs_add(s, s, k + 1, a1, k);
+    bignum_limbs_add(t, t, k + 1, b1, k);
+    bignum_limbs_lshift(s, s, k + 1, 1);
+    bignum_limbs_lshift(t, t, k + 1, 1);
+    bignum_limbs_add(s, s, k + 1, a, k);
+    bignum_limbs_add(t, t, k + 1, b, k);
+    bignum_limbs_mul_scratch(v2, s, k + 1, t, k + 1, next);
+
+    /**
+     * interpolate c1, c2, c3 of c0 + c1 x + ... + c4 x^4, all the
+     * differences halved or divided by 3 are not negative.
+     */
+    bignum_limbs_sub(v2, v2, width, vm1, width);
+    bignum_limbs_divexact_3(v2, width);         /** c1 + c2 + 3c3 + 5c4 */
+    bignum_limbs_sub(vm1, v1, width, vm1, width);
+    bignum_limbs_rshift(vm1, vm1, width, 1);    /** c1 + c3 */
+    bignum_limbs_sub(v1, v1, width, result, 2 * k); /** c1 + c2 + c3 + c4 */
+    bignum_limbs_sub(v2, v2, width, v1, width);
+    bignum_limbs_rshift(v2, v2, width, 1);      /** c3 + 2c4 */
+    bignum_limbs_sub(v1, v1, width, vm1, width); /** c2 + c4 */
+    bignum_limbs_sub(v2, v2, width, vinf, vinf_size);
+    bignum_limbs_sub(v2, v2, width, vinf, vinf_size); /** c3 */
+    bignum_limbs_sub(v1, v1, width, vinf, vinf_size); /** c2 */
+    bignum_limbs_sub(vm1, vm1, width, v2, width);      /** c1 */
+
+    bignum_limbs_add(result + k, result + k, size - k, vm1, width);
+    bignum_limbs_add(result + 2 * k, result + 2 * k, size - 2 * k, v1, width);
+    size_t c3_size = size - 3 * k < width ? size - 3 * k : width;
+    bignum_limbs_add(result + 3 * k, result + 3 * k, size - 3 * k, v2, c3_size);
+}
+
+/**
+ * The primes of the transforms, c * 2^k + 1 below 2^62, and a primitive
+ * root of each. Their product, above 2^179, bounds the coefficients of the
+ * product, n * 2^128 for n limbs of the smaller operand.
+ */
+static const limb_t bignum_ntt_primes[3] = {
+    0x3a00000000000001ULL, /** 29 * 2^57 + 1 */
+    0x1b00000000000001ULL, /** 27 * 2^56 + 1 */
+    0x0280000000000001ULL, /** 5 * 2^55 + 1 */
+};
+static const limb_t bignum_ntt_generators[3] = {3, 5, 6};
+
+/** Montgomery arithmetic modulo a prime p < 2^62, R = 2^64. */
+typedef struct _BignumMontgomery {
+    limb_t p;
+    /** -1 / p modulo R. */
+    limb_t inverse;
+    /** R modulo p, one. */
+    limb_t one;
+    /** R^2 modulo p. */
+    limb_t r2;
+} BignumMontgomery;
+
+/** a * b / R modulo p, for a < 2^64 and b < p. */
+static inline limb_t bignum_mont_mul(limb_t a,
+                                     limb_t b,
+                                     const BignumMontgomery *mont)
+{
+    limb_t t_high;
+    limb_t t = bignum_limb_mul(a, b, &t_high);
+    limb_t m = t * mont->inverse;
+    limb_t mp_high;
+    limb_t mp = bignum_limb_mul(m, mont->p, &mp_high);
+    /** t + m p is 0 modulo R, its low limb carries out unless t is 0. */
+    limb_t u = t_high + mp_high + ((limb_t)(t + mp) < t);
+    return u >= mont->p ? u - mont->p : u;
+}
+
+static void bignum_mont_init(BignumMontgomery *mont, limb_t p)
+{
+    /** Newton's iteration, each doubles the bits of 1 / p. */
+    limb_t x = p;
+    for (int i = 0; i < 5; ++i) {
+        x *= 2 - p * x;
+    }
+    mont->p = p;
+    mont->inverse = (limb_t)0 - x;
+    bignum_limb_div(1, 0, p, &(mont->one));
+    limb_t high;
+    limb_t low = bignum_limb_mul(mont->one, mont->one, &high);
+    bignum_limb_div(high, low, p, &(mont->r2));
+}
+
+/** x * R modulo p. */
+static inline limb_t bignum_mont_from(limb_t x, const BignumMontgomery *mont)
+{
+    return bignum_mont_mul(x, mont->r2, mont);
+}
+
+/** base^e, both in Montgomery form. */
+static limb_t
+bignum_mont_pow(limb_t base, limb_t e, const BignumMontgomery *mont)
+{
+    limb_t result = mont->one;
+    while (e != 0) {
+        if (e & 1) {
+            result = bignum_mont_mul(result, base, mont);
+        }
+        base = bignum_mont_mul(base, base, mont);
+        e >>= 1;
+    }
+    return result;
+}
+
+/**
+ * roots[len + j] = w^j of w a primitive 2len-th root of unity, or of its
+ * inverse, for len = 1, 2, ..., length / 2; in Montgomery form.
+ */
+static void bignum_ntt_roots(limb_t *roots,
+                             size_t length,
+                             limb_t generator,
+                             int inverse,
+                             const BignumMontgomery *mont)
+{
+    limb_t g = bignum_mont_from(generator, mont);
+    for (size_t len = 1; len < length; len <<= 1) {
+        limb_t e = (mont->p - 1) / (2 * len);
+        limb_t w = bignum_mont_pow(g, inverse ? mont->p - 1 - e : e, mont);
+        roots[len] = mont->one;
+        for (size_t j = 1; j < len; ++j) {
+            roots[len + j] = bignum_mont_mul(roots[len + j - 1], w, mont);
+        }
+    }
+}
+
+/** transform in place, natural order to bit reversed (decimation in freq). */
+static void bignum_ntt_forward(limb_t *x,
+                               size_t length,
+                               const limb_t *roots,
+                               const BignumMontgomery *mont)
+{
+    limb_t p = mont->p;
+    for (size_t len = length >> 1; len > 0; len >>= 1) {
+        for (size_t i = 0; i < length; i += 2 * len) {
+            limb_t *lo = x + i;
+            limb_t *hi = lo + len;
+            for (size_t j = 0; j < len; ++j) {
+                limb_t u = lo[j];
+                limb_t v = hi[j];
+                limb_t sum = u + v;
+                lo[j] = sum >= p ? sum - p : sum;
+                hi[j] = bignum_mont_mul(
+                    u >= v ? u - v : u + p - v, roots[len + j], mont);
+            }
+        }
+    }
+}
+
+/** transform in place, bit reversed to natural order (decimation in time). */
+static void bignum_ntt_inverse(limb_t *x,
+                               size_t length,
+                               const limb_t *roots,
+                               const BignumMontgomery *mont)
+{
+    limb_t p = mont->p;
+    for (size_t len = 1; len < length; len <<= 1) {
+        for (size_t i = 0; i < length; i += 2 * len) {
+            limb_t *lo = x + i;
+            limb_t *hi = lo + len;
+            for (size_t j = 0; j < len; ++j) {
+                limb_t u = lo[j];
+                limb_t v = bignum_mont_mul(hi[j], roots[len + j], mont);
+                limb_t sum = u + v;
+                lo[j] = sum >= p ? sum - p : sum;
+                hi[j] = u >= v ? u - v : u + p - v;
+            }
+        }
+    }
+}
+
+/** x[0..length) = a modulo p, zero padded. */
+static void bignum_ntt_load(limb_t *x,
+                            size_t length,
+                            const limb_t *a,
+                            size_t size,
+                            limb_t p)
+{
+    for (size_t i = 0; i < size; ++i) {
+        x[i] = a[i] % p;
+    }
+    memset(x + size, 0, sizeof(limb_t) * (length - size));
+}
+
+/**
+ * The product modulo three primes by transforms of length a power of 2,
+ * then each coefficient, below the product of the primes, by Garner's
+ * algorithm; a square if a is b.
+ */
+static void bignum_limbs_mul_ntt(limb_t *result,
+                                 const limb_t *a,
+                                 size_t a_size,
+                                 const limb_t *b,
+                                 size_t b_size,
+                                 limb_t *scratch)
+{
+    size_t size = a_size + b_size;
+    size_t length = bignum_ntt_length(size);
+    int square = a == b && a_size == b_size;
+    limb_t *residues[3] = {
+        scratch, scratch + length, scratch + 2 * length};
+    limb_t *other = scratch + 3 * length;
+    limb_t *roots = scratch + 4 * length;
+    BignumMontgomery monts[3];
+
+    for (int k = 0; k < 3; ++k) {
+        BignumMontgomery *mont = &(monts[k]);
+        limb_t *x = residues[k];
+        bignum_mont_init(mont, bignum_ntt_primes[k]);
+
+        bignum_ntt_roots(roots, length, bignum_ntt_generators[k], 0, mont);
+        bignum_ntt_load(x, length, a, a_size, mont->p);
+        bignum_ntt_forward(x, length, roots, mont);
+        if (!square) {
+            bignum_ntt_load(other, length, b, b_size, mont->p);
+            bignum_ntt_forward(other, length, roots, mont);
+        }
+
+        /** x * y / length: scale = R^2 / length, two reductions by R. */
+        limb_t scale = bignum_mont_pow(
+            bignum_mont_from(length % mont->p, mont), mont->p - 2, mont);
+        scale = bignum_mont_mul(scale, mont->r2, mont);
+        const limb_t *y = square ? x : other;
+        for (size_t i = 0; i < length; ++i) {
+            x[i] = bignum_mont_mul(bignum_mont_mul(x[i], y[i], mont),
+                                   scale,
+                                   mont);
+        }
+
+        bignum_ntt_roots(roots, length, bignum_ntt_generators[k], 1, mont);
+        bignum_ntt_inverse(x, length, roots, mont);
+    }
+
+    /**
+     * Garner: x = t1 + t2 p1 + t3 p1 p2, t1 = r1,
+     * t2 = (r2 - t1) / p1 mod p2, t3 = (r3 - t1 - t2 p1) / (p1 p2) mod p3.
+     */
+    const BignumMontgomery *m2 = &(monts[1]);
+    const BignumMontgomery *m3 = &(monts[2]);
+    limb_t p1 = bignum_ntt_primes[0];
+    limb_t p2 = bignum_ntt_primes[1];
+    limb_t p3 = bignum_ntt_primes[2];
+    /** in Montgomery form, so the products are in plain form. */
+    limb_t p1_inverse = bignum_mont_pow(
+        bignum_mont_from(p1 % p2, m2), p2 - 2, m2);
+    limb_t p1_mod_p3 = bignum_mont_from(p1 % p3, m3);
+    limb_t p12_mod_p3 = bignum_mont_mul(p1_mod_p3, p2 % p3, m3);
+    limb_t p12_inverse = bignum_mont_pow(
+        bignum_mont_from(p12_mod_p3, m3), p3 - 2, m3);
+    limb_t p12_high;
+    limb_t p12_low = bignum_limb_mul(p1, p2, &p12_high);
+
+    /** the carry into the next coefficient, below 2^128. */
+    limb_t c0 = 0;
+    limb_t c1 = 0;
+    for (size_t i = 0; i < size; ++i) {
+        limb_t t1 = residues[0][i];
+        limb_t t1_mod_p2 = t1;
+        while (t1_mod_p2 >= p2) {
+            t1_mod_p2 -= p2;
+        }
+        limb_t r2 = residues[1][i];
+        limb_t t2 = bignum_mont_mul(
+            r2 >= t1_mod_p2 ? r2 - t1_mod_p2 : r2 + p2 - t1_mod_p2,
+            p1_inverse,
+            m2);
+
+        limb_t y3 = bignum_mont_mul(t1, m3->one, m3) +
+                    bignum_mont_mul(t2, p1_mod_p3, m3);
+        y3 = y3 >= p3 ? y3 - p3 : y3;
+        limb_t r3 = residues[2][i];
+        limb_t t3 = bignum_mont_mul(
+            r3 >= y3 ? r3 - y3 : r3 + p3 - y3, p12_inverse, m3);
+
+        /** x = t3 p1 p2 + (t2 p1 + t1), three limbs, plus the carry. */
+        limb_t low_high;
+        limb_t low = bignum_limb_mul(t3, p12_low, &low_high);
+        limb_t high_high;
+        limb_t high = bignum_limb_mul(t3, p12_high, &high_high);
+        high += low_high;
+        high_high += high < low_high;
+        limb_t y_high;
+        limb_t y = bignum_limb_mul(t2, p1, &y_high);
+        y += t1;
+        y_high += y < t1;
+        limb_t x0 = low + y;
+        limb_t carry = x0 < y;
+        limb_t x1 = high + carry;
+        carry = x1 < carry;
+        x1 += y_high;
+        carry += x1 < y_high;
+        limb_t x2 = high_high + carry;
+
+        result[i] = x0 + c0;
+        carry = result[i] < c0;
+        x1 += carry;
+        carry = x1 < carry;
+        x1 += c1;
+        carry += x1 < c1;
+        c0 = x1;
+        c1 = x2 + carry;
+    }
+}
+
+/**
+ * a (a_size >= 2 * b_size) cut into pieces of b_size limbs, each piece
+ * times b added in.
+ */
+static void bignum_limbs_mul_unbalanced(limb_t *result,
+                                        const limb_t *a,
+                                        size_t a_size,
+                                        const limb_t *b,
+                                        size_t b_size,
+                                        limb_t *scratch)
+{
+    limb_t *product = scratch;
+    limb_t *next = scratch + 2 * b_size;
+    bignum_limbs_mul_scratch(result, a, b_size, b, b_size, next);
+    for (size_t offset = b_size; offset < a_size; offset += b_size) {
+        size_t piece = a_size - offset < b_size ? a_size - offset : b_size;
+        bignum_limbs_mul_scratch(product, b, b_size, a + offset, piece, next);
+        memset(result + offset + b_size, 0, sizeof(limb_t) * piece);
+        bignum_limbs_add(result + offset,
+                         result + offset,
+                         piece + b_size,
+                         product,
+                         piece + b_size);
+    }
+}
+
+/**
+ * result = a * b, a_size + b_size limbs, by the algorithm of the sizes,
+ * scratch of bignum_limbs_mul_scratch_size limbs; result is none of a, b
+ * and scratch.
+ */
+static void bignum_limbs_mul_scratch(limb_t *result,
+                                     const limb_t *a,
+                                     size_t a_size,
+                                     const limb_t *b,
+                                     size_t b_size,
+                                     limb_t *scratch)
+{
+    if (a_size < b_size) {
+        const limb_t *limbs = a;
+        a = b;
+        b = limbs;
+        size_t size = a_size;
+        a_size = b_size;
+        b_size = size;
+    }
+
+    switch (bignum_mul_algorithm(a_size, b_size)) {
+    case BIGNUM_MUL_BASECASE:
+        bignum_limbs_mul_basecase(result, a, a_size, b, b_size);
+        break;
+    case BIGNUM_MUL_NTT:
+        bignum_limbs_mul_ntt(result, a, a_size, b, b_size, scratch);
+        break;
+    case BIGNUM_MUL_UNBALANCED:
+        bignum_limbs_mul_unbalanced(result, a, a_size, b, b_size, scratch);
+        break;
+    case BIGNUM_MUL_TOOM3:
+        bignum_limbs_mul_toom3(result, a, a_size, b, b_size, scratch);
+        break;
+    case BIGNUM_MUL_KARATSUBA:
+    default:
+        bignum_limbs_mul_karatsuba(result, a, a_size, b, b_size, scratch);
+        break;
+    }
+}
+
+/**
+ * result = a * b, a_size + b_size limbs, a_size and b_size at least 1;
+ * result is none of a and b. Return 0, or -1 if out of memory.
+ */
+static int bignum_limbs_mul(limb_t *result,
+                            const limb_t *a,
+                            size_t a_size,
+                            const limb_t *b,
+                            size_t b_size)
+{
+    size_t scratch_size = bignum_limbs_mul_scratch_size(a_size, b_size);
+    limb_t *scratch = NULL;
+    if (scratch_size > 0) {
+        scratch = (limb_t *)malloc(sizeof(limb_t) * scratch_size);
+        if (scratch == NULL) {
+            return -1;
+        }
+    }
+    bignum_limbs_mul_scratch(result, a, a_size, b, b_size, scratch);
+    free(scratch);
+    return 0;
+}
+
+/**
+ * Knuth's algorithm D on u (q_size + size limbs) by v (size limbs, the top
+ * bit set), u < v * B^q_size: quotient to q_size limbs, the remainder left
+ * in u[0..size), zeros above.
+ */
+static void bignum_limbs_div_basecase(limb_t *quotient,
+                                      limb_t *u,
+                                      size_t q_size,
+                                      const limb_t *v,
+                                      size_t size)
+{
+    if (size == 1) {
+        limb_t remainder = u[q_size];
+        for (size_t j = q_size; j-- > 0;) {
+            quotient[j] = bignum_limb_div(remainder, u[j], v[0], &remainder);
+        }
+        u[0] = remainder;
+        memset(u + 1, 0, sizeof(limb_t) * q_size);
+        return;
+    }
+
+    limb_t v1 = v[size - 1];
+    limb_t v2 = v[size - 2];
+    for (size_t j = q_size; j-- > 0;) {
+        /** estimate by the top two limbs, at most 2 too large, at most
+         * B - 1 (the top limb is at most v1). */
+        limb_t qhat;
+        limb_t rhat;
+        int rhat_carry = 0;
+        if (u[j + size] >= v1) {
+            qhat = ~(limb_t)0;
+            rhat = u[j + size - 1] + v1;
+            rhat_carry = rhat < v1;
+        } else {
+            qhat = bignum_limb_div(u[j + size], u[j + size - 1], v1, &rhat);
+        }
+        /** by the third limb, while rhat is below B. */
+        while (!rhat_carry) {
+            limb_t product_high;
+            limb_t product = bignum_limb_mul(qhat, v2, &product_high);
+            if (product_high < rhat ||
+                (product_high == rhat && product <= u[j + size - 2])) {
+                break;
+            }
+            --qhat;
+            rhat += v1;
+            rhat_carry = rhat < v1;
+        }
+
+        limb_t borrow = bignum_limbs_submul_1(u + j, v, size, qhat);
+        limb_t top = u[j + size];
+        u[j + size] = top - borrow;
+        if (top < borrow) {
+            /** one too large: add back. */
+            --qhat;
+            u[j + size] += bignum_limbs_add(u + j, u + j, size, v, size);
+        }
+        quotient[j] = qhat;
+    }
+}
+
+/**
+ * quotient = a / b (a_size - b_size + 1 limbs), remainder = a % b (b_size
+ * limbs) by Knuth's algorithm D, a_size >= b_size >= 2, scratch of
+ * a_size + 1 + b_size limbs.
+ */
+static void bignum_limbs_divrem(limb_t *quotient,
+                                limb_t *remainder,
+                                const limb_t *a,
+                                size_t a_size,
+                                const limb_t *b,
+                                size_t b_size,
+                                limb_t *scratch)
+{
+    /** the divisor shifted to its top bit set, the dividend as well. */
+    unsigned int shift = bignum_limb_clz(b[b_size - 1]);
+    limb_t *u = scratch;
+    limb_t *v = u + a_size + 1;
+    bignum_limbs_lshift(v, b, b_size, shift);
+    u[a_size] = bignum_limbs_lshift(u, a, a_size, shift);
+
+    bignum_limbs_div_basecase(quotient, u, a_size - b_size + 1, v, b_size);
+    bignum_limbs_rshift(remainder, u, b_size, shift);
+}
+
+/** the limbs of scratch dividing 2n by n limbs. */
+static size_t bignum_limbs_div_scratch_size(size_t n)
+{
+    if (n % 2 != 0 || n < bignum_thresholds.burnikel_ziegler) {
+        return 0;
+    }
+    size_t h = n / 2;
+    return 2 * h + bignum_max_size(bignum_limbs_mul_scratch_size(h, h),
+                                   bignum_limbs_div_scratch_size(h));
+}
+
+static void bignum_limbs_div_3by2(limb_t *quotient,
+                                  limb_t *a,
+                                  const limb_t *b,
+                                  size_t h,
+                                  limb_t *scratch);
+
+/**
+ * Burnikel-Ziegler, a (2n limbs) by b (n limbs, the top bit set),
+ * a < b * B^n: quotient to n limbs, the remainder left in a[0..n), zeros
+ * above. Halves of three by two, down to an odd size or the threshold.
+ */
+static void bignum_limbs_div_2by1(limb_t *quotient,
+                                  limb_t *a,
+                                  const limb_t *b,
+                                  size_t n,
+                                  limb_t *scratch)
+{
+    if (n % 2 != 0 || n < bignum_thresholds.burnikel_ziegler) {
+        bignum_limbs_div_basecase(quotient, a, n, b, n);
+        return;
+    }
+    size_t h = n / 2;
+    bignum_limbs_div_3by2(quotient + h, a + h, b, h, scratch);
+    bignum_limbs_div_3by2(quotient, a, b, h, scratch);
+}
+
+/**
+ * a (3h limbs, a1 a2 a3 from the top) by b (2h limbs, b1 b2 from the top,
+ * the top bit set), a < b * B^h: quotient to h limbs, the remainder left in
+ * a[0..2h), zeros above. The quotient estimated by [a1 a2] / b1 is at most
+ * 2 too large.
+ */
+static void bignum_limbs_div_3by2(limb_t *quotient,
+                                  limb_t *a,
+                                  const limb_t *b,
+                                  size_t h,
+                                  limb_t *scratch)
+{
+    const limb_t *b1 = b + h;
+    limb_t *d = scratch;
+    limb_t *next = scratch + 2 * h;
+
+    if (bignum_limbs_compare(a + 2 * h, h, b1, h) < 0) {
+        /** [a1 a2] = q * b1 + r, r left in a[h..2h). */
+        bignum_limbs_div_2by1(quotient, a + h, b1, h, next);
+    } else {
+        /** a1 == b1: q = B^h - 1, r = [a1 a2] - q * b1 = a2 + b1. */
+        memset(quotient, 0xFF, sizeof(limb_t) * h);
+        bignum_limbs_sub(a + 2 * h, a + 2 * h, h, b1, h);
+        bignum_limbs_add(a + h, a + h, 2 * h, b1, h);
+    }
+
+    /** [r a3] - q * b2, add back b while negative. */
+    bignum_limbs_mul_scratch(d, quotient, h, b, h, next);
+    limb_t borrow = bignum_limbs_sub(a, a, 3 * h, d, 2 * h);
+    while (borrow != 0) {
+        limb_t one = 1;
+        bignum_limbs_sub(quotient, quotient, h, &one, 1);
+        if (bignum_limbs_add(a, a, 3 * h, b, 2 * h) != 0) {
+            borrow = 0;
+        }
+    }
+}
+
+/** the divisor of b_size limbs padded to j * 2^k, j below the threshold. */
+static size_t bignum_bz_block_size(size_t b_size)
+{
+    size_t m = 1;
+    while (m * bignum_thresholds.burnikel_ziegler <= b_size) {
+        m <<= 1;
+    }
+    return (b_size + m - 1) / m * m;
+}
+
+/** the limbs of scratch of bignum_limbs_divrem_bz. */
+static size_t bignum_limbs_divrem_bz_scratch_size(size_t a_size,
+                                                  size_t b_size)
+{
+    /** the shift is below (n - b_size + 1) limbs, so t is at most this. */
+    size_t n = bignum_bz_block_size(b_size);
+    size_t t = (a_size + 2 * n - b_size + 1) / n;
+    if (t < 2) {
+        t = 2;
+    }
+    return t * n + n + (t - 1) * n + bignum_limbs_div_scratch_size(n);
+}
+
+/**
+ * quotient = a / b (a_size - b_size + 1 limbs), remainder = a % b (b_size
+ * limbs) by Burnikel-Ziegler, a_size >= b_size >= 2, scratch of
+ * bignum_limbs_divrem_bz_scratch_size limbs. The divisor is shifted to
+ * n = j * 2^k limbs with its top bit set, j below the threshold, so that
+ * each 2n / n halves down to Knuth's algorithm D; the dividend by as much,
+ * into t blocks of n limbs, its top block below the divisor.
+ */
+static void bignum_limbs_divrem_bz(limb_t *quotient,
+                                   limb_t *remainder,
+                                   const limb_t *a,
+                                   size_t a_size,
+                                   const limb_t *b,
+                                   size_t b_size,
+                                   limb_t *scratch)
+{
+    size_t n = bignum_bz_block_size(b_size);
+    size_t b_bits = b_size * BIGNUM_LIMB_BITS -
+                    bignum_limb_clz(b[b_size - 1]);
+    size_t a_bits = a_size * BIGNUM_LIMB_BITS -
+                    bignum_limb_clz(a[a_size - 1]);
+    size_t shift = n * BIGNUM_LIMB_BITS - b_bits;
+    size_t t = (a_bits + shift + n * BIGNUM_LIMB_BITS) /
+               (n * BIGNUM_LIMB_BITS);
+    if (t < 2) {
+        t = 2;
+    }
+
+    limb_t *w = scratch;
+    limb_t *v = w + t * n;
+    limb_t *q = v + n;
+    scratch = q + (t - 1) * n;
+
+    size_t limbs_shift = shift / BIGNUM_LIMB_BITS;
+    unsigned int bits_shift = (unsigned int)(shift % BIGNUM_LIMB_BITS);
+    memset(v, 0, sizeof(limb_t) * limbs_shift);
+    bignum_limbs_lshift(v + limbs_shift, b, b_size, bits_shift);
+    memset(w, 0, sizeof(limb_t) * t * n);
+    limb_t out = bignum_limbs_lshift(w + limbs_shift, a, a_size, bits_shift);
+    if (limbs_shift + a_size < t * n) {
+        /** else it is 0, a shifted fits in t * n limbs. */
+        w[limbs_shift + a_size] = out;
+    }
+
+    /** each two blocks, the remainder above, by the divisor. */
+    for (size_t i = t - 1; i-- > 0;) {
+        bignum_limbs_div_2by1(q + i * n, w + i * n, v, n, scratch);
+    }
+
+    /** the quotient is below B^((t - 1) n), but may be shorter. */
+    size_t q_size = a_size - b_size + 1;
+    if (q_size > (t - 1) * n) {
+        memset(quotient + (t - 1) * n, 0,
+               sizeof(limb_t) * (q_size - (t - 1) * n));
+        q_size = (t - 1) * n;
+    }
+    memcpy(quotient, q, sizeof(limb_t) * q_size);
+    bignum_limbs_rshift(v, w + limbs_shift, n - limbs_shift, bits_shift);
+    memcpy(remainder, v, sizeof(limb_t) * b_size);
+}
+
+static inline int bignum_limbs_divmod_is_bz(size_t a_size, size_t b_size)
+{
+    return b_size >= bignum_thresholds.burnikel_ziegler &&
+           a_size - b_size + 1 >= bignum_thresholds.burnikel_ziegler;
+}
+
+/** the limbs of scratch dividing a_size by b_size limbs, a_size >= b_size. */
+static size_t bignum_limbs_divmod_scratch_size(size_t a_size, size_t b_size)
+{
+    if (b_size == 1) {
+        return 0;
+    }
+    if (bignum_limbs_divmod_is_bz(a_size, b_size)) {
+        return bignum_limbs_divrem_bz_scratch_size(a_size, b_size);
+    }
+    return a_size + 1 + b_size;
+}
+
+/**
+ * quotient (a_size - b_size + 1 limbs) and remainder (b_size limbs) of
+ * a / b, a_size >= b_size, a and b normalized, scratch of
+ * bignum_limbs_divmod_scratch_size limbs; none of them overlap.
+ */
+static void bignum_limbs_divmod_scratch(limb_t *quotient,
+                                        limb_t *remainder,
+                                        const limb_t *a,
+                                        size_t a_size,
+                                        const limb_t *b,
+                                        size_t b_size,
+                                        limb_t *scratch)
+{
+    if (b_size == 1) {
+        remainder[0] = bignum_limbs_divrem_1(quotient, a, a_size, b[0]);
+    } else if (bignum_limbs_divmod_is_bz(a_size, b_size)) {
+        bignum_limbs_divrem_bz(
+            quotient, remainder, a, a_size, b, b_size, scratch);
+    } else {
+        bignum_limbs_divrem(quotient, remainder, a, a_size, b, b_size, scratch);
+    }
+}
+
+/**
+ * quotient (a_size - b_size + 1 limbs) and remainder (b_size limbs) of
+ * a / b, a_size >= b_size, a and b normalized; either may be NULL. Return
+ * 0, or -1 if out of memory.
+ */
+static int bignum_limbs_divmod(limb_t *quotient,
+                               limb_t *remainder,
+                               const limb_t *a,
+                               size_t a_size,
+                               const limb_t *b,
+                               size_t b_size)
+{
+    /** the quotient or remainder not wanted, then the scratch. */
+    size_t size = bignum_limbs_divmod_scratch_size(a_size, b_size);
+    if (quotient == NULL || remainder == NULL) {
+        size += a_size + 1;
+    }
+    limb_t *buffer = NULL;
+    if (size > 0) {
+        buffer = (limb_t *)malloc(sizeof(limb_t) * size);
+        if (buffer == NULL) {
+            return -1;
+        }
+    }
+    limb_t *q = quotient;
+    limb_t *r = remainder;
+    limb_t *scratch = buffer;
+    if (q == NULL || r == NULL) {
+        if (q == NULL) {
+            q = buffer;
+        }
+        if (r == NULL) {
+            r = buffer + a_size - b_size + 1;
+        }
+        scratch = buffer + a_size + 1;
+    }
+    bignum_limbs_divmod_scratch(q, r, a, a_size, b, b_size, scratch);
+    free(buffer);
+    return 0;
+}
+
+int bignum_reserve(BigNum *num, size_t capacity)
+{
+    if (num->capacity >= capacity) {
+        return 0;
+    }
+    limb_t *limbs = (limb_t *)realloc(num->limbs, sizeof(limb_t) * capacity);
+    if (limbs == NULL) {
+        return -1;
+    }
+    num->limbs = limbs;
+    num->capacity = capacity;
+    return 0;
+}
+
+/** take limbs as the magnitude of num, normalized. */
+static void bignum_assign(BigNum *num,
+                          limb_t *limbs,
+                          size_t size,
+                          size_t capacity,
+                          Sign sign)
+{
+    free(num->limbs);
+    num->limbs = limbs;
+    num->capacity = capacity;
+    num->size = bignum_normalized_size(limbs, size);
+    num->sign = num->size == 0 ? Positive : sign;
+}
+
+BigNumScratch *bignum_scratch_new(size_t capacity)
+{
+    BigNumScratch *scratch = (BigNumScratch *)malloc(sizeof(BigNumScratch));
+    if (scratch == NULL) {
+        return NULL;
+    }
+    scratch->limbs = NULL;
+    scratch->capacity = 0;
+    if (bignum_scratch_reserve(scratch, capacity) != 0) {
+        free(scratch);
+        return NULL;
+    }
+    return scratch;
+}
+
+void bignum_scratch_free(BigNumScratch *scratch)
+{
+    free(scratch->limbs);
+    free(scratch);
+}
+
+int bignum_scratch_reserve(BigNumScratch *scratch, size_t capacity)
+{
+    if (scratch->capacity >= capacity) {
+        return 0;
+    }
+    /** the old limbs are only temporaries: not copied. */
+    limb_t *limbs = (limb_t *)malloc(sizeof(limb_t) * capacity);
+    if (limbs == NULL) {
+        return -1;
+    }
+    free(scratch->limbs);
+    scratch->limbs = limbs;
+    scratch->capacity = capacity;
+    return 0;
+}
+
+BigNum *bignum_new()
+{
+    BigNum *num = (BigNum *)malloc(sizeof(BigNum));
+    if (num == NULL) {
+        return NULL;
+    }
+    num->limbs = NULL;
+    num->size = 0;
+    num->capacity = 0;
+    num->sign = Positive;
+    return num;
+}
+
+void bignum_free(BigNum *num)
+{
+    free(num->limbs);
+    free(num);
+}
+
+int bignum_set_int(BigNum *num, int64_t value)
+{
+    if (bignum_reserve(num, 1) != 0) {
+        return -1;
+    }
+    /** the magnitude of INT64_MIN is not an int64_t. */
+    limb_t magnitude = value < 0 ? (limb_t)(-(value + 1)) + 1 : (limb_t)value;
+    num->limbs[0] = magnitude;
+    num->size = magnitude != 0;
+    num->sign = value < 0 ? Negative : Positive;
+    return 0;
+}
+
+int bignum_set(BigNum *num, const BigNum *value)
+{
+    if (num == value) {
+        return 0;
+    }
+    if (bignum_reserve(num, value->size) != 0) {
+        return -1;
+    }
+    if (value->size > 0) {
+        memcpy(num->limbs, value->limbs, sizeof(limb_t) * value->size);
+    }
+    num->size = value->size;
+    num->sign = value->sign;
+    return 0;
+}
+
+int bignum_compare(const BigNum *left, const BigNum *right)
+{
+    if (left->sign != right->sign) {
+        return left->sign == Positive ? 1 : -1;
+    }
+    int cmp = bignum_limbs_compare(
+        left->limbs, left->size, right->limbs, right->size);
+    return left->sign == Positive ? cmp : -cmp;
+}
+
+/** sum = |a| + |b| or |a| - |b| (subtract), the sign given to |a|. */
+static int bignum_add_signed(BigNum *sum,
+                             const BigNum *a,
+                             const BigNum *b,
+                             Sign a_sign,
+                             Sign b_sign)
+{
+    const BigNum *big = a;
+    const BigNum *small = b;
+    Sign sign = a_sign;
+    if (a_sign == b_sign) {
+        if (a->size < b->size) {
+            big = b;
+            small = a;
+        }
+        size_t big_size = big->size;
+        size_t small_size = small->size;
+        /** big or small may be sum, take the limbs after reserve. */
+        if (bignum_reserve(sum, big_size + 1) != 0) {
+            return -1;
+        }
+        limb_t carry = bignum_limbs_add(
+            sum->limbs, big->limbs, big_size, small->limbs, small_size);
+        sum->limbs[big_size] = carry;
+        sum->size = bignum_normalized_size(sum->limbs, big_size + 1);
+        sum->sign = sum->size == 0 ? Positive : sign;
+        return 0;
+    }
+
+    int cmp = bignum_limbs_compare(a->limbs, a->size, b->limbs, b->size);
+    if (cmp < 0) {
+        big = b;
+        small = a;
+        sign = b_sign;
+    }
+    size_t big_size = big->size;
+    size_t small_size = small->size;
+    if (bignum_reserve(sum, big_size) != 0) {
+        return -1;
+    }
+    bignum_limbs_sub(
+        sum->limbs, big->limbs, big_size, small->limbs, small_size);
+    sum->size = bignum_normalized_size(sum->limbs, big_size);
+    sum->sign = sum->size == 0 ? Positive : sign;
+    return 0;
+}
+
+int bignum_add(BigNum *sum, const BigNum *addend, const BigNum *aug)
+{
+    return bignum_add_signed(sum, addend, aug, addend->sign, aug->sign);
+}
+
+int bignum_sub(BigNum *difference,
+               const BigNum *minuend,
+               const BigNum *subtractor)
+{
+    Sign sign = subtractor->sign == Positive ? Negative : Positive;
+    return bignum_add_signed(
+        difference, minuend, subtractor, minuend->sign, sign);
+}
+
+size_t bignum_mul_size(size_t a_size, size_t b_size)
+{
+    return a_size + b_size;
+}
+
+size_t bignum_mul_scratch_size(size_t a_size, size_t b_size)
+{
+    /** the product is taken here when it is a factor. */
+    return bignum_limbs_mul_scratch_size(a_size, b_size) + a_size + b_size;
+}
+
+int bignum_mul_scratch(BigNum *product,
+                       const BigNum *multiplicand,
+                       const BigNum *multiplier,
+                       BigNumScratch *scratch)
+{
+    const BigNum *a = multiplicand;
+    const BigNum *b = multiplier;
+    if (a->size == 0 || b->size == 0) {
+        product->size = 0;
+        product->sign = Positive;
+        return 0;
+    }
+    if (a->size < b->size) {
+        a = multiplier;
+        b = multiplicand;
+    }
+
+    size_t size = a->size + b->size;
+    size_t scratch_size = bignum_limbs_mul_scratch_size(a->size, b->size);
+    int aliased = product == a || product == b;
+    if (bignum_scratch_reserve(scratch, scratch_size + (aliased ? size : 0)) !=
+            0 ||
+        (!aliased && bignum_reserve(product, size) != 0)) {
+        return -1;
+    }
+    Sign sign = a->sign == b->sign ? Positive : Negative;
+    limb_t *limbs =
+        aliased ? scratch->limbs + scratch_size : product->limbs;
+    bignum_limbs_mul_scratch(
+        limbs, a->limbs, a->size, b->limbs, b->size, scratch->limbs);
+
+    if (aliased) {
+        if (bignum_reserve(product, size) != 0) {
+            return -1;
+        }
+        memcpy(product->limbs, limbs, sizeof(limb_t) * size);
+    }
+    product->size = bignum_normalized_size(product->limbs, size);
+    product->sign = sign;
+    return 0;
+}
+
+int bignum_mul(BigNum *product,
+               const BigNum *multiplicand,
+               const BigNum *multiplier)
+{
+    BigNumScratch scratch = {NULL, 0};
+    int result =
+        bignum_mul_scratch(product, multiplicand, multiplier, &scratch);
+    free(scratch.limbs);
+    return result;
+}
+
+size_t bignum_addmul_size(size_t acc_size, size_t a_size, size_t b_size)
+{
+    return bignum_max_size(acc_size, a_size + b_size) + 1;
+}
+
+size_t bignum_addmul_scratch_size(size_t a_size, size_t b_size)
+{
+    return bignum_limbs_mul_scratch_size(a_size, b_size) + a_size + b_size;
+}
+
+int bignum_addmul(BigNum *acc,
+                  const BigNum *a,
+                  const BigNum *b,
+                  BigNumScratch *scratch)
+{
+    if (a->size == 0 || b->size == 0) {
+        return 0;
+    }
+    if (a->size < b->size) {
+        const BigNum *num = a;
+        a = b;
+        b = num;
+    }
+    Sign sign = a->sign == b->sign ? Positive : Negative;
+    size_t size = a->size + b->size;
+
+    if (b->size < bignum_thresholds.karatsuba && acc != a && acc != b &&
+        (acc->size == 0 || acc->sign == sign)) {
+        /** schoolbook rows added into acc, the carry up to its top. */
+        size_t acc_size = bignum_max_size(acc->size, size) + 1;
+        if (bignum_reserve(acc, acc_size) != 0) {
+            return -1;
+        }
+        memset(acc->limbs + acc->size,
+               0,
+               sizeof(limb_t) * (acc_size - acc->size));
+        for (size_t j = 0; j < b->size; ++j) {
+            limb_t carry = bignum_limbs_addmul_1(
+                acc->limbs + j, a->limbs, a->size, b->limbs[j]);
+            for (size_t k = j + a->size; carry != 0; ++k) {
+                acc->limbs[k] += carry;
+                carry = acc->limbs[k] < carry;
+            }
+        }
+        acc->size = bignum_normalized_size(acc->limbs, acc_size);
+        acc->sign = sign;
+        return 0;
+    }
+
+    size_t scratch_size = bignum_limbs_mul_scratch_size(a->size, b->size);
+    if (bignum_scratch_reserve(scratch, scratch_size + size) != 0) {
+        return -1;
+    }
+    BigNum product = {scratch->limbs + scratch_size, 0, size, sign};
+    bignum_limbs_mul_scratch(
+        product.limbs, a->limbs, a->size, b->limbs, b->size, scratch->limbs);
+    product.size = bignum_normalized_size(product.limbs, size);
+    return bignum_add_signed(acc, acc, &product, acc->sign, sign);
+}
+
+size_t bignum_quotient_size(size_t a_size, size_t b_size)
+{
+    return a_size >= b_size ? a_size - b_size + 1 : 0;
+}
+
+size_t bignum_remainder_size(size_t a_size, size_t b_size)
+{
+    return a_size < b_size ? a_size : b_size;
+}
+
+size_t bignum_divmod_scratch_size(size_t a_size, size_t b_size)
+{
+    if (b_size == 0 || a_size < b_size) {
+        return 0;
+    }
+    /** the quotient and remainder are taken here when not wanted. */
+    return bignum_limbs_divmod_scratch_size(a_size, b_size) + a_size + 1;
+}
+
+int bignum_divmod_scratch(BigNum *quotient,
+                          BigNum *remainder,
+                          const BigNum *dividend,
+                          const BigNum *divisor,
+                          BigNumScratch *scratch)
+{
+    if (divisor->size == 0) {
+        return -1;
+    }
+    Sign quotient_sign = dividend->sign == divisor->sign ? Positive : Negative;
+    Sign remainder_sign = dividend->sign;
+    if (bignum_limbs_compare(dividend->limbs,
+                             dividend->size,
+                             divisor->limbs,
+                             divisor->size) < 0) {
+        if (remainder != NULL && bignum_set(remainder, dividend) != 0) {
+            return -1;
+        }
+        if (quotient != NULL) {
+            quotient->size = 0;
+            quotient->sign = Positive;
+        }
+        return 0;
+    }
+
+    /** a quotient or remainder not wanted or an operand is in scratch. */
+    size_t a_size = dividend->size;
+    size_t b_size = divisor->size;
+    size_t q_size = a_size - b_size + 1;
+    int q_own = quotient != NULL && quotient != dividend &&
+                quotient != divisor;
+    int r_own = remainder != NULL && remainder != dividend &&
+                remainder != divisor && remainder != quotient;
+    size_t scratch_size = bignum_limbs_divmod_scratch_size(a_size, b_size);
+    size_t room = q_own && r_own ? 0 : a_size + 1;
+    if (bignum_scratch_reserve(scratch, scratch_size + room) != 0 ||
+        (q_own && bignum_reserve(quotient, q_size) != 0) ||
+        (r_own && bignum_reserve(remainder, b_size) != 0)) {
+        return -1;
+    }
+    limb_t *q = q_own ? quotient->limbs : scratch->limbs + scratch_size;
+    limb_t *r = r_own ? remainder->limbs
+                      : scratch->limbs + scratch_size + q_size;
+    bignum_limbs_divmod_scratch(q,
+                                r,
+                                dividend->limbs,
+                                a_size,
+                                divisor->limbs,
+                                b_size,
+                                scratch->limbs);
+
+    /** after the division, either may be the dividend or divisor. */
+    if (quotient != NULL) {
+        if (!q_own) {
+            if (bignum_reserve(quotient, q_size) != 0) {
+                return -1;
+            }
+            memcpy(quotient->limbs, q, sizeof(limb_t) * q_size);
+        }
+        quotient->size = bignum_normalized_size(quotient->limbs, q_size);
+        quotient->sign = quotient->size == 0 ? Positive : quotient_sign;
+    }
+    if (remainder != NULL) {
+        if (!r_own) {
+            if (bignum_reserve(remainder, b_size) != 0) {
+                return -1;
+            }
+            memcpy(remainder->limbs, r, sizeof(limb_t) * b_size);
+        }
+        remainder->size = bignum_normalized_size(remainder->limbs, b_size);
+        remainder->sign = remainder->size == 0 ? Positive : remainder_sign;
+    }
+    return 0;
+}
+
+int bignum_divmod(BigNum *quotient,
+                  BigNum *remainder,
+                  const BigNum *dividend,
+                  const BigNum *divisor)
+{
+    BigNumScratch scratch = {NULL, 0};
+    int result = bignum_divmod_scratch(
+        quotient, remainder, dividend, divisor, &scratch);
+    free(scratch.limbs);
+    return result;
+}
+
 /**
- * @brief Addition internal function.
- *
- * addend length always >= aug length.
- *
- * @param addend
- * @param addend_len
- * @param aug
- * @param aug_len
- * @param sum
- * @return size_t
+ * r = x * y mod m, x and y below m of size limbs, product 2 size limbs;
+ * r may be x or y. The temporaries are in scratch, grown if short.
  */
-size_t static bignum_int_addition_internal(const char *addend,
-                                           size_t addend_len,
-                                           const char *aug,
-                                           size_t aug_len,
-                                           char *sum)
-{
-    int eval;
-    int carry = 0;
-
-    // m len + n len ==> m or m + 1 len sum
-    int sum_len = addend_len + 1;
-    int index = sum_len;
-    sum[0] = '0';
-    sum[index] = '\0';
-
-    for (int i = 1; i <= aug_len; ++i) {
-        eval = char_to_int(addend[addend_len - i]) +
-               char_to_int(aug[aug_len - i]) + carry;
-        carry = eval / 10;
-        sum[--index] = int_to_char(eval % 10);
-    }
-
-    for (int i = addend_len - aug_len - 1; i >= 0; --i) {
-        eval = char_to_int(addend[i]) + carry;
-        carry = eval / 10;
-        sum[--index] = int_to_char(eval % 10);
-    }
-
-    assert(index == 1);
-    /** carry should be >= 0 and < 9 */
-    if (carry > 0) {
-        sum[--index] = int_to_char(carry);
-    } else {
-        memmove(sum, &sum[1], sum_len);
-        --sum_len;
+static int bignum_limbs_mulmod(limb_t *r,
+                               const limb_t *x,
+                               const limb_t *y,
+                               const limb_t *m,
+                               size_t size,
+                               limb_t *product,
+                               BigNumScratch *scratch)
+{
+    size_t x_size = bignum_normalized_size(x, size);
+    size_t y_size = bignum_normalized_size(y, size);
+    if (x_size == 0 || y_size == 0) {
+        memset(r, 0, sizeof(limb_t) * size);
+        return 0;
+    }
+    size_t mul_size = bignum_limbs_mul_scratch_size(x_size, y_size);
+    if (bignum_scratch_reserve(scratch, mul_size) != 0) {
+        return -1;
+    }
+    bignum_limbs_mul_scratch(product, x, x_size, y, y_size, scratch->limbs);
+    size_t product_size = bignum_normalized_size(product, x_size + y_size);
+    if (product_size < size) {
+        memcpy(r, product, sizeof(limb_t) * product_size);
+        memset(r + product_size, 0, sizeof(limb_t) * (size - product_size));
+        return 0;
     }
 
-    return sum_len;
+    /** the quotient, not wanted, then the scratch of the division. */
+    size_t q_size = product_size - size + 1;
+    if (bignum_scratch_reserve(
+            scratch,
+            q_size + bignum_limbs_divmod_scratch_size(product_size, size)) !=
+        0) {
+        return -1;
+    }
+    bignum_limbs_divmod_scratch(scratch->limbs,
+                                r,
+                                product,
+                                product_size,
+                                m,
+                                size,
+                                scratch->limbs + q_size);
+    return 0;
 }
 
-Sign bignum_int_addition(const char *addend, const char *aug, char *sum)
+/** the window of sliding window exponentiation by the exponent bits. */
+static inline unsigned int bignum_powmod_window(size_t bits)
 {
-    size_t addend_len = strlen(addend);
-    size_t aug_len = strlen(aug);
+    return bits <= 8     ? 1
+           : bits <= 24  ? 2
+           : bits <= 80  ? 3
+           : bits <= 240 ? 4
+           : bits <= 672 ? 5
+                         : 6;
+}
+
+static inline int bignum_bit(const BigNum *num, size_t i)
+{
+    return (int)((num->limbs[i / BIGNUM_LIMB_BITS] >> (i % BIGNUM_LIMB_BITS)) &
+                 1);
+}
+
+int bignum_powmod(BigNum *result,
+                  const BigNum *base,
+                  const BigNum *exponent,
+                  const BigNum *modulus)
+{
+    if (modulus->size == 0 || modulus->sign == Negative ||
+        exponent->sign == Negative) {
+        return -1;
+    }
+    size_t n = modulus->size;
+    const limb_t *m = modulus->limbs;
+    size_t bits = exponent->size == 0
+                      ? 0
+                      : exponent->size * BIGNUM_LIMB_BITS -
+                            bignum_limb_clz(
+                                exponent->limbs[exponent->size - 1]);
+    unsigned int window = bignum_powmod_window(bits);
+    size_t num_powers = (size_t)1 << (window - 1);
 
-    if (addend_len < aug_len) {
-        bignum_int_addition_internal(aug, aug_len, addend, addend_len, sum);
+    /** the result, then x, x^2, the odd powers and a product. */
+    BigNumScratch scratch = {NULL, 0};
+    limb_t *acc = (limb_t *)malloc(sizeof(limb_t) * n);
+    limb_t *buffer =
+        (limb_t *)malloc(sizeof(limb_t) * n * (num_powers + 4));
+    if (acc == NULL || buffer == NULL) {
+        free(acc);
+        free(buffer);
+        return -1;
+    }
+    limb_t *x = buffer;
+    limb_t *x2 = x + n;
+    limb_t *product = x2 + n;
+    limb_t *powers = product + 2 * n;
+
+    /** x = base mod m, in [0, m). */
+    int failed = 0;
+    if (base->size >= n) {
+        failed = bignum_limbs_divmod(NULL, x, base->limbs, base->size, m, n);
     } else {
-        bignum_int_addition_internal(addend, addend_len, aug, aug_len, sum);
+        if (base->size > 0) {
+            memcpy(x, base->limbs, sizeof(limb_t) * base->size);
+        }
+        memset(x + base->size, 0, sizeof(limb_t) * (n - base->size));
+    }
+    if (!failed && base->sign == Negative &&
+        bignum_normalized_size(x, n) > 0) {
+        bignum_limbs_sub(x, m, n, x, n);
+    }
+
+    /** 1 mod m. */
+    memset(acc, 0, sizeof(limb_t) * n);
+    acc[0] = n > 1 || m[0] > 1;
+
+    /** powers[i] = x^(2i + 1). */
+    memcpy(powers, x, sizeof(limb_t) * n);
+    if (!failed && num_powers > 1) {
+        failed = bignum_limbs_mulmod(x2, x, x, m, n, product, &scratch);
+        for (size_t i = 1; i < num_powers && !failed; ++i) {
+            failed = bignum_limbs_mulmod(powers + i * n,
+                                         powers + (i - 1) * n,
+                                         x2,
+                                         m,
+                                         n,
+                                         product,
+                                         &scratch);
+        }
+    }
+
+    /** left to right, each window an odd power. */
+    int started = 0;
+    size_t i = bits;
+    while (i > 0 && !failed) {
+        --i;
+        if (!bignum_bit(exponent, i)) {
+            if (started) {
+                failed = bignum_limbs_mulmod(
+                    acc, acc, acc, m, n, product, &scratch);
+            }
+            continue;
+        }
+        size_t low = i + 1 >= window ? i + 1 - window : 0;
+        while (!bignum_bit(exponent, low)) {
+            ++low;
+        }
+        size_t value = 0;
+        for (size_t j = i + 1; j-- > low;) {
+            value = (value << 1) | (size_t)bignum_bit(exponent, j);
+        }
+        const limb_t *power = powers + (value >> 1) * n;
+        if (started) {
+            for (size_t j = low; j <= i && !failed; ++j) {
+                failed = bignum_limbs_mulmod(
+                    acc, acc, acc, m, n, product, &scratch);
+            }
+            if (!failed) {
+                failed = bignum_limbs_mulmod(
+                    acc, acc, power, m, n, product, &scratch);
+            }
+        } else {
+            memcpy(acc, power, sizeof(limb_t) * n);
+            started = 1;
+        }
+        i = low;
+    }
+
+    free(buffer);
+    free(scratch.limbs);
+    if (failed) {
+        free(acc);
+        return -1;
+    }
+    bignum_assign(result, acc, n, n, Positive);
+    return 0;
+}
+
+/** gcd of two limbs, Euclid. */
+static limb_t bignum_limb_gcd(limb_t a, limb_t b)
+{
+    while (b != 0) {
+        limb_t t = a % b;
+        a = b;
+        b = t;
     }
-    return Positive;
+    return a;
 }
 
 /**
- * @brief Subtraction internal function.
- *
- * minuend length always >= subtractor length.
- *
- * @param minuend
- * @param subtractor
- * @param difference
- * @return size_t
+ * the 62 bits of x below the top bit of u, u_size >= 2 limbs: the cofactors
+ * stay below 2^62 too, so x + A and the products fit in int64_t.
  */
-static size_t bignum_int_subtraction_internal(const char *minuend,
-                                              const char *subtractor,
-                                              char *difference)
-{
-    size_t minuend_len = strlen(minuend);
-    size_t subtractor_len = strlen(subtractor);
-
-    // m len - n len ==> diff len <= m
-    int diff_len = minuend_len;
-    int index = diff_len;
-    difference[index] = '\0';
-
-    int borrow = 0;
-    for (int i = 1; i <= subtractor_len; ++i) {
-        int m = char_to_int(minuend[minuend_len - i]) - borrow;
-        int s = char_to_int(subtractor[subtractor_len - i]);
-        --index;
-        if (m < s) {
-            difference[index] = int_to_char(10 + m - s);
-            borrow = 1;
-        } else {
-            difference[index] = int_to_char(m - s);
-            borrow = 0;
+static inline limb_t
+bignum_lehmer_digit(const limb_t *x, size_t x_size, size_t u_size, int shift)
+{
+    limb_t high = x_size >= u_size ? x[u_size - 1] : 0;
+    limb_t low = x_size >= u_size - 1 ? x[u_size - 2] : 0;
+    limb_t digit = shift == 0 ? high
+                              : (high << shift) |
+                                    (low >> (BIGNUM_LIMB_BITS - shift));
+    return digit >> 2;
+}
+
+/** result = x * p - y * q, size + 1 limbs, not negative. */
+static void bignum_limbs_lincomb(limb_t *result,
+                                 const limb_t *x,
+                                 limb_t p,
+                                 const limb_t *y,
+                                 limb_t q,
+                                 size_t size)
+{
+    result[size] = bignum_limbs_mul_1(result, x, size, p, 0);
+    result[size] -= bignum_limbs_submul_1(result, y, size, q);
+}
+
+int bignum_gcd(BigNum *result, const BigNum *a, const BigNum *b)
+{
+    const BigNum *big = a;
+    const BigNum *small = b;
+    if (bignum_limbs_compare(a->limbs, a->size, b->limbs, b->size) < 0) {
+        big = b;
+        small = a;
+    }
+    size_t n = big->size;
+    if (small->size == 0) {
+        if (bignum_set(result, big) != 0) {
+            return -1;
         }
+        result->sign = Positive;
+        return 0;
+    }
+
+    /** u >= v, two more for the next u and v; zeros above v_size. */
+    limb_t *buffer = (limb_t *)malloc(sizeof(limb_t) * 4 * (n + 1));
+    if (buffer == NULL) {
+        return -1;
     }
+    limb_t *u = buffer;
+    limb_t *v = u + n + 1;
+    limb_t *s = v + n + 1;
+    limb_t *t = s + n + 1;
+    memcpy(u, big->limbs, sizeof(limb_t) * n);
+    memset(v, 0, sizeof(limb_t) * (n + 1));
+    memcpy(v, small->limbs, sizeof(limb_t) * small->size);
+    size_t u_size = n;
+    size_t v_size = small->size;
+
+    while (v_size > 1) {
+        int step = 0;
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        if (u_size - v_size <= 1) {
+            /** Euclid on the leading 62 bits while the quotients agree. */
+            int shift = (int)bignum_limb_clz(u[u_size - 1]);
+            int64_t x = (int64_t)bignum_lehmer_digit(u, u_size, u_size, shift);
+            int64_t y = (int64_t)bignum_lehmer_digit(v, v_size, u_size, shift);
+            while (y + C != 0 && y + D != 0) {
+                int64_t q = (x + A) / (y + C);
+                if (q != (x + B) / (y + D)) {
+                    break;
+                }
+                int64_t temp = A - q * C;
+                A = C;
+                C = temp;
+                temp = B - q * D;
+                B = D;
+                D = temp;
+                temp = x - q * y;
+                x = y;
+                y = temp;
+            }
+            step = B != 0;
+        }
 
-    /** If minuend_len > subtractor_len */
-    for (int i = subtractor_len + 1; i <= minuend_len; ++i) {
-        int m = char_to_int(minuend[minuend_len - i]) - borrow;
-        --index;
-        if (m < 0) {
-            difference[index] = int_to_char(10 + m);
-            borrow = 1;
+        limb_t *swap;
+        if (step) {
+            /** u, v = A u + B v, C u + D v: the signs alternate. */
+            if (B <= 0) {
+                bignum_limbs_lincomb(s, u, (limb_t)A, v, (limb_t)-B, u_size);
+            } else {
+                bignum_limbs_lincomb(s, v, (limb_t)B, u, (limb_t)-A, u_size);
+            }
+            if (D <= 0) {
+                bignum_limbs_lincomb(t, u, (limb_t)C, v, (limb_t)-D, u_size);
+            } else {
+                bignum_limbs_lincomb(t, v, (limb_t)D, u, (limb_t)-C, u_size);
+            }
+            swap = u;
+            u = s;
+            s = swap;
+            swap = v;
+            v = t;
+            t = swap;
+            u_size = bignum_normalized_size(u, u_size + 1);
+            v_size = bignum_normalized_size(v, u_size);
         } else {
-            difference[index] = int_to_char(m);
-            borrow = 0;
+            /** u, v = v, u mod v. */
+            if (bignum_limbs_divmod(NULL, s, u, u_size, v, v_size) != 0) {
+                free(buffer);
+                return -1;
+            }
+            memset(s + v_size, 0, sizeof(limb_t) * (n + 1 - v_size));
+            swap = u;
+            u = v;
+            v = s;
+            s = swap;
+            u_size = v_size;
+            v_size = bignum_normalized_size(v, v_size);
         }
     }
 
-    assert(index == 0);
-    return bignum_int_trim_head_zero(difference, diff_len);
+    if (v_size == 1) {
+        limb_t r = bignum_limbs_divrem_1(s, u, u_size, v[0]);
+        u[0] = bignum_limb_gcd(v[0], r);
+        u_size = 1;
+    }
+    limb_t *limbs = (limb_t *)malloc(sizeof(limb_t) * u_size);
+    if (limbs == NULL) {
+        free(buffer);
+        return -1;
+    }
+    memcpy(limbs, u, sizeof(limb_t) * u_size);
+    free(buffer);
+    bignum_assign(result, limbs, u_size, u_size, Positive);
+    return 0;
 }
 
-Sign bignum_int_subtraction(const char *minuend,
-                            const char *subtractor,
-                            char *difference)
+int bignum_shift_left(BigNum *result, const BigNum *num, size_t bits)
 {
-    int cmp = bignum_int_compare(minuend, subtractor);
-
-    if (cmp < 0) {
-        bignum_int_subtraction_internal(subtractor, minuend, difference);
-        return Negative;
-    } else if (cmp > 0) {
-        bignum_int_subtraction_internal(minuend, subtractor, difference);
-        return Positive;
-    } else {
-        strcpy(difference, BIG_NUM_ZERO);
-        return Positive;
+    if (num->size == 0) {
+        result->size = 0;
+        result->sign = Positive;
+        return 0;
+    }
+    size_t limbs_shift = bits / BIGNUM_LIMB_BITS;
+    size_t size = num->size + limbs_shift + 1;
+    limb_t *limbs = (limb_t *)malloc(sizeof(limb_t) * size);
+    if (limbs == NULL) {
+        return -1;
     }
+    memset(limbs, 0, sizeof(limb_t) * limbs_shift);
+    limbs[size - 1] = bignum_limbs_lshift(limbs + limbs_shift,
+                                          num->limbs,
+                                          num->size,
+                                          bits % BIGNUM_LIMB_BITS);
+    bignum_assign(result, limbs, size, size, num->sign);
+    return 0;
 }
 
-static size_t bignum_int_multiplication_move(char *num, size_t len, size_t move)
+int bignum_shift_right(BigNum *result, const BigNum *num, size_t bits)
 {
-    for (size_t i = 0; i < move; ++i) {
-        num[len + i] = '0';
+    size_t limbs_shift = bits / BIGNUM_LIMB_BITS;
+    if (limbs_shift >= num->size) {
+        result->size = 0;
+        result->sign = Positive;
+        return 0;
     }
-    size_t new_len = len + move;
-    num[new_len] = '\0';
-    return new_len;
+    size_t size = num->size - limbs_shift;
+    Sign sign = num->sign;
+    if (bignum_reserve(result, size) != 0) {
+        return -1;
+    }
+    /** in place from low to high, result may be num. */
+    bignum_limbs_rshift(result->limbs,
+                        num->limbs + limbs_shift,
+                        size,
+                        bits % BIGNUM_LIMB_BITS);
+    result->size = bignum_normalized_size(result->limbs, size);
+    result->sign = result->size == 0 ? Positive : sign;
+    return 0;
 }
 
 /**
- * @brief Multiplication internal function.
- *
- * multiplicand length always >= multiplier length.
- *
- * @param multiplicand
- * @param multiplicand_len
- * @param multiplier
- * @param multiplier_len
- * @param product
- * @return size_t
+ * The powers 10^(19 * 2^k) splitting decimal digits, each the square of
+ * the one before.
  */
-static size_t bignum_int_multiplication_internal(const char *multiplicand,
-                                                 size_t multiplicand_len,
-                                                 const char *multiplier,
-                                                 size_t multiplier_len,
-                                                 char *product)
-{
-    int move = 0;
-    int factor = 0;
-    size_t product_len = multiplicand_len + multiplier_len;
-    strcpy(product, BIG_NUM_ZERO);
-    char *tmp_product = (char *)malloc(sizeof(char) * product_len);
-    size_t tmp_product_len = 1;
-    strcpy(tmp_product, BIG_NUM_ZERO);
-    char *tmp_multip = (char *)malloc(sizeof(char) * product_len);
-    size_t tmp_multip_len = 0;
+typedef struct _BignumTenPowers {
+    limb_t *limbs[BIGNUM_LIMB_BITS];
+    size_t sizes[BIGNUM_LIMB_BITS];
+    int count;
+} BignumTenPowers;
 
-    /**
-     * 123 * 10 = 1230, 123 * 100 = 12300,
-     * If a number multiply by a multiple of ten, it will append the multiple of
-     * 0.
-     */
-    for (int i = multiplier_len - 1; i >= 0; --i, ++move) {
-        strcpy(tmp_multip, multiplicand);
-        tmp_multip_len =
-            bignum_int_multiplication_move(tmp_multip, multiplicand_len, move);
-
-        factor = char_to_int(multiplier[i]);
-        for (int j = 0; j < factor; ++j) {
-            strcpy(tmp_product, product);
-            if (tmp_product_len < tmp_multip_len) {
-                tmp_product_len = bignum_int_addition_internal(tmp_multip,
-                                                               tmp_multip_len,
-                                                               tmp_product,
-                                                               tmp_product_len,
-                                                               product);
-            } else {
-                tmp_product_len = bignum_int_addition_internal(tmp_product,
-                                                               tmp_product_len,
-                                                               tmp_multip,
-                                                               tmp_multip_len,
-                                                               product);
+static void bignum_ten_powers_free(BignumTenPowers *powers)
+{
+    for (int k = 0; k < powers->count; ++k) {
+        free(powers->limbs[k]);
+    }
+}
+
+/** the powers up to 10^(19 * 2^k) of at most digits digits. */
+static int bignum_ten_powers_init(BignumTenPowers *powers, size_t digits)
+{
+    powers->count = 0;
+    powers->limbs[0] = (limb_t *)malloc(sizeof(limb_t));
+    if (powers->limbs[0] == NULL) {
+        return -1;
+    }
+    powers->limbs[0][0] = BIGNUM_LIMB_TEN_POWER;
+    powers->sizes[0] = 1;
+    powers->count = 1;
+
+    size_t power_digits = BIGNUM_LIMB_DIGITS;
+    while (power_digits * 2 <= digits) {
+        int k = powers->count;
+        size_t size = powers->sizes[k - 1];
+        limb_t *limbs = (limb_t *)malloc(sizeof(limb_t) * size * 2);
+        if (limbs == NULL || bignum_limbs_mul(limbs,
+                                              powers->limbs[k - 1],
+                                              size,
+                                              powers->limbs[k - 1],
+                                              size) != 0) {
+            free(limbs);
+            bignum_ten_powers_free(powers);
+            return -1;
+        }
+        powers->limbs[k] = limbs;
+        powers->sizes[k] = bignum_normalized_size(limbs, size * 2);
+        ++powers->count;
+        power_digits *= 2;
+    }
+    return 0;
+}
+
+/** the value of 1 to 19 digits. */
+static inline limb_t bignum_parse_limb(const char *digits, size_t length)
+{
+    limb_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+        value = value * 10 + (limb_t)char_to_int(digits[i]);
+    }
+    return value;
+}
+
+/**
+ * parse length digits to result, at least length / 19 + 1 limbs, return
+ * the size.
+ */
+static size_t bignum_parse_digits(limb_t *result,
+                                  const char *digits,
+                                  size_t length,
+                                  const BignumTenPowers *powers)
+{
+    if (length <= BIGNUM_PARSE_SPLIT_DIGITS || powers->count < 2) {
+        /** 19 digits at a time: result = result * 10^19 + limb. */
+        size_t head = length % BIGNUM_LIMB_DIGITS;
+        if (head == 0) {
+            head = BIGNUM_LIMB_DIGITS;
+        }
+        size_t size = 0;
+        limb_t limb = bignum_parse_limb(digits, head);
+        if (limb != 0) {
+            result[size++] = limb;
+        }
+        for (size_t i = head; i < length; i += BIGNUM_LIMB_DIGITS) {
+            limb = bignum_parse_limb(digits + i, BIGNUM_LIMB_DIGITS);
+            limb_t carry = bignum_limbs_mul_1(
+                result, result, size, BIGNUM_LIMB_TEN_POWER, limb);
+            if (carry != 0) {
+                result[size++] = carry;
             }
         }
+        return size;
+    }
+
+    /** split at the largest 19 * 2^k below length. */
+    int k = powers->count - 1;
+    size_t low_digits = (size_t)BIGNUM_LIMB_DIGITS << k;
+    while (low_digits >= length) {
+        --k;
+        low_digits >>= 1;
+    }
+    size_t high_digits = length - low_digits;
+
+    /** result = high * 10^low_digits + low. */
+    size_t low_capacity = low_digits / BIGNUM_LIMB_DIGITS + 1;
+    size_t high_capacity = high_digits / BIGNUM_LIMB_DIGITS + 1;
+    limb_t *buffer =
+        (limb_t *)malloc(sizeof(limb_t) * (low_capacity + high_capacity));
+    if (buffer == NULL) {
+        return (size_t)-1;
+    }
+    limb_t *low = buffer;
+    limb_t *high = buffer + low_capacity;
+    size_t high_size = bignum_parse_digits(high, digits, high_digits, powers);
+    size_t low_size = bignum_parse_digits(
+        low, digits + high_digits, low_digits, powers);
+    if (high_size == (size_t)-1 || low_size == (size_t)-1) {
+        free(buffer);
+        return (size_t)-1;
     }
 
-    free(tmp_product);
-    free(tmp_multip);
-    return tmp_product_len;
+    size_t size = 0;
+    if (high_size > 0) {
+        const limb_t *power = powers->limbs[k];
+        size_t power_size = powers->sizes[k];
+        if (bignum_limbs_mul(result, high, high_size, power, power_size) !=
+            0) {
+            free(buffer);
+            return (size_t)-1;
+        }
+        size = high_size + power_size;
+    }
+    if (low_size > size) {
+        memcpy(result + size, low + size, sizeof(limb_t) * (low_size - size));
+        memset(result, 0, sizeof(limb_t) * size);
+        size = low_size;
+    }
+    /** low < 10^low_digits <= the product part, so no carry out of size. */
+    if (low_size > 0) {
+        limb_t carry = bignum_limbs_add(result, result, size, low, low_size);
+        if (carry != 0) {
+            result[size++] = carry;
+        }
+    }
+    free(buffer);
+    return bignum_normalized_size(result, size);
 }
 
-Sign bignum_int_multiplication(const char *multiplicand,
-                               const char *multiplier,
-                               char *product)
+int bignum_from_string(BigNum *num, const char *string)
 {
-    size_t multiplicand_len = strlen(multiplicand);
-    size_t multiplier_len = strlen(multiplier);
+    Sign sign = Positive;
+    if (char_is_negative_sign(*string)) {
+        sign = Negative;
+        ++string;
+    } else if (char_is_positive_sign(*string)) {
+        ++string;
+    }
+    size_t length = strlen(string);
+    num->size = 0;
+    num->sign = Positive;
+    if (length == 0 || !string_is_all_digits(string, length)) {
+        return -1;
+    }
+    while (length > 1 && char_is_zero(*string)) {
+        ++string;
+        --length;
+    }
 
-    if (multiplicand_len < multiplier_len) {
-        bignum_int_multiplication_internal(multiplier,
-                                           multiplier_len,
-                                           multiplicand,
-                                           multiplicand_len,
-                                           product);
-    } else {
-        bignum_int_multiplication_internal(multiplicand,
-                                           multiplicand_len,
-                                           multiplier,
-                                           multiplier_len,
-                                           product);
+    BignumTenPowers powers;
+    if (bignum_reserve(num, length / BIGNUM_LIMB_DIGITS + 1) != 0 ||
+        bignum_ten_powers_init(&powers,
+                               length > BIGNUM_PARSE_SPLIT_DIGITS ? length
+                                                                  : 0) !=
+            0) {
+        return -1;
+    }
+    size_t size = bignum_parse_digits(num->limbs, string, length, &powers);
+    bignum_ten_powers_free(&powers);
+    if (size == (size_t)-1) {
+        return -1;
     }
-    return Positive;
+    num->size = size;
+    num->sign = size == 0 ? Positive : sign;
+    return 0;
 }
 
-static size_t bignum_int_append_char(char *num, size_t len, char ch)
+/** write a limb below 10^19 as exactly width digits, right-aligned. */
+static inline void bignum_print_limb(char *out, limb_t limb, size_t width)
 {
-    int new_len = len + 1;
-    num[len] = ch;
-    num[new_len] = '\0';
-    return new_len;
+    for (size_t i = width; i-- > 0;) {
+        out[i] = (char)int_to_char((int)(limb % 10));
+        limb /= 10;
+    }
 }
 
 /**
- * @brief Division internal function.
- *
- * dividend length always >= divisor length.
- *
- * @param dividend
- * @param divisor
- * @param quotient
- * @param remainder
+ * write a (size limbs, a < 10^width) as exactly width digits, zeros
+ * leading; a is destroyed.
  */
-static void bignum_int_division_internal(const char *dividend,
-                                         const char *divisor,
-                                         char *quotient,
-                                         char *remainder)
+static int bignum_print_digits(char *out,
+                               size_t width,
+                               limb_t *a,
+                               size_t size,
+                               const BignumTenPowers *powers)
 {
-    size_t dividend_len = strlen(dividend);
-    size_t divisor_len = strlen(divisor);
+    size = bignum_normalized_size(a, size);
+    if (size <= BIGNUM_PRINT_SPLIT_LIMBS || powers->count < 2) {
+        /** 19 digits at a time, from the lowest: a = a / 10^19. */
+        size_t end = width;
+        while (size > 0 && end > 0) {
+            limb_t limb =
+                bignum_limbs_divrem_1(a, a, size, BIGNUM_LIMB_TEN_POWER);
+            size = bignum_normalized_size(a, size);
+            size_t count = end < BIGNUM_LIMB_DIGITS ? end : BIGNUM_LIMB_DIGITS;
+            bignum_print_limb(out + end - count, limb, count);
+            end -= count;
+        }
+        memset(out, '0', end);
+        return 0;
+    }
 
-    char *tmp_dividend = (char *)malloc(sizeof(char) * dividend_len);
-    char *tmp_diff = (char *)malloc(sizeof(char) * dividend_len);
-    size_t quotient_len = 0;
+    /** split at the largest 19 * 2^k below width, a = q * 10^k + r. */
+    int k = powers->count - 1;
+    size_t low_digits = (size_t)BIGNUM_LIMB_DIGITS << k;
+    while (k > 0 && (low_digits >= width || powers->sizes[k] > size)) {
+        --k;
+        low_digits >>= 1;
+    }
+    const limb_t *power = powers->limbs[k];
+    size_t power_size = powers->sizes[k];
+    if (power_size > size || low_digits >= width) {
+        /** too small to split. */
+        BignumTenPowers none = *powers;
+        none.count = 1;
+        return bignum_print_digits(out, width, a, size, &none);
+    }
 
-    /**
-     * Treat division as couple of subtractions.
-     */
+    size_t q_size = size - power_size + 1;
+    limb_t *buffer = (limb_t *)malloc(sizeof(limb_t) * (q_size + power_size));
+    if (buffer == NULL) {
+        return -1;
+    }
+    limb_t *q = buffer;
+    limb_t *r = buffer + q_size;
+    if (bignum_limbs_divmod(q, r, a, size, power, power_size) != 0 ||
+        bignum_print_digits(out, width - low_digits, q, q_size, powers) != 0 ||
+        bignum_print_digits(
+            out + width - low_digits, low_digits, r, power_size, powers) !=
+            0) {
+        free(buffer);
+        return -1;
+    }
+    free(buffer);
+    return 0;
+}
 
-    // 123456 / 789 => first try: 123 / 789 , then move to right
-    size_t tmp_dividend_len =
-        divisor_len - 1; // just copy 12, 3 will be append in loop
-    memcpy(tmp_dividend, dividend, tmp_dividend_len);
-    tmp_dividend[tmp_dividend_len] = '\0';
-    for (int cursor = tmp_dividend_len; cursor < dividend_len; ++cursor) {
-        tmp_dividend_len = bignum_int_append_char(
-            tmp_dividend, tmp_dividend_len, dividend[cursor]);
+/** the decimal digits of the magnitude, malloc'ed, without sign. */
+static char *bignum_to_digits(const BigNum *num, size_t *length)
+{
+    /** log10(2) < 0.30103, at least one digit. */
+    size_t width =
+        (size_t)((uint64_t)num->size * BIGNUM_LIMB_BITS * 30103 / 100000) + 1;
+    char *digits = (char *)malloc(width + 1);
+    limb_t *a = (limb_t *)malloc(sizeof(limb_t) * (num->size + 1));
+    BignumTenPowers powers;
+    powers.count = 0;
+    if (digits == NULL || a == NULL ||
+        bignum_ten_powers_init(
+            &powers,
+            num->size > BIGNUM_PRINT_SPLIT_LIMBS ? width : 0) != 0) {
+        free(digits);
+        free(a);
+        return NULL;
+    }
 
-        int times = 0;
-        while (bignum_int_compare(tmp_dividend, divisor) >= 0) {
-            tmp_dividend_len = bignum_int_subtraction_internal(
-                tmp_dividend, divisor, tmp_diff);
-            strcpy(tmp_dividend, tmp_diff);
-            ++times;
-        }
+    if (num->size > 0) {
+        memcpy(a, num->limbs, sizeof(limb_t) * num->size);
+    }
+    int result = bignum_print_digits(digits, width, a, num->size, &powers);
+    bignum_ten_powers_free(&powers);
+    free(a);
+    if (result != 0) {
+        free(digits);
+        return NULL;
+    }
 
-        if (quotient_len != 0 || times != 0) {
-            quotient[quotient_len++] = int_to_char(times);
-        }
+    size_t zeros = 0;
+    while (zeros + 1 < width && char_is_zero(digits[zeros])) {
+        ++zeros;
+    }
+    memmove(digits, digits + zeros, width - zeros);
+    *length = width - zeros;
+    digits[*length] = '\0';
+    return digits;
+}
+
+char *bignum_to_string(const BigNum *num)
+{
+    size_t length;
+    char *digits = bignum_to_digits(num, &length);
+    if (digits == NULL || num->sign == Positive) {
+        return digits;
+    }
+    char *string = (char *)malloc(length + 2);
+    if (string != NULL) {
+        string[0] = '-';
+        memcpy(string + 1, digits, length + 1);
+    }
+    free(digits);
+    return string;
+}
+
+/** The operands of a string function, parsed. */
+typedef struct _BignumOperands {
+    BigNum a;
+    BigNum b;
+    BigNum c;
+    BigNum d;
+} BignumOperands;
+
+static int bignum_operands_parse(BignumOperands *operands,
+                                 const char *left,
+                                 const char *right)
+{
+    memset(operands, 0, sizeof(BignumOperands));
+    operands->a.sign = operands->b.sign = Positive;
+    operands->c.sign = operands->d.sign = Positive;
+    return bignum_from_string(&(operands->a), left) == 0 &&
+                   bignum_from_string(&(operands->b), right) == 0
+               ? 0
+               : -1;
+}
+
+static void bignum_operands_free(BignumOperands *operands)
+{
+    free(operands->a.limbs);
+    free(operands->b.limbs);
+    free(operands->c.limbs);
+    free(operands->d.limbs);
+}
+
+/** print the magnitude to output, "NaN" if out of memory. */
+static Sign bignum_print_to(const BigNum *num, char *output)
+{
+    size_t length;
+    char *digits = bignum_to_digits(num, &length);
+    if (digits == NULL) {
+        strcpy(output, BIG_NUM_NOT_A_NUM);
+        return NaN;
+    }
+    memcpy(output, digits, length + 1);
+    free(digits);
+    return num->sign;
+}
+
+Sign bignum_int_addition(const char *addend, const char *aug, char *sum)
+{
+    BignumOperands operands;
+    Sign sign = NaN;
+    if (bignum_operands_parse(&operands, addend, aug) == 0 &&
+        bignum_add(&(operands.c), &(operands.a), &(operands.b)) == 0) {
+        sign = bignum_print_to(&(operands.c), sum);
+    } else {
+        strcpy(sum, BIG_NUM_NOT_A_NUM);
     }
+    bignum_operands_free(&operands);
+    return sign;
+}
 
-    quotient[quotient_len] = '\0';
-    strcpy(remainder, tmp_dividend);
+Sign bignum_int_subtraction(const char *minuend,
+                            const char *subtractor,
+                            char *difference)
+{
+    BignumOperands operands;
+    Sign sign = NaN;
+    if (bignum_operands_parse(&operands, minuend, subtractor) == 0 &&
+        bignum_sub(&(operands.c), &(operands.a), &(operands.b)) == 0) {
+        sign = bignum_print_to(&(operands.c), difference);
+    } else {
+        strcpy(difference, BIG_NUM_NOT_A_NUM);
+    }
+    bignum_operands_free(&operands);
+    return sign;
+}
 
-    free(tmp_dividend);
-    free(tmp_diff);
+Sign bignum_int_multiplication(const char *multiplicand,
+                               const char *multiplier,
+                               char *product)
+{
+    BignumOperands operands;
+    Sign sign = NaN;
+    if (bignum_operands_parse(&operands, multiplicand, multiplier) == 0 &&
+        bignum_mul(&(operands.c), &(operands.a), &(operands.b)) == 0) {
+        sign = bignum_print_to(&(operands.c), product);
+    } else {
+        strcpy(product, BIG_NUM_NOT_A_NUM);
+    }
+    bignum_operands_free(&operands);
+    return sign;
 }
 
 Sign bignum_int_division(const char *dividend,
@@ -471,17 +2653,21 @@ Sign bignum_int_division(const char *dividend,
         return Positive;
     }
 
-    int cmp = bignum_int_compare(dividend, divisor);
-
-    if (cmp < 0) {
-        strcpy(quotient, BIG_NUM_ZERO);
-        strcpy(remainder, dividend);
-    } else if (cmp > 0) {
-        bignum_int_division_internal(dividend, divisor, quotient, remainder);
+    BignumOperands operands;
+    Sign sign = NaN;
+    if (bignum_operands_parse(&operands, dividend, divisor) == 0 &&
+        bignum_divmod(&(operands.c),
+                      &(operands.d),
+                      &(operands.a),
+                      &(operands.b)) == 0) {
+        sign = bignum_print_to(&(operands.c), quotient);
+        if (bignum_print_to(&(operands.d), remainder) == NaN) {
+            sign = NaN;
+        }
     } else {
-        strcpy(quotient, BIG_NUM_ONE);
+        strcpy(quotient, BIG_NUM_NOT_A_NUM);
         strcpy(remainder, BIG_NUM_ZERO);
     }
-
-    return Positive;
+    bignum_operands_free(&operands);
+    return sign;
 }
@@ -17,6 +17,34 @@
  *
  * To do division, use @ref bignum_int_division.
  *
+ * The string functions above are wrappers of @ref BigNum, a binary big
+ * integer of 64-bit limbs, least significant first: parse the strings,
+ * calculate on limbs, and print. Use BigNum itself to keep numbers binary
+ * between operations, and convert by @ref bignum_from_string and
+ * @ref bignum_to_string. Decimal conversion is divide-and-conquer: the
+ * digits are split at 19 * 2^k, the halves joined by a multiplication by a
+ * power of 10 (parse), or split by a division by it (print).
+ *
+ * Multiplication picks by the size of the smaller operand: schoolbook,
+ * then Karatsuba, Toom-3 (points 0, 1, -1, 2, infinity), and above all a
+ * number theoretic transform over three primes below 2^62, joined by the
+ * Chinese remainder theorem. An operand twice as long as the other or more
+ * is cut into pieces of the shorter one. The thresholds are measured by
+ * benchmark/bench_bignum_mul.
+ *
+ * Division is Knuth's algorithm D, or for a long divisor and quotient
+ * Burnikel-Ziegler: the divisor padded to j * 2^k limbs, the dividend cut
+ * into blocks of that size, each two blocks by one divided recursively by
+ * two divisions of three halves by two, which multiply. GCD is Lehmer's,
+ * the leading 63 bits run by Euclid, with a division where the sizes
+ * differ; modular exponentiation is a sliding window, reduced by division.
+ *
+ * Multiplication and division take their temporaries from a
+ * @ref BigNumScratch by the functions ending in _scratch, and
+ * @ref bignum_addmul accumulates a product in place. Their output and
+ * scratch sizes are reported up front, so that a loop reserving them once
+ * allocates nothing; the functions without scratch use a new one a call.
+ *
  * @date 2019-07-20
  *
  * @copyright Copyright (c) 2019, hutusi.com
@@ -26,12 +54,38 @@
 #ifndef RETHINK_C_BIGNUM_H
 #define RETHINK_C_BIGNUM_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * @brief The sign type to differentiate positive or negative number.
  *        NaN means Not a Number.
  */
 typedef enum _Sign { Positive = 1, Negative = -1, NaN = 0 } Sign;
 
+/**
+ * @brief A limb of a BigNum.
+ */
+typedef uint64_t limb_t;
+
+#define BIGNUM_LIMB_BITS 64
+
+/**
+ * @brief Definition of a @ref BigNum.
+ *
+ * The magnitude is limbs[0] + limbs[1] * 2^64 + ..., without leading zero
+ * limbs: zero has size 0 and is Positive.
+ */
+typedef struct _BigNum {
+    limb_t *limbs;
+    /** The number of limbs of the magnitude. */
+    size_t size;
+    /** The number of limbs allocated. */
+    size_t capacity;
+    /** Positive or Negative. */
+    Sign sign;
+} BigNum;
+
 /**
  * @brief Compare an number with zero.
  *
@@ -112,4 +166,297 @@ Sign bignum_int_division(const char *dividend,
                          char *quotient,
                          char *remainder);
 
+/**
+ * @brief Allocate a new BigNum of value 0.
+ *
+ * @return BigNum*  The new BigNum, NULL if out of memory.
+ */
+BigNum *bignum_new();
+
+/**
+ * @brief Delete a BigNum and free back memory.
+ *
+ * @param num   The BigNum.
+ */
+void bignum_free(BigNum *num);
+
+/**
+ * @brief Set a BigNum to an integer.
+ *
+ * @param num       The BigNum.
+ * @param value     The integer.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_set_int(BigNum *num, int64_t value);
+
+/**
+ * @brief Set a BigNum to the value of another.
+ *
+ * @param num       The BigNum.
+ * @param value     The other BigNum.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_set(BigNum *num, const BigNum *value);
+
+/**
+ * @brief Parse a decimal string: an optional sign, then digits.
+ *
+ * @param num       The BigNum, 0 if the string is not a number.
+ * @param string    The string, see @ref bignum_int_sanitize for others.
+ * @return int      0 if success, -1 if not a number or out of memory.
+ */
+int bignum_from_string(BigNum *num, const char *string);
+
+/**
+ * @brief Print a BigNum in decimal, '-' first if negative.
+ *
+ * @param num       The BigNum.
+ * @return char*    The malloc'ed string, NULL if out of memory.
+ */
+char *bignum_to_string(const BigNum *num);
+
+/**
+ * @brief Compare two BigNums.
+ *
+ * @param left   The first BigNum.
+ * @param right  The second BigNum.
+ * @return int   1 if left greater than right, -1 if right greater than left,
+ *               0 if left equals right.
+ */
+int bignum_compare(const BigNum *left, const BigNum *right);
+
+/**
+ * @brief sum = addend + aug, any of them may be the same BigNum.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_add(BigNum *sum, const BigNum *addend, const BigNum *aug);
+
+/**
+ * @brief difference = minuend - subtractor, any of them may be the same
+ * BigNum.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_sub(BigNum *difference,
+               const BigNum *minuend,
+               const BigNum *subtractor);
+
+/**
+ * @brief product = multiplicand * multiplier, any of them may be the same
+ * BigNum.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_mul(BigNum *product,
+               const BigNum *multiplicand,
+               const BigNum *multiplier);
+
+/**
+ * @brief Divide, the quotient truncated toward zero as C: the remainder
+ * has the sign of the dividend.
+ *
+ * @param quotient      The quotient, or NULL.
+ * @param remainder     The remainder, or NULL.
+ * @param dividend      The dividend.
+ * @param divisor       The divisor.
+ * @return int          0 if success, -1 if divisor is 0 or out of memory.
+ */
+int bignum_divmod(BigNum *quotient,
+                  BigNum *remainder,
+                  const BigNum *dividend,
+                  const BigNum *divisor);
+
+/**
+ * @brief result = base^exponent mod modulus, in [0, modulus), any of them
+ * may be the same BigNum.
+ *
+ * @param result        The result.
+ * @param base          The base, negative taken modulo.
+ * @param exponent      The exponent, not negative.
+ * @param modulus       The modulus, positive.
+ * @return int          0 if success, -1 if the exponent is negative, the
+ *                      modulus not positive, or out of memory.
+ */
+int bignum_powmod(BigNum *result,
+                  const BigNum *base,
+                  const BigNum *exponent,
+                  const BigNum *modulus);
+
+/**
+ * @brief result = the greatest common divisor of |a| and |b|, 0 if both are
+ * 0; any of them may be the same BigNum.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_gcd(BigNum *result, const BigNum *a, const BigNum *b);
+
+/**
+ * @brief The sizes in limbs from which each multiplication and division
+ * algorithm is used.
+ */
+typedef struct _BigNumThresholds {
+    /** Karatsuba from this size of the smaller factor, at least 2. */
+    size_t karatsuba;
+    /** Toom-3 from this size of the smaller factor, at least 3. */
+    size_t toom3;
+    /**
+     * The number theoretic transform from this size of the smaller
+     * factor, at least 1.
+     */
+    size_t ntt;
+    /**
+     * Burnikel-Ziegler from this size of the divisor and of the quotient,
+     * at least 2.
+     */
+    size_t burnikel_ziegler;
+} BigNumThresholds;
+
+/**
+ * @brief Get the thresholds.
+ *
+ * @param thresholds    The thresholds in use.
+ */
+void bignum_get_thresholds(BigNumThresholds *thresholds);
+
+/**
+ * @brief Set the thresholds, raised to their least values; SIZE_MAX turns
+ * an algorithm off. Not thread safe: set before calculating, as to tune.
+ *
+ * @param thresholds    The thresholds.
+ */
+void bignum_set_thresholds(const BigNumThresholds *thresholds);
+
+/**
+ * @brief A scratch workspace of limbs for the functions ending in _scratch,
+ * kept between calls: they take their temporaries here, grown if short.
+ */
+typedef struct _BigNumScratch {
+    limb_t *limbs;
+    /** The number of limbs allocated. */
+    size_t capacity;
+} BigNumScratch;
+
+/**
+ * @brief Allocate a new scratch workspace.
+ *
+ * @param capacity          The limbs to allocate, by the *_scratch_size.
+ * @return BigNumScratch*   The new scratch, NULL if out of memory.
+ */
+BigNumScratch *bignum_scratch_new(size_t capacity);
+
+/**
+ * @brief Delete a scratch workspace and its limbs.
+ *
+ * @param scratch   The scratch.
+ */
+void bignum_scratch_free(BigNumScratch *scratch);
+
+/**
+ * @brief Grow a scratch workspace to at least capacity limbs.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_scratch_reserve(BigNumScratch *scratch, size_t capacity);
+
+/**
+ * @brief Grow the limbs of a BigNum to at least capacity, the value kept.
+ *
+ * A result whose capacity is the size reported below is not reallocated.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_reserve(BigNum *num, size_t capacity);
+
+/**
+ * @brief The limbs of a product of a_size by b_size limbs.
+ */
+size_t bignum_mul_size(size_t a_size, size_t b_size);
+
+/**
+ * @brief The limbs of scratch multiplying a_size by b_size limbs, by the
+ * thresholds in use.
+ */
+size_t bignum_mul_scratch_size(size_t a_size, size_t b_size);
+
+/**
+ * @brief product = multiplicand * multiplier as @ref bignum_mul, the
+ * temporaries in scratch: no allocation if the product and scratch have
+ * the capacities reported by @ref bignum_mul_size and
+ * @ref bignum_mul_scratch_size.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_mul_scratch(BigNum *product,
+                       const BigNum *multiplicand,
+                       const BigNum *multiplier,
+                       BigNumScratch *scratch);
+
+/**
+ * @brief The limbs of acc += a * b, acc of acc_size limbs.
+ */
+size_t bignum_addmul_size(size_t acc_size, size_t a_size, size_t b_size);
+
+/**
+ * @brief The limbs of scratch of acc += a * b.
+ */
+size_t bignum_addmul_scratch_size(size_t a_size, size_t b_size);
+
+/**
+ * @brief acc += a * b in place, acc may be a or b. No allocation if acc
+ * and scratch have the capacities reported by @ref bignum_addmul_size and
+ * @ref bignum_addmul_scratch_size; schoolbook sizes of the same sign add
+ * into acc row by row and take no scratch.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_addmul(BigNum *acc,
+                  const BigNum *a,
+                  const BigNum *b,
+                  BigNumScratch *scratch);
+
+/**
+ * @brief The limbs of the quotient of a_size by b_size limbs.
+ */
+size_t bignum_quotient_size(size_t a_size, size_t b_size);
+
+/**
+ * @brief The limbs of the remainder of a_size by b_size limbs.
+ */
+size_t bignum_remainder_size(size_t a_size, size_t b_size);
+
+/**
+ * @brief The limbs of scratch dividing a_size by b_size limbs, by the
+ * thresholds in use.
+ */
+size_t bignum_divmod_scratch_size(size_t a_size, size_t b_size);
+
+/**
+ * @brief Divide as @ref bignum_divmod, the temporaries in scratch: no
+ * allocation if the quotient, remainder and scratch have the capacities
+ * reported by @ref bignum_quotient_size, @ref bignum_remainder_size and
+ * @ref bignum_divmod_scratch_size.
+ *
+ * @return int      0 if success, -1 if divisor is 0 or out of memory.
+ */
+int bignum_divmod_scratch(BigNum *quotient,
+                          BigNum *remainder,
+                          const BigNum *dividend,
+                          const BigNum *divisor,
+                          BigNumScratch *scratch);
+
+/**
+ * @brief result = num * 2^bits, the sign kept.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_shift_left(BigNum *result, const BigNum *num, size_t bits);
+
+/**
+ * @brief result = num / 2^bits, the magnitude shifted, the sign kept.
+ *
+ * @return int      0 if success, -1 if out of memory.
+ */
+int bignum_shift_right(BigNum *result, const BigNum *num, size_t bits);
+
 #endif /* RETHINK_C_BIGNUM_H */
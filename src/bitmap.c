@@ -1,7 +1,7 @@
 /**
- * @file bignum.c
+ * @file bitmap.c
  * @author hutusi (hutusi@outlook.com)
- * @brief Refer to bignum.h
+ * @brief Refer to bitmap.h
  * @date 2019-07-20
  *
  * @copyright Copyright (c) 2019, hutusi.com
@@ -9,11 +9,25 @@
  */
 
 #include "bitmap.h"
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BITMAP_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define BITMAP_NEON
+#include <arm_neon.h>
+#endif
+
 #include "def.h"
 
+/** Bitmaps shorter than this (in words) skip the SIMD dispatch. */
+#define BITMAP_SIMD_MIN_WORDS 16
+
+typedef enum { BITMAP_OR, BITMAP_AND, BITMAP_XOR, BITMAP_ANDNOT } BitMapOp;
+
 inline void set_bit(word_t *words, unsigned int n)
 {
     words[WORD_OFFSET(n)] |= ((word_t)1 << BIT_OFFSET(n));
@@ -40,7 +54,252 @@ inline void clear_bitmap(word_t *words, unsigned int len)
     memset(words, 0x00, len * sizeof(word_t));
 }
 
-static inline unsigned int bitmap_num_words_need_by_bits(num_bits)
+static inline unsigned int popcount_word(word_t word)
+{
+#ifdef __GNUC__
+    return (unsigned int)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) +
+           ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/** index of the lowest 1 bit, word must not be 0. */
+static inline unsigned int ctz_word(word_t word)
+{
+#ifdef __GNUC__
+    return (unsigned int)__builtin_ctzll(word);
+#else
+    unsigned int n = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/** mask of the low n bits, n in [0, BITS_PER_WORD]. */
+static inline word_t low_mask(unsigned int n)
+{
+    return n >= BITS_PER_WORD ? WORD_ALL_SETTED : (((word_t)1 << n) - 1);
+}
+
+static size_t count_words_portable(const word_t *words, size_t n)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += popcount_word(words[i]);
+    }
+    return count;
+}
+
+#ifdef BITMAP_X86
+__attribute__((target("popcnt"))) static size_t
+count_words_popcnt(const word_t *words, size_t n)
+{
+    /** independent sums, so popcnt instructions overlap. */
+    size_t count0 = 0, count1 = 0, count2 = 0, count3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        count0 += __builtin_popcountll(words[i]);
+        count1 += __builtin_popcountll(words[i + 1]);
+        count2 += __builtin_popcountll(words[i + 2]);
+        count3 += __builtin_popcountll(words[i + 3]);
+    }
+    for (; i < n; ++i) {
+        count0 += __builtin_popcountll(words[i]);
+    }
+    return count0 + count1 + count2 + count3;
+}
+
+/** nibble lookup by pshufb, summed per 64-bit lane by psadbw (Mula). */
+__attribute__((target("avx2"))) static size_t
+count_words_avx2(const word_t *words, size_t n)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                            1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3,
+                                            1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(words + i));
+        __m256i low = _mm256_and_si256(v, low_nibbles);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles);
+        __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                        _mm256_shuffle_epi8(lookup, high));
+        total = _mm256_add_epi64(
+            total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    size_t count = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    return count + count_words_popcnt(words + i, n - i);
+}
+#endif
+
+#ifdef BITMAP_NEON
+static size_t count_words_neon(const word_t *words, size_t n)
+{
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint8x16_t v = vreinterpretq_u8_u64(vld1q_u64(words + i));
+        count += vaddlvq_u8(vcntq_u8(v));
+    }
+    return count + count_words_portable(words + i, n - i);
+}
+#endif
+
+static size_t count_words(const word_t *words, size_t n)
+{
+#if defined(BITMAP_X86)
+    if (n >= BITMAP_SIMD_MIN_WORDS && __builtin_cpu_supports("avx2")) {
+        return count_words_avx2(words, n);
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        return count_words_popcnt(words, n);
+    }
+#elif defined(BITMAP_NEON)
+    return count_words_neon(words, n);
+#endif
+    return count_words_portable(words, n);
+}
+
+/** one loop per op, so each loop vectorizes on its own. */
+static void op_words_portable(word_t *words,
+                              const word_t *others,
+                              size_t n,
+                              BitMapOp op)
+{
+    size_t i;
+    switch (op) {
+    case BITMAP_OR:
+        for (i = 0; i < n; ++i) {
+            words[i] |= others[i];
+        }
+        break;
+    case BITMAP_AND:
+        for (i = 0; i < n; ++i) {
+            words[i] &= others[i];
+        }
+        break;
+    case BITMAP_XOR:
+        for (i = 0; i < n; ++i) {
+            words[i] ^= others[i];
+        }
+        break;
+    case BITMAP_ANDNOT:
+        for (i = 0; i < n; ++i) {
+            words[i] &= ~others[i];
+        }
+        break;
+    }
+}
+
+#ifdef BITMAP_X86
+#define BITMAP_AVX2_LOOP(intrinsic)                                           \
+    for (; i + 4 <= n; i += 4) {                                              \
+        __m256i a = _mm256_loadu_si256((const __m256i *)(words + i));         \
+        __m256i b = _mm256_loadu_si256((const __m256i *)(others + i));        \
+        _mm256_storeu_si256((__m256i *)(words + i), intrinsic);               \
+    }
+
+__attribute__((target("avx2"))) static void
+op_words_avx2(word_t *words, const word_t *others, size_t n, BitMapOp op)
+{
+    size_t i = 0;
+    switch (op) {
+    case BITMAP_OR:
+        BITMAP_AVX2_LOOP(_mm256_or_si256(a, b));
+        break;
+    case BITMAP_AND:
+        BITMAP_AVX2_LOOP(_mm256_and_si256(a, b));
+        break;
+    case BITMAP_XOR:
+        BITMAP_AVX2_LOOP(_mm256_xor_si256(a, b));
+        break;
+    case BITMAP_ANDNOT:
+        /** _mm256_andnot_si256(x, y) is ~x & y. */
+        BITMAP_AVX2_LOOP(_mm256_andnot_si256(b, a));
+        break;
+    }
+    op_words_portable(words + i, others + i, n - i, op);
+}
+#endif
+
+#ifdef BITMAP_NEON
+#define BITMAP_NEON_LOOP(intrinsic)                                           \
+    for (; i + 2 <= n; i += 2) {                                              \
+        uint64x2_t a = vld1q_u64(words + i);                                  \
+        uint64x2_t b = vld1q_u64(others + i);                                 \
+        vst1q_u64(words + i, intrinsic);                                      \
+    }
+
+static void
+op_words_neon(word_t *words, const word_t *others, size_t n, BitMapOp op)
+{
+    size_t i = 0;
+    switch (op) {
+    case BITMAP_OR:
+        BITMAP_NEON_LOOP(vorrq_u64(a, b));
+        break;
+    case BITMAP_AND:
+        BITMAP_NEON_LOOP(vandq_u64(a, b));
+        break;
+    case BITMAP_XOR:
+        BITMAP_NEON_LOOP(veorq_u64(a, b));
+        break;
+    case BITMAP_ANDNOT:
+        /** vbicq_u64(x, y) is x & ~y. */
+        BITMAP_NEON_LOOP(vbicq_u64(a, b));
+        break;
+    }
+    op_words_portable(words + i, others + i, n - i, op);
+}
+#endif
+
+static void
+op_words(word_t *words, const word_t *others, size_t n, BitMapOp op)
+{
+#if defined(BITMAP_X86)
+    if (n >= BITMAP_SIMD_MIN_WORDS && __builtin_cpu_supports("avx2")) {
+        op_words_avx2(words, others, n, op);
+        return;
+    }
+#elif defined(BITMAP_NEON)
+    op_words_neon(words, others, n, op);
+    return;
+#endif
+    op_words_portable(words, others, n, op);
+}
+
+unsigned int count_bitmap(const word_t *words, unsigned int len)
+{
+    return (unsigned int)count_words(words, len);
+}
+
+void or_bitmap(word_t *words, const word_t *others, unsigned int len)
+{
+    op_words(words, others, len, BITMAP_OR);
+}
+
+void and_bitmap(word_t *words, const word_t *others, unsigned int len)
+{
+    op_words(words, others, len, BITMAP_AND);
+}
+
+void andnot_bitmap(word_t *words, const word_t *others, unsigned int len)
+{
+    op_words(words, others, len, BITMAP_ANDNOT);
+}
+
+static inline unsigned int bitmap_num_words_need_by_bits(unsigned int num_bits)
 {
     if ((num_bits % BITS_PER_WORD) == 0) {
         return num_bits / BITS_PER_WORD;
@@ -49,14 +308,56 @@ static inline unsigned int bitmap_num_words_need_by_bits(num_bits)
     }
 }
 
-BitMap *bitmap_new(unsigned int num_bits)
+/** clear the bits after num_bits in the last word. */
+static inline void bitmap_clear_tail(BitMap *bitmap)
+{
+    if (BIT_OFFSET(bitmap->num_bits) != 0) {
+        bitmap->words[WORD_OFFSET(bitmap->num_bits)] &=
+            low_mask(BIT_OFFSET(bitmap->num_bits));
+    }
+}
+
+/** make room for num_bits, capacity at least doubles, new words are 0. */
+static int bitmap_reserve(BitMap *bitmap, unsigned int num_bits)
+{
+    unsigned int num_words = bitmap_num_words_need_by_bits(num_bits);
+    if (num_words <= bitmap->capacity) {
+        return 0;
+    }
+
+    unsigned int capacity = bitmap->capacity * 2;
+    if (capacity < num_words) {
+        capacity = num_words;
+    }
+    word_t *words =
+        (word_t *)realloc(bitmap->words, sizeof(word_t) * capacity);
+    if (words == NULL) {
+        return -1;
+    }
+    memset(words + bitmap->capacity,
+           0,
+           sizeof(word_t) * (capacity - bitmap->capacity));
+    bitmap->words = words;
+    bitmap->capacity = capacity;
+    return 0;
+}
+
+static inline void bitmap_set_num_bits(BitMap *bitmap, unsigned int num_bits)
 {
-    BitMap *bitmap = (BitMap *)malloc(sizeof(BitMap));
     bitmap->num_bits = num_bits;
     bitmap->num_words = bitmap_num_words_need_by_bits(num_bits);
-    if (bitmap->num_words == 0)
+    if (bitmap->num_words == 0) {
         bitmap->num_words = 1;
-    bitmap->words = (word_t *)malloc(sizeof(word_t) * bitmap->num_words);
+    }
+}
+
+BitMap *bitmap_new(unsigned int num_bits)
+{
+    BitMap *bitmap = (BitMap *)malloc(sizeof(BitMap));
+    bitmap_set_num_bits(bitmap, num_bits);
+    bitmap->capacity = bitmap->num_words;
+    bitmap->words = (word_t *)malloc(sizeof(word_t) * bitmap->capacity);
+    memset(bitmap->words, 0, sizeof(word_t) * bitmap->capacity);
     return bitmap;
 }
 
@@ -65,6 +366,7 @@ BitMap *bitmap_clone(const BitMap *bitmap)
     BitMap *clone = (BitMap *)malloc(sizeof(BitMap));
     clone->num_bits = bitmap->num_bits;
     clone->num_words = bitmap->num_words;
+    clone->capacity = bitmap->num_words;
     clone->words = (word_t *)malloc(sizeof(word_t) * bitmap->num_words);
     memcpy(clone->words, bitmap->words, sizeof(word_t) * bitmap->num_words);
     return clone;
@@ -94,6 +396,7 @@ int bitmap_get(const BitMap *bitmap, unsigned int n)
 void bitmap_set_all(BitMap *bitmap)
 {
     memset(bitmap->words, 0xFF, sizeof(word_t) * bitmap->num_words);
+    bitmap_clear_tail(bitmap);
 }
 
 void bitmap_clear_all(BitMap *bitmap)
@@ -101,58 +404,148 @@ void bitmap_clear_all(BitMap *bitmap)
     memset(bitmap->words, 0x00, sizeof(word_t) * bitmap->num_words);
 }
 
-void bitmap_or(BitMap *bitmap, const BitMap *other)
+static void bitmap_op(BitMap *bitmap, const BitMap *other, BitMapOp op)
 {
-    for (int i = 0; i < bitmap->num_words; ++i) {
-        bitmap->words[i] |= other->words[i];
+    unsigned int n = bitmap->num_words;
+    if (n > other->num_words) {
+        /** the missing bits of other are 0. */
+        if (op == BITMAP_AND) {
+            memset(bitmap->words + other->num_words,
+                   0,
+                   sizeof(word_t) * (n - other->num_words));
+        }
+        n = other->num_words;
     }
+    op_words(bitmap->words, other->words, n, op);
+    bitmap_clear_tail(bitmap);
+}
+
+void bitmap_or(BitMap *bitmap, const BitMap *other)
+{
+    bitmap_op(bitmap, other, BITMAP_OR);
 }
 
 void bitmap_and(BitMap *bitmap, const BitMap *other)
 {
-    for (int i = 0; i < bitmap->num_words; ++i) {
-        bitmap->words[i] &= other->words[i];
-    }
+    bitmap_op(bitmap, other, BITMAP_AND);
 }
 
 void bitmap_xor(BitMap *bitmap, const BitMap *other)
 {
-    for (int i = 0; i < bitmap->num_words; ++i) {
-        bitmap->words[i] ^= other->words[i];
-    }
+    bitmap_op(bitmap, other, BITMAP_XOR);
+}
+
+void bitmap_andnot(BitMap *bitmap, const BitMap *other)
+{
+    bitmap_op(bitmap, other, BITMAP_ANDNOT);
 }
 
 unsigned int bitmap_count(const BitMap *bitmap)
 {
-    unsigned int count = 0;
-    for (unsigned int i = 0; i < bitmap->num_bits; ++i) {
-        if (bitmap_get(bitmap, i))
-            ++count;
+    return bitmap_rank(bitmap, bitmap->num_bits);
+}
+
+unsigned int bitmap_rank(const BitMap *bitmap, unsigned int n)
+{
+    if (n > bitmap->num_bits) {
+        n = bitmap->num_bits;
+    }
+
+    unsigned int count =
+        (unsigned int)count_words(bitmap->words, WORD_OFFSET(n));
+    if (BIT_OFFSET(n) != 0) {
+        count += popcount_word(bitmap->words[WORD_OFFSET(n)] &
+                               low_mask(BIT_OFFSET(n)));
     }
     return count;
 }
 
+unsigned int bitmap_select(const BitMap *bitmap, unsigned int k)
+{
+    for (unsigned int i = 0; i < bitmap->num_words; ++i) {
+        word_t word = bitmap->words[i];
+        if (i == WORD_OFFSET(bitmap->num_bits)) {
+            word &= low_mask(BIT_OFFSET(bitmap->num_bits));
+        }
+
+        unsigned int count = popcount_word(word);
+        if (k < count) {
+            /** drop the k lower 1 bits, the kth is the lowest left. */
+            for (; k > 0; --k) {
+                word &= word - 1;
+            }
+            return i * BITS_PER_WORD + ctz_word(word);
+        }
+        k -= count;
+    }
+    return BITMAP_NOT_FOUND;
+}
+
+unsigned int bitmap_first_set(const BitMap *bitmap)
+{
+    return bitmap_next_set(bitmap, 0);
+}
+
+unsigned int bitmap_next_set(const BitMap *bitmap, unsigned int n)
+{
+    if (n >= bitmap->num_bits) {
+        return BITMAP_NOT_FOUND;
+    }
+
+    unsigned int i = WORD_OFFSET(n);
+    word_t word = bitmap->words[i] & ~low_mask(BIT_OFFSET(n));
+    while (word == 0) {
+        if (++i >= bitmap->num_words) {
+            return BITMAP_NOT_FOUND;
+        }
+        word = bitmap->words[i];
+    }
+
+    unsigned int index = i * BITS_PER_WORD + ctz_word(word);
+    return index < bitmap->num_bits ? index : BITMAP_NOT_FOUND;
+}
+
 BitMap *bitmap_append(BitMap *bitmap, int flag)
 {
-    if (bitmap->num_words * BITS_PER_WORD <= bitmap->num_bits) {
-        ++(bitmap->num_words);
-        bitmap->words =
-            (word_t *)realloc(bitmap->words, sizeof(word_t) * bitmap->num_words);
+    unsigned int n = bitmap->num_bits;
+    if (BIT_OFFSET(n) == 0 && bitmap_reserve(bitmap, n + 1) != 0) {
+        return bitmap;
     }
 
+    /** bits past num_bits are kept 0, only a 1 needs a write. */
     if (flag) {
-        set_bit(bitmap->words, bitmap->num_bits);
-    } else {
-        clear_bit(bitmap->words, bitmap->num_bits);
+        set_bit(bitmap->words, n);
     }
+    bitmap->num_bits = n + 1;
+    bitmap->num_words = WORD_OFFSET(n) + 1;
+    return bitmap;
+}
 
-    ++(bitmap->num_bits);
+BitMap *bitmap_append_bits(BitMap *bitmap, word_t bits, unsigned int num_bits)
+{
+    if (num_bits == 0) {
+        return bitmap;
+    }
+    if (bitmap_reserve(bitmap, bitmap->num_bits + num_bits) != 0) {
+        return bitmap;
+    }
+
+    bits &= low_mask(num_bits);
+    unsigned int offset = WORD_OFFSET(bitmap->num_bits);
+    unsigned int shift = BIT_OFFSET(bitmap->num_bits);
+    bitmap->words[offset] =
+        (bitmap->words[offset] & low_mask(shift)) | (bits << shift);
+    if (shift + num_bits > BITS_PER_WORD) {
+        bitmap->words[offset + 1] = bits >> (BITS_PER_WORD - shift);
+    }
+
+    bitmap_set_num_bits(bitmap, bitmap->num_bits + num_bits);
     return bitmap;
 }
 
 BitMap *bitmap_append_char(BitMap *bitmap, unsigned char ch)
 {
-    return bitmap_merge(bitmap, bitmap_from_char(ch));
+    return bitmap_append_bits(bitmap, ch, CHAR_BIT);
 }
 
 char *bitmap_to_string(BitMap *bitmap)
@@ -190,68 +583,74 @@ BitMap *bitmap_from_word(word_t word)
 BitMap *bitmap_from_char(unsigned char ch)
 {
     BitMap *bitmap = bitmap_new(CHAR_BIT);
-    memcpy(bitmap->words, &ch, 1);
+    bitmap->words[0] = ch;
     return bitmap;
 }
 
-unsigned char bitmap_extract_char(const BitMap *bitmap, unsigned int n)
+word_t bitmap_extract_bits(const BitMap *bitmap,
+                           unsigned int n,
+                           unsigned int num_bits)
 {
-    unsigned int word_offset = WORD_OFFSET(n);
-    unsigned int bit_offset = BIT_OFFSET(n);
-    unsigned int word;
-    /** if char streach over two words ... */
-    if (bit_offset > BITS_PER_WORD - CHAR_BIT) {
-        unsigned int front_len = BITS_PER_WORD - bit_offset;
-        unsigned int back_len = CHAR_BIT - (BITS_PER_WORD - bit_offset);
-
-        unsigned int front = bitmap->words[word_offset] >> (BITS_PER_WORD - front_len);
-        unsigned int back = bitmap->words[word_offset + 1] << (BITS_PER_WORD - back_len);
+    unsigned int offset = WORD_OFFSET(n);
+    unsigned int shift = BIT_OFFSET(n);
+    if (offset >= bitmap->num_words) {
+        return 0;
+    }
 
-        word = front | (back >> (BITS_PER_WORD - back_len - front_len));
-    } else {
-        word = bitmap->words[word_offset] >> bit_offset;
+    word_t word = bitmap->words[offset] >> shift;
+    /** the bits stretch over two words. */
+    if (shift != 0 && shift + num_bits > BITS_PER_WORD &&
+        offset + 1 < bitmap->num_words) {
+        word |= bitmap->words[offset + 1] << (BITS_PER_WORD - shift);
     }
+    return word & low_mask(num_bits);
+}
 
-    return (unsigned char)word;
+unsigned char bitmap_extract_char(const BitMap *bitmap, unsigned int n)
+{
+    return (unsigned char)bitmap_extract_bits(bitmap, n, CHAR_BIT);
 }
 
 BitMap *bitmap_concat(BitMap *bitmap, const BitMap *other)
 {
-    unsigned int total_bits = bitmap->num_bits + other->num_bits;
-    if (total_bits >= bitmap->num_words * BITS_PER_WORD) {
-        bitmap->num_words = bitmap_num_words_need_by_bits(total_bits);
-        bitmap->words = (word_t *)realloc(bitmap->words,
-                                          sizeof(word_t) * bitmap->num_words);
+    if (other == bitmap) {
+        BitMap *clone = bitmap_clone(other);
+        bitmap_concat(bitmap, clone);
+        bitmap_free(clone);
+        return bitmap;
     }
 
-    unsigned int remainder = bitmap->num_bits % BITS_PER_WORD;
-    unsigned int quotient = bitmap->num_bits / BITS_PER_WORD;
-    // if target bits is 0, or full of words, just copy other words to the end.
-    if (remainder == 0) {
-        memcpy(&(bitmap->words[quotient]), other->words, sizeof(word_t) * other->num_words);
-    } else {
-        // -1: 1111 * 8 => 0001 111 ...
-        bitmap->words[quotient] &= ~(((word_t)(-1)) << remainder);
-
-        unsigned int num = bitmap_num_words_need_by_bits(bitmap->num_bits);
-        if (bitmap->num_words > num) {
-            memset(&(bitmap->words[num]),
-                   0x0,
-                   sizeof(word_t) * (bitmap->num_words - num));
-        }
+    unsigned int other_bits = other->num_bits;
+    unsigned int total_bits = bitmap->num_bits + other_bits;
+    if (other_bits == 0 || bitmap_reserve(bitmap, total_bits) != 0) {
+        return bitmap;
+    }
 
-        for (int i = 0; i < other->num_words; ++i) {
-            word_t front = other->words[i] << remainder;
-            bitmap->words[quotient + i] |= front;
+    unsigned int other_words = bitmap_num_words_need_by_bits(other_bits);
+    unsigned int total_words = bitmap_num_words_need_by_bits(total_bits);
+    unsigned int offset = WORD_OFFSET(bitmap->num_bits);
+    unsigned int shift = BIT_OFFSET(bitmap->num_bits);
 
-            if (quotient + i + 1 < bitmap->num_words) {
-                word_t back = other->words[i] >> (BITS_PER_WORD - remainder);
-                bitmap->words[quotient + i + 1] |= back;
-            }
+    // if target bits are full of words, just copy other words to the end.
+    if (shift == 0) {
+        memcpy(&(bitmap->words[offset]),
+               other->words,
+               sizeof(word_t) * other_words);
+    } else {
+        /** every word of other is split over two words of bitmap. */
+        word_t carry = bitmap->words[offset] & low_mask(shift);
+        for (unsigned int i = 0; i < other_words; ++i) {
+            word_t word = other->words[i];
+            bitmap->words[offset + i] = carry | (word << shift);
+            carry = word >> (BITS_PER_WORD - shift);
+        }
+        if (offset + other_words < total_words) {
+            bitmap->words[offset + other_words] = carry;
         }
     }
 
-    bitmap->num_bits += other->num_bits;
+    bitmap_set_num_bits(bitmap, total_bits);
+    bitmap_clear_tail(bitmap);
     return bitmap;
 }
 
@@ -275,8 +674,10 @@ int bitmap_equal(const BitMap *bitmap1, const BitMap *bitmap2)
         }
     }
 
-    return (bitmap1->words[bitmap1->num_words - 1]
-            << (BITS_PER_WORD - BIT_OFFSET(bitmap1->num_bits))) ==
-           (bitmap2->words[bitmap2->num_words - 1]
-            << (BITS_PER_WORD - BIT_OFFSET(bitmap2->num_bits)));
+    word_t mask = BIT_OFFSET(bitmap1->num_bits) == 0
+                      ? WORD_ALL_SETTED
+                      : low_mask(BIT_OFFSET(bitmap1->num_bits));
+    return ((bitmap1->words[bitmap1->num_words - 1] ^
+             bitmap2->words[bitmap2->num_words - 1]) &
+            mask) == 0;
 }
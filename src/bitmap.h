@@ -1,5 +1,5 @@
 /**
- * @file bignum.h
+ * @file bitmap.h
  *
  * @author hutusi (hutusi@outlook.com)
  *
@@ -7,6 +7,11 @@
  *
  * refer to: https://stackoverflow.com/questions/1225998/what-is-a-bitmap-in-c
  *
+ * Bits are packed in 64-bit words, bit n is bit (n % 64) of word (n / 64).
+ * Counting uses the popcount instruction (or an AVX2/NEON kernel on long
+ * bitmaps), and/or/xor/andnot are vectorized, append, concat and extract
+ * move whole words. The CPU features are detected at run time.
+ *
  * @date 2019-07-20
  *
  * @copyright Copyright (c) 2019, hutusi.com
@@ -17,15 +22,20 @@
 #define RETHINK_C_BITMAP_H
 
 #include <limits.h> /* for CHAR_BIT */
-#include <stdint.h> /* for uint32_t */
+#include <stdint.h> /* for uint64_t */
 
-typedef uint32_t word_t;
+typedef uint64_t word_t;
 enum { BITS_PER_WORD = sizeof(word_t) * CHAR_BIT };
 #define WORD_OFFSET(b) ((b) / BITS_PER_WORD)
 #define BIT_OFFSET(b) ((b) % BITS_PER_WORD)
 
 #define WORD_ALL_CLEARED 0
-#define WORD_ALL_SETTED UINT32_MAX
+#define WORD_ALL_SETTED UINT64_MAX
+
+/**
+ * The bit index returned if no bit is found.
+ */
+#define BITMAP_NOT_FOUND UINT_MAX
 
 /**
  * @brief Set a bit to 1.
@@ -68,6 +78,44 @@ void set_bitmap(word_t *words, unsigned int num_words);
  */
 void clear_bitmap(word_t *words, unsigned int num_words);
 
+/**
+ * @brief Count the 1 bits of a bitmap.
+ *
+ * @param words             The bitmap.
+ * @param num_words         The length of bitmap. (Not the bits number.)
+ * @return unsigned int     The number of 1 bits.
+ */
+unsigned int count_bitmap(const word_t *words, unsigned int num_words);
+
+/**
+ * @brief Or the words of other bitmap into a bitmap.
+ *
+ * @param words     The bitmap.
+ * @param others    The other bitmap.
+ * @param num_words The length of both bitmaps. (Not the bits number.)
+ */
+void or_bitmap(word_t *words, const word_t *others, unsigned int num_words);
+
+/**
+ * @brief And the words of other bitmap into a bitmap.
+ *
+ * @param words     The bitmap.
+ * @param others    The other bitmap.
+ * @param num_words The length of both bitmaps. (Not the bits number.)
+ */
+void and_bitmap(word_t *words, const word_t *others, unsigned int num_words);
+
+/**
+ * @brief Clear the bits of a bitmap which are set in other bitmap.
+ *
+ * @param words     The bitmap.
+ * @param others    The other bitmap.
+ * @param num_words The length of both bitmaps. (Not the bits number.)
+ */
+void andnot_bitmap(word_t *words,
+                   const word_t *others,
+                   unsigned int num_words);
+
 /**
  * @brief Definition of a @ref BitMap.
  *
@@ -77,14 +125,16 @@ typedef struct _BitMap {
     /** The num count of all bits. */
     unsigned int num_bits;
     /**
-     * The num count of all words.
-     * num_words may > num_bits / BITS_PER_WORD
+     * The num count of words holding bits, at least 1.
+     * Bits after num_bits in the last word are kept 0.
      */
     unsigned int num_words;
+    /** The num count of allocated words, grows geometrically. */
+    unsigned int capacity;
 } BitMap;
 
 /**
- * @brief Allcate a new BitMap.
+ * @brief Allcate a new BitMap, all bits are 0.
  *
  * @param num_bits  The num of bits.
  * @return BitMap*  The new BitMap if success, otherwise NULL.
@@ -148,6 +198,8 @@ void bitmap_clear_all(BitMap *bitmap);
 /**
  * @brief Do or operation on a BitMap with other BitMap.
  *
+ * If other is shorter, its missing bits are taken as 0.
+ *
  * @param bitmap    The BitMap.
  * @param other     The other BitMap.
  */
@@ -156,6 +208,8 @@ void bitmap_or(BitMap *bitmap, const BitMap *other);
 /**
  * @brief Do and operation on a BitMap with other BitMap.
  *
+ * If other is shorter, its missing bits are taken as 0.
+ *
  * @param bitmap    The BitMap.
  * @param other     The other BitMap.
  */
@@ -164,11 +218,24 @@ void bitmap_and(BitMap *bitmap, const BitMap *other);
 /**
  * @brief Do xor operation on a BitMap with other BitMap.
  *
+ * If other is shorter, its missing bits are taken as 0.
+ *
  * @param bitmap    The BitMap.
  * @param other     The other BitMap.
  */
 void bitmap_xor(BitMap *bitmap, const BitMap *other);
 
+/**
+ * @brief Clear the bits of a BitMap which are set in other BitMap.
+ *
+ * bitmap = bitmap & ~other. If other is shorter, its missing bits are taken
+ * as 0.
+ *
+ * @param bitmap    The BitMap.
+ * @param other     The other BitMap.
+ */
+void bitmap_andnot(BitMap *bitmap, const BitMap *other);
+
 /**
  * @brief Count the sum of 1 value bits of a BitMap.
  *
@@ -177,6 +244,49 @@ void bitmap_xor(BitMap *bitmap, const BitMap *other);
  */
 unsigned int bitmap_count(const BitMap *bitmap);
 
+/**
+ * @brief Count the 1 value bits of a BitMap before an index.
+ *
+ * @param bitmap            The BitMap.
+ * @param n                 The index, bits [0, n) are counted.
+ * @return unsigned int     The rank, the number of 1 bits before n.
+ */
+unsigned int bitmap_rank(const BitMap *bitmap, unsigned int n);
+
+/**
+ * @brief Find the kth (from 0) 1 value bit of a BitMap.
+ *
+ * bitmap_rank(bitmap, bitmap_select(bitmap, k)) == k.
+ *
+ * @param bitmap            The BitMap.
+ * @param k                 The k, from 0.
+ * @return unsigned int     The index of the bit, BITMAP_NOT_FOUND if there
+ *                          are not more than k 1 bits.
+ */
+unsigned int bitmap_select(const BitMap *bitmap, unsigned int k);
+
+/**
+ * @brief Find the first 1 value bit of a BitMap.
+ *
+ * @param bitmap            The BitMap.
+ * @return unsigned int     The index of the bit, BITMAP_NOT_FOUND if none.
+ */
+unsigned int bitmap_first_set(const BitMap *bitmap);
+
+/**
+ * @brief Find the first 1 value bit of a BitMap from an index.
+ *
+ * Iterate all 1 bits:
+ *
+ *     for (unsigned int i = bitmap_first_set(bitmap); i != BITMAP_NOT_FOUND;
+ *          i = bitmap_next_set(bitmap, i + 1)) { ... }
+ *
+ * @param bitmap            The BitMap.
+ * @param n                 The index to search from, included.
+ * @return unsigned int     The index of the bit, BITMAP_NOT_FOUND if none.
+ */
+unsigned int bitmap_next_set(const BitMap *bitmap, unsigned int n);
+
 /**
  * @brief Append a bit (0 or 1) to a BitMap.
  *
@@ -186,6 +296,16 @@ unsigned int bitmap_count(const BitMap *bitmap);
  */
 BitMap *bitmap_append(BitMap *bitmap, int flag);
 
+/**
+ * @brief Append the low bits of a word to a BitMap, lowest bit first.
+ *
+ * @param bitmap    The BitMap.
+ * @param bits      The bits.
+ * @param num_bits  The number of bits to append, 0 to BITS_PER_WORD.
+ * @return BitMap*  The BitMap.
+ */
+BitMap *bitmap_append_bits(BitMap *bitmap, word_t bits, unsigned int num_bits);
+
 /**
  * @brief Append a char to a BitMap.
  *
@@ -236,6 +356,20 @@ BitMap *bitmap_from_char(unsigned char ch);
  */
 unsigned char bitmap_extract_char(const BitMap *bitmap, unsigned int n);
 
+/**
+ * @brief Extract bits from a BitMap by indicating an index.
+ *
+ * Bits past the end of the BitMap are read as 0.
+ *
+ * @param bitmap    The BitMap.
+ * @param n         The start index.
+ * @param num_bits  The number of bits, 0 to BITS_PER_WORD.
+ * @return word_t   The bits, bit n is the lowest bit.
+ */
+word_t bitmap_extract_bits(const BitMap *bitmap,
+                           unsigned int n,
+                           unsigned int num_bits);
+
 /**
  * @brief Concat another BitMap to a BitMap.
  *
@@ -17,12 +17,41 @@
 BSTree *bs_tree_new(BSTreeCompareFunc compare_func)
 {
     BSTree *tree = (BSTree *)malloc(sizeof(BSTree));
+    if (tree == NULL) {
+        return NULL;
+    }
     tree->compare_func = compare_func;
     tree->root = NULL;
     tree->num_nodes = 0;
+    tree->slab = NULL;
+    return tree;
+}
+
+BSTree *bs_tree_new_with_slab(BSTreeCompareFunc compare_func,
+                              unsigned int nodes_per_page)
+{
+    BSTree *tree = bs_tree_new(compare_func);
+    if (tree == NULL) {
+        return NULL;
+    }
+
+    tree->slab = slab_new(sizeof(BSTreeNode), nodes_per_page);
+    if (tree->slab == NULL) {
+        free(tree);
+        return NULL;
+    }
     return tree;
 }
 
+void bs_tree_free_node(BSTree *tree, BSTreeNode *node)
+{
+    if (tree->slab != NULL) {
+        slab_dealloc(tree->slab, node);
+    } else {
+        free(node);
+    }
+}
+
 static void bs_tree_free_node_callback(BSTreeNode *node, void *args)
 {
     // printf("free node: [%d]\n", *((int *)(node->data)));
@@ -31,14 +60,23 @@ static void bs_tree_free_node_callback(BSTreeNode *node, void *args)
 
 void bs_tree_free(BSTree *tree)
 {
+    if (tree->slab != NULL) {
+        /** nodes own nothing, drop their pages at once. */
+        slab_free(tree->slab);
+        free(tree);
+        return;
+    }
+
     // free all nodes
     bs_tree_postorder_traverse(tree, bs_tree_free_node_callback, NULL);
     free(tree);
 }
 
-static BSTreeNode *bs_tree_node_new(BSTreeValue data)
+static BSTreeNode *bs_tree_node_new(BSTree *tree, BSTreeValue data)
 {
-    BSTreeNode *node = (BSTreeNode *)malloc(sizeof(BSTreeNode));
+    BSTreeNode *node = tree->slab != NULL
+                           ? (BSTreeNode *)slab_alloc(tree->slab)
+                           : (BSTreeNode *)malloc(sizeof(BSTreeNode));
     node->data = data;
     node->parent = NULL;
     node->left = node->right = NULL;
@@ -64,7 +102,7 @@ BSTreeNode *bs_tree_insert(BSTree *tree, BSTreeValue data)
         }
     }
 
-    BSTreeNode *new_node = bs_tree_node_new(data);
+    BSTreeNode *new_node = bs_tree_node_new(tree, data);
     new_node->parent = insert;
     ++(tree->num_nodes);
 
@@ -14,6 +14,8 @@
 #ifndef RETHINK_C_BS_TREE_H
 #define RETHINK_C_BS_TREE_H
 
+#include "slab.h"
+
 /**
  * @brief The type of a value to be stored in a @ref BSTreeNode.
  *        (void *) can be changed to int, long, or other types if needed.
@@ -48,6 +50,8 @@ typedef struct _BSTree {
     BSTreeCompareFunc compare_func;
     /** The number of nodes of the @ref BSTree. */
     unsigned int num_nodes;
+    /** The Slab of nodes, NULL if nodes are allocated by malloc. */
+    Slab *slab;
 } BSTree;
 
 /**
@@ -58,6 +62,18 @@ typedef struct _BSTree {
  */
 BSTree *bs_tree_new(BSTreeCompareFunc compare_func);
 
+/**
+ * @brief Allcate a new BSTree whose nodes are allocated from its own Slab.
+ *
+ * Nodes are packed in pages, and bs_tree_free releases them in O(pages).
+ *
+ * @param compare_func      Compare two node value when do searching in BSTree.
+ * @param nodes_per_page    The number of nodes per Slab page, 0 for default.
+ * @return BSTree*          The new BSTree if success, otherwise return NULL.
+ */
+BSTree *bs_tree_new_with_slab(BSTreeCompareFunc compare_func,
+                              unsigned int nodes_per_page);
+
 /**
  * @brief Delete a BSTree and free back memory.
  *
@@ -103,6 +119,14 @@ BSTreeNode *bs_tree_insert(BSTree *tree, BSTreeValue data);
  */
 BSTreeNode *bs_tree_remove_node(BSTree *tree, BSTreeNode *node);
 
+/**
+ * @brief Free back a BSTreeNode removed by bs_tree_remove_node.
+ *
+ * @param tree          The BSTree.
+ * @param node          The BSTreeNode.
+ */
+void bs_tree_free_node(BSTree *tree, BSTreeNode *node);
+
 /**
  * @brief Find a BSTreeNode value in a BSTree.
  *
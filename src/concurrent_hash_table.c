@@ -0,0 +1,188 @@
+/**
+ * @file concurrent_hash_table.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to concurrent_hash_table.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+/** pthread_rwlock_t is hidden by strict -std=c99 headers. */
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent_hash_table.h"
+#include "def.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/** Stripes are padded to separate cache lines to avoid false sharing. */
+#define STRIPE_PADDING 128
+
+typedef union _ConcurrentHashTableStripe {
+    struct {
+        pthread_rwlock_t lock;
+        /** a chaining HashTable with stop-the-world rehash, so get is
+         * read only and can run under the read lock. */
+        HashTable *hash_table;
+    } s;
+    char padding[STRIPE_PADDING];
+} ConcurrentHashTableStripe;
+
+struct _ConcurrentHashTable {
+    ConcurrentHashTableStripe *stripes;
+    unsigned int num_stripes;
+    /** stripe index is the top bits of the multiplied hash. */
+    unsigned int stripe_shift;
+    HashTableHashFunc hash_func;
+};
+
+ConcurrentHashTable *
+concurrent_hash_table_new(HashTableHashFunc hash_func,
+                          HashTableEqualFunc equal_func,
+                          HashTableFreeKeyFunc free_key_func,
+                          HashTableFreeValueFunc free_value_func,
+                          unsigned int num_stripes)
+{
+    ConcurrentHashTable *table =
+        (ConcurrentHashTable *)malloc(sizeof(ConcurrentHashTable));
+    if (table == NULL) {
+        return NULL;
+    }
+
+    if (num_stripes == 0) {
+        num_stripes = CONCURRENT_HASH_TABLE_STRIPES;
+    }
+    /** at least 2 stripes, so stripe_shift is less than 32. */
+    table->num_stripes = 2;
+    table->stripe_shift = 31;
+    while (table->num_stripes < num_stripes && table->stripe_shift > 1) {
+        table->num_stripes <<= 1;
+        --(table->stripe_shift);
+    }
+    table->hash_func = hash_func;
+
+    table->stripes = (ConcurrentHashTableStripe *)malloc(
+        sizeof(ConcurrentHashTableStripe) * table->num_stripes);
+    if (table->stripes == NULL) {
+        free(table);
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < table->num_stripes; ++i) {
+        ConcurrentHashTableStripe *stripe = &(table->stripes[i]);
+        stripe->s.hash_table = hash_table_new(
+            hash_func, equal_func, free_key_func, free_value_func);
+        if (stripe->s.hash_table == NULL ||
+            pthread_rwlock_init(&(stripe->s.lock), NULL) != 0) {
+            if (stripe->s.hash_table != NULL) {
+                hash_table_free(stripe->s.hash_table);
+            }
+            table->num_stripes = i;
+            concurrent_hash_table_free(table);
+            return NULL;
+        }
+    }
+    return table;
+}
+
+void concurrent_hash_table_free(ConcurrentHashTable *table)
+{
+    for (unsigned int i = 0; i < table->num_stripes; ++i) {
+        pthread_rwlock_destroy(&(table->stripes[i].s.lock));
+        hash_table_free(table->stripes[i].s.hash_table);
+    }
+    free(table->stripes);
+    free(table);
+}
+
+static inline ConcurrentHashTableStripe *
+concurrent_hash_table_stripe(ConcurrentHashTable *table, HashTableKey key)
+{
+    /**
+     * stripe tables index buckets by the low bits of the hash, take the
+     * stripe from the high bits of a multiplicative mix, so keys of a stripe
+     * still spread over all its buckets.
+     */
+    unsigned int hash = table->hash_func(key) * 2654435769u;
+    return &(table->stripes[hash >> table->stripe_shift]);
+}
+
+int concurrent_hash_table_insert(ConcurrentHashTable *table,
+                                 HashTableKey key,
+                                 HashTableValue value)
+{
+    ConcurrentHashTableStripe *stripe =
+        concurrent_hash_table_stripe(table, key);
+    pthread_rwlock_wrlock(&(stripe->s.lock));
+    int ret = hash_table_insert(stripe->s.hash_table, key, value);
+    pthread_rwlock_unlock(&(stripe->s.lock));
+    return ret;
+}
+
+HashTableValue concurrent_hash_table_get(ConcurrentHashTable *table,
+                                         HashTableKey key)
+{
+    ConcurrentHashTableStripe *stripe =
+        concurrent_hash_table_stripe(table, key);
+    pthread_rwlock_rdlock(&(stripe->s.lock));
+    HashTableValue value = hash_table_get(stripe->s.hash_table, key);
+    pthread_rwlock_unlock(&(stripe->s.lock));
+    return value;
+}
+
+int concurrent_hash_table_set(ConcurrentHashTable *table,
+                              HashTableKey key,
+                              HashTableValue value)
+{
+    ConcurrentHashTableStripe *stripe =
+        concurrent_hash_table_stripe(table, key);
+    pthread_rwlock_wrlock(&(stripe->s.lock));
+    int ret = hash_table_set(stripe->s.hash_table, key, value);
+    pthread_rwlock_unlock(&(stripe->s.lock));
+    return ret;
+}
+
+int concurrent_hash_table_delete(ConcurrentHashTable *table, HashTableKey key)
+{
+    ConcurrentHashTableStripe *stripe =
+        concurrent_hash_table_stripe(table, key);
+    pthread_rwlock_wrlock(&(stripe->s.lock));
+    int ret = hash_table_delete(stripe->s.hash_table, key);
+    pthread_rwlock_unlock(&(stripe->s.lock));
+    return ret;
+}
+
+unsigned int concurrent_hash_table_size(ConcurrentHashTable *table)
+{
+    unsigned int size = 0;
+    for (unsigned int i = 0; i < table->num_stripes; ++i) {
+        ConcurrentHashTableStripe *stripe = &(table->stripes[i]);
+        pthread_rwlock_rdlock(&(stripe->s.lock));
+        size += hash_table_size(stripe->s.hash_table);
+        pthread_rwlock_unlock(&(stripe->s.lock));
+    }
+    return size;
+}
+
+int concurrent_hash_table_foreach(ConcurrentHashTable *table,
+                                  ConcurrentHashTableVisitFunc visit,
+                                  void *data)
+{
+    for (unsigned int i = 0; i < table->num_stripes; ++i) {
+        ConcurrentHashTableStripe *stripe = &(table->stripes[i]);
+        int ret = 0;
+        pthread_rwlock_rdlock(&(stripe->s.lock));
+        HashTable *hash_table = stripe->s.hash_table;
+        for (HashTableEntity *entity = hash_table_first_entity(hash_table);
+             entity != NULL && ret == 0;
+             entity = hash_table_next_entity(hash_table, entity)) {
+            ret = visit(entity->key, entity->value, data);
+        }
+        pthread_rwlock_unlock(&(stripe->s.lock));
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
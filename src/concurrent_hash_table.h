@@ -0,0 +1,153 @@
+/**
+ * @file concurrent_hash_table.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Thread-safe hash table with striped locks.
+ *
+ * Keys are spread over independent stripes, each a chaining @ref HashTable
+ * guarded by its own reader/writer lock. Threads working on different
+ * stripes never contend, readers of the same stripe share its lock, and a
+ * stripe resizes under its own write lock without blocking other stripes.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_CONCURRENT_HASH_TABLE_H
+#define RETHINK_C_CONCURRENT_HASH_TABLE_H
+
+#include "hash_table.h"
+
+/**
+ * Default number of stripes, enough to keep 64 threads mostly apart.
+ */
+#define CONCURRENT_HASH_TABLE_STRIPES 256
+
+/**
+ * @brief Definition of a @ref ConcurrentHashTable.
+ *
+ */
+typedef struct _ConcurrentHashTable ConcurrentHashTable;
+
+/**
+ * @brief Visit a key/value pair while iterating a ConcurrentHashTable.
+ *
+ * @param key       The key.
+ * @param value     The value.
+ * @param data      The user data passed to foreach.
+ * @return int      0 to continue, otherwise stop iterating.
+ */
+typedef int (*ConcurrentHashTableVisitFunc)(HashTableKey key,
+                                            HashTableValue value,
+                                            void *data);
+
+/**
+ * @brief Allcate a new ConcurrentHashTable.
+ *
+ * The hash, equal and free functions are called by many threads and must
+ * be thread-safe.
+ *
+ * @param hash_func         The hash function.
+ * @param equal_func        The equal function that compare keys.
+ * @param free_key_func     The free function that free keys.
+ * @param free_value_func   The free function that free values.
+ * @param num_stripes       The number of stripes, rounded up to a power of
+ *                          two, 0 for CONCURRENT_HASH_TABLE_STRIPES.
+ * @return ConcurrentHashTable*     The new table if success, otherwise NULL.
+ */
+ConcurrentHashTable *
+concurrent_hash_table_new(HashTableHashFunc hash_func,
+                          HashTableEqualFunc equal_func,
+                          HashTableFreeKeyFunc free_key_func,
+                          HashTableFreeValueFunc free_value_func,
+                          unsigned int num_stripes);
+
+/**
+ * @brief Delete a ConcurrentHashTable and free back memory.
+ *
+ * Not thread-safe: no other thread may use the table any more.
+ *
+ * @param table     The ConcurrentHashTable to delete.
+ */
+void concurrent_hash_table_free(ConcurrentHashTable *table);
+
+/**
+ * @brief Insert a key/value pair to a ConcurrentHashTable.
+ *
+ * @param table     The ConcurrentHashTable.
+ * @param key       The key.
+ * @param value     The value.
+ * @return int      0 if success, -1 if the key already exists.
+ */
+int concurrent_hash_table_insert(ConcurrentHashTable *table,
+                                 HashTableKey key,
+                                 HashTableValue value);
+
+/**
+ * @brief Get the value by a key from a ConcurrentHashTable.
+ *
+ * Mind: if the table frees values, the returned value may be freed by
+ * another thread which sets or deletes the same key.
+ *
+ * @param table             The ConcurrentHashTable.
+ * @param key               The key.
+ * @return HashTableValue   The value, HASH_TABLE_VALUE_NULL if not found.
+ */
+HashTableValue concurrent_hash_table_get(ConcurrentHashTable *table,
+                                         HashTableKey key);
+
+/**
+ * @brief Set a value by a key to a ConcurrentHashTable, insert a key/value
+ * pair if key not exists.
+ *
+ * @param table     The ConcurrentHashTable.
+ * @param key       The key.
+ * @param value     The value.
+ * @return int      0 if success.
+ */
+int concurrent_hash_table_set(ConcurrentHashTable *table,
+                              HashTableKey key,
+                              HashTableValue value);
+
+/**
+ * @brief Delete an entity by a key from a ConcurrentHashTable.
+ *
+ * @param table     The ConcurrentHashTable.
+ * @param key       The key.
+ * @return int      0 if success, -1 if not found.
+ */
+int concurrent_hash_table_delete(ConcurrentHashTable *table, HashTableKey key);
+
+/**
+ * @brief Get the size of a ConcurrentHashTable.
+ *
+ * Stripes are counted one by one, the result is exact only if no other
+ * thread modifies the table meanwhile.
+ *
+ * @param table             The ConcurrentHashTable.
+ * @return unsigned int     The size.
+ */
+unsigned int concurrent_hash_table_size(ConcurrentHashTable *table);
+
+/**
+ * @brief Visit all key/value pairs of a ConcurrentHashTable.
+ *
+ * Safe to run concurrently with other operations: each stripe is visited
+ * under its read lock, so every pair seen is consistent, while pairs of
+ * stripes not yet visited may still change. The visit function must not
+ * modify the table.
+ *
+ * @param table     The ConcurrentHashTable.
+ * @param visit     The visit function.
+ * @param data      The user data passed to visit.
+ * @return int      0 if all pairs visited, otherwise the non-zero return of
+ *                  visit which stopped iterating.
+ */
+int concurrent_hash_table_foreach(ConcurrentHashTable *table,
+                                  ConcurrentHashTableVisitFunc visit,
+                                  void *data);
+
+#endif /* #ifndef RETHINK_C_CONCURRENT_HASH_TABLE_H */
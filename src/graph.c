@@ -10,8 +10,7 @@
 
 #include "graph.h"
 #include "def.h"
-#include "dup.h"
-#include "queue.h"
+#include "iqueue.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -81,35 +80,47 @@ adjacency_matrix_connected(const AdjacencyMatrix *graph, int from, int to)
     return graph->edges[from][to] >= 0;
 }
 
+/** Per vertex state of BFS, linked into the candidates queue. */
+typedef struct _BfsVertex {
+    int visited;
+    IQueueNode link;
+} BfsVertex;
+
 int adjacency_matrix_bfs(const AdjacencyMatrix *graph, int start, int end)
 {
     int found = -1;
-    int *visited = (int *)malloc(sizeof(int) * graph->num_vertexes);
-    memset(visited, 0, sizeof(int) * graph->num_vertexes);
+    BfsVertex *vertexes =
+        (BfsVertex *)malloc(sizeof(BfsVertex) * graph->num_vertexes);
+    for (int i = 0; i < graph->num_vertexes; ++i) {
+        vertexes[i].visited = 0;
+    }
 
-    Queue *candidates = queue_new();
-    queue_push_tail(candidates, intdup(start));
+    IQueue candidates;
+    iqueue_init(&candidates);
+    /** mark visited when queued, so a vertex is queued at most once. */
+    vertexes[start].visited = 1;
+    iqueue_push_tail(&candidates, &(vertexes[start].link));
 
-    while (queue_is_empty(candidates)) {
-        int *current = (int *)queue_pop_head(candidates);
-        visited[*current] = 1;
+    while (!iqueue_is_empty(&candidates)) {
+        BfsVertex *vertex =
+            iqueue_entry(iqueue_pop_head(&candidates), BfsVertex, link);
+        int current = (int)(vertex - vertexes);
 
-        if (*current == end) {
-            free(current);
+        if (current == end) {
             found = 0;
             break;
         }
 
         for (int i = 0; i < graph->num_vertexes; ++i) {
-            if (adjacency_matrix_connected(graph, *current, i) && !visited[i]) {
-                queue_push_tail(candidates, intdup(i));
+            if (adjacency_matrix_connected(graph, current, i) &&
+                !vertexes[i].visited) {
+                vertexes[i].visited = 1;
+                iqueue_push_tail(&candidates, &(vertexes[i].link));
             }
         }
-        free(current);
     }
 
-    queue_free(candidates);
-    free(visited);
+    free(vertexes);
     return found;
 }
 
@@ -122,9 +133,11 @@ static int adjacency_matrix_dfs_internal(const AdjacencyMatrix *graph,
         return 0;
     }
 
+    visited[start] = 1;
     for (int i = 0; i < graph->num_vertexes; ++i) {
-        if (adjacency_matrix_connected(graph, start, i) && !visited[i]) {
-            adjacency_matrix_dfs_internal(graph, i, end, visited);
+        if (adjacency_matrix_connected(graph, start, i) && !visited[i] &&
+            adjacency_matrix_dfs_internal(graph, i, end, visited) == 0) {
+            return 0;
         }
     }
 
@@ -12,6 +12,9 @@
 #include "def.h"
 #include "text.h"
 
+#include <string.h>
+#include <time.h>
+
 unsigned int hash_char(void *pointer)
 {
     return *(unsigned char *)pointer;
@@ -24,7 +27,7 @@ unsigned int hash_int(void *pointer)
 
 unsigned int hash_object(void *object)
 {
-    return (unsigned int)object;
+    return (unsigned int)(uintptr_t)object;
 }
 
 /**
@@ -63,3 +66,186 @@ unsigned int hash_text(void *text)
     }
     return hash;
 }
+
+/** process wide seed of the fast hash family. */
+static uint64_t hash_seed = 0;
+
+/** wyhash secret: odd, and every byte has 4 bits set. */
+static const uint64_t hash_secret[4] = {0x2d358dccaa6c78a5ull,
+                                        0x8bb84b93962eacc9ull,
+                                        0x4b33a62ed433d4a3ull,
+                                        0x4d5a2da51de1aa47ull};
+
+void hash_set_seed(uint64_t seed)
+{
+    hash_seed = seed;
+}
+
+uint64_t hash_randomize_seed()
+{
+    /** no portable entropy source in C99, mix what differs between runs. */
+    int local;
+    uint64_t seed = hash_mix64((uint64_t)time(NULL));
+    seed = hash_mix64(seed ^ (uint64_t)clock());
+    seed = hash_mix64(seed ^ (uint64_t)(uintptr_t)&local);
+    seed = hash_mix64(seed ^ (uint64_t)(uintptr_t)&hash_seed);
+    hash_seed = seed;
+    return seed;
+}
+
+uint64_t hash_get_seed()
+{
+    return hash_seed;
+}
+
+/**
+ * @brief 64 x 64 => 128 bits multiply, A gets low 64 bits, B gets high.
+ */
+static inline void hash_mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)(*a) * (*b);
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    *a = lo;
+    *b = hi;
+#endif
+}
+
+static inline uint64_t hash_mum_mix(uint64_t a, uint64_t b)
+{
+    hash_mum(&a, &b);
+    return a ^ b;
+}
+
+/** little endian reads, so hashes are the same on every platform. */
+static inline uint64_t hash_read64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline uint64_t hash_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+/** 1 ~ 3 bytes. */
+static inline uint64_t hash_read3(const uint8_t *p, size_t k)
+{
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+/**
+ * @brief wyhash (final version 4) by Wang Yi, public domain.
+ *
+ * Keys up to 16 bytes are read by at most four overlapped loads without a
+ * loop; longer keys run three independent multiply lanes per 48 bytes.
+ */
+uint64_t hash_bytes64(const void *data, size_t len, uint64_t seed)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    const uint64_t *secret = hash_secret;
+    uint64_t a, b;
+
+    seed ^= hash_mum_mix(seed ^ secret[0], secret[1]);
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (hash_read32(p) << 32) | hash_read32(p + ((len >> 3) << 2));
+            b = (hash_read32(p + len - 4) << 32) |
+                hash_read32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = hash_read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hash_mum_mix(hash_read64(p) ^ secret[1],
+                                    hash_read64(p + 8) ^ seed);
+                see1 = hash_mum_mix(hash_read64(p + 16) ^ secret[2],
+                                    hash_read64(p + 24) ^ see1);
+                see2 = hash_mum_mix(hash_read64(p + 32) ^ secret[3],
+                                    hash_read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hash_mum_mix(hash_read64(p) ^ secret[1],
+                                hash_read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    hash_mum(&a, &b);
+    return hash_mum_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+/**
+ * @brief splitmix64 / murmur3 style finalizer.
+ */
+uint64_t hash_mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+/** fold 64 bits hash to HashTableHashFunc's unsigned int. */
+static inline unsigned int hash_fold(uint64_t hash)
+{
+    return (unsigned int)(hash ^ (hash >> 32));
+}
+
+unsigned int hash_int_mix(void *pointer)
+{
+    return hash_fold(hash_mix64(*(unsigned int *)pointer ^ hash_seed));
+}
+
+unsigned int hash_object_mix(void *object)
+{
+    return hash_fold(hash_mix64((uint64_t)(uintptr_t)object ^ hash_seed));
+}
+
+unsigned int hash_string_fast(void *string)
+{
+    return hash_fold(hash_bytes64(string, strlen((char *)string), hash_seed));
+}
+
+unsigned int hash_text_fast(void *text)
+{
+    return hash_fold(hash_bytes64(
+        text_char_string(text), text_length(text), hash_seed));
+}
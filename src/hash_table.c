@@ -15,14 +15,47 @@
 
 #include "hash_table.h"
 #include "def.h"
+#include "slab.h"
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Open addressing control bytes.
+ *
+ * A full slot stores the low 7 bits of the entity's hash (0 ~ 127), so a
+ * probe can reject most non-matching slots without calling equal_func.
+ */
+#define CTRL_EMPTY ((signed char)-128)
+#define CTRL_DELETED ((signed char)-2)
+/** Slots are probed by groups of 16 control bytes. */
+#define GROUP_WIDTH 16
+
+/** Keys hashed and prefetched ahead per round of a batch operation. */
+#define HASH_TABLE_BATCH 16
+
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
+
 struct _HashTable {
+    HashTableType type;
+
     /** data point to HashTableEntity array,
      * A HashTableEntity will be allocated when insert an entity to HashTable.
+     * (HASH_TABLE_CHAINING only.)
      */
     HashTableEntity **data;
+
+    /** open addressing: flat entity slots and their control bytes. */
+    HashTableEntity *slots;
+    signed char *ctrl;
+
     unsigned int length;
 
     HashTableHashFunc hash_func;
@@ -35,14 +68,38 @@ struct _HashTable {
     unsigned int _allocated;
     /** private: count collision times. */
     unsigned int _collisions;
+    /** private: count of DELETED control bytes (open addressing). */
+    unsigned int _deleted;
+
+    /**
+     * private: incremental rehash (chaining). While rehashing, data is the
+     * new bucket array, and _old_data buckets before _rehash_index have
+     * been moved to data.
+     */
+    HashTableEntity **_old_data;
+    unsigned int _old_allocated;
+    unsigned int _rehash_index;
+    /** private: buckets moved per operation, 0 means rehash at once. */
+    unsigned int _rehash_step;
+
+    /** private: Slab of chained entities, NULL if allocated by malloc. */
+    Slab *_slab;
 };
 
-HashTable *hash_table_new(HashTableHashFunc hash_func,
-                          HashTableEqualFunc equal_func,
-                          HashTableFreeKeyFunc free_key_func,
-                          HashTableFreeValueFunc free_value_func)
+static void hash_table_oa_alloc(HashTable *hash_table, unsigned int size);
+
+HashTable *hash_table_new_with_type(HashTableType type,
+                                    HashTableHashFunc hash_func,
+                                    HashTableEqualFunc equal_func,
+                                    HashTableFreeKeyFunc free_key_func,
+                                    HashTableFreeValueFunc free_value_func)
 {
     HashTable *hash_table = (HashTable *)malloc(sizeof(HashTable));
+    if (hash_table == NULL) {
+        return NULL;
+    }
+
+    hash_table->type = type;
     hash_table->hash_func = hash_func;
     hash_table->equal_func = equal_func;
     hash_table->free_key_func = free_key_func;
@@ -51,16 +108,376 @@ HashTable *hash_table_new(HashTableHashFunc hash_func,
     /** initiate default size */
     hash_table->_allocated = 16;
     hash_table->length = 0;
-    hash_table->data = (HashTableEntity **)malloc(sizeof(HashTableEntity *) *
-                                                  hash_table->_allocated);
-    memset(hash_table->data,
-           0,
-           sizeof(HashTableEntity *) * hash_table->_allocated);
-
     hash_table->_collisions = 0;
+    hash_table->_deleted = 0;
+    hash_table->_old_data = NULL;
+    hash_table->_old_allocated = 0;
+    hash_table->_rehash_index = 0;
+    hash_table->_rehash_step = 0;
+    hash_table->data = NULL;
+    hash_table->slots = NULL;
+    hash_table->ctrl = NULL;
+    hash_table->_slab = NULL;
+
+    if (type == HASH_TABLE_OPEN_ADDRESSING) {
+        hash_table_oa_alloc(hash_table, hash_table->_allocated);
+    } else {
+        hash_table->data = (HashTableEntity **)malloc(
+            sizeof(HashTableEntity *) * hash_table->_allocated);
+        memset(hash_table->data,
+               0,
+               sizeof(HashTableEntity *) * hash_table->_allocated);
+    }
+
+    return hash_table;
+}
+
+HashTable *hash_table_new_with_slab(HashTableHashFunc hash_func,
+                                    HashTableEqualFunc equal_func,
+                                    HashTableFreeKeyFunc free_key_func,
+                                    HashTableFreeValueFunc free_value_func,
+                                    unsigned int entities_per_page)
+{
+    HashTable *hash_table = hash_table_new_with_type(HASH_TABLE_CHAINING,
+                                                     hash_func,
+                                                     equal_func,
+                                                     free_key_func,
+                                                     free_value_func);
+    if (hash_table == NULL) {
+        return NULL;
+    }
+
+    hash_table->_slab = slab_new(sizeof(HashTableEntity), entities_per_page);
+    if (hash_table->_slab == NULL) {
+        hash_table_free(hash_table);
+        return NULL;
+    }
     return hash_table;
 }
 
+HashTable *hash_table_new(HashTableHashFunc hash_func,
+                          HashTableEqualFunc equal_func,
+                          HashTableFreeKeyFunc free_key_func,
+                          HashTableFreeValueFunc free_value_func)
+{
+    return hash_table_new_with_type(HASH_TABLE_CHAINING,
+                                    hash_func,
+                                    equal_func,
+                                    free_key_func,
+                                    free_value_func);
+}
+
+/**
+ * Open addressing engine.
+ *
+ * Swiss-table style: slots are split into groups of GROUP_WIDTH, each slot
+ * has a control byte (EMPTY, DELETED or 7 bits of hash). A lookup compares
+ * all control bytes of a group at once and only calls equal_func on slots
+ * whose 7 bits match. Groups are probed in triangular sequence, which visits
+ * every group because the group count is a power of two.
+ */
+
+static inline unsigned int hash_table_ctz(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    unsigned int n = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Mix the user hash, hash functions like hash_int are identity and would
+ * put consecutive keys into the same group.
+ */
+static inline unsigned int hash_table_oa_mix(unsigned int hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/** The hash stored in entities: mixed for open addressing. */
+static inline unsigned int hash_table_hash_key(const HashTable *hash_table,
+                                               HashTableKey key)
+{
+    unsigned int hash = hash_table->hash_func(key);
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_mix(hash);
+    }
+    return hash;
+}
+
+/** bit i set if ctrl[i] == value */
+static inline unsigned int hash_table_group_match(const signed char *ctrl,
+                                                  signed char value)
+{
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value)));
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; ++i) {
+        if (ctrl[i] == value) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/** bit i set if ctrl[i] is EMPTY or DELETED */
+static inline unsigned int hash_table_group_match_free(const signed char *ctrl)
+{
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), group));
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; ++i) {
+        if (ctrl[i] < -1) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+static void hash_table_oa_alloc(HashTable *hash_table, unsigned int size)
+{
+    hash_table->_allocated = size;
+    hash_table->_deleted = 0;
+    hash_table->slots =
+        (HashTableEntity *)malloc(sizeof(HashTableEntity) * size);
+    hash_table->ctrl = (signed char *)malloc(sizeof(signed char) * size);
+    memset(hash_table->ctrl, CTRL_EMPTY, sizeof(signed char) * size);
+}
+
+static inline unsigned int hash_table_oa_group_mask(const HashTable *hash_table)
+{
+    return hash_table->_allocated / GROUP_WIDTH - 1;
+}
+
+static HashTableEntity *hash_table_oa_find(const HashTable *hash_table,
+                                           HashTableKey key,
+                                           unsigned int hash)
+{
+    unsigned int mask = hash_table_oa_group_mask(hash_table);
+    unsigned int group = (hash >> 7) & mask;
+    signed char h2 = (signed char)(hash & 0x7F);
+
+    for (unsigned int step = 1;; ++step) {
+        unsigned int base = group * GROUP_WIDTH;
+        const signed char *ctrl = &(hash_table->ctrl[base]);
+
+        unsigned int match = hash_table_group_match(ctrl, h2);
+        while (match != 0) {
+            HashTableEntity *entity =
+                &(hash_table->slots[base + hash_table_ctz(match)]);
+            if (entity->hash == hash &&
+                hash_table->equal_func(entity->key, key)) {
+                return entity; /** find it */
+            }
+            match &= match - 1;
+        }
+
+        /** an EMPTY slot ends the probe sequence. */
+        if (hash_table_group_match(ctrl, CTRL_EMPTY) != 0) {
+            return NULL;
+        }
+        group = (group + step) & mask;
+    }
+}
+
+/** Find the first EMPTY or DELETED slot in probe sequence of a hash. */
+static unsigned int hash_table_oa_find_free(HashTable *hash_table,
+                                            unsigned int hash)
+{
+    unsigned int mask = hash_table_oa_group_mask(hash_table);
+    unsigned int group = (hash >> 7) & mask;
+
+    for (unsigned int step = 1;; ++step) {
+        unsigned int base = group * GROUP_WIDTH;
+        unsigned int match =
+            hash_table_group_match_free(&(hash_table->ctrl[base]));
+        if (match != 0) {
+            return base + hash_table_ctz(match);
+        }
+        group = (group + step) & mask;
+        ++(hash_table->_collisions);
+    }
+}
+
+static void hash_table_oa_resize(HashTable *hash_table, unsigned int new_size)
+{
+    HashTableEntity *old_slots = hash_table->slots;
+    signed char *old_ctrl = hash_table->ctrl;
+    unsigned int old_size = hash_table->_allocated;
+
+    hash_table_oa_alloc(hash_table, new_size);
+    hash_table->_collisions = 0;
+
+    for (unsigned int i = 0; i < old_size; ++i) {
+        if (old_ctrl[i] < 0) {
+            continue;
+        }
+        /** reuse the cached hash, keys are not read again. */
+        unsigned int hash = old_slots[i].hash;
+        unsigned int index = hash_table_oa_find_free(hash_table, hash);
+        hash_table->ctrl[index] = (signed char)(hash & 0x7F);
+        hash_table->slots[index] = old_slots[i];
+    }
+
+    free(old_slots);
+    free(old_ctrl);
+}
+
+static int hash_table_oa_insert(HashTable *hash_table,
+                                HashTableKey key,
+                                HashTableValue value,
+                                unsigned int hash)
+{
+    /** keep at least 1/8 slots EMPTY, so probing always terminates. */
+    unsigned int used = hash_table->length + hash_table->_deleted;
+    if (used >= hash_table->_allocated - hash_table->_allocated / 8) {
+        if (hash_table->_deleted > hash_table->length) {
+            /** mostly tombstones, clean them up with same size. */
+            hash_table_oa_resize(hash_table, hash_table->_allocated);
+        } else {
+            hash_table_oa_resize(hash_table, hash_table->_allocated * 2);
+        }
+    }
+
+    unsigned int mask = hash_table_oa_group_mask(hash_table);
+    unsigned int group = (hash >> 7) & mask;
+    signed char h2 = (signed char)(hash & 0x7F);
+    unsigned int index = hash_table->_allocated; /** no free slot yet */
+
+    /** check duplicated key and find a free slot in one probe pass. */
+    for (unsigned int step = 1;; ++step) {
+        unsigned int base = group * GROUP_WIDTH;
+        const signed char *ctrl = &(hash_table->ctrl[base]);
+
+        unsigned int match = hash_table_group_match(ctrl, h2);
+        while (match != 0) {
+            unsigned int i = base + hash_table_ctz(match);
+            if (hash_table->slots[i].hash == hash &&
+                hash_table->equal_func(hash_table->slots[i].key, key)) {
+                return -1; /** duplicated key */
+            }
+            match &= match - 1;
+        }
+
+        if (index == hash_table->_allocated) {
+            unsigned int free_match = hash_table_group_match_free(ctrl);
+            if (free_match != 0) {
+                index = base + hash_table_ctz(free_match);
+            } else {
+                ++(hash_table->_collisions);
+            }
+        }
+
+        if (hash_table_group_match(ctrl, CTRL_EMPTY) != 0) {
+            break;
+        }
+        group = (group + step) & mask;
+    }
+
+    if (hash_table->ctrl[index] == CTRL_DELETED) {
+        --(hash_table->_deleted);
+    }
+    hash_table->ctrl[index] = h2;
+    hash_table->slots[index].key = key;
+    hash_table->slots[index].value = value;
+    hash_table->slots[index].next = NULL;
+    hash_table->slots[index].hash = hash;
+
+    ++(hash_table->length);
+    return 0;
+}
+
+static int hash_table_oa_delete(HashTable *hash_table, HashTableKey key)
+{
+    unsigned int hash = hash_table_hash_key(hash_table, key);
+    HashTableEntity *entity = hash_table_oa_find(hash_table, key, hash);
+    if (entity == NULL) {
+        return -1;
+    }
+
+    unsigned int index = entity - hash_table->slots;
+    unsigned int base = index - index % GROUP_WIDTH;
+
+    /**
+     * A group holding an EMPTY slot has never been full, so no probe
+     * sequence has passed through it and the slot can become EMPTY again.
+     */
+    if (hash_table_group_match(&(hash_table->ctrl[base]), CTRL_EMPTY) != 0) {
+        hash_table->ctrl[index] = CTRL_EMPTY;
+    } else {
+        hash_table->ctrl[index] = CTRL_DELETED;
+        ++(hash_table->_deleted);
+    }
+
+    if (hash_table->free_key_func && entity->key) {
+        hash_table->free_key_func(entity->key);
+    }
+    if (hash_table->free_value_func && entity->value) {
+        hash_table->free_value_func(entity->value);
+    }
+    --(hash_table->length);
+    return 0;
+}
+
+static void hash_table_oa_free(HashTable *hash_table)
+{
+    for (unsigned int i = 0; i < hash_table->_allocated; ++i) {
+        if (hash_table->ctrl[i] < 0) {
+            continue;
+        }
+        HashTableEntity *entity = &(hash_table->slots[i]);
+        if (hash_table->free_key_func && entity->key) {
+            hash_table->free_key_func(entity->key);
+        }
+        if (hash_table->free_value_func && entity->value) {
+            hash_table->free_value_func(entity->value);
+        }
+    }
+    free(hash_table->slots);
+    free(hash_table->ctrl);
+}
+
+static HashTableEntity *
+hash_table_oa_next_entity_from_index(const HashTable *hash_table,
+                                     unsigned int index)
+{
+    for (unsigned int i = index; i < hash_table->_allocated; ++i) {
+        if (hash_table->ctrl[i] >= 0) {
+            return &(hash_table->slots[i]);
+        }
+    }
+    return NULL;
+}
+
+static HashTableEntity *
+hash_table_oa_last_entity_before_index(const HashTable *hash_table,
+                                       unsigned int index)
+{
+    for (unsigned int i = index; i > 0; --i) {
+        if (hash_table->ctrl[i - 1] >= 0) {
+            return &(hash_table->slots[i - 1]);
+        }
+    }
+    return NULL;
+}
+
 static void hash_table_free_entity(HashTable *hash_table,
                                    HashTableEntity *entity)
 {
@@ -70,139 +487,301 @@ static void hash_table_free_entity(HashTable *hash_table,
     if (hash_table->free_value_func && entity->value) {
         hash_table->free_value_func(entity->value);
     }
-    free(entity);
+    if (hash_table->_slab != NULL) {
+        slab_dealloc(hash_table->_slab, entity);
+    } else {
+        free(entity);
+    }
 }
 
-void hash_table_free(HashTable *hash_table)
+static void hash_table_free_buckets(HashTable *hash_table,
+                                    HashTableEntity **data,
+                                    unsigned int from,
+                                    unsigned int to)
 {
-    for (int i = 0; i < hash_table->_allocated; ++i) {
-        HashTableEntity *entity = hash_table->data[i];
+    for (unsigned int i = from; i < to; ++i) {
+        HashTableEntity *entity = data[i];
         while (entity) {
             HashTableEntity *prev = entity;
             entity = entity->next;
             hash_table_free_entity(hash_table, prev);
         }
     }
+}
+
+void hash_table_free(HashTable *hash_table)
+{
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        hash_table_oa_free(hash_table);
+        free(hash_table);
+        return;
+    }
+
+    /** entities in a Slab own nothing without free functions. */
+    int walk = hash_table->_slab == NULL || hash_table->free_key_func ||
+               hash_table->free_value_func;
+    if (hash_table->_old_data != NULL) {
+        if (walk) {
+            hash_table_free_buckets(hash_table,
+                                    hash_table->_old_data,
+                                    hash_table->_rehash_index,
+                                    hash_table->_old_allocated);
+        }
+        free(hash_table->_old_data);
+    }
+    if (walk) {
+        hash_table_free_buckets(
+            hash_table, hash_table->data, 0, hash_table->_allocated);
+    }
+    if (hash_table->_slab != NULL) {
+        slab_free(hash_table->_slab);
+    }
     free(hash_table->data);
     free(hash_table);
 }
 
-static HashTableEntity *hash_table_new_entity(HashTableKey key,
-                                              HashTableValue value)
+void hash_table_set_rehash_step(HashTable *hash_table, unsigned int step)
+{
+    hash_table->_rehash_step = step;
+}
+
+static HashTableEntity *hash_table_new_entity(HashTable *hash_table,
+                                              HashTableKey key,
+                                              HashTableValue value,
+                                              unsigned int hash)
 {
     HashTableEntity *entity =
-        (HashTableEntity *)malloc(sizeof(HashTableEntity));
+        hash_table->_slab != NULL
+            ? (HashTableEntity *)slab_alloc(hash_table->_slab)
+            : (HashTableEntity *)malloc(sizeof(HashTableEntity));
     entity->key = key;
     entity->value = value;
     entity->next = NULL;
+    entity->hash = hash;
     return entity;
 }
 
-static inline int hash_table_hashing_key(const HashTable *hash_table,
-                                         HashTableKey key)
+/**
+ * Bucket counts are powers of two, so index by masking. High bits are
+ * folded in first, otherwise keys like aligned pointers, which differ only
+ * in high bits, would share few buckets.
+ */
+static inline unsigned int hash_table_spread(unsigned int hash)
 {
-    return hash_table->hash_func(key) % hash_table->_allocated;
+    return hash ^ (hash >> 16);
 }
 
-static HashTableEntity *hash_table_find_insert_place(HashTable *hash_table,
-                                                     HashTableEntity *entity,
-                                                     HashTableKey key)
+static inline int hash_table_hashing_index(const HashTable *hash_table,
+                                           unsigned int hash)
 {
-    HashTableEntity *prev = NULL;
+    return hash_table_spread(hash) & (hash_table->_allocated - 1);
+}
+
+static inline int hash_table_is_rehashing(const HashTable *hash_table)
+{
+    return hash_table->_old_data != NULL;
+}
+
+/**
+ * While rehashing, buckets before _rehash_index of old data have been moved
+ * to data; an entity lives in old data only if its old bucket is not moved.
+ */
+static inline int hash_table_old_index(const HashTable *hash_table,
+                                       unsigned int hash)
+{
+    if (!hash_table_is_rehashing(hash_table)) {
+        return -1;
+    }
+
+    unsigned int index =
+        hash_table_spread(hash) & (hash_table->_old_allocated - 1);
+    return index >= hash_table->_rehash_index ? (int)index : -1;
+}
+
+/** Get the address of the bucket which holds (or will hold) the key. */
+static HashTableEntity **hash_table_bucket(const HashTable *hash_table,
+                                           unsigned int hash)
+{
+    int old_index = hash_table_old_index(hash_table, hash);
+    if (old_index >= 0) {
+        return &(hash_table->_old_data[old_index]);
+    }
+    return &(hash_table->data[hash_table_hashing_index(hash_table, hash)]);
+}
+
+/**
+ * Move all entities of an old bucket to new buckets.
+ * Keys in a bucket are unique, so entities are just prepended without
+ * calling equal_func, and the cached hash is used instead of hash_func.
+ */
+static void hash_table_move_bucket(HashTable *hash_table,
+                                   HashTableEntity **old_data,
+                                   unsigned int old_index)
+{
+    HashTableEntity *entity = old_data[old_index];
     while (entity != NULL) {
-        if (hash_table->equal_func(entity->key, key)) {
-            return NULL; /** duplicated key */
-        } else {
-            prev = entity;
-            entity = entity->next;
+        HashTableEntity *next = entity->next;
+        unsigned int index = hash_table_hashing_index(hash_table, entity->hash);
+        if (hash_table->data[index] != NULL) {
+            ++(hash_table->_collisions);
         }
+        entity->next = hash_table->data[index];
+        hash_table->data[index] = entity;
+        entity = next;
     }
+    old_data[old_index] = NULL;
+}
 
-    return prev;
+static void hash_table_finish_rehash(HashTable *hash_table)
+{
+    free(hash_table->_old_data);
+    hash_table->_old_data = NULL;
+    hash_table->_old_allocated = 0;
+    hash_table->_rehash_index = 0;
+}
+
+/**
+ * Move at most `buckets` non-empty buckets, and visit at most 10 times
+ * empty buckets, so one step has bounded latency.
+ */
+static void hash_table_rehash(HashTable *hash_table, unsigned int buckets)
+{
+    unsigned int empty_visits = buckets * 10;
+    while (buckets > 0 &&
+           hash_table->_rehash_index < hash_table->_old_allocated) {
+        unsigned int index = hash_table->_rehash_index;
+        if (hash_table->_old_data[index] == NULL) {
+            ++(hash_table->_rehash_index);
+            if (--empty_visits == 0) {
+                break;
+            }
+            continue;
+        }
+
+        hash_table_move_bucket(hash_table, hash_table->_old_data, index);
+        ++(hash_table->_rehash_index);
+        --buckets;
+    }
+
+    if (hash_table->_rehash_index >= hash_table->_old_allocated) {
+        hash_table_finish_rehash(hash_table);
+    }
+}
+
+static inline void hash_table_rehash_step(HashTable *hash_table)
+{
+    if (hash_table_is_rehashing(hash_table)) {
+        hash_table_rehash(hash_table, hash_table->_rehash_step);
+    }
 }
 
 static void hash_table_enlarge(HashTable *hash_table)
 {
+    if (hash_table_is_rehashing(hash_table)) {
+        /** grow again before last rehash finished, finish it first. */
+        hash_table_rehash(hash_table, hash_table->_old_allocated);
+    }
+
     unsigned int new_size = hash_table->_allocated * 2;
+    /** calloc lets the system hand out zeroed pages lazily. */
     HashTableEntity **new_data =
-        (HashTableEntity **)malloc(sizeof(HashTableEntity *) * new_size);
-    memset(new_data, 0, sizeof(HashTableEntity *) * new_size);
+        (HashTableEntity **)calloc(new_size, sizeof(HashTableEntity *));
 
-    unsigned int old_size = hash_table->_allocated;
+    hash_table->_old_data = hash_table->data;
+    hash_table->_old_allocated = hash_table->_allocated;
+    hash_table->_rehash_index = 0;
+
+    hash_table->data = new_data;
     hash_table->_allocated = new_size;
     hash_table->_collisions = 0;
 
-    for (unsigned int i = 0; i < old_size; ++i) {
-        HashTableEntity *entity = hash_table->data[i];
+    if (hash_table->_rehash_step == 0) {
+        /** stop the world: move all buckets at once. */
+        hash_table_rehash(hash_table, hash_table->_old_allocated);
+    }
+}
 
-        while (entity != NULL) {
-            HashTableEntity *new_entity = entity;
-            entity = entity->next;
+static int hash_table_chaining_insert(HashTable *hash_table,
+                                      HashTableKey key,
+                                      HashTableValue value,
+                                      unsigned int hash)
+{
+    HashTableEntity **bucket = hash_table_bucket(hash_table, hash);
+    HashTableEntity *prev = NULL;
+    for (HashTableEntity *entity = *bucket; entity != NULL;
+         entity = entity->next) {
+        if (entity->hash == hash && hash_table->equal_func(entity->key, key)) {
+            return -1; /** duplicated key */
+        }
+        prev = entity;
+    }
 
-            new_entity->next = NULL;
-            unsigned int new_hash =
-                hash_table_hashing_key(hash_table, new_entity->key);
+    if (prev == NULL) {
+        *bucket = hash_table_new_entity(hash_table, key, value, hash);
+    } else {
+        /** hash collision, append value to entity list. */
+        prev->next = hash_table_new_entity(hash_table, key, value, hash);
+        ++(hash_table->_collisions);
+    }
 
-            if (new_data[new_hash] == NULL) {
-                new_data[new_hash] = new_entity;
-            } else {
-                HashTableEntity *prev = hash_table_find_insert_place(
-                    hash_table, new_data[new_hash], new_entity->key);
+    ++(hash_table->length);
+    return 0;
+}
 
-                /** hash collision, append */
-                prev->next = new_entity;
-                ++(hash_table->_collisions);
-            }
-        }
+/** Insert by key and its hash, without moving buckets: callers step. */
+static int hash_table_insert_hashed(HashTable *hash_table,
+                                    HashTableKey key,
+                                    HashTableValue value,
+                                    unsigned int hash)
+{
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_insert(hash_table, key, value, hash);
     }
 
-    free(hash_table->data); /** free old data */
-    hash_table->data = new_data;
+    if (hash_table->length > (hash_table->_allocated * 0.75)) {
+        /** enlarge table */
+        hash_table_enlarge(hash_table);
+    }
+
+    return hash_table_chaining_insert(hash_table, key, value, hash);
 }
 
 int hash_table_insert(HashTable *hash_table,
                       HashTableKey key,
                       HashTableValue value)
 {
-    if (hash_table->length > (hash_table->_allocated * 0.75)) {
-        /** enlarge table */
-        hash_table_enlarge(hash_table);
+    hash_table_rehash_step(hash_table);
+    return hash_table_insert_hashed(
+        hash_table, key, value, hash_table_hash_key(hash_table, key));
+}
+
+/** Find an entity by key and its hash, without moving buckets. */
+static HashTableEntity *hash_table_find_hashed(const HashTable *hash_table,
+                                               HashTableKey key,
+                                               unsigned int hash)
+{
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_find(hash_table, key, hash);
     }
 
-    int index = hash_table_hashing_key(hash_table, key);
-    if (hash_table->data[index] == NULL) {
-        hash_table->data[index] = hash_table_new_entity(key, value);
-    } else {
-        HashTableEntity *prev = hash_table_find_insert_place(
-            hash_table, hash_table->data[index], key);
-        /** hash collision, append value to entity list. */
-        prev->next = hash_table_new_entity(key, value);
-        ++(hash_table->_collisions);
+    HashTableEntity *entity = *hash_table_bucket(hash_table, hash);
+    while (entity != NULL) {
+        if (entity->hash == hash && hash_table->equal_func(entity->key, key)) {
+            return entity; /** find it */
+        }
+        entity = entity->next;
     }
 
-    ++(hash_table->length);
-    return 0;
+    /** not found */
+    return NULL;
 }
 
 static HashTableEntity *hash_table_get_entity(HashTable *hash_table,
                                               HashTableKey key)
 {
-    int index = hash_table_hashing_key(hash_table, key);
-    if (hash_table->data[index] == NULL) {
-        return NULL;
-    } else {
-        HashTableEntity *entity = hash_table->data[index];
-        while (entity != NULL) {
-            if (hash_table->equal_func(entity->key, key)) {
-                return entity; /** find it */
-            } else {
-                entity = entity->next;
-            }
-        }
-
-        /** not found */
-        return NULL;
-    }
+    hash_table_rehash_step(hash_table);
+    return hash_table_find_hashed(
+        hash_table, key, hash_table_hash_key(hash_table, key));
 }
 
 HashTableValue hash_table_get(HashTable *hash_table, HashTableKey key)
@@ -214,11 +793,12 @@ HashTableValue hash_table_get(HashTable *hash_table, HashTableKey key)
         return HASH_TABLE_VALUE_NULL;
 }
 
-int hash_table_set(HashTable *hash_table,
-                   HashTableKey key,
-                   HashTableValue value)
+static int hash_table_set_hashed(HashTable *hash_table,
+                                 HashTableKey key,
+                                 HashTableValue value,
+                                 unsigned int hash)
 {
-    HashTableEntity *entity = hash_table_get_entity(hash_table, key);
+    HashTableEntity *entity = hash_table_find_hashed(hash_table, key, hash);
     if (entity) {
         if (hash_table->free_value_func && entity->value) {
             hash_table->free_value_func(entity->value);
@@ -226,99 +806,293 @@ int hash_table_set(HashTable *hash_table,
         entity->value = value;
         return 0;
     } else {
-        return hash_table_insert(hash_table, key, value);
+        return hash_table_insert_hashed(hash_table, key, value, hash);
     }
 }
 
-int hash_table_delete(HashTable *hash_table, HashTableKey key)
+int hash_table_set(HashTable *hash_table,
+                   HashTableKey key,
+                   HashTableValue value)
 {
-    int index = hash_table_hashing_key(hash_table, key);
-    if (hash_table->data[index] == NULL) {
-        return -1;
+    hash_table_rehash_step(hash_table);
+    return hash_table_set_hashed(
+        hash_table, key, value, hash_table_hash_key(hash_table, key));
+}
+
+/**
+ * Batch operations.
+ *
+ * A batch is resolved by rounds of HASH_TABLE_BATCH keys: hash all keys of
+ * the round and prefetch their buckets (control bytes), then prefetch the
+ * first candidate entities, then resolve the keys. Cache misses of
+ * different keys overlap instead of being serialized.
+ */
+
+static inline void hash_table_prefetch_bucket(const HashTable *hash_table,
+                                              unsigned int hash)
+{
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        unsigned int group = (hash >> 7) & hash_table_oa_group_mask(hash_table);
+        PREFETCH(&(hash_table->ctrl[group * GROUP_WIDTH]));
     } else {
-        HashTableEntity *entity = hash_table->data[index];
-        HashTableEntity *prev = NULL;
-        while (entity != NULL) {
-            if (hash_table->equal_func(entity->key, key)) {
-                if (prev == NULL) {
-                    hash_table->data[index] = NULL;
-                } else {
-                    prev->next = NULL;
-                }
-                --(hash_table->length);
-                hash_table_free_entity(hash_table, entity);
-                return 0; /** find and delete it */
-            } else {
-                entity = entity->next;
-            }
+        PREFETCH(hash_table_bucket(hash_table, hash));
+    }
+}
+
+static inline void hash_table_prefetch_entity(const HashTable *hash_table,
+                                              unsigned int hash)
+{
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        unsigned int group = (hash >> 7) & hash_table_oa_group_mask(hash_table);
+        unsigned int base = group * GROUP_WIDTH;
+        unsigned int match = hash_table_group_match(
+            &(hash_table->ctrl[base]), (signed char)(hash & 0x7F));
+        if (match != 0) {
+            PREFETCH(&(hash_table->slots[base + hash_table_ctz(match)]));
         }
+    } else {
+        HashTableEntity *entity = *hash_table_bucket(hash_table, hash);
+        if (entity != NULL) {
+            PREFETCH(entity);
+        }
+    }
+}
 
-        /** not found */
-        return -1;
+/** hash a round of keys and prefetch their buckets, return round size. */
+static unsigned int hash_table_prepare_round(HashTable *hash_table,
+                                             HashTableKey *keys,
+                                             unsigned int count,
+                                             unsigned int *hashes,
+                                             int prefetch_entity)
+{
+    unsigned int n = count < HASH_TABLE_BATCH ? count : HASH_TABLE_BATCH;
+
+    /** same amount of incremental rehash work as n single operations. */
+    if (hash_table_is_rehashing(hash_table)) {
+        hash_table_rehash(hash_table, hash_table->_rehash_step * n);
+    }
+
+    for (unsigned int i = 0; i < n; ++i) {
+        hashes[i] = hash_table_hash_key(hash_table, keys[i]);
+        hash_table_prefetch_bucket(hash_table, hashes[i]);
     }
+    if (prefetch_entity) {
+        for (unsigned int i = 0; i < n; ++i) {
+            hash_table_prefetch_entity(hash_table, hashes[i]);
+        }
+    }
+    return n;
 }
 
-unsigned int hash_table_size(const HashTable *hash_table)
+void hash_table_get_many(HashTable *hash_table,
+                         HashTableKey *keys,
+                         unsigned int count,
+                         HashTableValue *values)
 {
-    return hash_table->length;
+    unsigned int hashes[HASH_TABLE_BATCH];
+    for (unsigned int from = 0; from < count;) {
+        unsigned int n = hash_table_prepare_round(
+            hash_table, &keys[from], count - from, hashes, 1);
+        for (unsigned int i = 0; i < n; ++i) {
+            HashTableEntity *entity =
+                hash_table_find_hashed(hash_table, keys[from + i], hashes[i]);
+            values[from + i] = entity ? entity->value : HASH_TABLE_VALUE_NULL;
+        }
+        from += n;
+    }
 }
 
-static HashTableEntity *
-hash_table_next_entity_from_index(const HashTable *hash_table, int index)
+unsigned int hash_table_insert_many(HashTable *hash_table,
+                                    HashTableKey *keys,
+                                    HashTableValue *values,
+                                    unsigned int count)
 {
-    HashTableEntity *next = NULL;
-    for (int i = index; i < hash_table->_allocated; ++i) {
-        if (hash_table->data[i] != NULL) {
-            next = hash_table->data[i];
-            break;
+    unsigned int hashes[HASH_TABLE_BATCH];
+    unsigned int inserted = 0;
+    for (unsigned int from = 0; from < count;) {
+        unsigned int n = hash_table_prepare_round(
+            hash_table, &keys[from], count - from, hashes, 0);
+        for (unsigned int i = 0; i < n; ++i) {
+            if (hash_table_insert_hashed(hash_table,
+                                         keys[from + i],
+                                         values[from + i],
+                                         hashes[i]) == 0) {
+                ++inserted;
+            }
         }
+        from += n;
     }
-    return next;
+    return inserted;
 }
 
-HashTableEntity *hash_table_first_entity(const HashTable *hash_table)
+int hash_table_set_many(HashTable *hash_table,
+                        HashTableKey *keys,
+                        HashTableValue *values,
+                        unsigned int count)
 {
-    return hash_table_next_entity_from_index(hash_table, 0);
+    unsigned int hashes[HASH_TABLE_BATCH];
+    for (unsigned int from = 0; from < count;) {
+        unsigned int n = hash_table_prepare_round(
+            hash_table, &keys[from], count - from, hashes, 1);
+        for (unsigned int i = 0; i < n; ++i) {
+            hash_table_set_hashed(
+                hash_table, keys[from + i], values[from + i], hashes[i]);
+        }
+        from += n;
+    }
+    return 0;
 }
 
-static HashTableEntity *
-hash_table_last_entity_before_index(const HashTable *hash_table, int index)
+int hash_table_delete(HashTable *hash_table, HashTableKey key)
+{
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_delete(hash_table, key);
+    }
+
+    hash_table_rehash_step(hash_table);
+    unsigned int hash = hash_table_hash_key(hash_table, key);
+    HashTableEntity **link = hash_table_bucket(hash_table, hash);
+    while (*link != NULL) {
+        HashTableEntity *entity = *link;
+        if (entity->hash == hash && hash_table->equal_func(entity->key, key)) {
+            *link = entity->next; /** unlink it */
+            --(hash_table->length);
+            hash_table_free_entity(hash_table, entity);
+            return 0; /** find and delete it */
+        }
+        link = &(entity->next);
+    }
+
+    /** not found */
+    return -1;
+}
+
+unsigned int hash_table_size(const HashTable *hash_table)
+{
+    return hash_table->length;
+}
+
+/**
+ * Iteration order while rehashing: unmoved old buckets first, then the new
+ * buckets.
+ */
+
+static HashTableEntity *hash_table_next_entity_from_index(
+    HashTableEntity **data, unsigned int index, unsigned int size)
 {
-    HashTableEntity *last = NULL;
-    for (int i = index - 1; i >= 0; --i) {
-        if (hash_table->data[i] != NULL) {
-            last = hash_table->data[i];
+    for (unsigned int i = index; i < size; ++i) {
+        if (data[i] != NULL) {
+            return data[i];
+        }
+    }
+    return NULL;
+}
+
+static HashTableEntity *hash_table_last_entity_before_index(
+    HashTableEntity **data, unsigned int index, unsigned int lower)
+{
+    for (unsigned int i = index; i > lower; --i) {
+        HashTableEntity *last = data[i - 1];
+        if (last != NULL) {
             while (last->next != NULL) {
                 last = last->next;
             }
-            break;
+            return last;
         }
     }
-    return last;
+    return NULL;
+}
+
+/** The first entity in new buckets from index, or NULL. */
+static HashTableEntity *hash_table_new_next(const HashTable *hash_table,
+                                            unsigned int index)
+{
+    return hash_table_next_entity_from_index(
+        hash_table->data, index, hash_table->_allocated);
+}
+
+/** The first unmoved entity in old buckets from index, or new buckets. */
+static HashTableEntity *hash_table_old_next(const HashTable *hash_table,
+                                            unsigned int index)
+{
+    HashTableEntity *next = NULL;
+    if (hash_table_is_rehashing(hash_table)) {
+        next = hash_table_next_entity_from_index(
+            hash_table->_old_data, index, hash_table->_old_allocated);
+    }
+    return next != NULL ? next : hash_table_new_next(hash_table, 0);
+}
+
+/** The last unmoved entity in old buckets before index, or NULL. */
+static HashTableEntity *hash_table_old_last(const HashTable *hash_table,
+                                            unsigned int index)
+{
+    if (!hash_table_is_rehashing(hash_table)) {
+        return NULL;
+    }
+    return hash_table_last_entity_before_index(
+        hash_table->_old_data, index, hash_table->_rehash_index);
+}
+
+/** The last entity in new buckets before index, or old buckets. */
+static HashTableEntity *hash_table_new_last(const HashTable *hash_table,
+                                            unsigned int index)
+{
+    HashTableEntity *last =
+        hash_table_last_entity_before_index(hash_table->data, index, 0);
+    if (last != NULL) {
+        return last;
+    }
+    return hash_table_old_last(hash_table, hash_table->_old_allocated);
+}
+
+HashTableEntity *hash_table_first_entity(const HashTable *hash_table)
+{
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_next_entity_from_index(hash_table, 0);
+    }
+    return hash_table_old_next(hash_table, hash_table->_rehash_index);
 }
 
 HashTableEntity *hash_table_last_entity(const HashTable *hash_table)
 {
-    return hash_table_last_entity_before_index(hash_table,
-                                               hash_table->_allocated);
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_last_entity_before_index(hash_table,
+                                                      hash_table->_allocated);
+    }
+    return hash_table_new_last(hash_table, hash_table->_allocated);
 }
 
 HashTableEntity *hash_table_next_entity(const HashTable *hash_table,
                                         HashTableEntity *entity)
 {
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_next_entity_from_index(
+            hash_table, entity - hash_table->slots + 1);
+    }
+
     HashTableEntity *next = entity->next;
     if (next != NULL)
         return next;
 
-    int index = hash_table_hashing_key(hash_table, entity->key);
-    return hash_table_next_entity_from_index(hash_table, index + 1);
+    int old_index = hash_table_old_index(hash_table, entity->hash);
+    if (old_index >= 0) {
+        return hash_table_old_next(hash_table, old_index + 1);
+    }
+    int index = hash_table_hashing_index(hash_table, entity->hash);
+    return hash_table_new_next(hash_table, index + 1);
 }
 
 HashTableEntity *hash_table_prev_entity(const HashTable *hash_table,
                                         HashTableEntity *entity)
 {
-    int index = hash_table_hashing_key(hash_table, entity->key);
-    HashTableEntity *rover = hash_table->data[index];
+    if (hash_table->type == HASH_TABLE_OPEN_ADDRESSING) {
+        return hash_table_oa_last_entity_before_index(
+            hash_table, entity - hash_table->slots);
+    }
+
+    HashTableEntity **bucket = hash_table_bucket(hash_table, entity->hash);
+    HashTableEntity *rover = *bucket;
     if (rover != entity) {
         while (rover->next != entity) {
             rover = rover->next;
@@ -326,5 +1100,10 @@ HashTableEntity *hash_table_prev_entity(const HashTable *hash_table,
         return rover;
     }
 
-    return hash_table_last_entity_before_index(hash_table, index);
+    int old_index = hash_table_old_index(hash_table, entity->hash);
+    if (old_index >= 0) {
+        return hash_table_old_last(hash_table, old_index);
+    }
+    int index = hash_table_hashing_index(hash_table, entity->hash);
+    return hash_table_new_last(hash_table, index);
 }
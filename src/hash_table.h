@@ -39,6 +39,8 @@ typedef struct _HashTableEntity {
     HashTableKey key;
     HashTableValue value;
     struct _HashTableEntity *next;
+    /** Cached hash of key, compared before calling equal_func. */
+    unsigned int hash;
 } HashTableEntity;
 
 typedef unsigned int (*HashTableHashFunc)(HashTableKey key);
@@ -47,6 +49,18 @@ typedef int (*HashTableEqualFunc)(HashTableKey key1, HashTableKey key2);
 typedef void (*HashTableFreeKeyFunc)(HashTableKey key);
 typedef void (*HashTableFreeValueFunc)(HashTableValue value);
 
+typedef enum {
+    /** Separate chaining, one HashTableEntity allocated per insert. */
+    HASH_TABLE_CHAINING = 0,
+    /**
+     * Open addressing: entities are stored in a flat array and probed with
+     * Swiss-table style control bytes (SSE2 group probing when available).
+     * Deleted entities leave tombstones, so entity pointers stay valid until
+     * the next insertion.
+     */
+    HASH_TABLE_OPEN_ADDRESSING = 1
+} HashTableType;
+
 /**
  * @brief Definition of a @ref HashTable.
  *
@@ -67,6 +81,43 @@ HashTable *hash_table_new(HashTableHashFunc hash_func,
                           HashTableFreeKeyFunc free_key_func,
                           HashTableFreeKeyFunc free_value_func);
 
+/**
+ * @brief Allcate a new HashTable with a specified engine.
+ *
+ * @param type              HASH_TABLE_CHAINING or HASH_TABLE_OPEN_ADDRESSING.
+ * @param hash_func         The hash function.
+ * @param equal_func        The equal function that compare keys.
+ * @param free_key_func     The free function that free keys.
+ * @param free_value_func   The free function that free values.
+ * @return HashTable*       The new HashTable if success, otherwise NULL.
+ */
+HashTable *hash_table_new_with_type(HashTableType type,
+                                    HashTableHashFunc hash_func,
+                                    HashTableEqualFunc equal_func,
+                                    HashTableFreeKeyFunc free_key_func,
+                                    HashTableFreeValueFunc free_value_func);
+
+/**
+ * @brief Allcate a new chaining HashTable whose entities are allocated from
+ * its own Slab.
+ *
+ * Entities are packed in pages, and hash_table_free releases them in
+ * O(pages) if there are no free key/value functions.
+ *
+ * @param hash_func         The hash function.
+ * @param equal_func        The equal function that compare keys.
+ * @param free_key_func     The free function that free keys.
+ * @param free_value_func   The free function that free values.
+ * @param entities_per_page The number of entities per Slab page, 0 for
+ *                          default.
+ * @return HashTable*       The new HashTable if success, otherwise NULL.
+ */
+HashTable *hash_table_new_with_slab(HashTableHashFunc hash_func,
+                                    HashTableEqualFunc equal_func,
+                                    HashTableFreeKeyFunc free_key_func,
+                                    HashTableFreeValueFunc free_value_func,
+                                    unsigned int entities_per_page);
+
 /**
  * @brief Delete a HashTable and free back memory.
  *
@@ -74,13 +125,30 @@ HashTable *hash_table_new(HashTableHashFunc hash_func,
  */
 void hash_table_free(HashTable *hash_table);
 
+/**
+ * @brief Enable incremental rehash of a HashTable.
+ *
+ * When a chaining HashTable grows, both the old and new bucket arrays are
+ * kept, and each insert/get/set/delete moves at most `step` buckets to the
+ * new array, so no single operation rehashes the whole table.
+ *
+ * Mind: while a rehash is in progress, get moves entities too, iteration
+ * should not be interleaved with any other operation on the HashTable.
+ * Open addressing HashTable ignores this setting.
+ *
+ * @param hash_table    The HashTable.
+ * @param step          Buckets moved per operation, 0 (default) to rehash
+ *                      all buckets at once.
+ */
+void hash_table_set_rehash_step(HashTable *hash_table, unsigned int step);
+
 /**
  * @brief Insert a key/value pair to a HashTable.
  *
  * @param hash_table    The HashTable.
  * @param key           The key.
  * @param value         The value.
- * @return int          0 if success.
+ * @return int          0 if success, -1 if the key already exists.
  */
 int hash_table_insert(HashTable *hash_table,
                       HashTableKey key,
@@ -108,6 +176,53 @@ int hash_table_set(HashTable *hash_table,
                    HashTableKey key,
                    HashTableValue value);
 
+/**
+ * @brief Get the values of many keys from a HashTable.
+ *
+ * Keys are hashed and their buckets prefetched ahead of the lookups, so the
+ * memory latency of different keys overlaps. The result is the same as
+ * calling hash_table_get on each key.
+ *
+ * @param hash_table    The HashTable.
+ * @param keys          The keys.
+ * @param count         The number of keys.
+ * @param values        The output values, values[i] is the value of keys[i],
+ *                      HASH_TABLE_VALUE_NULL if not found.
+ */
+void hash_table_get_many(HashTable *hash_table,
+                         HashTableKey *keys,
+                         unsigned int count,
+                         HashTableValue *values);
+
+/**
+ * @brief Insert many key/value pairs to a HashTable.
+ *
+ * @param hash_table        The HashTable.
+ * @param keys              The keys.
+ * @param values            The values, values[i] is the value of keys[i].
+ * @param count             The number of pairs.
+ * @return unsigned int     The number of inserted pairs, pairs whose key
+ *                          already exists are skipped.
+ */
+unsigned int hash_table_insert_many(HashTable *hash_table,
+                                    HashTableKey *keys,
+                                    HashTableValue *values,
+                                    unsigned int count);
+
+/**
+ * @brief Set many key/value pairs to a HashTable, as hash_table_set on each.
+ *
+ * @param hash_table    The HashTable.
+ * @param keys          The keys.
+ * @param values        The values, values[i] is the value of keys[i].
+ * @param count         The number of pairs.
+ * @return int          0 if success.
+ */
+int hash_table_set_many(HashTable *hash_table,
+                        HashTableKey *keys,
+                        HashTableValue *values,
+                        unsigned int count);
+
 /**
  * @brief Delete an entity by a key from a HashTable.
  *
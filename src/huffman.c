@@ -13,8 +13,13 @@
 #include "def.h"
 #include "hash.h"
 #include "hash_table.h"
+#include "lz77.h"
 
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
+#include <string.h>
 
 static inline int huffman_node_compare(HuffmanNode *node1, HuffmanNode *node2)
 {
@@ -196,9 +201,9 @@ STATIC HashTable *huffman_tree_to_hash_table(const HuffmanTree *tree)
     return hash_table;
 }
 
-BitMap *huffman_encode_string(const HuffmanTree *tree,
-                              const char *string,
-                              unsigned int size)
+static BitMap *huffman_encode_string_by_hash_table(const HuffmanTree *tree,
+                                                  const char *string,
+                                                  unsigned int size)
 {
     /** key: char, value: bitmap */
     HashTable *hash_table = huffman_tree_to_hash_table(tree);
@@ -207,22 +212,136 @@ BitMap *huffman_encode_string(const HuffmanTree *tree,
     for (unsigned int i = 0; i < size; ++i) {
         BitMap *bits = (BitMap *)hash_table_get(hash_table, &(string[i]));
         bitmap_concat(bitmap, bits);
-        // todo: error here.
-        // for (unsigned int j = 0; j < bits->num_bits; ++j) {
-        //     bitmap_append(bitmap, bitmap_get(bits, j));
-        // }
     }
     hash_table_free(hash_table);
     return bitmap;
 }
 
+static int huffman_tree_preorder_to_table(const HuffmanNode *node,
+                                          HuffmanTable *table,
+                                          uint64_t code,
+                                          unsigned int length)
+{
+    if (huffman_node_is_leave(node)) {
+        unsigned char ch = (unsigned char)node->value;
+        table->codes[ch] = code;
+        table->lengths[ch] = (unsigned char)length;
+        return 0;
+    }
+
+    /** the children are one bit longer. */
+    if (length >= HUFFMAN_MAX_CODE_BITS) {
+        return -1;
+    }
+
+    if (node->left != NULL &&
+        huffman_tree_preorder_to_table(node->left, table, code, length + 1) !=
+            0) {
+        return -1;
+    }
+    if (node->right != NULL &&
+        huffman_tree_preorder_to_table(
+            node->right, table, code | ((uint64_t)1 << length), length + 1) !=
+            0) {
+        return -1;
+    }
+    return 0;
+}
+
+HuffmanTable *huffman_table_new(const HuffmanTree *tree)
+{
+    HuffmanTable *table = (HuffmanTable *)malloc(sizeof(HuffmanTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    memset(table, 0, sizeof(HuffmanTable));
+
+    if (tree->root != NULL &&
+        huffman_tree_preorder_to_table(tree->root, table, 0, 0) != 0) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void huffman_table_free(HuffmanTable *table)
+{
+    free(table);
+}
+
+uint64_t huffman_table_encoded_bits(const HuffmanTable *table,
+                                    const char *string,
+                                    size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)string;
+    uint64_t bits = 0;
+    for (size_t i = 0; i < size; ++i) {
+        bits += table->lengths[bytes[i]];
+    }
+    return bits;
+}
+
+uint64_t huffman_table_encode_to(const HuffmanTable *table,
+                                 const char *string,
+                                 size_t size,
+                                 word_t *words)
+{
+    const unsigned char *bytes = (const unsigned char *)string;
+    word_t *out = words;
+    /** the pending bits, the next bit at bit `filled`. */
+    word_t buffer = 0;
+    unsigned int filled = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        word_t code = table->codes[bytes[i]];
+        unsigned int length = table->lengths[bytes[i]];
+
+        buffer |= code << filled;
+        filled += length;
+        if (filled >= BITS_PER_WORD) {
+            *out++ = buffer;
+            filled -= BITS_PER_WORD;
+            /** the bits of code which did not fit in the flushed word. */
+            buffer = filled > 0 ? code >> (length - filled) : 0;
+        }
+    }
+
+    uint64_t num_bits = (uint64_t)(out - words) * BITS_PER_WORD + filled;
+    if (filled > 0) {
+        *out = buffer;
+    }
+    return num_bits;
+}
+
+BitMap *huffman_encode_string(const HuffmanTree *tree,
+                              const char *string,
+                              unsigned int size)
+{
+    HuffmanTable *table = huffman_table_new(tree);
+    if (table == NULL) {
+        return huffman_encode_string_by_hash_table(tree, string, size);
+    }
+
+    uint64_t num_bits = huffman_table_encoded_bits(table, string, size);
+    if (num_bits > UINT_MAX) {
+        huffman_table_free(table);
+        return NULL;
+    }
+
+    BitMap *bitmap = bitmap_new((unsigned int)num_bits);
+    huffman_table_encode_to(table, string, size, bitmap->words);
+    huffman_table_free(table);
+    return bitmap;
+}
+
 BitMap *huffman_encode(const HuffmanTree *tree, const Text *text)
 {
     return huffman_encode_string(
         tree, text_char_string(text), text_length(text));
 }
 
-Text *huffman_decode(const HuffmanTree *tree, const BitMap *bitmap)
+static Text *huffman_decode_by_tree(const HuffmanTree *tree,
+                                    const BitMap *bitmap)
 {
     Text *text = text_new();
     HuffmanNode *node = tree->root;
@@ -241,6 +360,225 @@ Text *huffman_decode(const HuffmanTree *tree, const BitMap *bitmap)
     return text;
 }
 
+static unsigned int huffman_node_depth(const HuffmanNode *node)
+{
+    if (node == NULL || huffman_node_is_leave(node)) {
+        return 0;
+    }
+    unsigned int left = huffman_node_depth(node->left);
+    unsigned int right = huffman_node_depth(node->right);
+    return 1 + (left > right ? left : right);
+}
+
+static int huffman_decode_table_add(HuffmanDecodeTable *table,
+                                    const HuffmanNode *node,
+                                    unsigned int bits);
+
+/**
+ * Fill the entries of the codes passing node, at depth in the table at
+ * offset, code holding the bits of the path in the table.
+ */
+static int huffman_decode_table_fill(HuffmanDecodeTable *table,
+                                     unsigned int offset,
+                                     unsigned int bits,
+                                     const HuffmanNode *node,
+                                     unsigned int depth,
+                                     unsigned int code)
+{
+    if (node == NULL) {
+        return 0;
+    }
+
+    if (huffman_node_is_leave(node)) {
+        HuffmanDecodeEntry entry = {(unsigned char)node->value, depth, 0};
+        for (unsigned int i = 0; i < (1U << (bits - depth)); ++i) {
+            table->entries[offset + (code | (i << depth))] = entry;
+        }
+        return 0;
+    }
+
+    if (depth == bits) {
+        unsigned int sub_bits = huffman_node_depth(node);
+        if (sub_bits > HUFFMAN_DECODE_SUB_BITS) {
+            sub_bits = HUFFMAN_DECODE_SUB_BITS;
+        }
+        /** entries may move, take the sub table offset first. */
+        unsigned int sub_offset = table->num_entries;
+        if (huffman_decode_table_add(table, node, sub_bits) != 0) {
+            return -1;
+        }
+        HuffmanDecodeEntry entry = {sub_offset, bits, sub_bits};
+        table->entries[offset + code] = entry;
+        return 0;
+    }
+
+    if (huffman_decode_table_fill(
+            table, offset, bits, node->left, depth + 1, code) != 0) {
+        return -1;
+    }
+    return huffman_decode_table_fill(
+        table, offset, bits, node->right, depth + 1, code | (1U << depth));
+}
+
+/** Append a table of 1 << bits entries looking up the codes below node. */
+static int huffman_decode_table_add(HuffmanDecodeTable *table,
+                                    const HuffmanNode *node,
+                                    unsigned int bits)
+{
+    unsigned int offset = table->num_entries;
+    unsigned int num_entries = offset + (1U << bits);
+    HuffmanDecodeEntry *entries = (HuffmanDecodeEntry *)realloc(
+        table->entries, sizeof(HuffmanDecodeEntry) * num_entries);
+    if (entries == NULL) {
+        return -1;
+    }
+    memset(&(entries[offset]), 0, sizeof(HuffmanDecodeEntry) * (1U << bits));
+    table->entries = entries;
+    table->num_entries = num_entries;
+
+    return huffman_decode_table_fill(table, offset, bits, node, 0, 0);
+}
+
+HuffmanDecodeTable *huffman_decode_table_new(const HuffmanTree *tree)
+{
+    unsigned int depth = huffman_node_depth(tree->root);
+    if (depth > HUFFMAN_MAX_CODE_BITS) {
+        return NULL;
+    }
+
+    HuffmanDecodeTable *table =
+        (HuffmanDecodeTable *)malloc(sizeof(HuffmanDecodeTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->entries = NULL;
+    table->num_entries = 0;
+    table->root_bits =
+        depth < HUFFMAN_DECODE_ROOT_BITS ? depth : HUFFMAN_DECODE_ROOT_BITS;
+    table->max_length = depth;
+
+    /** a tree of a single leave has no code, its entry is left empty. */
+    if (huffman_decode_table_add(table, tree->root, table->root_bits) != 0) {
+        huffman_decode_table_free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void huffman_decode_table_free(HuffmanDecodeTable *table)
+{
+    free(table->entries);
+    free(table);
+}
+
+/** the 64 bits from bit n, bits past the last word read as 0. */
+static inline word_t
+huffman_peek_bits(const word_t *words, uint64_t num_words, uint64_t n)
+{
+    uint64_t index = WORD_OFFSET(n);
+    unsigned int offset = BIT_OFFSET(n);
+    word_t bits = words[index] >> offset;
+    if (offset > 0 && index + 1 < num_words) {
+        bits |= words[index + 1] << (BITS_PER_WORD - offset);
+    }
+    return bits;
+}
+
+size_t huffman_decode_to(const HuffmanDecodeTable *table,
+                         const word_t *words,
+                         uint64_t num_bits,
+                         uint64_t *position,
+                         char *output,
+                         size_t size)
+{
+    const HuffmanDecodeEntry *entries = table->entries;
+    word_t root_mask = ((word_t)1 << table->root_bits) - 1;
+    uint64_t num_words = (num_bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    uint64_t n = *position;
+    size_t count = 0;
+
+    /** the bits from n, several codes are decoded from one peek. */
+    word_t buffer = 0;
+    unsigned int available = 0;
+
+    while (count < size && n < num_bits) {
+        if (available < table->max_length) {
+            buffer = huffman_peek_bits(words, num_words, n);
+            available = BITS_PER_WORD;
+        }
+
+        word_t bits = buffer;
+        HuffmanDecodeEntry entry = entries[bits & root_mask];
+        unsigned int length = 0;
+        while (entry.sub_bits != 0) {
+            length += entry.length;
+            bits >>= entry.length;
+            entry = entries[entry.value +
+                            (bits & (((word_t)1 << entry.sub_bits) - 1))];
+        }
+        length += entry.length;
+
+        if (entry.length == 0 || n + length > num_bits) {
+            break;
+        }
+        output[count++] = (char)entry.value;
+        n += length;
+        available -= length;
+        buffer = length < BITS_PER_WORD ? buffer >> length : 0;
+    }
+
+    *position = n;
+    return count;
+}
+
+Text *huffman_decode(const HuffmanTree *tree, const BitMap *bitmap)
+{
+    HuffmanDecodeTable *table = huffman_decode_table_new(tree);
+    if (table == NULL) {
+        return huffman_decode_by_tree(tree, bitmap);
+    }
+
+    /** a guess of 4 bits per byte, grown if short. */
+    unsigned int allocated = bitmap->num_bits / 4 + 16;
+    char *data = (char *)malloc(allocated);
+    if (data == NULL) {
+        huffman_decode_table_free(table);
+        return NULL;
+    }
+    unsigned int length = 0;
+    uint64_t position = 0;
+
+    while (1) {
+        /** keep a byte for '\0'. */
+        size_t room = allocated - 1 - length;
+        size_t count = huffman_decode_to(table,
+                                         bitmap->words,
+                                         bitmap->num_bits,
+                                         &position,
+                                         data + length,
+                                         room);
+        length += count;
+        if (count < room) {
+            break;
+        }
+        allocated *= 2;
+        char *grown = (char *)realloc(data, allocated);
+        if (grown == NULL) {
+            free(data);
+            huffman_decode_table_free(table);
+            return NULL;
+        }
+        data = grown;
+    }
+
+    huffman_decode_table_free(table);
+    Text *text = text_from_buffer(data, length, allocated);
+    if (text == NULL) {
+        free(data);
+    }
+    return text;
+}
+
 static void huffman_tree_preorder_deflate(const HuffmanNode *node,
                                           BitMap *bitmap)
 {
@@ -327,3 +665,1304 @@ int huffman_tree_equal(const HuffmanTree *tree1, const HuffmanTree *tree2)
 {
     return huffman_tree_preorder_equal(tree1->root, tree2->root);
 }
+
+void huffman_count_weights(const char *string,
+                           size_t size,
+                           uint64_t weights[256])
+{
+    const unsigned char *bytes = (const unsigned char *)string;
+    memset(weights, 0, sizeof(uint64_t) * 256);
+    for (size_t i = 0; i < size; ++i) {
+        ++weights[bytes[i]];
+    }
+}
+
+/**
+ * An item of a package-merge list: a byte, or a package of the two items
+ * from index `left` of the list before.
+ */
+typedef struct _HuffmanPackage {
+    uint64_t weight;
+    int symbol;
+    int left;
+} HuffmanPackage;
+
+static int huffman_package_compare(const void *package1, const void *package2)
+{
+    const HuffmanPackage *p1 = (const HuffmanPackage *)package1;
+    const HuffmanPackage *p2 = (const HuffmanPackage *)package2;
+    if (p1->weight != p2->weight) {
+        return p1->weight < p2->weight ? -1 : 1;
+    }
+    return p1->symbol - p2->symbol;
+}
+
+/** Add one to the length of the bytes in an item of list level. */
+static void huffman_package_count(const HuffmanPackage *lists,
+                                  unsigned int list_size,
+                                  unsigned int level,
+                                  unsigned int index,
+                                  unsigned char lengths[256])
+{
+    const HuffmanPackage *package = &(lists[level * list_size + index]);
+    if (package->symbol >= 0) {
+        ++lengths[package->symbol];
+    } else {
+        huffman_package_count(
+            lists, list_size, level - 1, package->left, lengths);
+        huffman_package_count(
+            lists, list_size, level - 1, package->left + 1, lengths);
+    }
+}
+
+int huffman_code_lengths(const uint64_t weights[256],
+                         unsigned int max_length,
+                         unsigned char lengths[256])
+{
+    HuffmanPackage leaves[256];
+    unsigned int num_leaves = 0;
+    for (int i = 0; i < 256; ++i) {
+        if (weights[i] > 0) {
+            leaves[num_leaves].weight = weights[i];
+            leaves[num_leaves].symbol = i;
+            leaves[num_leaves].left = -1;
+            ++num_leaves;
+        }
+    }
+
+    memset(lengths, 0, 256);
+    if (max_length < 1 || max_length > HUFFMAN_MAX_CODE_BITS ||
+        (max_length < 8 && num_leaves > (1U << max_length))) {
+        return -1;
+    }
+    if (num_leaves <= 1) {
+        if (num_leaves == 1) {
+            lengths[leaves[0].symbol] = 1;
+        }
+        return 0;
+    }
+    qsort(leaves, num_leaves, sizeof(HuffmanPackage), huffman_package_compare);
+
+    /** a code is never longer than num_leaves - 1 bits. */
+    unsigned int num_levels =
+        max_length < num_leaves - 1 ? max_length : num_leaves - 1;
+    unsigned int list_size = 2 * num_leaves;
+    HuffmanPackage *lists = (HuffmanPackage *)malloc(
+        sizeof(HuffmanPackage) * list_size * num_levels);
+    if (lists == NULL) {
+        return -1;
+    }
+
+    /**
+     * level 0 holds the leaves; each next level merges the leaves with the
+     * packages of pairs of the level before.
+     */
+    memcpy(lists, leaves, sizeof(HuffmanPackage) * num_leaves);
+    unsigned int size = num_leaves;
+    for (unsigned int level = 1; level < num_levels; ++level) {
+        const HuffmanPackage *prev = &(lists[(level - 1) * list_size]);
+        HuffmanPackage *list = &(lists[level * list_size]);
+        unsigned int num_packages = size / 2;
+        unsigned int i = 0;
+        unsigned int j = 0;
+        size = 0;
+        while (i < num_leaves || j < num_packages) {
+            uint64_t weight = j < num_packages
+                                  ? prev[2 * j].weight + prev[2 * j + 1].weight
+                                  : 0;
+            if (j >= num_packages ||
+                (i < num_leaves && leaves[i].weight <= weight)) {
+                list[size++] = leaves[i++];
+            } else {
+                list[size].weight = weight;
+                list[size].symbol = -1;
+                list[size].left = 2 * j;
+                ++size;
+                ++j;
+            }
+        }
+    }
+
+    /** the first 2n - 2 items of the last level are the code. */
+    for (unsigned int i = 0; i < 2 * num_leaves - 2; ++i) {
+        huffman_package_count(lists, list_size, num_levels - 1, i, lengths);
+    }
+
+    free(lists);
+    return 0;
+}
+
+static int huffman_node_to_lengths(const HuffmanNode *node,
+                                   unsigned int depth,
+                                   unsigned char lengths[256])
+{
+    if (node == NULL) {
+        return 0;
+    }
+    if (huffman_node_is_leave(node)) {
+        lengths[(unsigned char)node->value] = depth;
+        return 0;
+    }
+    if (depth >= HUFFMAN_MAX_CODE_BITS) {
+        return -1;
+    }
+    if (huffman_node_to_lengths(node->left, depth + 1, lengths) != 0) {
+        return -1;
+    }
+    return huffman_node_to_lengths(node->right, depth + 1, lengths);
+}
+
+int huffman_tree_to_lengths(const HuffmanTree *tree, unsigned char lengths[256])
+{
+    memset(lengths, 0, 256);
+    if (tree->root != NULL && huffman_node_is_leave(tree->root)) {
+        lengths[(unsigned char)tree->root->value] = 1;
+        return 0;
+    }
+    return huffman_node_to_lengths(tree->root, 0, lengths);
+}
+
+/**
+ * Generate the canonical codes of lengths, the first bit the highest bit.
+ * Return -1 if the lengths are not a prefix code.
+ */
+static int huffman_canonical_codes(const unsigned char lengths[256],
+                                   uint64_t codes[256])
+{
+    unsigned int counts[HUFFMAN_MAX_CODE_BITS + 1] = {0};
+    for (int i = 0; i < 256; ++i) {
+        if (lengths[i] > HUFFMAN_MAX_CODE_BITS) {
+            return -1;
+        }
+        ++counts[lengths[i]];
+    }
+
+    /** the codes left of each length (Kraft), 512 is as good as more. */
+    uint64_t left = 1;
+    uint64_t next_codes[HUFFMAN_MAX_CODE_BITS + 1];
+    uint64_t code = 0;
+    counts[0] = 0;
+    for (unsigned int length = 1; length <= HUFFMAN_MAX_CODE_BITS; ++length) {
+        left = left < 512 ? left << 1 : left;
+        if (left < counts[length]) {
+            return -1;
+        }
+        left -= counts[length];
+        code = (code + counts[length - 1]) << 1;
+        next_codes[length] = code;
+    }
+
+    for (int i = 0; i < 256; ++i) {
+        codes[i] = lengths[i] > 0 ? next_codes[lengths[i]]++ : 0;
+    }
+    return 0;
+}
+
+HuffmanTree *huffman_tree_from_lengths(const unsigned char lengths[256])
+{
+    uint64_t codes[256];
+    if (huffman_canonical_codes(lengths, codes) != 0) {
+        return NULL;
+    }
+
+    HuffmanTree *tree = huffman_tree_new();
+    tree->root = NULL;
+    for (int i = 0; i < 256; ++i) {
+        if (lengths[i] == 0) {
+            continue;
+        }
+        if (tree->root == NULL) {
+            tree->root = huffman_node_new('\0', 0);
+        }
+        HuffmanNode *node = tree->root;
+        for (int bit = lengths[i] - 1; bit >= 0; --bit) {
+            HuffmanNode **child =
+                (codes[i] >> bit) & 1 ? &(node->right) : &(node->left);
+            if (*child == NULL) {
+                *child = huffman_node_new('\0', 0);
+            }
+            node = *child;
+        }
+        node->value = (char)i;
+    }
+    return tree;
+}
+
+HuffmanTable *huffman_table_from_lengths(const unsigned char lengths[256])
+{
+    uint64_t codes[256];
+    if (huffman_canonical_codes(lengths, codes) != 0) {
+        return NULL;
+    }
+
+    HuffmanTable *table = (HuffmanTable *)malloc(sizeof(HuffmanTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    /** reverse the bits, the first bit goes to bit 0. */
+    for (int i = 0; i < 256; ++i) {
+        uint64_t code = 0;
+        for (unsigned int bit = 0; bit < lengths[i]; ++bit) {
+            code = (code << 1) | ((codes[i] >> bit) & 1);
+        }
+        table->codes[i] = code;
+        table->lengths[i] = lengths[i];
+    }
+    return table;
+}
+
+HuffmanDecodeTable *
+huffman_decode_table_from_lengths(const unsigned char lengths[256])
+{
+    HuffmanTree *tree = huffman_tree_from_lengths(lengths);
+    if (tree == NULL) {
+        return NULL;
+    }
+    HuffmanDecodeTable *table = huffman_decode_table_new(tree);
+    huffman_tree_free(tree);
+    return table;
+}
+
+BitMap *huffman_lengths_deflate(const unsigned char lengths[256])
+{
+    BitMap *bitmap = bitmap_new(0);
+    int i = 0;
+    while (i < 256) {
+        if (lengths[i] > 0) {
+            /** 1, then the length - 1 in 6 bits. */
+            bitmap_append_bits(bitmap, 1 | ((word_t)(lengths[i] - 1) << 1), 7);
+            ++i;
+        } else {
+            /** 0, then the run of no code - 1 in 8 bits. */
+            int run = 1;
+            while (i + run < 256 && lengths[i + run] == 0) {
+                ++run;
+            }
+            bitmap_append_bits(bitmap, (word_t)(run - 1) << 1, 9);
+            i += run;
+        }
+    }
+    return bitmap;
+}
+
+int huffman_lengths_inflate(const BitMap *bitmap,
+                            unsigned int *index,
+                            unsigned char lengths[256])
+{
+    unsigned int n = *index;
+    int i = 0;
+    while (i < 256) {
+        if (n >= bitmap->num_bits) {
+            return -1;
+        }
+        if (bitmap_get(bitmap, n)) {
+            if (n + 7 > bitmap->num_bits) {
+                return -1;
+            }
+            lengths[i++] = 1 + bitmap_extract_bits(bitmap, n + 1, 6);
+            n += 7;
+        } else {
+            if (n + 9 > bitmap->num_bits) {
+                return -1;
+            }
+            unsigned int run = 1 + bitmap_extract_bits(bitmap, n + 1, 8);
+            if (i + run > 256) {
+                return -1;
+            }
+            memset(&(lengths[i]), 0, run);
+            i += run;
+            n += 9;
+        }
+    }
+    *index = n;
+    return 0;
+}
+
+/** "RHF1" in little-endian. */
+#define HUFFMAN_STREAM_MAGIC 0x31464852u
+
+/** "RHF2" in little-endian, a stream of LZ77 blocks. */
+#define HUFFMAN_LZ77_STREAM_MAGIC 0x32464852u
+
+static inline unsigned char *put_uint32(unsigned char *buffer, uint32_t value)
+{
+    buffer[0] = (unsigned char)value;
+    buffer[1] = (unsigned char)(value >> 8);
+    buffer[2] = (unsigned char)(value >> 16);
+    buffer[3] = (unsigned char)(value >> 24);
+    return buffer + 4;
+}
+
+static inline uint32_t get_uint32(const unsigned char *buffer)
+{
+    return buffer[0] | ((uint32_t)buffer[1] << 8) |
+           ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+/** write size bytes of words, little-endian. */
+static void huffman_put_words(unsigned char *buffer,
+                              const word_t *words,
+                              size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        buffer[i] = (unsigned char)(words[i / sizeof(word_t)] >>
+                                    (i % sizeof(word_t) * CHAR_BIT));
+    }
+}
+
+/** read size bytes to words, little-endian, the last word padded by 0. */
+static void huffman_get_words(word_t *words,
+                              const unsigned char *buffer,
+                              size_t size)
+{
+    size_t num_words = (size + sizeof(word_t) - 1) / sizeof(word_t);
+    memset(words, 0, sizeof(word_t) * num_words);
+    for (size_t i = 0; i < size; ++i) {
+        words[i / sizeof(word_t)] |= (word_t)buffer[i]
+                                     << (i % sizeof(word_t) * CHAR_BIT);
+    }
+}
+
+static inline uint32_t huffman_checksum(const char *data, size_t size)
+{
+    return (uint32_t)hash_bytes64(data, size, 0);
+}
+
+size_t huffman_block_bound(size_t size)
+{
+    /** the raw bytes are stored if the codes are not smaller. */
+    return HUFFMAN_BLOCK_HEADER_SIZE + size;
+}
+
+size_t huffman_block_encode(const char *data, size_t size, unsigned char *output)
+{
+    uint64_t weights[256];
+    unsigned char lengths[256];
+    huffman_count_weights(data, size, weights);
+    if (huffman_code_lengths(weights, HUFFMAN_BLOCK_CODE_BITS, lengths) != 0) {
+        return 0;
+    }
+
+    HuffmanTable *table = huffman_table_from_lengths(lengths);
+    BitMap *header = huffman_lengths_deflate(lengths);
+    if (table == NULL || header == NULL) {
+        if (table != NULL) {
+            huffman_table_free(table);
+        }
+        if (header != NULL) {
+            bitmap_free(header);
+        }
+        return 0;
+    }
+
+    /** the lengths take whole words, the codes start at a word. */
+    size_t header_words =
+        (header->num_bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    uint64_t code_bits = huffman_table_encoded_bits(table, data, size);
+    size_t payload_size =
+        header_words * sizeof(word_t) + (code_bits + CHAR_BIT - 1) / CHAR_BIT;
+
+    unsigned char *p = put_uint32(output, (uint32_t)size);
+    if (payload_size >= size) {
+        p = put_uint32(p, (uint32_t)size);
+        p = put_uint32(p, huffman_checksum(data, size));
+        memcpy(p, data, size);
+        payload_size = size;
+    } else {
+        size_t num_words =
+            header_words + (code_bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+        word_t *words = (word_t *)malloc(sizeof(word_t) * num_words);
+        if (words == NULL) {
+            huffman_table_free(table);
+            bitmap_free(header);
+            return 0;
+        }
+        memcpy(words, header->words, sizeof(word_t) * header_words);
+        huffman_table_encode_to(table, data, size, words + header_words);
+
+        p = put_uint32(p, (uint32_t)payload_size);
+        p = put_uint32(p, huffman_checksum(data, size));
+        huffman_put_words(p, words, payload_size);
+        free(words);
+    }
+
+    huffman_table_free(table);
+    bitmap_free(header);
+    return HUFFMAN_BLOCK_HEADER_SIZE + payload_size;
+}
+
+int huffman_block_peek(const unsigned char *block,
+                       size_t size,
+                       size_t *raw_size,
+                       size_t *block_size)
+{
+    if (size < HUFFMAN_BLOCK_HEADER_SIZE) {
+        return -1;
+    }
+    *raw_size = get_uint32(block);
+    *block_size = HUFFMAN_BLOCK_HEADER_SIZE + (size_t)get_uint32(block + 4);
+    return 0;
+}
+
+int huffman_block_decode(const unsigned char *block,
+                         size_t block_size,
+                         char *output)
+{
+    size_t raw_size;
+    size_t size;
+    if (huffman_block_peek(block, block_size, &raw_size, &size) != 0 ||
+        size != block_size || size - HUFFMAN_BLOCK_HEADER_SIZE > raw_size) {
+        return -1;
+    }
+    uint32_t checksum = get_uint32(block + 8);
+    const unsigned char *payload = block + HUFFMAN_BLOCK_HEADER_SIZE;
+    size_t payload_size = block_size - HUFFMAN_BLOCK_HEADER_SIZE;
+
+    if (payload_size == raw_size) {
+        memcpy(output, payload, raw_size);
+        return huffman_checksum(output, raw_size) == checksum ? 0 : -1;
+    }
+
+    BitMap *bitmap = bitmap_new(payload_size * CHAR_BIT);
+    huffman_get_words(bitmap->words, payload, payload_size);
+
+    int result = -1;
+    unsigned char lengths[256];
+    unsigned int index = 0;
+    if (huffman_lengths_inflate(bitmap, &index, lengths) == 0) {
+        HuffmanDecodeTable *table = huffman_decode_table_from_lengths(lengths);
+        if (table != NULL) {
+            size_t header_words = (index + BITS_PER_WORD - 1) / BITS_PER_WORD;
+            uint64_t position = 0;
+            if (header_words < bitmap->num_words &&
+                huffman_decode_to(table,
+                                  bitmap->words + header_words,
+                                  (uint64_t)bitmap->num_bits -
+                                      header_words * BITS_PER_WORD,
+                                  &position,
+                                  output,
+                                  raw_size) == raw_size &&
+                huffman_checksum(output, raw_size) == checksum) {
+                result = 0;
+            }
+            huffman_decode_table_free(table);
+        }
+    }
+
+    bitmap_free(bitmap);
+    return result;
+}
+
+/** "RHFI" in little-endian, ends the block index. */
+#define HUFFMAN_INDEX_MAGIC 0x49464852u
+
+/** The size of an index entry: block size and raw size. */
+#define HUFFMAN_INDEX_ENTRY_SIZE 8
+
+/** The blocks a thread codes at once, to even out their times. */
+#define HUFFMAN_BLOCKS_PER_THREAD 2
+
+/**
+ * Blocks encoded or decoded together by the worker threads: each thread
+ * claims the next block until none is left.
+ */
+typedef struct _HuffmanBatch {
+    /** encode: raw bytes to blocks; decode: blocks to raw bytes. */
+    int decode;
+    /** LZ77 blocks, by params if encode. */
+    int lz77;
+    Lz77Params params;
+    const void **inputs;
+    size_t *input_sizes;
+    void **outputs;
+    /** encode: the size of each block. */
+    size_t *output_sizes;
+    size_t num_jobs;
+    atomic_size_t next_job;
+    atomic_int failed;
+} HuffmanBatch;
+
+static inline int huffman_stream_block_decode(int lz77,
+                                              const unsigned char *block,
+                                              size_t block_size,
+                                              char *output)
+{
+    return lz77 ? lz77_block_decode(block, block_size, output)
+                : huffman_block_decode(block, block_size, output);
+}
+
+static void *huffman_batch_worker(void *args)
+{
+    HuffmanBatch *batch = (HuffmanBatch *)args;
+    while (1) {
+        size_t i = atomic_fetch_add(&(batch->next_job), 1);
+        if (i >= batch->num_jobs) {
+            break;
+        }
+        if (batch->decode) {
+            if (huffman_stream_block_decode(
+                    batch->lz77,
+                    (const unsigned char *)batch->inputs[i],
+                    batch->input_sizes[i],
+                    (char *)batch->outputs[i]) != 0) {
+                atomic_store(&(batch->failed), 1);
+            }
+        } else if (batch->lz77) {
+            batch->output_sizes[i] =
+                lz77_block_encode((const char *)batch->inputs[i],
+                                  batch->input_sizes[i],
+                                  &(batch->params),
+                                  (unsigned char *)batch->outputs[i]);
+            if (batch->output_sizes[i] == 0) {
+                atomic_store(&(batch->failed), 1);
+            }
+        } else {
+            batch->output_sizes[i] =
+                huffman_block_encode((const char *)batch->inputs[i],
+                                     batch->input_sizes[i],
+                                     (unsigned char *)batch->outputs[i]);
+            if (batch->output_sizes[i] == 0) {
+                atomic_store(&(batch->failed), 1);
+            }
+        }
+    }
+    return NULL;
+}
+
+/** run the jobs of a batch on up to num_threads threads. */
+static int huffman_batch_run(HuffmanBatch *batch, unsigned int num_threads)
+{
+    atomic_init(&(batch->next_job), 0);
+    atomic_init(&(batch->failed), 0);
+    if (num_threads > batch->num_jobs) {
+        num_threads = (unsigned int)batch->num_jobs;
+    }
+
+    if (num_threads <= 1) {
+        huffman_batch_worker(batch);
+    } else {
+        pthread_t threads[HUFFMAN_MAX_THREADS];
+        unsigned int started = 0;
+        for (; started < num_threads; ++started) {
+            if (pthread_create(
+                    &threads[started], NULL, huffman_batch_worker, batch) !=
+                0) {
+                break;
+            }
+        }
+        /** the calling thread alone if no thread could start. */
+        if (started == 0) {
+            huffman_batch_worker(batch);
+        }
+        for (unsigned int t = 0; t < started; ++t) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    return atomic_load(&(batch->failed)) ? -1 : 0;
+}
+
+static unsigned int huffman_batch_blocks(unsigned int num_threads)
+{
+    return num_threads <= 1 ? 1 : num_threads * HUFFMAN_BLOCKS_PER_THREAD;
+}
+
+struct _HuffmanEncoder {
+    HuffmanWriteFunc write;
+    void *args;
+    size_t block_size;
+    /** LZ77 blocks, by params. */
+    int lz77;
+    Lz77Params params;
+    unsigned int num_threads;
+    /** The blocks encoded at once. */
+    unsigned int batch_blocks;
+    /** The raw bytes of the blocks being filled. */
+    char *input;
+    size_t input_size;
+    /** The encoded blocks, huffman_block_bound(block_size) bytes each. */
+    unsigned char *output;
+    int started;
+    /** The block index: block size and raw size of each block. */
+    uint32_t *index;
+    size_t num_blocks;
+    size_t index_capacity;
+};
+
+HuffmanEncoder *
+huffman_encoder_new(size_t block_size, HuffmanWriteFunc write, void *args)
+{
+    return huffman_encoder_new_threads(block_size, 1, write, args);
+}
+
+HuffmanEncoder *huffman_encoder_new_threads(size_t block_size,
+                                            unsigned int num_threads,
+                                            HuffmanWriteFunc write,
+                                            void *args)
+{
+    return huffman_encoder_new_level(block_size, 0, num_threads, write, args);
+}
+
+HuffmanEncoder *huffman_encoder_new_level(size_t block_size,
+                                          int level,
+                                          unsigned int num_threads,
+                                          HuffmanWriteFunc write,
+                                          void *args)
+{
+    Lz77Params params;
+    lz77_params_from_level(level, &params);
+    return huffman_encoder_new_lz77(
+        block_size, level > 0 ? &params : NULL, num_threads, write, args);
+}
+
+HuffmanEncoder *huffman_encoder_new_lz77(size_t block_size,
+                                         const Lz77Params *params,
+                                         unsigned int num_threads,
+                                         HuffmanWriteFunc write,
+                                         void *args)
+{
+    if (block_size == 0) {
+        block_size = HUFFMAN_BLOCK_SIZE;
+    }
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (block_size > HUFFMAN_BLOCK_MAX_SIZE ||
+        num_threads > HUFFMAN_MAX_THREADS) {
+        return NULL;
+    }
+    if (params != NULL &&
+        (params->window_bits == 0 ||
+         params->window_bits > LZ77_MAX_WINDOW_BITS ||
+         params->max_chain == 0)) {
+        return NULL;
+    }
+
+    HuffmanEncoder *encoder = (HuffmanEncoder *)malloc(sizeof(HuffmanEncoder));
+    if (encoder == NULL) {
+        return NULL;
+    }
+    encoder->write = write;
+    encoder->args = args;
+    encoder->block_size = block_size;
+    encoder->lz77 = params != NULL;
+    if (params != NULL) {
+        encoder->params = *params;
+    }
+    encoder->num_threads = num_threads;
+    encoder->batch_blocks = huffman_batch_blocks(num_threads);
+    encoder->input = (char *)malloc(block_size * encoder->batch_blocks);
+    encoder->input_size = 0;
+    encoder->output = (unsigned char *)malloc(huffman_block_bound(block_size) *
+                                              encoder->batch_blocks);
+    encoder->started = 0;
+    encoder->index = NULL;
+    encoder->num_blocks = 0;
+    encoder->index_capacity = 0;
+    if (encoder->input == NULL || encoder->output == NULL) {
+        huffman_encoder_free(encoder);
+        return NULL;
+    }
+    return encoder;
+}
+
+void huffman_encoder_free(HuffmanEncoder *encoder)
+{
+    free(encoder->input);
+    free(encoder->output);
+    free(encoder->index);
+    free(encoder);
+}
+
+static int huffman_encoder_start(HuffmanEncoder *encoder)
+{
+    if (encoder->started) {
+        return 0;
+    }
+    unsigned char header[HUFFMAN_STREAM_HEADER_SIZE];
+    unsigned char *p = put_uint32(
+        header,
+        encoder->lz77 ? HUFFMAN_LZ77_STREAM_MAGIC : HUFFMAN_STREAM_MAGIC);
+    put_uint32(p, (uint32_t)encoder->block_size);
+    encoder->started = 1;
+    return encoder->write(header, HUFFMAN_STREAM_HEADER_SIZE, encoder->args) ==
+                   0
+               ? 0
+               : -1;
+}
+
+/** encode size bytes of data, block by block, and write the blocks. */
+static int
+huffman_encoder_blocks(HuffmanEncoder *encoder, const char *data, size_t size)
+{
+    const void *inputs[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    size_t input_sizes[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    void *outputs[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    size_t output_sizes[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    HuffmanBatch batch;
+    batch.decode = 0;
+    batch.lz77 = encoder->lz77;
+    batch.params = encoder->params;
+    batch.inputs = inputs;
+    batch.input_sizes = input_sizes;
+    batch.outputs = outputs;
+    batch.output_sizes = output_sizes;
+    batch.num_jobs = 0;
+    while (size > 0) {
+        size_t count = size < encoder->block_size ? size : encoder->block_size;
+        inputs[batch.num_jobs] = data;
+        input_sizes[batch.num_jobs] = count;
+        outputs[batch.num_jobs] =
+            encoder->output +
+            huffman_block_bound(encoder->block_size) * batch.num_jobs;
+        ++batch.num_jobs;
+        data += count;
+        size -= count;
+    }
+
+    if (encoder->num_blocks + batch.num_jobs > encoder->index_capacity) {
+        size_t capacity = encoder->index_capacity == 0
+                              ? 64
+                              : encoder->index_capacity * 2;
+        while (capacity < encoder->num_blocks + batch.num_jobs) {
+            capacity *= 2;
+        }
+        uint32_t *index = (uint32_t *)realloc(
+            encoder->index, sizeof(uint32_t) * 2 * capacity);
+        if (index == NULL) {
+            return -1;
+        }
+        encoder->index = index;
+        encoder->index_capacity = capacity;
+    }
+
+    if (huffman_batch_run(&batch, encoder->num_threads) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < batch.num_jobs; ++i) {
+        if (encoder->write(outputs[i], output_sizes[i], encoder->args) != 0) {
+            return -1;
+        }
+        encoder->index[2 * encoder->num_blocks] = (uint32_t)output_sizes[i];
+        encoder->index[2 * encoder->num_blocks + 1] = (uint32_t)input_sizes[i];
+        ++encoder->num_blocks;
+    }
+    return 0;
+}
+
+int huffman_encoder_write(HuffmanEncoder *encoder,
+                          const char *data,
+                          size_t size)
+{
+    if (huffman_encoder_start(encoder) != 0) {
+        return -1;
+    }
+
+    size_t batch_size = encoder->block_size * encoder->batch_blocks;
+    while (size > 0) {
+        /** whole batches of data are encoded in place. */
+        if (encoder->input_size == 0 && size >= batch_size) {
+            if (huffman_encoder_blocks(encoder, data, batch_size) != 0) {
+                return -1;
+            }
+            data += batch_size;
+            size -= batch_size;
+            continue;
+        }
+
+        size_t count = batch_size - encoder->input_size;
+        if (count > size) {
+            count = size;
+        }
+        memcpy(encoder->input + encoder->input_size, data, count);
+        encoder->input_size += count;
+        data += count;
+        size -= count;
+
+        if (encoder->input_size == batch_size) {
+            if (huffman_encoder_blocks(
+                    encoder, encoder->input, encoder->input_size) != 0) {
+                return -1;
+            }
+            encoder->input_size = 0;
+        }
+    }
+    return 0;
+}
+
+int huffman_encoder_finish(HuffmanEncoder *encoder)
+{
+    if (huffman_encoder_start(encoder) != 0) {
+        return -1;
+    }
+    if (encoder->input_size > 0) {
+        if (huffman_encoder_blocks(
+                encoder, encoder->input, encoder->input_size) != 0) {
+            return -1;
+        }
+        encoder->input_size = 0;
+    }
+
+    /** the end block, its payload the block index. */
+    size_t payload_size =
+        encoder->num_blocks * HUFFMAN_INDEX_ENTRY_SIZE + 2 * sizeof(uint32_t);
+    unsigned char *end =
+        (unsigned char *)malloc(HUFFMAN_BLOCK_HEADER_SIZE + payload_size);
+    if (end == NULL) {
+        return -1;
+    }
+    unsigned char *p = put_uint32(end, 0);
+    p = put_uint32(p, (uint32_t)payload_size);
+    p = put_uint32(p, 0);
+    for (size_t i = 0; i < 2 * encoder->num_blocks; ++i) {
+        p = put_uint32(p, encoder->index[i]);
+    }
+    p = put_uint32(p, (uint32_t)encoder->num_blocks);
+    p = put_uint32(p, HUFFMAN_INDEX_MAGIC);
+    put_uint32(end + 8,
+               huffman_checksum((const char *)end + HUFFMAN_BLOCK_HEADER_SIZE,
+                                payload_size));
+
+    int result = encoder->write(end,
+                                HUFFMAN_BLOCK_HEADER_SIZE + payload_size,
+                                encoder->args) == 0
+                     ? 0
+                     : -1;
+    free(end);
+    return result;
+}
+
+enum {
+    HUFFMAN_DECODER_HEADER,
+    HUFFMAN_DECODER_BLOCKS,
+    HUFFMAN_DECODER_END,
+    HUFFMAN_DECODER_ERROR
+};
+
+struct _HuffmanDecoder {
+    HuffmanWriteFunc write;
+    void *args;
+    int state;
+    /** LZ77 blocks, from the stream header. */
+    int lz77;
+    unsigned int num_threads;
+    unsigned int batch_blocks;
+    /** The raw size of a block, from the stream header. */
+    size_t block_size;
+    /**
+     * The blocks received whole, then the header or block being received.
+     * huffman_block_bound(block_size) bytes for each block of a batch.
+     */
+    unsigned char *input;
+    size_t input_size;
+    /** The blocks received whole. */
+    size_t num_pending;
+    size_t pending_sizes[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    /** The payload of the end block left to skip. */
+    size_t skip;
+    /** The raw bytes of the blocks of a batch. */
+    char *output;
+};
+
+HuffmanDecoder *huffman_decoder_new(HuffmanWriteFunc write, void *args)
+{
+    return huffman_decoder_new_threads(1, write, args);
+}
+
+HuffmanDecoder *huffman_decoder_new_threads(unsigned int num_threads,
+                                            HuffmanWriteFunc write,
+                                            void *args)
+{
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads > HUFFMAN_MAX_THREADS) {
+        return NULL;
+    }
+
+    HuffmanDecoder *decoder = (HuffmanDecoder *)malloc(sizeof(HuffmanDecoder));
+    if (decoder == NULL) {
+        return NULL;
+    }
+    decoder->write = write;
+    decoder->args = args;
+    decoder->state = HUFFMAN_DECODER_HEADER;
+    decoder->lz77 = 0;
+    decoder->num_threads = num_threads;
+    decoder->batch_blocks = huffman_batch_blocks(num_threads);
+    decoder->block_size = 0;
+    decoder->input = (unsigned char *)malloc(HUFFMAN_BLOCK_HEADER_SIZE);
+    decoder->input_size = 0;
+    decoder->num_pending = 0;
+    decoder->skip = 0;
+    decoder->output = NULL;
+    if (decoder->input == NULL) {
+        free(decoder);
+        return NULL;
+    }
+    return decoder;
+}
+
+void huffman_decoder_free(HuffmanDecoder *decoder)
+{
+    free(decoder->input);
+    free(decoder->output);
+    free(decoder);
+}
+
+/** decode and write the blocks received whole. */
+static int huffman_decoder_flush(HuffmanDecoder *decoder)
+{
+    if (decoder->num_pending == 0) {
+        return 0;
+    }
+
+    const void *inputs[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    void *outputs[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    size_t raw_sizes[HUFFMAN_MAX_THREADS * HUFFMAN_BLOCKS_PER_THREAD];
+    HuffmanBatch batch;
+    batch.decode = 1;
+    batch.lz77 = decoder->lz77;
+    batch.inputs = inputs;
+    batch.input_sizes = decoder->pending_sizes;
+    batch.outputs = outputs;
+    batch.output_sizes = NULL;
+    batch.num_jobs = decoder->num_pending;
+    size_t bound = huffman_block_bound(decoder->block_size);
+    for (size_t i = 0; i < batch.num_jobs; ++i) {
+        inputs[i] = decoder->input + bound * i;
+        outputs[i] = decoder->output + decoder->block_size * i;
+        raw_sizes[i] = get_uint32(decoder->input + bound * i);
+    }
+
+    decoder->num_pending = 0;
+    if (huffman_batch_run(&batch, decoder->num_threads) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < batch.num_jobs; ++i) {
+        if (decoder->write(outputs[i], raw_sizes[i], decoder->args) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/** the bytes needed for the header or the block being received. */
+static int huffman_decoder_need(HuffmanDecoder *decoder,
+                                const unsigned char *block,
+                                size_t size,
+                                size_t *need)
+{
+    if (decoder->state == HUFFMAN_DECODER_HEADER) {
+        *need = HUFFMAN_STREAM_HEADER_SIZE;
+        return 0;
+    }
+    size_t raw_size;
+    if (huffman_block_peek(block, size, &raw_size, need) != 0) {
+        *need = HUFFMAN_BLOCK_HEADER_SIZE;
+        return 0;
+    }
+    /** the end block is received as a header, its index is skipped. */
+    if (raw_size == 0) {
+        *need = HUFFMAN_BLOCK_HEADER_SIZE;
+        return 0;
+    }
+    /** the payload is never larger than the raw bytes. */
+    if (raw_size > decoder->block_size ||
+        *need - HUFFMAN_BLOCK_HEADER_SIZE > raw_size) {
+        return -1;
+    }
+    return 0;
+}
+
+/** handle a whole header or block, at the end of input. */
+static int huffman_decoder_process(HuffmanDecoder *decoder,
+                                   const unsigned char *block,
+                                   size_t size)
+{
+    if (decoder->state == HUFFMAN_DECODER_HEADER) {
+        uint32_t magic = get_uint32(block);
+        size_t block_size = get_uint32(block + 4);
+        if ((magic != HUFFMAN_STREAM_MAGIC &&
+             magic != HUFFMAN_LZ77_STREAM_MAGIC) ||
+            block_size == 0 || block_size > HUFFMAN_BLOCK_MAX_SIZE) {
+            return -1;
+        }
+        decoder->lz77 = magic == HUFFMAN_LZ77_STREAM_MAGIC;
+        size_t bound = huffman_block_bound(block_size);
+        unsigned char *input = (unsigned char *)realloc(
+            decoder->input, bound * decoder->batch_blocks);
+        if (input == NULL) {
+            return -1;
+        }
+        decoder->input = input;
+        decoder->output = (char *)malloc(block_size * decoder->batch_blocks);
+        if (decoder->output == NULL) {
+            return -1;
+        }
+        decoder->block_size = block_size;
+        decoder->state = HUFFMAN_DECODER_BLOCKS;
+        decoder->input_size = 0;
+        return 0;
+    }
+
+    size_t raw_size = get_uint32(block);
+    if (raw_size == 0) {
+        decoder->state = HUFFMAN_DECODER_END;
+        decoder->skip = get_uint32(block + 4);
+        decoder->input_size = 0;
+        return huffman_decoder_flush(decoder);
+    }
+
+    decoder->pending_sizes[decoder->num_pending++] = size;
+    decoder->input_size = 0;
+    if (decoder->num_pending == decoder->batch_blocks) {
+        return huffman_decoder_flush(decoder);
+    }
+    return 0;
+}
+
+int huffman_decoder_write(HuffmanDecoder *decoder,
+                          const unsigned char *data,
+                          size_t size)
+{
+    while (size > 0 && decoder->state != HUFFMAN_DECODER_ERROR) {
+        if (decoder->state == HUFFMAN_DECODER_END) {
+            if (decoder->skip == 0) {
+                decoder->state = HUFFMAN_DECODER_ERROR;
+                break;
+            }
+            size_t count = size < decoder->skip ? size : decoder->skip;
+            decoder->skip -= count;
+            data += count;
+            size -= count;
+            continue;
+        }
+
+        /** the block being received goes after the pending blocks. */
+        unsigned char *input =
+            decoder->input +
+            huffman_block_bound(decoder->block_size) * decoder->num_pending;
+        size_t need;
+        if (huffman_decoder_need(
+                decoder, input, decoder->input_size, &need) != 0) {
+            decoder->state = HUFFMAN_DECODER_ERROR;
+            break;
+        }
+
+        /** a whole block in data is decoded in place, without threads. */
+        if (decoder->input_size == 0 && decoder->batch_blocks == 1 &&
+            decoder->state == HUFFMAN_DECODER_BLOCKS) {
+            size_t raw_size;
+            if (huffman_decoder_need(decoder, data, size, &need) != 0) {
+                decoder->state = HUFFMAN_DECODER_ERROR;
+                break;
+            }
+            if (need <= size && need > HUFFMAN_BLOCK_HEADER_SIZE) {
+                huffman_block_peek(data, size, &raw_size, &need);
+                if (huffman_stream_block_decode(
+                        decoder->lz77, data, need, decoder->output) != 0 ||
+                    decoder->write(decoder->output, raw_size, decoder->args) !=
+                        0) {
+                    decoder->state = HUFFMAN_DECODER_ERROR;
+                    break;
+                }
+                data += need;
+                size -= need;
+                continue;
+            }
+            need = HUFFMAN_BLOCK_HEADER_SIZE;
+        }
+
+        size_t count = need - decoder->input_size;
+        if (count > size) {
+            count = size;
+        }
+        memcpy(input + decoder->input_size, data, count);
+        decoder->input_size += count;
+        data += count;
+        size -= count;
+
+        /** a block header may tell more bytes are needed. */
+        if (huffman_decoder_need(
+                decoder, input, decoder->input_size, &need) != 0) {
+            decoder->state = HUFFMAN_DECODER_ERROR;
+            break;
+        }
+        if (decoder->input_size == need) {
+            if (huffman_decoder_process(
+                    decoder, input, decoder->input_size) != 0) {
+                decoder->state = HUFFMAN_DECODER_ERROR;
+                break;
+            }
+        }
+    }
+    return decoder->state == HUFFMAN_DECODER_ERROR ? -1 : 0;
+}
+
+int huffman_decoder_finish(HuffmanDecoder *decoder)
+{
+    /** the blocks received whole are written even if the end is missing. */
+    if (decoder->state == HUFFMAN_DECODER_BLOCKS &&
+        huffman_decoder_flush(decoder) != 0) {
+        decoder->state = HUFFMAN_DECODER_ERROR;
+    }
+    return decoder->state == HUFFMAN_DECODER_END && decoder->skip == 0 ? 0
+                                                                       : -1;
+}
+
+/**
+ * Find the blocks of a stream in memory: from the index if there is one,
+ * otherwise from the block headers. offsets and raw_offsets are
+ * malloc'ed, num_blocks + 1 each.
+ */
+static int huffman_stream_blocks(const unsigned char *stream,
+                                 size_t size,
+                                 int *lz77,
+                                 size_t *num_blocks,
+                                 uint64_t **offsets,
+                                 uint64_t **raw_offsets)
+{
+    if (size < HUFFMAN_STREAM_HEADER_SIZE + HUFFMAN_BLOCK_HEADER_SIZE ||
+        (get_uint32(stream) != HUFFMAN_STREAM_MAGIC &&
+         get_uint32(stream) != HUFFMAN_LZ77_STREAM_MAGIC)) {
+        return -1;
+    }
+    *lz77 = get_uint32(stream) == HUFFMAN_LZ77_STREAM_MAGIC;
+    size_t block_size = get_uint32(stream + 4);
+
+    /** the index: entries, the number of blocks and the magic. */
+    size_t count = 0;
+    const unsigned char *index = NULL;
+    if (size >= HUFFMAN_STREAM_HEADER_SIZE + HUFFMAN_BLOCK_HEADER_SIZE + 8 &&
+        get_uint32(stream + size - 4) == HUFFMAN_INDEX_MAGIC) {
+        count = get_uint32(stream + size - 8);
+        size_t payload_size = count * HUFFMAN_INDEX_ENTRY_SIZE + 8;
+        if (payload_size <= size - HUFFMAN_STREAM_HEADER_SIZE -
+                                HUFFMAN_BLOCK_HEADER_SIZE) {
+            index = stream + size - payload_size;
+            const unsigned char *end = index - HUFFMAN_BLOCK_HEADER_SIZE;
+            if (get_uint32(end) != 0 || get_uint32(end + 4) != payload_size ||
+                get_uint32(end + 8) !=
+                    huffman_checksum((const char *)index, payload_size)) {
+                index = NULL;
+            }
+        }
+    }
+    if (index == NULL) {
+        /** count the blocks by their headers. */
+        count = 0;
+        size_t offset = HUFFMAN_STREAM_HEADER_SIZE;
+        size_t raw_size;
+        size_t length;
+        while (huffman_block_peek(
+                   stream + offset, size - offset, &raw_size, &length) == 0 &&
+               raw_size > 0 && length <= size - offset) {
+            offset += length;
+            ++count;
+        }
+    }
+
+    *offsets = (uint64_t *)malloc(sizeof(uint64_t) * (count + 1));
+    *raw_offsets = (uint64_t *)malloc(sizeof(uint64_t) * (count + 1));
+    if (*offsets == NULL || *raw_offsets == NULL) {
+        free(*offsets);
+        free(*raw_offsets);
+        return -1;
+    }
+
+    uint64_t offset = HUFFMAN_STREAM_HEADER_SIZE;
+    uint64_t raw_offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t raw_size;
+        size_t length;
+        if (huffman_block_peek(stream + offset, size - offset, &raw_size, &length) !=
+                0 ||
+            raw_size == 0 || raw_size > block_size || length > size - offset ||
+            (index != NULL &&
+             (get_uint32(index + HUFFMAN_INDEX_ENTRY_SIZE * i) != length ||
+              get_uint32(index + HUFFMAN_INDEX_ENTRY_SIZE * i + 4) !=
+                  raw_size))) {
+            free(*offsets);
+            free(*raw_offsets);
+            return -1;
+        }
+        (*offsets)[i] = offset;
+        (*raw_offsets)[i] = raw_offset;
+        offset += length;
+        raw_offset += raw_size;
+    }
+    (*offsets)[count] = offset;
+    (*raw_offsets)[count] = raw_offset;
+    *num_blocks = count;
+    return 0;
+}
+
+int huffman_stream_raw_size(const unsigned char *stream,
+                            size_t size,
+                            uint64_t *raw_size)
+{
+    int lz77;
+    size_t num_blocks;
+    uint64_t *offsets;
+    uint64_t *raw_offsets;
+    if (huffman_stream_blocks(
+            stream, size, &lz77, &num_blocks, &offsets, &raw_offsets) != 0) {
+        return -1;
+    }
+    *raw_size = raw_offsets[num_blocks];
+    free(offsets);
+    free(raw_offsets);
+    return 0;
+}
+
+int huffman_stream_decode(const unsigned char *stream,
+                          size_t size,
+                          char *output,
+                          uint64_t output_size,
+                          unsigned int num_threads)
+{
+    int lz77;
+    size_t num_blocks;
+    uint64_t *offsets;
+    uint64_t *raw_offsets;
+    if (huffman_stream_blocks(
+            stream, size, &lz77, &num_blocks, &offsets, &raw_offsets) != 0) {
+        return -1;
+    }
+    if (num_threads == 0) {
+        num_threads = 1;
+    } else if (num_threads > HUFFMAN_MAX_THREADS) {
+        num_threads = HUFFMAN_MAX_THREADS;
+    }
+
+    int result = -1;
+    const void **inputs = (const void **)malloc(sizeof(void *) * num_blocks);
+    size_t *input_sizes = (size_t *)malloc(sizeof(size_t) * num_blocks);
+    void **outputs = (void **)malloc(sizeof(void *) * num_blocks);
+    if (raw_offsets[num_blocks] <= output_size &&
+        (num_blocks == 0 ||
+         (inputs != NULL && input_sizes != NULL && outputs != NULL))) {
+        /** the blocks decode straight to their place in output. */
+        HuffmanBatch batch;
+        batch.decode = 1;
+        batch.lz77 = lz77;
+        batch.inputs = inputs;
+        batch.input_sizes = input_sizes;
+        batch.outputs = outputs;
+        batch.output_sizes = NULL;
+        batch.num_jobs = num_blocks;
+        for (size_t i = 0; i < num_blocks; ++i) {
+            inputs[i] = stream + offsets[i];
+            input_sizes[i] = offsets[i + 1] - offsets[i];
+            outputs[i] = output + raw_offsets[i];
+        }
+        result = huffman_batch_run(&batch, num_threads);
+    }
+
+    free(inputs);
+    free(input_sizes);
+    free(outputs);
+    free(offsets);
+    free(raw_offsets);
+    return result;
+}
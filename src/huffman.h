@@ -9,8 +9,51 @@
  *
  * Use huffman_encode or huffman_decode to encode or decode Text.
  *
+ * huffman_encode goes through a HuffmanTable, the code of each byte flat in
+ * an array, and writes the codes 64 bits at a time; use huffman_table_new
+ * and huffman_table_encode_to to encode many strings by the same tree into
+ * buffers of your own.
+ *
+ * huffman_decode goes through a HuffmanDecodeTable, looking up the next
+ * HUFFMAN_DECODE_ROOT_BITS bits at a time (long codes go on in sub tables)
+ * instead of walking the tree bit by bit; use huffman_decode_table_new and
+ * huffman_decode_to to decode into buffers of your own.
+ *
  * Use huffman_tree_deflate or huffman_tree_inflate to store or restor itself.
  *
+ * Or use canonical codes: huffman_code_lengths gives the code length of
+ * each byte, no longer than a limit (package-merge), and the codes follow
+ * from the 256 lengths alone. huffman_lengths_deflate or
+ * huffman_lengths_inflate store or restore the lengths, the tables and a
+ * HuffmanTree are rebuilt from them by huffman_table_from_lengths,
+ * huffman_decode_table_from_lengths and huffman_tree_from_lengths.
+ *
+ * To compress a stream in bounded memory, use a HuffmanEncoder and a
+ * HuffmanDecoder. The stream is split into independent blocks, each with
+ * its own canonical code lengths and checksum:
+ *
+ *     stream: "RHF1" [block_size: u32] block ... [end block]
+ *     block:  [raw_size: u32] [payload_size: u32] [checksum: u32] payload
+ *     end:    [0: u32] [payload_size: u32] [checksum: u32] index
+ *     index:  ([block size: u32] [raw_size: u32]) ... [blocks: u32] "RHFI"
+ *
+ * Numbers are little-endian. The payload is the code lengths
+ * (huffman_lengths_deflate) padded to 64 bits, then the codes; or the raw
+ * bytes if payload_size == raw_size (coding would not save). The checksum
+ * is the low 32 bits of hash_bytes64(raw, 0), of the index for the end
+ * block. The index may be missing (payload_size 0).
+ *
+ * A stream of magic "RHF2" has LZ77 blocks instead (lz77.h), of the same
+ * header: matches found in the block and then Huffman coded, by
+ * huffman_encoder_new_level or huffman_encoder_new_lz77; the decoder tells
+ * them by the magic.
+ *
+ * Blocks are independent, so the encoder and decoder may code several at
+ * once on threads (huffman_encoder_new_threads,
+ * huffman_decoder_new_threads); and a stream in memory is decoded block by
+ * block in parallel, each to its own place found from the index, by
+ * huffman_stream_decode.
+ *
  * @date 2019-08-21
  *
  * @copyright Copyright (c) 2019, hutusi.com
@@ -22,8 +65,59 @@
 
 #include "bitmap.h"
 #include "heap.h"
+#include "lz77.h"
 #include "text.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The longest code of a HuffmanTable.
+ */
+#define HUFFMAN_MAX_CODE_BITS 64
+
+/**
+ * @brief The bits looked up at once by the root table of a
+ * HuffmanDecodeTable.
+ */
+#define HUFFMAN_DECODE_ROOT_BITS 10
+
+/**
+ * @brief The most bits looked up at once by a sub table of a
+ * HuffmanDecodeTable.
+ */
+#define HUFFMAN_DECODE_SUB_BITS 6
+
+/**
+ * @brief The longest code in a block of a stream.
+ */
+#define HUFFMAN_BLOCK_CODE_BITS 15
+
+/**
+ * @brief The default raw size of a block of a stream.
+ */
+#define HUFFMAN_BLOCK_SIZE (1 << 20)
+
+/**
+ * @brief The largest raw size of a block of a stream.
+ */
+#define HUFFMAN_BLOCK_MAX_SIZE (1 << 28)
+
+/**
+ * @brief The size of a block header, before the payload.
+ */
+#define HUFFMAN_BLOCK_HEADER_SIZE 12
+
+/**
+ * @brief The size of a stream header, before the first block.
+ */
+#define HUFFMAN_STREAM_HEADER_SIZE 8
+
+/**
+ * @brief The most threads of a HuffmanEncoder or HuffmanDecoder.
+ */
+#define HUFFMAN_MAX_THREADS 64
+
 /**
  * @brief Definition of a @ref HuffmanNode.
  *
@@ -89,6 +183,50 @@ void huffman_heap_free(Heap *heap);
  */
 int huffman_heap_insert(Heap *heap, char value, unsigned int weight);
 
+/**
+ * @brief Definition of a @ref HuffmanTable, the codes of a Huffman Tree.
+ *
+ * The bits of a code are in the order of the path from the root, the first
+ * in bit 0, as they are written to a BitMap.
+ */
+typedef struct _HuffmanTable {
+    /** The code of each byte. */
+    uint64_t codes[256];
+    /** The length of each code in bits, 0 if the byte is not in the tree. */
+    unsigned char lengths[256];
+} HuffmanTable;
+
+/**
+ * @brief Definition of a @ref HuffmanDecodeEntry, an entry of a
+ * HuffmanDecodeTable.
+ */
+typedef struct _HuffmanDecodeEntry {
+    /** The byte, or the index of the sub table if sub_bits is not 0. */
+    uint32_t value;
+    /** The bits of the code used in this table, 0 if no code. */
+    unsigned char length;
+    /** The bits looking up the sub table, 0 if value is a byte. */
+    unsigned char sub_bits;
+} HuffmanDecodeEntry;
+
+/**
+ * @brief Definition of a @ref HuffmanDecodeTable.
+ *
+ * The entries of the root table are indexed by the next root_bits bits of
+ * a code (the first in bit 0): the entry of a code shorter than root_bits is
+ * repeated over all the bits after it. A longer code goes on in the sub
+ * table of its root_bits bits prefix, and so on.
+ */
+typedef struct _HuffmanDecodeTable {
+    /** The root table first, then the sub tables. */
+    HuffmanDecodeEntry *entries;
+    unsigned int num_entries;
+    /** The bits looking up the root table. */
+    unsigned int root_bits;
+    /** The length of the longest code. */
+    unsigned int max_length;
+} HuffmanDecodeTable;
+
 /**
  * @brief Allocate a new Huffman Tree.
  *
@@ -128,21 +266,105 @@ BitMap *huffman_encode(const HuffmanTree *tree, const Text *text);
  * @param tree      The Huffman Tree coding.
  * @param string    The string.
  * @param size      The size of the string.
- * @return BitMap*  The BitMap.
+ * @return BitMap*  The BitMap, NULL if the code is longer than UINT_MAX bits.
  */
 BitMap *huffman_encode_string(const HuffmanTree *tree,
                               const char *string,
                               unsigned int size);
 
+/**
+ * @brief Generate the table of codes of a Huffman Tree.
+ *
+ * @param tree              The Huffman Tree.
+ * @return HuffmanTable*    The new table, NULL if out of memory or a code is
+ *                          longer than HUFFMAN_MAX_CODE_BITS.
+ */
+HuffmanTable *huffman_table_new(const HuffmanTree *tree);
+
+/**
+ * @brief Delete a HuffmanTable and free back memory.
+ *
+ * @param table     The HuffmanTable.
+ */
+void huffman_table_free(HuffmanTable *table);
+
+/**
+ * @brief Get the number of bits of a string encoded by a HuffmanTable.
+ *
+ * @param table     The HuffmanTable.
+ * @param string    The string.
+ * @param size      The size of the string.
+ * @return uint64_t The number of bits.
+ */
+uint64_t huffman_table_encoded_bits(const HuffmanTable *table,
+                                    const char *string,
+                                    size_t size);
+
+/**
+ * @brief Encode a string by a HuffmanTable to words, as a BitMap's words.
+ *
+ * The bytes of string must all be in the table. The bits past the end in
+ * the last word are 0.
+ *
+ * @param table     The HuffmanTable.
+ * @param string    The string.
+ * @param size      The size of the string.
+ * @param words     The output, room for huffman_table_encoded_bits() bits.
+ * @return uint64_t The number of bits written.
+ */
+uint64_t huffman_table_encode_to(const HuffmanTable *table,
+                                 const char *string,
+                                 size_t size,
+                                 word_t *words);
+
 /**
  * @brief Decode a sequence of BitMap to a Text by a Huffman Tree coding.
  *
  * @param tree      The Huffman Tree coding.
  * @param bitmap    The BitMap.
- * @return Text*    The Text.
+ * @return Text*    The Text, NULL if out of memory.
  */
 Text *huffman_decode(const HuffmanTree *tree, const BitMap *bitmap);
 
+/**
+ * @brief Generate the decode table of a Huffman Tree.
+ *
+ * @param tree                  The Huffman Tree.
+ * @return HuffmanDecodeTable*  The new table, NULL if out of memory or a code
+ *                              is longer than HUFFMAN_MAX_CODE_BITS.
+ */
+HuffmanDecodeTable *huffman_decode_table_new(const HuffmanTree *tree);
+
+/**
+ * @brief Delete a HuffmanDecodeTable and free back memory.
+ *
+ * @param table     The HuffmanDecodeTable.
+ */
+void huffman_decode_table_free(HuffmanDecodeTable *table);
+
+/**
+ * @brief Decode words, as a BitMap's words, by a HuffmanDecodeTable into a
+ * buffer.
+ *
+ * Decoding stops when the buffer is full, or at the end of the bits. A code
+ * cut by the end of the bits is not decoded.
+ *
+ * @param table     The HuffmanDecodeTable.
+ * @param words     The words.
+ * @param num_bits  The number of bits in words.
+ * @param position  The bit to decode from, updated to the bit after the
+ *                  last code decoded.
+ * @param output    The buffer.
+ * @param size      The size of the buffer.
+ * @return size_t   The number of bytes decoded.
+ */
+size_t huffman_decode_to(const HuffmanDecodeTable *table,
+                         const word_t *words,
+                         uint64_t num_bits,
+                         uint64_t *position,
+                         char *output,
+                         size_t size);
+
 /**
  * @brief Deflate a Huffman Tree to a BitMap for storing with few storage.
  *
@@ -168,4 +390,368 @@ HuffmanTree *huffman_tree_inflate(const BitMap *bitmap);
  */
 int huffman_tree_equal(const HuffmanTree *tree1, const HuffmanTree *tree2);
 
+/**
+ * @brief Count the weight of each byte of a string.
+ *
+ * @param string    The string.
+ * @param size      The size of the string.
+ * @param weights   The output, the count of each byte.
+ */
+void huffman_count_weights(const char *string,
+                           size_t size,
+                           uint64_t weights[256]);
+
+/**
+ * @brief Generate the length-limited Huffman code lengths of the weights.
+ *
+ * The lengths minimize the encoded size with no code longer than
+ * max_length (package-merge). A byte of weight 0 has no code (length 0), a
+ * single byte of non-zero weight gets a 1 bit code.
+ *
+ * @param weights       The weight of each byte.
+ * @param max_length    The longest code allowed, 1 to HUFFMAN_MAX_CODE_BITS.
+ * @param lengths       The output, the code length of each byte.
+ * @return int          0 if success, -1 if out of memory or the bytes of
+ *                      non-zero weight are more than 2^max_length.
+ */
+int huffman_code_lengths(const uint64_t weights[256],
+                         unsigned int max_length,
+                         unsigned char lengths[256]);
+
+/**
+ * @brief Get the code lengths of a Huffman Tree.
+ *
+ * The leave of a tree of a single leave gets a 1 bit code.
+ *
+ * @param tree      The Huffman Tree.
+ * @param lengths   The output, the code length of each byte.
+ * @return int      0 if success, -1 if a code is longer than
+ *                  HUFFMAN_MAX_CODE_BITS.
+ */
+int huffman_tree_to_lengths(const HuffmanTree *tree, unsigned char lengths[256]);
+
+/**
+ * @brief Generate the canonical Huffman Tree of code lengths.
+ *
+ * The codes of the same length are in order of the bytes, the shorter codes
+ * first: as DEFLATE does. The weights of the nodes are 0.
+ *
+ * @param lengths           The code length of each byte.
+ * @return HuffmanTree*     The new Huffman Tree, NULL if the lengths are not
+ *                          a prefix code or longer than HUFFMAN_MAX_CODE_BITS.
+ */
+HuffmanTree *huffman_tree_from_lengths(const unsigned char lengths[256]);
+
+/**
+ * @brief Generate the table of the canonical codes of code lengths.
+ *
+ * @param lengths           The code length of each byte.
+ * @return HuffmanTable*    The new table, NULL if out of memory, or the
+ *                          lengths are not a prefix code or longer than
+ *                          HUFFMAN_MAX_CODE_BITS.
+ */
+HuffmanTable *huffman_table_from_lengths(const unsigned char lengths[256]);
+
+/**
+ * @brief Generate the decode table of the canonical codes of code lengths.
+ *
+ * @param lengths               The code length of each byte.
+ * @return HuffmanDecodeTable*  The new table, NULL if out of memory, or the
+ *                              lengths are not a prefix code or longer than
+ *                              HUFFMAN_MAX_CODE_BITS.
+ */
+HuffmanDecodeTable *
+huffman_decode_table_from_lengths(const unsigned char lengths[256]);
+
+/**
+ * @brief Deflate code lengths to a BitMap.
+ *
+ * A run of bytes without code is stored in 9 bits, a code length in 7 bits.
+ *
+ * @param lengths   The code length of each byte.
+ * @return BitMap*  The BitMap.
+ */
+BitMap *huffman_lengths_deflate(const unsigned char lengths[256]);
+
+/**
+ * @brief Inflate code lengths from a BitMap. (Restore.)
+ *
+ * @param bitmap    The BitMap.
+ * @param index     The bit to inflate from, updated to the bit after.
+ * @param lengths   The output, the code length of each byte.
+ * @return int      0 if success, -1 if the BitMap ends too early or its
+ *                  runs pass the 256 bytes.
+ */
+int huffman_lengths_inflate(const BitMap *bitmap,
+                            unsigned int *index,
+                            unsigned char lengths[256]);
+
+/**
+ * @brief Get the largest size of a block encoding size raw bytes.
+ *
+ * @param size      The raw size.
+ * @return size_t   The block size.
+ */
+size_t huffman_block_bound(size_t size);
+
+/**
+ * @brief Encode bytes to a block of a stream.
+ *
+ * @param data      The raw bytes.
+ * @param size      The raw size, 1 to HUFFMAN_BLOCK_MAX_SIZE.
+ * @param output    The block, room for huffman_block_bound(size) bytes.
+ * @return size_t   The size of the block, 0 if out of memory.
+ */
+size_t huffman_block_encode(const char *data, size_t size, unsigned char *output);
+
+/**
+ * @brief Read the header of a block of a stream.
+ *
+ * @param block         The block.
+ * @param size          The bytes available of the block.
+ * @param raw_size      The output, the raw size.
+ * @param block_size    The output, the size of the whole block.
+ * @return int          0 if success, -1 if size is less than the header.
+ */
+int huffman_block_peek(const unsigned char *block,
+                       size_t size,
+                       size_t *raw_size,
+                       size_t *block_size);
+
+/**
+ * @brief Decode a block of a stream.
+ *
+ * @param block         The block.
+ * @param block_size    The size of the whole block.
+ * @param output        The raw bytes, room for the raw size of the block.
+ * @return int          0 if success, -1 if the block is corrupt (or its
+ *                      checksum does not match) or out of memory.
+ */
+int huffman_block_decode(const unsigned char *block,
+                         size_t block_size,
+                         char *output);
+
+/**
+ * @brief The output of a HuffmanEncoder or a HuffmanDecoder.
+ *
+ * @param data      The bytes.
+ * @param size      The number of bytes.
+ * @param args      The args given to the encoder or decoder.
+ * @return int      0 if success, otherwise the stream stops.
+ */
+typedef int (*HuffmanWriteFunc)(const void *data, size_t size, void *args);
+
+/**
+ * @brief Definition of a @ref HuffmanEncoder, which compresses a stream
+ * block by block.
+ */
+typedef struct _HuffmanEncoder HuffmanEncoder;
+
+/**
+ * @brief Definition of a @ref HuffmanDecoder, which decompresses a stream
+ * block by block as its bytes arrive.
+ */
+typedef struct _HuffmanDecoder HuffmanDecoder;
+
+/**
+ * @brief Allocate a new HuffmanEncoder.
+ *
+ * It holds a block of raw bytes and one encoded block at most, and the
+ * index of the blocks written.
+ *
+ * @param block_size        The raw size of a block, 0 for
+ *                          HUFFMAN_BLOCK_SIZE, at most
+ *                          HUFFMAN_BLOCK_MAX_SIZE.
+ * @param write             The output of the compressed stream.
+ * @param args              The args of write.
+ * @return HuffmanEncoder*  The new HuffmanEncoder, NULL if out of memory or
+ *                          block_size is too large.
+ */
+HuffmanEncoder *
+huffman_encoder_new(size_t block_size, HuffmanWriteFunc write, void *args);
+
+/**
+ * @brief Allocate a new HuffmanEncoder which encodes blocks on threads.
+ *
+ * It holds two blocks of raw bytes and two encoded blocks a thread, and
+ * writes the same stream as huffman_encoder_new.
+ *
+ * @param block_size        The raw size of a block, 0 for
+ *                          HUFFMAN_BLOCK_SIZE, at most
+ *                          HUFFMAN_BLOCK_MAX_SIZE.
+ * @param num_threads       The number of threads, 0 for 1, at most
+ *                          HUFFMAN_MAX_THREADS.
+ * @param write             The output of the compressed stream.
+ * @param args              The args of write.
+ * @return HuffmanEncoder*  The new HuffmanEncoder, NULL if out of memory or
+ *                          block_size or num_threads is too large.
+ */
+HuffmanEncoder *huffman_encoder_new_threads(size_t block_size,
+                                            unsigned int num_threads,
+                                            HuffmanWriteFunc write,
+                                            void *args);
+
+/**
+ * @brief Allocate a new HuffmanEncoder which finds LZ77 matches in the
+ * blocks before Huffman coding, on threads.
+ *
+ * @param block_size        The raw size of a block, 0 for
+ *                          HUFFMAN_BLOCK_SIZE, at most
+ *                          HUFFMAN_BLOCK_MAX_SIZE.
+ * @param level             0 for Huffman coding only, or an LZ77 level,
+ *                          LZ77_MIN_LEVEL to LZ77_MAX_LEVEL.
+ * @param num_threads       The number of threads, 0 for 1, at most
+ *                          HUFFMAN_MAX_THREADS.
+ * @param write             The output of the compressed stream.
+ * @param args              The args of write.
+ * @return HuffmanEncoder*  The new HuffmanEncoder, NULL if out of memory or
+ *                          block_size or num_threads is too large.
+ */
+HuffmanEncoder *huffman_encoder_new_level(size_t block_size,
+                                          int level,
+                                          unsigned int num_threads,
+                                          HuffmanWriteFunc write,
+                                          void *args);
+
+/**
+ * @brief Allocate a new HuffmanEncoder which finds LZ77 matches by params
+ * before Huffman coding, on threads.
+ *
+ * @param block_size        The raw size of a block, 0 for
+ *                          HUFFMAN_BLOCK_SIZE, at most
+ *                          HUFFMAN_BLOCK_MAX_SIZE.
+ * @param params            The parameters of the match finder, NULL for
+ *                          Huffman coding only.
+ * @param num_threads       The number of threads, 0 for 1, at most
+ *                          HUFFMAN_MAX_THREADS.
+ * @param write             The output of the compressed stream.
+ * @param args              The args of write.
+ * @return HuffmanEncoder*  The new HuffmanEncoder, NULL if out of memory,
+ *                          block_size or num_threads is too large or
+ *                          params are bad.
+ */
+HuffmanEncoder *huffman_encoder_new_lz77(size_t block_size,
+                                         const Lz77Params *params,
+                                         unsigned int num_threads,
+                                         HuffmanWriteFunc write,
+                                         void *args);
+
+/**
+ * @brief Delete a HuffmanEncoder and free back memory.
+ *
+ * @param encoder   The HuffmanEncoder.
+ */
+void huffman_encoder_free(HuffmanEncoder *encoder);
+
+/**
+ * @brief Compress bytes of the stream, a block is written once full.
+ *
+ * @param encoder   The HuffmanEncoder.
+ * @param data      The bytes.
+ * @param size      The number of bytes.
+ * @return int      0 if success, -1 if out of memory or write failed.
+ */
+int huffman_encoder_write(HuffmanEncoder *encoder,
+                          const char *data,
+                          size_t size);
+
+/**
+ * @brief Write the last block and the end of the stream, with the index of
+ * the blocks.
+ *
+ * @param encoder   The HuffmanEncoder.
+ * @return int      0 if success, -1 if out of memory or write failed.
+ */
+int huffman_encoder_finish(HuffmanEncoder *encoder);
+
+/**
+ * @brief Allocate a new HuffmanDecoder.
+ *
+ * It holds one block and its raw bytes at most.
+ *
+ * @param write             The output of the raw stream.
+ * @param args              The args of write.
+ * @return HuffmanDecoder*  The new HuffmanDecoder, NULL if out of memory.
+ */
+HuffmanDecoder *huffman_decoder_new(HuffmanWriteFunc write, void *args);
+
+/**
+ * @brief Allocate a new HuffmanDecoder which decodes blocks on threads.
+ *
+ * It holds two blocks and their raw bytes a thread.
+ *
+ * @param num_threads       The number of threads, 0 for 1, at most
+ *                          HUFFMAN_MAX_THREADS.
+ * @param write             The output of the raw stream.
+ * @param args              The args of write.
+ * @return HuffmanDecoder*  The new HuffmanDecoder, NULL if out of memory or
+ *                          num_threads is too large.
+ */
+HuffmanDecoder *huffman_decoder_new_threads(unsigned int num_threads,
+                                            HuffmanWriteFunc write,
+                                            void *args);
+
+/**
+ * @brief Delete a HuffmanDecoder and free back memory.
+ *
+ * @param decoder   The HuffmanDecoder.
+ */
+void huffman_decoder_free(HuffmanDecoder *decoder);
+
+/**
+ * @brief Decompress bytes of the compressed stream, each block is written
+ * as soon as it is complete (on threads, once a block a thread is).
+ *
+ * @param decoder   The HuffmanDecoder.
+ * @param data      The bytes.
+ * @param size      The number of bytes.
+ * @return int      0 if success, -1 if the stream is corrupt, bytes follow
+ *                  its end, out of memory or write failed.
+ */
+int huffman_decoder_write(HuffmanDecoder *decoder,
+                          const unsigned char *data,
+                          size_t size);
+
+/**
+ * @brief Check the compressed stream is complete.
+ *
+ * @param decoder   The HuffmanDecoder.
+ * @return int      0 if the end of the stream is reached, otherwise -1.
+ */
+int huffman_decoder_finish(HuffmanDecoder *decoder);
+
+/**
+ * @brief Get the raw size of a whole compressed stream in memory.
+ *
+ * @param stream    The compressed stream.
+ * @param size      The size of the stream.
+ * @param raw_size  The raw size.
+ * @return int      0 if success, -1 if the stream is corrupt or out of
+ *                  memory.
+ */
+int huffman_stream_raw_size(const unsigned char *stream,
+                            size_t size,
+                            uint64_t *raw_size);
+
+/**
+ * @brief Decompress a whole compressed stream in memory, its blocks in
+ * parallel.
+ *
+ * The blocks are found from the index, or from the block headers one by
+ * one if the stream has none.
+ *
+ * @param stream        The compressed stream.
+ * @param size          The size of the stream.
+ * @param output        The raw bytes, huffman_stream_raw_size of them.
+ * @param output_size   The size of output.
+ * @param num_threads   The number of threads, 0 for 1.
+ * @return int          0 if success, -1 if the stream is corrupt, output is
+ *                      too small or out of memory.
+ */
+int huffman_stream_decode(const unsigned char *stream,
+                          size_t size,
+                          char *output,
+                          uint64_t output_size,
+                          unsigned int num_threads);
+
 #endif /* #ifndef RETHINK_C_HUFFMAN_H */
@@ -0,0 +1,189 @@
+/**
+ * @file ilist.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to ilist.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "ilist.h"
+
+void ilist_init(IList *list)
+{
+    list->head.prev = list->head.next = &(list->head);
+    list->length = 0;
+}
+
+int ilist_is_empty(const IList *list)
+{
+    return list->length == 0;
+}
+
+static inline void
+ilist_link(IListNode *prev, IListNode *node, IListNode *next)
+{
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+}
+
+void ilist_prepend(IList *list, IListNode *node)
+{
+    ilist_link(&(list->head), node, list->head.next);
+    ++(list->length);
+}
+
+void ilist_append(IList *list, IListNode *node)
+{
+    ilist_link(list->head.prev, node, &(list->head));
+    ++(list->length);
+}
+
+void ilist_insert_after(IList *list, IListNode *pos, IListNode *node)
+{
+    ilist_link(pos, node, pos->next);
+    ++(list->length);
+}
+
+IListNode *ilist_first(const IList *list)
+{
+    return list->length == 0 ? NULL : list->head.next;
+}
+
+IListNode *ilist_last(const IList *list)
+{
+    return list->length == 0 ? NULL : list->head.prev;
+}
+
+IListNode *ilist_next(const IList *list, const IListNode *node)
+{
+    return node->next == &(list->head) ? NULL : node->next;
+}
+
+IListNode *ilist_prev(const IList *list, const IListNode *node)
+{
+    return node->prev == &(list->head) ? NULL : node->prev;
+}
+
+IListNode *ilist_nth_node(const IList *list, unsigned int n)
+{
+    if (n >= list->length) {
+        return NULL;
+    }
+
+    IListNode *node = list->head.next;
+    for (unsigned int i = 0; i < n; ++i) {
+        node = node->next;
+    }
+    return node;
+}
+
+IListNode *ilist_find_node(const IList *list, const IListNode *node)
+{
+    for (IListNode *rover = list->head.next; rover != &(list->head);
+         rover = rover->next) {
+        if (rover == node) {
+            return rover;
+        }
+    }
+    return NULL;
+}
+
+IListNode *
+ilist_find_data(const IList *list, IListMatchFunc match, const void *data)
+{
+    for (IListNode *rover = list->head.next; rover != &(list->head);
+         rover = rover->next) {
+        if (match(rover, data)) {
+            return rover;
+        }
+    }
+    return NULL;
+}
+
+IListNode *ilist_remove_node(IList *list, IListNode *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = NULL;
+    --(list->length);
+    return node;
+}
+
+IListNode *
+ilist_remove_data(IList *list, IListMatchFunc match, const void *data)
+{
+    IListNode *node = ilist_find_data(list, match, data);
+    if (node == NULL) {
+        return NULL; // not found
+    }
+    return ilist_remove_node(list, node);
+}
+
+/** merge two NULL terminated singly linked (by next) runs. */
+static IListNode *
+ilist_merge(IListNode *run1, IListNode *run2, IListCompareFunc compare_func)
+{
+    IListNode merged;
+    IListNode *tail = &merged;
+    while (run1 != NULL && run2 != NULL) {
+        if (compare_func(run1, run2) <= 0) {
+            tail->next = run1;
+            run1 = run1->next;
+        } else {
+            tail->next = run2;
+            run2 = run2->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = run1 != NULL ? run1 : run2;
+    return merged.next;
+}
+
+static IListNode *ilist_merge_sort(IListNode *head,
+                                   unsigned int length,
+                                   IListCompareFunc compare_func)
+{
+    if (length <= 1) {
+        if (head != NULL) {
+            head->next = NULL;
+        }
+        return head;
+    }
+
+    unsigned int half = length / 2;
+    IListNode *second = head;
+    for (unsigned int i = 0; i < half; ++i) {
+        second = second->next;
+    }
+    /** the first run is cut by its length, the next links of the second run
+     * are still intact. */
+    IListNode *run2 = ilist_merge_sort(second, length - half, compare_func);
+    IListNode *run1 = ilist_merge_sort(head, half, compare_func);
+    return ilist_merge(run1, run2, compare_func);
+}
+
+int ilist_sort(IList *list, IListCompareFunc compare_func)
+{
+    if (list->length <= 1) {
+        return 0;
+    }
+
+    IListNode *node =
+        ilist_merge_sort(list->head.next, list->length, compare_func);
+
+    /** rebuild prev links and close the circle. */
+    IListNode *prev = &(list->head);
+    while (node != NULL) {
+        prev->next = node;
+        node->prev = prev;
+        prev = node;
+        node = node->next;
+    }
+    prev->next = &(list->head);
+    list->head.prev = prev;
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file ilist.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Intrusive Double Linked List.
+ *
+ * The links are embedded in the caller's struct as an @ref IListNode
+ * member, and the struct is recovered from a node by @ref ilist_entry, so
+ * linking and unlinking never allocate:
+ *
+ *     typedef struct { int vertex; IListNode link; } Vertex;
+ *     ilist_append(&list, &vertex->link);
+ *     Vertex *v = ilist_entry(ilist_first(&list), Vertex, link);
+ *
+ * A node can be in one IList at a time per IListNode member.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_ILIST_H
+#define RETHINK_C_ILIST_H
+
+#include <stddef.h>
+
+/**
+ * @brief Get the struct which embeds a member from a pointer to the member.
+ *
+ * @param ptr       The pointer to the member.
+ * @param type      The type of the struct.
+ * @param member    The name of the member in the struct.
+ */
+#define container_of(ptr, type, member)                                       \
+    ((type *)((char *)(ptr)-offsetof(type, member)))
+
+/**
+ * @brief Get the struct which embeds an @ref IListNode.
+ */
+#define ilist_entry(node, type, member) container_of(node, type, member)
+
+/**
+ * @brief Definition of an @ref IListNode, the links embedded in a struct.
+ *
+ */
+typedef struct _IListNode {
+    struct _IListNode *prev;
+    struct _IListNode *next;
+} IListNode;
+
+/**
+ * @brief Definition of an @ref IList.
+ *
+ * The list is circular around the head sentinel, so no link is ever NULL
+ * inside the list.
+ */
+typedef struct _IList {
+    IListNode head;
+    unsigned int length;
+} IList;
+
+typedef int (*IListCompareFunc)(const IListNode *node1,
+                                const IListNode *node2);
+typedef int (*IListMatchFunc)(const IListNode *node, const void *data);
+
+/**
+ * @brief Initialize an empty IList, an IList needs no free.
+ *
+ * @param list  The IList.
+ */
+void ilist_init(IList *list);
+
+/**
+ * @brief Check if an IList is empty.
+ *
+ * @param list      The IList.
+ * @return int      1 if empty, otherwise 0.
+ */
+int ilist_is_empty(const IList *list);
+
+/**
+ * @brief Prepend a node to the beginning of an IList.
+ *
+ * @param list  The IList.
+ * @param node  The node, not in any IList.
+ */
+void ilist_prepend(IList *list, IListNode *node);
+
+/**
+ * @brief Append a node to the end of an IList.
+ *
+ * @param list  The IList.
+ * @param node  The node, not in any IList.
+ */
+void ilist_append(IList *list, IListNode *node);
+
+/**
+ * @brief Insert a node after a node of an IList.
+ *
+ * @param list  The IList.
+ * @param pos   The node in the IList.
+ * @param node  The node to insert, not in any IList.
+ */
+void ilist_insert_after(IList *list, IListNode *pos, IListNode *node);
+
+/**
+ * @brief Get the first node of an IList.
+ *
+ * @param list          The IList.
+ * @return IListNode*   The first node, NULL if empty.
+ */
+IListNode *ilist_first(const IList *list);
+
+/**
+ * @brief Get the last node of an IList.
+ *
+ * @param list          The IList.
+ * @return IListNode*   The last node, NULL if empty.
+ */
+IListNode *ilist_last(const IList *list);
+
+/**
+ * @brief Get the next node in an IList.
+ *
+ * @param list          The IList.
+ * @param node          The node in the IList.
+ * @return IListNode*   The next node, NULL if node is the last.
+ */
+IListNode *ilist_next(const IList *list, const IListNode *node);
+
+/**
+ * @brief Get the previous node in an IList.
+ *
+ * @param list          The IList.
+ * @param node          The node in the IList.
+ * @return IListNode*   The previous node, NULL if node is the first.
+ */
+IListNode *ilist_prev(const IList *list, const IListNode *node);
+
+/**
+ * @brief Get the nth node of an IList.
+ *
+ * @param list          The IList.
+ * @param n             The nth index.
+ * @return IListNode*   The nth node if success, otherwise return NULL.
+ */
+IListNode *ilist_nth_node(const IList *list, unsigned int n);
+
+/**
+ * @brief Find a node in an IList.
+ *
+ * @param list          The IList.
+ * @param node          The node to lookup.
+ * @return IListNode*   The node if it is in the IList, otherwise NULL.
+ */
+IListNode *ilist_find_node(const IList *list, const IListNode *node);
+
+/**
+ * @brief Find the first node matching data in an IList.
+ *
+ * @param list          The IList.
+ * @param match         The match callback, non-zero if node matches data.
+ * @param data          The data to match.
+ * @return IListNode*   The node if found, otherwise NULL.
+ */
+IListNode *
+ilist_find_data(const IList *list, IListMatchFunc match, const void *data);
+
+/**
+ * @brief Remove a node from an IList.
+ *
+ * The caller still owns the struct embedding the node.
+ *
+ * @param list          The IList.
+ * @param node          The node in the IList.
+ * @return IListNode*   The node.
+ */
+IListNode *ilist_remove_node(IList *list, IListNode *node);
+
+/**
+ * @brief Remove the first node matching data from an IList.
+ *
+ * @param list          The IList.
+ * @param match         The match callback, non-zero if node matches data.
+ * @param data          The data to match.
+ * @return IListNode*   The removed node if found, otherwise NULL.
+ */
+IListNode *
+ilist_remove_data(IList *list, IListMatchFunc match, const void *data);
+
+/**
+ * @brief Sort an IList, stable merge sort.
+ *
+ * @param list          The IList.
+ * @param compare_func  The compare function to callback.
+ * @return int          0 if success.
+ */
+int ilist_sort(IList *list, IListCompareFunc compare_func);
+
+#endif /* #ifndef RETHINK_C_ILIST_H */
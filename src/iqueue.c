@@ -0,0 +1,64 @@
+/**
+ * @file iqueue.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to iqueue.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "iqueue.h"
+
+void iqueue_init(IQueue *queue)
+{
+    ilist_init(&(queue->list));
+}
+
+void iqueue_push_head(IQueue *queue, IQueueNode *node)
+{
+    ilist_prepend(&(queue->list), node);
+}
+
+IQueueNode *iqueue_pop_head(IQueue *queue)
+{
+    IQueueNode *node = ilist_first(&(queue->list));
+    if (node == NULL) {
+        return NULL;
+    }
+    return ilist_remove_node(&(queue->list), node);
+}
+
+IQueueNode *iqueue_peek_head(const IQueue *queue)
+{
+    return ilist_first(&(queue->list));
+}
+
+void iqueue_push_tail(IQueue *queue, IQueueNode *node)
+{
+    ilist_append(&(queue->list), node);
+}
+
+IQueueNode *iqueue_pop_tail(IQueue *queue)
+{
+    IQueueNode *node = ilist_last(&(queue->list));
+    if (node == NULL) {
+        return NULL;
+    }
+    return ilist_remove_node(&(queue->list), node);
+}
+
+IQueueNode *iqueue_peek_tail(const IQueue *queue)
+{
+    return ilist_last(&(queue->list));
+}
+
+int iqueue_is_empty(const IQueue *queue)
+{
+    return ilist_is_empty(&(queue->list));
+}
+
+unsigned int iqueue_length(const IQueue *queue)
+{
+    return queue->list.length;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file iqueue.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Intrusive Queue (double-ended), built on @ref IList.
+ *
+ * The caller embeds an @ref IQueueNode in its struct and recovers the
+ * struct from a popped node by @ref iqueue_entry, so push and pop never
+ * allocate.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_IQUEUE_H
+#define RETHINK_C_IQUEUE_H
+
+#include "ilist.h"
+
+/**
+ * @brief Get the struct which embeds an @ref IQueueNode.
+ */
+#define iqueue_entry(node, type, member) container_of(node, type, member)
+
+typedef IListNode IQueueNode;
+
+/**
+ * @brief Definition of an @ref IQueue.
+ *
+ */
+typedef struct _IQueue {
+    IList list;
+} IQueue;
+
+/**
+ * @brief Initialize an empty IQueue, an IQueue needs no free.
+ *
+ * @param queue     The IQueue.
+ */
+void iqueue_init(IQueue *queue);
+
+/**
+ * @brief Push a node to the head of an IQueue.
+ *
+ * @param queue     The IQueue.
+ * @param node      The node, not in any IQueue.
+ */
+void iqueue_push_head(IQueue *queue, IQueueNode *node);
+
+/**
+ * @brief Pop the head node of an IQueue.
+ *
+ * @param queue         The IQueue.
+ * @return IQueueNode*  The popped node, NULL if empty.
+ */
+IQueueNode *iqueue_pop_head(IQueue *queue);
+
+/**
+ * @brief Peek the head node of an IQueue.
+ *
+ * @param queue         The IQueue.
+ * @return IQueueNode*  The head node, NULL if empty.
+ */
+IQueueNode *iqueue_peek_head(const IQueue *queue);
+
+/**
+ * @brief Push a node to the tail of an IQueue.
+ *
+ * @param queue     The IQueue.
+ * @param node      The node, not in any IQueue.
+ */
+void iqueue_push_tail(IQueue *queue, IQueueNode *node);
+
+/**
+ * @brief Pop the tail node of an IQueue.
+ *
+ * @param queue         The IQueue.
+ * @return IQueueNode*  The popped node, NULL if empty.
+ */
+IQueueNode *iqueue_pop_tail(IQueue *queue);
+
+/**
+ * @brief Peek the tail node of an IQueue.
+ *
+ * @param queue         The IQueue.
+ * @return IQueueNode*  The tail node, NULL if empty.
+ */
+IQueueNode *iqueue_peek_tail(const IQueue *queue);
+
+/**
+ * @brief Check if an IQueue is empty.
+ *
+ * @param queue     The IQueue.
+ * @return int      1 if empty, otherwise 0.
+ */
+int iqueue_is_empty(const IQueue *queue);
+
+/**
+ * @brief Get the number of nodes in an IQueue.
+ *
+ * @param queue             The IQueue.
+ * @return unsigned int     The length.
+ */
+unsigned int iqueue_length(const IQueue *queue);
+
+#endif /* #ifndef RETHINK_C_IQUEUE_H */
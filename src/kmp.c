@@ -47,7 +47,7 @@ STATIC int *kmp_calculate_next(const char *string, int len)
     int k = 0;
     for (int i = 1; i < len; ++i) {
         while (k > 0 && string[k] != string[i]) {
-            k = next[k];
+            k = next[k - 1];
         }
 
         if (string[k] == string[i]) {
@@ -22,11 +22,34 @@ List *list_new()
 
     list->head = list->tail = NULL;
     list->length = 0;
+    list->slab = NULL;
+    return list;
+}
+
+List *list_new_with_slab(unsigned int nodes_per_page)
+{
+    List *list = list_new();
+    if (list == NULL) {
+        return NULL;
+    }
+
+    list->slab = slab_new(sizeof(ListNode), nodes_per_page);
+    if (list->slab == NULL) {
+        free(list);
+        return NULL;
+    }
     return list;
 }
 
 void list_free(List *list)
 {
+    if (list->slab != NULL) {
+        /** nodes own nothing, drop their pages at once. */
+        slab_free(list->slab);
+        free(list);
+        return;
+    }
+
     ListNode *node = list->head;
 
     while (node != NULL) {
@@ -38,9 +61,20 @@ void list_free(List *list)
     free(list);
 }
 
-static ListNode *listnode_new(ListValue data)
+void list_free_node(List *list, ListNode *node)
 {
-    ListNode *node = (ListNode *)malloc(sizeof(ListNode));
+    if (list->slab != NULL) {
+        slab_dealloc(list->slab, node);
+    } else {
+        free(node);
+    }
+}
+
+static ListNode *listnode_new(List *list, ListValue data)
+{
+    ListNode *node = list->slab != NULL
+                         ? (ListNode *)slab_alloc(list->slab)
+                         : (ListNode *)malloc(sizeof(ListNode));
     if (node == NULL) {
         return NULL;
     }
@@ -52,7 +86,7 @@ static ListNode *listnode_new(ListValue data)
 
 int list_append(List *list, ListValue data)
 {
-    ListNode *node = listnode_new(data);
+    ListNode *node = listnode_new(list, data);
     if (node == NULL) {
         return -1;
     }
@@ -71,7 +105,7 @@ int list_append(List *list, ListValue data)
 
 int list_prepend(List *list, ListValue data)
 {
-    ListNode *node = listnode_new(data);
+    ListNode *node = listnode_new(list, data);
     if (node == NULL) {
         return -1;
     }
@@ -200,7 +234,7 @@ int list_remove_data(List *list, ListEqualFunc callback, ListValue data)
 
     node = list_remove_node(list, node);
     if (node != NULL) {
-        free(node);
+        list_free_node(list, node);
     }
     return 0;
 }
@@ -244,6 +278,7 @@ list_merge(ListNode *head1, ListNode *head2, ListCompareFunc compare_func)
         head2 = head2->next;
     }
 
+    new_head->prev = NULL;
     tmp = new_head;
     while (head1 != NULL && head2 != NULL) {
         if (compare_func(head1->data, head2->data) <= 0) {
@@ -288,6 +323,7 @@ int list_sort(List *list, ListCompareFunc compare_func)
 {
     ListNode *new_head = merge_sort(list->head, compare_func);
     list->head = new_head;
-    list->tail = list_nth_node(list, list->length);
+    list->tail =
+        list->length > 0 ? list_nth_node(list, list->length - 1) : NULL;
     return 0;
 }
@@ -14,6 +14,8 @@
 #ifndef RETHINK_C_LIST_H
 #define RETHINK_C_LIST_H
 
+#include "slab.h"
+
 /**
  * @brief The type of a value to be stored in a @ref List.
  *        (void *) can be changed to int, long, or other types if needed.
@@ -43,6 +45,8 @@ typedef struct _List {
     struct _ListNode *head;
     struct _ListNode *tail;
     unsigned int length;
+    /** The Slab of nodes, NULL if nodes are allocated by malloc. */
+    Slab *slab;
 } List;
 
 /**
@@ -52,6 +56,16 @@ typedef struct _List {
  */
 List *list_new();
 
+/**
+ * @brief Allcate a new List whose nodes are allocated from its own Slab.
+ *
+ * Nodes are packed in pages, and list_free releases them in O(pages).
+ *
+ * @param nodes_per_page    The number of nodes per Slab page, 0 for default.
+ * @return List*            The new List if success, otherwise return NULL.
+ */
+List *list_new_with_slab(unsigned int nodes_per_page);
+
 /**
  * @brief Delete a List and free back memory.
  *
@@ -137,6 +151,14 @@ ListNode *list_find_data(List *list, ListEqualFunc callback, ListValue data);
  */
 ListNode *list_remove_node(List *list, ListNode *node);
 
+/**
+ * @brief Free back a ListNode removed by list_remove_node.
+ *
+ * @param list          The List.
+ * @param node          The ListNode.
+ */
+void list_free_node(List *list, ListNode *node);
+
 /**
  * @brief Remove a ListNode of a value from a List.
  *
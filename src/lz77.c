@@ -0,0 +1,708 @@
+/**
+ * @file lz77.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to lz77.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "lz77.h"
+#include "bitmap.h"
+#include "def.h"
+#include "hash.h"
+#include "huffman.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** The positions of the same hash are chained, 1 << LZ77_HASH_BITS heads. */
+#define LZ77_HASH_BITS 15
+
+/** No position in a chain. */
+#define LZ77_NIL (-1)
+
+/** A match of LZ77_MIN_MATCH is not worth a distance farther than this. */
+#define LZ77_TOO_FAR 4096
+
+/** The code bytes of a value: 16 exact, then 4 a power of 2. */
+#define LZ77_EXACT_CODES 16
+#define LZ77_NUM_CODES 128
+
+/** The streams of a block: literals, runs, lengths and distances. */
+#define LZ77_NUM_STREAMS 4
+
+/** The size of the numbers of sequences and literals, before the streams. */
+#define LZ77_PAYLOAD_HEADER_SIZE 8
+
+/** chain, nice, lazy and good lengths of zlib. */
+static const Lz77Params lz77_levels[LZ77_MAX_LEVEL] = {
+    {LZ77_WINDOW_BITS, 4, 8, 0, 4},
+    {LZ77_WINDOW_BITS, 8, 16, 0, 4},
+    {LZ77_WINDOW_BITS, 32, 32, 0, 4},
+    {LZ77_WINDOW_BITS, 16, 16, 4, 4},
+    {LZ77_WINDOW_BITS, 32, 32, 16, 8},
+    {LZ77_WINDOW_BITS, 128, 128, 16, 8},
+    {LZ77_WINDOW_BITS, 256, 128, 32, 8},
+    {LZ77_WINDOW_BITS, 1024, LZ77_MAX_MATCH, 128, 32},
+    {LZ77_WINDOW_BITS, 4096, LZ77_MAX_MATCH, LZ77_MAX_MATCH, 32},
+};
+
+void lz77_params_from_level(int level, Lz77Params *params)
+{
+    if (level < LZ77_MIN_LEVEL) {
+        level = LZ77_MIN_LEVEL;
+    } else if (level > LZ77_MAX_LEVEL) {
+        level = LZ77_MAX_LEVEL;
+    }
+    *params = lz77_levels[level - 1];
+}
+
+static inline unsigned char *put_uint32(unsigned char *buffer, uint32_t value)
+{
+    buffer[0] = (unsigned char)value;
+    buffer[1] = (unsigned char)(value >> 8);
+    buffer[2] = (unsigned char)(value >> 16);
+    buffer[3] = (unsigned char)(value >> 24);
+    return buffer + 4;
+}
+
+static inline uint32_t get_uint32(const unsigned char *buffer)
+{
+    return buffer[0] | ((uint32_t)buffer[1] << 8) |
+           ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+static inline uint32_t lz77_checksum(const char *data, size_t size)
+{
+    return (uint32_t)hash_bytes64(data, size, 0);
+}
+
+/** the index of the highest set bit, value not 0. */
+static inline unsigned int lz77_highest_bit(uint32_t value)
+{
+#ifdef __GNUC__
+    return 31 - (unsigned int)__builtin_clz(value);
+#else
+    unsigned int n = 0;
+    while (value >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/** the number of trailing zero bits, word not 0. */
+static inline unsigned int lz77_ctz64(uint64_t word)
+{
+#ifdef __GNUC__
+    return (unsigned int)__builtin_ctzll(word);
+#else
+    unsigned int n = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * the code byte of a value and its extra bits: v below 16 is its own code,
+ * otherwise the code tells the highest bit n and the 2 bits below it, the
+ * n - 2 low bits are extra.
+ */
+static inline unsigned int lz77_code(uint32_t value, unsigned int *extra_bits)
+{
+    if (value < LZ77_EXACT_CODES) {
+        *extra_bits = 0;
+        return value;
+    }
+    unsigned int n = lz77_highest_bit(value);
+    *extra_bits = n - 2;
+    return LZ77_EXACT_CODES + (n - 4) * 4 + ((value >> (n - 2)) & 3);
+}
+
+/** the value of a code byte, without its extra bits. */
+static inline uint32_t lz77_code_base(unsigned int code,
+                                      unsigned int *extra_bits)
+{
+    if (code < LZ77_EXACT_CODES) {
+        *extra_bits = 0;
+        return code;
+    }
+    unsigned int n = (code - LZ77_EXACT_CODES) / 4 + 4;
+    *extra_bits = n - 2;
+    return (uint32_t)(4 | ((code - LZ77_EXACT_CODES) % 4)) << (n - 2);
+}
+
+typedef struct _Lz77BitWriter {
+    word_t *words;
+    size_t num_words;
+    size_t capacity;
+    uint64_t buffer;
+    unsigned int count;
+} Lz77BitWriter;
+
+static int lz77_bits_push(Lz77BitWriter *writer, word_t word)
+{
+    if (writer->num_words == writer->capacity) {
+        size_t capacity = writer->capacity == 0 ? 1024 : writer->capacity * 2;
+        word_t *words =
+            (word_t *)realloc(writer->words, sizeof(word_t) * capacity);
+        if (words == NULL) {
+            return -1;
+        }
+        writer->words = words;
+        writer->capacity = capacity;
+    }
+    writer->words[writer->num_words++] = word;
+    return 0;
+}
+
+/** write the n low bits of value, n below 32. */
+static inline int
+lz77_bits_write(Lz77BitWriter *writer, uint32_t value, unsigned int n)
+{
+    if (writer->count + n < BITS_PER_WORD) {
+        writer->buffer |= (uint64_t)value << writer->count;
+        writer->count += n;
+        return 0;
+    }
+    unsigned int used = BITS_PER_WORD - writer->count;
+    writer->buffer |= (uint64_t)value << writer->count;
+    if (lz77_bits_push(writer, writer->buffer) != 0) {
+        return -1;
+    }
+    writer->buffer = (uint64_t)value >> used;
+    writer->count = n - used;
+    return 0;
+}
+
+typedef struct _Lz77BitReader {
+    const unsigned char *data;
+    size_t size;
+    size_t next;
+    uint64_t buffer;
+    unsigned int count;
+    /** bits were read past the end. */
+    int overrun;
+} Lz77BitReader;
+
+/** read n bits, n below 32. */
+static inline uint32_t lz77_bits_read(Lz77BitReader *reader, unsigned int n)
+{
+    if (reader->count >= n) {
+        uint32_t value = (uint32_t)(reader->buffer & ((1ULL << n) - 1));
+        reader->buffer >>= n;
+        reader->count -= n;
+        return value;
+    }
+
+    uint64_t word = 0;
+    if (reader->next + sizeof(uint64_t) <= reader->size) {
+        for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+            word |= (uint64_t)reader->data[reader->next + i] << (i * CHAR_BIT);
+        }
+        reader->next += sizeof(uint64_t);
+    } else {
+        reader->overrun = 1;
+    }
+    unsigned int used = n - reader->count;
+    uint32_t value =
+        (uint32_t)((reader->buffer | word << reader->count) & ((1ULL << n) - 1));
+    reader->buffer = word >> used;
+    reader->count = BITS_PER_WORD - used;
+    return value;
+}
+
+/** The streams of a block being parsed. */
+typedef struct _Lz77Parse {
+    const unsigned char *data;
+    size_t size;
+    const Lz77Params *params;
+    unsigned int window;
+    int32_t *head;
+    int32_t *prev;
+    unsigned int prev_mask;
+    char *literals;
+    size_t num_literals;
+    unsigned char *codes[LZ77_NUM_STREAMS - 1];
+    size_t num_sequences;
+    Lz77BitWriter extra;
+} Lz77Parse;
+
+static inline uint32_t lz77_hash(const unsigned char *p)
+{
+    uint32_t v = p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (v * 2654435761u) >> (32 - LZ77_HASH_BITS);
+}
+
+/** chain position i, which has LZ77_MIN_MATCH bytes. */
+static inline void lz77_insert(Lz77Parse *parse, size_t i)
+{
+    uint32_t h = lz77_hash(parse->data + i);
+    parse->prev[i & parse->prev_mask] = parse->head[h];
+    parse->head[h] = (int32_t)i;
+}
+
+/** the length of the common prefix, at most max. */
+static inline unsigned int lz77_match_length(const unsigned char *a,
+                                             const unsigned char *b,
+                                             unsigned int max)
+{
+    unsigned int n = 0;
+    while (n + sizeof(uint64_t) <= max) {
+        uint64_t x;
+        uint64_t y;
+        memcpy(&x, a + n, sizeof(uint64_t));
+        memcpy(&y, b + n, sizeof(uint64_t));
+        if (x != y) {
+            return n + lz77_ctz64(x ^ y) / CHAR_BIT;
+        }
+        n += sizeof(uint64_t);
+    }
+    while (n < max && a[n] == b[n]) {
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * the longest match at i, longer than best, by the chain of i (i is not
+ * chained yet). Returns its length, or best if none.
+ */
+static unsigned int lz77_longest_match(const Lz77Parse *parse,
+                                       size_t i,
+                                       unsigned int best,
+                                       unsigned int chain,
+                                       unsigned int *distance)
+{
+    size_t left = parse->size - i;
+    unsigned int max = left < LZ77_MAX_MATCH ? (unsigned int)left
+                                             : LZ77_MAX_MATCH;
+    if (max < LZ77_MIN_MATCH || best >= max) {
+        return best;
+    }
+
+    const unsigned char *current = parse->data + i;
+    int32_t candidate = parse->head[lz77_hash(current)];
+    while (candidate != LZ77_NIL && chain-- > 0) {
+        size_t d = i - (size_t)candidate;
+        if (d > parse->window) {
+            break;
+        }
+        const unsigned char *match = parse->data + candidate;
+        /** a longer match has the byte after best equal. */
+        if (match[best] == current[best]) {
+            unsigned int length = lz77_match_length(match, current, max);
+            if (length > best &&
+                (length > LZ77_MIN_MATCH || d <= LZ77_TOO_FAR)) {
+                best = length;
+                *distance = (unsigned int)d;
+                if (length >= parse->params->nice_length || length == max) {
+                    break;
+                }
+            }
+        }
+        int32_t next = parse->prev[candidate & parse->prev_mask];
+        /** the slot was taken by a newer position, out of the window. */
+        if (next >= candidate) {
+            break;
+        }
+        candidate = next;
+    }
+    return best;
+}
+
+static int lz77_put_value(Lz77Parse *parse, int stream, uint32_t value)
+{
+    unsigned int extra_bits;
+    unsigned int code = lz77_code(value, &extra_bits);
+    parse->codes[stream][parse->num_sequences] = (unsigned char)code;
+    if (extra_bits == 0) {
+        return 0;
+    }
+    return lz77_bits_write(
+        &(parse->extra), value & ((1u << extra_bits) - 1), extra_bits);
+}
+
+/** a sequence: the literals before i, then a match at i. */
+static int lz77_put_sequence(Lz77Parse *parse,
+                             size_t literal_start,
+                             size_t i,
+                             unsigned int length,
+                             unsigned int distance)
+{
+    size_t run = i - literal_start;
+    memcpy(parse->literals + parse->num_literals,
+           parse->data + literal_start,
+           run);
+    parse->num_literals += run;
+    if (lz77_put_value(parse, 0, (uint32_t)run) != 0 ||
+        lz77_put_value(parse, 1, length - LZ77_MIN_MATCH) != 0 ||
+        lz77_put_value(parse, 2, distance - 1) != 0) {
+        return -1;
+    }
+    ++parse->num_sequences;
+    return 0;
+}
+
+static int lz77_parse(Lz77Parse *parse)
+{
+    const Lz77Params *params = parse->params;
+    size_t size = parse->size;
+    size_t i = 0;
+    size_t literal_start = 0;
+    /** the last position with LZ77_MIN_MATCH bytes to hash. */
+    size_t end = size >= LZ77_MIN_MATCH ? size - LZ77_MIN_MATCH + 1 : 0;
+
+    while (i < end) {
+        unsigned int distance = 0;
+        unsigned int length = lz77_longest_match(
+            parse, i, LZ77_MIN_MATCH - 1, params->max_chain, &distance);
+        lz77_insert(parse, i);
+
+        /** a longer match at the next position, i stays a literal. */
+        while (length >= LZ77_MIN_MATCH && length < params->lazy_length &&
+               i + 1 < end) {
+            unsigned int chain = length >= params->good_length
+                                     ? (params->max_chain + 3) / 4
+                                     : params->max_chain;
+            unsigned int next_distance = 0;
+            unsigned int next_length = lz77_longest_match(
+                parse, i + 1, length, chain, &next_distance);
+            if (next_length <= length) {
+                break;
+            }
+            ++i;
+            lz77_insert(parse, i);
+            length = next_length;
+            distance = next_distance;
+        }
+
+        if (length < LZ77_MIN_MATCH) {
+            ++i;
+            continue;
+        }
+        if (lz77_put_sequence(parse, literal_start, i, length, distance) !=
+            0) {
+            return -1;
+        }
+
+        /** the fast levels skip the positions in a long match. */
+        size_t match_end = i + length;
+        if (params->lazy_length > 0 || length <= params->nice_length) {
+            for (++i; i < match_end && i < end; ++i) {
+                lz77_insert(parse, i);
+            }
+        }
+        i = match_end;
+        literal_start = i;
+    }
+
+    size_t run = size - literal_start;
+    memcpy(parse->literals + parse->num_literals,
+           parse->data + literal_start,
+           run);
+    parse->num_literals += run;
+    /** the last bits, in a whole word. */
+    if (parse->extra.count > 0 &&
+        lz77_bits_push(&(parse->extra), parse->extra.buffer) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/** write the streams of a parse as a payload, return its size or 0. */
+static size_t lz77_put_payload(const Lz77Parse *parse, unsigned char *output)
+{
+    unsigned char *p = put_uint32(output, (uint32_t)parse->num_sequences);
+    p = put_uint32(p, (uint32_t)parse->num_literals);
+
+    size_t size = huffman_block_encode(parse->literals, parse->num_literals, p);
+    if (size == 0) {
+        return 0;
+    }
+    p += size;
+    for (int s = 0; s < LZ77_NUM_STREAMS - 1; ++s) {
+        size = huffman_block_encode(
+            (const char *)parse->codes[s], parse->num_sequences, p);
+        if (size == 0) {
+            return 0;
+        }
+        p += size;
+    }
+
+    const word_t *words = parse->extra.words;
+    for (size_t i = 0; i < parse->extra.num_words; ++i) {
+        for (size_t b = 0; b < sizeof(word_t); ++b) {
+            *p++ = (unsigned char)(words[i] >> (b * CHAR_BIT));
+        }
+    }
+    return (size_t)(p - output);
+}
+
+/** the size of a payload of no sequence, size + 1 if out of memory. */
+static size_t lz77_literal_payload_size(const char *data, size_t size)
+{
+    uint64_t weights[256];
+    unsigned char lengths[256];
+    huffman_count_weights(data, size, weights);
+    if (huffman_code_lengths(weights, HUFFMAN_BLOCK_CODE_BITS, lengths) != 0) {
+        return size + 1;
+    }
+    BitMap *header = huffman_lengths_deflate(lengths);
+    if (header == NULL) {
+        return size + 1;
+    }
+
+    /** as huffman_block_encode: lengths in whole words, then the codes. */
+    uint64_t code_bits = 0;
+    for (int i = 0; i < 256; ++i) {
+        code_bits += weights[i] * lengths[i];
+    }
+    size_t literal_size =
+        (header->num_bits + BITS_PER_WORD - 1) / BITS_PER_WORD *
+            sizeof(word_t) +
+        (code_bits + CHAR_BIT - 1) / CHAR_BIT;
+    bitmap_free(header);
+    if (literal_size > size) {
+        literal_size = size;
+    }
+    return LZ77_PAYLOAD_HEADER_SIZE +
+           LZ77_NUM_STREAMS * HUFFMAN_BLOCK_HEADER_SIZE + literal_size;
+}
+
+size_t lz77_block_encode(const char *data,
+                         size_t size,
+                         const Lz77Params *params,
+                         unsigned char *output)
+{
+    if (params->window_bits == 0 || params->window_bits > LZ77_MAX_WINDOW_BITS ||
+        params->max_chain == 0) {
+        return 0;
+    }
+
+    Lz77Parse parse;
+    parse.data = (const unsigned char *)data;
+    parse.size = size;
+    parse.params = params;
+    parse.window = 1u << params->window_bits;
+    /** the chain of a window, or of the whole block if smaller. */
+    unsigned int prev_size = 1;
+    while (prev_size < parse.window && prev_size < size) {
+        prev_size <<= 1;
+    }
+    parse.prev_mask = prev_size - 1;
+    parse.head = (int32_t *)malloc(sizeof(int32_t) << LZ77_HASH_BITS);
+    parse.prev = (int32_t *)malloc(sizeof(int32_t) * prev_size);
+    /** a sequence takes LZ77_MIN_MATCH bytes at least. */
+    size_t max_sequences = size / LZ77_MIN_MATCH + 1;
+    parse.literals = (char *)malloc(size + 1);
+    parse.num_literals = 0;
+    parse.codes[0] = (unsigned char *)malloc(max_sequences * 3);
+    parse.num_sequences = 0;
+    memset(&(parse.extra), 0, sizeof(Lz77BitWriter));
+
+    size_t result = 0;
+    unsigned char *payload = NULL;
+    if (parse.head == NULL || parse.prev == NULL || parse.literals == NULL ||
+        parse.codes[0] == NULL) {
+        goto done;
+    }
+    parse.codes[1] = parse.codes[0] + max_sequences;
+    parse.codes[2] = parse.codes[1] + max_sequences;
+    memset(parse.head, 0xFF, sizeof(int32_t) << LZ77_HASH_BITS);
+    if (lz77_parse(&parse) != 0) {
+        goto done;
+    }
+
+    /** straight to output if the streams fit, else stored. */
+    size_t bound = LZ77_PAYLOAD_HEADER_SIZE +
+                   LZ77_NUM_STREAMS * HUFFMAN_BLOCK_HEADER_SIZE +
+                   parse.num_literals +
+                   (LZ77_NUM_STREAMS - 1) * parse.num_sequences +
+                   parse.extra.num_words * sizeof(word_t);
+    size_t payload_size = 0;
+    if (bound < size) {
+        payload_size = lz77_put_payload(
+            &parse, output + HUFFMAN_BLOCK_HEADER_SIZE);
+        if (payload_size == 0) {
+            goto done;
+        }
+    } else {
+        payload = (unsigned char *)malloc(bound);
+        if (payload == NULL) {
+            goto done;
+        }
+        payload_size = lz77_put_payload(&parse, payload);
+        if (payload_size == 0) {
+            goto done;
+        }
+        if (payload_size < size) {
+            memcpy(output + HUFFMAN_BLOCK_HEADER_SIZE, payload, payload_size);
+        }
+    }
+
+    /** all literals, if Huffman coding alone does better than the matches. */
+    size_t literal_size = lz77_literal_payload_size(data, size);
+    if (literal_size < payload_size && literal_size < size) {
+        memcpy(parse.literals, data, size);
+        parse.num_literals = size;
+        parse.num_sequences = 0;
+        parse.extra.num_words = 0;
+        payload_size =
+            lz77_put_payload(&parse, output + HUFFMAN_BLOCK_HEADER_SIZE);
+        if (payload_size == 0) {
+            goto done;
+        }
+    } else if (payload_size >= size) {
+        memcpy(output + HUFFMAN_BLOCK_HEADER_SIZE, data, size);
+        payload_size = size;
+    }
+
+    unsigned char *p = put_uint32(output, (uint32_t)size);
+    p = put_uint32(p, (uint32_t)payload_size);
+    put_uint32(p, lz77_checksum(data, size));
+    result = HUFFMAN_BLOCK_HEADER_SIZE + payload_size;
+
+done:
+    free(payload);
+    free(parse.extra.words);
+    free(parse.codes[0]);
+    free(parse.literals);
+    free(parse.prev);
+    free(parse.head);
+    return result;
+}
+
+/** decode a Huffman block of the payload, of raw_size bytes. */
+static int lz77_get_stream(const unsigned char **p,
+                           const unsigned char *end,
+                           size_t raw_size,
+                           char *output)
+{
+    size_t size;
+    size_t block_size;
+    if (huffman_block_peek(*p, (size_t)(end - *p), &size, &block_size) != 0 ||
+        size != raw_size || block_size > (size_t)(end - *p) ||
+        huffman_block_decode(*p, block_size, output) != 0) {
+        return -1;
+    }
+    *p += block_size;
+    return 0;
+}
+
+/** the value of a code byte and its extra bits, -1 if bad. */
+static inline int64_t lz77_get_value(Lz77BitReader *reader, unsigned int code)
+{
+    if (code >= LZ77_NUM_CODES) {
+        return -1;
+    }
+    unsigned int extra_bits;
+    uint32_t value = lz77_code_base(code, &extra_bits);
+    if (extra_bits > 0) {
+        value += lz77_bits_read(reader, extra_bits);
+    }
+    return value;
+}
+
+int lz77_block_decode(const unsigned char *block,
+                      size_t block_size,
+                      char *output)
+{
+    if (block_size < HUFFMAN_BLOCK_HEADER_SIZE) {
+        return -1;
+    }
+    size_t raw_size = get_uint32(block);
+    size_t payload_size = get_uint32(block + 4);
+    uint32_t checksum = get_uint32(block + 8);
+    const unsigned char *p = block + HUFFMAN_BLOCK_HEADER_SIZE;
+    const unsigned char *end = p + payload_size;
+    if (HUFFMAN_BLOCK_HEADER_SIZE + payload_size != block_size ||
+        payload_size > raw_size) {
+        return -1;
+    }
+    if (payload_size == raw_size) {
+        memcpy(output, p, raw_size);
+        return lz77_checksum(output, raw_size) == checksum ? 0 : -1;
+    }
+    if (payload_size < LZ77_PAYLOAD_HEADER_SIZE) {
+        return -1;
+    }
+
+    size_t num_sequences = get_uint32(p);
+    size_t num_literals = get_uint32(p + 4);
+    p += LZ77_PAYLOAD_HEADER_SIZE;
+    if (num_literals > raw_size ||
+        num_sequences > raw_size / LZ77_MIN_MATCH) {
+        return -1;
+    }
+
+    /** the literals, then the code bytes of runs, lengths and distances. */
+    char *streams = (char *)malloc(num_literals + 3 * num_sequences + 1);
+    if (streams == NULL) {
+        return -1;
+    }
+    const unsigned char *runs =
+        (const unsigned char *)streams + num_literals;
+    const unsigned char *lengths = runs + num_sequences;
+    const unsigned char *distances = lengths + num_sequences;
+    int result = -1;
+    if (lz77_get_stream(&p, end, num_literals, streams) != 0 ||
+        lz77_get_stream(&p, end, num_sequences, (char *)runs) != 0 ||
+        lz77_get_stream(&p, end, num_sequences, (char *)lengths) != 0 ||
+        lz77_get_stream(&p, end, num_sequences, (char *)distances) != 0) {
+        goto done;
+    }
+
+    Lz77BitReader reader = {p, (size_t)(end - p), 0, 0, 0, 0};
+    const char *literals = streams;
+    size_t literals_left = num_literals;
+    char *out = output;
+    size_t left = raw_size;
+    for (size_t s = 0; s < num_sequences; ++s) {
+        int64_t run = lz77_get_value(&reader, runs[s]);
+        int64_t length = lz77_get_value(&reader, lengths[s]);
+        int64_t distance = lz77_get_value(&reader, distances[s]);
+        if (run < 0 || length < 0 || distance < 0 ||
+            (size_t)run > literals_left) {
+            goto done;
+        }
+        length += LZ77_MIN_MATCH;
+        distance += 1;
+        if ((size_t)(run + length) > left ||
+            (size_t)distance > (size_t)(out - output) + (size_t)run) {
+            goto done;
+        }
+
+        memcpy(out, literals, (size_t)run);
+        literals += run;
+        literals_left -= (size_t)run;
+        out += run;
+        const char *match = out - distance;
+        if (distance >= length) {
+            memcpy(out, match, (size_t)length);
+        } else {
+            /** the match overlaps what it writes, a repeat. */
+            for (int64_t i = 0; i < length; ++i) {
+                out[i] = match[i];
+            }
+        }
+        out += length;
+        left -= (size_t)(run + length);
+    }
+    if (reader.overrun || literals_left != left) {
+        goto done;
+    }
+    memcpy(out, literals, left);
+    result = lz77_checksum(output, raw_size) == checksum ? 0 : -1;
+
+done:
+    free(streams);
+    return result;
+}
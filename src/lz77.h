@@ -0,0 +1,132 @@
+/**
+ * @file lz77.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief LZ77 compression of a block, the matches and literals then coded
+ * by Huffman codes.
+ *
+ * A hash chain finds, at each position, the longest earlier match within
+ * the window: the positions of the same 3-byte hash are linked from the
+ * newest, and up to max_chain of them are compared. With lazy matching, a
+ * match is given up for a longer one at the next position. The levels
+ * follow those of zlib. The block is parsed into sequences, each a run of
+ * literals then a match:
+ *
+ *     (literal run, match length, distance) ... trailing literals
+ *
+ * The literals, and a code byte of each run, length and distance, are four
+ * byte streams coded by huffman_block_encode; the low bits of the runs,
+ * lengths and distances which the code bytes leave out go raw in a fifth
+ * stream of extra bits. A block has the header of a Huffman block:
+ *
+ *     block:   [raw_size: u32] [payload_size: u32] [checksum: u32] payload
+ *     payload: [sequences: u32] [literals: u32]
+ *              [literal block] [run block] [length block] [distance block]
+ *              [extra bits: u64 ...]
+ *
+ * or the raw bytes if payload_size == raw_size (LZ77 would not save). If
+ * Huffman coding the block alone is smaller, it has no sequences and all
+ * its bytes are literals.
+ *
+ * refer to: Ziv, Lempel, "A universal algorithm for sequential data
+ * compression", 1977; RFC 1951, DEFLATE.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_LZ77_H
+#define RETHINK_C_LZ77_H
+
+#include <stddef.h>
+
+/**
+ * @brief The shortest match.
+ */
+#define LZ77_MIN_MATCH 3
+
+/**
+ * @brief The longest match.
+ */
+#define LZ77_MAX_MATCH 258
+
+/**
+ * @brief The default window, 32 KB as DEFLATE.
+ */
+#define LZ77_WINDOW_BITS 15
+
+/**
+ * @brief The largest window.
+ */
+#define LZ77_MAX_WINDOW_BITS 24
+
+/**
+ * @brief The levels, from the fastest to the smallest.
+ */
+#define LZ77_MIN_LEVEL 1
+#define LZ77_MAX_LEVEL 9
+
+/**
+ * @brief The default level.
+ */
+#define LZ77_DEFAULT_LEVEL 6
+
+/**
+ * @brief The parameters of the match finder.
+ */
+typedef struct _Lz77Params {
+    /** The window is 1 << window_bits bytes back. */
+    unsigned int window_bits;
+    /** The most positions of a hash chain compared. */
+    unsigned int max_chain;
+    /** A match this long is taken without looking further. */
+    unsigned int nice_length;
+    /**
+     * A match shorter than this may be given up for a longer one at the
+     * next position, 0 to take each match found (greedy).
+     */
+    unsigned int lazy_length;
+    /** Look for a longer match by a quarter of the chain past this. */
+    unsigned int good_length;
+} Lz77Params;
+
+/**
+ * @brief Get the parameters of a level.
+ *
+ * @param level     The level, LZ77_MIN_LEVEL to LZ77_MAX_LEVEL, clamped.
+ * @param params    The parameters, window_bits LZ77_WINDOW_BITS.
+ */
+void lz77_params_from_level(int level, Lz77Params *params);
+
+/**
+ * @brief Compress a block.
+ *
+ * @param data      The raw bytes.
+ * @param size      The raw size, 1 to HUFFMAN_BLOCK_MAX_SIZE.
+ * @param params    The parameters of the match finder.
+ * @param output    The block, huffman_block_bound(size) bytes.
+ * @return size_t   The size of the block, 0 if out of memory or the
+ *                  parameters are bad.
+ */
+size_t lz77_block_encode(const char *data,
+                         size_t size,
+                         const Lz77Params *params,
+                         unsigned char *output);
+
+/**
+ * @brief Decompress a block.
+ *
+ * @param block         The block.
+ * @param block_size    The size of the block, from huffman_block_peek.
+ * @param output        The raw bytes, raw_size of them.
+ * @return int          0 if success, -1 if the block is corrupt or out of
+ *                      memory.
+ */
+int lz77_block_decode(const unsigned char *block,
+                      size_t block_size,
+                      char *output);
+
+#endif /* #ifndef RETHINK_C_LZ77_H */
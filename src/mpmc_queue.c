@@ -0,0 +1,245 @@
+/**
+ * @file mpmc_queue.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to mpmc_queue.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "mpmc_queue.h"
+#include "def.h"
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/** Enqueue and dequeue counters are padded to separate cache lines. */
+#define MPMC_QUEUE_PADDING 128
+
+/** Spins on a claimed cell before yielding the CPU to its owner. */
+#define MPMC_QUEUE_SPINS 64
+
+/**
+ * A cell of lap L at index i is free for the producer of position
+ * L * capacity + i when sequence equals that position, and holds its value
+ * for the consumer when sequence equals position + 1.
+ */
+typedef struct _MpmcQueueCell {
+    atomic_size_t sequence;
+    QueueValue data;
+} MpmcQueueCell;
+
+struct _MpmcQueue {
+    /** read only after creation. */
+    MpmcQueueCell *cells;
+    size_t mask;
+    char padding0[MPMC_QUEUE_PADDING - sizeof(MpmcQueueCell *) -
+                  sizeof(size_t)];
+
+    atomic_size_t enqueue_pos;
+    char padding1[MPMC_QUEUE_PADDING - sizeof(size_t)];
+
+    atomic_size_t dequeue_pos;
+    char padding2[MPMC_QUEUE_PADDING - sizeof(size_t)];
+};
+
+MpmcQueue *mpmc_queue_new(unsigned int capacity)
+{
+    if (capacity > (~0u >> 1) + 1) {
+        return NULL;
+    }
+
+    MpmcQueue *queue = (MpmcQueue *)malloc(sizeof(MpmcQueue));
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    queue->cells = (MpmcQueueCell *)malloc(sizeof(MpmcQueueCell) * size);
+    if (queue->cells == NULL) {
+        free(queue);
+        return NULL;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        atomic_init(&(queue->cells[i].sequence), i);
+    }
+    queue->mask = size - 1;
+    atomic_init(&(queue->enqueue_pos), 0);
+    atomic_init(&(queue->dequeue_pos), 0);
+    return queue;
+}
+
+void mpmc_queue_free(MpmcQueue *queue)
+{
+    free(queue->cells);
+    free(queue);
+}
+
+/** wait until a claimed cell reaches sequence, its owner is in flight. */
+static void mpmc_queue_wait(MpmcQueueCell *cell, size_t sequence)
+{
+    int spins = 0;
+    while (atomic_load_explicit(&(cell->sequence), memory_order_acquire) !=
+           sequence) {
+        if (++spins == MPMC_QUEUE_SPINS) {
+            spins = 0;
+            sched_yield();
+        }
+    }
+}
+
+int mpmc_queue_push(MpmcQueue *queue, QueueValue data)
+{
+    MpmcQueueCell *cell;
+    size_t pos =
+        atomic_load_explicit(&(queue->enqueue_pos), memory_order_relaxed);
+    for (;;) {
+        cell = &(queue->cells[pos & queue->mask]);
+        size_t sequence =
+            atomic_load_explicit(&(cell->sequence), memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(sequence - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&(queue->enqueue_pos),
+                                                      &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // full, the cell of last lap is not popped yet
+        } else {
+            pos = atomic_load_explicit(&(queue->enqueue_pos),
+                                       memory_order_relaxed);
+        }
+    }
+
+    cell->data = data;
+    atomic_store_explicit(&(cell->sequence), pos + 1, memory_order_release);
+    return 0;
+}
+
+int mpmc_queue_pop(MpmcQueue *queue, QueueValue *data)
+{
+    MpmcQueueCell *cell;
+    size_t pos =
+        atomic_load_explicit(&(queue->dequeue_pos), memory_order_relaxed);
+    for (;;) {
+        cell = &(queue->cells[pos & queue->mask]);
+        size_t sequence =
+            atomic_load_explicit(&(cell->sequence), memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(sequence - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&(queue->dequeue_pos),
+                                                      &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // empty, the cell is not pushed yet
+        } else {
+            pos = atomic_load_explicit(&(queue->dequeue_pos),
+                                       memory_order_relaxed);
+        }
+    }
+
+    *data = cell->data;
+    atomic_store_explicit(
+        &(cell->sequence), pos + queue->mask + 1, memory_order_release);
+    return 0;
+}
+
+unsigned int mpmc_queue_push_many(MpmcQueue *queue,
+                                  const QueueValue *data,
+                                  unsigned int count)
+{
+    size_t capacity = queue->mask + 1;
+    size_t pos =
+        atomic_load_explicit(&(queue->enqueue_pos), memory_order_relaxed);
+    size_t claimed;
+    do {
+        /** cells before dequeue_pos are claimed by consumers, so the cells
+         * up to dequeue_pos + capacity will be free soon. */
+        size_t dequeue_pos =
+            atomic_load_explicit(&(queue->dequeue_pos), memory_order_acquire);
+        ptrdiff_t used = (ptrdiff_t)(pos - dequeue_pos);
+        if (used < 0) {
+            used = 0; // pos is stale, the CAS will fail
+        }
+        claimed = capacity - (size_t)used;
+        if (claimed > count) {
+            claimed = count;
+        }
+        if (claimed == 0) {
+            return 0;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&(queue->enqueue_pos),
+                                                    &pos,
+                                                    pos + claimed,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    for (size_t i = 0; i < claimed; ++i) {
+        MpmcQueueCell *cell = &(queue->cells[(pos + i) & queue->mask]);
+        mpmc_queue_wait(cell, pos + i);
+        cell->data = data[i];
+        atomic_store_explicit(
+            &(cell->sequence), pos + i + 1, memory_order_release);
+    }
+    return (unsigned int)claimed;
+}
+
+unsigned int
+mpmc_queue_pop_many(MpmcQueue *queue, QueueValue *data, unsigned int count)
+{
+    size_t pos =
+        atomic_load_explicit(&(queue->dequeue_pos), memory_order_relaxed);
+    size_t claimed;
+    do {
+        size_t enqueue_pos =
+            atomic_load_explicit(&(queue->enqueue_pos), memory_order_acquire);
+        ptrdiff_t available = (ptrdiff_t)(enqueue_pos - pos);
+        if (available <= 0) {
+            return 0;
+        }
+        claimed = (size_t)available < count ? (size_t)available : count;
+    } while (!atomic_compare_exchange_weak_explicit(&(queue->dequeue_pos),
+                                                    &pos,
+                                                    pos + claimed,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    for (size_t i = 0; i < claimed; ++i) {
+        MpmcQueueCell *cell = &(queue->cells[(pos + i) & queue->mask]);
+        mpmc_queue_wait(cell, pos + i + 1);
+        data[i] = cell->data;
+        atomic_store_explicit(
+            &(cell->sequence), pos + i + queue->mask + 1, memory_order_release);
+    }
+    return (unsigned int)claimed;
+}
+
+unsigned int mpmc_queue_capacity(const MpmcQueue *queue)
+{
+    return (unsigned int)(queue->mask + 1);
+}
+
+unsigned int mpmc_queue_length(MpmcQueue *queue)
+{
+    size_t dequeue_pos =
+        atomic_load_explicit(&(queue->dequeue_pos), memory_order_acquire);
+    size_t enqueue_pos =
+        atomic_load_explicit(&(queue->enqueue_pos), memory_order_acquire);
+    ptrdiff_t length = (ptrdiff_t)(enqueue_pos - dequeue_pos);
+    return length > 0 ? (unsigned int)length : 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file mpmc_queue.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Lock-free bounded queue for many producers and many consumers.
+ *
+ * A ring of cells, each with a sequence number telling which lap of the
+ * ring may write or read it next (Dmitry Vyukov's bounded MPMC queue).
+ * Producers claim cells by a CAS on the enqueue counter and consumers on
+ * the dequeue counter, the two counters live on separate cache lines, so
+ * producers and consumers only meet on the cells.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_MPMC_QUEUE_H
+#define RETHINK_C_MPMC_QUEUE_H
+
+#include "queue.h"
+
+/**
+ * @brief Definition of a @ref MpmcQueue.
+ *
+ */
+typedef struct _MpmcQueue MpmcQueue;
+
+/**
+ * @brief Allcate a new MpmcQueue.
+ *
+ * @param capacity      The capacity, rounded up to a power of two, at least 2.
+ * @return MpmcQueue*   The new MpmcQueue if success, otherwise return NULL.
+ */
+MpmcQueue *mpmc_queue_new(unsigned int capacity);
+
+/**
+ * @brief Delete a MpmcQueue and free back memory, no thread may use it.
+ *
+ * @param queue  The MpmcQueue to delete.
+ */
+void mpmc_queue_free(MpmcQueue *queue);
+
+/**
+ * @brief Push a value to the tail of a MpmcQueue.
+ *
+ * @param queue     The MpmcQueue.
+ * @param data      The value to push.
+ * @return int      0 if success, -1 if full.
+ */
+int mpmc_queue_push(MpmcQueue *queue, QueueValue data);
+
+/**
+ * @brief Pop the head value of a MpmcQueue.
+ *
+ * @param queue     The MpmcQueue.
+ * @param data      The output value.
+ * @return int      0 if success, -1 if empty.
+ */
+int mpmc_queue_pop(MpmcQueue *queue, QueueValue *data);
+
+/**
+ * @brief Push at most count values to a MpmcQueue.
+ *
+ * The cells are claimed by a single CAS, and stay contiguous in the queue.
+ * Mind: this blocks, not lock-free: after the claim, each cell still being
+ * read by a consumer of the previous lap is waited for, so a stalled
+ * consumer stalls the batch.
+ *
+ * @param queue             The MpmcQueue.
+ * @param data              The values.
+ * @param count             The number of values.
+ * @return unsigned int     The number of pushed values, less than count if
+ *                          the MpmcQueue is full.
+ */
+unsigned int mpmc_queue_push_many(MpmcQueue *queue,
+                                  const QueueValue *data,
+                                  unsigned int count);
+
+/**
+ * @brief Pop at most count values from a MpmcQueue.
+ *
+ * The cells are claimed by a single CAS, and stay contiguous in the queue.
+ * Mind: this blocks, not lock-free: after the claim, each cell still being
+ * written by its producer is waited for, so a stalled producer stalls the
+ * batch.
+ *
+ * @param queue             The MpmcQueue.
+ * @param data              The output values, in queue order.
+ * @param count             The max number of values.
+ * @return unsigned int     The number of popped values.
+ */
+unsigned int
+mpmc_queue_pop_many(MpmcQueue *queue, QueueValue *data, unsigned int count);
+
+/**
+ * @brief Get the capacity of a MpmcQueue.
+ *
+ * @param queue             The MpmcQueue.
+ * @return unsigned int     The capacity.
+ */
+unsigned int mpmc_queue_capacity(const MpmcQueue *queue);
+
+/**
+ * @brief Get the number of values in a MpmcQueue.
+ *
+ * Only a snapshot if other threads are running, claimed but unfinished
+ * cells are counted.
+ *
+ * @param queue             The MpmcQueue.
+ * @return unsigned int     The length.
+ */
+unsigned int mpmc_queue_length(MpmcQueue *queue);
+
+#endif /* #ifndef RETHINK_C_MPMC_QUEUE_H */
@@ -11,6 +11,10 @@
 #include "prime.h"
 #include "def.h"
 #include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
 
 static inline unsigned int bit_map_index_to_number(unsigned int n)
 {
@@ -46,10 +50,12 @@ BitMap *prime_number_sieve(unsigned int max_number)
 
         /** each time start from base_prime * base_prime, sieve 3 * 3 first,
          * etc. */
-        unsigned int composite = base_prime * base_prime;
+        /** 64 bits, or composite wraps around for max_number near 2^32. */
+        uint64_t composite = (uint64_t)base_prime * base_prime;
         while (composite <= max_number) {
             /** sieve prime */
-            unsigned int index = bit_map_number_to_index(composite);
+            unsigned int index =
+                bit_map_number_to_index((unsigned int)composite);
             bitmap_clear(sieve, index);
             composite += (base_prime + base_prime); /** skip even number */
         }
@@ -79,3 +85,731 @@ void prime_number_sieve_free(BitMap *sieve)
 {
     bitmap_free(sieve);
 }
+
+/** Consecutive windows a thread sieves from one claim when counting. */
+#define PRIME_SEGMENTS_PER_CLAIM 16
+
+#define PRIME_SEGMENT_WORDS (PRIME_SEGMENT_BITS / BITS_PER_WORD)
+
+/**
+ * The odd primes up to this, which may hit a window more than once, are kept
+ * with their next multiple from window to window. The larger ones up to
+ * sqrt(hi) are sieved again, block by block, for each claim of windows.
+ */
+#define PRIME_CARRIED_LIMIT (2 * (uint64_t)PRIME_SEGMENT_BITS)
+
+typedef struct _PrimeSegmentedSieve {
+    /** The odd numbers first, first + 2, ... below hi are sieved. */
+    uint64_t first;
+    uint64_t hi;
+    uint64_t num_segments;
+    /** The odd primes up to sqrt(hi) and PRIME_CARRIED_LIMIT. */
+    uint32_t *primes;
+    size_t num_primes;
+    /** 1 if there are primes up to sqrt(hi) past PRIME_CARRIED_LIMIT. */
+    int streamed;
+    /** 1 with a callback to stop soon after it asks, unless streamed. */
+    unsigned int segments_per_claim;
+    PrimeCallback callback;
+    void *args;
+
+    atomic_uint_fast64_t next_claim;
+    atomic_int stop;
+    atomic_int out_of_memory;
+    atomic_int_fast64_t count;
+
+    /** The window whose primes are passed to callback next. */
+    uint64_t next_segment;
+    pthread_mutex_t lock;
+    pthread_cond_t turn;
+} PrimeSegmentedSieve;
+
+/** the integer square root, rounded down. */
+static uint64_t isqrt64(uint64_t n)
+{
+    uint64_t root = (uint64_t)sqrt((double)n);
+    while (root > 0 && (root > UINT32_MAX || root * root > n)) {
+        --root;
+    }
+    while (root < UINT32_MAX && (root + 1) * (root + 1) <= n) {
+        ++root;
+    }
+    return root;
+}
+
+/** the odd primes p, p * p < hi, up to PRIME_CARRIED_LIMIT. */
+static int prime_base_primes(PrimeSegmentedSieve *sieve)
+{
+    sieve->primes = NULL;
+    sieve->num_primes = 0;
+    uint64_t limit = isqrt64(sieve->hi - 1);
+    sieve->streamed = limit > PRIME_CARRIED_LIMIT;
+    if (limit > PRIME_CARRIED_LIMIT) {
+        limit = PRIME_CARRIED_LIMIT;
+    }
+    if (limit < 3) {
+        return 0;
+    }
+
+    BitMap *base = prime_number_sieve((unsigned int)limit);
+    if (base == NULL) {
+        return -1;
+    }
+    sieve->primes = (uint32_t *)malloc(sizeof(uint32_t) *
+                                       (prime_number_sieve_count(base) - 1));
+    if (sieve->primes == NULL) {
+        prime_number_sieve_free(base);
+        return -1;
+    }
+    for (unsigned int i = bitmap_first_set(base); i != BITMAP_NOT_FOUND;
+         i = bitmap_next_set(base, i + 1)) {
+        sieve->primes[sieve->num_primes++] = bit_map_index_to_number(i);
+    }
+    prime_number_sieve_free(base);
+    return 0;
+}
+
+/** the index of the first odd multiple of prime to cross from segment_lo. */
+static inline uint64_t
+prime_first_index(uint64_t prime, uint64_t segment_lo)
+{
+    uint64_t square = prime * prime;
+    if (square >= segment_lo) {
+        return (square - segment_lo) / 2;
+    }
+    uint64_t remainder = segment_lo % prime;
+    uint64_t offset = remainder == 0 ? 0 : prime - remainder;
+    /** segment_lo and prime are odd, so an odd offset hits an even number. */
+    if (offset & 1) {
+        offset += prime;
+    }
+    return offset / 2;
+}
+
+/** clear the bits from length to the end of its word. */
+static inline void prime_clear_tail(word_t *words, unsigned int length)
+{
+    for (unsigned int i = length; i % BITS_PER_WORD != 0; ++i) {
+        words[i / BITS_PER_WORD] &= ~((word_t)1 << (i % BITS_PER_WORD));
+    }
+}
+
+/**
+ * cross off the multiples of the odd primes past PRIME_CARRIED_LIMIT, up to
+ * the square root of the last number, in the length odd numbers from lo.
+ * The primes are found a block at a time by the carried primes.
+ */
+static void prime_cross_streamed(const PrimeSegmentedSieve *sieve,
+                                 word_t *block,
+                                 word_t *words,
+                                 uint64_t lo,
+                                 uint64_t length)
+{
+    uint64_t root = isqrt64(lo + 2 * (length - 1));
+    for (uint64_t block_lo = PRIME_CARRIED_LIMIT + 1; block_lo <= root;
+         block_lo += 2 * (uint64_t)PRIME_SEGMENT_BITS) {
+        uint64_t remaining = (root - block_lo) / 2 + 1;
+        unsigned int block_length = remaining < PRIME_SEGMENT_BITS
+                                        ? (unsigned int)remaining
+                                        : PRIME_SEGMENT_BITS;
+        uint64_t block_last = block_lo + 2 * (uint64_t)(block_length - 1);
+
+        memset(block, 0xFF, sizeof(word_t) * PRIME_SEGMENT_WORDS);
+        for (size_t i = 0; i < sieve->num_primes &&
+                           (uint64_t)sieve->primes[i] * sieve->primes[i] <=
+                               block_last;
+             ++i) {
+            uint64_t prime = sieve->primes[i];
+            for (uint64_t index = prime_first_index(prime, block_lo);
+                 index < block_length;
+                 index += prime) {
+                block[index / BITS_PER_WORD] &=
+                    ~((word_t)1 << (index % BITS_PER_WORD));
+            }
+        }
+        prime_clear_tail(block, block_length);
+
+        BitMap primes;
+        primes.words = block;
+        primes.num_bits = block_length;
+        primes.num_words = (block_length + BITS_PER_WORD - 1) / BITS_PER_WORD;
+        primes.capacity = PRIME_SEGMENT_WORDS;
+        for (unsigned int i = bitmap_first_set(&primes); i != BITMAP_NOT_FOUND;
+             i = bitmap_next_set(&primes, i + 1)) {
+            uint64_t prime = block_lo + 2 * (uint64_t)i;
+            for (uint64_t index = prime_first_index(prime, lo); index < length;
+                 index += prime) {
+                words[index / BITS_PER_WORD] &=
+                    ~((word_t)1 << (index % BITS_PER_WORD));
+            }
+        }
+    }
+}
+
+/** pass the primes of a sieved window to callback, in window order. */
+static void prime_emit_segment(PrimeSegmentedSieve *sieve,
+                               const BitMap *window,
+                               uint64_t segment,
+                               uint64_t segment_lo)
+{
+    int64_t count = 0;
+    pthread_mutex_lock(&(sieve->lock));
+    while (sieve->next_segment != segment && !atomic_load(&(sieve->stop))) {
+        pthread_cond_wait(&(sieve->turn), &(sieve->lock));
+    }
+    if (!atomic_load(&(sieve->stop))) {
+        for (unsigned int i = bitmap_first_set(window); i != BITMAP_NOT_FOUND;
+             i = bitmap_next_set(window, i + 1)) {
+            ++count;
+            if (sieve->callback(segment_lo + 2 * (uint64_t)i, sieve->args) !=
+                0) {
+                atomic_store(&(sieve->stop), 1);
+                break;
+            }
+        }
+    }
+    ++(sieve->next_segment);
+    pthread_cond_broadcast(&(sieve->turn));
+    pthread_mutex_unlock(&(sieve->lock));
+    atomic_fetch_add(&(sieve->count), count);
+}
+
+static void *prime_sieve_worker(void *arg)
+{
+    PrimeSegmentedSieve *sieve = (PrimeSegmentedSieve *)arg;
+    /** with streamed primes, all windows of a claim are sieved at once. */
+    unsigned int num_windows = sieve->streamed ? sieve->segments_per_claim : 1;
+    word_t *words = (word_t *)malloc(sizeof(word_t) * PRIME_SEGMENT_WORDS *
+                                     num_windows);
+    word_t *block = NULL;
+    if (sieve->streamed) {
+        block = (word_t *)malloc(sizeof(word_t) * PRIME_SEGMENT_WORDS);
+    }
+    /** the index of the next multiple of each prime in the window. */
+    uint64_t *next =
+        (uint64_t *)malloc(sizeof(uint64_t) * (sieve->num_primes + 1));
+    if (words == NULL || next == NULL || (sieve->streamed && block == NULL)) {
+        atomic_store(&(sieve->out_of_memory), 1);
+        atomic_store(&(sieve->stop), 1);
+        pthread_mutex_lock(&(sieve->lock));
+        pthread_cond_broadcast(&(sieve->turn));
+        pthread_mutex_unlock(&(sieve->lock));
+        free(next);
+        free(block);
+        free(words);
+        return NULL;
+    }
+
+    int64_t count = 0;
+    while (!atomic_load(&(sieve->stop))) {
+        uint64_t segment = atomic_fetch_add(&(sieve->next_claim), 1) *
+                           sieve->segments_per_claim;
+        if (segment >= sieve->num_segments) {
+            break;
+        }
+        uint64_t end = segment + sieve->segments_per_claim;
+        if (end > sieve->num_segments) {
+            end = sieve->num_segments;
+        }
+
+        /** primes join as their squares come in range. */
+        size_t active = 0;
+        uint64_t segment_lo =
+            sieve->first + segment * 2 * (uint64_t)PRIME_SEGMENT_BITS;
+        while (segment < end) {
+            uint64_t batch_lo = segment_lo;
+            uint64_t batch_length = 0;
+            unsigned int batch = 0;
+            for (; batch < num_windows && segment + batch < end; ++batch) {
+                word_t *window_words = words + batch * PRIME_SEGMENT_WORDS;
+                uint64_t remaining = (sieve->hi - segment_lo + 1) / 2;
+                unsigned int length = remaining < PRIME_SEGMENT_BITS
+                                          ? (unsigned int)remaining
+                                          : PRIME_SEGMENT_BITS;
+                uint64_t segment_last =
+                    segment_lo + 2 * (uint64_t)(length - 1);
+                while (active < sieve->num_primes &&
+                       (uint64_t)sieve->primes[active] *
+                               sieve->primes[active] <=
+                           segment_last) {
+                    next[active] =
+                        prime_first_index(sieve->primes[active], segment_lo);
+                    ++active;
+                }
+
+                memset(window_words,
+                       0xFF,
+                       sizeof(word_t) * PRIME_SEGMENT_WORDS);
+                for (size_t i = 0; i < active; ++i) {
+                    uint64_t prime = sieve->primes[i];
+                    uint64_t index = next[i];
+                    for (; index < length; index += prime) {
+                        window_words[index / BITS_PER_WORD] &=
+                            ~((word_t)1 << (index % BITS_PER_WORD));
+                    }
+                    next[i] = index - length;
+                }
+                /** clear the bits past the range in the last window. */
+                prime_clear_tail(window_words, length);
+                batch_length += length;
+                segment_lo += 2 * (uint64_t)PRIME_SEGMENT_BITS;
+            }
+            if (sieve->streamed) {
+                prime_cross_streamed(
+                    sieve, block, words, batch_lo, batch_length);
+            }
+
+            for (unsigned int w = 0; w < batch; ++w, ++segment) {
+                uint64_t remaining =
+                    batch_length - w * (uint64_t)PRIME_SEGMENT_BITS;
+                unsigned int length = remaining < PRIME_SEGMENT_BITS
+                                          ? (unsigned int)remaining
+                                          : PRIME_SEGMENT_BITS;
+                /** a BitMap over the window, bit i is its lo + 2 * i. */
+                BitMap window;
+                window.words = words + w * PRIME_SEGMENT_WORDS;
+                window.num_bits = length;
+                window.num_words = (length + BITS_PER_WORD - 1) / BITS_PER_WORD;
+                window.capacity = PRIME_SEGMENT_WORDS;
+                if (sieve->callback == NULL) {
+                    count += bitmap_count(&window);
+                } else {
+                    prime_emit_segment(
+                        sieve,
+                        &window,
+                        segment,
+                        batch_lo + w * 2 * (uint64_t)PRIME_SEGMENT_BITS);
+                }
+            }
+            if (atomic_load(&(sieve->stop))) {
+                break;
+            }
+        }
+    }
+
+    atomic_fetch_add(&(sieve->count), count);
+    free(next);
+    free(block);
+    free(words);
+    return NULL;
+}
+
+int64_t prime_segmented_sieve(uint64_t lo,
+                              uint64_t hi,
+                              unsigned int num_threads,
+                              PrimeCallback callback,
+                              void *args)
+{
+    int64_t count = 0;
+    if (lo <= 2 && hi > 2) {
+        ++count;
+        if (callback != NULL && callback(2, args) != 0) {
+            return count;
+        }
+    }
+    uint64_t first = lo < 3 ? 3 : (lo | 1);
+    if (first >= hi) {
+        return count;
+    }
+
+    PrimeSegmentedSieve sieve;
+    sieve.first = first;
+    sieve.hi = hi;
+    uint64_t num_odds = (hi - first + 1) / 2;
+    sieve.num_segments =
+        (num_odds + PRIME_SEGMENT_BITS - 1) / PRIME_SEGMENT_BITS;
+    sieve.callback = callback;
+    sieve.args = args;
+    atomic_init(&(sieve.next_claim), 0);
+    atomic_init(&(sieve.stop), 0);
+    atomic_init(&(sieve.out_of_memory), 0);
+    atomic_init(&(sieve.count), count);
+    sieve.next_segment = 0;
+    if (prime_base_primes(&sieve) != 0) {
+        return -1;
+    }
+    /** streamed primes are sieved once a claim, so claim more windows. */
+    sieve.segments_per_claim = callback == NULL || sieve.streamed
+                                   ? PRIME_SEGMENTS_PER_CLAIM
+                                   : 1;
+    pthread_mutex_init(&(sieve.lock), NULL);
+    pthread_cond_init(&(sieve.turn), NULL);
+
+    if (num_threads > sieve.num_segments) {
+        num_threads = (unsigned int)sieve.num_segments;
+    }
+    if (num_threads <= 1) {
+        prime_sieve_worker(&sieve);
+    } else {
+        pthread_t *threads =
+            (pthread_t *)malloc(sizeof(pthread_t) * num_threads);
+        unsigned int started = 0;
+        if (threads != NULL) {
+            for (; started < num_threads; ++started) {
+                if (pthread_create(&threads[started],
+                                   NULL,
+                                   prime_sieve_worker,
+                                   &sieve) != 0) {
+                    break;
+                }
+            }
+        }
+        /** the calling thread alone if no thread could start. */
+        if (started == 0) {
+            prime_sieve_worker(&sieve);
+        }
+        for (unsigned int t = 0; t < started; ++t) {
+            pthread_join(threads[t], NULL);
+        }
+        free(threads);
+    }
+
+    pthread_cond_destroy(&(sieve.turn));
+    pthread_mutex_destroy(&(sieve.lock));
+    free(sieve.primes);
+    if (atomic_load(&(sieve.out_of_memory))) {
+        return -1;
+    }
+    return atomic_load(&(sieve.count));
+}
+
+int64_t
+prime_segmented_count(uint64_t lo, uint64_t hi, unsigned int num_threads)
+{
+    return prime_segmented_sieve(lo, hi, num_threads, NULL, NULL);
+}
+
+/** The numbers prime to 30 in [0, 30), bit i of a wheel byte is RESIDUES[i]. */
+static const unsigned char PRIME_WHEEL_RESIDUES[8] = {
+    1, 7, 11, 13, 17, 19, 23, 29};
+
+/** the wheel bit of r in [0, 30), 8 if r is not prime to 30. */
+static const unsigned char PRIME_WHEEL_INDEX[30] = {
+    8, 0, 8, 8, 8, 8, 8, 1, 8, 8, 8, 2, 8, 3, 8,
+    8, 8, 4, 8, 5, 8, 8, 8, 6, 8, 8, 8, 8, 8, 7};
+
+/** the number of residues prime to 30 in [0, r], r in [0, 30). */
+static const unsigned char PRIME_WHEEL_RANK[30] = {
+    0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 4,
+    4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 8};
+
+/** pi(n) for n < 7, below the wheel. */
+static const unsigned char PRIME_SMALL_COUNTS[7] = {0, 0, 1, 2, 2, 3, 3};
+
+#define PRIME_WHEEL_WORDS_PER_BLOCK 8
+
+/** the number of the wheel bit n. */
+static inline uint64_t prime_wheel_number(uint64_t n)
+{
+    return n / 8 * 30 + PRIME_WHEEL_RESIDUES[n % 8];
+}
+
+static inline unsigned int popcount_wheel_word(word_t word)
+{
+    return count_bitmap(&word, 1);
+}
+
+/** the index of the rank-th (from 0) 1 bit of word. */
+static inline unsigned int select_wheel_word(word_t word, unsigned int rank)
+{
+    for (unsigned int i = 0; i < rank; ++i) {
+        word &= word - 1;
+    }
+#ifdef __GNUC__
+    return (unsigned int)__builtin_ctzll(word);
+#else
+    unsigned int n = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/** cross off the multiples of the primes 7 to sqrt(limit), window by window
+ * to stay in the L1 cache. */
+static int prime_wheel_sieve(PrimeWheel *wheel)
+{
+    uint64_t root = isqrt64(wheel->limit);
+    if (root < 7) {
+        return 0;
+    }
+    BitMap *base = prime_number_sieve((unsigned int)root);
+    if (base == NULL) {
+        return -1;
+    }
+    /** from 7, the 2nd odd prime after 3. */
+    unsigned int num_primes = prime_number_sieve_count(base) - 3;
+    uint32_t *primes = (uint32_t *)malloc(sizeof(uint32_t) * num_primes);
+    /** the next wheel bit to cross of each prime, one per residue. */
+    uint64_t *next = (uint64_t *)malloc(sizeof(uint64_t) * 8 * num_primes);
+    if (primes == NULL || next == NULL) {
+        free(next);
+        free(primes);
+        prime_number_sieve_free(base);
+        return -1;
+    }
+    unsigned int n = 0;
+    for (unsigned int i = bitmap_next_set(base, bit_map_number_to_index(7));
+         i != BITMAP_NOT_FOUND;
+         i = bitmap_next_set(base, i + 1)) {
+        primes[n++] = bit_map_index_to_number(i);
+    }
+    prime_number_sieve_free(base);
+
+    uint64_t num_bits = wheel->num_words * BITS_PER_WORD;
+    unsigned int active = 0;
+    for (uint64_t lo = 0; lo < num_bits;
+         lo += PRIME_SEGMENT_WORDS * BITS_PER_WORD) {
+        uint64_t hi = lo + PRIME_SEGMENT_WORDS * BITS_PER_WORD;
+        if (hi > num_bits) {
+            hi = num_bits;
+        }
+        /** a prime joins when its square, the first multiple to cross, is
+         * in the window; p * q for q prime to 30 steps 8p bits a residue. */
+        while (active < num_primes &&
+               (uint64_t)primes[active] * primes[active] < hi / 8 * 30) {
+            uint64_t prime = primes[active];
+            for (int r = 0; r < 8; ++r) {
+                uint64_t q = prime - prime % 30 + PRIME_WHEEL_RESIDUES[r];
+                if (q < prime) {
+                    q += 30;
+                }
+                uint64_t multiple = prime * q;
+                next[8 * active + r] =
+                    multiple / 30 * 8 + PRIME_WHEEL_INDEX[multiple % 30];
+            }
+            ++active;
+        }
+        word_t *words = wheel->words;
+        for (unsigned int i = 0; i < active; ++i) {
+            uint64_t step = 8 * (uint64_t)primes[i];
+            for (int r = 0; r < 8; ++r) {
+                uint64_t bit = next[8 * i + r];
+                for (; bit < hi; bit += step) {
+                    words[bit / BITS_PER_WORD] &=
+                        ~((word_t)1 << (bit % BITS_PER_WORD));
+                }
+                next[8 * i + r] = bit;
+            }
+        }
+    }
+
+    free(next);
+    free(primes);
+    return 0;
+}
+
+PrimeWheel *prime_wheel_new(uint64_t limit)
+{
+    PrimeWheel *wheel = (PrimeWheel *)malloc(sizeof(PrimeWheel));
+    if (wheel == NULL) {
+        return NULL;
+    }
+    wheel->limit = limit;
+    uint64_t num_bytes = limit / 30 + 1;
+    wheel->num_words = (num_bytes + 7) / 8;
+    /** one more block count, for a count which ends on the last word. */
+    uint64_t num_blocks = wheel->num_words / PRIME_WHEEL_WORDS_PER_BLOCK + 1;
+    wheel->words = (word_t *)malloc(sizeof(word_t) * wheel->num_words);
+    wheel->block_counts = (uint64_t *)malloc(sizeof(uint64_t) * num_blocks);
+    if (wheel->words == NULL || wheel->block_counts == NULL) {
+        prime_wheel_free(wheel);
+        return NULL;
+    }
+    memset(wheel->words, 0xFF, sizeof(word_t) * wheel->num_words);
+    if (prime_wheel_sieve(wheel) != 0) {
+        prime_wheel_free(wheel);
+        return NULL;
+    }
+
+    /** 1 is not prime, nor the numbers past limit in the last word. */
+    wheel->words[0] &= ~(word_t)1;
+    uint64_t num_bits = wheel->num_words * BITS_PER_WORD;
+    for (uint64_t n = (limit / 30) * 8; n < num_bits; ++n) {
+        if (prime_wheel_number(n) > limit) {
+            wheel->words[n / BITS_PER_WORD] &=
+                ~((word_t)1 << (n % BITS_PER_WORD));
+        }
+    }
+
+    uint64_t count = 0;
+    for (uint64_t block = 0; block < num_blocks; ++block) {
+        wheel->block_counts[block] = count;
+        uint64_t first = block * PRIME_WHEEL_WORDS_PER_BLOCK;
+        if (first < wheel->num_words) {
+            uint64_t len = wheel->num_words - first;
+            if (len > PRIME_WHEEL_WORDS_PER_BLOCK) {
+                len = PRIME_WHEEL_WORDS_PER_BLOCK;
+            }
+            count += count_bitmap(&(wheel->words[first]), (unsigned int)len);
+        }
+    }
+    wheel->num_primes =
+        count + (limit >= 2) + (limit >= 3) + (limit >= 5);
+    return wheel;
+}
+
+void prime_wheel_free(PrimeWheel *wheel)
+{
+    free(wheel->block_counts);
+    free(wheel->words);
+    free(wheel);
+}
+
+int prime_wheel_is_prime(const PrimeWheel *wheel, uint64_t number)
+{
+    if (number > wheel->limit) {
+        return prime_miller_rabin(number);
+    }
+    if (number < 7) {
+        return number == 2 || number == 3 || number == 5;
+    }
+    unsigned int index = PRIME_WHEEL_INDEX[number % 30];
+    if (index == 8) {
+        return 0;
+    }
+    uint64_t n = number / 30 * 8 + index;
+    return (wheel->words[n / BITS_PER_WORD] >> (n % BITS_PER_WORD)) & 1;
+}
+
+int64_t prime_wheel_count(const PrimeWheel *wheel, uint64_t number)
+{
+    if (number > wheel->limit) {
+        return -1;
+    }
+    if (number < 7) {
+        return PRIME_SMALL_COUNTS[number];
+    }
+    /** the wheel bits below n are the numbers 7 to number. */
+    uint64_t n = number / 30 * 8 + PRIME_WHEEL_RANK[number % 30];
+    uint64_t word = n / BITS_PER_WORD;
+    uint64_t block = word / PRIME_WHEEL_WORDS_PER_BLOCK;
+    uint64_t first = block * PRIME_WHEEL_WORDS_PER_BLOCK;
+    uint64_t count =
+        wheel->block_counts[block] +
+        count_bitmap(&(wheel->words[first]), (unsigned int)(word - first));
+    if (n % BITS_PER_WORD != 0) {
+        word_t mask = ((word_t)1 << (n % BITS_PER_WORD)) - 1;
+        count += popcount_wheel_word(wheel->words[word] & mask);
+    }
+    return (int64_t)count + 3;
+}
+
+uint64_t prime_wheel_nth(const PrimeWheel *wheel, uint64_t nth)
+{
+    static const uint64_t small_primes[] = {2, 3, 5};
+    if (nth == 0 || nth > wheel->num_primes) {
+        return 0;
+    }
+    if (nth <= 3) {
+        return small_primes[nth - 1];
+    }
+
+    /** the rank-th (from 0) 1 bit: the last block counting at most rank. */
+    uint64_t rank = nth - 4;
+    uint64_t low = 0;
+    uint64_t high = wheel->num_words / PRIME_WHEEL_WORDS_PER_BLOCK;
+    while (low < high) {
+        uint64_t middle = low + (high - low + 1) / 2;
+        if (wheel->block_counts[middle] <= rank) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    rank -= wheel->block_counts[low];
+    uint64_t word = low * PRIME_WHEEL_WORDS_PER_BLOCK;
+    for (;; ++word) {
+        unsigned int count = popcount_wheel_word(wheel->words[word]);
+        if (rank < count) {
+            break;
+        }
+        rank -= count;
+    }
+    uint64_t n = word * BITS_PER_WORD +
+                 select_wheel_word(wheel->words[word], (unsigned int)rank);
+    return prime_wheel_number(n);
+}
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 prime_uint128_t;
+#endif
+
+/** a * b % modulus without overflow. */
+static inline uint64_t mul_mod64(uint64_t a, uint64_t b, uint64_t modulus)
+{
+#ifdef __SIZEOF_INT128__
+    return (uint64_t)((prime_uint128_t)a * b % modulus);
+#else
+    uint64_t result = 0;
+    a %= modulus;
+    for (; b > 0; b >>= 1) {
+        if (b & 1) {
+            result = result >= modulus - a ? result - (modulus - a)
+                                           : result + a;
+        }
+        a = a >= modulus - a ? a - (modulus - a) : a + a;
+    }
+    return result;
+#endif
+}
+
+static uint64_t pow_mod64(uint64_t base, uint64_t exponent, uint64_t modulus)
+{
+    uint64_t result = 1;
+    base %= modulus;
+    for (; exponent > 0; exponent >>= 1) {
+        if (exponent & 1) {
+            result = mul_mod64(result, base, modulus);
+        }
+        base = mul_mod64(base, base, modulus);
+    }
+    return result;
+}
+
+int prime_miller_rabin(uint64_t number)
+{
+    static const uint64_t bases[] = {
+        2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    const int num_bases = sizeof(bases) / sizeof(bases[0]);
+    if (number < 2) {
+        return 0;
+    }
+    for (int i = 0; i < num_bases; ++i) {
+        if (number % bases[i] == 0) {
+            return number == bases[i];
+        }
+    }
+    /** no factor up to 37 and below 41 * 41. */
+    if (number < 41 * 41) {
+        return 1;
+    }
+
+    /** number - 1 = d * 2^s, d odd. */
+    uint64_t d = number - 1;
+    unsigned int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        ++s;
+    }
+    for (int i = 0; i < num_bases; ++i) {
+        uint64_t x = pow_mod64(bases[i], d, number);
+        if (x == 1 || x == number - 1) {
+            continue;
+        }
+        unsigned int r = 1;
+        for (; r < s; ++r) {
+            x = mul_mod64(x, x, number);
+            if (x == number - 1) {
+                break;
+            }
+        }
+        /** a witness that number is composite. */
+        if (r == s) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -5,6 +5,18 @@
  *
  * @brief Prime number calculation.
  *
+ * prime_number_sieve sieves [0, max_number] in a single odd-only BitMap.
+ * prime_segmented_sieve sieves any [lo, hi) range below 2^64 in windows of
+ * PRIME_SEGMENT_BITS odd numbers (32 KB, sized for the L1 cache), spread
+ * over threads. The primes up to sqrt(hi) are kept only up to twice the
+ * window; the larger ones are sieved again a block at a time for each claim
+ * of 16 windows, so the memory does not grow with hi.
+ * PrimeWheel keeps the primes up to a limit for queries: only the numbers
+ * prime to 30 are stored (8 bits per 30 numbers, 0.27 bit per number vs 0.5
+ * for the odd-only sieve), with the prime count of every 8 words, so pi(n)
+ * is a lookup and at most 8 popcounts. Past the limit, prime_wheel_is_prime
+ * falls back to prime_miller_rabin, exact for every 64-bit number.
+ *
  * @date 2019-07-21
  *
  * @copyright Copyright (c) 2019, hutusi.com
@@ -16,6 +28,22 @@
 
 #include "bitmap.h"
 
+#include <stdint.h>
+
+/**
+ * @brief The number of odd numbers in a window of prime_segmented_sieve.
+ */
+#define PRIME_SEGMENT_BITS (1 << 18)
+
+/**
+ * @brief The callback of prime_segmented_sieve for each prime.
+ *
+ * @param prime     The prime.
+ * @param args      The args passed to prime_segmented_sieve.
+ * @return int      0 to go on, non-zero to stop the sieve.
+ */
+typedef int (*PrimeCallback)(uint64_t prime, void *args);
+
 /**
  * @brief Sieve the prime numbers less than or equal to specific max number.
  *
@@ -50,4 +78,112 @@ unsigned int prime_number_sieve_count(const BitMap *sieve);
  */
 void prime_number_sieve_free(BitMap *sieve);
 
+/**
+ * @brief Sieve the primes in [lo, hi) window by window, streaming them.
+ *
+ * The windows are sieved by num_threads threads, the callback is called
+ * for each prime in ascending order, never concurrently, from any thread.
+ * The memory is bounded, about 1 MB a thread, for any hi below 2^64; past
+ * hi of 2^38 each claim of windows sieves the odd numbers up to sqrt(hi)
+ * again to find the larger primes to cross.
+ *
+ * @param lo            The low bound, included.
+ * @param hi            The high bound, excluded.
+ * @param num_threads   The number of threads, 0 or 1 to sieve in the
+ *                      calling thread.
+ * @param callback      The callback, NULL to only count the primes.
+ * @param args          The args passed to callback.
+ * @return int64_t      The number of primes passed to callback (or counted),
+ *                      -1 if out of memory.
+ */
+int64_t prime_segmented_sieve(uint64_t lo,
+                              uint64_t hi,
+                              unsigned int num_threads,
+                              PrimeCallback callback,
+                              void *args);
+
+/**
+ * @brief Count the primes in [lo, hi) by prime_segmented_sieve.
+ *
+ * @param lo            The low bound, included.
+ * @param hi            The high bound, excluded.
+ * @param num_threads   The number of threads.
+ * @return int64_t      The number of primes, -1 if out of memory.
+ */
+int64_t
+prime_segmented_count(uint64_t lo, uint64_t hi, unsigned int num_threads);
+
+/**
+ * @brief The numbers in [0, limit] prime to 2, 3 and 5, as a wheel of 30.
+ *
+ * Bits 8k to 8k + 7 of the words (bit n is bit n % 64 of word n / 64) are
+ * the numbers 30k + 1, 7, 11, 13, 17, 19, 23 and 29, a bit is 1 if the
+ * number is prime.
+ */
+typedef struct _PrimeWheel {
+    word_t *words;
+    uint64_t num_words;
+    /** The number of 1 bits in the words before each block of 8 words. */
+    uint64_t *block_counts;
+    /** The largest number sieved. */
+    uint64_t limit;
+    /** The number of primes up to limit, 2, 3 and 5 included. */
+    uint64_t num_primes;
+} PrimeWheel;
+
+/**
+ * @brief Sieve the primes up to a limit into a new PrimeWheel.
+ *
+ * @param limit         The largest number to sieve.
+ * @return PrimeWheel*  The new PrimeWheel if success, otherwise return NULL.
+ */
+PrimeWheel *prime_wheel_new(uint64_t limit);
+
+/**
+ * @brief Delete a PrimeWheel and free back memory.
+ *
+ * @param wheel     The PrimeWheel.
+ */
+void prime_wheel_free(PrimeWheel *wheel);
+
+/**
+ * @brief Check if a number is prime.
+ *
+ * A lookup up to the limit of wheel, prime_miller_rabin past it.
+ *
+ * @param wheel     The PrimeWheel.
+ * @param number    The number, any 64-bit number.
+ * @return int      1 if prime, otherwise 0.
+ */
+int prime_wheel_is_prime(const PrimeWheel *wheel, uint64_t number);
+
+/**
+ * @brief Count the primes less than or equal to a number, pi(number).
+ *
+ * @param wheel     The PrimeWheel.
+ * @param number    The number, up to the limit of wheel.
+ * @return int64_t  The number of primes, -1 if number is past the limit.
+ */
+int64_t prime_wheel_count(const PrimeWheel *wheel, uint64_t number);
+
+/**
+ * @brief Get the nth prime, 2 is the 1st.
+ *
+ * @param wheel     The PrimeWheel.
+ * @param nth       The rank of the prime, from 1.
+ * @return uint64_t The prime, 0 if nth is 0 or past the primes of wheel.
+ */
+uint64_t prime_wheel_nth(const PrimeWheel *wheel, uint64_t nth);
+
+/**
+ * @brief Check if a number is prime by the Miller-Rabin test.
+ *
+ * The bases are the first 12 primes, which leave no strong pseudoprime
+ * below 3.3 * 10^24, so the answer is exact for every 64-bit number.
+ *
+ * @param number    The number.
+ * @return int      1 if prime, otherwise 0.
+ */
+int prime_miller_rabin(uint64_t number);
+
 #endif /* #ifndef RETHINK_C_PRIME_H */
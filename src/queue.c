@@ -22,11 +22,34 @@ Queue *queue_new()
 
     queue->head = queue->tail = NULL;
     queue->length = 0;
+    queue->slab = NULL;
+    return queue;
+}
+
+Queue *queue_new_with_slab(unsigned int nodes_per_page)
+{
+    Queue *queue = queue_new();
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    queue->slab = slab_new(sizeof(QueueNode), nodes_per_page);
+    if (queue->slab == NULL) {
+        free(queue);
+        return NULL;
+    }
     return queue;
 }
 
 void queue_free(Queue *queue)
 {
+    if (queue->slab != NULL) {
+        /** nodes own nothing, drop their pages at once. */
+        slab_free(queue->slab);
+        free(queue);
+        return;
+    }
+
     QueueNode *node = queue->head;
 
     while (node != NULL) {
@@ -38,9 +61,11 @@ void queue_free(Queue *queue)
     free(queue);
 }
 
-static QueueNode *queuenode_new(QueueValue data)
+static QueueNode *queuenode_new(Queue *queue, QueueValue data)
 {
-    QueueNode *node = (QueueNode *)malloc(sizeof(QueueNode));
+    QueueNode *node = queue->slab != NULL
+                          ? (QueueNode *)slab_alloc(queue->slab)
+                          : (QueueNode *)malloc(sizeof(QueueNode));
     if (node == NULL) {
         return NULL;
     }
@@ -50,9 +75,18 @@ static QueueNode *queuenode_new(QueueValue data)
     return node;
 }
 
+static void queuenode_free(Queue *queue, QueueNode *node)
+{
+    if (queue->slab != NULL) {
+        slab_dealloc(queue->slab, node);
+    } else {
+        free(node);
+    }
+}
+
 int queue_push_head(Queue *queue, QueueValue data)
 {
-    QueueNode *node = queuenode_new(data);
+    QueueNode *node = queuenode_new(queue, data);
     if (node == NULL) {
         return -1;
     }
@@ -86,7 +120,7 @@ QueueValue queue_pop_head(Queue *queue)
 
     --(queue->length);
     QueueValue value = node->data;
-    free(node);
+    queuenode_free(queue, node);
     return value;
 }
 
@@ -101,7 +135,7 @@ QueueValue queue_peek_head(const Queue *queue)
 
 int queue_push_tail(Queue *queue, QueueValue data)
 {
-    QueueNode *node = queuenode_new(data);
+    QueueNode *node = queuenode_new(queue, data);
     if (node == NULL) {
         return -1;
     }
@@ -135,7 +169,7 @@ QueueValue queue_pop_tail(Queue *queue)
 
     --(queue->length);
     QueueValue value = node->data;
-    free(node);
+    queuenode_free(queue, node);
     return value;
 }
 
@@ -14,6 +14,8 @@
 #ifndef RETHINK_C_QUEUE_H
 #define RETHINK_C_QUEUE_H
 
+#include "slab.h"
+
 /**
  * @brief The type of a value to be stored in a @ref Queue.
  *        (void *) can be changed to int, long, or other types if needed.
@@ -39,6 +41,8 @@ typedef struct _Queue {
     struct _QueueNode *head;
     struct _QueueNode *tail;
     unsigned int length;
+    /** The Slab of nodes, NULL if nodes are allocated by malloc. */
+    Slab *slab;
 } Queue;
 
 /**
@@ -48,6 +52,17 @@ typedef struct _Queue {
  */
 Queue *queue_new();
 
+/**
+ * @brief Allcate a new Queue whose nodes are allocated from its own Slab.
+ *
+ * A push reuses the node of a previous pop, and queue_free releases all
+ * nodes in O(pages).
+ *
+ * @param nodes_per_page    The number of nodes per Slab page, 0 for default.
+ * @return Queue*           The new Queue if success, otherwise return NULL.
+ */
+Queue *queue_new_with_slab(unsigned int nodes_per_page);
+
 /**
  * @brief Delete a Queue and free back memory.
  *
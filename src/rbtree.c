@@ -21,14 +21,53 @@ RBTree *rb_tree_new(RBTreeCompareFunc compare_func,
                     RBTreeFreeValueFunc free_value_func)
 {
     RBTree *tree = (RBTree *)malloc(sizeof(RBTree));
+    if (tree == NULL) {
+        return NULL;
+    }
     tree->compare_func = compare_func;
     tree->free_key_func = free_key_func;
     tree->free_value_func = free_value_func;
     tree->root = RB_TREE_NIL;
     tree->num_nodes = 0;
+    tree->slab = NULL;
+    return tree;
+}
+
+RBTree *rb_tree_new_with_slab(RBTreeCompareFunc compare_func,
+                              RBTreeFreeKeyFunc free_key_func,
+                              RBTreeFreeValueFunc free_value_func,
+                              unsigned int nodes_per_page)
+{
+    RBTree *tree = rb_tree_new(compare_func, free_key_func, free_value_func);
+    if (tree == NULL) {
+        return NULL;
+    }
+    /** nodes and entities share the Slab. */
+    unsigned int object_size = sizeof(RBTreeNode) > sizeof(RBTreeEntity)
+                                   ? sizeof(RBTreeNode)
+                                   : sizeof(RBTreeEntity);
+    tree->slab = slab_new(object_size, nodes_per_page);
+    if (tree->slab == NULL) {
+        free(tree);
+        return NULL;
+    }
     return tree;
 }
 
+static inline void *rb_tree_alloc(RBTree *tree, size_t size)
+{
+    return tree->slab != NULL ? slab_alloc(tree->slab) : malloc(size);
+}
+
+static inline void rb_tree_dealloc(RBTree *tree, void *object)
+{
+    if (tree->slab != NULL) {
+        slab_dealloc(tree->slab, object);
+    } else {
+        free(object);
+    }
+}
+
 void rb_tree_free_node(RBTree *tree, RBTreeNode *node)
 {
     RBTreeEntity *data = node->data;
@@ -38,14 +77,14 @@ void rb_tree_free_node(RBTree *tree, RBTreeNode *node)
         if (tree->free_value_func && prev->value) {
             tree->free_value_func(prev->value);
         }
-        free(prev);
+        rb_tree_dealloc(tree, prev);
     }
 
     if (tree->free_key_func && node->key) {
         tree->free_key_func(node->key);
     }
 
-    free(node);
+    rb_tree_dealloc(tree, node);
 }
 
 static void rb_tree_free_node_callback(RBTreeNode *node, void *args)
@@ -57,17 +96,29 @@ static void rb_tree_free_node_callback(RBTreeNode *node, void *args)
 
 void rb_tree_free(RBTree *tree)
 {
+    if (tree->slab != NULL && tree->free_key_func == NULL &&
+        tree->free_value_func == NULL) {
+        /** nothing to free per node, drop the pages at once. */
+        slab_free(tree->slab);
+        free(tree);
+        return;
+    }
+
     // free all nodes
     rb_tree_postorder_traverse(tree, rb_tree_free_node_callback, tree);
+    if (tree->slab != NULL) {
+        slab_free(tree->slab);
+    }
     free(tree);
 }
 
-static RBTreeNode *rb_tree_node_new(RBTreeKey key, RBTreeValue value)
+static RBTreeNode *
+rb_tree_node_new(RBTree *tree, RBTreeKey key, RBTreeValue value)
 {
-    RBTreeNode *node = (RBTreeNode *)malloc(sizeof(RBTreeNode));
+    RBTreeNode *node = (RBTreeNode *)rb_tree_alloc(tree, sizeof(RBTreeNode));
 
     node->key = key;
-    node->data = (RBTreeEntity *)malloc(sizeof(RBTreeEntity));
+    node->data = (RBTreeEntity *)rb_tree_alloc(tree, sizeof(RBTreeEntity));
     node->data->value = value;
     node->data->next = NULL;
 
@@ -77,10 +128,12 @@ static RBTreeNode *rb_tree_node_new(RBTreeKey key, RBTreeValue value)
     return node;
 }
 
-static RBTreeEntity *rb_tree_node_append_value(RBTreeNode *node,
+static RBTreeEntity *rb_tree_node_append_value(RBTree *tree,
+                                               RBTreeNode *node,
                                                RBTreeValue value)
 {
-    RBTreeEntity *entity = (RBTreeEntity *)malloc(sizeof(RBTreeEntity));
+    RBTreeEntity *entity =
+        (RBTreeEntity *)rb_tree_alloc(tree, sizeof(RBTreeEntity));
     entity->value = value;
     entity->next = NULL;
 
@@ -352,12 +405,12 @@ RBTreeNode *rb_tree_insert(RBTree *tree, RBTreeKey key, RBTreeValue value)
             // free the key. shared key with prev node.
             if (tree->free_key_func)
                 tree->free_key_func(key);
-            rb_tree_node_append_value(rover, value);
+            rb_tree_node_append_value(tree, rover, value);
             return rover;
         }
     }
 
-    RBTreeNode *new_node = rb_tree_node_new(key, value);
+    RBTreeNode *new_node = rb_tree_node_new(tree, key, value);
     new_node->parent = insert;
     ++(tree->num_nodes);
 
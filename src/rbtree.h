@@ -14,6 +14,8 @@
 #ifndef RETHINK_C_RB_TREE_H
 #define RETHINK_C_RB_TREE_H
 
+#include "slab.h"
+
 /**
  * @brief The type of a key to be stored in a @ref RBTree.
  *        (void *) can be changed to int, char *, or other types if needed.
@@ -77,6 +79,8 @@ typedef struct _RBTree {
     RBTreeFreeValueFunc free_value_func;
     /** The number of nodes of the @ref RBTree. */
     unsigned int num_nodes;
+    /** The Slab of nodes and entities, NULL if allocated by malloc. */
+    Slab *slab;
 } RBTree;
 
 /**
@@ -91,6 +95,24 @@ RBTree *rb_tree_new(RBTreeCompareFunc compare_func,
                     RBTreeFreeKeyFunc free_key_func,
                     RBTreeFreeValueFunc free_value_func);
 
+/**
+ * @brief Allcate a new RBTree whose nodes and entities are allocated from its
+ * own Slab.
+ *
+ * Nodes are packed in pages, and rb_tree_free releases them in O(pages) if
+ * there are no free key/value functions.
+ *
+ * @param compare_func      Compare two node value when do searching in RBTree.
+ * @param free_key_func     Free key callback function.
+ * @param free_value_func   Free value callback function.
+ * @param nodes_per_page    The number of nodes per Slab page, 0 for default.
+ * @return RBTree*          The new RBTree if success, otherwise return NULL.
+ */
+RBTree *rb_tree_new_with_slab(RBTreeCompareFunc compare_func,
+                              RBTreeFreeKeyFunc free_key_func,
+                              RBTreeFreeValueFunc free_value_func,
+                              unsigned int nodes_per_page);
+
 /**
  * @brief Delete a RBTree and free back memory.
  *
@@ -0,0 +1,312 @@
+/**
+ * @file ring_queue.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to ring_queue.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "ring_queue.h"
+#include "def.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RING_QUEUE_MAX_CAPACITY (UINT_MAX / 2 + 1)
+
+static inline char *ring_queue_slot(const RingQueue *queue, unsigned int pos)
+{
+    return queue->data + (size_t)pos * queue->element_size;
+}
+
+static inline unsigned int ring_queue_pos(const RingQueue *queue,
+                                          unsigned int n)
+{
+    return (queue->head + n) & (queue->capacity - 1);
+}
+
+/** a constant size memcpy is inlined as a move, the common element sizes
+ * skip the library call. */
+static inline void
+ring_queue_copy_element(void *dest, const void *src, unsigned int size)
+{
+    switch (size) {
+    case 4:
+        memcpy(dest, src, 4);
+        break;
+    case 8:
+        memcpy(dest, src, 8);
+        break;
+    case 16:
+        memcpy(dest, src, 16);
+        break;
+    default:
+        memcpy(dest, src, size);
+        break;
+    }
+}
+
+RingQueue *ring_queue_new(unsigned int element_size, unsigned int capacity)
+{
+    if (element_size == 0 || capacity > RING_QUEUE_MAX_CAPACITY) {
+        return NULL;
+    }
+    if (capacity == 0) {
+        capacity = RING_QUEUE_CAPACITY;
+    }
+
+    RingQueue *queue = (RingQueue *)malloc(sizeof(RingQueue));
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    queue->element_size = element_size;
+    queue->capacity = 1;
+    while (queue->capacity < capacity) {
+        queue->capacity <<= 1;
+    }
+    queue->head = 0;
+    queue->length = 0;
+    queue->data = (char *)malloc((size_t)queue->capacity * element_size);
+    if (queue->data == NULL) {
+        free(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+void ring_queue_free(RingQueue *queue)
+{
+    free(queue->data);
+    free(queue);
+}
+
+int ring_queue_reserve(RingQueue *queue, unsigned int capacity)
+{
+    if (capacity <= queue->capacity) {
+        return 0;
+    }
+    if (capacity > RING_QUEUE_MAX_CAPACITY) {
+        return -1;
+    }
+
+    unsigned int old_capacity = queue->capacity;
+    unsigned int new_capacity = old_capacity;
+    while (new_capacity < capacity) {
+        new_capacity <<= 1;
+    }
+
+    char *data = (char *)realloc(
+        queue->data, (size_t)new_capacity * queue->element_size);
+    if (data == NULL) {
+        return -1;
+    }
+    queue->data = data;
+    queue->capacity = new_capacity;
+
+    /** the wrapped part at the buffer start moves right after the old end,
+     * it fits since the capacity at least doubled. */
+    if (queue->head + queue->length > old_capacity) {
+        unsigned int wrapped = queue->head + queue->length - old_capacity;
+        memcpy(ring_queue_slot(queue, old_capacity),
+               queue->data,
+               (size_t)wrapped * queue->element_size);
+    }
+    return 0;
+}
+
+static inline int ring_queue_ensure(RingQueue *queue, unsigned int count)
+{
+    if (count > RING_QUEUE_MAX_CAPACITY - queue->length) {
+        return -1;
+    }
+    return ring_queue_reserve(queue, queue->length + count);
+}
+
+/** copy elements into count slots from pos, in at most two pieces. */
+static void ring_queue_copy_in(RingQueue *queue,
+                               unsigned int pos,
+                               const void *elements,
+                               unsigned int count)
+{
+    unsigned int first = queue->capacity - pos;
+    if (first > count) {
+        first = count;
+    }
+    size_t first_bytes = (size_t)first * queue->element_size;
+    memcpy(ring_queue_slot(queue, pos), elements, first_bytes);
+    memcpy(queue->data,
+           (const char *)elements + first_bytes,
+           (size_t)(count - first) * queue->element_size);
+}
+
+/** copy count elements from pos out, in at most two pieces. */
+static void ring_queue_copy_out(const RingQueue *queue,
+                                unsigned int pos,
+                                void *elements,
+                                unsigned int count)
+{
+    unsigned int first = queue->capacity - pos;
+    if (first > count) {
+        first = count;
+    }
+    size_t first_bytes = (size_t)first * queue->element_size;
+    memcpy(elements, ring_queue_slot(queue, pos), first_bytes);
+    memcpy((char *)elements + first_bytes,
+           queue->data,
+           (size_t)(count - first) * queue->element_size);
+}
+
+int ring_queue_push_head(RingQueue *queue, const void *element)
+{
+    if (queue->length == queue->capacity && ring_queue_ensure(queue, 1) != 0) {
+        return -1;
+    }
+
+    queue->head = (queue->head - 1) & (queue->capacity - 1);
+    ring_queue_copy_element(
+        ring_queue_slot(queue, queue->head), element, queue->element_size);
+    ++(queue->length);
+    return 0;
+}
+
+int ring_queue_push_tail(RingQueue *queue, const void *element)
+{
+    if (queue->length == queue->capacity && ring_queue_ensure(queue, 1) != 0) {
+        return -1;
+    }
+
+    ring_queue_copy_element(
+        ring_queue_slot(queue, ring_queue_pos(queue, queue->length)),
+        element,
+        queue->element_size);
+    ++(queue->length);
+    return 0;
+}
+
+int ring_queue_pop_head(RingQueue *queue, void *element)
+{
+    if (queue->length == 0) {
+        return -1;
+    }
+
+    if (element != NULL) {
+        ring_queue_copy_element(
+            element, ring_queue_slot(queue, queue->head), queue->element_size);
+    }
+    queue->head = ring_queue_pos(queue, 1);
+    --(queue->length);
+    return 0;
+}
+
+int ring_queue_pop_tail(RingQueue *queue, void *element)
+{
+    if (queue->length == 0) {
+        return -1;
+    }
+
+    --(queue->length);
+    if (element != NULL) {
+        ring_queue_copy_element(
+            element,
+            ring_queue_slot(queue, ring_queue_pos(queue, queue->length)),
+            queue->element_size);
+    }
+    return 0;
+}
+
+void *ring_queue_peek_head(const RingQueue *queue)
+{
+    return ring_queue_nth(queue, 0);
+}
+
+void *ring_queue_peek_tail(const RingQueue *queue)
+{
+    return queue->length == 0 ? NULL
+                              : ring_queue_nth(queue, queue->length - 1);
+}
+
+void *ring_queue_nth(const RingQueue *queue, unsigned int n)
+{
+    if (n >= queue->length) {
+        return NULL;
+    }
+    return ring_queue_slot(queue, ring_queue_pos(queue, n));
+}
+
+int ring_queue_push_head_many(RingQueue *queue,
+                              const void *elements,
+                              unsigned int count)
+{
+    if (ring_queue_ensure(queue, count) != 0) {
+        return -1;
+    }
+
+    queue->head = (queue->head - count) & (queue->capacity - 1);
+    ring_queue_copy_in(queue, queue->head, elements, count);
+    queue->length += count;
+    return 0;
+}
+
+int ring_queue_push_tail_many(RingQueue *queue,
+                              const void *elements,
+                              unsigned int count)
+{
+    if (ring_queue_ensure(queue, count) != 0) {
+        return -1;
+    }
+
+    ring_queue_copy_in(
+        queue, ring_queue_pos(queue, queue->length), elements, count);
+    queue->length += count;
+    return 0;
+}
+
+unsigned int
+ring_queue_pop_head_many(RingQueue *queue, void *elements, unsigned int count)
+{
+    if (count > queue->length) {
+        count = queue->length;
+    }
+
+    if (elements != NULL) {
+        ring_queue_copy_out(queue, queue->head, elements, count);
+    }
+    queue->head = ring_queue_pos(queue, count);
+    queue->length -= count;
+    return count;
+}
+
+unsigned int
+ring_queue_pop_tail_many(RingQueue *queue, void *elements, unsigned int count)
+{
+    if (count > queue->length) {
+        count = queue->length;
+    }
+
+    queue->length -= count;
+    if (elements != NULL) {
+        ring_queue_copy_out(
+            queue, ring_queue_pos(queue, queue->length), elements, count);
+    }
+    return count;
+}
+
+void ring_queue_clear(RingQueue *queue)
+{
+    queue->head = 0;
+    queue->length = 0;
+}
+
+int ring_queue_is_empty(const RingQueue *queue)
+{
+    return queue->length == 0;
+}
+
+unsigned int ring_queue_length(const RingQueue *queue)
+{
+    return queue->length;
+}
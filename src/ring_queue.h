@@ -0,0 +1,213 @@
+/**
+ * @file ring_queue.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Double-ended queue (Deque) on a growable circular buffer.
+ *
+ * Elements are stored inline with a fixed element size given at creation,
+ * so ints, structs and pointers are stored unboxed and pushing or popping
+ * an element is a memcpy, the buffer doubles when full:
+ *
+ *     RingQueue *queue = ring_queue_new(sizeof(int), 0);
+ *     int vertex = 7;
+ *     ring_queue_push_tail(queue, &vertex);
+ *     ring_queue_pop_head(queue, &vertex);
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_RING_QUEUE_H
+#define RETHINK_C_RING_QUEUE_H
+
+/**
+ * @brief The default capacity of a @ref RingQueue.
+ */
+#define RING_QUEUE_CAPACITY 16
+
+/**
+ * @brief Definition of a @ref RingQueue.
+ *
+ */
+typedef struct _RingQueue {
+    /** The circular buffer of capacity * element_size bytes. */
+    char *data;
+    unsigned int element_size;
+    /** Always a power of two, so indexes wrap by mask. */
+    unsigned int capacity;
+    /** The index of the head element. */
+    unsigned int head;
+    unsigned int length;
+} RingQueue;
+
+/**
+ * @brief Allcate a new RingQueue.
+ *
+ * @param element_size  The size of an element in bytes.
+ * @param capacity      The initial capacity, rounded up to a power of two, 0
+ *                      for RING_QUEUE_CAPACITY.
+ * @return RingQueue*   The new RingQueue if success, otherwise return NULL.
+ */
+RingQueue *ring_queue_new(unsigned int element_size, unsigned int capacity);
+
+/**
+ * @brief Delete a RingQueue and free back memory.
+ *
+ * @param queue  The RingQueue to delete.
+ */
+void ring_queue_free(RingQueue *queue);
+
+/**
+ * @brief Make sure a RingQueue can hold some elements without growing.
+ *
+ * @param queue     The RingQueue.
+ * @param capacity  The number of elements.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int ring_queue_reserve(RingQueue *queue, unsigned int capacity);
+
+/**
+ * @brief Push an element to the head of a RingQueue.
+ *
+ * @param queue     The RingQueue.
+ * @param element   The element, element_size bytes are copied.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int ring_queue_push_head(RingQueue *queue, const void *element);
+
+/**
+ * @brief Push an element to the tail of a RingQueue.
+ *
+ * @param queue     The RingQueue.
+ * @param element   The element, element_size bytes are copied.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int ring_queue_push_tail(RingQueue *queue, const void *element);
+
+/**
+ * @brief Pop the head element of a RingQueue.
+ *
+ * @param queue     The RingQueue.
+ * @param element   The output element, NULL to drop it.
+ * @return int      0 if success, -1 if empty.
+ */
+int ring_queue_pop_head(RingQueue *queue, void *element);
+
+/**
+ * @brief Pop the tail element of a RingQueue.
+ *
+ * @param queue     The RingQueue.
+ * @param element   The output element, NULL to drop it.
+ * @return int      0 if success, -1 if empty.
+ */
+int ring_queue_pop_tail(RingQueue *queue, void *element);
+
+/**
+ * @brief Peek the head element of a RingQueue.
+ *
+ * The pointer is valid until the next push.
+ *
+ * @param queue     The RingQueue.
+ * @return void*    The head element in the buffer, NULL if empty.
+ */
+void *ring_queue_peek_head(const RingQueue *queue);
+
+/**
+ * @brief Peek the tail element of a RingQueue.
+ *
+ * The pointer is valid until the next push.
+ *
+ * @param queue     The RingQueue.
+ * @return void*    The tail element in the buffer, NULL if empty.
+ */
+void *ring_queue_peek_tail(const RingQueue *queue);
+
+/**
+ * @brief Get the nth element (from head) of a RingQueue.
+ *
+ * @param queue     The RingQueue.
+ * @param n         The nth index.
+ * @return void*    The element in the buffer, NULL if out of range.
+ */
+void *ring_queue_nth(const RingQueue *queue, unsigned int n);
+
+/**
+ * @brief Push many elements to the head of a RingQueue.
+ *
+ * The elements keep their order, elements[0] becomes the head.
+ *
+ * @param queue     The RingQueue.
+ * @param elements  The array of elements.
+ * @param count     The number of elements.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int ring_queue_push_head_many(RingQueue *queue,
+                              const void *elements,
+                              unsigned int count);
+
+/**
+ * @brief Push many elements to the tail of a RingQueue.
+ *
+ * The elements keep their order, elements[count - 1] becomes the tail.
+ *
+ * @param queue     The RingQueue.
+ * @param elements  The array of elements.
+ * @param count     The number of elements.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int ring_queue_push_tail_many(RingQueue *queue,
+                              const void *elements,
+                              unsigned int count);
+
+/**
+ * @brief Pop at most count elements from the head of a RingQueue.
+ *
+ * @param queue             The RingQueue.
+ * @param elements          The output array, elements[0] was the head, NULL
+ *                          to drop them.
+ * @param count             The max number of elements.
+ * @return unsigned int     The number of popped elements.
+ */
+unsigned int
+ring_queue_pop_head_many(RingQueue *queue, void *elements, unsigned int count);
+
+/**
+ * @brief Pop at most count elements from the tail of a RingQueue.
+ *
+ * The elements keep their queue order, the last one was the tail.
+ *
+ * @param queue             The RingQueue.
+ * @param elements          The output array, NULL to drop them.
+ * @param count             The max number of elements.
+ * @return unsigned int     The number of popped elements.
+ */
+unsigned int
+ring_queue_pop_tail_many(RingQueue *queue, void *elements, unsigned int count);
+
+/**
+ * @brief Remove all elements of a RingQueue, the capacity is kept.
+ *
+ * @param queue     The RingQueue.
+ */
+void ring_queue_clear(RingQueue *queue);
+
+/**
+ * @brief Check if a RingQueue is empty.
+ *
+ * @param queue     The RingQueue.
+ * @return int      0 if not empty, 1 if empty.
+ */
+int ring_queue_is_empty(const RingQueue *queue);
+
+/**
+ * @brief Get the number of elements in a RingQueue.
+ *
+ * @param queue             The RingQueue.
+ * @return unsigned int     The length.
+ */
+unsigned int ring_queue_length(const RingQueue *queue);
+
+#endif /* #ifndef RETHINK_C_RING_QUEUE_H */
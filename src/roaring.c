@@ -0,0 +1,1877 @@
+/**
+ * @file roaring.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to roaring.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "roaring.h"
+#include "def.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** An array container is converted to a bitset beyond this many values. */
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_BITSET_WORDS 1024
+#define ROARING_CHUNK_VALUES 65536
+/** "RBM1" in little-endian. */
+#define ROARING_COOKIE 0x314D4252u
+
+enum { ROARING_ARRAY = 1, ROARING_BITSET = 2, ROARING_RUN = 3 };
+
+/** The values start to start + length. */
+typedef struct _RoaringRun {
+    uint16_t start;
+    uint16_t length;
+} RoaringRun;
+
+typedef struct _RoaringContainer {
+    /** The high 16 bits of the values. */
+    uint16_t key;
+    uint8_t type;
+    /** The number of values, 1 to 65536 once stored in a Roaring. */
+    uint32_t cardinality;
+    /** The number of values of an array, of runs of a run container. */
+    uint32_t size;
+    /** The number of allocated values, runs or words. */
+    uint32_t capacity;
+    union {
+        uint16_t *values;
+        uint64_t *words;
+        RoaringRun *runs;
+    } data;
+} RoaringContainer;
+
+struct _Roaring {
+    /** Sorted by key, none is empty. */
+    RoaringContainer *containers;
+    unsigned int size;
+    unsigned int capacity;
+};
+
+static inline unsigned int roaring_popcount(uint64_t word)
+{
+#ifdef __GNUC__
+    return (unsigned int)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) +
+           ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static inline unsigned int roaring_ctz(uint64_t word)
+{
+#ifdef __GNUC__
+    return (unsigned int)__builtin_ctzll(word);
+#else
+    unsigned int n = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/** the index of the first value not less than value. */
+static inline uint32_t
+lower_bound(const uint16_t *values, uint32_t size, uint16_t value)
+{
+    uint32_t low = 0;
+    while (low < size) {
+        uint32_t middle = low + (size - low) / 2;
+        if (values[middle] < value) {
+            low = middle + 1;
+        } else {
+            size = middle;
+        }
+    }
+    return low;
+}
+
+/** the index of the last run starting at or before value, -1 if none. */
+static inline int32_t
+run_find(const RoaringRun *runs, uint32_t size, uint16_t value)
+{
+    int32_t low = 0;
+    int32_t high = (int32_t)size - 1;
+    while (low <= high) {
+        int32_t middle = low + (high - low) / 2;
+        if (runs[middle].start <= value) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return high;
+}
+
+/** set the bits [start, end) of words. */
+static void words_set_range(uint64_t *words, uint64_t start, uint64_t end)
+{
+    if (start >= end) {
+        return;
+    }
+    uint64_t first = start / 64;
+    uint64_t last = (end - 1) / 64;
+    uint64_t first_mask = ~0ULL << (start % 64);
+    uint64_t last_mask = ~0ULL >> (63 - (end - 1) % 64);
+    if (first == last) {
+        words[first] |= first_mask & last_mask;
+        return;
+    }
+    words[first] |= first_mask;
+    for (uint64_t i = first + 1; i < last; ++i) {
+        words[i] = ~0ULL;
+    }
+    words[last] |= last_mask;
+}
+
+/** write the low 16 bits of the 1 bits of a bitset, returns the number. */
+static uint32_t words_to_values(const uint64_t *words, uint16_t *values)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ROARING_BITSET_WORDS; ++i) {
+        uint64_t word = words[i];
+        while (word != 0) {
+            values[n++] = (uint16_t)(i * 64 + roaring_ctz(word));
+            word &= word - 1;
+        }
+    }
+    return n;
+}
+
+static int container_init(RoaringContainer *container,
+                          uint16_t key,
+                          uint8_t type,
+                          uint32_t capacity)
+{
+    container->key = key;
+    container->type = type;
+    container->cardinality = 0;
+    container->size = 0;
+    if (capacity == 0) {
+        capacity = 1;
+    }
+    switch (type) {
+    case ROARING_ARRAY:
+        container->data.values =
+            (uint16_t *)malloc(sizeof(uint16_t) * capacity);
+        break;
+    case ROARING_BITSET:
+        capacity = ROARING_BITSET_WORDS;
+        container->size = ROARING_BITSET_WORDS;
+        container->data.words =
+            (uint64_t *)calloc(ROARING_BITSET_WORDS, sizeof(uint64_t));
+        break;
+    case ROARING_RUN:
+        container->data.runs =
+            (RoaringRun *)malloc(sizeof(RoaringRun) * capacity);
+        break;
+    }
+    container->capacity = capacity;
+    return container->data.values == NULL ? -1 : 0;
+}
+
+static void container_destroy(RoaringContainer *container)
+{
+    switch (container->type) {
+    case ROARING_ARRAY:
+        free(container->data.values);
+        break;
+    case ROARING_BITSET:
+        free(container->data.words);
+        break;
+    case ROARING_RUN:
+        free(container->data.runs);
+        break;
+    }
+    container->data.values = NULL;
+    container->cardinality = 0;
+}
+
+static size_t container_element_size(const RoaringContainer *container)
+{
+    switch (container->type) {
+    case ROARING_ARRAY:
+        return sizeof(uint16_t);
+    case ROARING_BITSET:
+        return sizeof(uint64_t);
+    default:
+        return sizeof(RoaringRun);
+    }
+}
+
+static int container_clone(RoaringContainer *clone,
+                           const RoaringContainer *container)
+{
+    if (container_init(
+            clone, container->key, container->type, container->size) != 0) {
+        return -1;
+    }
+    memcpy(clone->data.values,
+           container->data.values,
+           container_element_size(container) * container->size);
+    clone->size = container->size;
+    clone->cardinality = container->cardinality;
+    return 0;
+}
+
+/** make room for size values or runs, capacity at least doubles. */
+static int container_reserve(RoaringContainer *container, uint32_t size)
+{
+    if (size <= container->capacity) {
+        return 0;
+    }
+    uint32_t capacity = container->capacity * 2;
+    if (capacity < 4) {
+        capacity = 4;
+    }
+    if (container->type == ROARING_ARRAY && capacity > ROARING_ARRAY_MAX) {
+        capacity = ROARING_ARRAY_MAX;
+    }
+    if (capacity < size) {
+        capacity = size;
+    }
+    void *data = realloc(container->data.values,
+                         container_element_size(container) * capacity);
+    if (data == NULL) {
+        return -1;
+    }
+    container->data.values = (uint16_t *)data;
+    container->capacity = capacity;
+    return 0;
+}
+
+/** the bytes a container of cardinality values takes as array or bitset. */
+static inline size_t natural_bytes(uint32_t cardinality)
+{
+    return cardinality <= ROARING_ARRAY_MAX
+               ? cardinality * sizeof(uint16_t)
+               : ROARING_BITSET_WORDS * sizeof(uint64_t);
+}
+
+static int container_array_to_bitset(RoaringContainer *container)
+{
+    uint64_t *words =
+        (uint64_t *)calloc(ROARING_BITSET_WORDS, sizeof(uint64_t));
+    if (words == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < container->size; ++i) {
+        uint16_t value = container->data.values[i];
+        words[value / 64] |= 1ULL << (value % 64);
+    }
+    free(container->data.values);
+    container->data.words = words;
+    container->type = ROARING_BITSET;
+    container->size = container->capacity = ROARING_BITSET_WORDS;
+    return 0;
+}
+
+static int container_bitset_to_array(RoaringContainer *container)
+{
+    uint16_t *values =
+        (uint16_t *)malloc(sizeof(uint16_t) * container->cardinality);
+    if (values == NULL) {
+        return -1;
+    }
+    words_to_values(container->data.words, values);
+    free(container->data.words);
+    container->data.values = values;
+    container->type = ROARING_ARRAY;
+    container->size = container->capacity = container->cardinality;
+    return 0;
+}
+
+/** a bitset with few enough values becomes an array. */
+static int container_shrink_bitset(RoaringContainer *container)
+{
+    container->cardinality =
+        count_bitmap(container->data.words, ROARING_BITSET_WORDS);
+    if (container->cardinality <= ROARING_ARRAY_MAX) {
+        return container_bitset_to_array(container);
+    }
+    return 0;
+}
+
+/** a run container becomes an array or a bitset. */
+static int container_run_to_natural(RoaringContainer *container)
+{
+    RoaringContainer natural;
+    const RoaringRun *runs = container->data.runs;
+    if (container->cardinality <= ROARING_ARRAY_MAX) {
+        if (container_init(&natural,
+                           container->key,
+                           ROARING_ARRAY,
+                           container->cardinality) != 0) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < container->size; ++i) {
+            uint32_t end = (uint32_t)runs[i].start + runs[i].length;
+            for (uint32_t value = runs[i].start; value <= end; ++value) {
+                natural.data.values[natural.size++] = (uint16_t)value;
+            }
+        }
+    } else {
+        if (container_init(
+                &natural, container->key, ROARING_BITSET, 0) != 0) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < container->size; ++i) {
+            words_set_range(natural.data.words,
+                            runs[i].start,
+                            (uint64_t)runs[i].start + runs[i].length + 1);
+        }
+    }
+    natural.cardinality = container->cardinality;
+    container_destroy(container);
+    *container = natural;
+    return 0;
+}
+
+/** a copy of a run container as an array or a bitset. */
+static int container_natural_copy(RoaringContainer *copy,
+                                  const RoaringContainer *container)
+{
+    if (container_clone(copy, container) != 0) {
+        return -1;
+    }
+    if (container_run_to_natural(copy) != 0) {
+        container_destroy(copy);
+        return -1;
+    }
+    return 0;
+}
+
+/** a run container which runs take more room than values becomes natural. */
+static int container_shrink_run(RoaringContainer *container)
+{
+    if (container->size * sizeof(RoaringRun) >
+        natural_bytes(container->cardinality)) {
+        return container_run_to_natural(container);
+    }
+    return 0;
+}
+
+static inline int run_is_full(const RoaringContainer *container)
+{
+    return container->type == ROARING_RUN &&
+           container->cardinality == ROARING_CHUNK_VALUES;
+}
+
+static uint32_t container_count_runs(const RoaringContainer *container)
+{
+    uint32_t runs = 0;
+    if (container->type == ROARING_RUN) {
+        return container->size;
+    } else if (container->type == ROARING_ARRAY) {
+        const uint16_t *values = container->data.values;
+        for (uint32_t i = 0; i < container->size; ++i) {
+            if (i == 0 || values[i] != values[i - 1] + 1) {
+                ++runs;
+            }
+        }
+    } else {
+        /** a run starts at a 1 bit after a 0 bit. */
+        uint64_t previous = 0;
+        for (uint32_t i = 0; i < ROARING_BITSET_WORDS; ++i) {
+            uint64_t word = container->data.words[i];
+            runs += roaring_popcount(word & ~((word << 1) | (previous >> 63)));
+            previous = word;
+        }
+    }
+    return runs;
+}
+
+static int container_to_run(RoaringContainer *container)
+{
+    RoaringContainer run;
+    uint32_t num_runs = container_count_runs(container);
+    if (container_init(&run, container->key, ROARING_RUN, num_runs) != 0) {
+        return -1;
+    }
+
+    if (container->type == ROARING_ARRAY) {
+        const uint16_t *values = container->data.values;
+        for (uint32_t i = 0; i < container->size; ++i) {
+            if (i == 0 || values[i] != values[i - 1] + 1) {
+                run.data.runs[run.size].start = values[i];
+                run.data.runs[run.size++].length = 0;
+            } else {
+                ++(run.data.runs[run.size - 1].length);
+            }
+        }
+    } else {
+        const uint64_t *words = container->data.words;
+        uint32_t i = 0;
+        uint64_t word = words[0];
+        for (;;) {
+            while (word == 0) {
+                if (++i == ROARING_BITSET_WORDS) {
+                    goto done;
+                }
+                word = words[i];
+            }
+            uint32_t start = i * 64 + roaring_ctz(word);
+            /** fill the 0 bits below start, then skip the 1 bits. */
+            word |= word - 1;
+            while (word == ~0ULL) {
+                if (++i == ROARING_BITSET_WORDS) {
+                    break;
+                }
+                word = words[i];
+            }
+            uint32_t end = i == ROARING_BITSET_WORDS
+                               ? ROARING_CHUNK_VALUES
+                               : i * 64 + roaring_ctz(~word);
+            run.data.runs[run.size].start = (uint16_t)start;
+            run.data.runs[run.size++].length = (uint16_t)(end - 1 - start);
+            if (i == ROARING_BITSET_WORDS) {
+                break;
+            }
+            word &= word + 1;
+        }
+    }
+done:
+    run.cardinality = container->cardinality;
+    container_destroy(container);
+    *container = run;
+    return 0;
+}
+
+static int container_contains(const RoaringContainer *container, uint16_t low)
+{
+    switch (container->type) {
+    case ROARING_ARRAY: {
+        uint32_t i = lower_bound(container->data.values, container->size, low);
+        return i < container->size && container->data.values[i] == low;
+    }
+    case ROARING_BITSET:
+        return (container->data.words[low / 64] >> (low % 64)) & 1;
+    default: {
+        int32_t i = run_find(container->data.runs, container->size, low);
+        return i >= 0 && low <= (uint32_t)container->data.runs[i].start +
+                                     container->data.runs[i].length;
+    }
+    }
+}
+
+static int container_run_add(RoaringContainer *container, uint16_t low)
+{
+    RoaringRun *runs = container->data.runs;
+    int32_t i = run_find(runs, container->size, low);
+    if (i >= 0 && low <= (uint32_t)runs[i].start + runs[i].length) {
+        return 0;
+    }
+
+    int extend_previous =
+        i >= 0 && (uint32_t)runs[i].start + runs[i].length + 1 == low;
+    int extend_next = (uint32_t)(i + 1) < container->size &&
+                      runs[i + 1].start == (uint32_t)low + 1;
+    if (extend_previous && extend_next) {
+        runs[i].length += runs[i + 1].length + 2;
+        memmove(&runs[i + 1],
+                &runs[i + 2],
+                sizeof(RoaringRun) * (container->size - i - 2));
+        --(container->size);
+    } else if (extend_previous) {
+        ++(runs[i].length);
+    } else if (extend_next) {
+        --(runs[i + 1].start);
+        ++(runs[i + 1].length);
+    } else {
+        if (container_reserve(container, container->size + 1) != 0) {
+            return -1;
+        }
+        runs = container->data.runs;
+        memmove(&runs[i + 2],
+                &runs[i + 1],
+                sizeof(RoaringRun) * (container->size - i - 1));
+        runs[i + 1].start = low;
+        runs[i + 1].length = 0;
+        ++(container->size);
+    }
+    ++(container->cardinality);
+    return 1;
+}
+
+static int container_add(RoaringContainer *container, uint16_t low)
+{
+    if (container->type == ROARING_ARRAY) {
+        uint16_t *values = container->data.values;
+        uint32_t i = lower_bound(values, container->size, low);
+        if (i < container->size && values[i] == low) {
+            return 0;
+        }
+        if (container->size < ROARING_ARRAY_MAX) {
+            if (container_reserve(container, container->size + 1) != 0) {
+                return -1;
+            }
+            values = container->data.values;
+            memmove(&values[i + 1],
+                    &values[i],
+                    sizeof(uint16_t) * (container->size - i));
+            values[i] = low;
+            ++(container->size);
+            ++(container->cardinality);
+            return 1;
+        }
+        if (container_array_to_bitset(container) != 0) {
+            return -1;
+        }
+    }
+
+    if (container->type == ROARING_BITSET) {
+        uint64_t *word = &(container->data.words[low / 64]);
+        uint64_t bit = 1ULL << (low % 64);
+        if (*word & bit) {
+            return 0;
+        }
+        *word |= bit;
+        ++(container->cardinality);
+        return 1;
+    }
+    return container_run_add(container, low);
+}
+
+static int container_run_remove(RoaringContainer *container, uint16_t low)
+{
+    RoaringRun *runs = container->data.runs;
+    int32_t i = run_find(runs, container->size, low);
+    if (i < 0 || low > (uint32_t)runs[i].start + runs[i].length) {
+        return 0;
+    }
+
+    uint32_t start = runs[i].start;
+    uint32_t end = start + runs[i].length;
+    if (start == end) {
+        memmove(&runs[i],
+                &runs[i + 1],
+                sizeof(RoaringRun) * (container->size - i - 1));
+        --(container->size);
+    } else if (low == start) {
+        ++(runs[i].start);
+        --(runs[i].length);
+    } else if (low == end) {
+        --(runs[i].length);
+    } else {
+        /** split the run in two. */
+        if (container_reserve(container, container->size + 1) != 0) {
+            return -1;
+        }
+        runs = container->data.runs;
+        memmove(&runs[i + 2],
+                &runs[i + 1],
+                sizeof(RoaringRun) * (container->size - i - 1));
+        runs[i + 1].start = (uint16_t)(low + 1);
+        runs[i + 1].length = (uint16_t)(end - low - 1);
+        runs[i].length = (uint16_t)(low - 1 - start);
+        ++(container->size);
+    }
+    --(container->cardinality);
+    return 1;
+}
+
+static int container_remove(RoaringContainer *container, uint16_t low)
+{
+    switch (container->type) {
+    case ROARING_ARRAY: {
+        uint16_t *values = container->data.values;
+        uint32_t i = lower_bound(values, container->size, low);
+        if (i == container->size || values[i] != low) {
+            return 0;
+        }
+        memmove(&values[i],
+                &values[i + 1],
+                sizeof(uint16_t) * (container->size - i - 1));
+        --(container->size);
+        --(container->cardinality);
+        return 1;
+    }
+    case ROARING_BITSET: {
+        uint64_t *word = &(container->data.words[low / 64]);
+        uint64_t bit = 1ULL << (low % 64);
+        if ((*word & bit) == 0) {
+            return 0;
+        }
+        *word &= ~bit;
+        --(container->cardinality);
+        /** stays a (valid) bitset if out of memory. */
+        if (container->cardinality <= ROARING_ARRAY_MAX) {
+            container_bitset_to_array(container);
+        }
+        return 1;
+    }
+    default:
+        return container_run_remove(container, low);
+    }
+}
+
+/** intersect a small array with a large one by binary searches. */
+#define ROARING_GALLOP_RATIO 64
+
+static int array_and_array(const RoaringContainer *a,
+                           const RoaringContainer *b,
+                           RoaringContainer *result)
+{
+    if (a->size > b->size) {
+        const RoaringContainer *swap = a;
+        a = b;
+        b = swap;
+    }
+    if (container_init(result, a->key, ROARING_ARRAY, a->size) != 0) {
+        return -1;
+    }
+
+    const uint16_t *small = a->data.values;
+    const uint16_t *large = b->data.values;
+    uint16_t *out = result->data.values;
+    uint32_t n = 0;
+    uint32_t i = 0, j = 0;
+    if (a->size * ROARING_GALLOP_RATIO < b->size) {
+        for (i = 0; i < a->size && j < b->size; ++i) {
+            j += lower_bound(large + j, b->size - j, small[i]);
+            if (j < b->size && large[j] == small[i]) {
+                out[n++] = small[i];
+            }
+        }
+    } else {
+        /** branchless, the comparisons of a merge are unpredictable. */
+        while (i < a->size && j < b->size) {
+            uint16_t x = small[i];
+            uint16_t y = large[j];
+            out[n] = x;
+            n += x == y;
+            i += x <= y;
+            j += y <= x;
+        }
+    }
+    result->size = result->cardinality = n;
+    return 0;
+}
+
+static int array_and_bitset(const RoaringContainer *array,
+                            const RoaringContainer *bitset,
+                            RoaringContainer *result)
+{
+    if (container_init(result, array->key, ROARING_ARRAY, array->size) != 0) {
+        return -1;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < array->size; ++i) {
+        uint16_t value = array->data.values[i];
+        result->data.values[n] = value;
+        n += (bitset->data.words[value / 64] >> (value % 64)) & 1;
+    }
+    result->size = result->cardinality = n;
+    return 0;
+}
+
+static int array_and_run(const RoaringContainer *array,
+                         const RoaringContainer *run,
+                         RoaringContainer *result)
+{
+    if (container_init(result, array->key, ROARING_ARRAY, array->size) != 0) {
+        return -1;
+    }
+    const RoaringRun *runs = run->data.runs;
+    uint32_t n = 0;
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < array->size && j < run->size; ++i) {
+        uint16_t value = array->data.values[i];
+        while (j < run->size &&
+               (uint32_t)runs[j].start + runs[j].length < value) {
+            ++j;
+        }
+        if (j < run->size && runs[j].start <= value) {
+            result->data.values[n++] = value;
+        }
+    }
+    result->size = result->cardinality = n;
+    return 0;
+}
+
+/** op is and_bitmap, or_bitmap or andnot_bitmap. */
+static int bitset_op_bitset(const RoaringContainer *a,
+                            const RoaringContainer *b,
+                            RoaringContainer *result,
+                            void (*op)(word_t *, const word_t *, unsigned int))
+{
+    if (container_clone(result, a) != 0) {
+        return -1;
+    }
+    op(result->data.words, b->data.words, ROARING_BITSET_WORDS);
+    if (container_shrink_bitset(result) != 0) {
+        container_destroy(result);
+        return -1;
+    }
+    return 0;
+}
+
+static int run_and_run(const RoaringContainer *a,
+                       const RoaringContainer *b,
+                       RoaringContainer *result)
+{
+    if (container_init(result, a->key, ROARING_RUN, a->size + b->size) !=
+        0) {
+        return -1;
+    }
+    uint32_t i = 0, j = 0;
+    while (i < a->size && j < b->size) {
+        const RoaringRun *x = &(a->data.runs[i]);
+        const RoaringRun *y = &(b->data.runs[j]);
+        uint32_t a_end = (uint32_t)x->start + x->length;
+        uint32_t b_end = (uint32_t)y->start + y->length;
+        uint32_t start = x->start > y->start ? x->start : y->start;
+        uint32_t end = a_end < b_end ? a_end : b_end;
+        if (start <= end) {
+            result->data.runs[result->size].start = (uint16_t)start;
+            result->data.runs[result->size++].length = (uint16_t)(end - start);
+            result->cardinality += end - start + 1;
+        }
+        if (a_end < b_end) {
+            ++i;
+        } else {
+            ++j;
+        }
+    }
+    if (container_shrink_run(result) != 0) {
+        container_destroy(result);
+        return -1;
+    }
+    return 0;
+}
+
+static int container_and(const RoaringContainer *a,
+                         const RoaringContainer *b,
+                         RoaringContainer *result)
+{
+    if (a->type == ROARING_RUN || b->type == ROARING_RUN) {
+        if (a->type == ROARING_RUN && b->type == ROARING_RUN) {
+            return run_and_run(a, b, result);
+        }
+        const RoaringContainer *run = a->type == ROARING_RUN ? a : b;
+        const RoaringContainer *other = run == a ? b : a;
+        if (run_is_full(run)) {
+            return container_clone(result, other);
+        }
+        if (other->type == ROARING_ARRAY) {
+            return array_and_run(other, run, result);
+        }
+        RoaringContainer natural;
+        if (container_natural_copy(&natural, run) != 0) {
+            return -1;
+        }
+        int status = container_and(&natural, other, result);
+        container_destroy(&natural);
+        return status;
+    }
+
+    if (a->type == ROARING_ARRAY && b->type == ROARING_ARRAY) {
+        return array_and_array(a, b, result);
+    } else if (a->type == ROARING_ARRAY) {
+        return array_and_bitset(a, b, result);
+    } else if (b->type == ROARING_ARRAY) {
+        return array_and_bitset(b, a, result);
+    }
+    return bitset_op_bitset(a, b, result, and_bitmap);
+}
+
+static int array_or_array(const RoaringContainer *a,
+                          const RoaringContainer *b,
+                          RoaringContainer *result)
+{
+    if (a->size + b->size > ROARING_ARRAY_MAX) {
+        if (container_init(result, a->key, ROARING_BITSET, 0) != 0) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < a->size; ++i) {
+            uint16_t value = a->data.values[i];
+            result->data.words[value / 64] |= 1ULL << (value % 64);
+        }
+        for (uint32_t i = 0; i < b->size; ++i) {
+            uint16_t value = b->data.values[i];
+            result->data.words[value / 64] |= 1ULL << (value % 64);
+        }
+        if (container_shrink_bitset(result) != 0) {
+            container_destroy(result);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (container_init(result, a->key, ROARING_ARRAY, a->size + b->size) !=
+        0) {
+        return -1;
+    }
+    const uint16_t *x = a->data.values;
+    const uint16_t *y = b->data.values;
+    uint16_t *out = result->data.values;
+    uint32_t n = 0;
+    uint32_t i = 0, j = 0;
+    while (i < a->size && j < b->size) {
+        uint16_t u = x[i];
+        uint16_t v = y[j];
+        out[n++] = u < v ? u : v;
+        i += u <= v;
+        j += v <= u;
+    }
+    while (i < a->size) {
+        out[n++] = x[i++];
+    }
+    while (j < b->size) {
+        out[n++] = y[j++];
+    }
+    result->size = result->cardinality = n;
+    return 0;
+}
+
+static int array_or_bitset(const RoaringContainer *array,
+                           const RoaringContainer *bitset,
+                           RoaringContainer *result)
+{
+    if (container_clone(result, bitset) != 0) {
+        return -1;
+    }
+    uint64_t *words = result->data.words;
+    for (uint32_t i = 0; i < array->size; ++i) {
+        uint16_t value = array->data.values[i];
+        uint64_t bit = 1ULL << (value % 64);
+        result->cardinality += (words[value / 64] & bit) == 0;
+        words[value / 64] |= bit;
+    }
+    return 0;
+}
+
+static int run_or_run(const RoaringContainer *a,
+                      const RoaringContainer *b,
+                      RoaringContainer *result)
+{
+    if (container_init(result, a->key, ROARING_RUN, a->size + b->size) !=
+        0) {
+        return -1;
+    }
+    RoaringRun *out = result->data.runs;
+    uint32_t i = 0, j = 0;
+    while (i < a->size || j < b->size) {
+        const RoaringRun *run;
+        if (j == b->size ||
+            (i < a->size && a->data.runs[i].start <= b->data.runs[j].start)) {
+            run = &(a->data.runs[i++]);
+        } else {
+            run = &(b->data.runs[j++]);
+        }
+        uint32_t end = (uint32_t)run->start + run->length;
+        if (result->size > 0) {
+            RoaringRun *last = &out[result->size - 1];
+            uint32_t last_end = (uint32_t)last->start + last->length;
+            /** overlapping or adjacent runs are merged. */
+            if (run->start <= last_end + 1) {
+                if (end > last_end) {
+                    last->length = (uint16_t)(end - last->start);
+                }
+                continue;
+            }
+        }
+        out[result->size++] = *run;
+    }
+    for (i = 0; i < result->size; ++i) {
+        result->cardinality += (uint32_t)out[i].length + 1;
+    }
+    if (container_shrink_run(result) != 0) {
+        container_destroy(result);
+        return -1;
+    }
+    return 0;
+}
+
+static int container_or(const RoaringContainer *a,
+                        const RoaringContainer *b,
+                        RoaringContainer *result)
+{
+    if (a->type == ROARING_RUN || b->type == ROARING_RUN) {
+        if (run_is_full(a)) {
+            return container_clone(result, a);
+        } else if (run_is_full(b)) {
+            return container_clone(result, b);
+        } else if (a->type == ROARING_RUN && b->type == ROARING_RUN) {
+            return run_or_run(a, b, result);
+        }
+        const RoaringContainer *run = a->type == ROARING_RUN ? a : b;
+        const RoaringContainer *other = run == a ? b : a;
+        RoaringContainer natural;
+        if (container_natural_copy(&natural, run) != 0) {
+            return -1;
+        }
+        int status = container_or(&natural, other, result);
+        container_destroy(&natural);
+        return status;
+    }
+
+    if (a->type == ROARING_ARRAY && b->type == ROARING_ARRAY) {
+        return array_or_array(a, b, result);
+    } else if (a->type == ROARING_ARRAY) {
+        return array_or_bitset(a, b, result);
+    } else if (b->type == ROARING_ARRAY) {
+        return array_or_bitset(b, a, result);
+    }
+    return bitset_op_bitset(a, b, result, or_bitmap);
+}
+
+static int array_andnot_array(const RoaringContainer *a,
+                              const RoaringContainer *b,
+                              RoaringContainer *result)
+{
+    if (container_init(result, a->key, ROARING_ARRAY, a->size) != 0) {
+        return -1;
+    }
+    const uint16_t *x = a->data.values;
+    const uint16_t *y = b->data.values;
+    uint16_t *out = result->data.values;
+    uint32_t n = 0;
+    uint32_t i = 0, j = 0;
+    while (i < a->size && j < b->size) {
+        uint16_t u = x[i];
+        uint16_t v = y[j];
+        out[n] = u;
+        n += u < v;
+        i += u <= v;
+        j += v <= u;
+    }
+    while (i < a->size) {
+        out[n++] = x[i++];
+    }
+    result->size = result->cardinality = n;
+    return 0;
+}
+
+static int array_andnot_bitset(const RoaringContainer *array,
+                               const RoaringContainer *bitset,
+                               RoaringContainer *result)
+{
+    if (container_init(result, array->key, ROARING_ARRAY, array->size) != 0) {
+        return -1;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < array->size; ++i) {
+        uint16_t value = array->data.values[i];
+        result->data.values[n] = value;
+        n += ((bitset->data.words[value / 64] >> (value % 64)) & 1) ^ 1;
+    }
+    result->size = result->cardinality = n;
+    return 0;
+}
+
+static int bitset_andnot_array(const RoaringContainer *bitset,
+                               const RoaringContainer *array,
+                               RoaringContainer *result)
+{
+    if (container_clone(result, bitset) != 0) {
+        return -1;
+    }
+    uint64_t *words = result->data.words;
+    for (uint32_t i = 0; i < array->size; ++i) {
+        uint16_t value = array->data.values[i];
+        words[value / 64] &= ~(1ULL << (value % 64));
+    }
+    if (container_shrink_bitset(result) != 0) {
+        container_destroy(result);
+        return -1;
+    }
+    return 0;
+}
+
+static int run_andnot_run(const RoaringContainer *a,
+                          const RoaringContainer *b,
+                          RoaringContainer *result)
+{
+    if (container_init(result, a->key, ROARING_RUN, a->size + b->size) !=
+        0) {
+        return -1;
+    }
+    const RoaringRun *y = b->data.runs;
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < a->size; ++i) {
+        uint32_t start = a->data.runs[i].start;
+        uint32_t end = start + a->data.runs[i].length;
+        while (j < b->size && (uint32_t)y[j].start + y[j].length < start) {
+            ++j;
+        }
+        /** cut the runs of b out of [start, end]. */
+        for (uint32_t k = j; k < b->size && y[k].start <= end; ++k) {
+            if (y[k].start > start) {
+                result->data.runs[result->size].start = (uint16_t)start;
+                result->data.runs[result->size++].length =
+                    (uint16_t)(y[k].start - 1 - start);
+                result->cardinality += y[k].start - start;
+            }
+            start = (uint32_t)y[k].start + y[k].length + 1;
+            if (start > end) {
+                break;
+            }
+        }
+        if (start <= end) {
+            result->data.runs[result->size].start = (uint16_t)start;
+            result->data.runs[result->size++].length = (uint16_t)(end - start);
+            result->cardinality += end - start + 1;
+        }
+    }
+    if (container_shrink_run(result) != 0) {
+        container_destroy(result);
+        return -1;
+    }
+    return 0;
+}
+
+static int container_andnot(const RoaringContainer *a,
+                            const RoaringContainer *b,
+                            RoaringContainer *result)
+{
+    if (a->type == ROARING_RUN || b->type == ROARING_RUN) {
+        if (run_is_full(b)) {
+            result->key = a->key;
+            result->type = ROARING_ARRAY;
+            result->data.values = NULL;
+            result->cardinality = result->size = result->capacity = 0;
+            return 0;
+        } else if (a->type == ROARING_RUN && b->type == ROARING_RUN) {
+            return run_andnot_run(a, b, result);
+        }
+        /** difference on the natural form of the run containers. */
+        RoaringContainer natural_a, natural_b;
+        if (a->type == ROARING_RUN) {
+            if (container_natural_copy(&natural_a, a) != 0) {
+                return -1;
+            }
+        }
+        if (b->type == ROARING_RUN) {
+            if (container_natural_copy(&natural_b, b) != 0) {
+                if (a->type == ROARING_RUN) {
+                    container_destroy(&natural_a);
+                }
+                return -1;
+            }
+        }
+        int status =
+            container_andnot(a->type == ROARING_RUN ? &natural_a : a,
+                             b->type == ROARING_RUN ? &natural_b : b,
+                             result);
+        if (a->type == ROARING_RUN) {
+            container_destroy(&natural_a);
+        }
+        if (b->type == ROARING_RUN) {
+            container_destroy(&natural_b);
+        }
+        return status;
+    }
+
+    if (a->type == ROARING_ARRAY && b->type == ROARING_ARRAY) {
+        return array_andnot_array(a, b, result);
+    } else if (a->type == ROARING_ARRAY) {
+        return array_andnot_bitset(a, b, result);
+    } else if (b->type == ROARING_ARRAY) {
+        return bitset_andnot_array(a, b, result);
+    }
+    return bitset_op_bitset(a, b, result, andnot_bitmap);
+}
+
+static int roaring_reserve(Roaring *roaring, unsigned int size)
+{
+    if (size <= roaring->capacity) {
+        return 0;
+    }
+    unsigned int capacity = roaring->capacity * 2;
+    if (capacity < 4) {
+        capacity = 4;
+    }
+    if (capacity < size) {
+        capacity = size;
+    }
+    RoaringContainer *containers = (RoaringContainer *)realloc(
+        roaring->containers, sizeof(RoaringContainer) * capacity);
+    if (containers == NULL) {
+        return -1;
+    }
+    roaring->containers = containers;
+    roaring->capacity = capacity;
+    return 0;
+}
+
+/** the index of the container of key, or -(the index to insert at) - 1. */
+static int roaring_find(const Roaring *roaring, uint16_t key)
+{
+    int low = 0;
+    int high = (int)roaring->size - 1;
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+        uint16_t middle_key = roaring->containers[middle].key;
+        if (middle_key < key) {
+            low = middle + 1;
+        } else if (middle_key > key) {
+            high = middle - 1;
+        } else {
+            return middle;
+        }
+    }
+    return -low - 1;
+}
+
+/** move a container into a Roaring at index, it's freed on failure. */
+static int roaring_insert(Roaring *roaring,
+                          unsigned int index,
+                          RoaringContainer *container)
+{
+    if (roaring_reserve(roaring, roaring->size + 1) != 0) {
+        container_destroy(container);
+        return -1;
+    }
+    memmove(&(roaring->containers[index + 1]),
+            &(roaring->containers[index]),
+            sizeof(RoaringContainer) * (roaring->size - index));
+    roaring->containers[index] = *container;
+    ++(roaring->size);
+    return 0;
+}
+
+/** move a container to the end of a Roaring, an empty one is dropped. */
+static int roaring_append(Roaring *roaring, RoaringContainer *container)
+{
+    if (container->cardinality == 0) {
+        container_destroy(container);
+        return 0;
+    }
+    return roaring_insert(roaring, roaring->size, container);
+}
+
+static void roaring_remove_container(Roaring *roaring, unsigned int index)
+{
+    container_destroy(&(roaring->containers[index]));
+    memmove(&(roaring->containers[index]),
+            &(roaring->containers[index + 1]),
+            sizeof(RoaringContainer) * (roaring->size - index - 1));
+    --(roaring->size);
+}
+
+Roaring *roaring_new()
+{
+    Roaring *roaring = (Roaring *)malloc(sizeof(Roaring));
+    if (roaring == NULL) {
+        return NULL;
+    }
+    roaring->containers = NULL;
+    roaring->size = 0;
+    roaring->capacity = 0;
+    return roaring;
+}
+
+Roaring *roaring_clone(const Roaring *roaring)
+{
+    Roaring *clone = roaring_new();
+    if (clone == NULL || roaring_reserve(clone, roaring->size) != 0) {
+        roaring_free(clone);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        RoaringContainer container;
+        if (container_clone(&container, &(roaring->containers[i])) != 0) {
+            roaring_free(clone);
+            return NULL;
+        }
+        clone->containers[clone->size++] = container;
+    }
+    return clone;
+}
+
+void roaring_free(Roaring *roaring)
+{
+    if (roaring == NULL) {
+        return;
+    }
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        container_destroy(&(roaring->containers[i]));
+    }
+    free(roaring->containers);
+    free(roaring);
+}
+
+int roaring_add(Roaring *roaring, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    int index = roaring_find(roaring, key);
+    if (index < 0) {
+        RoaringContainer container;
+        index = -index - 1;
+        if (container_init(&container, key, ROARING_ARRAY, 4) != 0 ||
+            roaring_insert(roaring, index, &container) != 0) {
+            return -1;
+        }
+    }
+    return container_add(&(roaring->containers[index]), (uint16_t)value);
+}
+
+int roaring_add_range(Roaring *roaring, uint32_t start, uint64_t end)
+{
+    if (end > (uint64_t)UINT32_MAX + 1) {
+        end = (uint64_t)UINT32_MAX + 1;
+    }
+    uint64_t value = start;
+    while (value < end) {
+        uint16_t key = (uint16_t)(value >> 16);
+        uint64_t chunk_end = ((uint64_t)key + 1) * ROARING_CHUNK_VALUES;
+        if (chunk_end > end) {
+            chunk_end = end;
+        }
+
+        RoaringContainer range;
+        if (container_init(&range, key, ROARING_RUN, 1) != 0) {
+            return -1;
+        }
+        range.data.runs[0].start = (uint16_t)value;
+        range.data.runs[0].length = (uint16_t)(chunk_end - value - 1);
+        range.size = 1;
+        range.cardinality = (uint32_t)(chunk_end - value);
+
+        int index = roaring_find(roaring, key);
+        if (index < 0) {
+            if (roaring_insert(roaring, -index - 1, &range) != 0) {
+                return -1;
+            }
+        } else {
+            RoaringContainer merged;
+            int status =
+                container_or(&(roaring->containers[index]), &range, &merged);
+            container_destroy(&range);
+            if (status != 0) {
+                return -1;
+            }
+            container_destroy(&(roaring->containers[index]));
+            roaring->containers[index] = merged;
+        }
+        value = chunk_end;
+    }
+    return 0;
+}
+
+int roaring_remove(Roaring *roaring, uint32_t value)
+{
+    int index = roaring_find(roaring, (uint16_t)(value >> 16));
+    if (index < 0) {
+        return 0;
+    }
+    int status = container_remove(&(roaring->containers[index]),
+                                  (uint16_t)value);
+    if (roaring->containers[index].cardinality == 0) {
+        roaring_remove_container(roaring, index);
+    }
+    return status;
+}
+
+int roaring_contains(const Roaring *roaring, uint32_t value)
+{
+    int index = roaring_find(roaring, (uint16_t)(value >> 16));
+    return index >= 0 &&
+           container_contains(&(roaring->containers[index]), (uint16_t)value);
+}
+
+uint64_t roaring_cardinality(const Roaring *roaring)
+{
+    uint64_t cardinality = 0;
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        cardinality += roaring->containers[i].cardinality;
+    }
+    return cardinality;
+}
+
+/** write the 1024 words of a container. */
+static void container_to_words(const RoaringContainer *container,
+                               uint64_t *words)
+{
+    memset(words, 0, sizeof(uint64_t) * ROARING_BITSET_WORDS);
+    switch (container->type) {
+    case ROARING_ARRAY:
+        for (uint32_t i = 0; i < container->size; ++i) {
+            uint16_t value = container->data.values[i];
+            words[value / 64] |= 1ULL << (value % 64);
+        }
+        break;
+    case ROARING_BITSET:
+        memcpy(words,
+               container->data.words,
+               sizeof(uint64_t) * ROARING_BITSET_WORDS);
+        break;
+    case ROARING_RUN:
+        for (uint32_t i = 0; i < container->size; ++i) {
+            const RoaringRun *run = &(container->data.runs[i]);
+            words_set_range(
+                words, run->start, (uint64_t)run->start + run->length + 1);
+        }
+        break;
+    }
+}
+
+static int container_equal(const RoaringContainer *a,
+                           const RoaringContainer *b)
+{
+    if (a->key != b->key || a->cardinality != b->cardinality) {
+        return 0;
+    }
+    if (a->type == b->type) {
+        return a->size == b->size &&
+               memcmp(a->data.values,
+                      b->data.values,
+                      container_element_size(a) * a->size) == 0;
+    }
+
+    /** a run container may hold the same values as an array or bitset. */
+    uint64_t words[2 * ROARING_BITSET_WORDS];
+    container_to_words(a, words);
+    container_to_words(b, words + ROARING_BITSET_WORDS);
+    return memcmp(words,
+                  words + ROARING_BITSET_WORDS,
+                  sizeof(uint64_t) * ROARING_BITSET_WORDS) == 0;
+}
+
+int roaring_equal(const Roaring *roaring1, const Roaring *roaring2)
+{
+    if (roaring1->size != roaring2->size) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < roaring1->size; ++i) {
+        if (!container_equal(&(roaring1->containers[i]),
+                             &(roaring2->containers[i]))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+Roaring *roaring_and(const Roaring *roaring1, const Roaring *roaring2)
+{
+    Roaring *result = roaring_new();
+    if (result == NULL) {
+        return NULL;
+    }
+    unsigned int i = 0, j = 0;
+    while (i < roaring1->size && j < roaring2->size) {
+        const RoaringContainer *a = &(roaring1->containers[i]);
+        const RoaringContainer *b = &(roaring2->containers[j]);
+        if (a->key < b->key) {
+            ++i;
+        } else if (a->key > b->key) {
+            ++j;
+        } else {
+            RoaringContainer container;
+            if (container_and(a, b, &container) != 0 ||
+                roaring_append(result, &container) != 0) {
+                roaring_free(result);
+                return NULL;
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+Roaring *roaring_or(const Roaring *roaring1, const Roaring *roaring2)
+{
+    Roaring *result = roaring_new();
+    if (result == NULL ||
+        roaring_reserve(result, roaring1->size + roaring2->size) != 0) {
+        roaring_free(result);
+        return NULL;
+    }
+    unsigned int i = 0, j = 0;
+    while (i < roaring1->size || j < roaring2->size) {
+        const RoaringContainer *a =
+            i < roaring1->size ? &(roaring1->containers[i]) : NULL;
+        const RoaringContainer *b =
+            j < roaring2->size ? &(roaring2->containers[j]) : NULL;
+        RoaringContainer container;
+        int status;
+        if (b == NULL || (a != NULL && a->key < b->key)) {
+            status = container_clone(&container, a);
+            ++i;
+        } else if (a == NULL || a->key > b->key) {
+            status = container_clone(&container, b);
+            ++j;
+        } else {
+            status = container_or(a, b, &container);
+            ++i;
+            ++j;
+        }
+        if (status != 0 || roaring_append(result, &container) != 0) {
+            roaring_free(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+Roaring *roaring_andnot(const Roaring *roaring1, const Roaring *roaring2)
+{
+    Roaring *result = roaring_new();
+    if (result == NULL) {
+        return NULL;
+    }
+    unsigned int j = 0;
+    for (unsigned int i = 0; i < roaring1->size; ++i) {
+        const RoaringContainer *a = &(roaring1->containers[i]);
+        while (j < roaring2->size && roaring2->containers[j].key < a->key) {
+            ++j;
+        }
+        RoaringContainer container;
+        int status;
+        if (j < roaring2->size && roaring2->containers[j].key == a->key) {
+            status =
+                container_andnot(a, &(roaring2->containers[j]), &container);
+        } else {
+            status = container_clone(&container, a);
+        }
+        if (status != 0 || roaring_append(result, &container) != 0) {
+            roaring_free(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+int roaring_run_optimize(Roaring *roaring)
+{
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        RoaringContainer *container = &(roaring->containers[i]);
+        int status = 0;
+        if (container->type == ROARING_RUN) {
+            status = container_shrink_run(container);
+        } else if (container_count_runs(container) * sizeof(RoaringRun) <
+                   natural_bytes(container->cardinality)) {
+            status = container_to_run(container);
+        }
+        if (status != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+size_t roaring_size_in_bytes(const Roaring *roaring)
+{
+    size_t size =
+        sizeof(Roaring) + sizeof(RoaringContainer) * roaring->capacity;
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        const RoaringContainer *container = &(roaring->containers[i]);
+        size += container_element_size(container) * container->capacity;
+    }
+    return size;
+}
+
+void roaring_iterate(const Roaring *roaring, RoaringIterator *iterator)
+{
+    iterator->roaring = roaring;
+    iterator->container = 0;
+    iterator->position = 0;
+    iterator->low = 0;
+    iterator->word = 0;
+}
+
+int roaring_iter_next(RoaringIterator *iterator, uint32_t *value)
+{
+    const Roaring *roaring = iterator->roaring;
+    while (iterator->container < roaring->size) {
+        const RoaringContainer *container =
+            &(roaring->containers[iterator->container]);
+        uint32_t high = (uint32_t)container->key << 16;
+        if (container->type == ROARING_ARRAY) {
+            if (iterator->position < container->size) {
+                *value = high | container->data.values[iterator->position++];
+                return 1;
+            }
+        } else if (container->type == ROARING_BITSET) {
+            while (iterator->word == 0 &&
+                   iterator->position < ROARING_BITSET_WORDS) {
+                iterator->word = container->data.words[iterator->position++];
+            }
+            if (iterator->word != 0) {
+                *value = high | ((iterator->position - 1) * 64 +
+                                 roaring_ctz(iterator->word));
+                iterator->word &= iterator->word - 1;
+                return 1;
+            }
+        } else if (iterator->position < container->size) {
+            const RoaringRun *run = &(container->data.runs[iterator->position]);
+            if (iterator->low < run->start) {
+                iterator->low = run->start;
+            }
+            *value = high | iterator->low;
+            if (iterator->low == (uint32_t)run->start + run->length) {
+                ++(iterator->position);
+            }
+            ++(iterator->low);
+            return 1;
+        }
+
+        ++(iterator->container);
+        iterator->position = 0;
+        iterator->low = 0;
+        iterator->word = 0;
+    }
+    return 0;
+}
+
+size_t roaring_to_array(const Roaring *roaring, uint32_t *values)
+{
+    size_t n = 0;
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        const RoaringContainer *container = &(roaring->containers[i]);
+        uint32_t high = (uint32_t)container->key << 16;
+        switch (container->type) {
+        case ROARING_ARRAY:
+            for (uint32_t j = 0; j < container->size; ++j) {
+                values[n++] = high | container->data.values[j];
+            }
+            break;
+        case ROARING_BITSET:
+            for (uint32_t j = 0; j < ROARING_BITSET_WORDS; ++j) {
+                uint64_t word = container->data.words[j];
+                while (word != 0) {
+                    values[n++] = high | (j * 64 + roaring_ctz(word));
+                    word &= word - 1;
+                }
+            }
+            break;
+        case ROARING_RUN:
+            for (uint32_t j = 0; j < container->size; ++j) {
+                const RoaringRun *run = &(container->data.runs[j]);
+                uint32_t end = (uint32_t)run->start + run->length;
+                for (uint32_t low = run->start; low <= end; ++low) {
+                    values[n++] = high | low;
+                }
+            }
+            break;
+        }
+    }
+    return n;
+}
+
+Roaring *roaring_from_bitmap(const BitMap *bitmap)
+{
+    Roaring *roaring = roaring_new();
+    if (roaring == NULL) {
+        return NULL;
+    }
+    /** bits past num_bits are 0, so whole words are taken. */
+    for (unsigned int first = 0; first < bitmap->num_words;
+         first += ROARING_BITSET_WORDS) {
+        unsigned int num_words = bitmap->num_words - first;
+        if (num_words > ROARING_BITSET_WORDS) {
+            num_words = ROARING_BITSET_WORDS;
+        }
+        uint32_t cardinality = count_bitmap(bitmap->words + first, num_words);
+        if (cardinality == 0) {
+            continue;
+        }
+
+        RoaringContainer container;
+        uint16_t key = (uint16_t)(first / ROARING_BITSET_WORDS);
+        if (cardinality <= ROARING_ARRAY_MAX) {
+            if (container_init(&container, key, ROARING_ARRAY, cardinality) !=
+                0) {
+                roaring_free(roaring);
+                return NULL;
+            }
+            for (unsigned int i = 0; i < num_words; ++i) {
+                uint64_t word = bitmap->words[first + i];
+                while (word != 0) {
+                    container.data.values[container.size++] =
+                        (uint16_t)(i * 64 + roaring_ctz(word));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            if (container_init(&container, key, ROARING_BITSET, 0) != 0) {
+                roaring_free(roaring);
+                return NULL;
+            }
+            memcpy(container.data.words,
+                   bitmap->words + first,
+                   sizeof(uint64_t) * num_words);
+        }
+        container.cardinality = cardinality;
+        if (roaring_append(roaring, &container) != 0) {
+            roaring_free(roaring);
+            return NULL;
+        }
+    }
+    return roaring;
+}
+
+BitMap *roaring_to_bitmap(const Roaring *roaring)
+{
+    if (roaring->size == 0) {
+        return bitmap_new(0);
+    }
+
+    /** the maximum value is in the last container. */
+    const RoaringContainer *last = &(roaring->containers[roaring->size - 1]);
+    uint32_t max_low = 0;
+    if (last->type == ROARING_ARRAY) {
+        max_low = last->data.values[last->size - 1];
+    } else if (last->type == ROARING_RUN) {
+        max_low = (uint32_t)last->data.runs[last->size - 1].start +
+                  last->data.runs[last->size - 1].length;
+    } else {
+        for (uint32_t i = ROARING_BITSET_WORDS; i-- > 0;) {
+            uint64_t word = last->data.words[i];
+            if (word != 0) {
+                while (word >> 1) {
+                    word >>= 1;
+                    ++max_low;
+                }
+                max_low += i * 64;
+                break;
+            }
+        }
+    }
+    uint32_t max = ((uint32_t)last->key << 16) | max_low;
+    if (max == UINT32_MAX) {
+        return NULL;
+    }
+
+    BitMap *bitmap = bitmap_new(max + 1);
+    uint64_t words[ROARING_BITSET_WORDS];
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        const RoaringContainer *container = &(roaring->containers[i]);
+        unsigned int first =
+            (unsigned int)container->key * ROARING_BITSET_WORDS;
+        unsigned int num_words = bitmap->num_words - first;
+        if (num_words > ROARING_BITSET_WORDS) {
+            num_words = ROARING_BITSET_WORDS;
+        }
+        container_to_words(container, words);
+        memcpy(bitmap->words + first, words, sizeof(uint64_t) * num_words);
+    }
+    return bitmap;
+}
+
+static inline unsigned char *put_uint16(unsigned char *buffer, uint16_t value)
+{
+    buffer[0] = (unsigned char)value;
+    buffer[1] = (unsigned char)(value >> 8);
+    return buffer + 2;
+}
+
+static inline unsigned char *put_uint32(unsigned char *buffer, uint32_t value)
+{
+    buffer = put_uint16(buffer, (uint16_t)value);
+    return put_uint16(buffer, (uint16_t)(value >> 16));
+}
+
+static inline unsigned char *put_uint64(unsigned char *buffer, uint64_t value)
+{
+    buffer = put_uint32(buffer, (uint32_t)value);
+    return put_uint32(buffer, (uint32_t)(value >> 32));
+}
+
+static inline uint16_t get_uint16(const unsigned char *buffer)
+{
+    return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+static inline uint32_t get_uint32(const unsigned char *buffer)
+{
+    return get_uint16(buffer) | ((uint32_t)get_uint16(buffer + 2) << 16);
+}
+
+static inline uint64_t get_uint64(const unsigned char *buffer)
+{
+    return get_uint32(buffer) | ((uint64_t)get_uint32(buffer + 4) << 32);
+}
+
+/** key, type and cardinality - 1. */
+#define ROARING_CONTAINER_HEADER 5
+
+size_t roaring_serialized_size(const Roaring *roaring)
+{
+    size_t size = 2 * sizeof(uint32_t);
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        const RoaringContainer *container = &(roaring->containers[i]);
+        size += ROARING_CONTAINER_HEADER;
+        if (container->type == ROARING_RUN) {
+            size += sizeof(uint16_t);
+        }
+        size += container_element_size(container) * container->size;
+    }
+    return size;
+}
+
+size_t roaring_serialize(const Roaring *roaring, unsigned char *buffer)
+{
+    unsigned char *p = put_uint32(buffer, ROARING_COOKIE);
+    p = put_uint32(p, roaring->size);
+    for (unsigned int i = 0; i < roaring->size; ++i) {
+        const RoaringContainer *container = &(roaring->containers[i]);
+        p = put_uint16(p, container->key);
+        *p++ = container->type;
+        p = put_uint16(p, (uint16_t)(container->cardinality - 1));
+        switch (container->type) {
+        case ROARING_ARRAY:
+            for (uint32_t j = 0; j < container->size; ++j) {
+                p = put_uint16(p, container->data.values[j]);
+            }
+            break;
+        case ROARING_BITSET:
+            for (uint32_t j = 0; j < ROARING_BITSET_WORDS; ++j) {
+                p = put_uint64(p, container->data.words[j]);
+            }
+            break;
+        case ROARING_RUN:
+            p = put_uint16(p, (uint16_t)container->size);
+            for (uint32_t j = 0; j < container->size; ++j) {
+                p = put_uint16(p, container->data.runs[j].start);
+                p = put_uint16(p, container->data.runs[j].length);
+            }
+            break;
+        }
+    }
+    return (size_t)(p - buffer);
+}
+
+/** read a container's payload, checking it keeps the invariants. */
+static int container_deserialize(RoaringContainer *container,
+                                 const unsigned char **buffer,
+                                 size_t *remaining)
+{
+    const unsigned char *p = *buffer;
+    uint32_t cardinality = container->cardinality;
+    size_t size;
+    switch (container->type) {
+    case ROARING_ARRAY:
+        size = sizeof(uint16_t) * cardinality;
+        if (cardinality > ROARING_ARRAY_MAX || *remaining < size ||
+            container_init(container,
+                           container->key,
+                           ROARING_ARRAY,
+                           cardinality) != 0) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < cardinality; ++i) {
+            uint16_t value = get_uint16(p + 2 * i);
+            if (i > 0 && value <= container->data.values[i - 1]) {
+                container_destroy(container);
+                return -1;
+            }
+            container->data.values[i] = value;
+        }
+        container->size = cardinality;
+        break;
+    case ROARING_BITSET:
+        size = sizeof(uint64_t) * ROARING_BITSET_WORDS;
+        if (cardinality <= ROARING_ARRAY_MAX || *remaining < size ||
+            container_init(container, container->key, ROARING_BITSET, 0) !=
+                0) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < ROARING_BITSET_WORDS; ++i) {
+            container->data.words[i] = get_uint64(p + 8 * i);
+        }
+        if (count_bitmap(container->data.words, ROARING_BITSET_WORDS) !=
+            cardinality) {
+            container_destroy(container);
+            return -1;
+        }
+        break;
+    case ROARING_RUN: {
+        if (*remaining < sizeof(uint16_t)) {
+            return -1;
+        }
+        uint32_t num_runs = get_uint16(p);
+        p += sizeof(uint16_t);
+        *remaining -= sizeof(uint16_t);
+        size = sizeof(RoaringRun) * num_runs;
+        if (num_runs == 0 || *remaining < size ||
+            container_init(container, container->key, ROARING_RUN, num_runs) !=
+                0) {
+            return -1;
+        }
+        uint32_t sum = 0;
+        uint32_t previous_end = 0;
+        for (uint32_t i = 0; i < num_runs; ++i) {
+            uint32_t start = get_uint16(p + 4 * i);
+            uint32_t length = get_uint16(p + 4 * i + 2);
+            /** runs are sorted, neither overlapping nor adjacent. */
+            if (start + length >= ROARING_CHUNK_VALUES ||
+                (i > 0 && start <= previous_end + 1)) {
+                container_destroy(container);
+                return -1;
+            }
+            container->data.runs[i].start = (uint16_t)start;
+            container->data.runs[i].length = (uint16_t)length;
+            previous_end = start + length;
+            sum += length + 1;
+        }
+        container->size = num_runs;
+        if (sum != cardinality) {
+            container_destroy(container);
+            return -1;
+        }
+        break;
+    }
+    default:
+        return -1;
+    }
+    container->cardinality = cardinality;
+    *buffer = p + size;
+    *remaining -= size;
+    return 0;
+}
+
+Roaring *roaring_deserialize(const unsigned char *buffer, size_t size)
+{
+    if (size < 2 * sizeof(uint32_t) || get_uint32(buffer) != ROARING_COOKIE) {
+        return NULL;
+    }
+    uint32_t num_containers = get_uint32(buffer + 4);
+    const unsigned char *p = buffer + 2 * sizeof(uint32_t);
+    size_t remaining = size - 2 * sizeof(uint32_t);
+    if (num_containers > ROARING_CHUNK_VALUES ||
+        num_containers > remaining / ROARING_CONTAINER_HEADER) {
+        return NULL;
+    }
+
+    Roaring *roaring = roaring_new();
+    if (roaring == NULL || roaring_reserve(roaring, num_containers) != 0) {
+        roaring_free(roaring);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < num_containers; ++i) {
+        RoaringContainer container;
+        if (remaining < ROARING_CONTAINER_HEADER) {
+            roaring_free(roaring);
+            return NULL;
+        }
+        container.key = get_uint16(p);
+        container.type = p[2];
+        container.cardinality = (uint32_t)get_uint16(p + 3) + 1;
+        p += ROARING_CONTAINER_HEADER;
+        remaining -= ROARING_CONTAINER_HEADER;
+        if ((i > 0 && container.key <= roaring->containers[i - 1].key) ||
+            container_deserialize(&container, &p, &remaining) != 0) {
+            roaring_free(roaring);
+            return NULL;
+        }
+        roaring->containers[roaring->size++] = container;
+    }
+    if (remaining != 0) {
+        roaring_free(roaring);
+        return NULL;
+    }
+    return roaring;
+}
@@ -0,0 +1,264 @@
+/**
+ * @file roaring.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Compressed bitmap of 32-bit integers (Roaring bitmap).
+ *
+ * The 2^32 values are split into 2^16 chunks by their high 16 bits, only
+ * the chunks holding values get a container, and a container stores the
+ * low 16 bits in the smallest of three forms:
+ *
+ *  - array:  a sorted array of uint16_t, up to 4096 values (8 KB);
+ *  - bitset: 65536 bits in 1024 words, for more than 4096 values;
+ *  - run:    sorted runs of consecutive values, after roaring_run_optimize
+ *            or roaring_add_range.
+ *
+ * So a set of a few thousand ids out of 2^32 costs some KB instead of the
+ * 512 MB of a dense BitMap, and and/or/andnot work container by container,
+ * skipping the chunks which are absent.
+ *
+ * refer to: Chambi, Lemire et al., "Better bitmap performance with Roaring
+ * bitmaps", 2016.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_ROARING_H
+#define RETHINK_C_ROARING_H
+
+#include "bitmap.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Definition of a @ref Roaring.
+ *
+ */
+typedef struct _Roaring Roaring;
+
+/**
+ * @brief An iterator over the values of a @ref Roaring, in ascending order.
+ *
+ *     RoaringIterator iterator;
+ *     uint32_t value;
+ *     roaring_iterate(roaring, &iterator);
+ *     while (roaring_iter_next(&iterator, &value)) { ... }
+ *
+ * The Roaring must not be modified while iterating.
+ */
+typedef struct _RoaringIterator {
+    const Roaring *roaring;
+    /** The index of the current container. */
+    unsigned int container;
+    /** The index of the value, run or word in the current container. */
+    unsigned int position;
+    /** The next low 16 bits in the current run. */
+    uint32_t low;
+    /** The bits not returned yet of the current bitset word. */
+    uint64_t word;
+} RoaringIterator;
+
+/**
+ * @brief Allcate a new empty Roaring.
+ *
+ * @return Roaring*     The new Roaring if success, otherwise return NULL.
+ */
+Roaring *roaring_new();
+
+/**
+ * @brief Clone a Roaring.
+ *
+ * @param roaring       The Roaring.
+ * @return Roaring*     The clone if success, otherwise return NULL.
+ */
+Roaring *roaring_clone(const Roaring *roaring);
+
+/**
+ * @brief Delete a Roaring and free back memory.
+ *
+ * @param roaring   The Roaring to delete.
+ */
+void roaring_free(Roaring *roaring);
+
+/**
+ * @brief Add a value to a Roaring.
+ *
+ * @param roaring   The Roaring.
+ * @param value     The value.
+ * @return int      1 if added, 0 if already in, -1 if out of memory.
+ */
+int roaring_add(Roaring *roaring, uint32_t value);
+
+/**
+ * @brief Add the values [start, end) to a Roaring.
+ *
+ * The chunks fully covered become single run containers.
+ *
+ * @param roaring   The Roaring.
+ * @param start     The first value.
+ * @param end       The value after the last, up to 2^32.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int roaring_add_range(Roaring *roaring, uint32_t start, uint64_t end);
+
+/**
+ * @brief Remove a value from a Roaring.
+ *
+ * @param roaring   The Roaring.
+ * @param value     The value.
+ * @return int      1 if removed, 0 if not in, -1 if out of memory.
+ */
+int roaring_remove(Roaring *roaring, uint32_t value);
+
+/**
+ * @brief Check if a value is in a Roaring.
+ *
+ * @param roaring   The Roaring.
+ * @param value     The value.
+ * @return int      1 if in, 0 if not.
+ */
+int roaring_contains(const Roaring *roaring, uint32_t value);
+
+/**
+ * @brief Get the number of values in a Roaring.
+ *
+ * @param roaring       The Roaring.
+ * @return uint64_t     The cardinality, up to 2^32.
+ */
+uint64_t roaring_cardinality(const Roaring *roaring);
+
+/**
+ * @brief Check if two Roarings hold the same values.
+ *
+ * @param roaring1  One Roaring.
+ * @param roaring2  Another Roaring.
+ * @return int      1 if equal, 0 if not equal.
+ */
+int roaring_equal(const Roaring *roaring1, const Roaring *roaring2);
+
+/**
+ * @brief The intersection of two Roarings.
+ *
+ * @param roaring1      One Roaring.
+ * @param roaring2      Another Roaring.
+ * @return Roaring*     The new Roaring if success, otherwise return NULL.
+ */
+Roaring *roaring_and(const Roaring *roaring1, const Roaring *roaring2);
+
+/**
+ * @brief The union of two Roarings.
+ *
+ * @param roaring1      One Roaring.
+ * @param roaring2      Another Roaring.
+ * @return Roaring*     The new Roaring if success, otherwise return NULL.
+ */
+Roaring *roaring_or(const Roaring *roaring1, const Roaring *roaring2);
+
+/**
+ * @brief The difference of two Roarings, values of roaring1 not in roaring2.
+ *
+ * @param roaring1      One Roaring.
+ * @param roaring2      Another Roaring.
+ * @return Roaring*     The new Roaring if success, otherwise return NULL.
+ */
+Roaring *roaring_andnot(const Roaring *roaring1, const Roaring *roaring2);
+
+/**
+ * @brief Convert the containers to run containers where runs are smaller.
+ *
+ * @param roaring   The Roaring.
+ * @return int      0 if success, -1 if out of memory.
+ */
+int roaring_run_optimize(Roaring *roaring);
+
+/**
+ * @brief Get the memory used by a Roaring, in bytes.
+ *
+ * @param roaring   The Roaring.
+ * @return size_t   The allocated bytes.
+ */
+size_t roaring_size_in_bytes(const Roaring *roaring);
+
+/**
+ * @brief Start an iteration over a Roaring.
+ *
+ * @param roaring   The Roaring.
+ * @param iterator  The iterator to initialize.
+ */
+void roaring_iterate(const Roaring *roaring, RoaringIterator *iterator);
+
+/**
+ * @brief Get the next value of an iteration.
+ *
+ * @param iterator  The iterator.
+ * @param value     The output value.
+ * @return int      1 if a value is output, 0 if the iteration ends.
+ */
+int roaring_iter_next(RoaringIterator *iterator, uint32_t *value);
+
+/**
+ * @brief Write all values of a Roaring to an array, in ascending order.
+ *
+ * @param roaring   The Roaring.
+ * @param values    The array, roaring_cardinality() values long.
+ * @return size_t   The number of values written.
+ */
+size_t roaring_to_array(const Roaring *roaring, uint32_t *values);
+
+/**
+ * @brief Generate a new Roaring from the 1 bits of a BitMap.
+ *
+ * @param bitmap        The BitMap.
+ * @return Roaring*     The new Roaring if success, otherwise return NULL.
+ */
+Roaring *roaring_from_bitmap(const BitMap *bitmap);
+
+/**
+ * @brief Generate a new BitMap from a Roaring.
+ *
+ * @param roaring   The Roaring.
+ * @return BitMap*  The BitMap of (maximum value + 1) bits, NULL if the
+ *                  maximum value is UINT32_MAX: a BitMap holds fewer than
+ *                  2^32 bits.
+ */
+BitMap *roaring_to_bitmap(const Roaring *roaring);
+
+/**
+ * @brief Get the number of bytes roaring_serialize writes.
+ *
+ * @param roaring   The Roaring.
+ * @return size_t   The number of bytes.
+ */
+size_t roaring_serialized_size(const Roaring *roaring);
+
+/**
+ * @brief Serialize a Roaring to a buffer.
+ *
+ * The format is little-endian whatever the host, containers are written as
+ * they are: a cookie and the number of containers (uint32), then for each
+ * container its key (uint16), type (uint8), cardinality - 1 (uint16) and
+ * the values (uint16 each), the words (uint64 each) or the number of runs
+ * (uint16) and the runs (uint16 start, uint16 length - 1).
+ *
+ * @param roaring   The Roaring.
+ * @param buffer    The buffer, roaring_serialized_size() bytes long.
+ * @return size_t   The number of bytes written.
+ */
+size_t roaring_serialize(const Roaring *roaring, unsigned char *buffer);
+
+/**
+ * @brief Generate a new Roaring from the bytes written by roaring_serialize.
+ *
+ * @param buffer        The buffer.
+ * @param size          The size of buffer in bytes.
+ * @return Roaring*     The new Roaring, NULL if the bytes are not valid or
+ *                      out of memory.
+ */
+Roaring *roaring_deserialize(const unsigned char *buffer, size_t size);
+
+#endif /* #ifndef RETHINK_C_ROARING_H */
@@ -0,0 +1,357 @@
+/**
+ * @file search.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to search.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "search.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEARCH_X86
+#include <immintrin.h>
+#endif
+
+#include "def.h"
+
+/** The bytes of a q-gram of SEARCH_HASHQ. */
+#define SEARCH_Q 4
+
+/** The bits of the q-gram hash. */
+#define SEARCH_HASH_BITS 12
+
+/**
+ * Patterns of this many distinct bytes or fewer are of a small alphabet
+ * (DNA is 4), where the first and last byte filter poorly.
+ */
+#define SEARCH_SMALL_ALPHABET 4
+
+/** From these lengths q-gram Horspool beats the SIMD filter. */
+#define SEARCH_HASHQ_MIN_LENGTH 128
+#define SEARCH_HASHQ_SMALL_ALPHABET_MIN_LENGTH 16
+
+/** The matches found, the first max of them kept, stopped at limit. */
+typedef struct _SearchMatches {
+    unsigned int *matches;
+    unsigned int max;
+    unsigned int count;
+    unsigned int limit;
+} SearchMatches;
+
+/** add a match, return 1 if the limit is reached. */
+static inline int search_found(SearchMatches *found, unsigned int index)
+{
+    if (found->matches != NULL && found->count < found->max) {
+        found->matches[found->count] = index;
+    }
+    return ++found->count >= found->limit;
+}
+
+/** the pattern at text[i], but its first and last byte, known equal. */
+static inline int search_verify(const char *text,
+                                unsigned int i,
+                                const char *pattern,
+                                unsigned int pat_len)
+{
+    return pat_len < 3 ||
+           memcmp(text + i + 1, pattern + 1, pat_len - 2) == 0;
+}
+
+/** the matches at from and after, by memchr of the first byte. */
+static void search_scalar(const char *text,
+                          unsigned int text_len,
+                          const char *pattern,
+                          unsigned int pat_len,
+                          unsigned int from,
+                          SearchMatches *found)
+{
+    if (text_len < pat_len) {
+        return;
+    }
+    const char *end = text + (text_len - pat_len);
+    const char *cursor = text + from;
+    char last = pattern[pat_len - 1];
+    while (cursor <= end) {
+        cursor = (const char *)memchr(cursor, pattern[0], end - cursor + 1);
+        if (cursor == NULL) {
+            return;
+        }
+        unsigned int i = (unsigned int)(cursor - text);
+        if (cursor[pat_len - 1] == last &&
+            search_verify(text, i, pattern, pat_len) &&
+            search_found(found, i)) {
+            return;
+        }
+        ++cursor;
+    }
+}
+
+#if defined(SEARCH_X86) || defined(__SSE2__)
+/** the candidates of mask from i, verified; return 1 if the limit. */
+static inline int search_candidates(const char *text,
+                                    unsigned int i,
+                                    uint32_t mask,
+                                    const char *pattern,
+                                    unsigned int pat_len,
+                                    SearchMatches *found)
+{
+    while (mask != 0) {
+        unsigned int j = i + (unsigned int)__builtin_ctz(mask);
+        if (search_verify(text, j, pattern, pat_len) &&
+            search_found(found, j)) {
+            return 1;
+        }
+        mask &= mask - 1;
+    }
+    return 0;
+}
+#endif
+
+#ifdef __SSE2__
+/**
+ * 16 positions a step: the bytes equal to the first of the pattern, and
+ * pat_len - 1 on to the last, both by one compare.
+ */
+static void search_sse2(const char *text,
+                        unsigned int text_len,
+                        const char *pattern,
+                        unsigned int pat_len,
+                        SearchMatches *found)
+{
+    const __m128i first = _mm_set1_epi8(pattern[0]);
+    const __m128i last = _mm_set1_epi8(pattern[pat_len - 1]);
+    unsigned int i = 0;
+    for (; text_len >= pat_len + 15 && i <= text_len - pat_len - 15;
+         i += 16) {
+        __m128i head = _mm_loadu_si128((const __m128i *)(text + i));
+        __m128i tail =
+            _mm_loadu_si128((const __m128i *)(text + i + pat_len - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last)));
+        if (search_candidates(text, i, mask, pattern, pat_len, found)) {
+            return;
+        }
+    }
+    search_scalar(text, text_len, pattern, pat_len, i, found);
+}
+#endif
+
+#ifdef SEARCH_X86
+/** as search_sse2, 32 positions a step. */
+__attribute__((target("avx2"))) static void
+search_avx2(const char *text,
+            unsigned int text_len,
+            const char *pattern,
+            unsigned int pat_len,
+            SearchMatches *found)
+{
+    const __m256i first = _mm256_set1_epi8(pattern[0]);
+    const __m256i last = _mm256_set1_epi8(pattern[pat_len - 1]);
+    unsigned int i = 0;
+    for (; text_len >= pat_len + 31 && i <= text_len - pat_len - 31;
+         i += 32) {
+        __m256i head = _mm256_loadu_si256((const __m256i *)(text + i));
+        __m256i tail =
+            _mm256_loadu_si256((const __m256i *)(text + i + pat_len - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last)));
+        if (search_candidates(text, i, mask, pattern, pat_len, found)) {
+            return;
+        }
+    }
+    search_scalar(text, text_len, pattern, pat_len, i, found);
+}
+#endif
+
+/** the hash of the q-gram at text. */
+static inline unsigned int search_hash(const char *text)
+{
+    uint32_t gram;
+    memcpy(&gram, text, sizeof(gram));
+    return (unsigned int)((gram * UINT32_C(0x9E3779B1)) >>
+                          (32 - SEARCH_HASH_BITS));
+}
+
+/**
+ * Horspool on the q-gram ending the window: shift it to the rightmost
+ * occurrence of the hash in the pattern but the last, or past. A collision
+ * only shifts less. pat_len >= SEARCH_Q.
+ */
+static void search_hashq(const char *text,
+                         unsigned int text_len,
+                         const char *pattern,
+                         unsigned int pat_len,
+                         SearchMatches *found)
+{
+    if (text_len < pat_len) {
+        return;
+    }
+    unsigned int shifts[1 << SEARCH_HASH_BITS];
+    unsigned int longest = pat_len - SEARCH_Q + 1;
+    for (unsigned int h = 0; h < (1 << SEARCH_HASH_BITS); ++h) {
+        shifts[h] = longest;
+    }
+    for (unsigned int i = 0; i + SEARCH_Q < pat_len; ++i) {
+        shifts[search_hash(pattern + i)] = pat_len - SEARCH_Q - i;
+    }
+    unsigned int last_hash = search_hash(pattern + pat_len - SEARCH_Q);
+    unsigned int last_shift = shifts[last_hash];
+
+    unsigned int end = text_len - pat_len;
+    unsigned int i = 0;
+    while (i <= end) {
+        unsigned int h = search_hash(text + i + pat_len - SEARCH_Q);
+        if (h != last_hash) {
+            i += shifts[h];
+            continue;
+        }
+        if (memcmp(text + i, pattern, pat_len) == 0 && search_found(found, i)) {
+            return;
+        }
+        i += last_shift;
+    }
+}
+
+/** the number of distinct bytes of the pattern, counted up to limit. */
+static unsigned int
+search_alphabet(const char *pattern, unsigned int pat_len, unsigned int limit)
+{
+    unsigned char seen[256] = {0};
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < pat_len && count <= limit; ++i) {
+        unsigned char ch = (unsigned char)pattern[i];
+        count += !seen[ch];
+        seen[ch] = 1;
+    }
+    return count;
+}
+
+/** the SIMD filter this CPU runs, scalar without. */
+static SearchAlgorithm search_filter(SearchAlgorithm algorithm)
+{
+#ifdef SEARCH_X86
+    if (algorithm == SEARCH_AVX2 && __builtin_cpu_supports("avx2")) {
+        return SEARCH_AVX2;
+    }
+#endif
+#ifdef __SSE2__
+    if (algorithm == SEARCH_AVX2 || algorithm == SEARCH_SSE2) {
+        return SEARCH_SSE2;
+    }
+#endif
+    return SEARCH_SCALAR;
+}
+
+SearchAlgorithm search_choose(const char *pattern, unsigned int pat_len)
+{
+    if (pat_len >= SEARCH_HASHQ_MIN_LENGTH) {
+        return SEARCH_HASHQ;
+    }
+    if (pat_len >= SEARCH_HASHQ_SMALL_ALPHABET_MIN_LENGTH &&
+        search_alphabet(pattern, pat_len, SEARCH_SMALL_ALPHABET) <=
+            SEARCH_SMALL_ALPHABET) {
+        return SEARCH_HASHQ;
+    }
+    return search_filter(SEARCH_AVX2);
+}
+
+/** the matches, up to limit. */
+static unsigned int search_run(SearchAlgorithm algorithm,
+                               const char *text,
+                               unsigned int text_len,
+                               const char *pattern,
+                               unsigned int pat_len,
+                               unsigned int *matches,
+                               unsigned int max_matches,
+                               unsigned int limit)
+{
+    SearchMatches found = {matches, max_matches, 0, limit};
+    if (pat_len == 0 || text_len < pat_len) {
+        return 0;
+    }
+
+    if (algorithm == SEARCH_AUTO) {
+        algorithm = search_choose(pattern, pat_len);
+    } else if (algorithm == SEARCH_HASHQ && pat_len < SEARCH_Q) {
+        algorithm = SEARCH_SCALAR;
+    } else if (algorithm != SEARCH_HASHQ) {
+        algorithm = search_filter(algorithm);
+    }
+
+    switch (algorithm) {
+    case SEARCH_HASHQ:
+        search_hashq(text, text_len, pattern, pat_len, &found);
+        break;
+#ifdef SEARCH_X86
+    case SEARCH_AVX2:
+        search_avx2(text, text_len, pattern, pat_len, &found);
+        break;
+#endif
+#ifdef __SSE2__
+    case SEARCH_SSE2:
+        search_sse2(text, text_len, pattern, pat_len, &found);
+        break;
+#endif
+    default:
+        search_scalar(text, text_len, pattern, pat_len, 0, &found);
+        break;
+    }
+    return found.count;
+}
+
+unsigned int search_text_match_all_by(SearchAlgorithm algorithm,
+                                      const char *text,
+                                      unsigned int text_len,
+                                      const char *pattern,
+                                      unsigned int pat_len,
+                                      unsigned int *matches,
+                                      unsigned int max_matches)
+{
+    return search_run(algorithm,
+                      text,
+                      text_len,
+                      pattern,
+                      pat_len,
+                      matches,
+                      max_matches,
+                      UINT32_MAX);
+}
+
+unsigned int search_text_match_all(const char *text,
+                                   unsigned int text_len,
+                                   const char *pattern,
+                                   unsigned int pat_len,
+                                   unsigned int *matches,
+                                   unsigned int max_matches)
+{
+    return search_run(SEARCH_AUTO,
+                      text,
+                      text_len,
+                      pattern,
+                      pat_len,
+                      matches,
+                      max_matches,
+                      UINT32_MAX);
+}
+
+int search_text_match(const char *text,
+                      unsigned int text_len,
+                      const char *pattern,
+                      unsigned int pat_len)
+{
+    unsigned int index;
+    unsigned int count = search_run(
+        SEARCH_AUTO, text, text_len, pattern, pat_len, &index, 1, 1);
+    return count == 0 ? -1 : (int)index;
+}
+
+int search_string_match(const char *text, const char *pattern)
+{
+    return search_text_match(text, strlen(text), pattern, strlen(pattern));
+}
@@ -0,0 +1,128 @@
+/**
+ * @file search.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Substring search: a SIMD filter and hashed q-gram Horspool, picked
+ * by the pattern, finding the first or all matches.
+ *
+ * The SIMD filter compares the first and the last byte of the pattern with
+ * 32 (AVX2) or 16 (SSE2) positions of the text at once, and verifies only
+ * the positions where both are equal by memcmp. Without SIMD, memchr finds
+ * the first byte. Its cost is about one step a position, whatever the
+ * pattern length, and more verifications the smaller the alphabet.
+ *
+ * Hashed q-gram Horspool (Lecroq) hashes the last 4 bytes of the window,
+ * and shifts by the rightmost occurrence of the 4-gram in the pattern: up
+ * to the pattern length less 3, so it is the faster for long patterns, and
+ * for a small alphabet (DNA) where single bytes filter poorly.
+ *
+ * @ref search_choose picks by the length of the pattern and the number of
+ * distinct bytes in it, by the thresholds measured by
+ * benchmark/bench_search.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_SEARCH_H
+#define RETHINK_C_SEARCH_H
+
+/**
+ * @brief The substring search algorithms.
+ */
+typedef enum _SearchAlgorithm {
+    /** Picked by @ref search_choose. */
+    SEARCH_AUTO = 0,
+    /** memchr of the first byte, then the last byte and memcmp. */
+    SEARCH_SCALAR,
+    /** The first and last byte filter, 16 positions a step. */
+    SEARCH_SSE2,
+    /** The first and last byte filter, 32 positions a step. */
+    SEARCH_AVX2,
+    /** Horspool on hashed 4-grams, for patterns of 4 bytes or more. */
+    SEARCH_HASHQ,
+} SearchAlgorithm;
+
+/**
+ * @brief The algorithm SEARCH_AUTO runs for the pattern on this CPU.
+ *
+ * @param pattern           The pattern string.
+ * @param pat_len           The length of pattern string.
+ * @return SearchAlgorithm  The algorithm, not SEARCH_AUTO.
+ */
+SearchAlgorithm search_choose(const char *pattern, unsigned int pat_len);
+
+/**
+ * @brief Find all matches, overlapping, by an algorithm. An algorithm this
+ * CPU or pattern can not run falls back: AVX2 to SSE2 to scalar, q-gram to
+ * scalar for a pattern shorter than 4.
+ *
+ * @param algorithm     The algorithm.
+ * @param text          The text string.
+ * @param text_len      The length of text.
+ * @param pattern       The pattern string, an empty one matches nothing.
+ * @param pat_len       The length of pattern string.
+ * @param matches       The match indexes in order, the first max_matches
+ *                      of them; may be NULL to count only.
+ * @param max_matches   The size of matches.
+ * @return unsigned int The number of matches, may be more than
+ *                      max_matches.
+ */
+unsigned int search_text_match_all_by(SearchAlgorithm algorithm,
+                                      const char *text,
+                                      unsigned int text_len,
+                                      const char *pattern,
+                                      unsigned int pat_len,
+                                      unsigned int *matches,
+                                      unsigned int max_matches);
+
+/**
+ * @brief Find all matches, overlapping, by the algorithm picked by
+ * @ref search_choose.
+ *
+ * @param text          The text string.
+ * @param text_len      The length of text.
+ * @param pattern       The pattern string, an empty one matches nothing.
+ * @param pat_len       The length of pattern string.
+ * @param matches       The match indexes in order, the first max_matches
+ *                      of them; may be NULL to count only.
+ * @param max_matches   The size of matches.
+ * @return unsigned int The number of matches, may be more than
+ *                      max_matches.
+ */
+unsigned int search_text_match_all(const char *text,
+                                   unsigned int text_len,
+                                   const char *pattern,
+                                   unsigned int pat_len,
+                                   unsigned int *matches,
+                                   unsigned int max_matches);
+
+/**
+ * @brief Find the first match, by the algorithm picked by
+ * @ref search_choose.
+ *
+ * @param text      The text string.
+ * @param text_len  The length of text.
+ * @param pattern   The pattern string.
+ * @param pat_len   The length of pattern string.
+ * @return int      The first match index, -1 if no match.
+ */
+int search_text_match(const char *text,
+                      unsigned int text_len,
+                      const char *pattern,
+                      unsigned int pat_len);
+
+/**
+ * @brief Find the first match, by the algorithm picked by
+ * @ref search_choose.
+ *
+ * @param text      The text string.
+ * @param pattern   The pattern string.
+ * @return int      The first match index, -1 if no match.
+ */
+int search_string_match(const char *text, const char *pattern);
+
+#endif /* #ifndef RETHINK_C_SEARCH_H */
@@ -23,16 +23,33 @@
 
 #define SKIP_LIST_NIL NULL
 
-static SkipListNode *
-skip_list_node_new(int level, SkipListKey key, SkipListValue value)
+/** Next pointers of a Slab node are stored right after the node. */
+static inline SkipListNode **skip_list_inline_next(SkipListNode *node)
 {
-    SkipListNode *node = (SkipListNode *)malloc(sizeof(SkipListNode));
+    return (SkipListNode **)(node + 1);
+}
+
+static SkipListNode *skip_list_node_new(SkipList *list,
+                                        int level,
+                                        SkipListKey key,
+                                        SkipListValue value)
+{
+    SkipListNode *node;
+    if (list->slab != NULL) {
+        node = (SkipListNode *)slab_alloc(list->slab);
+    } else {
+        node = (SkipListNode *)malloc(sizeof(SkipListNode));
+    }
 
     node->key = key;
     node->value = value;
 
-    node->next_array =
-        (SkipListNode **)malloc((level + 1) * sizeof(SkipListNode *));
+    if (list->slab != NULL && level < SKIP_LIST_INLINE_LEVELS) {
+        node->next_array = skip_list_inline_next(node);
+    } else {
+        node->next_array =
+            (SkipListNode **)malloc((level + 1) * sizeof(SkipListNode *));
+    }
     for (int i = 0; i <= level; i++) {
         node->next_array[i] = NULL;
     }
@@ -40,6 +57,19 @@ skip_list_node_new(int level, SkipListKey key, SkipListValue value)
     return node;
 }
 
+static void skip_list_node_dealloc(SkipList *list, SkipListNode *node)
+{
+    if (list->slab != NULL) {
+        if (node->next_array != skip_list_inline_next(node)) {
+            free(node->next_array);
+        }
+        slab_dealloc(list->slab, node);
+    } else {
+        free(node->next_array);
+        free(node);
+    }
+}
+
 void skip_list_free_node(SkipList *list, SkipListNode *node)
 {
     if (list->free_key_func && node->value) {
@@ -50,28 +80,67 @@ void skip_list_free_node(SkipList *list, SkipListNode *node)
         list->free_value_func(node->value);
     }
 
-    free(node->next_array);
-    free(node);
+    skip_list_node_dealloc(list, node);
 }
 
-SkipList *skip_list_new(SkipListCompareFunc compare_func,
-                        SkipListFreeKeyFunc free_key_func,
-                        SkipListFreeValueFunc free_value_func)
+static SkipList *skip_list_new_internal(SkipListCompareFunc compare_func,
+                                        SkipListFreeKeyFunc free_key_func,
+                                        SkipListFreeValueFunc free_value_func,
+                                        Slab *slab)
 {
     SkipList *list = (SkipList *)malloc(sizeof(SkipList));
     list->compare_func = compare_func;
     list->free_key_func = free_key_func;
     list->free_value_func = free_value_func;
     list->level = 0;
+    list->slab = slab;
 
-    list->head =
-        skip_list_node_new(SKIP_LIST_MAX_LEVEL, SKIP_LIST_NIL, SKIP_LIST_NIL);
+    list->head = skip_list_node_new(
+        list, SKIP_LIST_MAX_LEVEL, SKIP_LIST_NIL, SKIP_LIST_NIL);
 
     return list;
 }
 
+SkipList *skip_list_new(SkipListCompareFunc compare_func,
+                        SkipListFreeKeyFunc free_key_func,
+                        SkipListFreeValueFunc free_value_func)
+{
+    return skip_list_new_internal(
+        compare_func, free_key_func, free_value_func, NULL);
+}
+
+SkipList *skip_list_new_with_slab(SkipListCompareFunc compare_func,
+                                  SkipListFreeKeyFunc free_key_func,
+                                  SkipListFreeValueFunc free_value_func,
+                                  unsigned int nodes_per_page)
+{
+    Slab *slab = slab_new(sizeof(SkipListNode) + SKIP_LIST_INLINE_LEVELS *
+                                                     sizeof(SkipListNode *),
+                          nodes_per_page);
+    return skip_list_new_internal(
+        compare_func, free_key_func, free_value_func, slab);
+}
+
 void skip_list_free(SkipList *list)
 {
+    if (list->slab != NULL && list->free_key_func == NULL &&
+        list->free_value_func == NULL) {
+        /**
+         * only nodes above the inline levels own a next array, and they are
+         * all linked on level SKIP_LIST_INLINE_LEVELS. free those arrays,
+         * then drop the pages at once.
+         */
+        SkipListNode *node = list->head;
+        while (node != NULL) {
+            SkipListNode *next = node->next_array[SKIP_LIST_INLINE_LEVELS];
+            free(node->next_array);
+            node = next;
+        }
+        slab_free(list->slab);
+        free(list);
+        return;
+    }
+
     SkipListNode *node = list->head;
 
     while (node != NULL) {
@@ -80,6 +149,9 @@ void skip_list_free(SkipList *list)
         node = next;
     }
 
+    if (list->slab != NULL) {
+        slab_free(list->slab);
+    }
     free(list);
 }
 
@@ -97,8 +169,7 @@ static int skip_list_random_level(SkipList *list)
 SkipListNode *
 skip_list_insert(SkipList *list, SkipListKey key, SkipListValue value)
 {
-    SkipListNode **updates = (SkipListNode **)malloc((SKIP_LIST_MAX_LEVEL + 1) *
-                                                     sizeof(SkipListNode *));
+    SkipListNode *updates[SKIP_LIST_MAX_LEVEL + 1];
 
     for (int i = SKIP_LIST_MAX_LEVEL; i >= 0; i--) {
         if (i == SKIP_LIST_MAX_LEVEL) {
@@ -114,7 +185,7 @@ skip_list_insert(SkipList *list, SkipListKey key, SkipListValue value)
     }
 
     int level = skip_list_random_level(list);
-    SkipListNode *node = skip_list_node_new(level, key, value);
+    SkipListNode *node = skip_list_node_new(list, level, key, value);
 
     // update next_array on each level
     for (int i = 0; i <= level; i++) {
@@ -124,7 +195,6 @@ skip_list_insert(SkipList *list, SkipListKey key, SkipListValue value)
 
     if (level > list->level)
         list->level = level;
-    free(updates);
 
     return node;
 }
@@ -142,8 +212,7 @@ SkipListNode *skip_list_remove_node(SkipList *list, SkipListKey key)
             } else if (cmp < 0) {
                 break;
             } else {
-                SkipListNode **updates = (SkipListNode **)malloc(
-                    (SKIP_LIST_MAX_LEVEL + 1) * sizeof(SkipListNode *));
+                SkipListNode *updates[SKIP_LIST_MAX_LEVEL + 1];
 
                 SkipListNode *node = next;
                 updates[i] = prev;
@@ -167,7 +236,6 @@ SkipListNode *skip_list_remove_node(SkipList *list, SkipListKey key)
                     }
                 }
 
-                free(updates);
                 return node;
             }
         }
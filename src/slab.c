@@ -0,0 +1,158 @@
+/**
+ * @file slab.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to slab.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "slab.h"
+#include "def.h"
+#include <stdlib.h>
+
+/** Objects are aligned for pointers, long long and double members. */
+#define SLAB_ALIGN                                                            \
+    (sizeof(long long) > sizeof(void *) ? sizeof(long long) : sizeof(void *))
+
+/** Page header, its size keeps the objects following it aligned. */
+typedef union _SlabPage {
+    union _SlabPage *next;
+    long double align_ld;
+    long long align_ll;
+    void *align_p;
+} SlabPage;
+
+/** A free object stores the link to the next free object in place. */
+typedef struct _SlabFreeObject {
+    struct _SlabFreeObject *next;
+} SlabFreeObject;
+
+struct _Slab {
+    unsigned int object_size;
+    unsigned int objects_per_page;
+    /** all pages, the newest first. */
+    SlabPage *pages;
+    unsigned int num_pages;
+    /** objects given back by slab_dealloc. */
+    SlabFreeObject *free_list;
+    /** never allocated objects at the end of the newest page. */
+    char *fresh;
+    unsigned int num_fresh;
+    unsigned int length;
+};
+
+Slab *slab_new(unsigned int object_size, unsigned int objects_per_page)
+{
+    Slab *slab = (Slab *)malloc(sizeof(Slab));
+    if (slab == NULL) {
+        return NULL;
+    }
+
+    /** room for the free link, and keep every object aligned. */
+    if (object_size < sizeof(SlabFreeObject)) {
+        object_size = sizeof(SlabFreeObject);
+    }
+    object_size = (object_size + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+
+    if (objects_per_page == 0) {
+        objects_per_page = (SLAB_PAGE_SIZE - sizeof(SlabPage)) / object_size;
+        if (objects_per_page < 8) {
+            objects_per_page = 8;
+        }
+    }
+
+    slab->object_size = object_size;
+    slab->objects_per_page = objects_per_page;
+    slab->pages = NULL;
+    slab->num_pages = 0;
+    slab->free_list = NULL;
+    slab->fresh = NULL;
+    slab->num_fresh = 0;
+    slab->length = 0;
+    return slab;
+}
+
+static void slab_free_pages(SlabPage *page)
+{
+    while (page != NULL) {
+        SlabPage *next = page->next;
+        free(page);
+        page = next;
+    }
+}
+
+void slab_free(Slab *slab)
+{
+    slab_free_pages(slab->pages);
+    free(slab);
+}
+
+static int slab_add_page(Slab *slab)
+{
+    SlabPage *page = (SlabPage *)malloc(
+        sizeof(SlabPage) + (size_t)slab->object_size * slab->objects_per_page);
+    if (page == NULL) {
+        return -1;
+    }
+
+    page->next = slab->pages;
+    slab->pages = page;
+    ++(slab->num_pages);
+    slab->fresh = (char *)(page + 1);
+    slab->num_fresh = slab->objects_per_page;
+    return 0;
+}
+
+void *slab_alloc(Slab *slab)
+{
+    void *object;
+    if (slab->free_list != NULL) {
+        object = slab->free_list;
+        slab->free_list = slab->free_list->next;
+    } else {
+        if (slab->num_fresh == 0 && slab_add_page(slab) != 0) {
+            return NULL;
+        }
+        object = slab->fresh;
+        slab->fresh += slab->object_size;
+        --(slab->num_fresh);
+    }
+
+    ++(slab->length);
+    return object;
+}
+
+void slab_dealloc(Slab *slab, void *object)
+{
+    SlabFreeObject *free_object = (SlabFreeObject *)object;
+    free_object->next = slab->free_list;
+    slab->free_list = free_object;
+    --(slab->length);
+}
+
+void slab_reset(Slab *slab)
+{
+    slab->free_list = NULL;
+    slab->length = 0;
+    if (slab->pages == NULL) {
+        return;
+    }
+
+    slab_free_pages(slab->pages->next);
+    slab->pages->next = NULL;
+    slab->num_pages = 1;
+    slab->fresh = (char *)(slab->pages + 1);
+    slab->num_fresh = slab->objects_per_page;
+}
+
+unsigned int slab_size(const Slab *slab)
+{
+    return slab->length;
+}
+
+unsigned int slab_num_pages(const Slab *slab)
+{
+    return slab->num_pages;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file slab.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Slab allocator of fixed-size objects.
+ *
+ * Objects are carved out of pages of many objects, so nodes of a container
+ * are packed together, an allocation is a freelist pop or a pointer bump,
+ * and all objects are released at once by freeing the pages.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_SLAB_H
+#define RETHINK_C_SLAB_H
+
+/**
+ * The default page size in bytes, used if objects per page is not given.
+ */
+#define SLAB_PAGE_SIZE 4096
+
+/**
+ * @brief Definition of a @ref Slab.
+ *
+ */
+typedef struct _Slab Slab;
+
+/**
+ * @brief Allcate a new Slab.
+ *
+ * @param object_size       The size of each object in bytes.
+ * @param objects_per_page  The number of objects per page, 0 to fit objects
+ *                          in a page of SLAB_PAGE_SIZE bytes.
+ * @return Slab*            The new Slab if success, otherwise NULL.
+ */
+Slab *slab_new(unsigned int object_size, unsigned int objects_per_page);
+
+/**
+ * @brief Delete a Slab and free back all pages.
+ *
+ * All objects allocated from the Slab are released, in O(pages).
+ *
+ * @param slab  The Slab.
+ */
+void slab_free(Slab *slab);
+
+/**
+ * @brief Allocate an object from a Slab.
+ *
+ * The memory is not initialized.
+ *
+ * @param slab      The Slab.
+ * @return void*    The object if success, otherwise NULL.
+ */
+void *slab_alloc(Slab *slab);
+
+/**
+ * @brief Give an object back to its Slab, for reuse by the next allocation.
+ *
+ * @param slab      The Slab.
+ * @param object    The object allocated from the Slab.
+ */
+void slab_dealloc(Slab *slab, void *object);
+
+/**
+ * @brief Release all objects of a Slab at once, keep one page for reuse.
+ *
+ * @param slab  The Slab.
+ */
+void slab_reset(Slab *slab);
+
+/**
+ * @brief Get the number of allocated (live) objects of a Slab.
+ *
+ * @param slab              The Slab.
+ * @return unsigned int     The number of objects.
+ */
+unsigned int slab_size(const Slab *slab);
+
+/**
+ * @brief Get the number of pages of a Slab.
+ *
+ * @param slab              The Slab.
+ * @return unsigned int     The number of pages.
+ */
+unsigned int slab_num_pages(const Slab *slab);
+
+#endif /* #ifndef RETHINK_C_SLAB_H */
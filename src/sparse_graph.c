@@ -10,8 +10,7 @@
 
 #include "sparse_graph.h"
 #include "def.h"
-#include "dup.h"
-#include "queue.h"
+#include "iqueue.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -106,7 +105,7 @@ int sparse_graph_link(SparseGraph *graph, int vertex1, int vertex2)
     }
 
     AdjacencyArc *new_arc = sparse_graph_new_arc(vertex2, 1);
-    if (pre_arc = NULL) {
+    if (pre_arc == NULL) {
         list->first_arc = new_arc;
     } else {
         pre_arc->next = new_arc;
@@ -116,50 +115,56 @@ int sparse_graph_link(SparseGraph *graph, int vertex1, int vertex2)
     return 0;
 }
 
+/** Per vertex state of topological sorting, linked into the queue. */
+typedef struct _TopoVertex {
+    int in_degree;
+    IQueueNode link;
+} TopoVertex;
+
 int *sparse_graph_topo_sort(SparseGraph *graph)
 {
     int *sorted_vertexes = (int *)malloc(graph->length * sizeof(int));
-    int *in_degrees = (int *)malloc(graph->length * sizeof(int));
-    memset(in_degrees, 0, graph->length * sizeof(int));
+    TopoVertex *vertexes =
+        (TopoVertex *)malloc(graph->length * sizeof(TopoVertex));
 
+    for (int i = 0; i < graph->length; ++i) {
+        vertexes[i].in_degree = 0;
+    }
     for (int i = 0; i < graph->length; ++i) {
         AdjacencyList *alist = (AdjacencyList *)graph->data[i];
         AdjacencyArc *arc = alist->first_arc;
         while (arc != NULL) {
-            ++(in_degrees[arc->vertex]);
+            ++(vertexes[arc->vertex].in_degree);
             arc = arc->next;
         }
     }
 
-    Queue *queue = queue_new();
+    IQueue queue;
+    iqueue_init(&queue);
     for (int i = 0; i < graph->length; ++i) {
-        if (in_degrees[i] == 0) {
-            queue_push_tail(queue, intdup(i));
+        if (vertexes[i].in_degree == 0) {
+            iqueue_push_tail(&queue, &(vertexes[i].link));
         }
     }
 
     int num = 0;
-    while (!queue_is_empty(queue)) {
-        int *v = (int *)queue_pop_head(queue);
-        sorted_vertexes[num++] = *v;
-        
-        AdjacencyList *alist = (AdjacencyList *)graph->data[*v];
+    while (!iqueue_is_empty(&queue)) {
+        TopoVertex *current =
+            iqueue_entry(iqueue_pop_head(&queue), TopoVertex, link);
+        int v = (int)(current - vertexes);
+        sorted_vertexes[num++] = v;
+
+        /** a vertex is queued once, when its last in arc is removed. */
+        AdjacencyList *alist = (AdjacencyList *)graph->data[v];
         AdjacencyArc *arc = alist->first_arc;
         while (arc != NULL) {
-            --(in_degrees[arc->vertex]);
-            arc = arc->next;
-        }
-        --(in_degrees[*v]);
-        free(v);
-
-        for (int i = 0; i < graph->length; ++i) {
-            if (in_degrees[i] == 0) {
-                queue_push_tail(queue, intdup(i));
+            if (--(vertexes[arc->vertex].in_degree) == 0) {
+                iqueue_push_tail(&queue, &(vertexes[arc->vertex].link));
             }
+            arc = arc->next;
         }
     }
 
-    queue_free(queue);
-    free(in_degrees);
+    free(vertexes);
     return sorted_vertexes;
 }
@@ -47,9 +47,11 @@ int sparse_graph_link(SparseGraph *graph, int vertex1, int vertex2);
 
 /**
  * @brief Topological sorting by Khan algorithm.
- * 
- * @param graph 
- * @return Queue* 
+ *
+ * Vertexes are queued in an intrusive IQueue, no allocation per vertex.
+ *
+ * @param graph     The Sparse Graph, must be acyclic.
+ * @return int*     The sorted vertexes, the caller should free it.
  */
 int *sparse_graph_topo_sort(SparseGraph *graph);
 
@@ -0,0 +1,167 @@
+/**
+ * @file spsc_queue.c
+ * @author hutusi (hutusi@outlook.com)
+ * @brief Refer to spsc_queue.h
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#include "spsc_queue.h"
+#include "def.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Consumer and producer fields are padded to separate cache lines (two
+ * lines, as adjacent lines are prefetched in pairs). */
+#define SPSC_QUEUE_PADDING 128
+
+struct _SpscQueue {
+    /** read only after creation. */
+    QueueValue *buffer;
+    size_t mask;
+    char padding0[SPSC_QUEUE_PADDING - sizeof(QueueValue *) - sizeof(size_t)];
+
+    /** the consumer's line: values before head have been popped. */
+    atomic_size_t head;
+    size_t cached_tail;
+    char padding1[SPSC_QUEUE_PADDING - 2 * sizeof(size_t)];
+
+    /** the producer's line: values before tail have been pushed. */
+    atomic_size_t tail;
+    size_t cached_head;
+    char padding2[SPSC_QUEUE_PADDING - 2 * sizeof(size_t)];
+};
+
+SpscQueue *spsc_queue_new(unsigned int capacity)
+{
+    if (capacity == 0 || capacity > (~0u >> 1) + 1) {
+        return NULL;
+    }
+
+    SpscQueue *queue = (SpscQueue *)malloc(sizeof(SpscQueue));
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    queue->buffer = (QueueValue *)malloc(sizeof(QueueValue) * size);
+    if (queue->buffer == NULL) {
+        free(queue);
+        return NULL;
+    }
+    queue->mask = size - 1;
+    atomic_init(&(queue->head), 0);
+    atomic_init(&(queue->tail), 0);
+    queue->cached_head = queue->cached_tail = 0;
+    return queue;
+}
+
+void spsc_queue_free(SpscQueue *queue)
+{
+    free(queue->buffer);
+    free(queue);
+}
+
+int spsc_queue_push(SpscQueue *queue, QueueValue data)
+{
+    size_t tail = atomic_load_explicit(&(queue->tail), memory_order_relaxed);
+    if (tail - queue->cached_head > queue->mask) {
+        queue->cached_head =
+            atomic_load_explicit(&(queue->head), memory_order_acquire);
+        if (tail - queue->cached_head > queue->mask) {
+            return -1; // full
+        }
+    }
+
+    queue->buffer[tail & queue->mask] = data;
+    atomic_store_explicit(&(queue->tail), tail + 1, memory_order_release);
+    return 0;
+}
+
+int spsc_queue_pop(SpscQueue *queue, QueueValue *data)
+{
+    size_t head = atomic_load_explicit(&(queue->head), memory_order_relaxed);
+    if (head == queue->cached_tail) {
+        queue->cached_tail =
+            atomic_load_explicit(&(queue->tail), memory_order_acquire);
+        if (head == queue->cached_tail) {
+            return -1; // empty
+        }
+    }
+
+    *data = queue->buffer[head & queue->mask];
+    atomic_store_explicit(&(queue->head), head + 1, memory_order_release);
+    return 0;
+}
+
+unsigned int spsc_queue_push_many(SpscQueue *queue,
+                                  const QueueValue *data,
+                                  unsigned int count)
+{
+    size_t tail = atomic_load_explicit(&(queue->tail), memory_order_relaxed);
+    size_t free_slots = queue->mask + 1 - (tail - queue->cached_head);
+    if (free_slots < count) {
+        queue->cached_head =
+            atomic_load_explicit(&(queue->head), memory_order_acquire);
+        free_slots = queue->mask + 1 - (tail - queue->cached_head);
+        if (free_slots < count) {
+            count = (unsigned int)free_slots;
+        }
+    }
+
+    /** copy in at most two pieces, then publish them all at once. */
+    size_t pos = tail & queue->mask;
+    size_t first = queue->mask + 1 - pos;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(queue->buffer + pos, data, sizeof(QueueValue) * first);
+    memcpy(queue->buffer, data + first, sizeof(QueueValue) * (count - first));
+    atomic_store_explicit(&(queue->tail), tail + count, memory_order_release);
+    return count;
+}
+
+unsigned int
+spsc_queue_pop_many(SpscQueue *queue, QueueValue *data, unsigned int count)
+{
+    size_t head = atomic_load_explicit(&(queue->head), memory_order_relaxed);
+    size_t available = queue->cached_tail - head;
+    if (available < count) {
+        queue->cached_tail =
+            atomic_load_explicit(&(queue->tail), memory_order_acquire);
+        available = queue->cached_tail - head;
+        if (available < count) {
+            count = (unsigned int)available;
+        }
+    }
+
+    size_t pos = head & queue->mask;
+    size_t first = queue->mask + 1 - pos;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(data, queue->buffer + pos, sizeof(QueueValue) * first);
+    memcpy(data + first, queue->buffer, sizeof(QueueValue) * (count - first));
+    atomic_store_explicit(&(queue->head), head + count, memory_order_release);
+    return count;
+}
+
+unsigned int spsc_queue_capacity(const SpscQueue *queue)
+{
+    return (unsigned int)(queue->mask + 1);
+}
+
+unsigned int spsc_queue_length(SpscQueue *queue)
+{
+    size_t head = atomic_load_explicit(&(queue->head), memory_order_acquire);
+    size_t tail = atomic_load_explicit(&(queue->tail), memory_order_acquire);
+    return (unsigned int)(tail - head);
+}
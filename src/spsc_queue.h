@@ -0,0 +1,109 @@
+/**
+ * @file spsc_queue.h
+ *
+ * @author hutusi (hutusi@outlook.com)
+ *
+ * @brief Lock-free bounded queue for a single producer and a single consumer.
+ *
+ * A ring of @ref QueueValue whose head (consumer) and tail (producer)
+ * counters live on separate cache lines, each side also caches the other
+ * side's counter, so a push or pop touches shared memory only when the
+ * cached view says the ring is full or empty.
+ *
+ * Exactly one thread may push and exactly one thread may pop at a time.
+ *
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2019, hutusi.com
+ *
+ */
+
+#ifndef RETHINK_C_SPSC_QUEUE_H
+#define RETHINK_C_SPSC_QUEUE_H
+
+#include "queue.h"
+
+/**
+ * @brief Definition of a @ref SpscQueue.
+ *
+ */
+typedef struct _SpscQueue SpscQueue;
+
+/**
+ * @brief Allcate a new SpscQueue.
+ *
+ * @param capacity      The capacity, rounded up to a power of two.
+ * @return SpscQueue*   The new SpscQueue if success, otherwise return NULL.
+ */
+SpscQueue *spsc_queue_new(unsigned int capacity);
+
+/**
+ * @brief Delete a SpscQueue and free back memory, no thread may use it.
+ *
+ * @param queue  The SpscQueue to delete.
+ */
+void spsc_queue_free(SpscQueue *queue);
+
+/**
+ * @brief Push a value to the tail of a SpscQueue, by the producer.
+ *
+ * @param queue     The SpscQueue.
+ * @param data      The value to push.
+ * @return int      0 if success, -1 if full.
+ */
+int spsc_queue_push(SpscQueue *queue, QueueValue data);
+
+/**
+ * @brief Pop the head value of a SpscQueue, by the consumer.
+ *
+ * @param queue     The SpscQueue.
+ * @param data      The output value.
+ * @return int      0 if success, -1 if empty.
+ */
+int spsc_queue_pop(SpscQueue *queue, QueueValue *data);
+
+/**
+ * @brief Push at most count values to a SpscQueue, by the producer.
+ *
+ * All pushed values are published to the consumer at once.
+ *
+ * @param queue             The SpscQueue.
+ * @param data              The values.
+ * @param count             The number of values.
+ * @return unsigned int     The number of pushed values, less than count if
+ *                          the SpscQueue is full.
+ */
+unsigned int spsc_queue_push_many(SpscQueue *queue,
+                                  const QueueValue *data,
+                                  unsigned int count);
+
+/**
+ * @brief Pop at most count values from a SpscQueue, by the consumer.
+ *
+ * @param queue             The SpscQueue.
+ * @param data              The output values, data[0] was the head.
+ * @param count             The max number of values.
+ * @return unsigned int     The number of popped values.
+ */
+unsigned int
+spsc_queue_pop_many(SpscQueue *queue, QueueValue *data, unsigned int count);
+
+/**
+ * @brief Get the capacity of a SpscQueue.
+ *
+ * @param queue             The SpscQueue.
+ * @return unsigned int     The capacity.
+ */
+unsigned int spsc_queue_capacity(const SpscQueue *queue);
+
+/**
+ * @brief Get the number of values in a SpscQueue.
+ *
+ * Only a snapshot if the other side is running.
+ *
+ * @param queue             The SpscQueue.
+ * @return unsigned int     The length.
+ */
+unsigned int spsc_queue_length(SpscQueue *queue);
+
+#endif /* #ifndef RETHINK_C_SPSC_QUEUE_H */
@@ -20,13 +20,35 @@ sunday_calculate_bad_chars(const char *pattern, int len, int *bad_chars)
     }
 
     for (int i = len - 1; i >= 0; --i) {
-        int ch = pattern[i];
+        int ch = (unsigned char)pattern[i];
         if (bad_chars[ch] < 0) {
             bad_chars[ch] = i;
         }
     }
 }
 
+/**
+ * @brief Sunday algorithm function
+ *
+ * compare from the first charactor, on mismatch look at the charactor just
+ * after the window:
+ *
+ *    !   *
+ * abceabdab
+ * abd
+ *
+ * 'e' is not in 'abd', move past it, length 4 ('abd' + 1):
+ *
+ *     !
+ * abceabdab
+ *     abd
+ *
+ * a charactor in the pattern moves to align with its last occurrence.
+ *
+ * @param text
+ * @param pattern
+ * @return int
+ */
 int sunday_text_match(const char *text,
                       unsigned int text_len,
                       const char *pattern,
@@ -35,21 +57,23 @@ int sunday_text_match(const char *text,
     int bad_chars[256];
     sunday_calculate_bad_chars(pattern, pat_len, bad_chars);
 
-    int move = 0;
-    for (int i = 0; i < text_len; /* no ++i */) {
-        for (int j = 0; j < pat_len; /* no ++j */) {
-            if (text[i] == pattern[j]) {
-                ++i;
-                ++j;
-            } else {
-                move = pat_len - bad_chars[(int)text[pat_len + move]];
-                i = move;
-                j = 0;
-            }
+    if (pat_len > text_len) {
+        return -1;
+    }
+    unsigned int cursor = 0;
+    while (cursor <= text_len - pat_len) {
+        unsigned int j = 0;
+        while (j < pat_len && text[cursor + j] == pattern[j]) {
+            ++j;
         }
-
-        /* here means j == pat_len */
-        return move;
+        if (j == pat_len) {
+            return cursor;
+        }
+        if (cursor + pat_len >= text_len) {
+            break;
+        }
+        cursor += pat_len -
+                  bad_chars[(unsigned char)text[cursor + pat_len]];
     }
 
     return -1;
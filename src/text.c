@@ -60,6 +60,19 @@ Text *text_n_from(const char *string, int length)
     return text;
 }
 
+Text *text_from_buffer(char *data, unsigned int length, unsigned int allocated)
+{
+    Text *text = (Text *)malloc(sizeof(Text));
+    if (text == NULL) {
+        return NULL;
+    }
+    text->data = data;
+    text->length = length;
+    text->_allocated = allocated;
+    text->data[length] = '\0';
+    return text;
+}
+
 void text_free(Text *text)
 {
     free(text->data);
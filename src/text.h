@@ -50,6 +50,18 @@ Text *text_from(const char *string);
  */
 Text *text_n_from(const char *string, int length);
 
+/**
+ * @brief New a new Text over a malloc'd buffer, the Text takes it over.
+ *
+ * The buffer is not copied, it is freed by text_free.
+ *
+ * @param data      The buffer, holding length chars, maybe '\0'.
+ * @param length    The length of the chars.
+ * @param allocated The size of the buffer, greater than length.
+ * @return Text*    The new Text if success, otherwise NULL.
+ */
+Text *text_from_buffer(char *data, unsigned int length, unsigned int allocated);
+
 /**
  * @brief Delete a Text and free back memory.
  *
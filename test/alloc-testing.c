@@ -14,6 +14,9 @@ NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
 CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -61,6 +64,11 @@ static size_t allocated_bytes = 0;
 
 signed int allocation_limit = -1;
 
+/* Guards the counters above, so that thread-safe code under test can
+ * allocate from several threads. */
+
+static pthread_mutex_t alloc_test_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* Get the block header for an allocated pointer. */
 
 static BlockHeader *alloc_test_get_header(void *ptr)
@@ -103,9 +111,12 @@ void *alloc_test_malloc(size_t bytes)
 
     /* Check if we have reached the allocation limit. */
 
+    pthread_mutex_lock(&alloc_test_mutex);
     if (allocation_limit == 0) {
+        pthread_mutex_unlock(&alloc_test_mutex);
         return NULL;
     }
+    pthread_mutex_unlock(&alloc_test_mutex);
 
     /* Allocate the requested block with enough room for the block header
      * as well. */
@@ -127,6 +138,7 @@ void *alloc_test_malloc(size_t bytes)
 
     /* Update counter */
 
+    pthread_mutex_lock(&alloc_test_mutex);
     allocated_bytes += bytes;
 
     /* Decrease the allocation limit */
@@ -134,6 +146,7 @@ void *alloc_test_malloc(size_t bytes)
     if (allocation_limit > 0) {
         --allocation_limit;
     }
+    pthread_mutex_unlock(&alloc_test_mutex);
 
     /* Skip past the header and return the block itself */
 
@@ -157,7 +170,6 @@ void alloc_test_free(void *ptr)
 
     header = alloc_test_get_header(ptr);
     block_size = header->bytes;
-    assert(allocated_bytes >= block_size);
 
     /* Trash the allocated block to foil any code that relies on memory
      * that has been freed. */
@@ -175,7 +187,10 @@ void alloc_test_free(void *ptr)
 
     /* Update counter */
 
+    pthread_mutex_lock(&alloc_test_mutex);
+    assert(allocated_bytes >= block_size);
     allocated_bytes -= block_size;
+    pthread_mutex_unlock(&alloc_test_mutex);
 }
 
 void *alloc_test_realloc(void *ptr, size_t bytes)
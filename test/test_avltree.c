@@ -63,9 +63,48 @@ void test_avltree_print()
     avl_tree_free(tree);
 }
 
+void test_avltree_slab()
+{
+    /** free keys: nodes are walked, then the pages are dropped. */
+    AVLTree *tree = avl_tree_new_with_slab(int_compare, free, NULL, 0);
+    for (int i = 0; i < 1000; ++i) {
+        int *key = intdup(i);
+        assert(avl_tree_insert(tree, key, key));
+    }
+    assert(avl_tree_subtree_height(tree->root) <= 20);
+
+    int key = 7;
+    AVLTreeNode *removed =
+        avl_tree_remove_node(tree, avl_tree_find_node(tree, &key));
+    avl_tree_free_node(tree, removed);
+    assert(tree->num_nodes == 999);
+    ASSERT_INT_EQ(slab_size(tree->slab), 999 * 2);
+    avl_tree_free(tree);
+
+    /** nothing to free per node. */
+    int keys[100];
+    tree = avl_tree_new_with_slab(int_compare, NULL, NULL, 8);
+    for (int i = 0; i < 100; ++i) {
+        keys[i] = i % 50;
+        assert(avl_tree_insert(tree, &keys[i], &keys[i]));
+    }
+    assert(tree->num_nodes == 50);
+    avl_tree_free(tree);
+
+    /** out of memory for the tree, then for its Slab. */
+    size_t allocated = alloc_test_get_allocated();
+    for (int limit = 0; limit < 2; ++limit) {
+        alloc_test_set_limit(limit);
+        assert(avl_tree_new_with_slab(int_compare, NULL, NULL, 8) == NULL);
+        alloc_test_set_limit(-1);
+        assert(alloc_test_get_allocated() == allocated);
+    }
+}
+
 void test_avltree()
 {
     test_avltree_insert();
     test_avltree_delete();
+    test_avltree_slab();
     // test_avltree_print();
 }
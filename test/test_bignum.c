@@ -1,5 +1,6 @@
 #include "bignum.h"
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -146,3 +147,473 @@ void test_bignum_int_division()
     assert(bignum_int_division("123", "0", quotient, remainder) > 0);
     assert(strcmp(quotient, "NaN") == 0);
 }
+
+/** parse string, print it back, check the same. */
+static void test_bignum_round_trip(BigNum *num, const char *string)
+{
+    assert(bignum_from_string(num, string) == 0);
+    char *printed = bignum_to_string(num);
+    assert(strcmp(printed, string) == 0);
+    free(printed);
+}
+
+static void test_bignum_expect(const BigNum *num, const char *expected)
+{
+    char *printed = bignum_to_string(num);
+    assert(strcmp(printed, expected) == 0);
+    free(printed);
+}
+
+void test_bignum_limbs()
+{
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *c = bignum_new();
+    BigNum *d = bignum_new();
+
+    test_bignum_round_trip(a, "0");
+    test_bignum_round_trip(a, "-1");
+    test_bignum_round_trip(a, "18446744073709551615");
+    test_bignum_round_trip(a, "18446744073709551616");
+    test_bignum_round_trip(a, "-340282366920938463463374607431768211456");
+
+    assert(bignum_from_string(a, "+000123") == 0);
+    test_bignum_expect(a, "123");
+    assert(bignum_from_string(a, "-0") == 0);
+    test_bignum_expect(a, "0");
+    assert(bignum_from_string(a, "12a") == -1);
+    test_bignum_expect(a, "0");
+    assert(bignum_from_string(a, "-") == -1);
+
+    bignum_set_int(a, INT64_MIN);
+    test_bignum_expect(a, "-9223372036854775808");
+
+    /** carries and borrows across limbs. */
+    bignum_from_string(a, "18446744073709551615");
+    bignum_set_int(b, 1);
+    bignum_add(c, a, b);
+    test_bignum_expect(c, "18446744073709551616");
+    bignum_sub(c, b, c);
+    test_bignum_expect(c, "-18446744073709551615");
+    bignum_add(c, c, a);
+    test_bignum_expect(c, "0");
+    bignum_set_int(b, -5);
+    bignum_sub(c, b, a);
+    test_bignum_expect(c, "-18446744073709551620");
+
+    /** aliasing operands. */
+    bignum_mul(a, a, a);
+    test_bignum_expect(a, "340282366920938463426481119284349108225");
+    bignum_add(a, a, a);
+    test_bignum_expect(a, "680564733841876926852962238568698216450");
+    bignum_mul(c, a, b);
+    test_bignum_expect(c, "-3402823669209384634264811192843491082250");
+
+    /** truncated division, the remainder of the dividend's sign. */
+    bignum_set_int(a, -7);
+    bignum_set_int(b, 2);
+    bignum_divmod(c, d, a, b);
+    test_bignum_expect(c, "-3");
+    test_bignum_expect(d, "-1");
+    bignum_set_int(b, -2);
+    bignum_divmod(c, d, a, b);
+    test_bignum_expect(c, "3");
+    test_bignum_expect(d, "-1");
+    bignum_set_int(b, 0);
+    assert(bignum_divmod(c, d, a, b) == -1);
+
+    bignum_from_string(a, "123456789012345678901234567890123456789012345678901"
+                          "234567890");
+    bignum_from_string(b, "98765432109876543210987654321");
+    bignum_divmod(c, d, a, b);
+    test_bignum_expect(c, "1249999988609375000142382812499");
+    test_bignum_expect(d, "46440971104644097110464409711");
+    bignum_divmod(NULL, a, a, b);
+    test_bignum_expect(a, "46440971104644097110464409711");
+
+    /** shifts keep the sign. */
+    bignum_set_int(a, -3);
+    bignum_shift_left(b, a, 130);
+    test_bignum_expect(b, "-4083388403051261561560495289181218537472");
+    bignum_shift_right(b, b, 129);
+    test_bignum_expect(b, "-6");
+    bignum_shift_right(b, b, 3);
+    test_bignum_expect(b, "0");
+
+    /** divmod identity: a == q * b + r, |r| < |b|. */
+    srand(2019);
+    for (int i = 0; i < 200; ++i) {
+        char digits[2][400];
+        for (int k = 0; k < 2; ++k) {
+            int length = 1 + rand() % 399;
+            digits[k][0] = (rand() & 1) ? '-' : '+';
+            for (int j = 1; j < length; ++j) {
+                digits[k][j] = (char)('0' + rand() % 10);
+            }
+            digits[k][length] = '\0';
+            if (length == 1) {
+                strcpy(digits[k], "7");
+            }
+        }
+        bignum_from_string(a, digits[0]);
+        bignum_from_string(b, digits[1]);
+        if (b->size == 0) {
+            continue;
+        }
+        bignum_divmod(c, d, a, b);
+        BigNum *e = bignum_new();
+        bignum_mul(e, c, b);
+        bignum_add(e, e, d);
+        assert(bignum_compare(e, a) == 0);
+        assert(d->size == 0 || d->sign == a->sign);
+        bignum_set(e, d);
+        e->sign = b->sign;
+        assert(bignum_compare(e, b) * (b->sign == Positive ? 1 : -1) < 0);
+        bignum_free(e);
+    }
+
+    /** large decimals, converted by splitting. */
+    size_t length = 20000;
+    char *string = (char *)malloc(length + 1);
+    string[0] = '1';
+    memset(string + 1, '0', length - 1);
+    string[length] = '\0';
+    test_bignum_round_trip(a, string);
+    bignum_set_int(b, 1);
+    bignum_set_int(c, 10);
+    for (size_t i = 1; i < length; ++i) {
+        bignum_mul(b, b, c);
+    }
+    assert(bignum_compare(a, b) == 0);
+    for (size_t i = 0; i < length; ++i) {
+        string[i] = (char)('0' + (i * 7 + i / 13) % 10);
+    }
+    string[0] = '9';
+    test_bignum_round_trip(a, string);
+    free(string);
+
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(c);
+    bignum_free(d);
+}
+
+void test_bignum_mul_algorithms()
+{
+    BigNumThresholds saved;
+    bignum_get_thresholds(&saved);
+    BigNumThresholds basecase = {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX};
+    BigNumThresholds algorithms[] = {
+        {2, SIZE_MAX, SIZE_MAX, SIZE_MAX}, /** Karatsuba */
+        {2, 3, SIZE_MAX, SIZE_MAX},        /** Toom-3 */
+        {5, 9, SIZE_MAX, SIZE_MAX},
+        {SIZE_MAX, SIZE_MAX, 1, SIZE_MAX}, /** the transform */
+        {2, 3, 40, SIZE_MAX},
+    };
+    size_t num_algorithms = sizeof(algorithms) / sizeof(algorithms[0]);
+    size_t sizes[][2] = {{1, 1}, {2, 2}, {3, 2}, {7, 7}, {20, 3},
+                         {30, 29}, {64, 64}, {100, 51}, {211, 97}, {300, 300}};
+    size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *expected = bignum_new();
+    BigNum *product = bignum_new();
+    srand(2019);
+    for (size_t i = 0; i < num_sizes; ++i) {
+        /** random limbs, or all ones for the most carries. */
+        bignum_set_int(a, 1);
+        bignum_shift_left(a, a, sizes[i][0] * BIGNUM_LIMB_BITS);
+        bignum_set_int(b, 1);
+        bignum_sub(a, a, b);
+        if (i % 2 == 0) {
+            for (size_t j = 0; j < a->size; ++j) {
+                a->limbs[j] = ((limb_t)rand() << 40) ^ (limb_t)rand() ^ 1;
+            }
+        }
+        bignum_set_int(b, 1);
+        bignum_shift_left(b, b, sizes[i][1] * BIGNUM_LIMB_BITS);
+        for (size_t j = 0; j < b->size; ++j) {
+            b->limbs[j] = ~((limb_t)rand() << 20);
+        }
+
+        bignum_set_thresholds(&basecase);
+        bignum_mul(expected, a, b);
+        for (size_t k = 0; k < num_algorithms; ++k) {
+            bignum_set_thresholds(&(algorithms[k]));
+            bignum_mul(product, a, b);
+            assert(bignum_compare(product, expected) == 0);
+            bignum_mul(product, b, a);
+            assert(bignum_compare(product, expected) == 0);
+        }
+    }
+
+    /** (2^64n - 1)^2 = 2^128n - 2^(64n + 1) + 1, squared by each. */
+    bignum_set_int(a, 1);
+    bignum_shift_left(a, a, 300 * BIGNUM_LIMB_BITS);
+    bignum_set_int(b, 1);
+    bignum_sub(a, a, b);
+    bignum_shift_left(expected, b, 600 * BIGNUM_LIMB_BITS);
+    bignum_shift_left(product, b, 301 * BIGNUM_LIMB_BITS - 63);
+    bignum_sub(expected, expected, product);
+    bignum_add(expected, expected, b);
+    for (size_t k = 0; k < num_algorithms; ++k) {
+        bignum_set_thresholds(&(algorithms[k]));
+        bignum_mul(product, a, a);
+        assert(bignum_compare(product, expected) == 0);
+    }
+
+    bignum_set_thresholds(&saved);
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(expected);
+    bignum_free(product);
+}
+
+/** num of size random limbs, the top not zero. */
+static void test_bignum_random(BigNum *num, size_t size)
+{
+    bignum_set_int(num, 1);
+    bignum_shift_left(num, num, (size - 1) * BIGNUM_LIMB_BITS);
+    for (size_t j = 0; j < size; ++j) {
+        num->limbs[j] = ((limb_t)rand() << 40) ^ ((limb_t)rand() << 20) ^
+                        (limb_t)rand() ^ 1;
+    }
+}
+
+void test_bignum_div_algorithms()
+{
+    BigNumThresholds saved;
+    bignum_get_thresholds(&saved);
+    BigNumThresholds knuth = saved;
+    knuth.burnikel_ziegler = SIZE_MAX;
+    size_t thresholds[] = {2, 3, 4, 7, 16};
+    size_t sizes[][2] = {{2, 2},   {5, 2},   {9, 4},   {40, 17},
+                         {64, 32}, {65, 31}, {300, 100}, {500, 61}};
+
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *q = bignum_new();
+    BigNum *r = bignum_new();
+    BigNum *expected_q = bignum_new();
+    BigNum *expected_r = bignum_new();
+    srand(2019);
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        test_bignum_random(a, sizes[i][0]);
+        test_bignum_random(b, sizes[i][1]);
+        if (i % 3 == 0) {
+            /** the top limb of the divisor, all ones or small. */
+            b->limbs[b->size - 1] = i % 2 == 0 ? ~(limb_t)0 : 1;
+        }
+        bignum_set_thresholds(&knuth);
+        bignum_divmod(expected_q, expected_r, a, b);
+
+        for (size_t k = 0; k < sizeof(thresholds) / sizeof(size_t); ++k) {
+            BigNumThresholds bz = saved;
+            bz.burnikel_ziegler = thresholds[k];
+            bignum_set_thresholds(&bz);
+            bignum_divmod(q, r, a, b);
+            assert(bignum_compare(q, expected_q) == 0);
+            assert(bignum_compare(r, expected_r) == 0);
+
+            /** a = q b + r. */
+            bignum_mul(q, q, b);
+            bignum_add(q, q, r);
+            assert(bignum_compare(q, a) == 0);
+        }
+    }
+
+    bignum_set_thresholds(&saved);
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(q);
+    bignum_free(r);
+    bignum_free(expected_q);
+    bignum_free(expected_r);
+}
+
+void test_bignum_powmod_gcd()
+{
+    BigNum *a = bignum_new();
+    BigNum *b = bignum_new();
+    BigNum *m = bignum_new();
+    BigNum *result = bignum_new();
+
+    bignum_set_int(a, 2);
+    bignum_set_int(b, 10);
+    bignum_set_int(m, 1000);
+    assert(bignum_powmod(result, a, b, m) == 0);
+    test_bignum_expect(result, "24");
+    bignum_set_int(a, -2);
+    bignum_set_int(b, 3);
+    bignum_powmod(result, a, b, m);
+    test_bignum_expect(result, "992");
+    bignum_set_int(b, 0);
+    bignum_powmod(result, a, b, m);
+    test_bignum_expect(result, "1");
+    bignum_set_int(m, 1);
+    bignum_powmod(result, a, b, m);
+    test_bignum_expect(result, "0");
+    bignum_set_int(m, 0);
+    assert(bignum_powmod(result, a, b, m) == -1);
+    bignum_set_int(m, 7);
+    bignum_set_int(b, -1);
+    assert(bignum_powmod(result, a, b, m) == -1);
+
+    /** Fermat: a^(p - 1) = 1 mod p, p = 2^521 - 1 a Mersenne prime. */
+    bignum_set_int(b, 1);
+    bignum_shift_left(m, b, 521);
+    bignum_sub(m, m, b);
+    bignum_from_string(a, "123456789012345678901234567890");
+    bignum_sub(b, m, b);
+    bignum_powmod(result, a, b, m);
+    test_bignum_expect(result, "1");
+    /** and a^p = a, the result in place. */
+    bignum_set_int(result, 1);
+    bignum_add(b, b, result);
+    bignum_powmod(b, a, b, m);
+    assert(bignum_compare(b, a) == 0);
+
+    /** gcd(2^64 * 3 * 5^30, -(2^70 * 5^10 * 7)) = 2^64 * 5^10. */
+    bignum_set_int(m, 5);
+    bignum_set_int(b, 1);
+    for (int i = 0; i < 30; ++i) {
+        bignum_mul(b, b, m);
+    }
+    bignum_set_int(a, 3);
+    bignum_mul(a, a, b);
+    bignum_shift_left(a, a, 64);
+    bignum_set_int(b, 9765625);
+    bignum_set_int(m, -7);
+    bignum_mul(b, b, m);
+    bignum_shift_left(b, b, 70);
+    bignum_gcd(result, a, b);
+    bignum_set_int(m, 9765625);
+    bignum_shift_left(m, m, 64);
+    assert(bignum_compare(result, m) == 0);
+    bignum_gcd(result, b, a);
+    assert(bignum_compare(result, m) == 0);
+
+    /** consecutive Fibonacci numbers, the most Euclid steps: 1. */
+    bignum_set_int(a, 1);
+    bignum_set_int(b, 1);
+    for (int i = 0; i < 3000; ++i) {
+        bignum_add(a, a, b);
+        bignum_sub(b, a, b);
+    }
+    bignum_gcd(result, a, b);
+    test_bignum_expect(result, "1");
+    /** times a common factor. */
+    bignum_set(m, a);
+    bignum_mul(a, a, m);
+    bignum_mul(b, b, m);
+    bignum_gcd(a, a, b);
+    assert(bignum_compare(a, m) == 0);
+
+    bignum_set_int(a, 0);
+    bignum_gcd(result, a, a);
+    test_bignum_expect(result, "0");
+    bignum_set_int(b, -12);
+    bignum_gcd(result, a, b);
+    test_bignum_expect(result, "12");
+
+    bignum_free(a);
+    bignum_free(b);
+    bignum_free(m);
+    bignum_free(result);
+}
+
+void test_bignum_scratch()
+{
+    BigNumThresholds saved;
+    bignum_get_thresholds(&saved);
+    BigNumThresholds fast = {2, 3, 40, 3};
+    size_t sizes[][2] = {{1, 1}, {3, 2}, {8, 8}, {30, 7}, {64, 50}, {90, 90}};
+    size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    BigNum *a[6];
+    BigNum *b[6];
+    BigNum *acc = bignum_new();
+    BigNum *expected = bignum_new();
+    BigNum *product = bignum_new();
+    BigNum *quotient = bignum_new();
+    BigNum *remainder = bignum_new();
+    BigNumScratch *scratch = bignum_scratch_new(0);
+    srand(2019);
+    for (size_t i = 0; i < num_sizes; ++i) {
+        a[i] = bignum_new();
+        b[i] = bignum_new();
+        test_bignum_random(a[i], sizes[i][0]);
+        test_bignum_random(b[i], sizes[i][1]);
+        if (i % 2 == 1) {
+            b[i]->sign = Negative;
+        }
+    }
+
+    for (int k = 0; k < 2; ++k) {
+        bignum_set_thresholds(k == 0 ? &saved : &fast);
+
+        /** the expected sums, and the sizes up front. */
+        size_t acc_size = 0;
+        size_t scratch_size = 0;
+        bignum_set_int(expected, 0);
+        for (size_t i = 0; i < num_sizes; ++i) {
+            size_t an = a[i]->size;
+            size_t bn = b[i]->size;
+            bignum_mul(product, a[i], b[i]);
+            bignum_add(expected, expected, product);
+            acc_size = bignum_addmul_size(acc_size, an, bn);
+            size_t need[] = {bignum_addmul_scratch_size(an, bn),
+                             bignum_mul_scratch_size(an, bn),
+                             bignum_divmod_scratch_size(an + bn, bn)};
+            for (int j = 0; j < 3; ++j) {
+                if (scratch_size < need[j]) {
+                    scratch_size = need[j];
+                }
+            }
+        }
+        assert(bignum_reserve(acc, acc_size) == 0);
+        assert(bignum_reserve(product, bignum_mul_size(90, 90)) == 0);
+        assert(bignum_reserve(quotient, bignum_quotient_size(180, 90)) == 0);
+        assert(bignum_reserve(remainder, bignum_remainder_size(90, 90)) ==
+               0);
+        size_t square_size = a[0]->size;
+        assert(bignum_reserve(a[0],
+                              bignum_addmul_size(
+                                  square_size, square_size, square_size)) ==
+               0);
+        assert(bignum_scratch_reserve(
+                   scratch,
+                   scratch_size +
+                       bignum_addmul_scratch_size(square_size, square_size)) ==
+               0);
+
+        /** no allocation from here. */
+        alloc_test_set_limit(0);
+        bignum_set_int(acc, 0);
+        for (size_t i = 0; i < num_sizes; ++i) {
+            assert(bignum_addmul(acc, a[i], b[i], scratch) == 0);
+            assert(bignum_mul_scratch(product, a[i], b[i], scratch) == 0);
+            assert(bignum_divmod_scratch(
+                       quotient, remainder, product, b[i], scratch) == 0);
+            assert(bignum_compare(quotient, a[i]) == 0);
+            assert(remainder->size == 0);
+        }
+        assert(bignum_compare(acc, expected) == 0);
+        /** acc += acc * acc, the product in scratch. */
+        assert(bignum_addmul(a[0], a[0], a[0], scratch) == 0);
+        alloc_test_set_limit(-1);
+    }
+
+    bignum_set_thresholds(&saved);
+    for (size_t i = 0; i < num_sizes; ++i) {
+        bignum_free(a[i]);
+        bignum_free(b[i]);
+    }
+    bignum_free(acc);
+    bignum_free(expected);
+    bignum_free(product);
+    bignum_free(quotient);
+    bignum_free(remainder);
+    bignum_scratch_free(scratch);
+}
@@ -2,6 +2,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "alloc-testing.h"
 #include "test_helper.h"
@@ -56,40 +57,52 @@ void test_bitmap_from_word()
     char *string;
 
     bitmap = bitmap_from_word(1);
-    ASSERT_INT_EQ(bitmap->num_bits, 32);
+    ASSERT_INT_EQ(bitmap->num_bits, 64);
     ASSERT_INT_EQ(bitmap->num_words, 1);
     string = bitmap_to_string(bitmap);
-    ASSERT_STRING_EQ(string, "10000000000000000000000000000000");
+    ASSERT_STRING_EQ(string,
+                     "10000000000000000000000000000000"
+                     "00000000000000000000000000000000");
     free(string);
     bitmap_free(bitmap);
 
     bitmap = bitmap_from_word(1 << 2);
     string = bitmap_to_string(bitmap);
-    ASSERT_STRING_EQ(string, "00100000000000000000000000000000");
+    ASSERT_STRING_EQ(string,
+                     "00100000000000000000000000000000"
+                     "00000000000000000000000000000000");
     free(string);
     bitmap_free(bitmap);
 
     bitmap = bitmap_from_word(0xFFFFFFFF >> 3);
     string = bitmap_to_string(bitmap);
-    ASSERT_STRING_EQ(string, "11111111111111111111111111111000");
+    ASSERT_STRING_EQ(string,
+                     "11111111111111111111111111111000"
+                     "00000000000000000000000000000000");
     free(string);
     bitmap_free(bitmap);
 
     bitmap = bitmap_from_word((-1));
     string = bitmap_to_string(bitmap);
-    ASSERT_STRING_EQ(string, "11111111111111111111111111111111");
+    ASSERT_STRING_EQ(string,
+                     "11111111111111111111111111111111"
+                     "11111111111111111111111111111111");
     free(string);
     bitmap_free(bitmap);
 
-    bitmap = bitmap_from_word(((unsigned int)(-1)) >> 3);
+    bitmap = bitmap_from_word(((word_t)(-1)) >> 3);
     string = bitmap_to_string(bitmap);
-    ASSERT_STRING_EQ(string, "11111111111111111111111111111000");
+    ASSERT_STRING_EQ(string,
+                     "11111111111111111111111111111111"
+                     "11111111111111111111111111111000");
     free(string);
     bitmap_free(bitmap);
 
-    bitmap = bitmap_from_word(((unsigned int)(-1)) << 3);
+    bitmap = bitmap_from_word(((word_t)(-1)) << 3);
     string = bitmap_to_string(bitmap);
-    ASSERT_STRING_EQ(string, "00011111111111111111111111111111");
+    ASSERT_STRING_EQ(string,
+                     "00011111111111111111111111111111"
+                     "11111111111111111111111111111111");
     free(string);
     bitmap_free(bitmap);
 }
@@ -259,6 +272,209 @@ void test_bitmap_extract()
     bitmap_free(bitmap);
 }
 
+/** a random bitmap and the same bits as a char array. */
+static BitMap *random_bitmap(unsigned int num_bits, char *bits, int percent)
+{
+    BitMap *bitmap = bitmap_new(num_bits);
+    for (unsigned int i = 0; i < num_bits; ++i) {
+        bits[i] = rand() % 100 < percent;
+        if (bits[i]) {
+            bitmap_set(bitmap, i);
+        }
+    }
+    return bitmap;
+}
+
+static void check_bitmap_bits(const BitMap *bitmap, const char *bits)
+{
+    for (unsigned int i = 0; i < bitmap->num_bits; ++i) {
+        ASSERT_INT_EQ(bitmap_get(bitmap, i), bits[i]);
+    }
+}
+
+void test_bitmap_ops()
+{
+    /** long enough for the SIMD kernels, with a partial tail word. */
+    unsigned int sizes[] = {0, 1, 63, 64, 65, 1000, 5000};
+    char *bits1 = (char *)malloc(5000);
+    char *bits2 = (char *)malloc(5000);
+    srand(2019);
+
+    for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        unsigned int n = sizes[s];
+        BitMap *bitmap1 = random_bitmap(n, bits1, 30);
+        BitMap *bitmap2 = random_bitmap(n, bits2, 60);
+        unsigned int count = 0;
+        for (unsigned int i = 0; i < n; ++i) {
+            count += bits1[i];
+        }
+        ASSERT_INT_EQ(bitmap_count(bitmap1), count);
+
+        BitMap *result = bitmap_clone(bitmap1);
+        bitmap_or(result, bitmap2);
+        for (unsigned int i = 0; i < n; ++i) {
+            ASSERT_INT_EQ(bitmap_get(result, i), (bits1[i] | bits2[i]));
+        }
+        bitmap_free(result);
+
+        result = bitmap_clone(bitmap1);
+        bitmap_and(result, bitmap2);
+        for (unsigned int i = 0; i < n; ++i) {
+            ASSERT_INT_EQ(bitmap_get(result, i), (bits1[i] & bits2[i]));
+        }
+        bitmap_free(result);
+
+        result = bitmap_clone(bitmap1);
+        bitmap_xor(result, bitmap2);
+        for (unsigned int i = 0; i < n; ++i) {
+            ASSERT_INT_EQ(bitmap_get(result, i), (bits1[i] ^ bits2[i]));
+        }
+        bitmap_free(result);
+
+        result = bitmap_clone(bitmap1);
+        bitmap_andnot(result, bitmap2);
+        for (unsigned int i = 0; i < n; ++i) {
+            ASSERT_INT_EQ(bitmap_get(result, i), (bits1[i] & !bits2[i]));
+        }
+        bitmap_free(result);
+
+        /** set_all keeps the bits after num_bits 0. */
+        bitmap_set_all(bitmap1);
+        ASSERT_INT_EQ(bitmap_count(bitmap1), n);
+
+        bitmap_free(bitmap1);
+        bitmap_free(bitmap2);
+    }
+
+    /** missing bits of a shorter other are 0. */
+    BitMap *bitmap = bitmap_new(200);
+    BitMap *other = bitmap_new(10);
+    bitmap_set_all(bitmap);
+    bitmap_set_all(other);
+    bitmap_xor(bitmap, other);
+    ASSERT_INT_EQ(bitmap_count(bitmap), 190);
+    bitmap_and(bitmap, other);
+    ASSERT_INT_EQ(bitmap_count(bitmap), 0);
+    bitmap_free(bitmap);
+    bitmap_free(other);
+
+    free(bits1);
+    free(bits2);
+}
+
+void test_bitmap_rank_select()
+{
+    unsigned int n = 3000;
+    char *bits = (char *)malloc(n);
+    srand(2020);
+
+    for (int percent = 0; percent <= 100; percent += 25) {
+        BitMap *bitmap = random_bitmap(n, bits, percent);
+        unsigned int rank = 0;
+        unsigned int next = BITMAP_NOT_FOUND;
+        for (unsigned int i = 0; i < n; ++i) {
+            ASSERT_INT_EQ(bitmap_rank(bitmap, i), rank);
+            if (bits[i]) {
+                ASSERT_INT_EQ(bitmap_select(bitmap, rank), i);
+                ++rank;
+            }
+        }
+        ASSERT_INT_EQ(bitmap_rank(bitmap, n), rank);
+        ASSERT_INT_EQ(bitmap_rank(bitmap, n + 100), rank);
+        assert(bitmap_select(bitmap, rank) == BITMAP_NOT_FOUND);
+
+        /** iterate from the end, next_set(i) is the next 1 bit. */
+        for (unsigned int i = n; i-- > 0;) {
+            if (bits[i]) {
+                next = i;
+            }
+            assert(bitmap_next_set(bitmap, i) == next);
+        }
+        assert(bitmap_first_set(bitmap) == next);
+        assert(bitmap_next_set(bitmap, n) == BITMAP_NOT_FOUND);
+
+        unsigned int visited = 0;
+        for (unsigned int i = bitmap_first_set(bitmap); i != BITMAP_NOT_FOUND;
+             i = bitmap_next_set(bitmap, i + 1)) {
+            assert(bits[i]);
+            ++visited;
+        }
+        ASSERT_INT_EQ(visited, rank);
+        bitmap_free(bitmap);
+    }
+
+    BitMap *empty = bitmap_new(0);
+    assert(bitmap_first_set(empty) == BITMAP_NOT_FOUND);
+    assert(bitmap_select(empty, 0) == BITMAP_NOT_FOUND);
+    ASSERT_INT_EQ(bitmap_count(empty), 0);
+    bitmap_free(empty);
+    free(bits);
+}
+
+void test_bitmap_append_concat()
+{
+    unsigned int n = 2000;
+    char *bits = (char *)malloc((n + BITS_PER_WORD) * 2);
+    srand(2021);
+
+    /** append bits of random widths, then read them back. */
+    BitMap *bitmap = bitmap_new(0);
+    unsigned int num_bits = 0;
+    while (num_bits < n) {
+        unsigned int width = rand() % (BITS_PER_WORD + 1);
+        word_t word =
+            ((word_t)rand() << 40) ^ ((word_t)rand() << 20) ^ (word_t)rand();
+        bitmap_append_bits(bitmap, word, width);
+        for (unsigned int i = 0; i < width; ++i) {
+            bits[num_bits + i] = (word >> i) & 1;
+        }
+        num_bits += width;
+        ASSERT_INT_EQ(bitmap->num_bits, num_bits);
+    }
+    assert(bitmap->capacity >= bitmap->num_words);
+    check_bitmap_bits(bitmap, bits);
+    for (unsigned int i = 0; i < num_bits; i += 7) {
+        unsigned int width = i % (BITS_PER_WORD + 1);
+        word_t word = bitmap_extract_bits(bitmap, i, width);
+        for (unsigned int j = 0; j < width; ++j) {
+            int bit = i + j < num_bits ? bits[i + j] : 0;
+            ASSERT_INT_EQ((int)((word >> j) & 1), bit);
+        }
+    }
+    assert(bitmap_extract_bits(bitmap, num_bits + 1000, 8) == 0);
+
+    /** concat at every alignment, and to itself. */
+    for (unsigned int shift = 0; shift < 70; shift += 3) {
+        BitMap *head = bitmap_from_string("1");
+        for (unsigned int i = 1; i < shift; ++i) {
+            bitmap_append(head, i % 2);
+        }
+        BitMap *clone = bitmap_clone(head);
+        bitmap_concat(head, bitmap);
+        ASSERT_INT_EQ(head->num_bits, clone->num_bits + num_bits);
+        for (unsigned int i = 0; i < clone->num_bits; ++i) {
+            ASSERT_INT_EQ(bitmap_get(head, i), bitmap_get(clone, i));
+        }
+        for (unsigned int i = 0; i < num_bits; ++i) {
+            ASSERT_INT_EQ(bitmap_get(head, clone->num_bits + i), bits[i]);
+        }
+        ASSERT_INT_EQ(bitmap_count(head),
+                      bitmap_count(clone) + bitmap_count(bitmap));
+        bitmap_free(clone);
+        bitmap_free(head);
+    }
+
+    unsigned int count = bitmap_count(bitmap);
+    bitmap_concat(bitmap, bitmap);
+    ASSERT_INT_EQ(bitmap->num_bits, num_bits * 2);
+    ASSERT_INT_EQ(bitmap_count(bitmap), count * 2);
+    memcpy(bits + num_bits, bits, num_bits);
+    check_bitmap_bits(bitmap, bits);
+
+    bitmap_free(bitmap);
+    free(bits);
+}
+
 void test_bitmap()
 {
     test_bitmap_basic();
@@ -269,6 +485,9 @@ void test_bitmap()
     test_bitmap_merege_simple();
     test_bitmap_merege();
     test_bitmap_extract();
+    test_bitmap_ops();
+    test_bitmap_rank_select();
+    test_bitmap_append_concat();
 }
 
 void test_bitmap_words()
@@ -289,7 +508,7 @@ void test_bitmap_words()
     assert(get_bit(&flag, 1) == 0);
 
     flag = WORD_ALL_SETTED;
-    assert(flag == 0xFFFFFFFF);
+    assert(flag == 0xFFFFFFFFFFFFFFFFULL);
 
     int len = 10;
     word_t *flags = (word_t *)malloc(sizeof(word_t) * len);
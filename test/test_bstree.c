@@ -84,6 +84,38 @@ void test_bstree()
     bs_tree_free(tree);
 }
 
+void test_bstree_slab()
+{
+    int entries[] = {38, 23, 42, 4, 16, 15, 8, 99, 50, 30};
+    int num_entries = sizeof(entries) / sizeof(int);
+
+    BSTree *tree = bs_tree_new_with_slab(int_compare, 4);
+    for (int i = 0; i < num_entries; ++i) {
+        assert(int_equal(bs_tree_insert(tree, &entries[i])->data, &entries[i]));
+    }
+    ASSERT_INT_EQ(slab_num_pages(tree->slab), 3);
+
+    BSTreeNode *node =
+        bs_tree_remove_node(tree, bs_tree_lookup_data(tree, &entries[0]));
+    bs_tree_free_node(tree, node);
+    assert(bs_tree_lookup_data(tree, &entries[0]) == NULL);
+    ASSERT_INT_EQ(slab_size(tree->slab), num_entries - 1);
+
+    /** the removed node is reused. */
+    bs_tree_insert(tree, &entries[0]);
+    ASSERT_INT_EQ(slab_num_pages(tree->slab), 3);
+    bs_tree_free(tree);
+
+    /** out of memory for the tree, then for its Slab. */
+    size_t allocated = alloc_test_get_allocated();
+    for (int limit = 0; limit < 2; ++limit) {
+        alloc_test_set_limit(limit);
+        assert(bs_tree_new_with_slab(int_compare, 4) == NULL);
+        alloc_test_set_limit(-1);
+        assert(alloc_test_get_allocated() == allocated);
+    }
+}
+
 void test_bstree_remove()
 {
     int entries[] = {38, 23, 42, 4,  16,  15, 8,  99, 50, 30,
@@ -0,0 +1,137 @@
+#include "concurrent_hash_table.h"
+#include "hash.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+#define NUM_THREADS 4
+#define KEYS_PER_THREAD 5000
+
+void test_concurrent_hash_table_basic()
+{
+    ConcurrentHashTable *table =
+        concurrent_hash_table_new(hash_int, int_equal, free, free, 0);
+    for (int i = 0; i < 1000; ++i) {
+        assert(concurrent_hash_table_insert(table, intdup(i), intdup(i)) == 0);
+    }
+    ASSERT_INT_EQ(concurrent_hash_table_size(table), 1000);
+
+    int *key = intdup(1);
+    int *value = intdup(1);
+    assert(concurrent_hash_table_insert(table, key, value) == -1);
+    free(key);
+    free(value);
+
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_INT_POINTER_EQ(concurrent_hash_table_get(table, &i), i);
+    }
+
+    int i = 5;
+    assert(concurrent_hash_table_set(table, &i, intdup(50)) == 0);
+    ASSERT_INT_POINTER_EQ(concurrent_hash_table_get(table, &i), 50);
+    assert(concurrent_hash_table_set(table, intdup(2000), intdup(2000)) == 0);
+    ASSERT_INT_EQ(concurrent_hash_table_size(table), 1001);
+
+    assert(concurrent_hash_table_delete(table, &i) == 0);
+    assert(concurrent_hash_table_delete(table, &i) == -1);
+    assert(concurrent_hash_table_get(table, &i) == HASH_TABLE_VALUE_NULL);
+    ASSERT_INT_EQ(concurrent_hash_table_size(table), 1000);
+
+    concurrent_hash_table_free(table);
+
+    /** stripes are rounded up to a power of two, at least 2. */
+    table = concurrent_hash_table_new(hash_int, int_equal, free, NULL, 1);
+    assert(concurrent_hash_table_insert(table, intdup(1), NULL) == 0);
+    ASSERT_INT_EQ(concurrent_hash_table_size(table), 1);
+    concurrent_hash_table_free(table);
+}
+
+static int sum_keys(HashTableKey key, HashTableValue value, void *data)
+{
+    assert(*(int *)key == *(int *)value);
+    *(long *)data += *(int *)key;
+    return 0;
+}
+
+static int stop_at_first(HashTableKey key, HashTableValue value, void *data)
+{
+    ++*(int *)data;
+    return 7;
+}
+
+typedef struct {
+    ConcurrentHashTable *table;
+    int id;
+} Worker;
+
+static void *insert_get_delete(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    int from = worker->id * KEYS_PER_THREAD;
+    for (int i = from; i < from + KEYS_PER_THREAD; ++i) {
+        assert(concurrent_hash_table_insert(
+                   worker->table, intdup(i), intdup(i)) == 0);
+    }
+    for (int i = from; i < from + KEYS_PER_THREAD; ++i) {
+        ASSERT_INT_POINTER_EQ(concurrent_hash_table_get(worker->table, &i), i);
+    }
+    /** delete odd keys. */
+    for (int i = from + 1; i < from + KEYS_PER_THREAD; i += 2) {
+        assert(concurrent_hash_table_delete(worker->table, &i) == 0);
+    }
+    return NULL;
+}
+
+static void *iterate(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    for (int round = 0; round < 20; ++round) {
+        long sum = 0;
+        assert(concurrent_hash_table_foreach(worker->table, sum_keys, &sum) ==
+               0);
+    }
+    return NULL;
+}
+
+void test_concurrent_hash_table_threads()
+{
+    ConcurrentHashTable *table =
+        concurrent_hash_table_new(hash_int, int_equal, free, free, 16);
+    pthread_t threads[NUM_THREADS + 1];
+    Worker workers[NUM_THREADS + 1];
+
+    for (int t = 0; t <= NUM_THREADS; ++t) {
+        workers[t].table = table;
+        workers[t].id = t;
+        pthread_create(&threads[t],
+                       NULL,
+                       t < NUM_THREADS ? insert_get_delete : iterate,
+                       &workers[t]);
+    }
+    for (int t = 0; t <= NUM_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    /** even keys are left. */
+    int total = NUM_THREADS * KEYS_PER_THREAD;
+    ASSERT_INT_EQ(concurrent_hash_table_size(table), total / 2);
+    long sum = 0;
+    assert(concurrent_hash_table_foreach(table, sum_keys, &sum) == 0);
+    assert(sum == (long)(total / 2) * (total / 2 - 1));
+
+    int visited = 0;
+    assert(concurrent_hash_table_foreach(table, stop_at_first, &visited) == 7);
+    ASSERT_INT_EQ(visited, 1);
+
+    concurrent_hash_table_free(table);
+}
+
+void test_concurrent_hash_table()
+{
+    test_concurrent_hash_table_basic();
+    test_concurrent_hash_table_threads();
+}
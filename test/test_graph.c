@@ -1,4 +1,5 @@
 #include "graph.h"
+#include "sparse_graph.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -67,3 +68,33 @@ void test_graph()
     test_graph_bfs();
     test_graph_dfs();
 }
+
+void test_sparse_graph()
+{
+    int arcs[][2] = {{5, 2}, {5, 0}, {4, 0}, {4, 1}, {2, 3},
+                     {3, 1}, {6, 5}, {6, 4}, {7, 6}, {2, 1}};
+    int num_arcs = sizeof(arcs) / sizeof(arcs[0]);
+    int num_vertexes = 8;
+    int position[8];
+
+    SparseGraph *graph = sparse_graph_new(num_vertexes);
+    for (int i = 0; i < num_arcs; ++i) {
+        ASSERT_INT_EQ(sparse_graph_link(graph, arcs[i][0], arcs[i][1]), 0);
+    }
+    ASSERT_INT_EQ(sparse_graph_link(graph, 5, 2), 1);
+
+    int *sorted = sparse_graph_topo_sort(graph);
+    for (int i = 0; i < num_vertexes; ++i) {
+        position[i] = -1;
+    }
+    for (int i = 0; i < num_vertexes; ++i) {
+        assert(position[sorted[i]] == -1);
+        position[sorted[i]] = i;
+    }
+    for (int i = 0; i < num_arcs; ++i) {
+        assert(position[arcs[i][0]] < position[arcs[i][1]]);
+    }
+
+    free(sorted);
+    sparse_graph_free(graph);
+}
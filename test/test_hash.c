@@ -0,0 +1,93 @@
+#include "hash.h"
+#include "hash_table.h"
+#include "text.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+void test_hash_bytes64()
+{
+    unsigned char buf[256];
+    uint64_t hashes[257];
+    for (int i = 0; i < 256; ++i) {
+        buf[i] = (unsigned char)(i * 7 + 1);
+    }
+
+    /** every length hits a different code path and a different hash. */
+    for (int len = 0; len <= 256; ++len) {
+        hashes[len] = hash_bytes64(buf, len, 0);
+        assert(hashes[len] == hash_bytes64(buf, len, 0));
+        for (int j = 0; j < len; ++j) {
+            assert(hashes[j] != hashes[len]);
+        }
+    }
+
+    /** flip any bit, get another hash. */
+    uint64_t origin = hash_bytes64(buf, 100, 0);
+    for (int bit = 0; bit < 100 * 8; ++bit) {
+        buf[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+        assert(hash_bytes64(buf, 100, 0) != origin);
+        buf[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+    }
+
+    assert(hash_bytes64(buf, 100, 1) != origin);
+    assert(hash_bytes64(buf, 3, 1) != hash_bytes64(buf, 3, 2));
+}
+
+void test_hash_mix()
+{
+    /** hash_mix64 is bijective: no collisions on consecutive integers. */
+    HashTable *hash_table = hash_table_new_with_type(
+        HASH_TABLE_OPEN_ADDRESSING, hash_int_mix, int_equal, free, NULL);
+    for (int i = 0; i < 10000; ++i) {
+        assert(hash_mix64(i) != hash_mix64(i + 1));
+        assert(hash_table_insert(hash_table, intdup(i), NULL) == 0);
+    }
+    ASSERT_INT_EQ(hash_table_size(hash_table), 10000);
+    hash_table_free(hash_table);
+
+    int value = 0;
+    assert(hash_object_mix(&value) != hash_object_mix(&value + 1));
+}
+
+void test_hash_string_fast()
+{
+    Text *text = text_from("hello, world");
+    assert(hash_string_fast("hello, world") == hash_text_fast(text));
+    assert(hash_string_fast("hello, world") != hash_string_fast("hello world"));
+    text_free(text);
+
+    /** different seed, different hash. */
+    unsigned int before = hash_string_fast("seed");
+    uint64_t seed = hash_get_seed();
+    hash_set_seed(seed + 1);
+    assert(hash_string_fast("seed") != before);
+    hash_randomize_seed();
+    hash_set_seed(seed);
+    assert(hash_string_fast("seed") == before);
+
+    char buf[10];
+    HashTable *hash_table =
+        hash_table_new(hash_string_fast, string_equal, free, NULL);
+    for (int i = 0; i < 10000; ++i) {
+        sprintf(buf, "%i", i);
+        assert(hash_table_insert(hash_table, strdup(buf), NULL) == 0);
+    }
+    for (int i = 0; i < 10000; ++i) {
+        sprintf(buf, "%i", i);
+        assert(hash_table_delete(hash_table, buf) == 0);
+    }
+    hash_table_free(hash_table);
+}
+
+void test_hash()
+{
+    test_hash_bytes64();
+    test_hash_mix();
+    test_hash_string_fast();
+}
@@ -164,6 +164,301 @@ void test_hash_table_iterate()
     hash_table_free(hash_table);
 }
 
+void test_hash_table_open_addressing()
+{
+    char buf[10];
+    HashTable *hash_table = hash_table_new_with_type(
+        HASH_TABLE_OPEN_ADDRESSING, hash_string, string_equal, free, NULL);
+    for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+        sprintf(buf, "%i", i);
+        char *key = strdup(buf);
+        assert(hash_table_insert(hash_table, key, key) == 0);
+    }
+    ASSERT_INT_EQ(hash_table_size(hash_table), MAX_TABLE_SIZE);
+
+    /** duplicated key is rejected. */
+    assert(hash_table_insert(hash_table, "0", NULL) == -1);
+
+    for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+        sprintf(buf, "%i", i);
+        assert(string_equal(hash_table_get(hash_table, buf), buf));
+    }
+    assert(hash_table_get(hash_table, "not exists") == HASH_TABLE_VALUE_NULL);
+
+    /** delete the odd keys, leave tombstones, then insert them again. */
+    for (int i = 1; i < MAX_TABLE_SIZE; i += 2) {
+        sprintf(buf, "%i", i);
+        assert(hash_table_delete(hash_table, buf) == 0);
+        assert(hash_table_get(hash_table, buf) == HASH_TABLE_VALUE_NULL);
+    }
+    assert(hash_table_delete(hash_table, "1") == -1);
+    ASSERT_INT_EQ(hash_table_size(hash_table), MAX_TABLE_SIZE / 2);
+
+    for (int i = 1; i < MAX_TABLE_SIZE; i += 2) {
+        sprintf(buf, "%i", i);
+        char *key = strdup(buf);
+        assert(hash_table_insert(hash_table, key, key) == 0);
+    }
+    for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+        sprintf(buf, "%i", i);
+        assert(string_equal(hash_table_get(hash_table, buf), buf));
+    }
+
+    int count = 0;
+    for (HashTableEntity *iterator = hash_table_first_entity(hash_table);
+         iterator != NULL;
+         iterator = hash_table_next_entity(hash_table, iterator)) {
+        ++count;
+    }
+    ASSERT_INT_EQ(count, MAX_TABLE_SIZE);
+
+    hash_table_free(hash_table);
+}
+
+void test_hash_table_open_addressing_first_last()
+{
+    HashTable *hash_table = hash_table_new_with_type(
+        HASH_TABLE_OPEN_ADDRESSING, hash_int, int_equal, free, free);
+
+    for (int i = 0; i < 100; ++i) {
+        assert(hash_table_insert(hash_table, intdup(i), intdup(i * 2)) == 0);
+    }
+    assert(hash_table_set(hash_table, &(int){7}, intdup(-7)) == 0);
+    ASSERT_INT_POINTER_EQ(hash_table_get(hash_table, &(int){7}), -7);
+    ASSERT_INT_EQ(hash_table_size(hash_table), 100);
+
+    int count = 0;
+    for (HashTableEntity *iterator = hash_table_last_entity(hash_table);
+         iterator != NULL;
+         iterator = hash_table_prev_entity(hash_table, iterator)) {
+        ++count;
+    }
+    ASSERT_INT_EQ(count, 100);
+
+    HashTableEntity *iterator = hash_table_last_entity(hash_table);
+    while (iterator != NULL) {
+        HashTableEntity *prev = iterator;
+        iterator = hash_table_prev_entity(hash_table, prev);
+        hash_table_delete(hash_table, prev->key);
+    }
+    ASSERT_INT_EQ(hash_table_size(hash_table), 0);
+    assert(hash_table_first_entity(hash_table) == NULL);
+
+    hash_table_free(hash_table);
+}
+
+void test_hash_table_incremental_rehash()
+{
+    char buf[10];
+    HashTable *hash_table =
+        hash_table_new(hash_string, string_equal, free, NULL);
+    hash_table_set_rehash_step(hash_table, 1);
+
+    for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+        sprintf(buf, "%i", i);
+        char *key = strdup(buf);
+        assert(hash_table_insert(hash_table, key, key) == 0);
+
+        /** every key is reachable while buckets are moving. */
+        if (i % 97 == 0) {
+            for (int j = 0; j <= i; j += 7) {
+                sprintf(buf, "%i", j);
+                assert(string_equal(hash_table_get(hash_table, buf), buf));
+            }
+        }
+    }
+    assert(hash_table_insert(hash_table, "9999", NULL) == -1);
+    ASSERT_INT_EQ(hash_table_size(hash_table), MAX_TABLE_SIZE);
+
+    int count = 0;
+    for (HashTableEntity *iterator = hash_table_first_entity(hash_table);
+         iterator != NULL;
+         iterator = hash_table_next_entity(hash_table, iterator)) {
+        ++count;
+    }
+    ASSERT_INT_EQ(count, MAX_TABLE_SIZE);
+
+    count = 0;
+    for (HashTableEntity *iterator = hash_table_last_entity(hash_table);
+         iterator != NULL;
+         iterator = hash_table_prev_entity(hash_table, iterator)) {
+        ++count;
+    }
+    ASSERT_INT_EQ(count, MAX_TABLE_SIZE);
+
+    for (int i = 0; i < MAX_TABLE_SIZE; i += 2) {
+        sprintf(buf, "%i", i);
+        assert(hash_table_delete(hash_table, buf) == 0);
+    }
+    ASSERT_INT_EQ(hash_table_size(hash_table), MAX_TABLE_SIZE / 2);
+    for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+        sprintf(buf, "%i", i);
+        if (i % 2 == 0) {
+            assert(hash_table_get(hash_table, buf) == HASH_TABLE_VALUE_NULL);
+        } else {
+            assert(string_equal(hash_table_get(hash_table, buf), buf));
+        }
+    }
+
+    hash_table_free(hash_table);
+}
+
+static unsigned int hash_zero(void *key)
+{
+    return 0;
+}
+
+void test_hash_table_delete_in_chain()
+{
+    /** all keys collide in one chain. */
+    HashTable *hash_table = hash_table_new(hash_zero, int_equal, free, free);
+    for (int i = 0; i < 10; ++i) {
+        assert(hash_table_insert(hash_table, intdup(i), intdup(i)) == 0);
+    }
+
+    assert(hash_table_delete(hash_table, &(int){5}) == 0);
+    assert(hash_table_delete(hash_table, &(int){0}) == 0);
+    assert(hash_table_delete(hash_table, &(int){9}) == 0);
+    assert(hash_table_delete(hash_table, &(int){9}) == -1);
+    ASSERT_INT_EQ(hash_table_size(hash_table), 7);
+
+    for (int i = 0; i < 10; ++i) {
+        if (i == 0 || i == 5 || i == 9) {
+            assert(hash_table_get(hash_table, &i) == HASH_TABLE_VALUE_NULL);
+        } else {
+            ASSERT_INT_POINTER_EQ(hash_table_get(hash_table, &i), i);
+        }
+    }
+
+    hash_table_free(hash_table);
+}
+
+static int equal_calls = 0;
+
+static int int_equal_counted(void *key1, void *key2)
+{
+    ++equal_calls;
+    return int_equal(key1, key2);
+}
+
+void test_hash_table_cached_hash()
+{
+    HashTableType types[] = {HASH_TABLE_CHAINING, HASH_TABLE_OPEN_ADDRESSING};
+    for (int t = 0; t < 2; ++t) {
+        HashTable *hash_table = hash_table_new_with_type(
+            types[t], hash_int, int_equal_counted, free, NULL);
+        equal_calls = 0;
+
+        /** distinct hashes: neither collisions nor resizing compare keys. */
+        for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+            assert(hash_table_insert(hash_table, intdup(i), NULL) == 0);
+        }
+        ASSERT_INT_EQ(equal_calls, 0);
+
+        for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+            assert(hash_table_delete(hash_table, &i) == 0);
+        }
+        ASSERT_INT_EQ(equal_calls, MAX_TABLE_SIZE);
+
+        hash_table_free(hash_table);
+    }
+}
+
+void test_hash_table_batch()
+{
+    static int numbers[MAX_TABLE_SIZE * 2];
+    HashTableKey keys[MAX_TABLE_SIZE * 2];
+    HashTableValue values[MAX_TABLE_SIZE * 2];
+    for (int i = 0; i < MAX_TABLE_SIZE * 2; ++i) {
+        numbers[i] = i;
+    }
+
+    for (int t = 0; t < 3; ++t) {
+        HashTable *hash_table = hash_table_new_with_type(
+            t == 2 ? HASH_TABLE_OPEN_ADDRESSING : HASH_TABLE_CHAINING,
+            hash_int,
+            int_equal,
+            NULL,
+            NULL);
+        if (t == 1) {
+            hash_table_set_rehash_step(hash_table, 1);
+        }
+
+        /** insert even keys, the second insert of a key is skipped. */
+        for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+            keys[i] = &numbers[(i * 2) % MAX_TABLE_SIZE];
+            values[i] = &numbers[i];
+        }
+        ASSERT_INT_EQ(
+            hash_table_insert_many(hash_table, keys, values, MAX_TABLE_SIZE),
+            MAX_TABLE_SIZE / 2);
+        ASSERT_INT_EQ(hash_table_size(hash_table), MAX_TABLE_SIZE / 2);
+
+        /** batch get agrees with single get, odd keys miss. */
+        for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+            keys[i] = &numbers[i];
+        }
+        hash_table_get_many(hash_table, keys, MAX_TABLE_SIZE, values);
+        for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+            if (i % 2 == 0) {
+                assert(values[i] == hash_table_get(hash_table, &i));
+                assert(values[i] != HASH_TABLE_VALUE_NULL);
+                ASSERT_INT_EQ(*(int *)values[i], i / 2);
+            } else {
+                assert(values[i] == HASH_TABLE_VALUE_NULL);
+            }
+        }
+
+        /** set overwrites existing keys and inserts the others. */
+        for (int i = 0; i < MAX_TABLE_SIZE * 2; ++i) {
+            keys[i] = &numbers[i];
+            values[i] = &numbers[MAX_TABLE_SIZE * 2 - 1 - i];
+        }
+        assert(hash_table_set_many(
+                   hash_table, keys, values, MAX_TABLE_SIZE * 2) == 0);
+        ASSERT_INT_EQ(hash_table_size(hash_table), MAX_TABLE_SIZE * 2);
+        hash_table_get_many(hash_table, keys, MAX_TABLE_SIZE * 2, values);
+        for (int i = 0; i < MAX_TABLE_SIZE * 2; ++i) {
+            ASSERT_INT_EQ(*(int *)values[i], MAX_TABLE_SIZE * 2 - 1 - i);
+        }
+
+        /** empty batches are no-ops. */
+        hash_table_get_many(hash_table, keys, 0, values);
+        ASSERT_INT_EQ(hash_table_insert_many(hash_table, keys, values, 0), 0);
+
+        hash_table_free(hash_table);
+    }
+}
+
+void test_hash_table_slab()
+{
+    static int numbers[MAX_TABLE_SIZE];
+    for (int round = 0; round < 2; ++round) {
+        /** free values: entities are walked, then the pages are dropped. */
+        HashTable *hash_table = hash_table_new_with_slab(
+            hash_int, int_equal, NULL, round == 0 ? NULL : free, 0);
+        hash_table_set_rehash_step(hash_table, round);
+        for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+            numbers[i] = i;
+            HashTableValue value = round == 0 ? &numbers[i] : intdup(i);
+            assert(hash_table_insert(hash_table, &numbers[i], value) == 0);
+        }
+        for (int i = 0; i < MAX_TABLE_SIZE; i += 2) {
+            assert(hash_table_delete(hash_table, &i) == 0);
+        }
+        for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+            HashTableValue value = hash_table_get(hash_table, &i);
+            if (i % 2 == 0) {
+                assert(value == HASH_TABLE_VALUE_NULL);
+            } else {
+                ASSERT_INT_POINTER_EQ(value, i);
+            }
+        }
+        ASSERT_INT_EQ(hash_table_size(hash_table), MAX_TABLE_SIZE / 2);
+        hash_table_free(hash_table);
+    }
+}
+
 void test_hash_table()
 {
     test_hash_table_string();
@@ -171,4 +466,11 @@ void test_hash_table()
     test_hash_table_enlarge();
     test_hash_table_first_last();
     test_hash_table_iterate();
+    test_hash_table_open_addressing();
+    test_hash_table_open_addressing_first_last();
+    test_hash_table_incremental_rehash();
+    test_hash_table_delete_in_chain();
+    test_hash_table_cached_hash();
+    test_hash_table_batch();
+    test_hash_table_slab();
 }
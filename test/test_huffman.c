@@ -3,10 +3,13 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "alloc-testing.h"
 #include "test_helper.h"
 
+extern HashTable *huffman_tree_to_hash_table(HuffmanTree *tree);
+
 void test_huffman_tree()
 {
     Heap *heap = huffman_heap_new();
@@ -89,7 +92,756 @@ void test_huffman_decode()
     huffman_tree_free(tree);
 }
 
-extern HashTable *huffman_tree_to_hash_table(HuffmanTree *tree);
+void test_huffman_decode_out_of_memory()
+{
+    Heap *heap = huffman_heap_new();
+    huffman_heap_insert(heap, 'a', 7);
+    huffman_heap_insert(heap, 'b', 5);
+    huffman_heap_insert(heap, 'c', 3);
+    huffman_heap_insert(heap, 'd', 1);
+    HuffmanTree *tree = huffman_tree_from(heap);
+
+    /** 1 bit a byte, so the output outgrows its first guess. */
+    Text *text = text_new();
+    for (int i = 0; i < 200; ++i) {
+        text_append(text, 'a');
+    }
+    text_append(text, 'b');
+    text_append(text, 'c');
+    text_append(text, 'd');
+    BitMap *code = huffman_encode(tree, text);
+
+    /** the allocations of the decode table. */
+    int table_allocs = 0;
+    HuffmanDecodeTable *table = NULL;
+    while (table == NULL) {
+        alloc_test_set_limit(++table_allocs);
+        table = huffman_decode_table_new(tree);
+    }
+    alloc_test_set_limit(-1);
+    huffman_decode_table_free(table);
+
+    /** the buffer, each realloc, then the Text fail in turn. */
+    size_t allocated = alloc_test_get_allocated();
+    int limit = table_allocs;
+    Text *new_text = NULL;
+    while (new_text == NULL) {
+        alloc_test_set_limit(limit++);
+        new_text = huffman_decode(tree, code);
+        alloc_test_set_limit(-1);
+        if (new_text == NULL) {
+            assert(alloc_test_get_allocated() == allocated);
+        }
+    }
+    assert(limit > table_allocs + 2);
+    ASSERT_INT_EQ(text_compare(text, new_text), 0);
+
+    text_free(new_text);
+    bitmap_free(code);
+    text_free(text);
+    huffman_tree_free(tree);
+}
+
+void test_huffman_table()
+{
+    Heap *heap = huffman_heap_new();
+    huffman_heap_insert(heap, 'a', 7);
+    huffman_heap_insert(heap, 'b', 5);
+    huffman_heap_insert(heap, 'c', 3);
+    huffman_heap_insert(heap, 'd', 1);
+
+    // a: 0, b: 11, c: 101, d: 100, the first bit in bit 0.
+    HuffmanTree *tree = huffman_tree_from(heap);
+    HuffmanTable *table = huffman_table_new(tree);
+
+    ASSERT_INT_EQ(table->lengths['a'], 1);
+    ASSERT_INT_EQ((int)table->codes['a'], 0);
+    ASSERT_INT_EQ(table->lengths['b'], 2);
+    ASSERT_INT_EQ((int)table->codes['b'], 3);
+    ASSERT_INT_EQ(table->lengths['c'], 3);
+    ASSERT_INT_EQ((int)table->codes['c'], 5);
+    ASSERT_INT_EQ(table->lengths['d'], 3);
+    ASSERT_INT_EQ((int)table->codes['d'], 1);
+    ASSERT_INT_EQ(table->lengths['e'], 0);
+
+    ASSERT(huffman_table_encoded_bits(table, "abcabcaaaaabbbcd", 16) == 29,
+           "Huffman table encoded bits not equal to 29.");
+
+    huffman_table_free(table);
+    huffman_tree_free(tree);
+}
+
+void test_huffman_table_encode_to()
+{
+    /** all 256 bytes, skewed weights: codes of many lengths, crossing words. */
+    Heap *heap = huffman_heap_new();
+    for (int i = 0; i < 256; ++i) {
+        huffman_heap_insert(heap, (char)i, 1 + (i % 16) * (i % 16) * (i % 7));
+    }
+    HuffmanTree *tree = huffman_tree_from(heap);
+    HuffmanTable *table = huffman_table_new(tree);
+    HashTable *hash_table = huffman_tree_to_hash_table(tree);
+
+    char string[3000];
+    srand(2019);
+    for (int i = 0; i < 3000; ++i) {
+        string[i] = (char)(rand() & 0xFF);
+    }
+
+    for (unsigned int size = 0; size <= 3000; size += 97) {
+        BitMap *expected = bitmap_new(0);
+        for (unsigned int i = 0; i < size; ++i) {
+            bitmap_concat(expected,
+                          (BitMap *)hash_table_get(hash_table, &(string[i])));
+        }
+
+        uint64_t num_bits = huffman_table_encoded_bits(table, string, size);
+        ASSERT(num_bits == expected->num_bits,
+               "Huffman table encoded bits not equal to expected.");
+
+        /** a guard word past the output must not be touched. */
+        unsigned int num_words = (num_bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+        word_t *words = (word_t *)malloc(sizeof(word_t) * (num_words + 1));
+        memset(words, 0xFF, sizeof(word_t) * (num_words + 1));
+        ASSERT(huffman_table_encode_to(table, string, size, words) == num_bits,
+               "Huffman table encode_to bits not equal to expected.");
+        ASSERT(words[num_words] == WORD_ALL_SETTED,
+               "Huffman table encode_to wrote past the end.");
+
+        BitMap *code = huffman_encode_string(tree, string, size);
+        ASSERT(bitmap_equal(code, expected),
+               "Huffman table code not equal to hash table code.");
+        ASSERT(num_words == 0 || memcmp(words,
+                                        code->words,
+                                        sizeof(word_t) * num_words) == 0,
+               "Huffman table encode_to words not equal to BitMap words.");
+
+        free(words);
+        bitmap_free(code);
+        bitmap_free(expected);
+    }
+
+    hash_table_free(hash_table);
+    huffman_table_free(table);
+    huffman_tree_free(tree);
+}
+
+void test_huffman_decode_table()
+{
+    Heap *heap = huffman_heap_new();
+    huffman_heap_insert(heap, 'a', 7);
+    huffman_heap_insert(heap, 'b', 5);
+    huffman_heap_insert(heap, 'c', 3);
+    huffman_heap_insert(heap, 'd', 1);
+
+    // a: 0, b: 11, c: 101, d: 100, the first bit in bit 0.
+    HuffmanTree *tree = huffman_tree_from(heap);
+    HuffmanDecodeTable *table = huffman_decode_table_new(tree);
+
+    ASSERT_INT_EQ(table->root_bits, 3);
+    ASSERT_INT_EQ(table->num_entries, 8);
+    for (int i = 0; i < 8; i += 2) {
+        ASSERT_CHAR_EQ(table->entries[i].value, 'a');
+        ASSERT_INT_EQ(table->entries[i].length, 1);
+    }
+    ASSERT_CHAR_EQ(table->entries[3].value, 'b');
+    ASSERT_CHAR_EQ(table->entries[7].value, 'b');
+    ASSERT_INT_EQ(table->entries[7].length, 2);
+    ASSERT_CHAR_EQ(table->entries[5].value, 'c');
+    ASSERT_INT_EQ(table->entries[5].length, 3);
+    ASSERT_CHAR_EQ(table->entries[1].value, 'd');
+
+    /** "abcd" and a cut code. */
+    BitMap *bitmap = bitmap_from_string("011101100" "10");
+    char output[8];
+    uint64_t position = 0;
+    ASSERT_INT_EQ((int)huffman_decode_to(table,
+                                         bitmap->words,
+                                         bitmap->num_bits,
+                                         &position,
+                                         output,
+                                         3),
+                  3);
+    ASSERT_INT_EQ((int)position, 6);
+    ASSERT_INT_EQ((int)huffman_decode_to(table,
+                                         bitmap->words,
+                                         bitmap->num_bits,
+                                         &position,
+                                         output + 3,
+                                         5),
+                  1);
+    ASSERT_INT_EQ((int)position, 9);
+    ASSERT(memcmp(output, "abcd", 4) == 0, "Huffman decode_to not abcd.");
+
+    bitmap_free(bitmap);
+    huffman_decode_table_free(table);
+    huffman_tree_free(tree);
+}
+
+void test_huffman_decode_long_codes()
+{
+    /** Fibonacci weights: a code of every length up to 30, sub tables. */
+    Heap *heap = huffman_heap_new();
+    unsigned int weight1 = 1;
+    unsigned int weight2 = 1;
+    for (int i = 0; i < 31; ++i) {
+        huffman_heap_insert(heap, (char)(i * 7), weight1);
+        unsigned int weight = weight1 + weight2;
+        weight1 = weight2;
+        weight2 = weight;
+    }
+    HuffmanTree *tree = huffman_tree_from(heap);
+    HuffmanDecodeTable *table = huffman_decode_table_new(tree);
+    ASSERT_INT_EQ(table->root_bits, HUFFMAN_DECODE_ROOT_BITS);
+    ASSERT(table->num_entries > (1U << HUFFMAN_DECODE_ROOT_BITS),
+           "Huffman decode table has no sub table.");
+
+    /** every byte, '\0' too, a few times over. */
+    char string[31 * 5];
+    for (int i = 0; i < 31 * 5; ++i) {
+        string[i] = (char)((i % 31) * 7);
+    }
+    BitMap *code = huffman_encode_string(tree, string, 31 * 5);
+    Text *text = huffman_decode(tree, code);
+    ASSERT_INT_EQ(text_length(text), 31 * 5);
+    ASSERT(memcmp(text_char_string(text), string, 31 * 5) == 0,
+           "Huffman decode of long codes not equal to string.");
+
+    /** a byte at a time. */
+    char output[31 * 5];
+    uint64_t position = 0;
+    for (int i = 0; i < 31 * 5; ++i) {
+        ASSERT_INT_EQ((int)huffman_decode_to(table,
+                                             code->words,
+                                             code->num_bits,
+                                             &position,
+                                             output + i,
+                                             1),
+                      1);
+    }
+    ASSERT(position == code->num_bits, "Huffman decode_to not at the end.");
+    ASSERT(memcmp(output, string, 31 * 5) == 0,
+           "Huffman decode_to of long codes not equal to string.");
+
+    text_free(text);
+    bitmap_free(code);
+    huffman_decode_table_free(table);
+    huffman_tree_free(tree);
+}
+
+static uint64_t test_huffman_cost(const uint64_t weights[256],
+                                  const unsigned char lengths[256])
+{
+    uint64_t cost = 0;
+    for (int i = 0; i < 256; ++i) {
+        cost += weights[i] * lengths[i];
+    }
+    return cost;
+}
+
+void test_huffman_code_lengths()
+{
+    uint64_t weights[256] = {0};
+    unsigned char lengths[256];
+    weights['a'] = 7;
+    weights['b'] = 5;
+    weights['c'] = 3;
+    weights['d'] = 1;
+
+    ASSERT_INT_EQ(huffman_code_lengths(weights, 64, lengths), 0);
+    ASSERT_INT_EQ(lengths['a'], 1);
+    ASSERT_INT_EQ(lengths['b'], 2);
+    ASSERT_INT_EQ(lengths['c'], 3);
+    ASSERT_INT_EQ(lengths['d'], 3);
+    ASSERT_INT_EQ(lengths['e'], 0);
+
+    ASSERT_INT_EQ(huffman_code_lengths(weights, 2, lengths), 0);
+    ASSERT_INT_EQ(lengths['a'], 2);
+    ASSERT_INT_EQ(lengths['d'], 2);
+    ASSERT_INT_EQ(huffman_code_lengths(weights, 1, lengths), -1);
+
+    memset(weights, 0, sizeof(weights));
+    weights['x'] = 3;
+    ASSERT_INT_EQ(huffman_code_lengths(weights, 15, lengths), 0);
+    ASSERT_INT_EQ(lengths['x'], 1);
+
+    /** Fibonacci weights: the Huffman code is 30 bits long at most. */
+    memset(weights, 0, sizeof(weights));
+    uint64_t weight1 = 1;
+    uint64_t weight2 = 1;
+    for (int i = 0; i < 31; ++i) {
+        weights[i * 7] = weight1;
+        uint64_t weight = weight1 + weight2;
+        weight1 = weight2;
+        weight2 = weight;
+    }
+    unsigned char tree_lengths[256];
+    Heap *heap = huffman_heap_new();
+    for (int i = 0; i < 31; ++i) {
+        huffman_heap_insert(heap, (char)(i * 7), (unsigned int)weights[i * 7]);
+    }
+    HuffmanTree *tree = huffman_tree_from(heap);
+    ASSERT_INT_EQ(huffman_tree_to_lengths(tree, tree_lengths), 0);
+    huffman_tree_free(tree);
+
+    ASSERT_INT_EQ(huffman_code_lengths(weights, 64, lengths), 0);
+    ASSERT(test_huffman_cost(weights, lengths) ==
+               test_huffman_cost(weights, tree_lengths),
+           "Huffman code lengths cost not equal to Huffman Tree cost.");
+
+    for (unsigned int max_length = 5; max_length <= 30; ++max_length) {
+        ASSERT_INT_EQ(huffman_code_lengths(weights, max_length, lengths), 0);
+        /** a complete prefix code: the Kraft sum is 1. */
+        uint64_t kraft = 0;
+        for (int i = 0; i < 256; ++i) {
+            ASSERT(lengths[i] <= max_length, "Huffman code length too long.");
+            if (lengths[i] > 0) {
+                kraft += (uint64_t)1 << (30 - lengths[i]);
+            }
+        }
+        ASSERT(kraft == (uint64_t)1 << 30, "Huffman code lengths not complete.");
+        ASSERT(test_huffman_cost(weights, lengths) >=
+                   test_huffman_cost(weights, tree_lengths),
+               "Huffman code lengths cost less than Huffman Tree cost.");
+    }
+}
+
+void test_huffman_canonical()
+{
+    unsigned char lengths[256] = {0};
+    lengths['a'] = 1;
+    lengths['b'] = 2;
+    lengths['c'] = 3;
+    lengths['d'] = 3;
+
+    // canonical: a: 0, b: 10, c: 110, d: 111
+    HuffmanTree *tree = huffman_tree_from_lengths(lengths);
+    ASSERT_CHAR_EQ(tree->root->left->value, 'a');
+    ASSERT_CHAR_EQ(tree->root->right->left->value, 'b');
+    ASSERT_CHAR_EQ(tree->root->right->right->left->value, 'c');
+    ASSERT_CHAR_EQ(tree->root->right->right->right->value, 'd');
+
+    unsigned char tree_lengths[256];
+    ASSERT_INT_EQ(huffman_tree_to_lengths(tree, tree_lengths), 0);
+    ASSERT(memcmp(lengths, tree_lengths, 256) == 0,
+           "Huffman Tree lengths not equal to lengths.");
+
+    /** the first bit in bit 0. */
+    HuffmanTable *table = huffman_table_from_lengths(lengths);
+    ASSERT_INT_EQ((int)table->codes['a'], 0);
+    ASSERT_INT_EQ((int)table->codes['b'], 1);
+    ASSERT_INT_EQ((int)table->codes['c'], 3);
+    ASSERT_INT_EQ((int)table->codes['d'], 7);
+    ASSERT_INT_EQ(table->lengths['d'], 3);
+
+    BitMap *code = huffman_encode_string(tree, "abcabcaaaaabbbcd", 16);
+    char *bits = bitmap_to_string(code);
+    ASSERT_STRING_EQ(bits, "01011001011000000101010110111");
+    free(bits);
+
+    HuffmanDecodeTable *decode_table =
+        huffman_decode_table_from_lengths(lengths);
+    char output[16];
+    uint64_t position = 0;
+    ASSERT_INT_EQ((int)huffman_decode_to(decode_table,
+                                         code->words,
+                                         code->num_bits,
+                                         &position,
+                                         output,
+                                         16),
+                  16);
+    ASSERT(memcmp(output, "abcabcaaaaabbbcd", 16) == 0,
+           "Huffman canonical decode not equal to string.");
+
+    /** over-subscribed. */
+    lengths['e'] = 2;
+    ASSERT(huffman_tree_from_lengths(lengths) == NULL,
+           "Huffman Tree from over-subscribed lengths.");
+    ASSERT(huffman_table_from_lengths(lengths) == NULL,
+           "Huffman table from over-subscribed lengths.");
+
+    huffman_decode_table_free(decode_table);
+    bitmap_free(code);
+    huffman_table_free(table);
+    huffman_tree_free(tree);
+}
+
+void test_huffman_lengths_deflate()
+{
+    unsigned char lengths[256] = {0};
+    unsigned char new_lengths[256];
+    lengths['a'] = 1;
+    lengths['b'] = 2;
+    lengths['c'] = 3;
+    lengths[255] = 64;
+
+    // runs of 97, 1, 1, 1, 155 and 4 lengths.
+    BitMap *bitmap = huffman_lengths_deflate(lengths);
+    ASSERT_INT_EQ(bitmap->num_bits, 2 * 9 + 4 * 7);
+
+    unsigned int index = 0;
+    memset(new_lengths, 0xFF, 256);
+    ASSERT_INT_EQ(huffman_lengths_inflate(bitmap, &index, new_lengths), 0);
+    ASSERT_INT_EQ(index, bitmap->num_bits);
+    ASSERT(memcmp(lengths, new_lengths, 256) == 0,
+           "Huffman lengths inflate not equal to lengths.");
+
+    bitmap->num_bits -= 1;
+    index = 0;
+    ASSERT_INT_EQ(huffman_lengths_inflate(bitmap, &index, new_lengths), -1);
+    bitmap_free(bitmap);
+
+    for (int i = 0; i < 256; ++i) {
+        lengths[i] = 8;
+    }
+    bitmap = huffman_lengths_deflate(lengths);
+    ASSERT_INT_EQ(bitmap->num_bits, 256 * 7);
+    bitmap_free(bitmap);
+
+    memset(lengths, 0, 256);
+    bitmap = huffman_lengths_deflate(lengths);
+    ASSERT_INT_EQ(bitmap->num_bits, 9);
+    index = 0;
+    ASSERT_INT_EQ(huffman_lengths_inflate(bitmap, &index, new_lengths), 0);
+    ASSERT(memcmp(lengths, new_lengths, 256) == 0,
+           "Huffman lengths inflate not all 0.");
+    bitmap_free(bitmap);
+}
+
+void test_huffman_block()
+{
+    const char *string = "abcabcaaaaabbbcd abcabcaaaaabbbcd abcabcaaaaabbbcd";
+    size_t size = strlen(string);
+    unsigned char *block = (unsigned char *)malloc(huffman_block_bound(256));
+    char output[256];
+
+    size_t block_size = huffman_block_encode(string, size, block);
+    ASSERT(block_size < size, "Huffman block not smaller than the string.");
+    size_t raw_size;
+    size_t peek_size;
+    ASSERT_INT_EQ(huffman_block_peek(block, block_size, &raw_size, &peek_size),
+                  0);
+    ASSERT_INT_EQ((int)raw_size, (int)size);
+    ASSERT_INT_EQ((int)peek_size, (int)block_size);
+    ASSERT_INT_EQ(huffman_block_decode(block, block_size, output), 0);
+    ASSERT(memcmp(output, string, size) == 0,
+           "Huffman block decode not equal to string.");
+
+    /** a corrupt byte fails the checksum or the codes. */
+    block[block_size - 2] ^= 0x10;
+    ASSERT_INT_EQ(huffman_block_decode(block, block_size, output), -1);
+    block[block_size - 2] ^= 0x10;
+    block[8] ^= 0x01;
+    ASSERT_INT_EQ(huffman_block_decode(block, block_size, output), -1);
+
+    /** every byte once, the codes do not save: stored. */
+    char bytes[256];
+    for (int i = 0; i < 256; ++i) {
+        bytes[i] = (char)i;
+    }
+    block_size = huffman_block_encode(bytes, 256, block);
+    ASSERT_INT_EQ((int)block_size, (int)huffman_block_bound(256));
+    ASSERT_INT_EQ(huffman_block_decode(block, block_size, output), 0);
+    ASSERT(memcmp(output, bytes, 256) == 0,
+           "Huffman stored block decode not equal to bytes.");
+
+    free(block);
+}
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+} TestHuffmanSink;
+
+static int test_huffman_sink_write(const void *data, size_t size, void *args)
+{
+    TestHuffmanSink *sink = (TestHuffmanSink *)args;
+    sink->data = (unsigned char *)realloc(sink->data, sink->size + size);
+    memcpy(sink->data + sink->size, data, size);
+    sink->size += size;
+    return 0;
+}
+
+void test_huffman_stream()
+{
+    /** text, then random bytes which are stored. */
+    size_t size = 100000;
+    char *data = (char *)malloc(size);
+    const char *words = "the quick brown fox jumps over the lazy dog. ";
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = i < 70000 ? words[i % strlen(words)] : (char)rand();
+    }
+
+    TestHuffmanSink compressed = {NULL, 0};
+    HuffmanEncoder *encoder =
+        huffman_encoder_new(4096, test_huffman_sink_write, &compressed);
+    size_t chunks[] = {1, 7, 5000, 4096, 3, 12000, 33};
+    size_t n = 0;
+    for (int i = 0; n < size; ++i) {
+        size_t count = chunks[i % 7];
+        if (count > size - n) {
+            count = size - n;
+        }
+        ASSERT_INT_EQ(huffman_encoder_write(encoder, data + n, count), 0);
+        n += count;
+    }
+    ASSERT_INT_EQ(huffman_encoder_finish(encoder), 0);
+    huffman_encoder_free(encoder);
+    ASSERT(compressed.size < size, "Huffman stream not smaller than data.");
+
+    /** byte by byte, then in chunks. */
+    TestHuffmanSink raw = {NULL, 0};
+    HuffmanDecoder *decoder =
+        huffman_decoder_new(test_huffman_sink_write, &raw);
+    for (n = 0; n < 5000; ++n) {
+        ASSERT_INT_EQ(huffman_decoder_write(decoder, compressed.data + n, 1),
+                      0);
+    }
+    while (n < compressed.size) {
+        size_t count = compressed.size - n < 777 ? compressed.size - n : 777;
+        ASSERT_INT_EQ(
+            huffman_decoder_write(decoder, compressed.data + n, count), 0);
+        n += count;
+    }
+    ASSERT_INT_EQ(huffman_decoder_finish(decoder), 0);
+    ASSERT_INT_EQ((int)raw.size, (int)size);
+    ASSERT(memcmp(raw.data, data, size) == 0,
+           "Huffman stream decode not equal to data.");
+
+    /** bytes after the end. */
+    ASSERT_INT_EQ(huffman_decoder_write(decoder, compressed.data, 1), -1);
+    huffman_decoder_free(decoder);
+
+    /** truncated: all blocks but the end. */
+    raw.size = 0;
+    decoder = huffman_decoder_new(test_huffman_sink_write, &raw);
+    ASSERT_INT_EQ(huffman_decoder_write(
+                      decoder, compressed.data, compressed.size - 1),
+                  0);
+    ASSERT_INT_EQ(huffman_decoder_finish(decoder), -1);
+    ASSERT_INT_EQ((int)raw.size, (int)size);
+    huffman_decoder_free(decoder);
+
+    /** corrupt. */
+    raw.size = 0;
+    compressed.data[100] ^= 0x01;
+    decoder = huffman_decoder_new(test_huffman_sink_write, &raw);
+    ASSERT_INT_EQ(
+        huffman_decoder_write(decoder, compressed.data, compressed.size), -1);
+    huffman_decoder_free(decoder);
+
+    /** an empty stream. */
+    compressed.size = 0;
+    encoder = huffman_encoder_new(0, test_huffman_sink_write, &compressed);
+    ASSERT_INT_EQ(huffman_encoder_finish(encoder), 0);
+    huffman_encoder_free(encoder);
+    ASSERT_INT_EQ((int)compressed.size,
+                  HUFFMAN_STREAM_HEADER_SIZE + HUFFMAN_BLOCK_HEADER_SIZE + 8);
+    raw.size = 0;
+    decoder = huffman_decoder_new(test_huffman_sink_write, &raw);
+    ASSERT_INT_EQ(
+        huffman_decoder_write(decoder, compressed.data, compressed.size), 0);
+    ASSERT_INT_EQ(huffman_decoder_finish(decoder), 0);
+    ASSERT_INT_EQ((int)raw.size, 0);
+    huffman_decoder_free(decoder);
+
+    free(raw.data);
+    free(compressed.data);
+    free(data);
+}
+
+void test_huffman_stream_threads()
+{
+    size_t size = 150000;
+    char *data = (char *)malloc(size);
+    const char *words = "pack my box with five dozen liquor jugs. ";
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = i % 50000 < 40000 ? words[i % strlen(words)] : (char)rand();
+    }
+
+    TestHuffmanSink expected = {NULL, 0};
+    HuffmanEncoder *encoder =
+        huffman_encoder_new(4096, test_huffman_sink_write, &expected);
+    ASSERT_INT_EQ(huffman_encoder_write(encoder, data, size), 0);
+    ASSERT_INT_EQ(huffman_encoder_finish(encoder), 0);
+    huffman_encoder_free(encoder);
+
+    /** the same stream from threads, whatever the chunks. */
+    TestHuffmanSink compressed = {NULL, 0};
+    encoder = huffman_encoder_new_threads(
+        4096, 3, test_huffman_sink_write, &compressed);
+    size_t chunks[] = {1, 30000, 4095, 7, 24576, 2};
+    size_t n = 0;
+    for (int i = 0; n < size; ++i) {
+        size_t count = chunks[i % 6];
+        if (count > size - n) {
+            count = size - n;
+        }
+        ASSERT_INT_EQ(huffman_encoder_write(encoder, data + n, count), 0);
+        n += count;
+    }
+    ASSERT_INT_EQ(huffman_encoder_finish(encoder), 0);
+    huffman_encoder_free(encoder);
+    ASSERT_INT_EQ((int)compressed.size, (int)expected.size);
+    ASSERT(memcmp(compressed.data, expected.data, expected.size) == 0,
+           "Huffman stream from threads not equal to stream.");
+    ASSERT(huffman_encoder_new_threads(0,
+                                       HUFFMAN_MAX_THREADS + 1,
+                                       test_huffman_sink_write,
+                                       &compressed) == NULL,
+           "Huffman encoder of too many threads.");
+
+    /** the index: one entry a block, then their number and magic. */
+    size_t num_blocks = (size + 4095) / 4096;
+    const unsigned char *trailer = compressed.data + compressed.size - 8;
+    ASSERT_INT_EQ((trailer[0] | (trailer[1] << 8)), (int)num_blocks);
+    ASSERT(memcmp(trailer + 4, "RHFI", 4) == 0, "Huffman index magic.");
+
+    /** decode on threads, byte by byte then at once. */
+    TestHuffmanSink raw = {NULL, 0};
+    HuffmanDecoder *decoder =
+        huffman_decoder_new_threads(4, test_huffman_sink_write, &raw);
+    for (n = 0; n < 9000; ++n) {
+        ASSERT_INT_EQ(huffman_decoder_write(decoder, compressed.data + n, 1),
+                      0);
+    }
+    ASSERT_INT_EQ(huffman_decoder_write(
+                      decoder, compressed.data + n, compressed.size - n),
+                  0);
+    ASSERT_INT_EQ(huffman_decoder_finish(decoder), 0);
+    huffman_decoder_free(decoder);
+    ASSERT_INT_EQ((int)raw.size, (int)size);
+    ASSERT(memcmp(raw.data, data, size) == 0,
+           "Huffman stream decode on threads not equal to data.");
+
+    /** in memory, from the index. */
+    uint64_t raw_size = 0;
+    ASSERT_INT_EQ(
+        huffman_stream_raw_size(compressed.data, compressed.size, &raw_size),
+        0);
+    ASSERT(raw_size == size, "Huffman stream raw size.");
+    char *output = (char *)malloc(size);
+    for (unsigned int threads = 1; threads <= 4; ++threads) {
+        memset(output, 0, size);
+        ASSERT_INT_EQ(huffman_stream_decode(
+                          compressed.data, compressed.size, output, size,
+                          threads),
+                      0);
+        ASSERT(memcmp(output, data, size) == 0,
+               "Huffman stream decode in memory not equal to data.");
+    }
+    ASSERT_INT_EQ(huffman_stream_decode(
+                      compressed.data, compressed.size, output, size - 1, 2),
+                  -1);
+
+    /** without the index, as an empty end block. */
+    size_t index_size = num_blocks * 8 + 8;
+    size_t end = compressed.size - index_size - HUFFMAN_BLOCK_HEADER_SIZE;
+    memset(compressed.data + end, 0, HUFFMAN_BLOCK_HEADER_SIZE);
+    compressed.size = end + HUFFMAN_BLOCK_HEADER_SIZE;
+    memset(output, 0, size);
+    ASSERT_INT_EQ(huffman_stream_decode(
+                      compressed.data, compressed.size, output, size, 2),
+                  0);
+    ASSERT(memcmp(output, data, size) == 0,
+           "Huffman stream decode without index not equal to data.");
+    raw.size = 0;
+    decoder = huffman_decoder_new_threads(2, test_huffman_sink_write, &raw);
+    ASSERT_INT_EQ(
+        huffman_decoder_write(decoder, compressed.data, compressed.size), 0);
+    ASSERT_INT_EQ(huffman_decoder_finish(decoder), 0);
+    huffman_decoder_free(decoder);
+    ASSERT_INT_EQ((int)raw.size, (int)size);
+
+    /** a corrupt block. */
+    compressed.data[5000] ^= 0x10;
+    ASSERT_INT_EQ(huffman_stream_decode(
+                      compressed.data, compressed.size, output, size, 3),
+                  -1);
+    decoder = huffman_decoder_new_threads(3, test_huffman_sink_write, &raw);
+    ASSERT_INT_EQ(
+        huffman_decoder_write(decoder, compressed.data, compressed.size), -1);
+    huffman_decoder_free(decoder);
+
+    free(output);
+    free(raw.data);
+    free(compressed.data);
+    free(expected.data);
+    free(data);
+}
+
+void test_huffman_stream_lz77()
+{
+    size_t size = 300000;
+    char *data = (char *)malloc(size);
+    const char *words = "GET /index.html 200 GET /favicon.ico 404 ";
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = i % 100000 < 90000 ? words[i % strlen(words)] : (char)rand();
+    }
+
+    TestHuffmanSink huffman = {NULL, 0};
+    HuffmanEncoder *encoder =
+        huffman_encoder_new_level(65536, 0, 1, test_huffman_sink_write, &huffman);
+    ASSERT_INT_EQ(huffman_encoder_write(encoder, data, size), 0);
+    ASSERT_INT_EQ(huffman_encoder_finish(encoder), 0);
+    huffman_encoder_free(encoder);
+    ASSERT(memcmp(huffman.data, "RHF1", 4) == 0, "Huffman stream magic.");
+
+    /** the same stream on threads, far smaller than Huffman alone. */
+    TestHuffmanSink expected = {NULL, 0};
+    encoder = huffman_encoder_new_level(
+        65536, LZ77_DEFAULT_LEVEL, 1, test_huffman_sink_write, &expected);
+    ASSERT_INT_EQ(huffman_encoder_write(encoder, data, size), 0);
+    ASSERT_INT_EQ(huffman_encoder_finish(encoder), 0);
+    huffman_encoder_free(encoder);
+    ASSERT(memcmp(expected.data, "RHF2", 4) == 0, "LZ77 stream magic.");
+    ASSERT(expected.size * 4 < huffman.size,
+           "LZ77 stream not a quarter of the Huffman stream.");
+
+    TestHuffmanSink compressed = {NULL, 0};
+    encoder = huffman_encoder_new_level(
+        65536, LZ77_DEFAULT_LEVEL, 3, test_huffman_sink_write, &compressed);
+    ASSERT_INT_EQ(huffman_encoder_write(encoder, data, 1000), 0);
+    ASSERT_INT_EQ(huffman_encoder_write(encoder, data + 1000, size - 1000), 0);
+    ASSERT_INT_EQ(huffman_encoder_finish(encoder), 0);
+    huffman_encoder_free(encoder);
+    ASSERT_INT_EQ((int)compressed.size, (int)expected.size);
+    ASSERT(memcmp(compressed.data, expected.data, expected.size) == 0,
+           "LZ77 stream from threads not equal to stream.");
+
+    Lz77Params params;
+    lz77_params_from_level(1, &params);
+    params.max_chain = 0;
+    ASSERT(huffman_encoder_new_lz77(
+               0, &params, 1, test_huffman_sink_write, &compressed) == NULL,
+           "LZ77 encoder of bad params.");
+
+    /** the decoder tells the blocks by the magic. */
+    TestHuffmanSink raw = {NULL, 0};
+    HuffmanDecoder *decoder =
+        huffman_decoder_new_threads(2, test_huffman_sink_write, &raw);
+    ASSERT_INT_EQ(
+        huffman_decoder_write(decoder, compressed.data, compressed.size), 0);
+    ASSERT_INT_EQ(huffman_decoder_finish(decoder), 0);
+    huffman_decoder_free(decoder);
+    ASSERT_INT_EQ((int)raw.size, (int)size);
+    ASSERT(memcmp(raw.data, data, size) == 0,
+           "LZ77 stream decode not equal to data.");
+
+    char *output = (char *)malloc(size);
+    ASSERT_INT_EQ(huffman_stream_decode(
+                      compressed.data, compressed.size, output, size, 2),
+                  0);
+    ASSERT(memcmp(output, data, size) == 0,
+           "LZ77 stream decode in memory not equal to data.");
+
+    free(output);
+    free(raw.data);
+    free(compressed.data);
+    free(expected.data);
+    free(huffman.data);
+    free(data);
+}
 
 void test_test_huffman_tree_to_hash_table_bitmap(HashTable *hash_table,
                                                  char ch,
@@ -356,7 +1108,19 @@ void test_huffman()
     test_huffman_encode();
     test_huffman_encode();
     test_huffman_decode();
+    test_huffman_decode_out_of_memory();
     test_huffman_decode_same_weight();
+    test_huffman_table();
+    test_huffman_table_encode_to();
+    test_huffman_decode_table();
+    test_huffman_decode_long_codes();
+    test_huffman_code_lengths();
+    test_huffman_canonical();
+    test_huffman_lengths_deflate();
+    test_huffman_block();
+    test_huffman_stream();
+    test_huffman_stream_threads();
+    test_huffman_stream_lz77();
 
     test_huffman_tree_deflate();
     test_huffman_tree_inflate();
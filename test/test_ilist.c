@@ -0,0 +1,152 @@
+#include "ilist.h"
+#include "iqueue.h"
+#include <assert.h>
+#include <stdio.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+typedef struct _Item {
+    int value;
+    IListNode link;
+} Item;
+
+static int item_compare(const IListNode *node1, const IListNode *node2)
+{
+    return ilist_entry(node1, Item, link)->value -
+           ilist_entry(node2, Item, link)->value;
+}
+
+static int item_match(const IListNode *node, const void *data)
+{
+    return ilist_entry(node, Item, link)->value == *(const int *)data;
+}
+
+static void check_ilist_integrity(IList *list)
+{
+    unsigned int length = 0;
+    IListNode *prev = NULL;
+    for (IListNode *node = ilist_first(list); node != NULL;
+         node = ilist_next(list, node)) {
+        assert(ilist_prev(list, node) == prev);
+        prev = node;
+        ++length;
+    }
+    assert(ilist_last(list) == prev);
+    ASSERT_INT_EQ(length, list->length);
+}
+
+void test_ilist()
+{
+    Item items[10];
+    IList list;
+    ilist_init(&list);
+    assert(ilist_is_empty(&list));
+    assert(ilist_first(&list) == NULL);
+    assert(ilist_last(&list) == NULL);
+
+    for (int i = 0; i < 10; ++i) {
+        items[i].value = i;
+    }
+    for (int i = 4; i >= 0; --i) {
+        ilist_prepend(&list, &(items[i].link));
+    }
+    for (int i = 6; i < 10; ++i) {
+        ilist_append(&list, &(items[i].link));
+    }
+    ilist_insert_after(&list, &(items[4].link), &(items[5].link));
+    check_ilist_integrity(&list);
+    ASSERT_INT_EQ(list.length, 10);
+
+    for (int i = 0; i < 10; ++i) {
+        IListNode *node = ilist_nth_node(&list, i);
+        assert(ilist_entry(node, Item, link) == &items[i]);
+    }
+    assert(ilist_nth_node(&list, 10) == NULL);
+
+    int value = 7;
+    assert(ilist_find_data(&list, item_match, &value) == &(items[7].link));
+    assert(ilist_find_node(&list, &(items[3].link)) == &(items[3].link));
+
+    assert(ilist_remove_data(&list, item_match, &value) == &(items[7].link));
+    assert(ilist_find_data(&list, item_match, &value) == NULL);
+    assert(ilist_remove_data(&list, item_match, &value) == NULL);
+    assert(ilist_remove_node(&list, &(items[0].link)) == &(items[0].link));
+    assert(ilist_remove_node(&list, &(items[9].link)) == &(items[9].link));
+    assert(ilist_find_node(&list, &(items[9].link)) == NULL);
+    check_ilist_integrity(&list);
+    ASSERT_INT_EQ(list.length, 7);
+    assert(ilist_entry(ilist_first(&list), Item, link) == &items[1]);
+    assert(ilist_entry(ilist_last(&list), Item, link) == &items[8]);
+
+    while (!ilist_is_empty(&list)) {
+        ilist_remove_node(&list, ilist_first(&list));
+    }
+    check_ilist_integrity(&list);
+}
+
+void test_ilist_sort()
+{
+    int values[] = {5, 3, 9, 1, 3, 0, 7, 2, 8, 3, 6, 4};
+    int num = sizeof(values) / sizeof(int);
+    Item items[sizeof(values) / sizeof(int)];
+    IList list;
+    ilist_init(&list);
+    assert(ilist_sort(&list, item_compare) == 0);
+
+    for (int i = 0; i < num; ++i) {
+        items[i].value = values[i];
+        ilist_append(&list, &(items[i].link));
+    }
+    assert(ilist_sort(&list, item_compare) == 0);
+    check_ilist_integrity(&list);
+
+    Item *prev = NULL;
+    for (IListNode *node = ilist_first(&list); node != NULL;
+         node = ilist_next(&list, node)) {
+        Item *item = ilist_entry(node, Item, link);
+        if (prev != NULL) {
+            assert(prev->value <= item->value);
+            /** stable: equal values keep their original order. */
+            if (prev->value == item->value) {
+                assert(prev < item);
+            }
+        }
+        prev = item;
+    }
+}
+
+void test_iqueue()
+{
+    Item items[10];
+    IQueue queue;
+    iqueue_init(&queue);
+    assert(iqueue_is_empty(&queue));
+    assert(iqueue_pop_head(&queue) == NULL);
+    assert(iqueue_pop_tail(&queue) == NULL);
+
+    for (int i = 0; i < 10; ++i) {
+        items[i].value = i;
+        iqueue_push_tail(&queue, &(items[i].link));
+    }
+    ASSERT_INT_EQ(iqueue_length(&queue), 10);
+    assert(iqueue_entry(iqueue_peek_head(&queue), Item, link) == &items[0]);
+    assert(iqueue_entry(iqueue_peek_tail(&queue), Item, link) == &items[9]);
+
+    for (int i = 0; i < 5; ++i) {
+        Item *item = iqueue_entry(iqueue_pop_head(&queue), Item, link);
+        ASSERT_INT_EQ(item->value, i);
+    }
+    for (int i = 9; i >= 5; --i) {
+        Item *item = iqueue_entry(iqueue_pop_tail(&queue), Item, link);
+        ASSERT_INT_EQ(item->value, i);
+    }
+    assert(iqueue_is_empty(&queue));
+
+    /** popped nodes can be queued again. */
+    iqueue_push_head(&queue, &(items[1].link));
+    iqueue_push_head(&queue, &(items[2].link));
+    assert(iqueue_pop_tail(&queue) == &(items[1].link));
+    assert(iqueue_pop_tail(&queue) == &(items[2].link));
+    assert(iqueue_is_empty(&queue));
+}
@@ -59,6 +59,15 @@ void test_kmp_calculate_next()
     assert(next[10] == 0);
     assert(next[11] == 1);
     free(next);
+
+    /** a mismatch after a prefix of 1 used to loop forever. */
+    next = kmp_calculate_next("CCTGGGGT", 8);
+    assert(next[0] == 0);
+    assert(next[1] == 1);
+    for (int i = 2; i < 8; ++i) {
+        assert(next[i] == 0);
+    }
+    free(next);
 }
 
 void test_kmp_string_match()
@@ -68,6 +77,8 @@ void test_kmp_string_match()
     assert(kmp_string_match("abcabcd", "abcd") == 3);
     assert(kmp_string_match("bcabaaaa", "aaaa") == 4);
     assert(kmp_string_match("bbcabcdababcdabcdabde", "abcdabd") == 13);
+    assert(kmp_text_match("CCCTGGGACCTGGGGTA", 17, "CCTGGGGT", 8) == 8);
+    assert(kmp_string_match("ACCTGGGGA", "CCTGGGGT") < 0);
 }
 
 void test_kmp()
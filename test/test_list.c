@@ -124,3 +124,37 @@ void test_list_sort()
 
     list_free(list);
 }
+
+void test_list_slab()
+{
+    int entries[100];
+    List *list = list_new_with_slab(16);
+    for (int i = 0; i < 100; ++i) {
+        entries[i] = i;
+        assert(list_append(list, &entries[i]) == 0);
+    }
+    check_list_integrity(list);
+    ASSERT_INT_EQ(slab_num_pages(list->slab), 7);
+
+    for (int i = 0; i < 100; i += 2) {
+        assert(list_remove_data(list, int_equal, &entries[i]) == 0);
+    }
+    ListNode *node = list_remove_node(list, list->head);
+    assert(node->data == &entries[1]);
+    list_free_node(list, node);
+    assert(list->length == 49);
+    ASSERT_INT_EQ(slab_size(list->slab), 49);
+
+    /** removed nodes are reused. */
+    for (int i = 0; i < 51; ++i) {
+        assert(list_prepend(list, &entries[i]) == 0);
+    }
+    check_list_integrity(list);
+    ASSERT_INT_EQ(slab_num_pages(list->slab), 7);
+
+    list_sort(list, int_compare);
+    check_list_integrity(list);
+    assert(list->tail != NULL && list->tail->next == NULL);
+    ASSERT_INT_POINTER_EQ(list->tail->data, 99);
+    list_free(list);
+}
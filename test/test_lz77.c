@@ -0,0 +1,172 @@
+#include "huffman.h"
+#include "lz77.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_helper.h"
+
+/** encode by params, check the block decodes back, return its size. */
+static size_t test_lz77_round_trip(const char *data,
+                                   size_t size,
+                                   const Lz77Params *params)
+{
+    unsigned char *block = (unsigned char *)malloc(huffman_block_bound(size));
+    char *output = (char *)malloc(size);
+    size_t block_size = lz77_block_encode(data, size, params, block);
+    ASSERT(block_size > 0 && block_size <= huffman_block_bound(size),
+           "LZ77 block size out of bound.");
+
+    size_t raw_size = 0;
+    size_t peek_size = 0;
+    ASSERT_INT_EQ(huffman_block_peek(block, block_size, &raw_size, &peek_size),
+                  0);
+    ASSERT_INT_EQ((int)raw_size, (int)size);
+    ASSERT_INT_EQ((int)peek_size, (int)block_size);
+    ASSERT_INT_EQ(lz77_block_decode(block, block_size, output), 0);
+    ASSERT(memcmp(output, data, size) == 0,
+           "LZ77 block decode not equal to data.");
+
+    free(output);
+    free(block);
+    return block_size;
+}
+
+/** lines of a log: repeated fields, changing numbers. */
+static void test_lz77_fill_log(char *data, size_t size)
+{
+    static const char *levels[] = {"INFO", "WARN", "DEBUG", "ERROR"};
+    static const char *messages[] = {"connection accepted from",
+                                     "request served in",
+                                     "cache miss for key",
+                                     "retrying upstream"};
+    size_t n = 0;
+    for (unsigned int line = 0; n < size; ++line) {
+        char buffer[128];
+        int length = sprintf(buffer,
+                             "2019-08-30 12:%02u:%02u [%s] %s %u\n",
+                             line / 60 % 60,
+                             line % 60,
+                             levels[line * 7 % 4],
+                             messages[line * 3 % 4],
+                             (unsigned int)rand() % 1000);
+        for (int i = 0; i < length && n < size; ++i) {
+            data[n++] = buffer[i];
+        }
+    }
+}
+
+void test_lz77_levels()
+{
+    size_t size = 200000;
+    char *data = (char *)malloc(size);
+    test_lz77_fill_log(data, size);
+
+    /** Huffman coding alone, for the ratio. */
+    unsigned char *block = (unsigned char *)malloc(huffman_block_bound(size));
+    size_t huffman_size = huffman_block_encode(data, size, block);
+    free(block);
+
+    size_t sizes[LZ77_MAX_LEVEL + 1];
+    for (int level = LZ77_MIN_LEVEL; level <= LZ77_MAX_LEVEL; ++level) {
+        Lz77Params params;
+        lz77_params_from_level(level, &params);
+        sizes[level] = test_lz77_round_trip(data, size, &params);
+        ASSERT(sizes[level] * 2 < huffman_size,
+               "LZ77 block not half of the Huffman block.");
+    }
+    ASSERT(sizes[LZ77_MAX_LEVEL] <= sizes[LZ77_MIN_LEVEL],
+           "LZ77 level 9 larger than level 1.");
+
+    /** out of range levels are clamped. */
+    Lz77Params params;
+    Lz77Params expected;
+    lz77_params_from_level(0, &params);
+    lz77_params_from_level(LZ77_MIN_LEVEL, &expected);
+    ASSERT(memcmp(&params, &expected, sizeof(Lz77Params)) == 0,
+           "LZ77 level 0 not clamped.");
+    lz77_params_from_level(100, &params);
+    lz77_params_from_level(LZ77_MAX_LEVEL, &expected);
+    ASSERT(memcmp(&params, &expected, sizeof(Lz77Params)) == 0,
+           "LZ77 level 100 not clamped.");
+
+    free(data);
+}
+
+void test_lz77_block()
+{
+    Lz77Params params;
+    lz77_params_from_level(LZ77_DEFAULT_LEVEL, &params);
+
+    /** short blocks, stored. */
+    test_lz77_round_trip("a", 1, &params);
+    test_lz77_round_trip("ab", 2, &params);
+    test_lz77_round_trip("abc", 3, &params);
+    test_lz77_round_trip("abcabc", 6, &params);
+
+    /** a run: matches overlapping what they copy. */
+    size_t size = 100000;
+    char *data = (char *)malloc(size);
+    memset(data, 'x', size);
+    ASSERT(test_lz77_round_trip(data, size, &params) < 2000,
+           "LZ77 run not compressed.");
+
+    /** a period longer than the window is not found. */
+    for (size_t i = 0; i < 5000; ++i) {
+        data[i] = (char)rand();
+    }
+    for (size_t i = 5000; i < size; ++i) {
+        data[i] = data[i - 5000];
+    }
+    size_t window_size = test_lz77_round_trip(data, size, &params);
+    ASSERT(window_size < 20000, "LZ77 period not compressed.");
+    Lz77Params small = params;
+    small.window_bits = 12;
+    ASSERT(test_lz77_round_trip(data, size, &small) > 4 * window_size,
+           "LZ77 period found out of the window.");
+
+    /** random bytes, stored. */
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (char)rand();
+    }
+    ASSERT_INT_EQ((int)test_lz77_round_trip(data, size, &params),
+                  (int)huffman_block_bound(size));
+
+    /** skewed bytes, few matches: no worse than Huffman coding alone. */
+    unsigned char *block = (unsigned char *)malloc(huffman_block_bound(size));
+    for (size_t i = 0; i < size; ++i) {
+        unsigned int r = (unsigned int)rand();
+        data[i] = (char)((r >> 8) & (0xFFu >> (r % 8)));
+    }
+    size_t huffman_size = huffman_block_encode(data, size, block);
+    ASSERT(test_lz77_round_trip(data, size, &params) <= huffman_size + 56,
+           "LZ77 block larger than the Huffman block.");
+
+    /** bad parameters. */
+    small.window_bits = LZ77_MAX_WINDOW_BITS + 1;
+    ASSERT_INT_EQ((int)lz77_block_encode(data, size, &small, block), 0);
+
+    /** corrupt: a code, and the checksum. */
+    test_lz77_fill_log(data, size);
+    size_t block_size = lz77_block_encode(data, size, &params, block);
+    char *output = (char *)malloc(size);
+    block[block_size / 2] ^= 0x20;
+    ASSERT_INT_EQ(lz77_block_decode(block, block_size, output), -1);
+    block[block_size / 2] ^= 0x20;
+    block[8] ^= 0x01;
+    ASSERT_INT_EQ(lz77_block_decode(block, block_size, output), -1);
+    block[8] ^= 0x01;
+    ASSERT_INT_EQ(lz77_block_decode(block, block_size - 1, output), -1);
+    ASSERT_INT_EQ(lz77_block_decode(block, block_size, output), 0);
+
+    free(output);
+    free(block);
+    free(data);
+}
+
+void test_lz77()
+{
+    test_lz77_levels();
+    test_lz77_block();
+}
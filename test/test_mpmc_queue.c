@@ -0,0 +1,181 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mpmc_queue.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+#define NUM_PRODUCERS 3
+#define NUM_CONSUMERS 3
+#define VALUES_PER_PRODUCER 10000
+
+void test_mpmc_queue_basic()
+{
+    int values[10];
+    QueueValue data[10];
+    QueueValue value;
+
+    MpmcQueue *queue = mpmc_queue_new(0);
+    ASSERT_INT_EQ(mpmc_queue_capacity(queue), 2);
+    mpmc_queue_free(queue);
+
+    queue = mpmc_queue_new(6);
+    ASSERT_INT_EQ(mpmc_queue_capacity(queue), 8);
+    assert(mpmc_queue_pop(queue, &value) == -1);
+
+    for (int i = 0; i < 8; ++i) {
+        assert(mpmc_queue_push(queue, &values[i]) == 0);
+    }
+    assert(mpmc_queue_push(queue, &values[8]) == -1);
+    ASSERT_INT_EQ(mpmc_queue_length(queue), 8);
+    for (int i = 0; i < 5; ++i) {
+        assert(mpmc_queue_pop(queue, &value) == 0);
+        assert(value == &values[i]);
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        data[i] = &values[i];
+    }
+    ASSERT_INT_EQ(mpmc_queue_push_many(queue, data, 10), 5);
+    ASSERT_INT_EQ(mpmc_queue_push_many(queue, data, 10), 0);
+    assert(mpmc_queue_push(queue, &values[9]) == -1);
+    ASSERT_INT_EQ(mpmc_queue_pop_many(queue, data, 2), 2);
+    assert(data[0] == &values[5] && data[1] == &values[6]);
+    assert(mpmc_queue_pop(queue, &value) == 0);
+    assert(value == &values[7]);
+    ASSERT_INT_EQ(mpmc_queue_pop_many(queue, data, 10), 5);
+    for (int i = 0; i < 5; ++i) {
+        assert(data[i] == &values[i]);
+    }
+    ASSERT_INT_EQ(mpmc_queue_length(queue), 0);
+    ASSERT_INT_EQ(mpmc_queue_pop_many(queue, data, 10), 0);
+
+    mpmc_queue_free(queue);
+}
+
+/** the number of values popped by all consumers. */
+static atomic_int mpmc_num_popped;
+
+typedef struct {
+    MpmcQueue *queue;
+    int id;
+    int *values;
+    /** how many times each value is popped, by consumers. */
+    int *popped;
+} MpmcWorker;
+
+static void *mpmc_produce(void *arg)
+{
+    MpmcWorker *worker = (MpmcWorker *)arg;
+    int *values = worker->values + worker->id * VALUES_PER_PRODUCER;
+    QueueValue batch[4];
+    int i = 0;
+    while (i < VALUES_PER_PRODUCER) {
+        unsigned int pushed;
+        if (i % 2 == 0) {
+            int count = 0;
+            while (count < 4 && i + count < VALUES_PER_PRODUCER) {
+                batch[count] = &values[i + count];
+                ++count;
+            }
+            pushed = mpmc_queue_push_many(worker->queue, batch, count);
+        } else {
+            pushed = mpmc_queue_push(worker->queue, &values[i]) == 0;
+        }
+        if (pushed == 0) {
+            sched_yield();
+        }
+        i += pushed;
+    }
+    return NULL;
+}
+
+static void *mpmc_consume(void *arg)
+{
+    MpmcWorker *worker = (MpmcWorker *)arg;
+    int total = NUM_PRODUCERS * VALUES_PER_PRODUCER;
+    /** the last value seen from each producer, FIFO per producer. */
+    int last[NUM_PRODUCERS];
+    QueueValue batch[3];
+    for (int p = 0; p < NUM_PRODUCERS; ++p) {
+        last[p] = -1;
+    }
+
+    for (int round = 0;; ++round) {
+        unsigned int count =
+            round % 2 == 0 ? mpmc_queue_pop_many(worker->queue, batch, 3)
+                           : (unsigned int)(mpmc_queue_pop(worker->queue,
+                                                           batch) == 0);
+        if (count == 0) {
+            if (atomic_load(&mpmc_num_popped) == total) {
+                break; // all values popped
+            }
+            sched_yield();
+        }
+        for (unsigned int k = 0; k < count; ++k) {
+            int value = *(int *)batch[k];
+            int producer = value / VALUES_PER_PRODUCER;
+            assert(value > last[producer]);
+            last[producer] = value;
+            ++(worker->popped[worker->id * total + value]);
+            atomic_fetch_add(&mpmc_num_popped, 1);
+        }
+    }
+    return NULL;
+}
+
+void test_mpmc_queue_threads()
+{
+    int total = NUM_PRODUCERS * VALUES_PER_PRODUCER;
+    MpmcQueue *queue = mpmc_queue_new(32);
+    int *values = (int *)malloc(sizeof(int) * total);
+    int *popped = (int *)malloc(sizeof(int) * total * NUM_CONSUMERS);
+    for (int i = 0; i < total; ++i) {
+        values[i] = i;
+    }
+    atomic_store(&mpmc_num_popped, 0);
+    memset(popped, 0, sizeof(int) * total * NUM_CONSUMERS);
+
+    pthread_t threads[NUM_PRODUCERS + NUM_CONSUMERS];
+    MpmcWorker workers[NUM_PRODUCERS + NUM_CONSUMERS];
+    for (int t = 0; t < NUM_PRODUCERS + NUM_CONSUMERS; ++t) {
+        workers[t].queue = queue;
+        workers[t].id = t < NUM_PRODUCERS ? t : t - NUM_PRODUCERS;
+        workers[t].values = values;
+        workers[t].popped = popped;
+        pthread_create(&threads[t],
+                       NULL,
+                       t < NUM_PRODUCERS ? mpmc_produce : mpmc_consume,
+                       &workers[t]);
+    }
+    for (int t = 0; t < NUM_PRODUCERS + NUM_CONSUMERS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    /** every value is popped exactly once. */
+    for (int i = 0; i < total; ++i) {
+        int times = 0;
+        for (int c = 0; c < NUM_CONSUMERS; ++c) {
+            times += popped[c * total + i];
+        }
+        ASSERT_INT_EQ(times, 1);
+    }
+    ASSERT_INT_EQ(mpmc_queue_length(queue), 0);
+
+    free(popped);
+    free(values);
+    mpmc_queue_free(queue);
+}
+
+void test_mpmc_queue()
+{
+    test_mpmc_queue_basic();
+    test_mpmc_queue_threads();
+}
@@ -1,6 +1,7 @@
 #include "prime.h"
 #include <assert.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "alloc-testing.h"
@@ -48,9 +49,212 @@ void test_prime_3()
     prime_number_sieve_free(sieve);
 }
 
+typedef struct {
+    uint64_t *primes;
+    unsigned int count;
+    unsigned int max_count;
+} PrimeList;
+
+static int collect_prime(uint64_t prime, void *args)
+{
+    PrimeList *list = (PrimeList *)args;
+    /** ascending order, never concurrently. */
+    assert(list->count == 0 || list->primes[list->count - 1] < prime);
+    list->primes[list->count++] = prime;
+    return list->count == list->max_count;
+}
+
+static void
+check_segmented_range(const BitMap *sieve, uint64_t lo, uint64_t hi)
+{
+    unsigned int expected = 0;
+    for (uint64_t n = lo; n < hi; ++n) {
+        expected += prime_number_sieve_check(sieve, (unsigned int)n);
+    }
+    for (unsigned int threads = 1; threads <= 4; threads += 3) {
+        assert(prime_segmented_count(lo, hi, threads) == expected);
+
+        PrimeList list;
+        list.primes = (uint64_t *)malloc(sizeof(uint64_t) * (expected + 1));
+        list.count = 0;
+        list.max_count = expected + 1;
+        assert(prime_segmented_sieve(lo, hi, threads, collect_prime, &list) ==
+               expected);
+        ASSERT_INT_EQ(list.count, expected);
+        for (unsigned int i = 0; i < list.count; ++i) {
+            assert(list.primes[i] >= lo && list.primes[i] < hi);
+            assert(prime_number_sieve_check(sieve,
+                                            (unsigned int)list.primes[i]));
+        }
+        free(list.primes);
+    }
+}
+
+void test_prime_segmented()
+{
+    BitMap *sieve = prime_number_sieve(6 * PRIME_SEGMENT_BITS + 100);
+    uint64_t ranges[][2] = {{0, 0},
+                            {0, 2},
+                            {0, 3},
+                            {2, 3},
+                            {3, 4},
+                            {0, 100},
+                            {90, 97},
+                            {90, 98},
+                            {1, 2 * PRIME_SEGMENT_BITS + 1},
+                            {PRIME_SEGMENT_BITS - 7, 3 * PRIME_SEGMENT_BITS},
+                            {1000, 6 * PRIME_SEGMENT_BITS + 99}};
+    for (unsigned int i = 0; i < sizeof(ranges) / sizeof(ranges[0]); ++i) {
+        check_segmented_range(sieve, ranges[i][0], ranges[i][1]);
+    }
+    prime_number_sieve_free(sieve);
+
+    assert(prime_segmented_count(0, 1000000, 1) == 78498);
+    assert(prime_segmented_count(0, 10000000, 3) == 664579);
+    assert(prime_segmented_count(1000000, 10000000, 2) == 664579 - 78498);
+
+    /** stop after 100 primes from 10^6, in order whatever the threads. */
+    uint64_t first[100];
+    PrimeList list = {first, 0, 100};
+    assert(prime_segmented_sieve(1000000, 20000000, 4, collect_prime, &list) ==
+           100);
+    ASSERT_INT_EQ(list.count, 100);
+    assert(first[0] == 1000003);
+    assert(first[99] == 1001311);
+
+    /** far from 0, the numbers found have no small factor. */
+    uint64_t far[4000];
+    list.primes = far;
+    list.count = 0;
+    list.max_count = 4000;
+    uint64_t lo = (uint64_t)1 << 40;
+    int64_t count =
+        prime_segmented_sieve(lo, lo + 100000, 2, collect_prime, &list);
+    assert(count == 3653);
+    assert(prime_segmented_count(lo, lo + 100000, 1) == count);
+    for (int64_t i = 0; i < count; ++i) {
+        for (uint64_t d = 3; d < 1000; d += 2) {
+            assert(far[i] % d != 0);
+        }
+    }
+    /** 2^40 + 15 is the first prime after 2^40. */
+    assert(far[0] == lo + 15);
+
+    /** claims of windows with primes past twice the window sieved again,
+     * split anywhere. */
+    uint64_t hi = lo + 40 * (uint64_t)PRIME_SEGMENT_BITS;
+    uint64_t mid = lo + 34 * (uint64_t)PRIME_SEGMENT_BITS + 12345;
+    assert(prime_segmented_count(lo, hi, 1) ==
+           prime_segmented_count(lo, mid, 2) +
+               prime_segmented_count(mid, hi, 3));
+
+    /** near 2^50, over a window boundary, the primes of Miller-Rabin. */
+    lo = ((uint64_t)1 << 50) - PRIME_SEGMENT_BITS - 1;
+    hi = lo + 3 * (uint64_t)PRIME_SEGMENT_BITS;
+    unsigned int expected = 0;
+    for (uint64_t n = lo; n < hi; ++n) {
+        expected += prime_miller_rabin(n);
+    }
+    list.primes = (uint64_t *)malloc(sizeof(uint64_t) * (expected + 1));
+    list.count = 0;
+    list.max_count = expected + 1;
+    assert(prime_segmented_sieve(lo, hi, 3, collect_prime, &list) ==
+           expected);
+    ASSERT_INT_EQ(list.count, expected);
+    for (unsigned int i = 0; i < list.count; ++i) {
+        assert(prime_miller_rabin(list.primes[i]));
+    }
+    free(list.primes);
+    assert(prime_segmented_count(lo, hi, 1) == expected);
+}
+
+/** check every query of a PrimeWheel against prime_number_sieve. */
+static void check_prime_wheel(const BitMap *sieve, uint64_t limit)
+{
+    PrimeWheel *wheel = prime_wheel_new(limit);
+    assert(wheel != NULL);
+    int64_t count = 0;
+    for (uint64_t n = 0; n <= limit; ++n) {
+        int is_prime = prime_number_sieve_check(sieve, (unsigned int)n);
+        assert(prime_wheel_is_prime(wheel, n) == is_prime);
+        if (is_prime) {
+            ++count;
+            assert(prime_wheel_nth(wheel, (uint64_t)count) == n);
+        }
+        assert(prime_wheel_count(wheel, n) == count);
+    }
+    assert(wheel->num_primes == (uint64_t)count);
+    assert(prime_wheel_count(wheel, limit + 1) == -1);
+    assert(prime_wheel_nth(wheel, 0) == 0);
+    assert(prime_wheel_nth(wheel, (uint64_t)count + 1) == 0);
+    prime_wheel_free(wheel);
+}
+
+void test_prime_wheel()
+{
+    BitMap *sieve = prime_number_sieve(1000100);
+    /** the first wheel bytes and word boundaries (240 numbers a word). */
+    uint64_t limits[] = {0, 1, 2, 5, 6, 7, 29, 30, 31, 239, 240, 241,
+                         1919, 1920, 1921, 49 * 49, 1000003};
+    for (unsigned int i = 0; i < sizeof(limits) / sizeof(limits[0]); ++i) {
+        check_prime_wheel(sieve, limits[i]);
+    }
+    prime_number_sieve_free(sieve);
+
+    PrimeWheel *wheel = prime_wheel_new(10000000);
+    assert(prime_wheel_count(wheel, 10000000) == 664579);
+    assert(prime_wheel_count(wheel, 1000000) == 78498);
+    assert(prime_wheel_nth(wheel, 664579) == 9999991);
+    assert(prime_wheel_nth(wheel, 78498) == 999983);
+    /** past the limit, by Miller-Rabin. */
+    assert(prime_wheel_is_prime(wheel, 10000019));
+    assert(!prime_wheel_is_prime(wheel, 10000017));
+    assert(prime_wheel_is_prime(wheel, 18446744073709551557ULL));
+    prime_wheel_free(wheel);
+}
+
+void test_prime_miller_rabin()
+{
+    BitMap *sieve = prime_number_sieve(1000000);
+    for (unsigned int n = 0; n <= 1000000; ++n) {
+        assert(prime_miller_rabin(n) == prime_number_sieve_check(sieve, n));
+    }
+    prime_number_sieve_free(sieve);
+
+    /** strong pseudoprimes to the first bases, and a Carmichael number. */
+    uint64_t composites[] = {561,
+                             2047,
+                             1373653,
+                             25326001,
+                             3215031751ULL,
+                             2152302898747ULL,
+                             3474749660383ULL,
+                             341550071728321ULL,
+                             3825123056546413051ULL,
+                             4294967291ULL * 4294967291ULL,
+                             18446744073709551615ULL};
+    for (unsigned int i = 0; i < sizeof(composites) / sizeof(uint64_t); ++i) {
+        assert(!prime_miller_rabin(composites[i]));
+    }
+    assert(prime_miller_rabin(4294967291ULL));
+    assert(prime_miller_rabin(((uint64_t)1 << 61) - 1));
+    assert(prime_miller_rabin(18446744073709551557ULL));
+
+    /** the same primes as the segmented sieve, far from 0. */
+    uint64_t lo = (uint64_t)1 << 40;
+    int64_t count = 0;
+    for (uint64_t n = lo; n < lo + 100000; ++n) {
+        count += prime_miller_rabin(n);
+    }
+    assert(count == 3653);
+}
+
 void test_prime()
 {
     test_prime_1();
     test_prime_2();
     test_prime_3();
+    test_prime_segmented();
+    test_prime_wheel();
+    test_prime_miller_rabin();
 }
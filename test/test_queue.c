@@ -36,3 +36,26 @@ void test_queue()
 
     queue_free(queue);
 }
+
+void test_queue_slab()
+{
+    int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0};
+    Queue *queue = queue_new_with_slab(4);
+
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 10; ++i) {
+            assert(queue_push_tail(queue, &values[i]) == 0);
+        }
+        for (int i = 0; i < 10; ++i) {
+            assert(queue_pop_head(queue) == &values[i]);
+        }
+    }
+    assert(queue_is_empty(queue));
+    /** a steady queue keeps reusing its popped nodes. */
+    ASSERT_INT_EQ(slab_num_pages(queue->slab), 3);
+
+    queue_push_head(queue, &values[0]);
+    queue_push_head(queue, &values[1]);
+    assert(queue_pop_tail(queue) == &values[0]);
+    queue_free(queue);
+}
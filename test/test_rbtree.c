@@ -81,10 +81,49 @@ void test_rbtree_print()
 //     rb_tree_free(tree);
 // }
 
+void test_rbtree_slab()
+{
+    /** free keys: nodes are walked, then the pages are dropped. */
+    RBTree *tree = rb_tree_new_with_slab(int_compare, free, NULL, 0);
+    for (int i = 0; i < 1000; ++i) {
+        int *key = intdup(i);
+        assert(rb_tree_insert(tree, key, key));
+    }
+    assert(rb_tree_subtree_height(tree->root) <= 20);
+
+    int key = 7;
+    RBTreeNode *removed =
+        rb_tree_remove_node(tree, rb_tree_find_node(tree, &key));
+    rb_tree_free_node(tree, removed);
+    assert(tree->num_nodes == 999);
+    ASSERT_INT_EQ(slab_size(tree->slab), 999 * 2);
+    rb_tree_free(tree);
+
+    /** nothing to free per node. */
+    int keys[100];
+    tree = rb_tree_new_with_slab(int_compare, NULL, NULL, 8);
+    for (int i = 0; i < 100; ++i) {
+        keys[i] = i % 50;
+        assert(rb_tree_insert(tree, &keys[i], &keys[i]));
+    }
+    assert(tree->num_nodes == 50);
+    rb_tree_free(tree);
+
+    /** out of memory for the tree, then for its Slab. */
+    size_t allocated = alloc_test_get_allocated();
+    for (int limit = 0; limit < 2; ++limit) {
+        alloc_test_set_limit(limit);
+        assert(rb_tree_new_with_slab(int_compare, NULL, NULL, 8) == NULL);
+        alloc_test_set_limit(-1);
+        assert(alloc_test_get_allocated() == allocated);
+    }
+}
+
 void test_rbtree()
 {
     // test_rb_tree_rotate();
     test_rbtree_insert();
     test_rbtree_delete();
+    test_rbtree_slab();
     // test_rbtree_print();
 }
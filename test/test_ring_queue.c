@@ -0,0 +1,176 @@
+#include "ring_queue.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+typedef struct _Point {
+    int x;
+    int y;
+    char tag;
+} Point;
+
+void test_ring_queue()
+{
+    RingQueue *queue = ring_queue_new(sizeof(int), 4);
+    int value;
+    assert(ring_queue_is_empty(queue));
+    assert(ring_queue_pop_head(queue, &value) == -1);
+    assert(ring_queue_pop_tail(queue, &value) == -1);
+    assert(ring_queue_peek_head(queue) == NULL);
+    assert(ring_queue_peek_tail(queue) == NULL);
+
+    for (int i = 0; i < 3; ++i) {
+        assert(ring_queue_push_head(queue, &i) == 0);
+    }
+    ASSERT_INT_EQ(*(int *)ring_queue_peek_head(queue), 2);
+    ASSERT_INT_EQ(*(int *)ring_queue_peek_tail(queue), 0);
+    for (int i = 2; i >= 0; --i) {
+        assert(ring_queue_pop_head(queue, &value) == 0);
+        ASSERT_INT_EQ(value, i);
+    }
+
+    /** head is in the middle of the buffer, so growing has to unwrap. */
+    for (int i = 0; i < 100; ++i) {
+        assert(ring_queue_push_tail(queue, &i) == 0);
+    }
+    ASSERT_INT_EQ(ring_queue_length(queue), 100);
+    assert(queue->capacity == 128);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_INT_EQ(*(int *)ring_queue_nth(queue, i), i);
+    }
+    assert(ring_queue_nth(queue, 100) == NULL);
+    for (int i = 99; i >= 50; --i) {
+        assert(ring_queue_pop_tail(queue, &value) == 0);
+        ASSERT_INT_EQ(value, i);
+    }
+    assert(ring_queue_pop_head(queue, NULL) == 0);
+    ASSERT_INT_EQ(*(int *)ring_queue_peek_head(queue), 1);
+
+    ring_queue_clear(queue);
+    assert(ring_queue_is_empty(queue));
+    ring_queue_free(queue);
+
+    /** elements are stored unboxed whatever their size. */
+    RingQueue *points = ring_queue_new(sizeof(Point), 0);
+    for (int i = 0; i < 40; ++i) {
+        Point point = {i, -i, (char)('a' + i % 26)};
+        if (i % 2 == 0) {
+            ring_queue_push_tail(points, &point);
+        } else {
+            ring_queue_push_head(points, &point);
+        }
+    }
+    for (int i = 39; i >= 0; i -= 2) {
+        Point point;
+        assert(ring_queue_pop_head(points, &point) == 0);
+        ASSERT_INT_EQ(point.x, i);
+        ASSERT_INT_EQ(point.y, -i);
+        ASSERT_INT_EQ(point.tag, 'a' + i % 26);
+    }
+    for (int i = 38; i >= 0; i -= 2) {
+        Point point;
+        assert(ring_queue_pop_tail(points, &point) == 0);
+        ASSERT_INT_EQ(point.x, i);
+    }
+    assert(ring_queue_is_empty(points));
+    ring_queue_free(points);
+
+    assert(ring_queue_new(0, 0) == NULL);
+}
+
+/** random pushes and pops, checked against a plain array model. */
+void test_ring_queue_many()
+{
+    enum { MODEL_SIZE = 4096 };
+    int *model = (int *)malloc(sizeof(int) * MODEL_SIZE * 3);
+    int model_head = MODEL_SIZE, model_tail = MODEL_SIZE;
+    int buffer[64];
+    int next = 0;
+
+    RingQueue *queue = ring_queue_new(sizeof(int), 1);
+    srand(2019);
+    for (int round = 0; round < 20000; ++round) {
+        int count = rand() % 40;
+        int length = model_tail - model_head;
+        switch (rand() % 6) {
+        case 0:
+        case 1:
+            if (length + count > MODEL_SIZE) {
+                break;
+            }
+            for (int i = 0; i < count; ++i) {
+                buffer[i] = next++;
+            }
+            assert(ring_queue_push_tail_many(queue, buffer, count) == 0);
+            for (int i = 0; i < count; ++i) {
+                model[model_tail++] = buffer[i];
+            }
+            break;
+        case 2:
+            if (length + count > MODEL_SIZE || model_head < count) {
+                break;
+            }
+            for (int i = 0; i < count; ++i) {
+                buffer[i] = next++;
+            }
+            assert(ring_queue_push_head_many(queue, buffer, count) == 0);
+            model_head -= count;
+            for (int i = 0; i < count; ++i) {
+                model[model_head + i] = buffer[i];
+            }
+            break;
+        case 3: {
+            unsigned int popped =
+                ring_queue_pop_head_many(queue, buffer, count);
+            ASSERT_INT_EQ(popped, (count < length ? count : length));
+            for (unsigned int i = 0; i < popped; ++i) {
+                ASSERT_INT_EQ(buffer[i], model[model_head++]);
+            }
+            break;
+        }
+        case 4: {
+            unsigned int popped =
+                ring_queue_pop_tail_many(queue, buffer, count);
+            ASSERT_INT_EQ(popped, (count < length ? count : length));
+            model_tail -= popped;
+            for (unsigned int i = 0; i < popped; ++i) {
+                ASSERT_INT_EQ(buffer[i], model[model_tail + i]);
+            }
+            break;
+        }
+        default:
+            if (length < MODEL_SIZE) {
+                ring_queue_push_tail(queue, &next);
+                model[model_tail++] = next++;
+            }
+            break;
+        }
+
+        /** keep the model window inside its array. */
+        if (model_head < MODEL_SIZE / 2 || model_tail > MODEL_SIZE * 5 / 2) {
+            length = model_tail - model_head;
+            memmove(model + MODEL_SIZE, model + model_head,
+                    sizeof(int) * length);
+            model_head = MODEL_SIZE;
+            model_tail = MODEL_SIZE + length;
+        }
+
+        ASSERT_INT_EQ(ring_queue_length(queue), model_tail - model_head);
+        if (model_tail > model_head) {
+            ASSERT_INT_EQ(*(int *)ring_queue_peek_head(queue),
+                          model[model_head]);
+            ASSERT_INT_EQ(*(int *)ring_queue_peek_tail(queue),
+                          model[model_tail - 1]);
+        }
+    }
+
+    assert(ring_queue_pop_head_many(queue, NULL, MODEL_SIZE) ==
+           (unsigned int)(model_tail - model_head));
+    assert(ring_queue_is_empty(queue));
+    ring_queue_free(queue);
+    free(model);
+}
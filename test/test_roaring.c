@@ -0,0 +1,299 @@
+#include "roaring.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+#define CHUNK 65536
+#define NUM_CHUNKS 4
+
+/** check a Roaring holds exactly the 1 bits of a BitMap. */
+static void check_roaring_bits(const Roaring *roaring, const BitMap *bitmap)
+{
+    unsigned int count = bitmap_count(bitmap);
+    assert(roaring_cardinality(roaring) == count);
+
+    uint32_t *values = (uint32_t *)malloc(sizeof(uint32_t) * (count + 1));
+    assert(roaring_to_array(roaring, values) == count);
+    RoaringIterator iterator;
+    roaring_iterate(roaring, &iterator);
+    uint32_t value;
+    unsigned int n = 0;
+    for (unsigned int i = bitmap_first_set(bitmap); i != BITMAP_NOT_FOUND;
+         i = bitmap_next_set(bitmap, i + 1)) {
+        assert(values[n] == i);
+        assert(roaring_iter_next(&iterator, &value) == 1);
+        assert(value == i);
+        assert(roaring_contains(roaring, i));
+        ++n;
+    }
+    assert(roaring_iter_next(&iterator, &value) == 0);
+    free(values);
+}
+
+/** a random set whose chunks are empty, sparse, dense or runs. */
+static Roaring *random_roaring(BitMap *bitmap, unsigned int seed)
+{
+    Roaring *roaring = roaring_new();
+    for (unsigned int k = 0; k < NUM_CHUNKS; ++k) {
+        uint32_t base = k * CHUNK;
+        switch ((seed + k) % 4) {
+        case 0:
+            break;
+        case 1:
+            for (int i = 0; i < 300; ++i) {
+                uint32_t value = base + rand() % CHUNK;
+                roaring_add(roaring, value);
+                bitmap_set(bitmap, value);
+            }
+            break;
+        case 2:
+            for (int i = 0; i < 30000; ++i) {
+                uint32_t value = base + rand() % CHUNK;
+                roaring_add(roaring, value);
+                bitmap_set(bitmap, value);
+            }
+            break;
+        case 3:
+            for (int i = 0; i < 20; ++i) {
+                uint32_t start = base + rand() % CHUNK;
+                uint32_t end = start + rand() % 3000;
+                if (end > base + CHUNK) {
+                    end = base + CHUNK;
+                }
+                roaring_add_range(roaring, start, end);
+                for (uint32_t value = start; value < end; ++value) {
+                    bitmap_set(bitmap, value);
+                }
+            }
+            break;
+        }
+    }
+    return roaring;
+}
+
+void test_roaring()
+{
+    Roaring *roaring = roaring_new();
+    assert(roaring_cardinality(roaring) == 0);
+    assert(roaring_add(roaring, 7) == 1);
+    assert(roaring_add(roaring, 7) == 0);
+    assert(roaring_add(roaring, UINT32_MAX) == 1);
+    assert(roaring_add(roaring, 3 * CHUNK + 1) == 1);
+    assert(roaring_contains(roaring, 7));
+    assert(roaring_contains(roaring, UINT32_MAX));
+    assert(!roaring_contains(roaring, 8));
+    assert(!roaring_contains(roaring, CHUNK + 7));
+    assert(roaring_cardinality(roaring) == 3);
+
+    RoaringIterator iterator;
+    uint32_t value;
+    roaring_iterate(roaring, &iterator);
+    assert(roaring_iter_next(&iterator, &value) == 1 && value == 7);
+    assert(roaring_iter_next(&iterator, &value) == 1 &&
+           value == 3 * CHUNK + 1);
+    assert(roaring_iter_next(&iterator, &value) == 1 && value == UINT32_MAX);
+    assert(roaring_iter_next(&iterator, &value) == 0);
+    /** the maximum value does not fit in a BitMap. */
+    assert(roaring_to_bitmap(roaring) == NULL);
+
+    assert(roaring_remove(roaring, 7) == 1);
+    assert(roaring_remove(roaring, 7) == 0);
+    assert(roaring_remove(roaring, UINT32_MAX) == 1);
+    assert(roaring_cardinality(roaring) == 1);
+    roaring_free(roaring);
+
+    /** an array becomes a bitset past 4096 values and back. */
+    roaring = roaring_new();
+    BitMap *bitmap = bitmap_new(NUM_CHUNKS * CHUNK);
+    for (uint32_t i = 0; i < 5000; ++i) {
+        roaring_add(roaring, CHUNK + i * 3);
+        bitmap_set(bitmap, CHUNK + i * 3);
+    }
+    check_roaring_bits(roaring, bitmap);
+    for (uint32_t i = 0; i < 2000; ++i) {
+        assert(roaring_remove(roaring, CHUNK + i * 3) == 1);
+        bitmap_clear(bitmap, CHUNK + i * 3);
+    }
+    check_roaring_bits(roaring, bitmap);
+
+    /** ranges are runs, and adding or removing inside them keeps runs. */
+    assert(roaring_add_range(roaring, 2 * CHUNK + 10, 3 * CHUNK + 20) == 0);
+    for (uint32_t i = 2 * CHUNK + 10; i < 3 * CHUNK + 20; ++i) {
+        bitmap_set(bitmap, i);
+    }
+    size_t run_bytes = roaring_size_in_bytes(roaring);
+    check_roaring_bits(roaring, bitmap);
+    uint32_t holes[] = {2 * CHUNK + 10, 2 * CHUNK + 500, 2 * CHUNK + 502,
+                        3 * CHUNK + 19};
+    for (int i = 0; i < 4; ++i) {
+        assert(roaring_remove(roaring, holes[i]) == 1);
+        bitmap_clear(bitmap, holes[i]);
+    }
+    check_roaring_bits(roaring, bitmap);
+    assert(roaring_add(roaring, 2 * CHUNK + 500) == 1);
+    assert(roaring_add(roaring, 2 * CHUNK + 502) == 1);
+    assert(roaring_add(roaring, 2 * CHUNK + 501) == 0);
+    assert(roaring_add(roaring, 2 * CHUNK + 5) == 1);
+    bitmap_set(bitmap, 2 * CHUNK + 500);
+    bitmap_set(bitmap, 2 * CHUNK + 502);
+    bitmap_set(bitmap, 2 * CHUNK + 5);
+    check_roaring_bits(roaring, bitmap);
+    assert(roaring_size_in_bytes(roaring) < run_bytes + 64);
+
+    /** the same values in other containers are still equal. */
+    Roaring *clone = roaring_clone(roaring);
+    assert(roaring_equal(roaring, clone));
+    Roaring *from_bitmap = roaring_from_bitmap(bitmap);
+    assert(roaring_equal(roaring, from_bitmap));
+    assert(roaring_equal(from_bitmap, roaring));
+    size_t natural_bytes = roaring_size_in_bytes(from_bitmap);
+    assert(roaring_run_optimize(from_bitmap) == 0);
+    assert(roaring_size_in_bytes(from_bitmap) < natural_bytes);
+    assert(roaring_equal(roaring, from_bitmap));
+    check_roaring_bits(from_bitmap, bitmap);
+    BitMap *to_bitmap = roaring_to_bitmap(from_bitmap);
+    ASSERT_INT_EQ(to_bitmap->num_bits, 3 * CHUNK + 19);
+    ASSERT_INT_EQ(bitmap_count(to_bitmap), bitmap_count(bitmap));
+    ASSERT_INT_EQ(bitmap_rank(bitmap, to_bitmap->num_bits),
+                  bitmap_count(bitmap));
+    assert(roaring_remove(clone, 2 * CHUNK + 100) == 1);
+    assert(!roaring_equal(roaring, clone));
+
+    bitmap_free(to_bitmap);
+    roaring_free(from_bitmap);
+    roaring_free(clone);
+    bitmap_free(bitmap);
+    roaring_free(roaring);
+
+    /** a full chunk is a single run. */
+    roaring = roaring_new();
+    assert(roaring_add_range(roaring, 0, (uint64_t)UINT32_MAX + 1) == 0);
+    assert(roaring_cardinality(roaring) == (uint64_t)UINT32_MAX + 1);
+    assert(roaring_contains(roaring, 123456789));
+    assert(roaring_size_in_bytes(roaring) < 65536 * 64);
+    /** UINT32_MAX in a run container does not fit in a BitMap either. */
+    assert(roaring_to_bitmap(roaring) == NULL);
+    roaring_free(roaring);
+
+    /** nor in a bitset container. */
+    roaring = roaring_new();
+    for (uint32_t i = 0; i < 5000; ++i) {
+        assert(roaring_add(roaring, UINT32_MAX - 2 * i) == 1);
+    }
+    assert(roaring_to_bitmap(roaring) == NULL);
+    roaring_free(roaring);
+}
+
+void test_roaring_ops()
+{
+    srand(2019);
+    for (unsigned int seed = 0; seed < 8; ++seed) {
+        BitMap *bitmap1 = bitmap_new(NUM_CHUNKS * CHUNK);
+        BitMap *bitmap2 = bitmap_new(NUM_CHUNKS * CHUNK);
+        Roaring *roaring1 = random_roaring(bitmap1, seed);
+        Roaring *roaring2 = random_roaring(bitmap2, seed / 2 + seed % 2 * 3);
+        /** mix run containers with arrays and bitsets of same values. */
+        if (seed % 3 == 1) {
+            roaring_run_optimize(roaring1);
+        }
+        check_roaring_bits(roaring1, bitmap1);
+        check_roaring_bits(roaring2, bitmap2);
+
+        Roaring *result = roaring_and(roaring1, roaring2);
+        BitMap *expected = bitmap_clone(bitmap1);
+        bitmap_and(expected, bitmap2);
+        check_roaring_bits(result, expected);
+        roaring_free(result);
+        bitmap_free(expected);
+
+        result = roaring_or(roaring1, roaring2);
+        expected = bitmap_clone(bitmap1);
+        bitmap_or(expected, bitmap2);
+        check_roaring_bits(result, expected);
+        roaring_free(result);
+        bitmap_free(expected);
+
+        result = roaring_andnot(roaring1, roaring2);
+        expected = bitmap_clone(bitmap1);
+        bitmap_andnot(expected, bitmap2);
+        check_roaring_bits(result, expected);
+        roaring_free(result);
+        bitmap_free(expected);
+
+        result = roaring_andnot(roaring2, roaring1);
+        expected = bitmap_clone(bitmap2);
+        bitmap_andnot(expected, bitmap1);
+        check_roaring_bits(result, expected);
+        roaring_free(result);
+        bitmap_free(expected);
+
+        /** x & x == x | x == x, x - x is empty. */
+        result = roaring_and(roaring1, roaring1);
+        assert(roaring_equal(result, roaring1));
+        roaring_free(result);
+        result = roaring_or(roaring2, roaring2);
+        assert(roaring_equal(result, roaring2));
+        roaring_free(result);
+        result = roaring_andnot(roaring1, roaring1);
+        assert(roaring_cardinality(result) == 0);
+        roaring_free(result);
+
+        roaring_free(roaring2);
+        roaring_free(roaring1);
+        bitmap_free(bitmap2);
+        bitmap_free(bitmap1);
+    }
+}
+
+void test_roaring_serialize()
+{
+    srand(2020);
+    for (unsigned int seed = 0; seed < 4; ++seed) {
+        BitMap *bitmap = bitmap_new(NUM_CHUNKS * CHUNK);
+        Roaring *roaring = random_roaring(bitmap, seed);
+        if (seed % 2 == 0) {
+            roaring_run_optimize(roaring);
+        }
+
+        size_t size = roaring_serialized_size(roaring);
+        unsigned char *buffer = (unsigned char *)malloc(size);
+        assert(roaring_serialize(roaring, buffer) == size);
+        Roaring *copy = roaring_deserialize(buffer, size);
+        assert(copy != NULL);
+        assert(roaring_equal(roaring, copy));
+        check_roaring_bits(copy, bitmap);
+
+        /** truncated or corrupted bytes are rejected. */
+        for (size_t cut = 0; cut < size; cut += size / 7 + 1) {
+            assert(roaring_deserialize(buffer, cut) == NULL);
+        }
+        buffer[0] ^= 1;
+        assert(roaring_deserialize(buffer, size) == NULL);
+        buffer[0] ^= 1;
+        if (size > 8) {
+            /** the first container's type. */
+            unsigned char type = buffer[10];
+            buffer[10] = 9;
+            assert(roaring_deserialize(buffer, size) == NULL);
+            buffer[10] = type;
+        }
+
+        free(buffer);
+        roaring_free(copy);
+        roaring_free(roaring);
+        bitmap_free(bitmap);
+    }
+
+    Roaring *empty = roaring_new();
+    unsigned char header[8];
+    ASSERT_INT_EQ((int)roaring_serialized_size(empty), 8);
+    ASSERT_INT_EQ((int)roaring_serialize(empty, header), 8);
+    Roaring *copy = roaring_deserialize(header, 8);
+    assert(copy != NULL && roaring_cardinality(copy) == 0);
+    roaring_free(copy);
+    roaring_free(empty);
+}
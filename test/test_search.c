@@ -0,0 +1,159 @@
+#include "search.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+static const SearchAlgorithm algorithms[] = {
+    SEARCH_AUTO, SEARCH_SCALAR, SEARCH_SSE2, SEARCH_AVX2, SEARCH_HASHQ};
+
+#define NUM_ALGORITHMS (sizeof(algorithms) / sizeof(algorithms[0]))
+
+/** all matches by brute force. */
+static unsigned int search_naive(const char *text,
+                                 unsigned int text_len,
+                                 const char *pattern,
+                                 unsigned int pat_len,
+                                 unsigned int *matches)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; pat_len > 0 && i + pat_len <= text_len; ++i) {
+        if (memcmp(text + i, pattern, pat_len) == 0) {
+            matches[count++] = i;
+        }
+    }
+    return count;
+}
+
+void test_search_string_match()
+{
+    ASSERT_INT_EQ(search_string_match("abcabc", "abc"), 0);
+    ASSERT_INT_EQ(search_string_match("abcabc", "abcd"), -1);
+    ASSERT_INT_EQ(search_string_match("abcabcd", "abcd"), 3);
+    ASSERT_INT_EQ(search_string_match("bcabaaabaaaa", "aaaa"), 8);
+    ASSERT_INT_EQ(search_string_match("bbcabcdababcdabcdabde", "abcdabd"), 13);
+    ASSERT_INT_EQ(search_string_match("here is a simple example", "example"),
+                  17);
+    ASSERT_INT_EQ(search_string_match("aaaaaaaaaaaaaaaa", "baaa"), -1);
+    ASSERT_INT_EQ(search_string_match("aaaabaaaaaaaaa", "baaaaaaaaa"), 4);
+    ASSERT_INT_EQ(search_string_match("abc", "c"), 2);
+    ASSERT_INT_EQ(search_string_match("abc", ""), -1);
+    ASSERT_INT_EQ(search_string_match("", "a"), -1);
+    ASSERT_INT_EQ(search_string_match("ab", "abc"), -1);
+
+    /** the dispatcher: short, long over ACGT, and very long. */
+    char pattern[128];
+    memset(pattern, 'e', sizeof(pattern));
+    assert(search_choose("e", 1) != SEARCH_HASHQ);
+    assert(search_choose("connection reset by peer, retrying", 34) !=
+           SEARCH_HASHQ);
+    assert(search_choose("GATTACAGATTAC", 13) != SEARCH_HASHQ);
+    assert(search_choose("GATTACAGATTACAGA", 16) == SEARCH_HASHQ);
+    assert(search_choose(pattern, sizeof(pattern)) == SEARCH_HASHQ);
+}
+
+void test_search_text_match_all()
+{
+    unsigned int matches[64];
+    ASSERT_INT_EQ(
+        search_text_match_all("aaaaa", 5, "aa", 2, matches, 64), 4);
+    ASSERT_INT_EQ(matches[3], 3);
+    /** counted past max_matches, or without. */
+    ASSERT_INT_EQ(search_text_match_all("abababab", 8, "ab", 2, matches, 2),
+                  4);
+    ASSERT_INT_EQ(matches[1], 2);
+    ASSERT_INT_EQ(search_text_match_all("abababab", 8, "aba", 3, NULL, 0), 3);
+    /** with '\0' and bytes above 127. */
+    ASSERT_INT_EQ(search_text_match_all("a\0\xff" "a\0\xff", 6, "\0\xff", 2,
+                                        matches, 64),
+                  2);
+    ASSERT_INT_EQ(matches[1], 4);
+}
+
+void test_search_algorithms()
+{
+    /** random texts of 2, 4 and 26 letters, the patterns from them. */
+    unsigned int text_len = 3000;
+    char *text = (char *)malloc(text_len);
+    char pattern[80];
+    unsigned int *expected =
+        (unsigned int *)malloc(sizeof(unsigned int) * text_len);
+    unsigned int *matches =
+        (unsigned int *)malloc(sizeof(unsigned int) * text_len);
+    unsigned int alphabets[] = {2, 4, 26};
+    srand(2019);
+
+    for (unsigned int a = 0; a < sizeof(alphabets) / sizeof(unsigned int);
+         ++a) {
+        for (unsigned int i = 0; i < text_len; ++i) {
+            text[i] = (char)('a' + rand() % alphabets[a]);
+        }
+        for (unsigned int pat_len = 1; pat_len < sizeof(pattern);
+             pat_len += 1 + pat_len / 4) {
+            for (int trial = 0; trial < 4; ++trial) {
+                if (trial == 3) {
+                    /** likely absent. */
+                    for (unsigned int i = 0; i < pat_len; ++i) {
+                        pattern[i] = (char)('a' + rand() % 26);
+                    }
+                } else {
+                    memcpy(pattern,
+                           text + rand() % (text_len - pat_len),
+                           pat_len);
+                }
+                unsigned int count =
+                    search_naive(text, text_len, pattern, pat_len, expected);
+
+                /** the text cut at each length near the SIMD steps. */
+                for (size_t k = 0; k < NUM_ALGORITHMS; ++k) {
+                    ASSERT_INT_EQ(search_text_match_all_by(algorithms[k],
+                                                           text,
+                                                           text_len,
+                                                           pattern,
+                                                           pat_len,
+                                                           matches,
+                                                           text_len),
+                                  count);
+                    assert(memcmp(matches,
+                                  expected,
+                                  sizeof(unsigned int) * count) == 0);
+                }
+                int first = count == 0 ? -1 : (int)expected[0];
+                ASSERT_INT_EQ(
+                    search_text_match(text, text_len, pattern, pat_len), first);
+            }
+        }
+    }
+
+    /** every short text, the match at its end. */
+    for (unsigned int len = 1; len < 70; ++len) {
+        memset(text, 'a', len);
+        text[len - 1] = 'b';
+        for (size_t k = 0; k < NUM_ALGORITHMS; ++k) {
+            unsigned int pat_len = len < 5 ? len : 5;
+            ASSERT_INT_EQ(search_text_match_all_by(algorithms[k],
+                                                   text,
+                                                   len,
+                                                   text + len - pat_len,
+                                                   pat_len,
+                                                   matches,
+                                                   text_len),
+                          1);
+            ASSERT_INT_EQ(matches[0], len - pat_len);
+        }
+    }
+
+    free(text);
+    free(expected);
+    free(matches);
+}
+
+void test_search()
+{
+    test_search_string_match();
+    test_search_text_match_all();
+    test_search_algorithms();
+}
@@ -31,7 +31,40 @@ void test_skip_list_insert()
     free(arr);
 }
 
+void test_skip_list_slab()
+{
+    int *arr = generate_random_numbers(0, 999);
+    for (int round = 0; round < 2; ++round) {
+        /** free values: nodes are walked, then the pages are dropped. */
+        SkipList *list = skip_list_new_with_slab(
+            int_compare, NULL, round == 0 ? NULL : free, 0);
+        for (int i = 0; i < 1000; ++i) {
+            int *value = round == 0 ? &arr[i] : intdup(arr[i]);
+            assert(skip_list_insert(list, &arr[i], value));
+        }
+
+        for (int k = 0; k < 1000; k += 2) {
+            SkipListNode *node = skip_list_remove_node(list, &k);
+            assert(node != NULL && *(int *)node->key == k);
+            skip_list_free_node(list, node);
+        }
+        for (int k = 0; k < 1000; ++k) {
+            int *value = (int *)skip_list_find(list, &k);
+            if (k % 2 == 0) {
+                assert(value == NULL);
+            } else {
+                ASSERT_INT_POINTER_EQ(value, k);
+            }
+        }
+        /** head and the odd keys. */
+        ASSERT_INT_EQ(slab_size(list->slab), 501);
+        skip_list_free(list);
+    }
+    free(arr);
+}
+
 void test_skip_list()
 {
     test_skip_list_insert();
+    test_skip_list_slab();
 }
@@ -0,0 +1,72 @@
+#include "slab.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+void test_slab_alloc()
+{
+    Slab *slab = slab_new(20, 10);
+    char *objects[25];
+    for (int i = 0; i < 25; ++i) {
+        objects[i] = (char *)slab_alloc(slab);
+        assert(objects[i] != NULL);
+        /** objects are aligned and do not overlap. */
+        assert((uintptr_t)objects[i] % sizeof(void *) == 0);
+        memset(objects[i], i, 20);
+    }
+    for (int i = 0; i < 25; ++i) {
+        for (int j = 0; j < 20; ++j) {
+            assert(objects[i][j] == i);
+        }
+    }
+    ASSERT_INT_EQ(slab_size(slab), 25);
+    ASSERT_INT_EQ(slab_num_pages(slab), 3);
+
+    /** freed objects are reused first, most recent first. */
+    slab_dealloc(slab, objects[3]);
+    slab_dealloc(slab, objects[17]);
+    ASSERT_INT_EQ(slab_size(slab), 23);
+    assert(slab_alloc(slab) == objects[17]);
+    assert(slab_alloc(slab) == objects[3]);
+    ASSERT_INT_EQ(slab_num_pages(slab), 3);
+
+    slab_free(slab);
+}
+
+void test_slab_reset()
+{
+    Slab *slab = slab_new(sizeof(int), 0);
+    for (int i = 0; i < 10000; ++i) {
+        *(int *)slab_alloc(slab) = i;
+    }
+    assert(slab_num_pages(slab) > 1);
+
+    slab_reset(slab);
+    ASSERT_INT_EQ(slab_size(slab), 0);
+    ASSERT_INT_EQ(slab_num_pages(slab), 1);
+    /** the kept page is reused. */
+    for (int i = 0; i < 100; ++i) {
+        assert(slab_alloc(slab) != NULL);
+    }
+    ASSERT_INT_EQ(slab_size(slab), 100);
+    ASSERT_INT_EQ(slab_num_pages(slab), 1);
+
+    slab_free(slab);
+
+    /** reset an empty slab. */
+    slab = slab_new(64, 0);
+    slab_reset(slab);
+    ASSERT_INT_EQ(slab_num_pages(slab), 0);
+    assert(slab_alloc(slab) != NULL);
+    slab_free(slab);
+}
+
+void test_slab()
+{
+    test_slab_alloc();
+    test_slab_reset();
+}
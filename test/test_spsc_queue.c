@@ -0,0 +1,117 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "spsc_queue.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alloc-testing.h"
+#include "test_helper.h"
+
+#define NUM_VALUES 50000
+
+void test_spsc_queue_basic()
+{
+    int values[10];
+    QueueValue data[10];
+    QueueValue value;
+
+    assert(spsc_queue_new(0) == NULL);
+    SpscQueue *queue = spsc_queue_new(5);
+    ASSERT_INT_EQ(spsc_queue_capacity(queue), 8);
+    assert(spsc_queue_pop(queue, &value) == -1);
+
+    for (int i = 0; i < 8; ++i) {
+        assert(spsc_queue_push(queue, &values[i]) == 0);
+    }
+    assert(spsc_queue_push(queue, &values[8]) == -1);
+    ASSERT_INT_EQ(spsc_queue_length(queue), 8);
+    for (int i = 0; i < 5; ++i) {
+        assert(spsc_queue_pop(queue, &value) == 0);
+        assert(value == &values[i]);
+    }
+
+    /** the batch wraps around the end of the ring and is cut when full. */
+    for (int i = 0; i < 10; ++i) {
+        data[i] = &values[i];
+    }
+    ASSERT_INT_EQ(spsc_queue_push_many(queue, data, 10), 5);
+    ASSERT_INT_EQ(spsc_queue_push_many(queue, data, 10), 0);
+    ASSERT_INT_EQ(spsc_queue_pop_many(queue, data, 2), 2);
+    assert(data[0] == &values[5] && data[1] == &values[6]);
+    ASSERT_INT_EQ(spsc_queue_pop_many(queue, data, 10), 6);
+    assert(data[0] == &values[7]);
+    for (int i = 1; i < 6; ++i) {
+        assert(data[i] == &values[i - 1]);
+    }
+    ASSERT_INT_EQ(spsc_queue_length(queue), 0);
+    ASSERT_INT_EQ(spsc_queue_pop_many(queue, data, 10), 0);
+
+    spsc_queue_free(queue);
+}
+
+static int *spsc_values;
+
+static void *spsc_produce(void *arg)
+{
+    SpscQueue *queue = (SpscQueue *)arg;
+    QueueValue batch[7];
+    int i = 0;
+    while (i < NUM_VALUES) {
+        if (i % 3 == 0) {
+            int count = 0;
+            while (count < 7 && i + count < NUM_VALUES) {
+                batch[count] = &spsc_values[i + count];
+                ++count;
+            }
+            i += spsc_queue_push_many(queue, batch, count);
+        } else if (spsc_queue_push(queue, &spsc_values[i]) == 0) {
+            ++i;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void test_spsc_queue_threads()
+{
+    SpscQueue *queue = spsc_queue_new(64);
+    spsc_values = (int *)malloc(sizeof(int) * NUM_VALUES);
+    for (int i = 0; i < NUM_VALUES; ++i) {
+        spsc_values[i] = i;
+    }
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, spsc_produce, queue);
+
+    /** values arrive complete and in order. */
+    QueueValue batch[5];
+    int next = 0;
+    while (next < NUM_VALUES) {
+        unsigned int count = next % 2 == 0
+                                 ? spsc_queue_pop_many(queue, batch, 5)
+                                 : (unsigned int)(spsc_queue_pop(queue,
+                                                                 batch) == 0);
+        if (count == 0) {
+            sched_yield();
+        }
+        for (unsigned int k = 0; k < count; ++k) {
+            ASSERT_INT_EQ(*(int *)batch[k], next);
+            ++next;
+        }
+    }
+
+    pthread_join(producer, NULL);
+    ASSERT_INT_EQ(spsc_queue_length(queue), 0);
+    free(spsc_values);
+    spsc_queue_free(queue);
+}
+
+void test_spsc_queue()
+{
+    test_spsc_queue_basic();
+    test_spsc_queue_threads();
+}
@@ -3,18 +3,32 @@
 
 #include "alloc-testing.h"
 
+extern void test_slab();
 extern void test_arraylist();
 extern void test_arraylist_index_of();
 extern void test_arraylist_sort();
 extern void test_list();
 extern void test_list_sort();
+extern void test_list_slab();
 extern void test_queue();
+extern void test_queue_slab();
+extern void test_ilist();
+extern void test_ilist_sort();
+extern void test_iqueue();
+extern void test_ring_queue();
+extern void test_ring_queue_many();
+extern void test_spsc_queue();
+extern void test_mpmc_queue();
 extern void test_bitmap();
 extern void test_bitmap_words();
+extern void test_roaring();
+extern void test_roaring_ops();
+extern void test_roaring_serialize();
 extern void test_matrix();
 extern void test_matrix_2_dimensions();
 extern void test_bstree();
 extern void test_bstree_remove();
+extern void test_bstree_slab();
 extern void test_avltree();
 extern void test_rbtree();
 extern void test_heap();
@@ -24,32 +38,58 @@ extern void test_bignum_int_addition();
 extern void test_bignum_int_subtraction();
 extern void test_bignum_int_multiplication();
 extern void test_bignum_int_division();
+extern void test_bignum_limbs();
+extern void test_bignum_mul_algorithms();
+extern void test_bignum_div_algorithms();
+extern void test_bignum_powmod_gcd();
+extern void test_bignum_scratch();
+extern void test_graph();
+extern void test_sparse_graph();
 extern void test_dijkstra();
 extern void test_prime();
+extern void test_hash();
 extern void test_hash_table();
+extern void test_concurrent_hash_table();
 extern void test_kmp();
 extern void test_bm();
+extern void test_sunday();
+extern void test_search();
 extern void test_trie();
 extern void test_ac();
 extern void test_text();
 extern void test_huffman();
+extern void test_lz77();
 extern void test_distance();
 extern void test_vector();
 
 typedef void (*TestcaseFunc)(void);
 
-static TestcaseFunc all_tests[] = {test_arraylist,
+static TestcaseFunc all_tests[] = {test_slab,
+                                   test_arraylist,
                                    test_arraylist_index_of,
                                    test_arraylist_sort,
                                    test_list,
                                    test_list_sort,
+                                   test_list_slab,
                                    test_queue,
+                                   test_queue_slab,
+                                   test_ilist,
+                                   test_ilist_sort,
+                                   test_iqueue,
+                                   test_ring_queue,
+                                   test_ring_queue_many,
+                                   test_spsc_queue,
+                                   test_mpmc_queue,
                                    test_bitmap,
                                    test_bitmap_words,
+                                   test_roaring,
+                                   test_roaring_ops,
+                                   test_roaring_serialize,
                                    test_matrix,
                                    test_matrix_2_dimensions,
                                    test_bstree,
                                    test_bstree_remove,
+                                   test_bstree_slab,
                                    test_avltree,
                                    test_rbtree,
                                    test_heap,
@@ -59,15 +99,27 @@ static TestcaseFunc all_tests[] = {test_arraylist,
                                    test_bignum_int_subtraction,
                                    test_bignum_int_multiplication,
                                    test_bignum_int_division,
+                                   test_bignum_limbs,
+                                   test_bignum_mul_algorithms,
+                                   test_bignum_div_algorithms,
+                                   test_bignum_powmod_gcd,
+                                   test_bignum_scratch,
+                                   test_graph,
+                                   test_sparse_graph,
                                    test_dijkstra,
                                    test_prime,
+                                   test_hash,
                                    test_hash_table,
+                                   test_concurrent_hash_table,
                                    test_kmp,
                                    test_bm,
+                                   test_sunday,
+                                   test_search,
                                    test_trie,
                                    test_ac,
                                    test_text,
                                    test_huffman,
+                                   test_lz77,
                                    test_distance,
                                    test_vector,
                                    NULL};